@@ -0,0 +1,414 @@
+// RgBench: times the RgTools plane kernels directly on synthetic planes, without Avisynth.
+//
+//   RgBench [--filter=RemoveGrain,Repair,Clense,SClense,MedianOfClips,VerticalCleaner] [--table=avx2_functions,...]
+//           [--mode=1,4,17] [--bits=8,10,12,14,16,32] [--size=1920x1080,...] [--pattern=flat,noise,edges]
+//           [--time=ms] [--format=text|csv|json] [--out=file] [--counters=on] [--check=on]
+//
+// Defaults: every filter, table and mode the CPU can run, 8 bit, all sizes from 320x240 to 8K, noise,
+// at least 100 ms and 3 runs per kernel, text to stdout.
+// Mpix/s and cycles/pixel are from the median run. bytes/cycle counts the source planes read and the
+// destination written, cycles are TSC ticks (the nominal clock, not the current one).
+//
+// --counters=on adds hardware counters per kernel call (Linux perf_event_open, averaged over the timed runs):
+// IPC, instructions per byte, L1D and LLC misses per pixel, backend stall share. Without counter access
+// (perf_event_paranoid > 2, containers, VMs, Windows) it prints why and goes on with timing only.
+// It also copies one plane with BitBlt per frame size and bit depth, the bytes/cycle of that copy is the
+// memory roof of the roofline: roof% is a kernel's bytes/cycle against it, 60% or more is memory bound.
+//
+// --check=on runs RemoveGrain, Repair and VerticalCleaner kernels once more in place, in row windows like the
+// filters on exclusively owned frames, before they are timed, and stops at the first output that differs.
+
+#include "bench.h"
+#include "autotune.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+#include <stdexcept>
+
+const AVS_Linkage *AVS_linkage = nullptr;
+
+namespace {
+
+struct Size { int width; int height; };
+
+struct Options {
+  std::vector<std::string> filters;
+  std::vector<std::string> tables;
+  std::vector<int> modes;
+  std::vector<int> bits;
+  std::vector<Size> sizes;
+  std::vector<BenchPattern> patterns;
+  double min_time;
+  std::string format;
+  std::string out;
+  bool counters;
+  bool check;
+};
+
+struct Result {
+  const BenchKernel *kernel;
+  Size size;
+  const char *pattern;
+  int runs;
+  double seconds; // median
+  double cycles;  // median
+  BenchCounterValues counters; // per call
+  double roof;    // bytes/cycle of a plane copy at this size and bit depth, 0 without --counters
+};
+
+const Size all_sizes[] = { { 320, 240 }, { 640, 480 }, { 1280, 720 }, { 1920, 1080 }, { 3840, 2160 }, { 7680, 4320 } };
+
+const char* pattern_name(BenchPattern p) {
+  return p == BenchPattern::FLAT ? "flat" : p == BenchPattern::EDGES ? "edges" : "noise";
+}
+
+std::vector<std::string> split(const std::string &s) {
+  std::vector<std::string> parts;
+  size_t start = 0;
+  while (start <= s.size()) {
+    size_t end = s.find(',', start);
+    if (end == std::string::npos)
+      end = s.size();
+    if (end > start)
+      parts.push_back(s.substr(start, end - start));
+    start = end + 1;
+  }
+  return parts;
+}
+
+Options parse_options(int argc, char **argv) {
+  Options o;
+  o.bits.push_back(8);
+  o.sizes.assign(std::begin(all_sizes), std::end(all_sizes));
+  o.patterns.push_back(BenchPattern::NOISE);
+  o.min_time = 0.1;
+  o.format = "text";
+  o.counters = false;
+  o.check = false;
+
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
+    const size_t eq = arg.find('=');
+    if (arg.compare(0, 2, "--") != 0 || eq == std::string::npos)
+      throw std::runtime_error("unknown argument " + arg + ", options are --name=value");
+    const std::string name = arg.substr(2, eq - 2);
+    const std::vector<std::string> values = split(arg.substr(eq + 1));
+
+    if (name == "filter") {
+      o.filters = values;
+    }
+    else if (name == "table") {
+      o.tables = values;
+    }
+    else if (name == "mode") {
+      o.modes.clear();
+      for (auto &v : values) o.modes.push_back(atoi(v.c_str()));
+    }
+    else if (name == "bits") {
+      o.bits.clear();
+      for (auto &v : values) o.bits.push_back(atoi(v.c_str()));
+    }
+    else if (name == "size") {
+      o.sizes.clear();
+      for (auto &v : values) {
+        Size s = { 0, 0 };
+        if (sscanf(v.c_str(), "%dx%d", &s.width, &s.height) != 2 || s.width < 4 || s.height < 5)
+          throw std::runtime_error("bad size " + v + ", expected WIDTHxHEIGHT");
+        o.sizes.push_back(s);
+      }
+    }
+    else if (name == "pattern") {
+      o.patterns.clear();
+      for (auto &v : values) {
+        if (v == "flat") o.patterns.push_back(BenchPattern::FLAT);
+        else if (v == "noise") o.patterns.push_back(BenchPattern::NOISE);
+        else if (v == "edges") o.patterns.push_back(BenchPattern::EDGES);
+        else throw std::runtime_error("bad pattern " + v + ", expected flat, noise or edges");
+      }
+    }
+    else if (name == "time") {
+      o.min_time = atof(values.empty() ? "0" : values[0].c_str()) / 1000.0;
+    }
+    else if (name == "format") {
+      o.format = values.empty() ? "" : values[0];
+      if (o.format != "text" && o.format != "csv" && o.format != "json")
+        throw std::runtime_error("bad format " + o.format + ", expected text, csv or json");
+    }
+    else if (name == "counters") {
+      const std::string v = values.empty() ? "" : values[0];
+      if (v != "on" && v != "off")
+        throw std::runtime_error("bad counters " + v + ", expected on or off");
+      o.counters = v == "on";
+    }
+    else if (name == "check") {
+      const std::string v = values.empty() ? "" : values[0];
+      if (v != "on" && v != "off")
+        throw std::runtime_error("bad check " + v + ", expected on or off");
+      o.check = v == "on";
+    }
+    else if (name == "out") {
+      o.out = arg.substr(eq + 1);
+    }
+    else {
+      throw std::runtime_error("unknown option --" + name);
+    }
+  }
+  return o;
+}
+
+template<typename T>
+bool selected(const std::vector<T> &list, const T &value) {
+  return list.empty() || std::find(list.begin(), list.end(), value) != list.end();
+}
+
+// the in place output must be the one of the kernel writing into a separate destination
+void check_inplace(const BenchKernel &k, BenchFrame &frame, const char *pattern) {
+  IScriptEnvironment *env = bench_env();
+  const int rowsize = frame.rowsize();
+  k.run(frame, env);
+  std::vector<BYTE> expected((size_t)rowsize * frame.height);
+  for (int y = 0; y < frame.height; ++y)
+    memcpy(&expected[(size_t)y * rowsize], frame.dst.ptr() + (size_t)y * frame.dst.pitch(), rowsize);
+
+  env->BitBlt(frame.dst.ptr(), frame.dst.pitch(), frame.in[0].ptr(), frame.in[0].pitch(), rowsize, frame.height);
+  k.run_inplace(frame, env);
+  for (int y = 0; y < frame.height; ++y) {
+    if (memcmp(&expected[(size_t)y * rowsize], frame.dst.ptr() + (size_t)y * frame.dst.pitch(), rowsize) != 0) {
+      char message[256];
+      snprintf(message, sizeof(message), "%s %s mode %d, %dx%d %s: in place output differs in row %d",
+        k.filter.c_str(), k.table.c_str(), k.mode, frame.width, frame.height, pattern, y);
+      throw std::runtime_error(message);
+    }
+  }
+}
+
+Result measure(const BenchKernel &k, BenchFrame &frame, const char *pattern, double min_time, BenchCounters *counters) {
+  typedef std::chrono::steady_clock clock;
+  IScriptEnvironment *env = bench_env();
+
+  k.run(frame, env); // warm up caches and page in the planes
+
+  std::vector<double> seconds, cycles;
+  double total = 0;
+  if (counters)
+    counters->start();
+  while (seconds.size() < 3 || total < min_time) {
+    const auto start = clock::now();
+    const unsigned long long tsc = __rdtsc();
+    k.run(frame, env);
+    cycles.push_back((double)(__rdtsc() - tsc));
+    const double t = std::chrono::duration<double>(clock::now() - start).count();
+    seconds.push_back(t);
+    total += t;
+  }
+  BenchCounterValues values = { { -1, -1, -1, -1, -1 } };
+  if (counters) {
+    counters->stop();
+    values = counters->read_values();
+    for (double &v : values.value) {
+      if (v >= 0)
+        v /= seconds.size();
+    }
+  }
+
+  std::sort(seconds.begin(), seconds.end());
+  std::sort(cycles.begin(), cycles.end());
+  Result r = { &k, { frame.width, frame.height }, pattern, (int)seconds.size(), seconds[seconds.size() / 2], cycles[cycles.size() / 2], values, 0 };
+  return r;
+}
+
+// Counter derived columns of one result, -1 where a counter is missing
+struct Profile {
+  double ipc;
+  double instructions_per_byte;
+  double l1d_misses_per_pixel;
+  double llc_misses_per_pixel;
+  double stall_percent;
+  double roof_percent;
+  const char *bound;
+};
+
+Profile profile(const Result &r, double pixels, double bytes) {
+  const double *c = r.counters.value;
+  const bool cycles = c[BENCH_CYCLES] > 0;
+  Profile p;
+  p.ipc = cycles && c[BENCH_INSTRUCTIONS] >= 0 ? c[BENCH_INSTRUCTIONS] / c[BENCH_CYCLES] : -1;
+  p.instructions_per_byte = c[BENCH_INSTRUCTIONS] >= 0 ? c[BENCH_INSTRUCTIONS] / bytes : -1;
+  p.l1d_misses_per_pixel = c[BENCH_L1D_MISSES] >= 0 ? c[BENCH_L1D_MISSES] / pixels : -1;
+  p.llc_misses_per_pixel = c[BENCH_LLC_MISSES] >= 0 ? c[BENCH_LLC_MISSES] / pixels : -1;
+  p.stall_percent = cycles && c[BENCH_STALLS] >= 0 ? c[BENCH_STALLS] / c[BENCH_CYCLES] * 100 : -1;
+  p.roof_percent = r.roof > 0 ? bytes / r.cycles / r.roof * 100 : -1;
+  p.bound = p.roof_percent < 0 ? "" : p.roof_percent >= 60 ? "memory" : "compute";
+  return p;
+}
+
+// "-" in text, empty in csv, null in json for missing values
+std::string number(double v, const char *fmt, const std::string &format) {
+  if (v < 0)
+    return format == "json" ? "null" : format == "csv" ? "" : "-";
+  char s[32];
+  snprintf(s, sizeof(s), fmt, v);
+  return s;
+}
+
+void write_results(FILE *f, const std::vector<Result> &results, const std::string &format, bool counters) {
+  const std::string cpu = cpu_model_name();
+
+  if (format == "json") {
+    fprintf(f, "{\n  \"cpu\": \"%s\",\n  \"results\": [", cpu.c_str());
+  }
+  else if (format == "csv") {
+    fprintf(f, "cpu,filter,table,mode,bits,width,height,pattern,runs,ms,mpix_s,cycles_per_pixel,bytes_per_cycle%s\n",
+      counters ? ",ipc,instructions_per_byte,l1d_misses_per_pixel,llc_misses_per_pixel,stall_percent,roof_percent,bound" : "");
+  }
+  else {
+    fprintf(f, "%s\n%-16s %-26s %4s %4s %11s %-5s %10s %10s %8s %8s", cpu.c_str(),
+      "filter", "table", "mode", "bits", "size", "data", "ms", "Mpix/s", "cyc/pix", "B/cycle");
+    if (counters)
+      fprintf(f, " %5s %7s %8s %8s %6s %6s %s", "IPC", "instr/B", "L1D/pix", "LLC/pix", "stall%", "roof%", "bound");
+    fprintf(f, "\n");
+  }
+
+  for (size_t i = 0; i < results.size(); ++i) {
+    const Result &r = results[i];
+    const BenchKernel &k = *r.kernel;
+    const double pixels = (double)r.size.width * r.size.height;
+    const int pixelsize = k.bits_per_pixel == 8 ? 1 : k.bits_per_pixel == 32 ? 4 : 2;
+    const double bytes = pixels * pixelsize * (k.inputs + 1);
+    const double mpix = pixels / r.seconds / 1e6;
+    const double cycles_per_pixel = r.cycles / pixels;
+    const double bytes_per_cycle = bytes / r.cycles;
+    const Profile p = profile(r, pixels, bytes);
+
+    if (format == "json") {
+      fprintf(f, "%s\n    { \"filter\": \"%s\", \"table\": \"%s\", \"mode\": %d, \"bits\": %d, \"width\": %d, \"height\": %d, "
+        "\"pattern\": \"%s\", \"runs\": %d, \"ms\": %.4f, \"mpix_s\": %.2f, \"cycles_per_pixel\": %.4f, \"bytes_per_cycle\": %.4f",
+        i == 0 ? "" : ",", k.filter.c_str(), k.table.c_str(), k.mode, k.bits_per_pixel, r.size.width, r.size.height,
+        r.pattern, r.runs, r.seconds * 1000, mpix, cycles_per_pixel, bytes_per_cycle);
+      if (counters) {
+        fprintf(f, ", \"ipc\": %s, \"instructions_per_byte\": %s, \"l1d_misses_per_pixel\": %s, \"llc_misses_per_pixel\": %s, "
+          "\"stall_percent\": %s, \"roof_percent\": %s, \"bound\": \"%s\"",
+          number(p.ipc, "%.3f", format).c_str(), number(p.instructions_per_byte, "%.3f", format).c_str(),
+          number(p.l1d_misses_per_pixel, "%.5f", format).c_str(), number(p.llc_misses_per_pixel, "%.5f", format).c_str(),
+          number(p.stall_percent, "%.1f", format).c_str(), number(p.roof_percent, "%.1f", format).c_str(), p.bound);
+      }
+      fprintf(f, " }");
+    }
+    else if (format == "csv") {
+      fprintf(f, "\"%s\",%s,%s,%d,%d,%d,%d,%s,%d,%.4f,%.2f,%.4f,%.4f", cpu.c_str(), k.filter.c_str(), k.table.c_str(), k.mode,
+        k.bits_per_pixel, r.size.width, r.size.height, r.pattern, r.runs, r.seconds * 1000, mpix, cycles_per_pixel, bytes_per_cycle);
+      if (counters) {
+        fprintf(f, ",%s,%s,%s,%s,%s,%s,%s", number(p.ipc, "%.3f", format).c_str(), number(p.instructions_per_byte, "%.3f", format).c_str(),
+          number(p.l1d_misses_per_pixel, "%.5f", format).c_str(), number(p.llc_misses_per_pixel, "%.5f", format).c_str(),
+          number(p.stall_percent, "%.1f", format).c_str(), number(p.roof_percent, "%.1f", format).c_str(), p.bound);
+      }
+      fprintf(f, "\n");
+    }
+    else {
+      char size[32];
+      snprintf(size, sizeof(size), "%dx%d", r.size.width, r.size.height);
+      fprintf(f, "%-16s %-26s %4d %4d %11s %-5s %10.3f %10.1f %8.3f %8.3f", k.filter.c_str(), k.table.c_str(), k.mode,
+        k.bits_per_pixel, size, r.pattern, r.seconds * 1000, mpix, cycles_per_pixel, bytes_per_cycle);
+      if (counters) {
+        fprintf(f, " %5s %7s %8s %8s %6s %6s %s", number(p.ipc, "%.2f", format).c_str(), number(p.instructions_per_byte, "%.3f", format).c_str(),
+          number(p.l1d_misses_per_pixel, "%.4f", format).c_str(), number(p.llc_misses_per_pixel, "%.4f", format).c_str(),
+          number(p.stall_percent, "%.1f", format).c_str(), number(p.roof_percent, "%.1f", format).c_str(), p.bound);
+      }
+      fprintf(f, "\n");
+    }
+  }
+
+  if (format == "json")
+    fprintf(f, "\n  ]\n}\n");
+}
+
+}
+
+int main(int argc, char **argv) {
+  try {
+    const Options o = parse_options(argc, argv);
+#ifndef _MSC_VER
+    // RgBench/Makefile compiles the kernel sources with -msse4.1, the harness with -msse2
+    if (!bench_cpu_supports(CPUF_SSE4_1))
+      throw std::runtime_error("this build needs an SSE4.1 CPU");
+#endif
+
+    std::vector<BenchKernel> all, kernels;
+    add_removegrain_kernels(all);
+    add_repair_kernels(all);
+    add_clense_kernels(all);
+    add_vertical_cleaner_kernels(all);
+    for (auto &k : all) {
+      if (selected(o.filters, k.filter) && selected(o.tables, k.table) && selected(o.modes, k.mode) && selected(o.bits, k.bits_per_pixel))
+        kernels.push_back(k);
+    }
+    if (kernels.empty())
+      throw std::runtime_error("no kernel matches the options on this CPU");
+
+    std::unique_ptr<BenchCounters> counters;
+    if (o.counters) {
+      counters.reset(new BenchCounters());
+      if (!counters->available()) {
+        fprintf(stderr, "RgBench: hardware counters unavailable (%s), timing only\n", counters->status().c_str());
+        counters.reset();
+      }
+    }
+
+    std::vector<Result> results;
+    for (auto &size : o.sizes) {
+      for (int bits : o.bits) {
+        for (auto pattern : o.patterns) {
+          // one frame per size, bit depth and pattern, shared by all kernels
+          bool any = false;
+          for (auto &k : kernels) any |= k.bits_per_pixel == bits;
+          if (!any)
+            continue;
+          const int pixelsize = bits == 8 ? 1 : bits == 32 ? 4 : 2;
+          BenchFrame frame(size.width, size.height, pixelsize, bits, pattern);
+
+          double roof = 0;
+          if (o.counters) {
+            BenchKernel copy = { "copy", "BitBlt", 0, bits, 1, [](BenchFrame &fr, IScriptEnvironment *env) {
+              env->BitBlt(fr.dst.ptr(), fr.dst.pitch(), fr.in[0].ptr(), fr.in[0].pitch(), fr.rowsize(), fr.height);
+            } };
+            const Result c = measure(copy, frame, pattern_name(pattern), o.min_time, nullptr);
+            roof = (double)frame.rowsize() * frame.height * 2 / c.cycles;
+          }
+
+          for (auto &k : kernels) {
+            if (k.bits_per_pixel != bits)
+              continue;
+            if (o.check && k.run_inplace)
+              check_inplace(k, frame, pattern_name(pattern));
+            results.push_back(measure(k, frame, pattern_name(pattern), o.min_time, counters.get()));
+            results.back().roof = roof;
+            if (!o.out.empty() || o.format != "text")
+              fprintf(stderr, "\r%u kernels timed", (unsigned)results.size());
+          }
+        }
+      }
+    }
+    if (!o.out.empty() || o.format != "text")
+      fprintf(stderr, "\n");
+
+    FILE *f = o.out.empty() ? stdout : fopen(o.out.c_str(), "w");
+    if (f == nullptr)
+      throw std::runtime_error("cannot write " + o.out);
+    write_results(f, results, o.format, o.counters);
+    if (f != stdout)
+      fclose(f);
+    return 0;
+  }
+  catch (const std::exception &e) {
+    fprintf(stderr, "RgBench: %s\n", e.what());
+    return 1;
+  }
+}
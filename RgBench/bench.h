@@ -0,0 +1,114 @@
+#ifndef __RGBENCH_H__
+#define __RGBENCH_H__
+
+#include "common.h"
+#include <functional>
+#include <string>
+#include <vector>
+
+// Synthetic plane, 64 byte aligned rows like a frame
+enum class BenchPattern {
+  FLAT,   // mid grey, every comparison ties
+  NOISE,  // xorshift noise over the full range
+  EDGES   // 8x8 black and white blocks, hard edges in both directions
+};
+
+class BenchPlane {
+public:
+  BenchPlane(int width, int height, int pixelsize, int bits_per_pixel, BenchPattern pattern, unsigned seed);
+
+  BYTE* ptr() { return data_; }
+  int pitch() const { return pitch_; }
+
+private:
+  std::vector<BYTE> buffer_;
+  BYTE *data_;
+  int pitch_;
+};
+
+// Source planes and the destination of one benchmark frame, 'in' has as many planes as the widest kernel reads
+struct BenchFrame {
+  int width;
+  int height;
+  int pixelsize;
+  int bits_per_pixel;
+  std::vector<BenchPlane> in;
+  BenchPlane dst;
+
+  BenchFrame(int width, int height, int pixelsize, int bits_per_pixel, BenchPattern pattern);
+  int rowsize() const { return width * pixelsize; }
+};
+
+// One table entry of one filter
+struct BenchKernel {
+  std::string filter;  // RemoveGrain, Repair, Clense, SClense, MedianOfClips, VerticalCleaner
+  std::string table;   // name of the function table, e.g. sse4_functions_16_10
+  int mode;
+  int bits_per_pixel;  // 8, 10, 12, 14, 16, 32
+  int inputs;          // source planes read, for bytes/cycle
+  std::function<void(BenchFrame &frame, IScriptEnvironment *env)> run;
+  // RemoveGrain, Repair, VerticalCleaner: the same kernel in place on dst, which holds a copy of in[0], the way
+  // the filter runs it on exclusively owned frames (--check=on). Empty for the others
+  std::function<void(BenchFrame &frame, IScriptEnvironment *env)> run_inplace;
+};
+
+// ISA a table needs, checked against CPUID before a kernel is added
+enum BenchIsa {
+  BENCH_C = 0,
+  BENCH_SSE2 = CPUF_SSE2,
+  BENCH_SSE3 = CPUF_SSE3,
+  BENCH_SSSE3 = CPUF_SSSE3,
+  BENCH_SSE4 = CPUF_SSE4_1,
+  BENCH_AVX2 = CPUF_AVX2,
+  BENCH_FMA = CPUF_AVX2 | CPUF_FMA3,
+  BENCH_AVX512 = -1 // AVX-512 F, BW, VL, own check
+};
+
+bool bench_cpu_supports(int isa);
+
+// Every table entry of each filter the CPU can run, one file per filter (the table names clash between them)
+void add_removegrain_kernels(std::vector<BenchKernel> &kernels);
+void add_repair_kernels(std::vector<BenchKernel> &kernels);
+void add_clense_kernels(std::vector<BenchKernel> &kernels);
+void add_vertical_cleaner_kernels(std::vector<BenchKernel> &kernels);
+
+// Hardware counters, Linux perf_event_open, user space of the calling thread
+enum BenchCounter {
+  BENCH_CYCLES,
+  BENCH_INSTRUCTIONS,
+  BENCH_L1D_MISSES,  // L1 data read misses
+  BENCH_LLC_MISSES,  // last level cache misses
+  BENCH_STALLS,      // backend stall cycles, not counted on many Intel CPUs
+  BENCH_COUNTER_COUNT
+};
+
+struct BenchCounterValues {
+  double value[BENCH_COUNTER_COUNT]; // -1 if not counted
+};
+
+// available() is false when the kernel or the CPU refuses cycles or instructions (perf_event_paranoid,
+// containers, VMs, other OS), status() tells why. The other events are optional.
+class BenchCounters {
+public:
+  BenchCounters();
+  ~BenchCounters();
+
+  bool available() const;
+  const std::string& status() const { return status_; }
+
+  void start(); // reset and enable
+  void stop();
+  BenchCounterValues read_values() const;
+
+private:
+  BenchCounters(const BenchCounters&) = delete;
+  BenchCounters& operator=(const BenchCounters&) = delete;
+
+  int fd_[BENCH_COUNTER_COUNT];
+  std::string status_;
+};
+
+// The few IScriptEnvironment calls the kernels make (BitBlt), everything else throws
+IScriptEnvironment* bench_env();
+
+#endif
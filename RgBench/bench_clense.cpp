@@ -0,0 +1,109 @@
+#include "bench.h"
+#include "clense.h"
+
+extern ClenseProcessor* c_clense_functions[];
+extern ClenseProcessor* c_sclense_functions[];
+extern ClenseProcessor* sse_clense_functions[];
+extern ClenseProcessor* sse_sclense_functions[];
+extern ClenseProcessor* avx2_clense_functions[];
+extern ClenseProcessor* avx2_sclense_functions[];
+extern ClenseProcessor* avx512_clense_functions[];
+extern ClenseProcessor* avx512_sclense_functions[];
+extern ClenseMedianProcessor* c_clense_median_functions[][6];
+extern ClenseMedianProcessor* sse_clense_median_functions[][6];
+extern ClenseMedianProcessor* avx2_clense_median_functions[][6];
+extern ClenseMedianProcessor* avx512_clense_median_functions[][6];
+extern RankProcessor* c_rank_functions[];
+extern RankProcessor* sse_rank_functions[];
+extern RankProcessor* avx2_rank_functions[];
+extern RankProcessor* avx512_rank_functions[];
+
+void add_clense_kernels(std::vector<BenchKernel> &kernels) {
+  // Clense is the median of previous, current and next frame, SClense (ForwardClense, BackwardClense) of the
+  // current frame and two frames on one side
+  struct { const char *filter; const char *name; ClenseProcessor **table; int isa; } tables[] = {
+    { "Clense", "c_clense_functions", c_clense_functions, BENCH_C },
+    { "SClense", "c_sclense_functions", c_sclense_functions, BENCH_C },
+    { "Clense", "sse_clense_functions", sse_clense_functions, BENCH_SSE2 },
+    { "SClense", "sse_sclense_functions", sse_sclense_functions, BENCH_SSE2 },
+    { "Clense", "avx2_clense_functions", avx2_clense_functions, BENCH_AVX2 },
+    { "SClense", "avx2_sclense_functions", avx2_sclense_functions, BENCH_AVX2 },
+    { "Clense", "avx512_clense_functions", avx512_clense_functions, BENCH_AVX512 },
+    { "SClense", "avx512_sclense_functions", avx512_sclense_functions, BENCH_AVX512 },
+  };
+  const int bits[] = { 8, 10, 12, 14, 16, 32 }; // table index
+
+  for (auto &t : tables) {
+    if (!bench_cpu_supports(t.isa))
+      continue;
+    for (int i = 0; i < 6; ++i) {
+      // the 16 bit SSE entries are SSE4.1
+      if (bits[i] > 8 && bits[i] < 32 && t.isa == BENCH_SSE2 && !bench_cpu_supports(BENCH_SSE4))
+        continue;
+      ClenseProcessor *processor = t.table[i];
+      kernels.push_back({ t.filter, t.name, 0, bits[i], 3, [processor](BenchFrame &f, IScriptEnvironment *env) {
+        processor(f.dst.ptr(), f.in[0].ptr(), f.in[1].ptr(), f.in[2].ptr(), f.dst.pitch(), f.in[0].pitch(), f.in[1].pitch(), f.in[2].pitch(),
+          f.rowsize(), f.height, env);
+      } });
+    }
+  }
+
+  // Clense radius 2-4 as mode, 5 to 9 frames made of the three source planes
+  struct { const char *name; ClenseMedianProcessor* (*table)[6]; int isa; } median_tables[] = {
+    { "c_clense_median_functions", c_clense_median_functions, BENCH_C },
+    { "sse_clense_median_functions", sse_clense_median_functions, BENCH_SSE2 },
+    { "avx2_clense_median_functions", avx2_clense_median_functions, BENCH_AVX2 },
+    { "avx512_clense_median_functions", avx512_clense_median_functions, BENCH_AVX512 },
+  };
+
+  for (auto &t : median_tables) {
+    if (!bench_cpu_supports(t.isa))
+      continue;
+    for (int radius = 2; radius <= Clense::MAX_RADIUS; ++radius) {
+      for (int i = 0; i < 6; ++i) {
+        if (bits[i] > 8 && bits[i] < 32 && t.isa == BENCH_SSE2 && !bench_cpu_supports(BENCH_SSE4))
+          continue;
+        ClenseMedianProcessor *processor = t.table[radius - 2][i];
+        kernels.push_back({ "Clense", t.name, radius, bits[i], 3, [processor, radius](BenchFrame &f, IScriptEnvironment *env) {
+          const Byte* frames[2 * Clense::MAX_RADIUS + 1];
+          int pitches[2 * Clense::MAX_RADIUS + 1];
+          for (int k = 0; k < 2 * radius + 1; ++k) {
+            frames[k] = f.in[k % 3].ptr();
+            pitches[k] = f.in[k % 3].pitch();
+          }
+          processor(f.dst.ptr(), frames, pitches, f.dst.pitch(), f.rowsize(), f.height, env);
+        } });
+      }
+    }
+  }
+
+  // MedianOfClips sort, number of clips as mode (median rank), made of the three source planes
+  struct { const char *name; RankProcessor **table; int isa; } rank_tables[] = {
+    { "c_rank_functions", c_rank_functions, BENCH_C },
+    { "sse_rank_functions", sse_rank_functions, BENCH_SSE2 },
+    { "avx2_rank_functions", avx2_rank_functions, BENCH_AVX2 },
+    { "avx512_rank_functions", avx512_rank_functions, BENCH_AVX512 },
+  };
+  const int counts[] = { 3, 6, 16 };
+
+  for (auto &t : rank_tables) {
+    if (!bench_cpu_supports(t.isa))
+      continue;
+    for (int count : counts) {
+      for (int i = 0; i < 6; ++i) {
+        if (bits[i] > 8 && bits[i] < 32 && t.isa == BENCH_SSE2 && !bench_cpu_supports(BENCH_SSE4))
+          continue;
+        RankProcessor *processor = t.table[i];
+        kernels.push_back({ "MedianOfClips", t.name, count, bits[i], 3, [processor, count](BenchFrame &f, IScriptEnvironment *env) {
+          const Byte* planes[RANK_MAX_PLANES];
+          int pitches[RANK_MAX_PLANES];
+          for (int k = 0; k < count; ++k) {
+            planes[k] = f.in[k % 3].ptr();
+            pitches[k] = f.in[k % 3].pitch();
+          }
+          processor(f.dst.ptr(), planes, pitches, count, (count - 1) / 2, f.dst.pitch(), f.rowsize(), f.height, env);
+        } });
+      }
+    }
+  }
+}
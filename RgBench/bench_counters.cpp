@@ -0,0 +1,119 @@
+#include "bench.h"
+
+#ifdef __linux__
+#include <cerrno>
+#include <cstring>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace {
+
+struct EventSpec {
+  uint32_t type;
+  uint64_t config;
+};
+
+const EventSpec event_specs[BENCH_COUNTER_COUNT] = {
+  { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+  { PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+  { PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16) },
+  { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES },
+  { PERF_TYPE_HARDWARE, PERF_COUNT_HW_STALLED_CYCLES_BACKEND },
+};
+
+int open_event(const EventSpec &spec) {
+  perf_event_attr attr;
+  memset(&attr, 0, sizeof(attr));
+  attr.size = sizeof(attr);
+  attr.type = spec.type;
+  attr.config = spec.config;
+  attr.disabled = 1;
+  // user space only, allowed with the default perf_event_paranoid=2
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+  // more events than counters are multiplexed, the values are scaled by the running time
+  attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+  return (int)syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+}
+
+}
+
+BenchCounters::BenchCounters() {
+  for (int i = 0; i < BENCH_COUNTER_COUNT; ++i)
+    fd_[i] = -1;
+
+  for (int i = 0; i < BENCH_COUNTER_COUNT; ++i) {
+    fd_[i] = open_event(event_specs[i]);
+    if (fd_[i] < 0 && i <= BENCH_INSTRUCTIONS) {
+      status_ = std::string("perf_event_open: ") + strerror(errno);
+      if (errno == EACCES || errno == EPERM)
+        status_ += ", check /proc/sys/kernel/perf_event_paranoid";
+      break;
+    }
+  }
+}
+
+BenchCounters::~BenchCounters() {
+  for (int i = 0; i < BENCH_COUNTER_COUNT; ++i) {
+    if (fd_[i] >= 0)
+      close(fd_[i]);
+  }
+}
+
+bool BenchCounters::available() const {
+  return fd_[BENCH_CYCLES] >= 0 && fd_[BENCH_INSTRUCTIONS] >= 0;
+}
+
+void BenchCounters::start() {
+  for (int i = 0; i < BENCH_COUNTER_COUNT; ++i) {
+    if (fd_[i] >= 0) {
+      ioctl(fd_[i], PERF_EVENT_IOC_RESET, 0);
+      ioctl(fd_[i], PERF_EVENT_IOC_ENABLE, 0);
+    }
+  }
+}
+
+void BenchCounters::stop() {
+  for (int i = 0; i < BENCH_COUNTER_COUNT; ++i) {
+    if (fd_[i] >= 0)
+      ioctl(fd_[i], PERF_EVENT_IOC_DISABLE, 0);
+  }
+}
+
+BenchCounterValues BenchCounters::read_values() const {
+  BenchCounterValues v;
+  for (int i = 0; i < BENCH_COUNTER_COUNT; ++i) {
+    v.value[i] = -1;
+    uint64_t data[3]; // value, time enabled, time running
+    if (fd_[i] < 0 || read(fd_[i], data, sizeof(data)) != sizeof(data) || data[2] == 0)
+      continue;
+    v.value[i] = (double)data[0] * ((double)data[1] / (double)data[2]);
+  }
+  return v;
+}
+
+#else
+
+BenchCounters::BenchCounters() : status_("hardware counters are read with Linux perf_event_open") {
+  for (int i = 0; i < BENCH_COUNTER_COUNT; ++i)
+    fd_[i] = -1;
+}
+
+BenchCounters::~BenchCounters() {}
+
+bool BenchCounters::available() const { return false; }
+
+void BenchCounters::start() {}
+
+void BenchCounters::stop() {}
+
+BenchCounterValues BenchCounters::read_values() const {
+  BenchCounterValues v;
+  for (int i = 0; i < BENCH_COUNTER_COUNT; ++i)
+    v.value[i] = -1;
+  return v;
+}
+
+#endif
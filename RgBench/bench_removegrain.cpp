@@ -0,0 +1,114 @@
+#include "bench.h"
+#include "removegrain.h"
+#include "inplace.h"
+
+extern PlaneProcessor* c_functions[];
+extern PlaneProcessor* c_functions_10[];
+extern PlaneProcessor* c_functions_12[];
+extern PlaneProcessor* c_functions_14[];
+extern PlaneProcessor* c_functions_16[];
+extern PlaneProcessor* c_functions_32[];
+extern PlaneProcessor* sse2_functions[];
+extern PlaneProcessor* sse3_functions[];
+extern PlaneProcessor* ssse3_functions[];
+extern PlaneProcessor* sse4_functions_16_10[];
+extern PlaneProcessor* sse4_functions_16_12[];
+extern PlaneProcessor* sse4_functions_16_14[];
+extern PlaneProcessor* sse4_functions_16_16[];
+extern PlaneProcessor* sse4_functions_32[];
+extern PlaneProcessor* avx2_functions[];
+extern PlaneProcessor* avx2_functions_16_10[];
+extern PlaneProcessor* avx2_functions_16_12[];
+extern PlaneProcessor* avx2_functions_16_14[];
+extern PlaneProcessor* avx2_functions_16_16[];
+extern PlaneProcessor* avx2_functions_32[];
+extern PlaneProcessor* avx2_fma_functions_32[];
+extern PlaneProcessor* avx512_functions[];
+extern PlaneProcessor* avx512_functions_16_10[];
+extern PlaneProcessor* avx512_functions_16_12[];
+extern PlaneProcessor* avx512_functions_16_14[];
+extern PlaneProcessor* avx512_functions_16_16[];
+extern PlaneProcessor* avx512_functions_32[];
+// row blocked modes with one row per iteration, nullptr for the others
+extern PlaneProcessor* sse2_functions_rows1[];
+extern PlaneProcessor* sse3_functions_rows1[];
+extern PlaneProcessor* ssse3_functions_rows1[];
+extern PlaneProcessor* sse4_functions_16_10_rows1[];
+extern PlaneProcessor* sse4_functions_16_12_rows1[];
+extern PlaneProcessor* sse4_functions_16_14_rows1[];
+extern PlaneProcessor* sse4_functions_16_16_rows1[];
+extern PlaneProcessor* sse4_functions_32_rows1[];
+extern PlaneProcessor* avx2_functions_rows1[];
+extern PlaneProcessor* avx2_functions_16_10_rows1[];
+extern PlaneProcessor* avx2_functions_16_12_rows1[];
+extern PlaneProcessor* avx2_functions_16_14_rows1[];
+extern PlaneProcessor* avx2_functions_16_16_rows1[];
+extern PlaneProcessor* avx2_functions_32_rows1[];
+extern PlaneProcessor* avx2_fma_functions_32_rows1[];
+
+void add_removegrain_kernels(std::vector<BenchKernel> &kernels) {
+  struct { const char *name; PlaneProcessor **table; int bits; int isa; } tables[] = {
+    { "c_functions", c_functions, 8, BENCH_C },
+    { "c_functions_10", c_functions_10, 10, BENCH_C },
+    { "c_functions_12", c_functions_12, 12, BENCH_C },
+    { "c_functions_14", c_functions_14, 14, BENCH_C },
+    { "c_functions_16", c_functions_16, 16, BENCH_C },
+    { "c_functions_32", c_functions_32, 32, BENCH_C },
+    { "sse2_functions", sse2_functions, 8, BENCH_SSE2 },
+    { "sse3_functions", sse3_functions, 8, BENCH_SSE3 },
+    { "ssse3_functions", ssse3_functions, 8, BENCH_SSSE3 },
+    { "sse4_functions_16_10", sse4_functions_16_10, 10, BENCH_SSE4 },
+    { "sse4_functions_16_12", sse4_functions_16_12, 12, BENCH_SSE4 },
+    { "sse4_functions_16_14", sse4_functions_16_14, 14, BENCH_SSE4 },
+    { "sse4_functions_16_16", sse4_functions_16_16, 16, BENCH_SSE4 },
+    { "sse4_functions_32", sse4_functions_32, 32, BENCH_SSE4 },
+    { "avx2_functions", avx2_functions, 8, BENCH_AVX2 },
+    { "avx2_functions_16_10", avx2_functions_16_10, 10, BENCH_AVX2 },
+    { "avx2_functions_16_12", avx2_functions_16_12, 12, BENCH_AVX2 },
+    { "avx2_functions_16_14", avx2_functions_16_14, 14, BENCH_AVX2 },
+    { "avx2_functions_16_16", avx2_functions_16_16, 16, BENCH_AVX2 },
+    { "avx2_functions_32", avx2_functions_32, 32, BENCH_AVX2 },
+    { "avx2_fma_functions_32", avx2_fma_functions_32, 32, BENCH_FMA },
+    { "avx512_functions", avx512_functions, 8, BENCH_AVX512 },
+    { "avx512_functions_16_10", avx512_functions_16_10, 10, BENCH_AVX512 },
+    { "avx512_functions_16_12", avx512_functions_16_12, 12, BENCH_AVX512 },
+    { "avx512_functions_16_14", avx512_functions_16_14, 14, BENCH_AVX512 },
+    { "avx512_functions_16_16", avx512_functions_16_16, 16, BENCH_AVX512 },
+    { "avx512_functions_32", avx512_functions_32, 32, BENCH_AVX512 },
+    // RG_BLOCK_ROWS against one row: --table=avx2_functions,avx2_functions_rows1
+    { "sse2_functions_rows1", sse2_functions_rows1, 8, BENCH_SSE2 },
+    { "sse3_functions_rows1", sse3_functions_rows1, 8, BENCH_SSE3 },
+    { "ssse3_functions_rows1", ssse3_functions_rows1, 8, BENCH_SSSE3 },
+    { "sse4_functions_16_10_rows1", sse4_functions_16_10_rows1, 10, BENCH_SSE4 },
+    { "sse4_functions_16_12_rows1", sse4_functions_16_12_rows1, 12, BENCH_SSE4 },
+    { "sse4_functions_16_14_rows1", sse4_functions_16_14_rows1, 14, BENCH_SSE4 },
+    { "sse4_functions_16_16_rows1", sse4_functions_16_16_rows1, 16, BENCH_SSE4 },
+    { "sse4_functions_32_rows1", sse4_functions_32_rows1, 32, BENCH_SSE4 },
+    { "avx2_functions_rows1", avx2_functions_rows1, 8, BENCH_AVX2 },
+    { "avx2_functions_16_10_rows1", avx2_functions_16_10_rows1, 10, BENCH_AVX2 },
+    { "avx2_functions_16_12_rows1", avx2_functions_16_12_rows1, 12, BENCH_AVX2 },
+    { "avx2_functions_16_14_rows1", avx2_functions_16_14_rows1, 14, BENCH_AVX2 },
+    { "avx2_functions_16_16_rows1", avx2_functions_16_16_rows1, 16, BENCH_AVX2 },
+    { "avx2_functions_32_rows1", avx2_functions_32_rows1, 32, BENCH_AVX2 },
+    { "avx2_fma_functions_32_rows1", avx2_fma_functions_32_rows1, 32, BENCH_FMA },
+  };
+
+  for (auto &t : tables) {
+    if (!bench_cpu_supports(t.isa))
+      continue;
+    // mode 0 (copy) is the memory bandwidth baseline
+    for (int mode = 0; mode <= 24; ++mode) {
+      PlaneProcessor *processor = t.table[mode + 1];
+      if (processor == nullptr)
+        continue;
+      kernels.push_back({ "RemoveGrain", t.name, mode, t.bits, 1, [processor](BenchFrame &f, IScriptEnvironment *env) {
+        processor(env, f.in[0].ptr(), f.dst.ptr(), f.rowsize(), f.height, f.in[0].pitch(), f.dst.pitch());
+      }, [processor](BenchFrame &f, IScriptEnvironment *env) {
+        const int rowsize = f.rowsize();
+        process_plane_inplace(f.dst.ptr(), f.dst.pitch(), rowsize, f.height, 1, [&](int, int h, const BYTE* pWindow, int windowPitch, BYTE* pRows, int pitch) {
+          processor(env, pWindow, pRows, rowsize, h, windowPitch, pitch);
+        });
+      } });
+    }
+  }
+}
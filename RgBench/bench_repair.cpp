@@ -0,0 +1,121 @@
+#include "bench.h"
+#include "repair.h"
+#include "inplace.h"
+
+namespace repair {
+
+extern RepairPlaneProcessor* c_functions[];
+extern RepairPlaneProcessor* c_functions_10[];
+extern RepairPlaneProcessor* c_functions_12[];
+extern RepairPlaneProcessor* c_functions_14[];
+extern RepairPlaneProcessor* c_functions_16[];
+extern RepairPlaneProcessor* c_functions_32[];
+extern RepairPlaneProcessor* sse2_functions[];
+extern RepairPlaneProcessor* sse3_functions[];
+extern RepairPlaneProcessor* ssse3_functions[];
+extern RepairPlaneProcessor* sse4_functions_16_10[];
+extern RepairPlaneProcessor* sse4_functions_16_12[];
+extern RepairPlaneProcessor* sse4_functions_16_14[];
+extern RepairPlaneProcessor* sse4_functions_16_16[];
+extern RepairPlaneProcessor* sse4_functions_32[];
+extern RepairPlaneProcessor* avx2_functions[];
+extern RepairPlaneProcessor* avx2_functions_16_10[];
+extern RepairPlaneProcessor* avx2_functions_16_12[];
+extern RepairPlaneProcessor* avx2_functions_16_14[];
+extern RepairPlaneProcessor* avx2_functions_16_16[];
+extern RepairPlaneProcessor* avx2_functions_32[];
+extern RepairPlaneProcessor* avx2_fma_functions_32[];
+extern RepairPlaneProcessor* avx512_functions[];
+extern RepairPlaneProcessor* avx512_functions_16_10[];
+extern RepairPlaneProcessor* avx512_functions_16_12[];
+extern RepairPlaneProcessor* avx512_functions_16_14[];
+extern RepairPlaneProcessor* avx512_functions_16_16[];
+extern RepairPlaneProcessor* avx512_functions_32[];
+// row blocked modes with one row per iteration, nullptr for the others
+extern RepairPlaneProcessor* sse2_functions_rows1[];
+extern RepairPlaneProcessor* sse3_functions_rows1[];
+extern RepairPlaneProcessor* ssse3_functions_rows1[];
+extern RepairPlaneProcessor* sse4_functions_16_10_rows1[];
+extern RepairPlaneProcessor* sse4_functions_16_12_rows1[];
+extern RepairPlaneProcessor* sse4_functions_16_14_rows1[];
+extern RepairPlaneProcessor* sse4_functions_16_16_rows1[];
+extern RepairPlaneProcessor* sse4_functions_32_rows1[];
+extern RepairPlaneProcessor* avx2_functions_rows1[];
+extern RepairPlaneProcessor* avx2_functions_16_10_rows1[];
+extern RepairPlaneProcessor* avx2_functions_16_12_rows1[];
+extern RepairPlaneProcessor* avx2_functions_16_14_rows1[];
+extern RepairPlaneProcessor* avx2_functions_16_16_rows1[];
+extern RepairPlaneProcessor* avx2_functions_32_rows1[];
+extern RepairPlaneProcessor* avx2_fma_functions_32_rows1[];
+
+}
+using namespace repair;
+
+void add_repair_kernels(std::vector<BenchKernel> &kernels) {
+  struct { const char *name; RepairPlaneProcessor **table; int bits; int isa; } tables[] = {
+    { "c_functions", c_functions, 8, BENCH_C },
+    { "c_functions_10", c_functions_10, 10, BENCH_C },
+    { "c_functions_12", c_functions_12, 12, BENCH_C },
+    { "c_functions_14", c_functions_14, 14, BENCH_C },
+    { "c_functions_16", c_functions_16, 16, BENCH_C },
+    { "c_functions_32", c_functions_32, 32, BENCH_C },
+    { "sse2_functions", sse2_functions, 8, BENCH_SSE2 },
+    { "sse3_functions", sse3_functions, 8, BENCH_SSE3 },
+    { "ssse3_functions", ssse3_functions, 8, BENCH_SSSE3 },
+    { "sse4_functions_16_10", sse4_functions_16_10, 10, BENCH_SSE4 },
+    { "sse4_functions_16_12", sse4_functions_16_12, 12, BENCH_SSE4 },
+    { "sse4_functions_16_14", sse4_functions_16_14, 14, BENCH_SSE4 },
+    { "sse4_functions_16_16", sse4_functions_16_16, 16, BENCH_SSE4 },
+    { "sse4_functions_32", sse4_functions_32, 32, BENCH_SSE4 },
+    { "avx2_functions", avx2_functions, 8, BENCH_AVX2 },
+    { "avx2_functions_16_10", avx2_functions_16_10, 10, BENCH_AVX2 },
+    { "avx2_functions_16_12", avx2_functions_16_12, 12, BENCH_AVX2 },
+    { "avx2_functions_16_14", avx2_functions_16_14, 14, BENCH_AVX2 },
+    { "avx2_functions_16_16", avx2_functions_16_16, 16, BENCH_AVX2 },
+    { "avx2_functions_32", avx2_functions_32, 32, BENCH_AVX2 },
+    { "avx2_fma_functions_32", avx2_fma_functions_32, 32, BENCH_FMA },
+    { "avx512_functions", avx512_functions, 8, BENCH_AVX512 },
+    { "avx512_functions_16_10", avx512_functions_16_10, 10, BENCH_AVX512 },
+    { "avx512_functions_16_12", avx512_functions_16_12, 12, BENCH_AVX512 },
+    { "avx512_functions_16_14", avx512_functions_16_14, 14, BENCH_AVX512 },
+    { "avx512_functions_16_16", avx512_functions_16_16, 16, BENCH_AVX512 },
+    { "avx512_functions_32", avx512_functions_32, 32, BENCH_AVX512 },
+    // RG_BLOCK_ROWS against one row: --table=avx2_functions,avx2_functions_rows1
+    { "sse2_functions_rows1", sse2_functions_rows1, 8, BENCH_SSE2 },
+    { "sse3_functions_rows1", sse3_functions_rows1, 8, BENCH_SSE3 },
+    { "ssse3_functions_rows1", ssse3_functions_rows1, 8, BENCH_SSSE3 },
+    { "sse4_functions_16_10_rows1", sse4_functions_16_10_rows1, 10, BENCH_SSE4 },
+    { "sse4_functions_16_12_rows1", sse4_functions_16_12_rows1, 12, BENCH_SSE4 },
+    { "sse4_functions_16_14_rows1", sse4_functions_16_14_rows1, 14, BENCH_SSE4 },
+    { "sse4_functions_16_16_rows1", sse4_functions_16_16_rows1, 16, BENCH_SSE4 },
+    { "sse4_functions_32_rows1", sse4_functions_32_rows1, 32, BENCH_SSE4 },
+    { "avx2_functions_rows1", avx2_functions_rows1, 8, BENCH_AVX2 },
+    { "avx2_functions_16_10_rows1", avx2_functions_16_10_rows1, 10, BENCH_AVX2 },
+    { "avx2_functions_16_12_rows1", avx2_functions_16_12_rows1, 12, BENCH_AVX2 },
+    { "avx2_functions_16_14_rows1", avx2_functions_16_14_rows1, 14, BENCH_AVX2 },
+    { "avx2_functions_16_16_rows1", avx2_functions_16_16_rows1, 16, BENCH_AVX2 },
+    { "avx2_functions_32_rows1", avx2_functions_32_rows1, 32, BENCH_AVX2 },
+    { "avx2_fma_functions_32_rows1", avx2_fma_functions_32_rows1, 32, BENCH_FMA },
+  };
+
+  for (auto &t : tables) {
+    if (!bench_cpu_supports(t.isa))
+      continue;
+    // mode 0 (copy) is the memory bandwidth baseline
+    for (int mode = 0; mode <= 24; ++mode) {
+      RepairPlaneProcessor *processor = t.table[mode + 1];
+      if (processor == nullptr)
+        continue;
+      kernels.push_back({ "Repair", t.name, mode, t.bits, 2, [processor](BenchFrame &f, IScriptEnvironment *env) {
+        processor(env, f.dst.ptr(), f.in[0].ptr(), f.in[1].ptr(), f.dst.pitch(), f.in[0].pitch(), f.in[1].pitch(), f.rowsize(), f.height);
+      }, [processor](BenchFrame &f, IScriptEnvironment *env) {
+        const int rowsize = f.rowsize();
+        const BYTE* pRef = f.in[1].ptr();
+        const int refPitch = f.in[1].pitch();
+        process_plane_inplace(f.dst.ptr(), f.dst.pitch(), rowsize, f.height, 1, [&](int y, int h, const BYTE* pWindow, int windowPitch, BYTE* pRows, int pitch) {
+          processor(env, pRows, pWindow, pRef + y * refPitch, pitch, windowPitch, refPitch, rowsize, h);
+        });
+      } });
+    }
+  }
+}
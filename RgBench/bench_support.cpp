@@ -0,0 +1,154 @@
+#include "bench.h"
+#include "autotune.h"
+#include <cstdarg>
+#include <stdexcept>
+
+BenchPlane::BenchPlane(int width, int height, int pixelsize, int bits_per_pixel, BenchPattern pattern, unsigned seed)
+  : pitch_((width * pixelsize + 63) / 64 * 64 + 64) {
+  buffer_.resize((size_t)pitch_ * height + 64);
+  data_ = buffer_.data() + ((64 - ((uintptr_t)buffer_.data() & 63)) & 63);
+
+  const unsigned max_value = pixelsize == 4 ? 0 : (1u << bits_per_pixel) - 1;
+  unsigned x = 2463534242u + seed * 7919u;
+  for (int y = 0; y < height; ++y) {
+    BYTE *row = data_ + (size_t)y * pitch_;
+    for (int i = 0; i < width; ++i) {
+      float v; // 0..1
+      if (pattern == BenchPattern::FLAT) {
+        v = 0.5f;
+      }
+      else if (pattern == BenchPattern::EDGES) {
+        // seed shifts the blocks so the source planes of Repair and Clense differ
+        v = (((i + seed) >> 3) ^ (y >> 3)) & 1 ? 1.0f : 0.0f;
+      }
+      else {
+        x ^= x << 13; x ^= x >> 17; x ^= x << 5;
+        v = (x >> 8) * (1.0f / 16777215.0f);
+      }
+
+      if (pixelsize == 1)
+        row[i] = (BYTE)(v * max_value + 0.5f);
+      else if (pixelsize == 2)
+        reinterpret_cast<uint16_t*>(row)[i] = (uint16_t)(v * max_value + 0.5f);
+      else
+        reinterpret_cast<float*>(row)[i] = v;
+    }
+  }
+}
+
+BenchFrame::BenchFrame(int width, int height, int pixelsize, int bits_per_pixel, BenchPattern pattern)
+  : width(width), height(height), pixelsize(pixelsize), bits_per_pixel(bits_per_pixel),
+    dst(width, height, pixelsize, bits_per_pixel, BenchPattern::FLAT, 0) {
+  // Clense reads three planes
+  for (unsigned i = 0; i < 3; ++i)
+    in.emplace_back(width, height, pixelsize, bits_per_pixel, pattern, i + 1);
+}
+
+bool bench_cpu_supports(int isa) {
+  if (isa == BENCH_AVX512)
+    return (cpu_detect_flags() & CPUF_AVX2) && cpu_has_avx512bw();
+  return (cpu_detect_flags() & isa) == isa;
+}
+
+namespace {
+
+[[noreturn]] void unsupported() {
+  throw std::logic_error("IScriptEnvironment function not available in RgBench");
+}
+
+class BenchEnvironment : public IScriptEnvironment {
+public:
+  int __stdcall GetCPUFlags() override { return cpu_detect_flags(); }
+
+  void __stdcall BitBlt(BYTE* dstp, int dst_pitch, const BYTE* srcp, int src_pitch, int row_size, int height) override {
+    for (int y = 0; y < height; ++y)
+      memcpy(dstp + (size_t)y * dst_pitch, srcp + (size_t)y * src_pitch, row_size);
+  }
+
+  void ThrowError(const char* fmt, ...) override {
+    char message[512];
+    va_list args;
+    va_start(args, fmt);
+    vsnprintf(message, sizeof(message), fmt, args);
+    va_end(args);
+    throw std::runtime_error(message);
+  }
+
+  char* __stdcall SaveString(const char*, int) override { unsupported(); }
+  char* Sprintf(const char*, ...) override { unsupported(); }
+  char* __stdcall VSprintf(const char*, va_list) override { unsupported(); }
+  void __stdcall AddFunction(const char*, const char*, ApplyFunc, void*) override { unsupported(); }
+  bool __stdcall FunctionExists(const char*) override { unsupported(); }
+  AVSValue __stdcall Invoke(const char*, const AVSValue, const char* const*) override { unsupported(); }
+  AVSValue __stdcall GetVar(const char*) override { unsupported(); }
+  bool __stdcall SetVar(const char*, const AVSValue&) override { unsupported(); }
+  bool __stdcall SetGlobalVar(const char*, const AVSValue&) override { unsupported(); }
+  void __stdcall PushContext(int) override { unsupported(); }
+  void __stdcall PopContext() override { unsupported(); }
+  PVideoFrame __stdcall NewVideoFrame(const VideoInfo&, int) override { unsupported(); }
+  bool __stdcall MakeWritable(PVideoFrame*) override { unsupported(); }
+  void __stdcall AtExit(ShutdownFunc, void*) override { unsupported(); }
+  void __stdcall CheckVersion(int) override { unsupported(); }
+  PVideoFrame __stdcall Subframe(PVideoFrame, int, int, int, int) override { unsupported(); }
+  int __stdcall SetMemoryMax(int) override { unsupported(); }
+  int __stdcall SetWorkingDir(const char*) override { unsupported(); }
+  void* __stdcall ManageCache(int, void*) override { unsupported(); }
+  bool __stdcall PlanarChromaAlignment(PlanarChromaAlignmentMode) override { unsupported(); }
+  PVideoFrame __stdcall SubframePlanar(PVideoFrame, int, int, int, int, int, int, int) override { unsupported(); }
+  void __stdcall DeleteScriptEnvironment() override { unsupported(); }
+  void __stdcall ApplyMessage(PVideoFrame*, const VideoInfo&, const char*, int, int, int, int) override { unsupported(); }
+  const AVS_Linkage* __stdcall GetAVSLinkage() override { unsupported(); }
+  AVSValue __stdcall GetVarDef(const char*, const AVSValue&) override { unsupported(); }
+
+  // interface 8 and 9
+  PVideoFrame __stdcall SubframePlanarA(PVideoFrame, int, int, int, int, int, int, int, int) override { unsupported(); }
+  void __stdcall copyFrameProps(const PVideoFrame&, PVideoFrame&) override { unsupported(); }
+  const AVSMap* __stdcall getFramePropsRO(const PVideoFrame&) override { unsupported(); }
+  AVSMap* __stdcall getFramePropsRW(PVideoFrame&) override { unsupported(); }
+  int __stdcall propNumKeys(const AVSMap*) override { unsupported(); }
+  const char* __stdcall propGetKey(const AVSMap*, int) override { unsupported(); }
+  int __stdcall propNumElements(const AVSMap*, const char*) override { unsupported(); }
+  char __stdcall propGetType(const AVSMap*, const char*) override { unsupported(); }
+  int64_t __stdcall propGetInt(const AVSMap*, const char*, int, int*) override { unsupported(); }
+  double __stdcall propGetFloat(const AVSMap*, const char*, int, int*) override { unsupported(); }
+  const char* __stdcall propGetData(const AVSMap*, const char*, int, int*) override { unsupported(); }
+  int __stdcall propGetDataSize(const AVSMap*, const char*, int, int*) override { unsupported(); }
+  PClip __stdcall propGetClip(const AVSMap*, const char*, int, int*) override { unsupported(); }
+  const PVideoFrame __stdcall propGetFrame(const AVSMap*, const char*, int, int*) override { unsupported(); }
+  int __stdcall propDeleteKey(AVSMap*, const char*) override { unsupported(); }
+  int __stdcall propSetInt(AVSMap*, const char*, int64_t, int) override { unsupported(); }
+  int __stdcall propSetFloat(AVSMap*, const char*, double, int) override { unsupported(); }
+  int __stdcall propSetData(AVSMap*, const char*, const char*, int, int) override { unsupported(); }
+  int __stdcall propSetClip(AVSMap*, const char*, PClip&, int) override { unsupported(); }
+  int __stdcall propSetFrame(AVSMap*, const char*, const PVideoFrame&, int) override { unsupported(); }
+  const int64_t* __stdcall propGetIntArray(const AVSMap*, const char*, int*) override { unsupported(); }
+  const double* __stdcall propGetFloatArray(const AVSMap*, const char*, int*) override { unsupported(); }
+  int __stdcall propSetIntArray(AVSMap*, const char*, const int64_t*, int) override { unsupported(); }
+  int __stdcall propSetFloatArray(AVSMap*, const char*, const double*, int) override { unsupported(); }
+  AVSMap* __stdcall createMap() override { unsupported(); }
+  void __stdcall freeMap(AVSMap*) override { unsupported(); }
+  void __stdcall clearMap(AVSMap*) override { unsupported(); }
+  PVideoFrame __stdcall NewVideoFrameP(const VideoInfo&, const PVideoFrame*, int) override { unsupported(); }
+  size_t __stdcall GetEnvProperty(AvsEnvProperty) override { unsupported(); }
+  void* __stdcall Allocate(size_t, size_t, AvsAllocType) override { unsupported(); }
+  void __stdcall Free(void*) override { unsupported(); }
+  bool __stdcall GetVarTry(const char*, AVSValue*) const override { unsupported(); }
+  bool __stdcall GetVarBool(const char*, bool) const override { unsupported(); }
+  int __stdcall GetVarInt(const char*, int) const override { unsupported(); }
+  double __stdcall GetVarDouble(const char*, double) const override { unsupported(); }
+  const char* __stdcall GetVarString(const char*, const char*) const override { unsupported(); }
+  int64_t __stdcall GetVarLong(const char*, int64_t) const override { unsupported(); }
+  bool __stdcall InvokeTry(AVSValue*, const char*, const AVSValue&, const char* const*) override { unsupported(); }
+  AVSValue __stdcall Invoke2(const AVSValue&, const char*, const AVSValue, const char* const*) override { unsupported(); }
+  bool __stdcall Invoke2Try(AVSValue*, const AVSValue&, const char*, const AVSValue, const char* const*) override { unsupported(); }
+  AVSValue __stdcall Invoke3(const AVSValue&, const PFunction&, const AVSValue, const char* const*) override { unsupported(); }
+  bool __stdcall Invoke3Try(AVSValue*, const AVSValue&, const PFunction&, const AVSValue, const char* const*) override { unsupported(); }
+  bool __stdcall MakePropertyWritable(PVideoFrame*) override { unsupported(); }
+};
+
+}
+
+IScriptEnvironment* bench_env() {
+  static BenchEnvironment env;
+  return &env;
+}
@@ -0,0 +1,80 @@
+#include "bench.h"
+#include "vertical_cleaner.h"
+#include "inplace.h"
+
+namespace vcleaner {
+
+extern VCleanerProcessor* c_functions[];
+extern VCleanerProcessor* c_functions_10[];
+extern VCleanerProcessor* c_functions_12[];
+extern VCleanerProcessor* c_functions_14[];
+extern VCleanerProcessor* c_functions_16[];
+extern VCleanerProcessor* c_functions_32[];
+extern VCleanerProcessor* sse2_functions[];
+extern VCleanerProcessor* sse4_functions_uint16_10[];
+extern VCleanerProcessor* sse4_functions_uint16_12[];
+extern VCleanerProcessor* sse4_functions_uint16_14[];
+extern VCleanerProcessor* sse4_functions_uint16_16[];
+extern VCleanerProcessor* sse2_functions_32[];
+extern VCleanerProcessor* avx2_functions[];
+extern VCleanerProcessor* avx2_functions_uint16_10[];
+extern VCleanerProcessor* avx2_functions_uint16_12[];
+extern VCleanerProcessor* avx2_functions_uint16_14[];
+extern VCleanerProcessor* avx2_functions_uint16_16[];
+extern VCleanerProcessor* avx2_functions_32[];
+extern VCleanerProcessor* avx2_fma_functions_32[];
+extern VCleanerProcessor* avx512_functions[];
+extern VCleanerProcessor* avx512_functions_uint16_10[];
+extern VCleanerProcessor* avx512_functions_uint16_12[];
+extern VCleanerProcessor* avx512_functions_uint16_14[];
+extern VCleanerProcessor* avx512_functions_uint16_16[];
+extern VCleanerProcessor* avx512_functions_32[];
+
+}
+using namespace vcleaner;
+
+void add_vertical_cleaner_kernels(std::vector<BenchKernel> &kernels) {
+  struct { const char *name; VCleanerProcessor **table; int bits; int isa; } tables[] = {
+    { "c_functions", c_functions, 8, BENCH_C },
+    { "c_functions_10", c_functions_10, 10, BENCH_C },
+    { "c_functions_12", c_functions_12, 12, BENCH_C },
+    { "c_functions_14", c_functions_14, 14, BENCH_C },
+    { "c_functions_16", c_functions_16, 16, BENCH_C },
+    { "c_functions_32", c_functions_32, 32, BENCH_C },
+    { "sse2_functions", sse2_functions, 8, BENCH_SSE2 },
+    { "sse4_functions_uint16_10", sse4_functions_uint16_10, 10, BENCH_SSE4 },
+    { "sse4_functions_uint16_12", sse4_functions_uint16_12, 12, BENCH_SSE4 },
+    { "sse4_functions_uint16_14", sse4_functions_uint16_14, 14, BENCH_SSE4 },
+    { "sse4_functions_uint16_16", sse4_functions_uint16_16, 16, BENCH_SSE4 },
+    { "sse2_functions_32", sse2_functions_32, 32, BENCH_SSE2 },
+    { "avx2_functions", avx2_functions, 8, BENCH_AVX2 },
+    { "avx2_functions_uint16_10", avx2_functions_uint16_10, 10, BENCH_AVX2 },
+    { "avx2_functions_uint16_12", avx2_functions_uint16_12, 12, BENCH_AVX2 },
+    { "avx2_functions_uint16_14", avx2_functions_uint16_14, 14, BENCH_AVX2 },
+    { "avx2_functions_uint16_16", avx2_functions_uint16_16, 16, BENCH_AVX2 },
+    { "avx2_functions_32", avx2_functions_32, 32, BENCH_AVX2 },
+    { "avx2_fma_functions_32", avx2_fma_functions_32, 32, BENCH_FMA },
+    { "avx512_functions", avx512_functions, 8, BENCH_AVX512 },
+    { "avx512_functions_uint16_10", avx512_functions_uint16_10, 10, BENCH_AVX512 },
+    { "avx512_functions_uint16_12", avx512_functions_uint16_12, 12, BENCH_AVX512 },
+    { "avx512_functions_uint16_14", avx512_functions_uint16_14, 14, BENCH_AVX512 },
+    { "avx512_functions_uint16_16", avx512_functions_uint16_16, 16, BENCH_AVX512 },
+    { "avx512_functions_32", avx512_functions_32, 32, BENCH_AVX512 },
+  };
+
+  for (auto &t : tables) {
+    if (!bench_cpu_supports(t.isa))
+      continue;
+    for (int mode = 0; mode <= 2; ++mode) {
+      VCleanerProcessor *processor = t.table[mode + 1];
+      kernels.push_back({ "VerticalCleaner", t.name, mode, t.bits, 1, [processor](BenchFrame &f, IScriptEnvironment *env) {
+        processor(f.dst.ptr(), f.in[0].ptr(), f.dst.pitch(), f.in[0].pitch(), f.rowsize(), f.height, env);
+      }, [processor, mode](BenchFrame &f, IScriptEnvironment *env) {
+        const int rowsize = f.rowsize();
+        process_plane_inplace(f.dst.ptr(), f.dst.pitch(), rowsize, f.height, mode == 2 ? 2 : 1, [&](int, int h, const Byte* pWindow, int windowPitch, Byte* pRows, int pitch) {
+          processor(pRows, pWindow, pitch, windowPitch, rowsize, h, env);
+        });
+      } });
+    }
+  }
+}
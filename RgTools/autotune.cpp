@@ -0,0 +1,88 @@
+#include "autotune.h"
+#include <chrono>
+#include <cstdio>
+#include <mutex>
+
+TunePlane::TunePlane(int rowsize, int height, int bits_per_pixel, unsigned seed)
+  : pitch_((rowsize + 63) / 64 * 64 + 64), rowsize_(rowsize), height_(height) {
+  buffer_.resize((size_t)pitch_ * height + 64);
+  data_ = buffer_.data() + ((64 - ((uintptr_t)buffer_.data() & 63)) & 63);
+
+  // xorshift noise, full range at 8 bit, masked to the bit depth at 16 bit, 0..1 for float
+  unsigned x = 2463534242u + seed;
+  for (int y = 0; y < height; ++y) {
+    BYTE *row = data_ + (size_t)y * pitch_;
+    for (int i = 0; i < rowsize; i += bits_per_pixel == 8 ? 1 : bits_per_pixel == 32 ? 4 : 2) {
+      x ^= x << 13; x ^= x >> 17; x ^= x << 5;
+      if (bits_per_pixel == 8)
+        row[i] = (BYTE)x;
+      else if (bits_per_pixel == 32)
+        *reinterpret_cast<float*>(row + i) = (x >> 8) * (1.0f / 16777216.0f);
+      else
+        *reinterpret_cast<uint16_t*>(row + i) = (uint16_t)(x & ((1u << bits_per_pixel) - 1));
+    }
+  }
+}
+
+bool TunePlane::same_as(const TunePlane &other) const {
+  for (int y = 0; y < height_; ++y) {
+    if (memcmp(data_ + (size_t)y * pitch_, other.data_ + (size_t)y * other.pitch_, rowsize_) != 0)
+      return false;
+  }
+  return true;
+}
+
+double autotune_time(const std::function<void()> &run, double best_so_far) {
+  typedef std::chrono::steady_clock clock;
+  const int runs = 5;
+
+  double best = 0;
+  for (int i = 0; i < runs; ++i) {
+    auto start = clock::now();
+    run();
+    const double t = std::chrono::duration<double>(clock::now() - start).count();
+    if (i == 0 || t < best)
+      best = t;
+    if (best_so_far > 0 && best > 2 * best_so_far)
+      break;
+  }
+  return best;
+}
+
+// filters are created from several script threads
+static std::mutex cache_lock;
+
+std::string autotune_cache_lookup(const char *path, const std::string &key) {
+  if (path == nullptr || path[0] == 0)
+    return "";
+
+  std::lock_guard<std::mutex> guard(cache_lock);
+  FILE *f = fopen(path, "r");
+  if (f == nullptr)
+    return "";
+
+  // the last line of a key wins
+  std::string found;
+  char line[512];
+  while (fgets(line, sizeof(line), f) != nullptr) {
+    std::string s(line);
+    while (!s.empty() && (s.back() == '\n' || s.back() == '\r'))
+      s.pop_back();
+    if (s.size() > key.size() && s[key.size()] == '=' && s.compare(0, key.size(), key) == 0)
+      found = s.substr(key.size() + 1);
+  }
+  fclose(f);
+  return found;
+}
+
+void autotune_cache_store(const char *path, const std::string &key, const std::string &name) {
+  if (path == nullptr || path[0] == 0)
+    return;
+
+  std::lock_guard<std::mutex> guard(cache_lock);
+  FILE *f = fopen(path, "a");
+  if (f == nullptr)
+    return; // read only location, tuning still works
+  fprintf(f, "%s=%s\n", key.c_str(), name.c_str());
+  fclose(f);
+}
@@ -0,0 +1,110 @@
+#ifndef __AUTOTUNE_H__
+#define __AUTOTUNE_H__
+
+#include "common.h"
+#include <cstdio>
+#include <functional>
+#include <string>
+#include <vector>
+
+// CPUF_* flags detected with CPUID/XGETBV, independent of what the host reports
+int cpu_detect_flags();
+// CPUID brand string, key of the autotune cache
+std::string cpu_model_name();
+
+// A function table the CPU can run, candidate of the autotuner
+template<typename Processor>
+struct TuneCandidate {
+  const char *name;
+  Processor **table;
+};
+
+// Name of the candidate 'table' is, or whose entry for 'mode' it holds (autotuned copies), "" if none
+template<typename Processor>
+const char* tune_candidate_name(const std::vector<TuneCandidate<Processor>> &candidates, Processor **table, int mode) {
+  for (auto &c : candidates) {
+    if (c.table == table)
+      return c.name;
+  }
+  for (auto &c : candidates) {
+    if (c.table[mode + 1] == table[mode + 1])
+      return c.name;
+  }
+  return "";
+}
+
+// Noise filled plane for timing the candidates, 64 byte aligned rows like a frame
+class TunePlane {
+public:
+  TunePlane(int rowsize, int height, int bits_per_pixel, unsigned seed);
+
+  BYTE* ptr() { return data_; }
+  int pitch() const { return pitch_; }
+  // compares rowsize bytes of every row
+  bool same_as(const TunePlane &other) const;
+
+private:
+  std::vector<BYTE> buffer_;
+  BYTE *data_;
+  int pitch_;
+  int rowsize_;
+  int height_;
+};
+
+// Best time of a few runs in seconds. Gives up after the first run when it is more than twice 'best_so_far'.
+double autotune_time(const std::function<void()> &run, double best_so_far);
+
+// Text cache of decisions, one "key=name" line each. Empty path: no cache. Lookup returns "" when not found.
+std::string autotune_cache_lookup(const char *path, const std::string &key);
+void autotune_cache_store(const char *path, const std::string &key, const std::string &name);
+
+// Picks the fastest candidate for one mode and plane size. The output of 'reference' (the table chosen
+// without autotune) on a noise plane is computed first, candidates that do not reproduce it exactly are
+// never picked, so autotune changes the speed but not the result.
+// run(table, in, dst) processes the 'inputs' noise planes in 'in' into 'dst' with table[mode + 1].
+template<typename Processor>
+Processor** autotune_pick(const std::vector<TuneCandidate<Processor>> &candidates, Processor **reference, const std::string &key,
+  int rowsize, int height, int bits_per_pixel, int inputs, const char *cache_path,
+  const std::function<void(Processor **table, std::vector<TunePlane> &in, TunePlane &dst)> &run) {
+  const std::string cached = autotune_cache_lookup(cache_path, key);
+  if (!cached.empty()) {
+    for (auto &c : candidates) {
+      if (cached == c.name)
+        return c.table;
+    }
+  }
+
+  std::vector<TunePlane> in;
+  for (int i = 0; i < inputs; ++i)
+    in.emplace_back(rowsize, height, bits_per_pixel, i + 1);
+  TunePlane expected(rowsize, height, bits_per_pixel, 0);
+  TunePlane dst(rowsize, height, bits_per_pixel, 0);
+  run(reference, in, expected);
+
+  Processor **best = reference;
+  const char *best_name = nullptr; // stays null when no candidate has the reference table
+  double best_time = autotune_time([&] { run(reference, in, dst); }, 0);
+
+  for (auto &c : candidates) {
+    if (c.table == reference) {
+      if (best == reference)
+        best_name = c.name;
+      continue;
+    }
+    run(c.table, in, dst);
+    if (!dst.same_as(expected))
+      continue;
+    const double t = autotune_time([&] { run(c.table, in, dst); }, best_time);
+    if (t < best_time) {
+      best = c.table;
+      best_name = c.name;
+      best_time = t;
+    }
+  }
+
+  if (best_name != nullptr)
+    autotune_cache_store(cache_path, key, best_name);
+  return best;
+}
+
+#endif
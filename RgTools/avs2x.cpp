@@ -2,6 +2,11 @@
 #include "clense.h"
 #include "repair.h"
 #include "vertical_cleaner.h"
+#include "rgrepair.h"
+#include "clenserg.h"
+#include "median_of_clips.h"
+#include "profile.h"
+#include "benchmark.h"
 
 
 
@@ -10,11 +15,18 @@ const AVS_Linkage *AVS_linkage = nullptr;
 extern "C" __declspec(dllexport) const char* __stdcall AvisynthPluginInit3(IScriptEnvironment* env, const AVS_Linkage* const vectors) {
     AVS_linkage = vectors;
 
-    env->AddFunction("RemoveGrain", "c[mode]i[modeU]i[modeV]i[planar]b[optavx2]b", Create_RemoveGrain, 0);
-    env->AddFunction("Repair", "cc[mode]i[modeU]i[modeV]i[planar]b", Create_Repair, 0);
-    env->AddFunction("Clense", "c[previous]c[next]c[grey]b[reduceflicker]b[planar]b[cache]i", Create_Clense, 0);
-    env->AddFunction("ForwardClense", "c[grey]b[planar]b[cache]i", Create_ForwardClense, 0);
-    env->AddFunction("BackwardClense", "c[grey]b[planar]b[cache]i", Create_BackwardClense, 0);
-    env->AddFunction("VerticalCleaner", "c[mode]i[modeU]i[modeV]i[planar]b", Create_VerticalCleaner, 0);
+    env->AddFunction("RemoveGrain", "c[mode]i[modeU]i[modeV]i[planar]b[optavx2]b[threads]i[autotune]b[tunecache]s[profile]b", Create_RemoveGrain, 0);
+    env->AddFunction("Repair", "cc[mode]i[modeU]i[modeV]i[planar]b[optavx2]b[threads]i[autotune]b[tunecache]s[profile]b", Create_Repair, 0);
+    // clip arrays ("c+") work only as unnamed trailing arguments, like MedianOfClips' clips. Optional named
+    // ones are not supported, so previous and next of Clense radius 2-4 are single clips for all frames on their side
+    env->AddFunction("Clense", "c[previous]c[next]c[grey]b[reduceflicker]b[planar]b[cache]i[optavx2]b[threads]i[profile]b[radius]i[batch]i", Create_Clense, 0);
+    env->AddFunction("ForwardClense", "c[grey]b[planar]b[cache]i[optavx2]b[threads]i[profile]b[batch]i", Create_ForwardClense, 0);
+    env->AddFunction("BackwardClense", "c[grey]b[planar]b[cache]i[optavx2]b[threads]i[profile]b[batch]i", Create_BackwardClense, 0);
+    env->AddFunction("VerticalCleaner", "c[mode]i[modeU]i[modeV]i[planar]b[optavx2]b[threads]i[profile]b", Create_VerticalCleaner, 0);
+    env->AddFunction("RGRepair", "c[rgmode]i[repmode]i[planar]b[optavx2]b[threads]i[profile]b", Create_RGRepair, 0);
+    env->AddFunction("ClenseRG", "c[mode]i[planar]b[optavx2]b[threads]i[profile]b", Create_ClenseRG, 0);
+    env->AddFunction("MedianOfClips", "c+[rank]i[planar]b[optavx2]b[threads]i[profile]b", Create_MedianOfClips, 0);
+    env->AddFunction("RgToolsStats", "[log]s", Create_RgToolsStats, 0);
+    env->AddFunction("RgBench", "c[filter]s[mode]i[frames]i[threads]i[optavx2]b[autotune]b[ref]c[repmode]i", Create_RgBench, 0);
     return "Itai, onii-chan!";
 }
@@ -0,0 +1,117 @@
+#include "benchmark.h"
+#include "removegrain.h"
+#include "repair.h"
+#include "clense.h"
+#include "vertical_cleaner.h"
+#include "rgrepair.h"
+#include "clenserg.h"
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// Source frames held in memory, the timed loop does not include the decoder and the filters before.
+// Frames outside the cached range get the first or last one (Clense reads n-1 and n+1).
+class FrameCache : public GenericVideoFilter {
+public:
+  FrameCache(PClip child, int frames, IScriptEnvironment* env) : GenericVideoFilter(child) {
+    vi.num_frames = frames;
+    frames_.reserve(frames);
+    for (int n = 0; n < frames; ++n)
+      frames_.push_back(child->GetFrame(n, env));
+  }
+
+  PVideoFrame __stdcall GetFrame(int n, IScriptEnvironment*) override {
+    return frames_[std::min(std::max(n, 0), vi.num_frames - 1)];
+  }
+
+private:
+  std::vector<PVideoFrame> frames_;
+};
+
+// script function names are case insensitive
+static bool same_name(const char *a, const char *b) {
+  for (; *a != 0 && *b != 0; ++a, ++b) {
+    if (tolower((unsigned char)*a) != tolower((unsigned char)*b))
+      return false;
+  }
+  return *a == *b;
+}
+
+AVSValue __cdecl Create_RgBench(AVSValue args, void*, IScriptEnvironment* env) {
+  enum { CLIP, FILTER, MODE, FRAMES, THREADS, OPTAVX2, AUTOTUNE, REF, REPMODE };
+  typedef std::chrono::steady_clock clock;
+
+  PClip clip = args[CLIP].AsClip();
+  const char *filter = args[FILTER].AsString("RemoveGrain");
+  const int mode = args[MODE].AsInt(1);
+  const int threads = args[THREADS].AsInt(1);
+  const bool use_avx2 = args[OPTAVX2].AsBool(true);
+  const bool autotune = args[AUTOTUNE].AsBool(false);
+  const int frames = std::min(args[FRAMES].AsInt(100), clip->GetVideoInfo().num_frames);
+  if (frames < 1) {
+    env->ThrowError("RgBench: frames must be positive!");
+  }
+
+  // the filter is created directly on the cache, no host cache between it and the timing loop
+  PClip source = new FrameCache(clip, frames, env);
+  PClip tested;
+  FilterProfile *profile = nullptr;
+  const int ud = RemoveGrain::UNDEFINED_MODE;
+
+  if (same_name(filter, "RemoveGrain")) {
+    auto f = new RemoveGrain(source, mode, ud, ud, false, use_avx2, threads, autotune, "", true, env);
+    tested = f;
+    profile = f->profile();
+  }
+  else if (same_name(filter, "Repair")) {
+    PClip ref = args[REF].Defined() ? PClip(new FrameCache(args[REF].AsClip(), frames, env)) : source;
+    auto f = new Repair(source, ref, mode, ud, ud, false, use_avx2, threads, autotune, "", true, env);
+    tested = f;
+    profile = f->profile();
+  }
+  else if (same_name(filter, "RGRepair")) {
+    auto f = new RGRepair(source, mode, args[REPMODE].AsInt(1), false, use_avx2, threads, true, env);
+    tested = f;
+    profile = f->profile();
+  }
+  else if (same_name(filter, "ClenseRG")) {
+    auto f = new ClenseRG(source, mode, false, use_avx2, threads, true, env);
+    tested = f;
+    profile = f->profile();
+  }
+  else if (same_name(filter, "VerticalCleaner")) {
+    auto f = new VerticalCleaner(source, mode, ud, ud, false, use_avx2, threads, true, env);
+    tested = f;
+    profile = f->profile();
+  }
+  else if (same_name(filter, "Clense") || same_name(filter, "ForwardClense") || same_name(filter, "BackwardClense")) {
+    const ClenseMode clense_mode = same_name(filter, "Clense") ? ClenseMode::BOTH : same_name(filter, "ForwardClense") ? ClenseMode::FORWARD : ClenseMode::BACKWARD;
+    auto f = new Clense(source, nullptr, nullptr, 1, 1, false, false, clense_mode, false, use_avx2, threads, true, env);
+    tested = f;
+    profile = f->profile();
+  }
+  else {
+    env->ThrowError("RgBench: unknown filter %s, expected RemoveGrain, Repair, RGRepair, ClenseRG, VerticalCleaner, Clense, ForwardClense or BackwardClense", filter);
+  }
+
+  // thread pool start and first frame allocations are not timed
+  tested->GetFrame(std::min(1, frames - 1), env);
+  profile->reset();
+
+  const auto start = clock::now();
+  for (int n = 0; n < frames; ++n)
+    tested->GetFrame(n, env);
+  const double seconds = std::chrono::duration<double>(clock::now() - start).count();
+
+  const VideoInfo &vi = source->GetVideoInfo();
+  char head[512];
+  snprintf(head, sizeof(head), "RgBench %s mode=%d threads=%d optAvx2=%s%s, %dx%d, %d bit, %d frames\n"
+    "  %.1f ms, %.1f fps, %.1f Mpix/s\n",
+    filter, mode, threads, use_avx2 ? "true" : "false", autotune ? " autotune" : "", vi.width, vi.height, vi.BitsPerComponent(), frames,
+    seconds * 1000, frames / seconds, (double)vi.width * vi.height * frames / seconds / 1e6);
+
+  const std::string report = head + profile->plane_report();
+  return AVSValue(env->SaveString(report.c_str()));
+}
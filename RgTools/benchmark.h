@@ -0,0 +1,10 @@
+#ifndef __BENCHMARK_H__
+#define __BENCHMARK_H__
+
+#include "common.h"
+
+// RgBench(clip, "RemoveGrain", mode=17, frames=500, threads=8): times one filter on frames cached in memory
+// when the script is loaded, returns the report as a string
+AVSValue __cdecl Create_RgBench(AVSValue args, void*, IScriptEnvironment* env);
+
+#endif
@@ -1,5 +1,7 @@
 #include "clense.h"
-#include <xutility>
+#include "clense_median.h"
+#include "colsort.h"
+#include <algorithm>
 
 static void check_if_match(const VideoInfo &vi, const VideoInfo &otherVi, IScriptEnvironment* env) {
     if (otherVi.height != vi.height || otherVi.width != vi.width) {
@@ -74,53 +76,57 @@ static void process_plane_c(Byte* pDst, const Byte *pSrc, const Byte* pRef1, con
     }
 }
 
+template<bool aligned>
 RG_FORCEINLINE void clense_process_line_sse2(Byte* pDst, const Byte *pSrc, const Byte* pRef1, const Byte* pRef2, int rowsize) {
     for (int x = 0; x < rowsize; x+=16) {
-        auto src = _mm_load_si128(reinterpret_cast<const __m128i*>(pSrc+x));
-        auto ref1 = _mm_load_si128(reinterpret_cast<const __m128i*>(pRef1+x));
-        auto ref2 = _mm_load_si128(reinterpret_cast<const __m128i*>(pRef2+x));
+        auto src = simd_load_si128<aligned>(pSrc+x);
+        auto ref1 = simd_load_si128<aligned>(pRef1+x);
+        auto ref2 = simd_load_si128<aligned>(pRef2+x);
 
         auto minref = _mm_min_epu8(ref1, ref2);
         auto maxref = _mm_max_epu8(ref1, ref2);
         auto dst = simd_clip(src, minref, maxref);
 
-        _mm_store_si128(reinterpret_cast<__m128i*>(pDst+x), dst);
+        simd_store_si128<aligned>(pDst+x, dst);
     }
 }
 
+template<bool aligned>
 RG_FORCEINLINE void clense_process_line_sse4_16(Byte* pDst, const Byte *pSrc, const Byte* pRef1, const Byte* pRef2, int rowsize) {
   for (int x = 0; x < rowsize; x+=16) {
-    auto src = _mm_load_si128(reinterpret_cast<const __m128i*>(pSrc+x));
-    auto ref1 = _mm_load_si128(reinterpret_cast<const __m128i*>(pRef1+x));
-    auto ref2 = _mm_load_si128(reinterpret_cast<const __m128i*>(pRef2+x));
+    auto src = simd_load_si128<aligned>(pSrc+x);
+    auto ref1 = simd_load_si128<aligned>(pRef1+x);
+    auto ref2 = simd_load_si128<aligned>(pRef2+x);
 
     auto minref = _mm_min_epu16(ref1, ref2);
     auto maxref = _mm_max_epu16(ref1, ref2);
     auto dst = simd_clip_16(src, minref, maxref);
 
-    _mm_store_si128(reinterpret_cast<__m128i*>(pDst+x), dst);
+    simd_store_si128<aligned>(pDst+x, dst);
   }
 }
 
+template<bool aligned>
 RG_FORCEINLINE void clense_process_line_sse2_32(Byte* pDst, const Byte *pSrc, const Byte* pRef1, const Byte* pRef2, int rowsize) {
   for (int x = 0; x < rowsize; x+=16) {
-    auto src = _mm_load_ps(reinterpret_cast<const float*>(pSrc+x));
-    auto ref1 = _mm_load_ps(reinterpret_cast<const float*>(pRef1+x));
-    auto ref2 = _mm_load_ps(reinterpret_cast<const float*>(pRef2+x));
+    auto src = simd_load_ps<aligned>(pSrc+x);
+    auto ref1 = simd_load_ps<aligned>(pRef1+x);
+    auto ref2 = simd_load_ps<aligned>(pRef2+x);
 
     auto minref = _mm_min_ps(ref1, ref2);
     auto maxref = _mm_max_ps(ref1, ref2);
     auto dst = simd_clip_32(src, minref, maxref);
 
-    _mm_store_ps(reinterpret_cast<float*>(pDst+x), dst);
+    simd_store_ps<aligned>(pDst+x, dst);
   }
 }
 
+template<bool aligned>
 RG_FORCEINLINE void sclense_process_line_sse2(Byte* pDst, const Byte *pSrc, const Byte* pRef1, const Byte* pRef2, int rowsize) {
     for (int x = 0; x < rowsize; x+=16) {
-        auto src = _mm_load_si128(reinterpret_cast<const __m128i*>(pSrc+x));
-        auto ref1 = _mm_load_si128(reinterpret_cast<const __m128i*>(pRef1+x));
-        auto ref2 = _mm_load_si128(reinterpret_cast<const __m128i*>(pRef2+x));
+        auto src = simd_load_si128<aligned>(pSrc+x);
+        auto ref1 = simd_load_si128<aligned>(pRef1+x);
+        auto ref2 = simd_load_si128<aligned>(pRef2+x);
 
         auto minref = _mm_min_epu8(ref1, ref2);
         auto maxref = _mm_max_epu8(ref1, ref2);
@@ -133,18 +139,18 @@ RG_FORCEINLINE void sclense_process_line_sse2(Byte* pDst, const Byte *pSrc, cons
 
         auto dst = simd_clip(src, mi, ma);
 
-        _mm_store_si128(reinterpret_cast<__m128i*>(pDst+x), dst);
+        simd_store_si128<aligned>(pDst+x, dst);
     }
 }
 
-template<int bits_per_pixel>
+template<int bits_per_pixel, bool aligned>
 RG_FORCEINLINE void sclense_process_line_sse4_16(Byte* pDst, const Byte *pSrc, const Byte* pRef1, const Byte* pRef2, int rowsize) {
   const __m128i pixel_max = _mm_set1_epi16(bits_per_pixel < 16 ? (1 << bits_per_pixel) - 1 : 0); // anti warning 65535 (not used) vs short
 
   for (int x = 0; x < rowsize; x+=16) {
-    auto src = _mm_load_si128(reinterpret_cast<const __m128i*>(pSrc+x));
-    auto ref1 = _mm_load_si128(reinterpret_cast<const __m128i*>(pRef1+x));
-    auto ref2 = _mm_load_si128(reinterpret_cast<const __m128i*>(pRef2+x));
+    auto src = simd_load_si128<aligned>(pSrc+x);
+    auto ref1 = simd_load_si128<aligned>(pRef1+x);
+    auto ref2 = simd_load_si128<aligned>(pRef2+x);
 
     auto minref = _mm_min_epu16(ref1, ref2);
     auto maxref = _mm_max_epu16(ref1, ref2);
@@ -160,11 +166,12 @@ RG_FORCEINLINE void sclense_process_line_sse4_16(Byte* pDst, const Byte *pSrc, c
 
     auto dst = simd_clip_16(src, mi, ma);
 
-    _mm_store_si128(reinterpret_cast<__m128i*>(pDst+x), dst);
+    simd_store_si128<aligned>(pDst+x, dst);
   }
 }
 
 //template<bool chroma>
+template<bool aligned>
 RG_FORCEINLINE void sclense_process_line_sse2_32(Byte* pDst, const Byte *pSrc, const Byte* pRef1, const Byte* pRef2, int rowsize) {
 #if 0
   // no max_pixel_value clamp for float
@@ -179,9 +186,9 @@ RG_FORCEINLINE void sclense_process_line_sse2_32(Byte* pDst, const Byte *pSrc, c
   const __m128 pixel_max_128 = _mm_set1_ps(pixel_max);
 #endif
   for (int x = 0; x < rowsize; x+=16) {
-    auto src = _mm_load_ps(reinterpret_cast<const float*>(pSrc+x));
-    auto ref1 = _mm_load_ps(reinterpret_cast<const float*>(pRef1+x));
-    auto ref2 = _mm_load_ps(reinterpret_cast<const float*>(pRef2+x));
+    auto src = simd_load_ps<aligned>(pSrc+x);
+    auto ref1 = simd_load_ps<aligned>(pRef1+x);
+    auto ref2 = simd_load_ps<aligned>(pRef2+x);
 
     auto minref = _mm_min_ps(ref1, ref2);
     auto maxref = _mm_max_ps(ref1, ref2);
@@ -195,22 +202,27 @@ RG_FORCEINLINE void sclense_process_line_sse2_32(Byte* pDst, const Byte *pSrc, c
 
     auto dst = simd_clip_32(src, mi, ma);
 
-    _mm_store_ps(reinterpret_cast<float*>(pDst+x), dst);
+    simd_store_ps<aligned>(pDst+x, dst);
   }
 }
 
-template<decltype(clense_process_line_sse2) processor>
+// rowsize must be at least 16, checked in Clense constructor
+template<decltype(clense_process_line_sse2<true>) processor, decltype(clense_process_line_sse2<true>) processor_ua>
 void process_plane_sse(Byte* pDst, const Byte *pSrc, const Byte* pRef1, const Byte* pRef2, int dstPitch, int srcPitch, int ref1Pitch, int ref2Pitch, int rowsize, int height, IScriptEnvironment *env) {
-    if (!is_16byte_aligned(pSrc) || !is_16byte_aligned(pRef1) || !is_16byte_aligned(pRef2)) {
-        env->ThrowError("Invalid memory alignment. Used unaligned crop?"); //omg I feel so dumb
-    }
+    // unaligned crop: unaligned loads and stores for the whole plane
+    const bool aligned = is_16byte_aligned_plane(pDst, dstPitch) && is_16byte_aligned_plane(pSrc, srcPitch) &&
+      is_16byte_aligned_plane(pRef1, ref1Pitch) && is_16byte_aligned_plane(pRef2, ref2Pitch);
     auto mod16Width = (rowsize / 16) * 16;
 
     for (int y = 0; y < height; ++y) {
-        processor(pDst, pSrc, pRef1, pRef2, mod16Width);
+        if (aligned)
+            processor(pDst, pSrc, pRef1, pRef2, mod16Width);
+        else
+            processor_ua(pDst, pSrc, pRef1, pRef2, mod16Width);
 
         if (mod16Width != rowsize) {
-            processor(pDst + mod16Width, pSrc + mod16Width, pRef1 + mod16Width, pRef2 + mod16Width, 16);
+            // last 16 bytes, overlaps with the already processed part
+            processor_ua(pDst + rowsize - 16, pSrc + rowsize - 16, pRef1 + rowsize - 16, pRef2 + rowsize - 16, 16);
         }
         pDst += dstPitch;
         pSrc += srcPitch;
@@ -219,8 +231,171 @@ void process_plane_sse(Byte* pDst, const Byte *pSrc, const Byte* pRef1, const By
     }
 }
 
-Clense::Clense(PClip child, PClip previous, PClip next, bool grey, bool reduceflicker, ClenseMode mode, bool skip_cs_check, IScriptEnvironment* env)
-    : GenericVideoFilter(child), previous_(previous), next_(next), grey_(grey), mode_(mode), reduceflicker_(reduceflicker) {
+// 8, 10, 12, 14, 16 bits and float, same layout as the AVX2 tables
+ClenseProcessor* c_clense_functions[] = {
+  process_plane_c<uint8_t, clense_process_pixel_c>,
+  process_plane_c<uint16_t, clense_process_pixel_c_16>,
+  process_plane_c<uint16_t, clense_process_pixel_c_16>,
+  process_plane_c<uint16_t, clense_process_pixel_c_16>,
+  process_plane_c<uint16_t, clense_process_pixel_c_16>,
+  process_plane_c<float, clense_process_pixel_c_32>
+};
+
+ClenseProcessor* c_sclense_functions[] = {
+  process_plane_c<uint8_t, sclense_process_pixel_c>,
+  process_plane_c<uint16_t, sclense_process_pixel_c_16<10>>,
+  process_plane_c<uint16_t, sclense_process_pixel_c_16<12>>,
+  process_plane_c<uint16_t, sclense_process_pixel_c_16<14>>,
+  process_plane_c<uint16_t, sclense_process_pixel_c_16<16>>,
+  process_plane_c<float, sclense_process_pixel_c_32>
+};
+
+// SSE2 for 8 bit and float, SSE4.1 for 16 bit
+ClenseProcessor* sse_clense_functions[] = {
+  process_plane_sse<clense_process_line_sse2<true>, clense_process_line_sse2<false>>,
+  process_plane_sse<clense_process_line_sse4_16<true>, clense_process_line_sse4_16<false>>,
+  process_plane_sse<clense_process_line_sse4_16<true>, clense_process_line_sse4_16<false>>,
+  process_plane_sse<clense_process_line_sse4_16<true>, clense_process_line_sse4_16<false>>,
+  process_plane_sse<clense_process_line_sse4_16<true>, clense_process_line_sse4_16<false>>,
+  process_plane_sse<clense_process_line_sse2_32<true>, clense_process_line_sse2_32<false>>
+};
+
+ClenseProcessor* sse_sclense_functions[] = {
+  process_plane_sse<sclense_process_line_sse2<true>, sclense_process_line_sse2<false>>,
+  process_plane_sse<sclense_process_line_sse4_16<10, true>, sclense_process_line_sse4_16<10, false>>,
+  process_plane_sse<sclense_process_line_sse4_16<12, true>, sclense_process_line_sse4_16<12, false>>,
+  process_plane_sse<sclense_process_line_sse4_16<14, true>, sclense_process_line_sse4_16<14, false>>,
+  process_plane_sse<sclense_process_line_sse4_16<16, true>, sclense_process_line_sse4_16<16, false>>,
+  process_plane_sse<sclense_process_line_sse2_32<true>, sclense_process_line_sse2_32<false>>
+};
+
+// radius 2, 3, 4 x 8, 10, 12, 14, 16 bits and float
+ClenseMedianProcessor* c_clense_median_functions[][6] = {
+  { clense_median_plane<ClenseScalar<uint8_t>, 5>, clense_median_plane<ClenseScalar<uint16_t>, 5>, clense_median_plane<ClenseScalar<uint16_t>, 5>,
+    clense_median_plane<ClenseScalar<uint16_t>, 5>, clense_median_plane<ClenseScalar<uint16_t>, 5>, clense_median_plane<ClenseScalar<float>, 5> },
+  { clense_median_plane<ClenseScalar<uint8_t>, 7>, clense_median_plane<ClenseScalar<uint16_t>, 7>, clense_median_plane<ClenseScalar<uint16_t>, 7>,
+    clense_median_plane<ClenseScalar<uint16_t>, 7>, clense_median_plane<ClenseScalar<uint16_t>, 7>, clense_median_plane<ClenseScalar<float>, 7> },
+  { clense_median_plane<ClenseScalar<uint8_t>, 9>, clense_median_plane<ClenseScalar<uint16_t>, 9>, clense_median_plane<ClenseScalar<uint16_t>, 9>,
+    clense_median_plane<ClenseScalar<uint16_t>, 9>, clense_median_plane<ClenseScalar<uint16_t>, 9>, clense_median_plane<ClenseScalar<float>, 9> }
+};
+
+// SSE2 for 8 bit and float, SSE4.1 for 16 bit
+ClenseMedianProcessor* sse_clense_median_functions[][6] = {
+  { clense_median_plane<ColsortSse8<SSE2>, 5>, clense_median_plane<ColsortSse16, 5>, clense_median_plane<ColsortSse16, 5>,
+    clense_median_plane<ColsortSse16, 5>, clense_median_plane<ColsortSse16, 5>, clense_median_plane<ColsortSse32, 5> },
+  { clense_median_plane<ColsortSse8<SSE2>, 7>, clense_median_plane<ColsortSse16, 7>, clense_median_plane<ColsortSse16, 7>,
+    clense_median_plane<ColsortSse16, 7>, clense_median_plane<ColsortSse16, 7>, clense_median_plane<ColsortSse32, 7> },
+  { clense_median_plane<ColsortSse8<SSE2>, 9>, clense_median_plane<ColsortSse16, 9>, clense_median_plane<ColsortSse16, 9>,
+    clense_median_plane<ColsortSse16, 9>, clense_median_plane<ColsortSse16, 9>, clense_median_plane<ColsortSse32, 9> }
+};
+
+extern ClenseProcessor* avx2_clense_functions[];
+extern ClenseProcessor* avx2_sclense_functions[];
+extern ClenseProcessor* avx512_clense_functions[];
+extern ClenseProcessor* avx512_sclense_functions[];
+// 8, 10, 12, 14, 16 bits and float
+RankProcessor* c_rank_functions[] = {
+  rank_plane<ClenseScalar<uint8_t>>, rank_plane<ClenseScalar<uint16_t>>, rank_plane<ClenseScalar<uint16_t>>,
+  rank_plane<ClenseScalar<uint16_t>>, rank_plane<ClenseScalar<uint16_t>>, rank_plane<ClenseScalar<float>>
+};
+RankProcessor* sse_rank_functions[] = {
+  rank_plane<ColsortSse8<SSE2>>, rank_plane<ColsortSse16>, rank_plane<ColsortSse16>,
+  rank_plane<ColsortSse16>, rank_plane<ColsortSse16>, rank_plane<ColsortSse32>
+};
+extern RankProcessor* avx2_rank_functions[];
+extern RankProcessor* avx512_rank_functions[];
+extern ClenseMedianProcessor* avx2_clense_median_functions[][6];
+extern ClenseMedianProcessor* avx512_clense_median_functions[][6];
+
+// 8, 10, 12, 14, 16 bits and float
+static int table_index(const VideoInfo &vi) {
+    const int pixelsize = vi.ComponentSize();
+    return pixelsize == 1 ? 0 : pixelsize == 4 ? 5 : (vi.BitsPerComponent() - 8) / 2;
+}
+
+// CPU, bit depth and plane width dependent processor, shared with ClenseRG. both: Clense, else SClense.
+// width: the narrowest plane it runs on. isa (may be nullptr) gets the name of the instruction set
+ClenseProcessor* clense_function(const VideoInfo &vi, int width, bool both, bool use_avx2, const char **isa, IScriptEnvironment* env) {
+    const int pixelsize = vi.ComponentSize();
+    const bool sse2 = width * pixelsize >= 16 && (env->GetCPUFlags() & CPUF_SSE2);
+    const bool sse4 = width * pixelsize >= 16 && (env->GetCPUFlags() & CPUF_SSE4);
+    const bool avx2 = use_avx2 && width * pixelsize >= 32 && (env->GetCPUFlags() & CPUF_AVX2);
+    // AVX-512 rows end with a masked vector, any width
+    const bool avx512 = use_avx2 && (env->GetCPUFlags() & CPUF_AVX2) && cpu_has_avx512bw();
+
+    const int index = table_index(vi);
+    const char *name;
+    ClenseProcessor *processor;
+    if (avx512) {
+      name = "avx512";
+      processor = both ? avx512_clense_functions[index] : avx512_sclense_functions[index];
+    } else if (avx2) {
+      name = "avx2";
+      processor = both ? avx2_clense_functions[index] : avx2_sclense_functions[index];
+    } else if (pixelsize == 2 ? sse4 : sse2) { // 16 bit needs SSE4.1
+      name = pixelsize == 2 ? "sse4" : "sse2";
+      processor = both ? sse_clense_functions[index] : sse_sclense_functions[index];
+    } else {
+      name = "c";
+      processor = both ? c_clense_functions[index] : c_sclense_functions[index];
+    }
+    if (isa != nullptr)
+      *isa = name;
+    return processor;
+}
+
+enum class MedianIsa { C, SSE, AVX2, AVX512 };
+
+// Median and rank tables: rows end with an overlapping vector, the narrowest plane needs a whole one,
+// 64 bytes for AVX-512 too. 16 bit needs SSE4.1
+static MedianIsa median_isa(const VideoInfo &vi, int width, bool use_avx2, const char **isa, IScriptEnvironment* env) {
+    const int pixelsize = vi.ComponentSize();
+    const int bytes = width * pixelsize;
+    const int flags = env->GetCPUFlags();
+    MedianIsa result;
+    const char *name;
+    if (use_avx2 && bytes >= 64 && (flags & CPUF_AVX2) && cpu_has_avx512bw()) {
+      result = MedianIsa::AVX512;
+      name = "avx512";
+    } else if (use_avx2 && bytes >= 32 && (flags & CPUF_AVX2)) {
+      result = MedianIsa::AVX2;
+      name = "avx2";
+    } else if (bytes >= 16 && (flags & (pixelsize == 2 ? CPUF_SSE4 : CPUF_SSE2))) {
+      result = MedianIsa::SSE;
+      name = pixelsize == 2 ? "sse4" : "sse2";
+    } else {
+      result = MedianIsa::C;
+      name = "c";
+    }
+    if (isa != nullptr)
+      *isa = name;
+    return result;
+}
+
+// Clense radius 2-4: median of the 2*radius+1 frames, table and isa like clense_function
+ClenseMedianProcessor* clense_median_function(const VideoInfo &vi, int width, int radius, bool use_avx2, const char **isa, IScriptEnvironment* env) {
+    const int index = table_index(vi);
+    switch (median_isa(vi, width, use_avx2, isa, env)) {
+    case MedianIsa::AVX512: return avx512_clense_median_functions[radius - 2][index];
+    case MedianIsa::AVX2: return avx2_clense_median_functions[radius - 2][index];
+    case MedianIsa::SSE: return sse_clense_median_functions[radius - 2][index];
+    default: return c_clense_median_functions[radius - 2][index];
+    }
+}
+
+// MedianOfClips: value of any rank of up to RANK_MAX_PLANES planes, same instruction set as the median
+RankProcessor* rank_function(const VideoInfo &vi, int width, bool use_avx2, const char **isa, IScriptEnvironment* env) {
+    const int index = table_index(vi);
+    switch (median_isa(vi, width, use_avx2, isa, env)) {
+    case MedianIsa::AVX512: return avx512_rank_functions[index];
+    case MedianIsa::AVX2: return avx2_rank_functions[index];
+    case MedianIsa::SSE: return sse_rank_functions[index];
+    default: return c_rank_functions[index];
+    }
+}
+
+Clense::Clense(PClip child, PClip previous, PClip next, int radius, int batch, bool grey, bool reduceflicker, ClenseMode mode, bool skip_cs_check, bool use_avx2, int threads, bool profile, IScriptEnvironment* env)
+    : GenericVideoFilter(child), previous_(previous), next_(next), grey_(grey), mode_(mode), reduceflicker_(reduceflicker), batch_(batch), radius_(radius), median_processor_(nullptr), pool_(nullptr), stripes_(1) {
     if(!(vi.IsPlanar() || skip_cs_check)) {
         env->ThrowError("Clense works only with planar colorspaces");
     }
@@ -228,57 +403,126 @@ Clense::Clense(PClip child, PClip previous, PClip next, bool grey, bool reducefl
     if(grey_ && (vi.IsPlanarRGB() || vi.IsPlanarRGBA()))
       env->ThrowError("Clense: cannot speficy grey for planar RGB colorspaces");
 
+    if (radius_ < 1 || radius_ > MAX_RADIUS)
+      env->ThrowError("Clense: radius must be between 1 and %d!", MAX_RADIUS);
+
+    if (batch_ < 1)
+      env->ThrowError("Clense: batch must be positive!");
+
+    // frames one output reads: n-radius..n+radius, n..n+2 or n-2..n. A batch needs batch-1 more
+    const int window = mode_ == ClenseMode::BOTH ? 2 * radius_ + 1 : 3;
+    sources_.reset(new KeyedFrameCache(window + batch_ - 1));
+    if (reduceflicker_ || batch_ > 1)
+      outputs_.reset(new KeyedFrameCache(std::max(4, 2 * batch_)));
+
+    // the ring holds the window already, the host cache only has to bridge to the next request
+    child->SetCacheHints(CACHE_WINDOW, window + batch_ - 1);
+    if (previous_ != nullptr)
+      previous_->SetCacheHints(CACHE_WINDOW, radius_ + batch_ - 1);
+    if (next_ != nullptr)
+      next_->SetCacheHints(CACHE_WINDOW, radius_ + batch_ - 1);
+
     pixelsize = vi.ComponentSize();
     bits_per_pixel = vi.BitsPerComponent();
 
-    lastDstFrame = nullptr;
-    lastRequestedFrameNo = -1;
-
     if (previous_ != nullptr) {
         check_if_match(vi, previous_->GetVideoInfo(), env);
     }
     if (next_ != nullptr) {
         check_if_match(vi, next_->GetVideoInfo(), env);
     }
-    sse2_ = vi.width > 16 && (env->GetCPUFlags() & CPUF_SSE2);
-    sse4_ = vi.width > 16 && (env->GetCPUFlags() & CPUF_SSE4);
+    // SSE and AVX2 plane processors need at least 16 or 32 bytes in the narrowest processed plane
+    int min_width = vi.width;
+    if (vi.IsPlanar() && !vi.IsY() && !grey_ && !vi.IsPlanarRGB() && !vi.IsPlanarRGBA())
+      min_width >>= vi.GetPlaneWidthSubsampling(PLANAR_U);
+
+    if (pixelsize == 2 && (bits_per_pixel < 10 || bits_per_pixel > 16 || (bits_per_pixel & 1)))
+      env->ThrowError("Illegal bit-depth: %d!", bits_per_pixel);
+
+    const bool both = mode_ == ClenseMode::BOTH;
+    const char *isa;
+    processor_ = clense_function(vi, min_width, both, use_avx2, &isa, env);
+    // radius 2-4 runs the median only
+    if (radius_ > 1)
+      median_processor_ = clense_median_function(vi, min_width, radius_, use_avx2, &isa, env);
+
+    profile_ = FilterProfile::create(profile, both ? "Clense" : mode_ == ClenseMode::FORWARD ? "ForwardClense" : "BackwardClense", vi, env);
+    if (profile_) {
+      for (int p = 0; p < 3; ++p)
+        profile_->set_isa(p, isa);
+    }
 
-    if (pixelsize == 1) {
-      processor_ = (mode_ == ClenseMode::BOTH)
-        ? (sse2_ ? process_plane_sse<clense_process_line_sse2> : process_plane_c<uint8_t, clense_process_pixel_c>)
-        : (sse2_ ? process_plane_sse<sclense_process_line_sse2> : process_plane_c<uint8_t, sclense_process_pixel_c>);
+    if (threads < 0) {
+      env->ThrowError("Clense: threads must be 0 (auto) or positive!");
     }
-    else if (pixelsize == 2) {
-      // sse4 needed
-      switch (bits_per_pixel) {
-      case 10: processor_ = (mode_ == ClenseMode::BOTH)
-        ? (sse4_ ? process_plane_sse<clense_process_line_sse4_16> : process_plane_c<uint16_t, clense_process_pixel_c_16>)
-        : (sse4_ ? process_plane_sse<sclense_process_line_sse4_16<10>> : process_plane_c<uint16_t, sclense_process_pixel_c_16<10>>);
-        break;
-      case 12: processor_ = (mode_ == ClenseMode::BOTH)
-        ? (sse4_ ? process_plane_sse<clense_process_line_sse4_16> : process_plane_c<uint16_t, clense_process_pixel_c_16>)
-        : (sse4_ ? process_plane_sse<sclense_process_line_sse4_16<12>> : process_plane_c<uint16_t, sclense_process_pixel_c_16<12>>);
-        break;
-      case 14: processor_ = (mode_ == ClenseMode::BOTH)
-        ? (sse4_ ? process_plane_sse<clense_process_line_sse4_16> : process_plane_c<uint16_t, clense_process_pixel_c_16>)
-        : (sse4_ ? process_plane_sse<sclense_process_line_sse4_16<14>> : process_plane_c<uint16_t, sclense_process_pixel_c_16<14>>);
-        break;
-      case 16: processor_ = (mode_ == ClenseMode::BOTH)
-        ? (sse4_ ? process_plane_sse<clense_process_line_sse4_16> : process_plane_c<uint16_t, clense_process_pixel_c_16>)
-        : (sse4_ ? process_plane_sse<sclense_process_line_sse4_16<16>> : process_plane_c<uint16_t, sclense_process_pixel_c_16<16>>);
-        break;
-      default: env->ThrowError("Illegal bit-depth: %d!", bits_per_pixel);
-      }
+    if (threads != 1) {
+      pool_ = ThreadPool::acquire();
+      stripes_ = stripes_for_threads(threads, pool_);
     }
-    else { // pixelsize == 4
-      processor_ = (mode_ == ClenseMode::BOTH)
-        ? (sse2_ ? process_plane_sse<clense_process_line_sse2_32> : process_plane_c<float, clense_process_pixel_c_32>)
-        : (sse2_ ? process_plane_sse<sclense_process_line_sse2_32> : process_plane_c<float, sclense_process_pixel_c_32>);
+}
+
+Clense::~Clense() {
+  if (pool_ != nullptr)
+    ThreadPool::release();
+}
+
+void Clense::process_plane(int p, Byte* pDst, const Byte *pSrc, const Byte* pRef1, const Byte* pRef2, int dstPitch, int srcPitch, int ref1Pitch, int ref2Pitch, int rowsize, int height, IScriptEnvironment *env) {
+  PlaneTimer timer(profile_.get(), p, rowsize, height, 3);
+  // purely temporal, stripes need no overlap
+  process_plane_stripes(pool_, stripes_, 0, pDst, dstPitch, rowsize, height, [&](int y, int h, Byte* pStripeDst, int stripeDstPitch) {
+    processor_(pStripeDst, pSrc + y * srcPitch, pRef1 + y * ref1Pitch, pRef2 + y * ref2Pitch, stripeDstPitch, srcPitch, ref1Pitch, ref2Pitch, rowsize, h, env);
+  });
+}
+
+void Clense::process_median_plane(int p, int plane, PVideoFrame &dstFrame, const PVideoFrame *frames, IScriptEnvironment *env) {
+  const int count = 2 * radius_ + 1;
+  const Byte* pFrames[2 * MAX_RADIUS + 1];
+  int pitches[2 * MAX_RADIUS + 1];
+  for (int i = 0; i < count; ++i) {
+    pFrames[i] = frames[i]->GetReadPtr(plane);
+    pitches[i] = frames[i]->GetPitch(plane);
+  }
+  const int rowsize = dstFrame->GetRowSize(plane);
+  const int height = dstFrame->GetHeight(plane);
+
+  PlaneTimer timer(profile_.get(), p, rowsize, height, count);
+  process_plane_stripes(pool_, stripes_, 0, dstFrame->GetWritePtr(plane), dstFrame->GetPitch(plane), rowsize, height, [&](int y, int h, Byte* pStripeDst, int stripeDstPitch) {
+    const Byte* pStripes[2 * MAX_RADIUS + 1];
+    for (int i = 0; i < count; ++i)
+      pStripes[i] = pFrames[i] + y * pitches[i];
+    median_processor_(pStripeDst, pStripes, pitches, stripeDstPitch, rowsize, h, env);
+  });
+}
+
+PVideoFrame Clense::source(int n, IScriptEnvironment* env) {
+    PVideoFrame frame;
+    if (!sources_->lookup(n, frame)) {
+      frame = child->GetFrame(n, env);
+      sources_->insert(n, frame);
     }
+    return frame;
 }
 
 PVideoFrame Clense::GetFrame(int n, IScriptEnvironment* env) {
-    auto srcFrame = child->GetFrame(n, env);
+    if (batch_ == 1)
+      return clense_frame(n, env);
+
+    // batch: outputs n..n+batch-1 are rendered together, the later ones wait in outputs_
+    PVideoFrame frame;
+    const bool rendered = outputs_->lookup(n, frame);
+    if (profile_)
+      profile_->count_lookup(rendered);
+    if (rendered)
+      return frame;
+
+    frame = clense_frame(n, env);
+    for (int i = 1; i < batch_ && n + i < vi.num_frames; ++i)
+      clense_frame(n + i, env);
+    return frame;
+}
+
+PVideoFrame Clense::clense_frame(int n, IScriptEnvironment* env) {
+    auto srcFrame = source(n, env);
 
     if (mode_ == ClenseMode::FORWARD && (n == vi.num_frames - 2 || n == vi.num_frames - 1)) {
         return srcFrame;
@@ -286,52 +530,77 @@ PVideoFrame Clense::GetFrame(int n, IScriptEnvironment* env) {
     if (mode_ == ClenseMode::BACKWARD && (n == 1 || n == 0)) {
         return srcFrame;
     }
-    if (mode_ == ClenseMode::BOTH && (n == 0 || n == vi.num_frames - 1))  {
+    if (mode_ == ClenseMode::BOTH && (n < radius_ || n >= vi.num_frames - radius_))  {
         return srcFrame;
     }
 
     PVideoFrame frame1, frame2;
+    PVideoFrame frames[2 * MAX_RADIUS + 1]; // radius > 1: n-radius..n+radius
 
     if (mode_ == ClenseMode::BACKWARD) {
-        frame1 = child->GetFrame(n-1, env);
-        frame2 = child->GetFrame(n-2, env);
+        frame1 = source(n-1, env);
+        frame2 = source(n-2, env);
     } else if (mode_ == ClenseMode::FORWARD) {
-        frame1 = child->GetFrame(n+1, env);
-        frame2 = child->GetFrame(n+2, env);
+        frame1 = source(n+1, env);
+        frame2 = source(n+2, env);
     } else {
-      // reduceflicker works when frames are requested sequentally
-      // maybe multi_instance works
-      if (reduceflicker_ && lastRequestedFrameNo == n - 1) // from v0.9
-        frame1 = lastDstFrame;
-      else
-        frame1 = previous_ == nullptr ? child->GetFrame(n-1, env) : previous_->GetFrame(n-1, env);
-
-      frame2 = next_ == nullptr ? child->GetFrame(n+1, env) : next_->GetFrame(n+1, env);
+      // reduceflicker: the clensed frame n-1 instead of the source when it is done already (from v0.9).
+      // Always with sequential requests, in MT mode when another thread has finished it
+      bool clensed = false;
+      if (reduceflicker_) {
+        clensed = outputs_->lookup(n - 1, frame1);
+        if (profile_)
+          profile_->count_lookup(clensed);
+      }
+      if (!clensed)
+        frame1 = previous_ == nullptr ? source(n-1, env) : previous_->GetFrame(n-1, env);
+
+      frame2 = next_ == nullptr ? source(n+1, env) : next_->GetFrame(n+1, env);
+
+      if (radius_ > 1) {
+        // previous and next give all the frames on their side, they can not be named clip arrays (see avs2x.cpp)
+        frames[radius_ - 1] = frame1;
+        frames[radius_] = srcFrame;
+        frames[radius_ + 1] = frame2;
+        for (int k = 2; k <= radius_; ++k) {
+          frames[radius_ - k] = previous_ == nullptr ? source(n-k, env) : previous_->GetFrame(n-k, env);
+          frames[radius_ + k] = next_ == nullptr ? source(n+k, env) : next_->GetFrame(n+k, env);
+        }
+      }
     }
 
+    // the source ring holds srcFrame, it is never exclusively owned: no in place processing
     auto dstFrame = env->NewVideoFrame(vi);
-
-    if (vi.IsPlanarRGB() || vi.IsPlanarRGBA()) {
-      processor_(dstFrame->GetWritePtr(PLANAR_G), srcFrame->GetReadPtr(PLANAR_G), frame1->GetReadPtr(PLANAR_G), frame2->GetReadPtr(PLANAR_G),
+    FrameProfile frame_profile(profile_.get());
+
+    if (radius_ > 1) {
+      int planes_y[3] = { PLANAR_Y, PLANAR_U, PLANAR_V };
+      int planes_r[3] = { PLANAR_G, PLANAR_B, PLANAR_R };
+      const bool rgb = vi.IsPlanarRGB() || vi.IsPlanarRGBA();
+      const int num_planes = rgb ? 3 : (vi.IsY() || grey_) ? 1 : 3;
+      for (int p = 0; p < num_planes; ++p)
+        process_median_plane(p, rgb ? planes_r[p] : planes_y[p], dstFrame, frames, env);
+    } else if (vi.IsPlanarRGB() || vi.IsPlanarRGBA()) {
+      process_plane(0, dstFrame->GetWritePtr(PLANAR_G), srcFrame->GetReadPtr(PLANAR_G), frame1->GetReadPtr(PLANAR_G), frame2->GetReadPtr(PLANAR_G),
         dstFrame->GetPitch(PLANAR_G), srcFrame->GetPitch(PLANAR_G), frame1->GetPitch(PLANAR_G), frame2->GetPitch(PLANAR_G),
         srcFrame->GetRowSize(PLANAR_G), srcFrame->GetHeight(PLANAR_G), env);
-      processor_(dstFrame->GetWritePtr(PLANAR_B), srcFrame->GetReadPtr(PLANAR_B), frame1->GetReadPtr(PLANAR_B), frame2->GetReadPtr(PLANAR_B),
+      process_plane(1, dstFrame->GetWritePtr(PLANAR_B), srcFrame->GetReadPtr(PLANAR_B), frame1->GetReadPtr(PLANAR_B), frame2->GetReadPtr(PLANAR_B),
         dstFrame->GetPitch(PLANAR_B), srcFrame->GetPitch(PLANAR_B), frame1->GetPitch(PLANAR_B), frame2->GetPitch(PLANAR_B),
         srcFrame->GetRowSize(PLANAR_B), srcFrame->GetHeight(PLANAR_B), env);
-      processor_(dstFrame->GetWritePtr(PLANAR_R), srcFrame->GetReadPtr(PLANAR_R), frame1->GetReadPtr(PLANAR_R), frame2->GetReadPtr(PLANAR_R),
+      process_plane(2, dstFrame->GetWritePtr(PLANAR_R), srcFrame->GetReadPtr(PLANAR_R), frame1->GetReadPtr(PLANAR_R), frame2->GetReadPtr(PLANAR_R),
         dstFrame->GetPitch(PLANAR_R), srcFrame->GetPitch(PLANAR_R), frame1->GetPitch(PLANAR_R), frame2->GetPitch(PLANAR_R),
         srcFrame->GetRowSize(PLANAR_R), srcFrame->GetHeight(PLANAR_R), env);
     } else {
-      processor_(dstFrame->GetWritePtr(PLANAR_Y), srcFrame->GetReadPtr(PLANAR_Y), frame1->GetReadPtr(PLANAR_Y), frame2->GetReadPtr(PLANAR_Y),
+      process_plane(0, dstFrame->GetWritePtr(PLANAR_Y), srcFrame->GetReadPtr(PLANAR_Y), frame1->GetReadPtr(PLANAR_Y), frame2->GetReadPtr(PLANAR_Y),
         dstFrame->GetPitch(PLANAR_Y), srcFrame->GetPitch(PLANAR_Y), frame1->GetPitch(PLANAR_Y), frame2->GetPitch(PLANAR_Y),
         srcFrame->GetRowSize(PLANAR_Y), srcFrame->GetHeight(PLANAR_Y), env);
 
       if (!vi.IsY() && !grey_) {
-        processor_(dstFrame->GetWritePtr(PLANAR_U), srcFrame->GetReadPtr(PLANAR_U), frame1->GetReadPtr(PLANAR_U), frame2->GetReadPtr(PLANAR_U),
+        process_plane(1, dstFrame->GetWritePtr(PLANAR_U), srcFrame->GetReadPtr(PLANAR_U), frame1->GetReadPtr(PLANAR_U), frame2->GetReadPtr(PLANAR_U),
           dstFrame->GetPitch(PLANAR_U), srcFrame->GetPitch(PLANAR_U), frame1->GetPitch(PLANAR_U), frame2->GetPitch(PLANAR_U),
           srcFrame->GetRowSize(PLANAR_U), srcFrame->GetHeight(PLANAR_U), env);
 
-        processor_(dstFrame->GetWritePtr(PLANAR_V), srcFrame->GetReadPtr(PLANAR_V), frame1->GetReadPtr(PLANAR_V), frame2->GetReadPtr(PLANAR_V),
+        process_plane(2, dstFrame->GetWritePtr(PLANAR_V), srcFrame->GetReadPtr(PLANAR_V), frame1->GetReadPtr(PLANAR_V), frame2->GetReadPtr(PLANAR_V),
           dstFrame->GetPitch(PLANAR_V), srcFrame->GetPitch(PLANAR_V), frame1->GetPitch(PLANAR_V), frame2->GetPitch(PLANAR_V),
           srcFrame->GetRowSize(PLANAR_V), srcFrame->GetHeight(PLANAR_V), env);
       }
@@ -341,28 +610,27 @@ PVideoFrame Clense::GetFrame(int n, IScriptEnvironment* env) {
       env->BitBlt(dstFrame->GetWritePtr(PLANAR_A), dstFrame->GetPitch(PLANAR_A), srcFrame->GetReadPtr(PLANAR_A), srcFrame->GetPitch(PLANAR_A), srcFrame->GetRowSize(PLANAR_A_ALIGNED), srcFrame->GetHeight(PLANAR_A));
     }
 
-    if (reduceflicker_) {
-      lastDstFrame = dstFrame;
-      lastRequestedFrameNo = n;
-    }
+    frame_profile.attach(dstFrame, env);
+    if (outputs_)
+      outputs_->insert(n, dstFrame);
 
     return dstFrame;
 }
 
 AVSValue __cdecl Create_Clense(AVSValue args, void*, IScriptEnvironment* env) {
-    enum { CLIP, PREVIOUS, NEXT, GREY, FLICKER, PLANAR, CACHE };
+    enum { CLIP, PREVIOUS, NEXT, GREY, FLICKER, PLANAR, CACHE, OPTAVX2, THREADS, PROFILE, RADIUS, BATCH };
     return new Clense(args[CLIP].AsClip(),
       args[PREVIOUS].Defined() ? args[PREVIOUS].AsClip() : nullptr,
-      args[NEXT].Defined() ? args[NEXT].AsClip() : nullptr, args[GREY].AsBool(false), args[FLICKER].AsBool(false), ClenseMode::BOTH, args[PLANAR].AsBool(false), env);
+      args[NEXT].Defined() ? args[NEXT].AsClip() : nullptr, args[RADIUS].AsInt(1), args[BATCH].AsInt(1), args[GREY].AsBool(false), args[FLICKER].AsBool(false), ClenseMode::BOTH, args[PLANAR].AsBool(false), args[OPTAVX2].AsBool(true), args[THREADS].AsInt(1), args[PROFILE].AsBool(false), env);
     // planar and cache are dummy parameters for compatibility reasons
 }
 
 AVSValue __cdecl Create_ForwardClense(AVSValue args, void*, IScriptEnvironment* env) {
-    enum { CLIP, GREY, PLANAR};
-    return new Clense(args[CLIP].AsClip(), nullptr, nullptr, args[GREY].AsBool(false), false, ClenseMode::FORWARD, args[PLANAR].AsBool(false), env);
+    enum { CLIP, GREY, PLANAR, CACHE, OPTAVX2, THREADS, PROFILE, BATCH };
+    return new Clense(args[CLIP].AsClip(), nullptr, nullptr, 1, args[BATCH].AsInt(1), args[GREY].AsBool(false), false, ClenseMode::FORWARD, args[PLANAR].AsBool(false), args[OPTAVX2].AsBool(true), args[THREADS].AsInt(1), args[PROFILE].AsBool(false), env);
 }
 
 AVSValue __cdecl Create_BackwardClense(AVSValue args, void*, IScriptEnvironment* env) {
-    enum { CLIP, GREY, PLANAR};
-    return new Clense(args[CLIP].AsClip(), nullptr, nullptr, args[GREY].AsBool(false), false, ClenseMode::BACKWARD, args[PLANAR].AsBool(false), env);
+    enum { CLIP, GREY, PLANAR, CACHE, OPTAVX2, THREADS, PROFILE, BATCH };
+    return new Clense(args[CLIP].AsClip(), nullptr, nullptr, 1, args[BATCH].AsInt(1), args[GREY].AsBool(false), false, ClenseMode::BACKWARD, args[PLANAR].AsBool(false), args[OPTAVX2].AsBool(true), args[THREADS].AsInt(1), args[PROFILE].AsBool(false), env);
 }
\ No newline at end of file
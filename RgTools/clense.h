@@ -2,10 +2,20 @@
 #define __CLENSE_H__
 
 #include "common.h"
+#include "thread_pool.h"
+#include "profile.h"
+#include "frame_cache.h"
 
 template<typename pixel_t>
 using CModeProcessor = pixel_t (*)(pixel_t, pixel_t, pixel_t);
 
+typedef void (ClenseProcessor)(Byte* pDst, const Byte *pSrc, const Byte* pRef1, const Byte* pRef2, int dstPitch, int srcPitch, int ref1Pitch, int ref2Pitch, int width, int height, IScriptEnvironment *env);
+// radius 2-4: median of the planes of frames n-radius..n+radius
+typedef void (ClenseMedianProcessor)(Byte* pDst, const Byte* const* pFrames, const int* pitches, int dstPitch, int rowsize, int height, IScriptEnvironment *env);
+// MedianOfClips: value of rank 'rank' (0 is the minimum) of 'count' planes, count up to RANK_MAX_PLANES
+typedef void (RankProcessor)(Byte* pDst, const Byte* const* pPlanes, const int* pitches, int count, int rank, int dstPitch, int rowsize, int height, IScriptEnvironment *env);
+const int RANK_MAX_PLANES = 32;
+
 enum class ClenseMode {
     FORWARD,
     BACKWARD,
@@ -17,37 +27,57 @@ class Clense : public GenericVideoFilter {
 
 
 public:
-    Clense(PClip child, PClip previous, PClip next, bool grey, bool reduceflicker, ClenseMode mode, bool skip_cs_check, IScriptEnvironment* env);
+    Clense(PClip child, PClip previous, PClip next, int radius, int batch, bool grey, bool reduceflicker, ClenseMode mode, bool skip_cs_check, bool use_avx2, int threads, bool profile, IScriptEnvironment* env);
+    ~Clense();
 
     PVideoFrame __stdcall GetFrame(int n, IScriptEnvironment* env);
 
+    // profile=true, else nullptr
+    FilterProfile* profile() const { return profile_.get(); }
+
     int __stdcall SetCacheHints(int cachehints, int frame_range) override {
-      // depends on working mode
-      return cachehints == CACHE_GET_MTMODE ? (reduceflicker_ ? MT_MULTI_INSTANCE : MT_NICE_FILTER) : 0;
+      // the source ring and reduceflicker share their frames between the threads
+      return cachehints == CACHE_GET_MTMODE ? MT_NICE_FILTER : 0;
     }
 
+    const static int MAX_RADIUS = 4;
+
 private:
     PClip previous_;
     PClip next_;
     bool grey_;
-    bool sse2_;
-    bool sse4_;
     ClenseMode mode_;
     bool reduceflicker_;
 
     int pixelsize;
     int bits_per_pixel;
 
-    // for reduceflicker
-    PVideoFrame lastDstFrame;
-    int lastRequestedFrameNo;
-
-    typedef void (ClenseProcessor)(Byte* pDst, const Byte *pSrc, const Byte* pRef1, const Byte* pRef2, int dstPitch, int srcPitch, int ref1Pitch, int ref2Pitch, int width, int height, IScriptEnvironment *env);
+    // the last source frames, each one is fetched once for all outputs it is part of
+    std::unique_ptr<KeyedFrameCache> sources_;
+    // the last clensed frames, reduceflicker or batch > 1, else nullptr
+    std::unique_ptr<KeyedFrameCache> outputs_;
+    int batch_; // consecutive outputs rendered per request
 
     ClenseProcessor* processor_;
+    int radius_; // Clense: frames n-radius..n+radius, 1 for ForwardClense and BackwardClense
+    ClenseMedianProcessor* median_processor_; // radius > 1
+
+    ThreadPool *pool_; // nullptr when threads=1
+    int stripes_;
+
+    std::shared_ptr<FilterProfile> profile_; // nullptr when profile=false
+
+    PVideoFrame source(int n, IScriptEnvironment* env);
+    PVideoFrame clense_frame(int n, IScriptEnvironment* env);
+    void process_plane(int p, Byte* pDst, const Byte *pSrc, const Byte* pRef1, const Byte* pRef2, int dstPitch, int srcPitch, int ref1Pitch, int ref2Pitch, int rowsize, int height, IScriptEnvironment *env);
+    void process_median_plane(int p, int plane, PVideoFrame &dstFrame, const PVideoFrame *frames, IScriptEnvironment *env);
 };
 
 
+ClenseProcessor* clense_function(const VideoInfo &vi, int width, bool both, bool use_avx2, const char **isa, IScriptEnvironment* env);
+ClenseMedianProcessor* clense_median_function(const VideoInfo &vi, int width, int radius, bool use_avx2, const char **isa, IScriptEnvironment* env);
+RankProcessor* rank_function(const VideoInfo &vi, int width, bool use_avx2, const char **isa, IScriptEnvironment* env);
+
 AVSValue __cdecl Create_Clense(AVSValue args, void*, IScriptEnvironment* env);
 AVSValue __cdecl Create_ForwardClense(AVSValue args, void*, IScriptEnvironment* env);
 AVSValue __cdecl Create_BackwardClense(AVSValue args, void*, IScriptEnvironment* env);
@@ -0,0 +1,171 @@
+#include "common_avx2.h"
+#include "clense.h"
+#include "clense_median.h"
+#include "colsort_avx2.h"
+
+// AVX2: not using special aligned templates, loadu is fast is aligned
+RG_FORCEINLINE void clense_process_line_avx2(Byte* pDst, const Byte *pSrc, const Byte* pRef1, const Byte* pRef2, int rowsize) {
+  for (int x = 0; x < rowsize; x+=32) {
+    auto src = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pSrc+x));
+    auto ref1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pRef1+x));
+    auto ref2 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pRef2+x));
+
+    auto minref = _mm256_min_epu8(ref1, ref2);
+    auto maxref = _mm256_max_epu8(ref1, ref2);
+    auto dst = simd_clip(src, minref, maxref);
+
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(pDst+x), dst);
+  }
+}
+
+RG_FORCEINLINE void clense_process_line_avx2_16(Byte* pDst, const Byte *pSrc, const Byte* pRef1, const Byte* pRef2, int rowsize) {
+  for (int x = 0; x < rowsize; x+=32) {
+    auto src = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pSrc+x));
+    auto ref1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pRef1+x));
+    auto ref2 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pRef2+x));
+
+    auto minref = _mm256_min_epu16(ref1, ref2);
+    auto maxref = _mm256_max_epu16(ref1, ref2);
+    auto dst = simd_clip_16(src, minref, maxref);
+
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(pDst+x), dst);
+  }
+}
+
+RG_FORCEINLINE void clense_process_line_avx2_32(Byte* pDst, const Byte *pSrc, const Byte* pRef1, const Byte* pRef2, int rowsize) {
+  for (int x = 0; x < rowsize; x+=32) {
+    auto src = _mm256_loadu_ps(reinterpret_cast<const float*>(pSrc+x));
+    auto ref1 = _mm256_loadu_ps(reinterpret_cast<const float*>(pRef1+x));
+    auto ref2 = _mm256_loadu_ps(reinterpret_cast<const float*>(pRef2+x));
+
+    auto minref = _mm256_min_ps(ref1, ref2);
+    auto maxref = _mm256_max_ps(ref1, ref2);
+    auto dst = simd_clip_32(src, minref, maxref);
+
+    _mm256_storeu_ps(reinterpret_cast<float*>(pDst+x), dst);
+  }
+}
+
+RG_FORCEINLINE void sclense_process_line_avx2(Byte* pDst, const Byte *pSrc, const Byte* pRef1, const Byte* pRef2, int rowsize) {
+  for (int x = 0; x < rowsize; x+=32) {
+    auto src = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pSrc+x));
+    auto ref1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pRef1+x));
+    auto ref2 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pRef2+x));
+
+    auto minref = _mm256_min_epu8(ref1, ref2);
+    auto maxref = _mm256_max_epu8(ref1, ref2);
+
+    auto ma = _mm256_subs_epu8(maxref, ref2);
+    auto mi = _mm256_subs_epu8(ref2, minref);
+
+    ma = _mm256_adds_epu8(ma, maxref);
+    mi = _mm256_subs_epu8(minref, mi);
+
+    auto dst = simd_clip(src, mi, ma);
+
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(pDst+x), dst);
+  }
+}
+
+template<int bits_per_pixel>
+RG_FORCEINLINE void sclense_process_line_avx2_16(Byte* pDst, const Byte *pSrc, const Byte* pRef1, const Byte* pRef2, int rowsize) {
+  const __m256i pixel_max = _mm256_set1_epi16(bits_per_pixel < 16 ? (1 << bits_per_pixel) - 1 : 0); // anti warning 65535 (not used) vs short
+
+  for (int x = 0; x < rowsize; x+=32) {
+    auto src = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pSrc+x));
+    auto ref1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pRef1+x));
+    auto ref2 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pRef2+x));
+
+    auto minref = _mm256_min_epu16(ref1, ref2);
+    auto maxref = _mm256_max_epu16(ref1, ref2);
+
+    auto ma = _mm256_subs_epu16(maxref, ref2);
+    auto mi = _mm256_subs_epu16(ref2, minref);
+
+    ma = _mm256_adds_epu16(ma, maxref);
+    mi = _mm256_subs_epu16(minref, mi);
+
+    if (bits_per_pixel < 16)
+      ma = _mm256_min_epu16(ma, pixel_max); // saturation is not enough
+
+    auto dst = simd_clip_16(src, mi, ma);
+
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(pDst+x), dst);
+  }
+}
+
+RG_FORCEINLINE void sclense_process_line_avx2_32(Byte* pDst, const Byte *pSrc, const Byte* pRef1, const Byte* pRef2, int rowsize) {
+  for (int x = 0; x < rowsize; x+=32) {
+    auto src = _mm256_loadu_ps(reinterpret_cast<const float*>(pSrc+x));
+    auto ref1 = _mm256_loadu_ps(reinterpret_cast<const float*>(pRef1+x));
+    auto ref2 = _mm256_loadu_ps(reinterpret_cast<const float*>(pRef2+x));
+
+    auto minref = _mm256_min_ps(ref1, ref2);
+    auto maxref = _mm256_max_ps(ref1, ref2);
+
+    auto mi = _mm256_sub_ps(_mm256_add_ps(minref, minref), ref2);
+    auto ma = _mm256_sub_ps(_mm256_add_ps(maxref, maxref), ref2);
+
+    // no max_pixel_value clamp for float
+    auto dst = simd_clip_32(src, mi, ma);
+
+    _mm256_storeu_ps(reinterpret_cast<float*>(pDst+x), dst);
+  }
+}
+
+// rowsize must be at least 32, checked in Clense constructor
+template<decltype(clense_process_line_avx2) processor>
+static void process_plane_avx2(Byte* pDst, const Byte *pSrc, const Byte* pRef1, const Byte* pRef2, int dstPitch, int srcPitch, int ref1Pitch, int ref2Pitch, int rowsize, int height, IScriptEnvironment *env) {
+  _mm256_zeroupper();
+
+  auto mod32Width = (rowsize / 32) * 32;
+
+  for (int y = 0; y < height; ++y) {
+    processor(pDst, pSrc, pRef1, pRef2, mod32Width);
+
+    if (mod32Width != rowsize) {
+      // last 32 bytes, overlaps with the already processed part
+      processor(pDst + rowsize - 32, pSrc + rowsize - 32, pRef1 + rowsize - 32, pRef2 + rowsize - 32, 32);
+    }
+    pDst += dstPitch;
+    pSrc += srcPitch;
+    pRef1 += ref1Pitch;
+    pRef2 += ref2Pitch;
+  }
+  _mm256_zeroupper();
+}
+
+// 8, 10, 12, 14, 16 bits and float
+ClenseProcessor* avx2_clense_functions[] = {
+  process_plane_avx2<clense_process_line_avx2>,
+  process_plane_avx2<clense_process_line_avx2_16>,
+  process_plane_avx2<clense_process_line_avx2_16>,
+  process_plane_avx2<clense_process_line_avx2_16>,
+  process_plane_avx2<clense_process_line_avx2_16>,
+  process_plane_avx2<clense_process_line_avx2_32>
+};
+
+ClenseProcessor* avx2_sclense_functions[] = {
+  process_plane_avx2<sclense_process_line_avx2>,
+  process_plane_avx2<sclense_process_line_avx2_16<10>>,
+  process_plane_avx2<sclense_process_line_avx2_16<12>>,
+  process_plane_avx2<sclense_process_line_avx2_16<14>>,
+  process_plane_avx2<sclense_process_line_avx2_16<16>>,
+  process_plane_avx2<sclense_process_line_avx2_32>
+};
+
+// MedianOfClips, 8, 10, 12, 14, 16 bits and float
+RankProcessor* avx2_rank_functions[] = {
+  rank_plane<ColsortAvx2_8>, rank_plane<ColsortAvx2_16>, rank_plane<ColsortAvx2_16>,
+  rank_plane<ColsortAvx2_16>, rank_plane<ColsortAvx2_16>, rank_plane<ColsortAvx2_32>
+};
+
+// radius 2, 3, 4 x 8, 10, 12, 14, 16 bits and float
+ClenseMedianProcessor* avx2_clense_median_functions[][6] = {
+  { clense_median_plane<ColsortAvx2_8, 5>, clense_median_plane<ColsortAvx2_16, 5>, clense_median_plane<ColsortAvx2_16, 5>,
+    clense_median_plane<ColsortAvx2_16, 5>, clense_median_plane<ColsortAvx2_16, 5>, clense_median_plane<ColsortAvx2_32, 5> },
+  { clense_median_plane<ColsortAvx2_8, 7>, clense_median_plane<ColsortAvx2_16, 7>, clense_median_plane<ColsortAvx2_16, 7>,
+    clense_median_plane<ColsortAvx2_16, 7>, clense_median_plane<ColsortAvx2_16, 7>, clense_median_plane<ColsortAvx2_32, 7> },
+  { clense_median_plane<ColsortAvx2_8, 9>, clense_median_plane<ColsortAvx2_16, 9>, clense_median_plane<ColsortAvx2_16, 9>,
+    clense_median_plane<ColsortAvx2_16, 9>, clense_median_plane<ColsortAvx2_16, 9>, clense_median_plane<ColsortAvx2_32, 9> }
+};
@@ -0,0 +1,130 @@
+#include "common_avx512.h"
+#include "clense.h"
+#include "clense_median.h"
+#include "colsort_avx512.h"
+
+// AVX-512BW: one 64 byte vector per step, the rest of the row with masked loads and stores.
+// Works for any rowsize, no overlapping last vector.
+
+typedef __m512i (ClenseOp)(__m512i src, __m512i ref1, __m512i ref2);
+
+static RG_FORCEINLINE __m512i clense_avx512(__m512i src, __m512i ref1, __m512i ref2) {
+  auto minref = _mm512_min_epu8(ref1, ref2);
+  auto maxref = _mm512_max_epu8(ref1, ref2);
+  return simd_clip(src, minref, maxref);
+}
+
+static RG_FORCEINLINE __m512i clense_avx512_16(__m512i src, __m512i ref1, __m512i ref2) {
+  auto minref = _mm512_min_epu16(ref1, ref2);
+  auto maxref = _mm512_max_epu16(ref1, ref2);
+  return simd_clip_16(src, minref, maxref);
+}
+
+static RG_FORCEINLINE __m512i clense_avx512_32(__m512i src, __m512i ref1, __m512i ref2) {
+  auto minref = _mm512_min_ps(_mm512_castsi512_ps(ref1), _mm512_castsi512_ps(ref2));
+  auto maxref = _mm512_max_ps(_mm512_castsi512_ps(ref1), _mm512_castsi512_ps(ref2));
+  return _mm512_castps_si512(simd_clip_32(_mm512_castsi512_ps(src), minref, maxref));
+}
+
+static RG_FORCEINLINE __m512i sclense_avx512(__m512i src, __m512i ref1, __m512i ref2) {
+  auto minref = _mm512_min_epu8(ref1, ref2);
+  auto maxref = _mm512_max_epu8(ref1, ref2);
+
+  auto ma = _mm512_subs_epu8(maxref, ref2);
+  auto mi = _mm512_subs_epu8(ref2, minref);
+
+  ma = _mm512_adds_epu8(ma, maxref);
+  mi = _mm512_subs_epu8(minref, mi);
+
+  return simd_clip(src, mi, ma);
+}
+
+template<int bits_per_pixel>
+static RG_FORCEINLINE __m512i sclense_avx512_16(__m512i src, __m512i ref1, __m512i ref2) {
+  auto minref = _mm512_min_epu16(ref1, ref2);
+  auto maxref = _mm512_max_epu16(ref1, ref2);
+
+  auto ma = _mm512_subs_epu16(maxref, ref2);
+  auto mi = _mm512_subs_epu16(ref2, minref);
+
+  ma = _mm512_adds_epu16(ma, maxref);
+  mi = _mm512_subs_epu16(minref, mi);
+
+  if (bits_per_pixel < 16)
+    ma = _mm512_min_epu16(ma, _mm512_set1_epi16((short)((1u << bits_per_pixel) - 1))); // saturation is not enough
+
+  return simd_clip_16(src, mi, ma);
+}
+
+static RG_FORCEINLINE __m512i sclense_avx512_32(__m512i src, __m512i ref1, __m512i ref2) {
+  auto r2 = _mm512_castsi512_ps(ref2);
+  auto minref = _mm512_min_ps(_mm512_castsi512_ps(ref1), r2);
+  auto maxref = _mm512_max_ps(_mm512_castsi512_ps(ref1), r2);
+
+  auto mi = _mm512_sub_ps(_mm512_add_ps(minref, minref), r2);
+  auto ma = _mm512_sub_ps(_mm512_add_ps(maxref, maxref), r2);
+
+  // no max_pixel_value clamp for float
+  return _mm512_castps_si512(simd_clip_32(_mm512_castsi512_ps(src), mi, ma));
+}
+
+template<ClenseOp op>
+static void process_plane_avx512(Byte* pDst, const Byte *pSrc, const Byte* pRef1, const Byte* pRef2, int dstPitch, int srcPitch, int ref1Pitch, int ref2Pitch, int rowsize, int height, IScriptEnvironment *env) {
+  _mm256_zeroupper();
+
+  const int mod64Width = rowsize / 64 * 64;
+  const __mmask64 tail = first_bytes_mask(rowsize - mod64Width);
+
+  for (int y = 0; y < height; ++y) {
+    for (int x = 0; x < mod64Width; x += 64) {
+      auto dst = op(simd_loadu_si512(pSrc + x), simd_loadu_si512(pRef1 + x), simd_loadu_si512(pRef2 + x));
+      _mm512_storeu_si512(reinterpret_cast<__m512i*>(pDst + x), dst);
+    }
+
+    if (mod64Width != rowsize) {
+      const int x = mod64Width;
+      auto dst = op(simd_maskz_loadu(pSrc + x, tail), simd_maskz_loadu(pRef1 + x, tail), simd_maskz_loadu(pRef2 + x, tail));
+      simd_mask_storeu(pDst + x, tail, dst);
+    }
+    pDst += dstPitch;
+    pSrc += srcPitch;
+    pRef1 += ref1Pitch;
+    pRef2 += ref2Pitch;
+  }
+  _mm256_zeroupper();
+}
+
+// 8, 10, 12, 14, 16 bits and float
+ClenseProcessor* avx512_clense_functions[] = {
+  process_plane_avx512<clense_avx512>,
+  process_plane_avx512<clense_avx512_16>,
+  process_plane_avx512<clense_avx512_16>,
+  process_plane_avx512<clense_avx512_16>,
+  process_plane_avx512<clense_avx512_16>,
+  process_plane_avx512<clense_avx512_32>
+};
+
+ClenseProcessor* avx512_sclense_functions[] = {
+  process_plane_avx512<sclense_avx512>,
+  process_plane_avx512<sclense_avx512_16<10>>,
+  process_plane_avx512<sclense_avx512_16<12>>,
+  process_plane_avx512<sclense_avx512_16<14>>,
+  process_plane_avx512<sclense_avx512_16<16>>,
+  process_plane_avx512<sclense_avx512_32>
+};
+
+// MedianOfClips, 8, 10, 12, 14, 16 bits and float
+RankProcessor* avx512_rank_functions[] = {
+  rank_plane<ColsortAvx512_8>, rank_plane<ColsortAvx512_16>, rank_plane<ColsortAvx512_16>,
+  rank_plane<ColsortAvx512_16>, rank_plane<ColsortAvx512_16>, rank_plane<ColsortAvx512_32>
+};
+
+// radius 2, 3, 4 x 8, 10, 12, 14, 16 bits and float
+ClenseMedianProcessor* avx512_clense_median_functions[][6] = {
+  { clense_median_plane<ColsortAvx512_8, 5>, clense_median_plane<ColsortAvx512_16, 5>, clense_median_plane<ColsortAvx512_16, 5>,
+    clense_median_plane<ColsortAvx512_16, 5>, clense_median_plane<ColsortAvx512_16, 5>, clense_median_plane<ColsortAvx512_32, 5> },
+  { clense_median_plane<ColsortAvx512_8, 7>, clense_median_plane<ColsortAvx512_16, 7>, clense_median_plane<ColsortAvx512_16, 7>,
+    clense_median_plane<ColsortAvx512_16, 7>, clense_median_plane<ColsortAvx512_16, 7>, clense_median_plane<ColsortAvx512_32, 7> },
+  { clense_median_plane<ColsortAvx512_8, 9>, clense_median_plane<ColsortAvx512_16, 9>, clense_median_plane<ColsortAvx512_16, 9>,
+    clense_median_plane<ColsortAvx512_16, 9>, clense_median_plane<ColsortAvx512_16, 9>, clense_median_plane<ColsortAvx512_32, 9> }
+};
@@ -0,0 +1,105 @@
+#ifndef __CLENSE_MEDIAN_H__
+#define __CLENSE_MEDIAN_H__
+
+#include "clense.h"
+
+// Clense with radius 2-4: exact median of 5, 7 or 9 frames per pixel.
+// Selection networks on vector min/max, Ops is a colsort.h vector struct (ClenseScalar for C).
+// The halves of compare-exchanges whose result does not reach the median drop out in the compiler.
+
+// C: one pixel per "vector"
+template<typename T>
+struct ClenseScalar {
+    typedef T V;
+    typedef T pixel_t;
+    enum { pixels = 1 };
+    static RG_FORCEINLINE V load(const Byte* p) { return *reinterpret_cast<const T*>(p); }
+    static RG_FORCEINLINE void store(Byte* p, V v) { *reinterpret_cast<T*>(p) = v; }
+    static RG_FORCEINLINE V vmin(V a, V b) { return std::min(a, b); }
+    static RG_FORCEINLINE V vmax(V a, V b) { return std::max(a, b); }
+    static RG_FORCEINLINE void zeroupper() {}
+};
+
+template<typename Ops>
+static RG_FORCEINLINE void clense_sort_pair(typename Ops::V &a, typename Ops::V &b) {
+    const auto t = Ops::vmin(a, b);
+    b = Ops::vmax(a, b);
+    a = t;
+}
+
+template<typename Ops, int frames>
+static RG_FORCEINLINE typename Ops::V clense_median(typename Ops::V *p) {
+    typedef typename Ops::V V;
+    if (frames == 5) {
+        // med3(e, max(min(a,b), min(c,d)), min(max(a,b), max(c,d)))
+        const V lo = Ops::vmax(Ops::vmin(p[0], p[1]), Ops::vmin(p[3], p[4]));
+        const V hi = Ops::vmin(Ops::vmax(p[0], p[1]), Ops::vmax(p[3], p[4]));
+        return Ops::vmax(Ops::vmin(p[2], lo), Ops::vmin(Ops::vmax(p[2], lo), hi));
+    }
+    if (frames == 7) {
+        clense_sort_pair<Ops>(p[0], p[5]); clense_sort_pair<Ops>(p[0], p[3]); clense_sort_pair<Ops>(p[1], p[6]);
+        clense_sort_pair<Ops>(p[2], p[4]); clense_sort_pair<Ops>(p[0], p[1]); clense_sort_pair<Ops>(p[3], p[5]);
+        clense_sort_pair<Ops>(p[2], p[6]); clense_sort_pair<Ops>(p[2], p[3]); clense_sort_pair<Ops>(p[3], p[6]);
+        clense_sort_pair<Ops>(p[4], p[5]); clense_sort_pair<Ops>(p[1], p[4]); clense_sort_pair<Ops>(p[1], p[3]);
+        clense_sort_pair<Ops>(p[3], p[4]);
+        return p[3];
+    }
+    // 9
+    clense_sort_pair<Ops>(p[1], p[2]); clense_sort_pair<Ops>(p[4], p[5]); clense_sort_pair<Ops>(p[7], p[8]);
+    clense_sort_pair<Ops>(p[0], p[1]); clense_sort_pair<Ops>(p[3], p[4]); clense_sort_pair<Ops>(p[6], p[7]);
+    clense_sort_pair<Ops>(p[1], p[2]); clense_sort_pair<Ops>(p[4], p[5]); clense_sort_pair<Ops>(p[7], p[8]);
+    clense_sort_pair<Ops>(p[0], p[3]); clense_sort_pair<Ops>(p[5], p[8]); clense_sort_pair<Ops>(p[4], p[7]);
+    clense_sort_pair<Ops>(p[3], p[6]); clense_sort_pair<Ops>(p[1], p[4]); clense_sort_pair<Ops>(p[2], p[5]);
+    clense_sort_pair<Ops>(p[4], p[7]); clense_sort_pair<Ops>(p[4], p[2]); clense_sort_pair<Ops>(p[6], p[4]);
+    clense_sort_pair<Ops>(p[4], p[2]);
+    return p[4];
+}
+
+// pFrames: n-radius..n+radius. The last vector of a row overlaps the one before, rowsize must hold
+// one vector (checked in the Clense constructor). A median over values that include it is the median
+// again, so the overlap also works in place.
+template<typename Ops, int frames>
+static void clense_median_plane(Byte* pDst, const Byte* const* pFrames, const int* pitches, int dstPitch, int rowsize, int height, IScriptEnvironment*) {
+    typedef typename Ops::V V;
+    const int step = Ops::pixels * sizeof(typename Ops::pixel_t);
+
+    Ops::zeroupper();
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < rowsize; x += step) {
+            const int xx = std::min(x, rowsize - step);
+            V v[frames];
+            for (int i = 0; i < frames; ++i)
+                v[i] = Ops::load(pFrames[i] + (size_t)y * pitches[i] + xx);
+            Ops::store(pDst + xx, clense_median<Ops, frames>(v));
+        }
+        pDst += dstPitch;
+    }
+    Ops::zeroupper();
+}
+
+// MedianOfClips with a plane count or rank the networks above do not cover. Odd-even transposition sort:
+// 'count' rounds of compare-exchanges between neighbours sort any input, the rank is read at the end.
+// Branchless, count is the same for every pixel. Rows end with an overlapping vector like above
+template<typename Ops>
+static void rank_plane(Byte* pDst, const Byte* const* pPlanes, const int* pitches, int count, int rank, int dstPitch, int rowsize, int height, IScriptEnvironment*) {
+    typedef typename Ops::V V;
+    const int step = Ops::pixels * sizeof(typename Ops::pixel_t);
+
+    Ops::zeroupper();
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < rowsize; x += step) {
+            const int xx = std::min(x, rowsize - step);
+            V v[RANK_MAX_PLANES];
+            for (int i = 0; i < count; ++i)
+                v[i] = Ops::load(pPlanes[i] + (size_t)y * pitches[i] + xx);
+            for (int round = 0; round < count; ++round)
+                for (int i = round & 1; i + 1 < count; i += 2)
+                    clense_sort_pair<Ops>(v[i], v[i + 1]);
+            Ops::store(pDst + xx, v[rank]);
+        }
+        pDst += dstPitch;
+    }
+    Ops::zeroupper();
+}
+
+#endif
@@ -0,0 +1,122 @@
+#include "clenserg.h"
+
+
+ClenseRG::ClenseRG(PClip child, int mode, bool skip_cs_check, bool use_avx2, int threads, bool profile, IScriptEnvironment* env)
+    : GenericVideoFilter(child), mode_(mode), rg_functions(nullptr), rg_functions_chroma(nullptr), clense_processor_(nullptr), clense_processor_chroma_(nullptr), pool_(nullptr), stripes_(1) {
+    if (!(vi.IsPlanar() || skip_cs_check)) {
+        env->ThrowError("ClenseRG works only with planar colorspaces");
+    }
+
+    if (mode_ < 0 || mode_ > 24) {
+        env->ThrowError("ClenseRG: mode should be between 0 and 24!");
+    }
+
+    // same tables as RemoveGrain and Clense would pick for this clip, the bit depth is checked here
+    rg_functions = removegrain_functions(vi, vi.width, use_avx2, env);
+    rg_functions_chroma = removegrain_functions(vi, chroma_plane_width(vi), use_avx2, env);
+    clense_processor_ = clense_function(vi, vi.width, true, use_avx2, nullptr, env);
+    clense_processor_chroma_ = clense_function(vi, chroma_plane_width(vi), true, use_avx2, nullptr, env);
+
+    // the temporal median reads n-1, n and n+1
+    child->SetCacheHints(CACHE_WINDOW, 3);
+
+    profile_ = FilterProfile::create(profile, "ClenseRG", vi, env);
+    if (profile_) {
+      // the RemoveGrain kernel takes most of the time, Clense runs on the same or a wider instruction set
+      const bool rgb = vi.IsPlanarRGB() || vi.IsPlanarRGBA();
+      const char *chroma = removegrain_table_name(vi, rgb ? rg_functions : rg_functions_chroma, mode_);
+      profile_->set_isa(0, removegrain_table_name(vi, rg_functions, mode_));
+      profile_->set_isa(1, chroma);
+      profile_->set_isa(2, chroma);
+    }
+
+    if (threads < 0) {
+      env->ThrowError("ClenseRG: threads must be 0 (auto) or positive!");
+    }
+    if (threads != 1) {
+      pool_ = ThreadPool::acquire();
+      stripes_ = stripes_for_threads(threads, pool_);
+    }
+}
+
+ClenseRG::~ClenseRG() {
+  if (pool_ != nullptr)
+    ThreadPool::release();
+}
+
+// The temporal median of a band of rows goes into a small buffer and RemoveGrain reads it back while
+// it is still in cache. Bands overlap by two rows like in RGRepair: the first and last row of a band
+// are RemoveGrain border rows, copied from the buffer. Row 0 of a later band is already final in pDst,
+// it is kept aside and written back after the band. Even band heights keep the field parity of
+// RemoveGrain modes 13-16.
+void ClenseRG::process_bands(bool chroma, const BYTE* pSrc, const BYTE* pPrev, const BYTE* pNext, BYTE* pDst, int rowsize, int height,
+  int srcPitch, int prevPitch, int nextPitch, int dstPitch, IScriptEnvironment* env) {
+  const int bufPitch = (rowsize + 63) & ~63;
+  const int band = std::min(std::max(256 * 1024 / bufPitch, 8), 64) & ~1;
+
+  std::vector<BYTE> buffer(bufPitch * (band + 1) + 64);
+  BYTE* pBuf = reinterpret_cast<BYTE*>(((uintptr_t)buffer.data() + 63) & ~(uintptr_t)63);
+  BYTE* pRow = pBuf + bufPitch * band; // final row 0 of the band
+
+  PlaneProcessor *rg = (chroma ? rg_functions_chroma : rg_functions)[mode_ + 1];
+  ClenseProcessor *clense = chroma ? clense_processor_chroma_ : clense_processor_;
+
+  for (int y = 0; ; y += band - 2) {
+    const int h = std::min(band, height - y);
+
+    clense(pBuf, pSrc + y * srcPitch, pPrev + y * prevPitch, pNext + y * nextPitch, bufPitch, srcPitch, prevPitch, nextPitch, rowsize, h, env);
+    if (y > 0)
+      memcpy(pRow, pDst + y * dstPitch, rowsize);
+    rg(env, pBuf, pDst + y * dstPitch, rowsize, h, bufPitch, dstPitch);
+    if (y > 0)
+      memcpy(pDst + y * dstPitch, pRow, rowsize);
+
+    if (y + h == height)
+      break;
+  }
+}
+
+void ClenseRG::process_plane(int p, bool chroma, const BYTE* pSrc, const BYTE* pPrev, const BYTE* pNext, BYTE* pDst, int rowsize, int height,
+  int srcPitch, int prevPitch, int nextPitch, int dstPitch, IScriptEnvironment* env) {
+  // the median stays in cache, three planes read and one written
+  PlaneTimer timer(profile_.get(), p, rowsize, height, 3);
+  process_plane_stripes(pool_, stripes_, 1, pDst, dstPitch, rowsize, height, [&](int y, int h, BYTE* pStripeDst, int stripeDstPitch) {
+    process_bands(chroma, pSrc + y * srcPitch, pPrev + y * prevPitch, pNext + y * nextPitch, pStripeDst, rowsize, h,
+      srcPitch, prevPitch, nextPitch, stripeDstPitch, env);
+  });
+}
+
+PVideoFrame ClenseRG::GetFrame(int n, IScriptEnvironment* env) {
+    auto srcFrame = child->GetFrame(n, env);
+    // Clense returns the first and the last frame as they are: the median of three copies of the source
+    const bool edge = n == 0 || n >= vi.num_frames - 1;
+    auto prevFrame = edge ? srcFrame : child->GetFrame(n - 1, env);
+    auto nextFrame = edge ? srcFrame : child->GetFrame(n + 1, env);
+    auto dstFrame = env->NewVideoFrame(vi);
+    FrameProfile frame_profile(profile_.get());
+
+    int planes_y[4] = { PLANAR_Y, PLANAR_U, PLANAR_V, PLANAR_A };
+    int planes_r[4] = { PLANAR_G, PLANAR_B, PLANAR_R, PLANAR_A };
+    int *planes = (vi.IsPlanarRGB() || vi.IsPlanarRGBA()) ? planes_r : planes_y;
+    const int num_planes = (vi.IsPlanar() && !vi.IsY()) ? 3 : 1;
+
+    for (int p = 0; p < num_planes; ++p) {
+      const int plane = planes[p];
+      process_plane(p, p > 0 && planes == planes_y, srcFrame->GetReadPtr(plane), prevFrame->GetReadPtr(plane), nextFrame->GetReadPtr(plane), dstFrame->GetWritePtr(plane),
+        srcFrame->GetRowSize(plane), srcFrame->GetHeight(plane), srcFrame->GetPitch(plane), prevFrame->GetPitch(plane), nextFrame->GetPitch(plane),
+        dstFrame->GetPitch(plane), env);
+    }
+    if (vi.IsYUVA() || vi.IsPlanarRGBA())
+    { // copy alpha
+      env->BitBlt(dstFrame->GetWritePtr(PLANAR_A), dstFrame->GetPitch(PLANAR_A), srcFrame->GetReadPtr(PLANAR_A), srcFrame->GetPitch(PLANAR_A), srcFrame->GetRowSize(PLANAR_A_ALIGNED), srcFrame->GetHeight(PLANAR_A));
+    }
+    frame_profile.attach(dstFrame, env);
+    return dstFrame;
+}
+
+
+AVSValue __cdecl Create_ClenseRG(AVSValue args, void*, IScriptEnvironment* env) {
+    enum { CLIP, MODE, PLANAR, OPTAVX2, THREADS, PROFILE };
+    return new ClenseRG(args[CLIP].AsClip(), args[MODE].AsInt(1),
+      args[PLANAR].AsBool(false), args[OPTAVX2].AsBool(true), args[THREADS].AsInt(1), args[PROFILE].AsBool(false), env);
+}
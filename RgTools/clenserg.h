@@ -0,0 +1,47 @@
+#ifndef __CLENSERG_H__
+#define __CLENSERG_H__
+
+#include "common.h"
+#include "thread_pool.h"
+#include "removegrain.h"
+#include "clense.h"
+
+
+// RemoveGrain(Clense(c), mode) in one pass, without the intermediate frame
+class ClenseRG : public GenericVideoFilter {
+public:
+    ClenseRG(PClip child, int mode, bool skip_cs_check, bool use_avx2, int threads, bool profile, IScriptEnvironment* env);
+    ~ClenseRG();
+
+    PVideoFrame __stdcall GetFrame(int n, IScriptEnvironment* env);
+
+    // profile=true, else nullptr
+    FilterProfile* profile() const { return profile_.get(); }
+
+    int __stdcall SetCacheHints(int cachehints, int frame_range) override {
+      return cachehints == CACHE_GET_MTMODE ? MT_NICE_FILTER : 0;
+    }
+
+private:
+    int mode_;
+
+    PlaneProcessor **rg_functions;
+    PlaneProcessor **rg_functions_chroma; // U and V, may be narrower than a vector
+    ClenseProcessor *clense_processor_;
+    ClenseProcessor *clense_processor_chroma_;
+
+    ThreadPool *pool_; // nullptr when threads=1
+    int stripes_;
+
+    std::shared_ptr<FilterProfile> profile_; // nullptr when profile=false
+
+    void process_plane(int p, bool chroma, const BYTE* pSrc, const BYTE* pPrev, const BYTE* pNext, BYTE* pDst, int rowsize, int height,
+      int srcPitch, int prevPitch, int nextPitch, int dstPitch, IScriptEnvironment* env);
+    void process_bands(bool chroma, const BYTE* pSrc, const BYTE* pPrev, const BYTE* pNext, BYTE* pDst, int rowsize, int height,
+      int srcPitch, int prevPitch, int nextPitch, int dstPitch, IScriptEnvironment* env);
+};
+
+
+AVSValue __cdecl Create_ClenseRG(AVSValue args, void*, IScriptEnvironment* env);
+
+#endif
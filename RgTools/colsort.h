@@ -0,0 +1,237 @@
+#ifndef __COLSORT_H__
+#define __COLSORT_H__
+
+#include "common.h"
+
+// Column sorted RemoveGrain modes 2 and 4 and Repair modes 2-4.
+//
+// With t[0..8] the sorted 3x3 window including the centre, RemoveGrain mode k is
+// clip(c, t[k], t[8-k]) and Repair mode k is clip(val, t[k-1], t[9-k]).
+// Every 3 pixel column is sorted once per row into a small buffer and then shared by
+// the three output pixels it belongs to. The ranks are picked from the sorted columns
+// a (x-1), b (x) and c (x+1). Sorting the rows of that 3x3 matrix as well gives m[row][i],
+// row 0/1/2 = column minimums/middles/maximums, and every rank is a few min/max of it.
+// RemoveGrain 2 works on the 8 neighbours, using the sorted pair above/below.
+//
+// Comparators per output vector, sorting networks -> column sorted:
+// RemoveGrain 2: 32 -> 24, 4: 30 -> 18
+// Repair      2: 41 -> 22, 3: 43 -> 28, 4: 43 -> 32
+// RemoveGrain 1, 3 and Repair 1 gain little or nothing in comparators and lose the two row
+// blocking, they stay with the sorting networks. Output is identical to the sorting networks.
+
+enum ColsortRank {
+    CS_RANK1_8,   // RemoveGrain 2: 2nd smallest/largest of the 8 neighbours
+    CS_RANK1,     // Repair 2
+    CS_RANK2,     // Repair 3
+    CS_RANK3,     // Repair 4
+    CS_MEDIAN     // RemoveGrain 4, no clip
+};
+
+// vector operations, one struct per instruction set and pixel type
+
+template<InstructionSet optLevel>
+struct ColsortSse8 {
+    typedef __m128i V;
+    typedef uint8_t pixel_t;
+    enum { pixels = 16 };
+    static RG_FORCEINLINE V load(const Byte* p) { return simd_loadu_si128<optLevel>(p); }
+    static RG_FORCEINLINE void store(Byte* p, V v) { _mm_storeu_si128(reinterpret_cast<__m128i*>(p), v); }
+    static RG_FORCEINLINE V vmin(V a, V b) { return _mm_min_epu8(a, b); }
+    static RG_FORCEINLINE V vmax(V a, V b) { return _mm_max_epu8(a, b); }
+    static RG_FORCEINLINE void zeroupper() {}
+};
+
+// SSE4.1
+struct ColsortSse16 {
+    typedef __m128i V;
+    typedef uint16_t pixel_t;
+    enum { pixels = 8 };
+    static RG_FORCEINLINE V load(const Byte* p) { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)); }
+    static RG_FORCEINLINE void store(Byte* p, V v) { _mm_storeu_si128(reinterpret_cast<__m128i*>(p), v); }
+    static RG_FORCEINLINE V vmin(V a, V b) { return _mm_min_epu16(a, b); }
+    static RG_FORCEINLINE V vmax(V a, V b) { return _mm_max_epu16(a, b); }
+    static RG_FORCEINLINE void zeroupper() {}
+};
+
+struct ColsortSse32 {
+    typedef __m128 V;
+    typedef float pixel_t;
+    enum { pixels = 4 };
+    static RG_FORCEINLINE V load(const Byte* p) { return _mm_loadu_ps(reinterpret_cast<const float*>(p)); }
+    static RG_FORCEINLINE void store(Byte* p, V v) { _mm_storeu_ps(reinterpret_cast<float*>(p), v); }
+    static RG_FORCEINLINE V vmin(V a, V b) { return _mm_min_ps(a, b); }
+    static RG_FORCEINLINE V vmax(V a, V b) { return _mm_max_ps(a, b); }
+    static RG_FORCEINLINE void zeroupper() {}
+};
+
+
+template<typename Ops>
+static RG_FORCEINLINE typename Ops::V colsort_med3(typename Ops::V x, typename Ops::V y, typename Ops::V z) {
+    return Ops::vmax(Ops::vmin(x, y), Ops::vmin(Ops::vmax(x, y), z));
+}
+
+// sorts columns [0, n) of the rows above, at and below pWin into lo/mid/hi, n >= Ops::pixels
+template<typename Ops>
+static RG_FORCEINLINE void colsort_sort_columns(const Byte* pWin, int pitch, Byte* lo, Byte* mid, Byte* hi, int n) {
+    typedef typename Ops::V V;
+    for (int i = 0; i < n; i += Ops::pixels) {
+        const int x = std::min(i, n - (int)Ops::pixels) * sizeof(typename Ops::pixel_t);
+        const V m = Ops::load(pWin + x);
+        const V t = Ops::load(pWin - pitch + x);
+        const V b = Ops::load(pWin + pitch + x);
+        const V l = Ops::vmin(t, b);
+        const V h = Ops::vmax(t, b);
+        Ops::store(lo + x, Ops::vmin(l, m));
+        Ops::store(mid + x, Ops::vmax(l, Ops::vmin(h, m)));
+        Ops::store(hi + x, Ops::vmax(h, m));
+    }
+}
+
+// one output vector, lo/mid/hi at the sorted column left of it, pWin at the centre pixel
+template<typename Ops, int rank>
+static RG_FORCEINLINE typename Ops::V colsort_select(const Byte* lo, const Byte* mid, const Byte* hi, const Byte* pWin, int pitch, typename Ops::V val) {
+    typedef typename Ops::V V;
+    const int ps = sizeof(typename Ops::pixel_t);
+
+    const V a0 = Ops::load(lo), c0 = Ops::load(lo + 2 * ps);
+    const V a2 = Ops::load(hi), c2 = Ops::load(hi + 2 * ps);
+    V mi, ma;
+
+    if (rank == CS_RANK1_8) {
+        // 2nd of the column minimums, or the 2nd element of the column holding the minimum
+        const V t = Ops::load(pWin - pitch);
+        const V b = Ops::load(pWin + pitch);
+        const V bt0 = Ops::vmin(t, b);
+        const V bt1 = Ops::vmax(t, b);
+        const V a1 = Ops::load(mid), c1 = Ops::load(mid + 2 * ps);
+        mi = Ops::vmin(Ops::vmin(colsort_med3<Ops>(a0, bt0, c0), Ops::vmin(a1, c1)), bt1);
+        ma = Ops::vmax(Ops::vmax(colsort_med3<Ops>(a2, bt1, c2), Ops::vmax(a1, c1)), bt0);
+        return Ops::vmax(Ops::vmin(val, ma), mi);
+    }
+
+    const V b0 = Ops::load(lo + ps), b2 = Ops::load(hi + ps);
+    const V a1 = Ops::load(mid), b1 = Ops::load(mid + ps), c1 = Ops::load(mid + 2 * ps);
+    if (rank == CS_MEDIAN) {
+        const V m02 = Ops::vmax(Ops::vmax(a0, b0), c0);
+        const V m20 = Ops::vmin(Ops::vmin(a2, b2), c2);
+        return colsort_med3<Ops>(m02, colsort_med3<Ops>(a1, b1, c1), m20);
+    }
+
+    // sorted rows, only the elements a rank needs survive dead code elimination
+    V p = Ops::vmin(a0, b0), q = Ops::vmax(a0, b0);
+    const V m01 = Ops::vmax(p, Ops::vmin(q, c0));
+    const V m02 = Ops::vmax(q, c0);
+    p = Ops::vmin(a1, b1); q = Ops::vmax(a1, b1);
+    const V m10 = Ops::vmin(p, c1);
+    const V m11 = Ops::vmax(p, Ops::vmin(q, c1));
+    const V m12 = Ops::vmax(q, c1);
+    p = Ops::vmin(a2, b2); q = Ops::vmax(a2, b2);
+    const V m20 = Ops::vmin(p, c2);
+    const V m21 = Ops::vmin(q, Ops::vmax(p, c2));
+
+    if (rank == CS_RANK1) {
+        mi = Ops::vmin(m01, m10);
+        ma = Ops::vmax(m21, m12);
+    } else if (rank == CS_RANK2) {
+        mi = Ops::vmin(Ops::vmin(Ops::vmax(m01, m10), m02), m20);
+        ma = Ops::vmax(Ops::vmax(Ops::vmin(m12, m21), m20), m02);
+    } else {
+        mi = Ops::vmax(Ops::vmax(m01, m10), Ops::vmin(Ops::vmin(m02, m20), m11));
+        ma = Ops::vmin(Ops::vmin(m12, m21), Ops::vmax(Ops::vmax(m20, m02), m11));
+    }
+    return Ops::vmax(Ops::vmin(val, ma), mi);
+}
+
+// Inner pixels of one row. pWin: row of the 3x3 windows, pVal: row of the clipped values
+// (the same as pWin for RemoveGrain). The row is done in chunks, so the sorted columns
+// stay in L1 even for wide float planes. width >= Ops::pixels + 2.
+template<typename Ops, int rank>
+static RG_FORCEINLINE void colsort_row(Byte* pDst, const Byte* pVal, const Byte* pWin, int winPitch, int width) {
+    typedef typename Ops::pixel_t pixel_t;
+    const int step = Ops::pixels;
+    const int chunk = 1024 / sizeof(pixel_t);
+
+    // chunk + 2 columns, the last chunk can be up to a vector longer
+    alignas(16) Byte lo[(chunk + 3 * step) * sizeof(pixel_t)];
+    alignas(16) Byte mid[(chunk + 3 * step) * sizeof(pixel_t)];
+    alignas(16) Byte hi[(chunk + 3 * step) * sizeof(pixel_t)];
+
+    for (int x0 = 1; x0 < width - 1; ) {
+        const int remaining = width - 1 - x0;
+        const int n = remaining < chunk + step ? remaining : chunk;
+        const int offset = x0 * sizeof(pixel_t);
+
+        colsort_sort_columns<Ops>(pWin + offset - sizeof(pixel_t), winPitch, lo, mid, hi, n + 2);
+
+        for (int i = 0; i < n; i += step) {
+            const int x = std::max(0, std::min(i, n - step)) * sizeof(pixel_t);
+            const typename Ops::V val = Ops::load(pVal + offset + x);
+            Ops::store(pDst + offset + x, colsort_select<Ops, rank>(lo + x, mid + x, hi + x, pWin + offset + x, winPitch, val));
+        }
+        x0 += n;
+    }
+}
+
+// colsort_row for planes narrower than Ops::pixels + 2, on zero padded copies of the rows, see stage_rows
+template<typename Ops, int rank>
+static RG_FORCEINLINE void colsort_row_staged(Byte* pDst, const Byte* pVal, const Byte* pWin, int winPitch, int width) {
+    const int ps = sizeof(typename Ops::pixel_t);
+    alignas(64) Byte stage[3 * RG_STAGE_PITCH];
+    alignas(64) Byte val[RG_STAGE_PITCH] = {};
+    alignas(64) Byte out[RG_STAGE_PITCH];
+    stage_rows(stage, pWin, winPitch, width * ps);
+    memcpy(val, pVal, width * ps);
+    colsort_row<Ops, rank>(out, val, stage + RG_STAGE_PITCH, RG_STAGE_PITCH, Ops::pixels + 2);
+    memcpy(pDst + ps, out + ps, (width - 2) * ps);
+}
+
+// RemoveGrain plane processor
+template<typename Ops, int rank>
+static void process_plane_colsort(IScriptEnvironment* env, const BYTE* pSrc, BYTE* pDst, int rowsize, int height, int srcPitch, int dstPitch) {
+    typedef typename Ops::pixel_t pixel_t;
+    Ops::zeroupper();
+    env->BitBlt(pDst, dstPitch, pSrc, srcPitch, rowsize, 1);
+
+    const int width = rowsize / sizeof(pixel_t);
+
+    for (int y = 1; y < height - 1; ++y) {
+        pSrc += srcPitch;
+        pDst += dstPitch;
+        if (width >= Ops::pixels + 2)
+            colsort_row<Ops, rank>(pDst, pSrc, pSrc, srcPitch, width);
+        else if (width > 2)
+            colsort_row_staged<Ops, rank>(pDst, pSrc, pSrc, srcPitch, width);
+        reinterpret_cast<pixel_t*>(pDst)[0] = reinterpret_cast<const pixel_t*>(pSrc)[0];
+        reinterpret_cast<pixel_t*>(pDst)[width - 1] = reinterpret_cast<const pixel_t*>(pSrc)[width - 1];
+    }
+    Ops::zeroupper();
+
+    env->BitBlt(pDst + dstPitch, dstPitch, pSrc + srcPitch, srcPitch, rowsize, 1);
+}
+
+// Repair plane processor, windows from pRef, clipped values from pSrc
+template<typename Ops, int rank>
+static void process_plane_colsort(IScriptEnvironment* env, BYTE* pDst, const BYTE* pSrc, const BYTE* pRef, int dstPitch, int srcPitch, int refPitch, int rowsize, int height) {
+    typedef typename Ops::pixel_t pixel_t;
+    Ops::zeroupper();
+    env->BitBlt(pDst, dstPitch, pSrc, srcPitch, rowsize, 1);
+
+    const int width = rowsize / sizeof(pixel_t);
+
+    for (int y = 1; y < height - 1; ++y) {
+        pSrc += srcPitch;
+        pDst += dstPitch;
+        pRef += refPitch;
+        if (width >= Ops::pixels + 2)
+            colsort_row<Ops, rank>(pDst, pSrc, pRef, refPitch, width);
+        else if (width > 2)
+            colsort_row_staged<Ops, rank>(pDst, pSrc, pRef, refPitch, width);
+        reinterpret_cast<pixel_t*>(pDst)[0] = reinterpret_cast<const pixel_t*>(pSrc)[0];
+        reinterpret_cast<pixel_t*>(pDst)[width - 1] = reinterpret_cast<const pixel_t*>(pSrc)[width - 1];
+    }
+    Ops::zeroupper();
+
+    env->BitBlt(pDst + dstPitch, dstPitch, pSrc + srcPitch, srcPitch, rowsize, 1);
+}
+
+#endif
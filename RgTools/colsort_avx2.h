@@ -0,0 +1,42 @@
+#ifndef __COLSORT_AVX2_H__
+#define __COLSORT_AVX2_H__
+
+#include "common_avx2.h"
+#include "colsort.h"
+
+// AVX2 vector operations for the column sorted modes, see colsort.h
+
+struct ColsortAvx2_8 {
+    typedef __m256i V;
+    typedef uint8_t pixel_t;
+    enum { pixels = 32 };
+    static RG_FORCEINLINE V load(const Byte* p) { return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)); }
+    static RG_FORCEINLINE void store(Byte* p, V v) { _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), v); }
+    static RG_FORCEINLINE V vmin(V a, V b) { return _mm256_min_epu8(a, b); }
+    static RG_FORCEINLINE V vmax(V a, V b) { return _mm256_max_epu8(a, b); }
+    static RG_FORCEINLINE void zeroupper() { _mm256_zeroupper(); }
+};
+
+struct ColsortAvx2_16 {
+    typedef __m256i V;
+    typedef uint16_t pixel_t;
+    enum { pixels = 16 };
+    static RG_FORCEINLINE V load(const Byte* p) { return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)); }
+    static RG_FORCEINLINE void store(Byte* p, V v) { _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), v); }
+    static RG_FORCEINLINE V vmin(V a, V b) { return _mm256_min_epu16(a, b); }
+    static RG_FORCEINLINE V vmax(V a, V b) { return _mm256_max_epu16(a, b); }
+    static RG_FORCEINLINE void zeroupper() { _mm256_zeroupper(); }
+};
+
+struct ColsortAvx2_32 {
+    typedef __m256 V;
+    typedef float pixel_t;
+    enum { pixels = 8 };
+    static RG_FORCEINLINE V load(const Byte* p) { return _mm256_loadu_ps(reinterpret_cast<const float*>(p)); }
+    static RG_FORCEINLINE void store(Byte* p, V v) { _mm256_storeu_ps(reinterpret_cast<float*>(p), v); }
+    static RG_FORCEINLINE V vmin(V a, V b) { return _mm256_min_ps(a, b); }
+    static RG_FORCEINLINE V vmax(V a, V b) { return _mm256_max_ps(a, b); }
+    static RG_FORCEINLINE void zeroupper() { _mm256_zeroupper(); }
+};
+
+#endif
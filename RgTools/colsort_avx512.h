@@ -0,0 +1,42 @@
+#ifndef __COLSORT_AVX512_H__
+#define __COLSORT_AVX512_H__
+
+#include "common_avx512.h"
+#include "colsort.h"
+
+// AVX-512 vector operations for the column sorted modes, see colsort.h
+
+struct ColsortAvx512_8 {
+    typedef __m512i V;
+    typedef uint8_t pixel_t;
+    enum { pixels = 64 };
+    static RG_FORCEINLINE V load(const Byte* p) { return _mm512_loadu_si512(reinterpret_cast<const __m512i*>(p)); }
+    static RG_FORCEINLINE void store(Byte* p, V v) { _mm512_storeu_si512(reinterpret_cast<__m512i*>(p), v); }
+    static RG_FORCEINLINE V vmin(V a, V b) { return _mm512_min_epu8(a, b); }
+    static RG_FORCEINLINE V vmax(V a, V b) { return _mm512_max_epu8(a, b); }
+    static RG_FORCEINLINE void zeroupper() { _mm256_zeroupper(); }
+};
+
+struct ColsortAvx512_16 {
+    typedef __m512i V;
+    typedef uint16_t pixel_t;
+    enum { pixels = 32 };
+    static RG_FORCEINLINE V load(const Byte* p) { return _mm512_loadu_si512(reinterpret_cast<const __m512i*>(p)); }
+    static RG_FORCEINLINE void store(Byte* p, V v) { _mm512_storeu_si512(reinterpret_cast<__m512i*>(p), v); }
+    static RG_FORCEINLINE V vmin(V a, V b) { return _mm512_min_epu16(a, b); }
+    static RG_FORCEINLINE V vmax(V a, V b) { return _mm512_max_epu16(a, b); }
+    static RG_FORCEINLINE void zeroupper() { _mm256_zeroupper(); }
+};
+
+struct ColsortAvx512_32 {
+    typedef __m512 V;
+    typedef float pixel_t;
+    enum { pixels = 16 };
+    static RG_FORCEINLINE V load(const Byte* p) { return _mm512_loadu_ps(reinterpret_cast<const float*>(p)); }
+    static RG_FORCEINLINE void store(Byte* p, V v) { _mm512_storeu_ps(reinterpret_cast<float*>(p), v); }
+    static RG_FORCEINLINE V vmin(V a, V b) { return _mm512_min_ps(a, b); }
+    static RG_FORCEINLINE V vmax(V a, V b) { return _mm512_max_ps(a, b); }
+    static RG_FORCEINLINE void zeroupper() { _mm256_zeroupper(); }
+};
+
+#endif
@@ -2,8 +2,12 @@
 #define __COMMON_H__
 
 #include <algorithm>
+#include <cstdint>
+#include <cstring>
+#ifdef _WIN32
 #define NOMINMAX
 #include <Windows.h>
+#endif
 #pragma warning(disable: 4512 4244 4100)
 #include "avisynth.h"
 #pragma warning(default: 4512 4244 4100)
@@ -11,15 +15,28 @@
 
 typedef unsigned char Byte;
 
-#define RG_FORCEINLINE __forceinline
+#define RG_FORCEINLINE AVS_FORCEINLINE
 
 #define USE_MOVPS
 
+// output rows per iteration in the row blocked plane loops of the cheap modes,
+// 32 bit x86 has only 8 xmm registers and would spill the shared source rows
+#if defined(_M_X64) || defined(__x86_64__)
+#define RG_BLOCK_ROWS 2
+#else
+#define RG_BLOCK_ROWS 1
+#endif
+
 enum InstructionSet {
     SSE2,
-    SSE3
+    SSE3,
+    SSSE3 // palignr neighbour loads, see simd_loadn_si128
 };
 
+// AVX-512 F, BW and VL usable: CPU support and ZMM/opmask state enabled by the OS.
+// Own CPUID/XGETBV check, GetCPUFlags of the supported Avisynth versions has no AVX-512 flags
+bool cpu_has_avx512bw();
+
 template<typename T>
 static RG_FORCEINLINE Byte clip(T val, T minimum, T maximum) {
     return std::max(std::min(val, maximum), minimum);
@@ -37,10 +54,47 @@ static RG_FORCEINLINE float clip_32(T val, T minimum, T maximum) {
   return std::max(std::min(val, maximum), minimum);
 }
 
+// scalar sorting networks, fixed min/max sequences instead of std::sort:
+// no branches, so the C loops can be vectorized by the compiler
+template<typename T>
+static RG_FORCEINLINE void sort_pair_c(T &a1, T &a2) {
+  const T tmp = std::min(a1, a2);
+  a2 = std::max(a1, a2);
+  a1 = tmp;
+}
+
+// 19 comparators
+template<typename T>
+static RG_FORCEINLINE void sort8_c(T (&a)[8]) {
+  sort_pair_c(a[0], a[2]); sort_pair_c(a[1], a[3]); sort_pair_c(a[4], a[6]); sort_pair_c(a[5], a[7]);
+  sort_pair_c(a[0], a[4]); sort_pair_c(a[1], a[5]); sort_pair_c(a[2], a[6]); sort_pair_c(a[3], a[7]);
+  sort_pair_c(a[0], a[1]); sort_pair_c(a[2], a[3]); sort_pair_c(a[4], a[5]); sort_pair_c(a[6], a[7]);
+  sort_pair_c(a[2], a[4]); sort_pair_c(a[3], a[5]);
+  sort_pair_c(a[1], a[4]); sort_pair_c(a[3], a[6]);
+  sort_pair_c(a[1], a[2]); sort_pair_c(a[3], a[4]); sort_pair_c(a[5], a[6]);
+}
+
+// 25 comparators
+template<typename T>
+static RG_FORCEINLINE void sort9_c(T (&a)[9]) {
+  sort_pair_c(a[0], a[3]); sort_pair_c(a[1], a[7]); sort_pair_c(a[2], a[5]); sort_pair_c(a[4], a[8]);
+  sort_pair_c(a[0], a[7]); sort_pair_c(a[2], a[4]); sort_pair_c(a[3], a[8]); sort_pair_c(a[5], a[6]);
+  sort_pair_c(a[0], a[2]); sort_pair_c(a[1], a[3]); sort_pair_c(a[4], a[5]); sort_pair_c(a[7], a[8]);
+  sort_pair_c(a[1], a[4]); sort_pair_c(a[3], a[6]); sort_pair_c(a[5], a[7]);
+  sort_pair_c(a[0], a[1]); sort_pair_c(a[2], a[4]); sort_pair_c(a[3], a[5]); sort_pair_c(a[6], a[8]);
+  sort_pair_c(a[2], a[3]); sort_pair_c(a[4], a[5]); sort_pair_c(a[6], a[7]);
+  sort_pair_c(a[1], a[2]); sort_pair_c(a[3], a[4]); sort_pair_c(a[5], a[6]);
+}
+
 static RG_FORCEINLINE bool is_16byte_aligned(const void *ptr) {
     return (((uintptr_t)ptr) & 15) == 0;
 }
 
+// every line of the plane starts on a 16 byte boundary (false after an unaligned crop)
+static RG_FORCEINLINE bool is_16byte_aligned_plane(const void *ptr, int pitch) {
+    return is_16byte_aligned(ptr) && (pitch & 15) == 0;
+}
+
 static RG_FORCEINLINE __m128i simd_clip(const __m128i &val, const __m128i &minimum, const __m128i &maximum) {
   return _mm_max_epu8(_mm_min_epu8(val, maximum), minimum);
 }
@@ -107,6 +161,84 @@ static RG_FORCEINLINE __m128i simd_loada_si128(const Byte* ptr) {
   return _mm_load_si128(reinterpret_cast<const __m128i*>(ptr));
 }
 
+// Horizontal neighbour of an aligned vector: ptr + offset, offset = +-pixelsize.
+// SSSE3 builds it with palignr from the aligned vectors left or right of ptr, the
+// unaligned load would split a cache line for every fourth vector. The aligned loads
+// are the ones the neighbouring columns and the centre load use anyway.
+// Only worth it where split loads are slow (Core 2, Atom), from Nehalem on the
+// unaligned loads are faster than the extra shuffles.
+// Reads the whole aligned vector around ptr + offset, which is safe for the same reason
+// the unaligned load at ptr + offset is.
+template<InstructionSet optLevel, int offset>
+static RG_FORCEINLINE __m128i simd_loadn_si128(const Byte* ptr) {
+  if (optLevel < SSSE3)
+    return simd_loadu_si128<optLevel>(ptr + offset);
+  const __m128i centre = _mm_load_si128(reinterpret_cast<const __m128i*>(ptr));
+  if (offset < 0)
+    return _mm_alignr_epi8(centre, _mm_load_si128(reinterpret_cast<const __m128i*>(ptr - 16)), (16 + offset) & 15);
+  return _mm_alignr_epi8(_mm_load_si128(reinterpret_cast<const __m128i*>(ptr + 16)), centre, offset & 15);
+}
+
+// aligned=false for planes of unaligned crops
+template<bool aligned>
+static RG_FORCEINLINE __m128i simd_load_si128(const Byte* ptr) {
+  if (aligned)
+    return _mm_load_si128(reinterpret_cast<const __m128i*>(ptr));
+  return _mm_loadu_si128(reinterpret_cast<const __m128i*>(ptr));
+}
+
+template<bool aligned>
+static RG_FORCEINLINE void simd_store_si128(Byte* ptr, __m128i value) {
+  if (aligned)
+    _mm_store_si128(reinterpret_cast<__m128i*>(ptr), value);
+  else
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(ptr), value);
+}
+
+template<bool aligned>
+static RG_FORCEINLINE __m128 simd_load_ps(const Byte* ptr) {
+  if (aligned)
+    return _mm_load_ps(reinterpret_cast<const float*>(ptr));
+  return _mm_loadu_ps(reinterpret_cast<const float*>(ptr));
+}
+
+template<bool aligned>
+static RG_FORCEINLINE void simd_store_ps(Byte* ptr, __m128 value) {
+  if (aligned)
+    _mm_store_ps(reinterpret_cast<float*>(ptr), value);
+  else
+    _mm_storeu_ps(reinterpret_cast<float*>(ptr), value);
+}
+
+// Planes narrower than a vector + 2 pixels (chroma of small clips): the overlapping first and
+// last vector of the row loops would read and write outside the row. The 3 rows around the row
+// at pSrc (pixel 0 = the left neighbour of the first output) are copied into a zero padded
+// buffer, the kernel runs on the copy with its centre at stage + RG_STAGE_PITCH + pixelsize.
+// Wide enough for a 512 bit vector of 8 bit pixels and its neighbours.
+#define RG_STAGE_PITCH 128
+
+static RG_FORCEINLINE void stage_rows(Byte* stage, const Byte* pSrc, int srcPitch, int bytes) {
+  memset(stage, 0, 3 * RG_STAGE_PITCH);
+  for (int r = 0; r < 3; ++r)
+    memcpy(stage + r * RG_STAGE_PITCH, pSrc + (r - 1) * srcPitch, bytes);
+}
+
+// inner width - 2 pixels of one narrow row, kernel(pCentre, pitch) returns one vector
+template<typename pixel_t, typename Kernel>
+static RG_FORCEINLINE void process_row_staged(Byte* pDst, const Byte* pSrc, int srcPitch, int width, Kernel kernel) {
+  alignas(64) Byte stage[3 * RG_STAGE_PITCH];
+  stage_rows(stage, pSrc, srcPitch, width * sizeof(pixel_t));
+  const auto result = kernel(stage + RG_STAGE_PITCH + sizeof(pixel_t), RG_STAGE_PITCH);
+  memcpy(pDst + sizeof(pixel_t), &result, (width - 2) * sizeof(pixel_t));
+}
+
+// width of the U and V planes, the SIMD width of the plane tables is chosen by it
+static RG_FORCEINLINE int chroma_plane_width(const VideoInfo& vi) {
+  if (!vi.IsPlanar() || vi.IsY() || vi.IsPlanarRGB() || vi.IsPlanarRGBA())
+    return vi.width;
+  return vi.width >> vi.GetPlaneWidthSubsampling(PLANAR_U);
+}
+
 //mask ? a : b
 static RG_FORCEINLINE __m128i blend(__m128i const &mask, __m128i const &desired, __m128i const &otherwise) {
   //return  _mm_blendv_epi8 (otherwise, desired, mask);
@@ -204,8 +336,8 @@ if(!aligned) {\
 a1 = simd_loadu_si128<optLevel>((ptr) - (pitch) - (pixelsize)); \
 a8 = simd_loadu_si128<optLevel>((ptr) + (pitch) + (pixelsize)); \
 } else {\
-a1 = simd_loadu_si128<optLevel>((ptr) - (pitch) - (pixelsize)); \
-a8 = simd_loadu_si128<optLevel>((ptr) + (pitch) + (pixelsize)); \
+a1 = simd_loadn_si128<optLevel, -(pixelsize)>((ptr) - (pitch)); \
+a8 = simd_loadn_si128<optLevel, (pixelsize)>((ptr) + (pitch)); \
 }
 
 #define LOAD_SQUARE_SSE_0_27(optLevel, ptr, pitch, pixelsize, aligned) \
@@ -224,8 +356,8 @@ if(!aligned) {\
 a3 = simd_loadu_si128<optLevel>((ptr) - (pitch) + (pixelsize)); \
 a6 = simd_loadu_si128<optLevel>((ptr) + (pitch) - (pixelsize)); \
 } else {\
-a3 = simd_loadu_si128<optLevel>((ptr) - (pitch) + (pixelsize)); \
-a6 = simd_loadu_si128<optLevel>((ptr) + (pitch) - (pixelsize)); \
+a3 = simd_loadn_si128<optLevel, (pixelsize)>((ptr) - (pitch)); \
+a6 = simd_loadn_si128<optLevel, -(pixelsize)>((ptr) + (pitch)); \
 }
 
 #define LOAD_SQUARE_SSE_0_45(optLevel, ptr, pitch, pixelsize, aligned) \
@@ -234,8 +366,8 @@ if(!aligned) {\
 a4 = simd_loadu_si128<optLevel>((ptr) - (pixelsize)); \
 a5 = simd_loadu_si128<optLevel>((ptr) + (pixelsize)); \
 } else {\
-a4 = simd_loadu_si128<optLevel>((ptr) - (pixelsize)); \
-a5 = simd_loadu_si128<optLevel>((ptr) + (pixelsize)); \
+a4 = simd_loadn_si128<optLevel, -(pixelsize)>(ptr); \
+a5 = simd_loadn_si128<optLevel, (pixelsize)>(ptr); \
 }
 
 #define LOAD_SQUARE_SSE_0_Cent(optLevel, ptr, pitch, pixelsize, aligned) \
@@ -259,15 +391,15 @@ a6 = simd_loadu_si128<optLevel>((ptr) + (pitch) - (pixelsize)); \
 a7 = simd_loadu_si128<optLevel>((ptr) + (pitch)); \
 a8 = simd_loadu_si128<optLevel>((ptr) + (pitch) + (pixelsize)); \
 } else {\
-a1 = simd_loadu_si128<optLevel>((ptr) - (pitch) - (pixelsize)); \
+a1 = simd_loadn_si128<optLevel, -(pixelsize)>((ptr) - (pitch)); \
 a2 = simd_loada_si128<optLevel>((ptr) - (pitch)); \
-a3 = simd_loadu_si128<optLevel>((ptr) - (pitch) + (pixelsize)); \
-a4 = simd_loadu_si128<optLevel>((ptr) - (pixelsize)); \
+a3 = simd_loadn_si128<optLevel, (pixelsize)>((ptr) - (pitch)); \
+a4 = simd_loadn_si128<optLevel, -(pixelsize)>(ptr); \
 c  = simd_loada_si128<optLevel>((ptr) ); \
-a5 = simd_loadu_si128<optLevel>((ptr) + (pixelsize)); \
-a6 = simd_loadu_si128<optLevel>((ptr) + (pitch) - (pixelsize)); \
+a5 = simd_loadn_si128<optLevel, (pixelsize)>(ptr); \
+a6 = simd_loadn_si128<optLevel, -(pixelsize)>((ptr) + (pitch)); \
 a7 = simd_loada_si128<optLevel>((ptr) + (pitch)); \
-a8 = simd_loadu_si128<optLevel>((ptr) + (pitch) + (pixelsize)); \
+a8 = simd_loadn_si128<optLevel, (pixelsize)>((ptr) + (pitch)); \
 }
 
 // 8 bit loads
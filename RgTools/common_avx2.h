@@ -2,8 +2,10 @@
 #define __COMMON_AVX2_H__
 
 #include <algorithm>
+#ifdef _WIN32
 #define NOMINMAX
 #include <Windows.h>
+#endif
 #pragma warning(disable: 4512 4244 4100)
 #include "avisynth.h"
 #pragma warning(default: 4512 4244 4100)
@@ -12,7 +14,7 @@
 
 typedef unsigned char Byte;
 
-#define RG_FORCEINLINE __forceinline
+#define RG_FORCEINLINE AVS_FORCEINLINE
 
 /*
 template<typename T>
@@ -136,14 +138,24 @@ static RG_FORCEINLINE __m256 abs_diff_32(__m256 a, __m256 b) {
 
 // PF until I find out better
 static RG_FORCEINLINE __m256 _mm256_subs_ps(__m256 a, __m256 b) {
+#if 0
 const __m256 zero = _mm256_setzero_ps();
 return _mm256_max_ps(_mm256_sub_ps(a, b), zero);
+#else
+  // no float clamp, same as SSE
+  return _mm256_sub_ps(a, b);
+#endif
 }
 
 // PF until I find out better
 static RG_FORCEINLINE __m256 _mm256_adds_ps(__m256 a, __m256 b) {
+#if 0
   const __m256 one = _mm256_set1_ps(1.0f);
   return _mm256_min_ps(_mm256_add_ps(a, b), one);
+#else
+  // no float clamp, same as SSE
+  return _mm256_add_ps(a, b);
+#endif
 }
 
 // PF until I find out better
@@ -152,6 +164,11 @@ static RG_FORCEINLINE __m256 _mm256_avg_ps(__m256 a, __m256 b) {
   return _mm256_mul_ps(_mm256_add_ps(a, b), div2);
 }
 
+// 2 * x + y in one rounding, FMA3 only
+static RG_FORCEINLINE __m256 fma_twice_plus_32(__m256 x, __m256 y) {
+  return _mm256_fmadd_ps(x, _mm256_set1_ps(2.0f), y);
+}
+
 static RG_FORCEINLINE __m256i select_on_equal(const __m256i &cmp1, const __m256i &cmp2, const __m256i &current, const __m256i &desired) {
   auto eq = _mm256_cmpeq_epi8(cmp1, cmp2);
   return blend(eq, desired, current);
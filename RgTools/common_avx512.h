@@ -0,0 +1,221 @@
+#ifndef __COMMON_AVX512_H__
+#define __COMMON_AVX512_H__
+
+#include <algorithm>
+#ifdef _WIN32
+#define NOMINMAX
+#include <Windows.h>
+#endif
+#pragma warning(disable: 4512 4244 4100)
+#include "avisynth.h"
+#pragma warning(default: 4512 4244 4100)
+#include <immintrin.h>
+#include "common.h"
+
+typedef unsigned char Byte;
+
+#define RG_FORCEINLINE AVS_FORCEINLINE
+
+// AVX-512 F + BW (+ VL for the masked 8/16 bit stores), see cpu_has_avx512bw.
+// Same helpers as common_avx2.h on 64 byte vectors. Compares produce __mmask registers,
+// selections are mask blends instead of and/andnot/or or blendv.
+
+static RG_FORCEINLINE __m512i simd_clip(const __m512i &val, const __m512i &minimum, const __m512i &maximum) {
+  return _mm512_max_epu8(_mm512_min_epu8(val, maximum), minimum);
+}
+
+static RG_FORCEINLINE __m512i simd_clip_16(const __m512i &val, const __m512i &minimum, const __m512i &maximum) {
+  return _mm512_max_epu16(_mm512_min_epu16(val, maximum), minimum);
+}
+
+static RG_FORCEINLINE __m512 simd_clip_32(const __m512 &val, const __m512 &minimum, const __m512 &maximum) {
+  return _mm512_max_ps(_mm512_min_ps(val, maximum), minimum);
+}
+
+static RG_FORCEINLINE void sort_pair(__m512i &a1, __m512i &a2)
+{
+  const __m512i tmp = _mm512_min_epu8 (a1, a2);
+  a2 = _mm512_max_epu8 (a1, a2);
+  a1 = tmp;
+}
+
+static RG_FORCEINLINE void sort_pair_16(__m512i &a1, __m512i &a2)
+{
+  const __m512i tmp = _mm512_min_epu16 (a1, a2);
+  a2 = _mm512_max_epu16 (a1, a2);
+  a1 = tmp;
+}
+
+static RG_FORCEINLINE void sort_pair_32(__m512 &a1, __m512 &a2)
+{
+  const __m512 tmp = _mm512_min_ps (a1, a2);
+  a2 = _mm512_max_ps (a1, a2);
+  a1 = tmp;
+}
+
+static RG_FORCEINLINE __m512i simd_loadu_si512(const Byte* ptr) {
+  return _mm512_loadu_si512(reinterpret_cast<const __m512i*>(ptr));
+}
+
+static RG_FORCEINLINE __m512i simd_loada_si512(const Byte* ptr) {
+  return _mm512_load_si512(reinterpret_cast<const __m512i*>(ptr));
+}
+
+// byte masks for the partial first/last vectors of a row, n in bytes (0..64)
+static RG_FORCEINLINE __mmask64 first_bytes_mask(int n) {
+  return n >= 64 ? ~0ULL : (1ULL << n) - 1;
+}
+
+static RG_FORCEINLINE __mmask64 from_byte_mask(int n) {
+  return n >= 64 ? 0ULL : ~0ULL << n;
+}
+
+// all pixel types, the mask is per byte
+static RG_FORCEINLINE void simd_mask_storeu(Byte* ptr, __mmask64 mask, __m512i value) {
+  _mm512_mask_storeu_epi8(ptr, mask, value);
+}
+
+static RG_FORCEINLINE __m512i simd_maskz_loadu(const Byte* ptr, __mmask64 mask) {
+  return _mm512_maskz_loadu_epi8(mask, ptr);
+}
+
+static RG_FORCEINLINE __m512i abs_diff(__m512i a, __m512i b) {
+  auto positive = _mm512_subs_epu8(a, b);
+  auto negative = _mm512_subs_epu8(b, a);
+  return _mm512_or_si512(positive, negative);
+}
+
+static RG_FORCEINLINE __m512i abs_diff_16(__m512i a, __m512i b) {
+  auto positive = _mm512_subs_epu16(a, b);
+  auto negative = _mm512_subs_epu16(b, a);
+  return _mm512_or_si512(positive, negative);
+}
+
+static RG_FORCEINLINE __m512 abs_diff_32(__m512 a, __m512 b) {
+  // clears the sign bit, AVX-512F has no andps on zmm without DQ
+  const __m512i absmask = _mm512_set1_epi32(0x7FFFFFFF);
+  return _mm512_castsi512_ps(_mm512_and_si512(_mm512_castps_si512(_mm512_sub_ps(a, b)), absmask));
+}
+
+// no float clamp, same as SSE and AVX2
+static RG_FORCEINLINE __m512 _mm512_subs_ps(__m512 a, __m512 b) {
+  return _mm512_sub_ps(a, b);
+}
+
+static RG_FORCEINLINE __m512 _mm512_adds_ps(__m512 a, __m512 b) {
+  return _mm512_add_ps(a, b);
+}
+
+static RG_FORCEINLINE __m512 _mm512_avg_ps(__m512 a, __m512 b) {
+  const __m512 div2 = _mm512_set1_ps(0.5f);
+  return _mm512_mul_ps(_mm512_add_ps(a, b), div2);
+}
+
+// 2 * x + y in one rounding, FMA is part of AVX-512F
+static RG_FORCEINLINE __m512 fma_twice_plus_32(__m512 x, __m512 y) {
+  return _mm512_fmadd_ps(x, _mm512_set1_ps(2.0f), y);
+}
+
+static RG_FORCEINLINE __m512i select_on_equal(const __m512i &cmp1, const __m512i &cmp2, const __m512i &current, const __m512i &desired) {
+  return _mm512_mask_blend_epi8(_mm512_cmpeq_epi8_mask(cmp1, cmp2), current, desired);
+}
+
+static RG_FORCEINLINE __m512i select_on_equal_16(const __m512i &cmp1, const __m512i &cmp2, const __m512i &current, const __m512i &desired) {
+  return _mm512_mask_blend_epi16(_mm512_cmpeq_epi16_mask(cmp1, cmp2), current, desired);
+}
+
+static RG_FORCEINLINE __m512 select_on_equal_32(const __m512 &cmp1, const __m512 &cmp2, const __m512 &current, const __m512 &desired) {
+  return _mm512_mask_blend_ps(_mm512_cmp_ps_mask(cmp1, cmp2, _CMP_EQ_OQ), current, desired);
+}
+
+#define LOAD_SQUARE_AVX512_0_18(ptr, pitch, pixelsize, aligned) \
+__m512i a1 = simd_loadu_si512((ptr) - (pitch) - (pixelsize)); \
+__m512i a8 = simd_loadu_si512((ptr) + (pitch) + (pixelsize));
+
+#define LOAD_SQUARE_AVX512_0_27(ptr, pitch, pixelsize, aligned) \
+__m512i a2, a7; \
+if(!aligned) {\
+a2 = simd_loadu_si512((ptr) - (pitch)); \
+a7 = simd_loadu_si512((ptr) + (pitch)); \
+} else {\
+a2 = simd_loada_si512((ptr) - (pitch)); \
+a7 = simd_loada_si512((ptr) + (pitch)); \
+}
+
+#define LOAD_SQUARE_AVX512_0_36(ptr, pitch, pixelsize, aligned) \
+__m512i a3 = simd_loadu_si512((ptr) - (pitch) + (pixelsize)); \
+__m512i a6 = simd_loadu_si512((ptr) + (pitch) - (pixelsize));
+
+#define LOAD_SQUARE_AVX512_0_45(ptr, pitch, pixelsize, aligned) \
+__m512i a4 = simd_loadu_si512((ptr) - (pixelsize)); \
+__m512i a5 = simd_loadu_si512((ptr) + (pixelsize));
+
+#define LOAD_SQUARE_AVX512_0_Cent(ptr, pitch, pixelsize, aligned) \
+__m512i c = (aligned) ? simd_loada_si512((ptr)) : simd_loadu_si512((ptr));
+
+#define LOAD_SQUARE_AVX512_0(ptr, pitch, pixelsize, aligned) \
+__m512i a1, a2, a3, a4, a5, a6, a7, a8, c; \
+if(!aligned) {\
+a1 = simd_loadu_si512((ptr) - (pitch) - (pixelsize)); \
+a2 = simd_loadu_si512((ptr) - (pitch)); \
+a3 = simd_loadu_si512((ptr) - (pitch) + (pixelsize)); \
+a4 = simd_loadu_si512((ptr) - (pixelsize)); \
+c  = simd_loadu_si512((ptr) ); \
+a5 = simd_loadu_si512((ptr) + (pixelsize)); \
+a6 = simd_loadu_si512((ptr) + (pitch) - (pixelsize)); \
+a7 = simd_loadu_si512((ptr) + (pitch)); \
+a8 = simd_loadu_si512((ptr) + (pitch) + (pixelsize)); \
+} else {\
+a1 = simd_loadu_si512((ptr) - (pitch) - (pixelsize)); \
+a2 = simd_loada_si512((ptr) - (pitch)); \
+a3 = simd_loadu_si512((ptr) - (pitch) + (pixelsize)); \
+a4 = simd_loadu_si512((ptr) - (pixelsize)); \
+c  = simd_loada_si512((ptr) ); \
+a5 = simd_loadu_si512((ptr) + (pixelsize)); \
+a6 = simd_loadu_si512((ptr) + (pitch) - (pixelsize)); \
+a7 = simd_loada_si512((ptr) + (pitch)); \
+a8 = simd_loadu_si512((ptr) + (pitch) + (pixelsize)); \
+}
+
+// 8 bit loads
+#define LOAD_SQUARE_AVX512(ptr, pitch) LOAD_SQUARE_AVX512_0(ptr, pitch, 1, false)
+#define LOAD_SQUARE_AVX512_UA(ptr, pitch, aligned) LOAD_SQUARE_AVX512_0(ptr, pitch, 1, aligned)
+#define LOAD_SQUARE_AVX512_UA_18(ptr, pitch, aligned) LOAD_SQUARE_AVX512_0_18(ptr, pitch, 1, aligned)
+#define LOAD_SQUARE_AVX512_UA_27(ptr, pitch, aligned) LOAD_SQUARE_AVX512_0_27(ptr, pitch, 1, aligned)
+#define LOAD_SQUARE_AVX512_UA_36(ptr, pitch, aligned) LOAD_SQUARE_AVX512_0_36(ptr, pitch, 1, aligned)
+#define LOAD_SQUARE_AVX512_UA_45(ptr, pitch, aligned) LOAD_SQUARE_AVX512_0_45(ptr, pitch, 1, aligned)
+#define LOAD_SQUARE_AVX512_UA_Cent(ptr, pitch, aligned) LOAD_SQUARE_AVX512_0_Cent(ptr, pitch, 1, aligned)
+
+// 16 bit loads
+#define LOAD_SQUARE_AVX512_16(ptr, pitch) LOAD_SQUARE_AVX512_0(ptr, pitch, 2, false)
+#define LOAD_SQUARE_AVX512_16_UA(ptr, pitch, aligned) LOAD_SQUARE_AVX512_0(ptr, pitch, 2, aligned)
+
+// 32 bit float loads
+#define LOAD_SQUARE_AVX512_0_32(ptr, pitch, aligned) \
+__m512 a1, a2, a3, a4, a5, a6, a7, a8, c; \
+if(!aligned) {\
+a1 = _mm512_loadu_ps((const float *)((ptr) - (pitch) - 4)); \
+a2 = _mm512_loadu_ps((const float *)((ptr) - (pitch))); \
+a3 = _mm512_loadu_ps((const float *)((ptr) - (pitch) + (4))); \
+a4 = _mm512_loadu_ps((const float *)((ptr) - (4))); \
+c  = _mm512_loadu_ps((const float *)((ptr) )); \
+a5 = _mm512_loadu_ps((const float *)((ptr) + (4))); \
+a6 = _mm512_loadu_ps((const float *)((ptr) + (pitch) - (4))); \
+a7 = _mm512_loadu_ps((const float *)((ptr) + (pitch))); \
+a8 = _mm512_loadu_ps((const float *)((ptr) + (pitch) + (4))); \
+} else { \
+a1 = _mm512_loadu_ps((const float *)((ptr) - (pitch) - 4)); \
+a2 = _mm512_load_ps((const float *)((ptr) - (pitch))); \
+a3 = _mm512_loadu_ps((const float *)((ptr) - (pitch) + (4))); \
+a4 = _mm512_loadu_ps((const float *)((ptr) - (4))); \
+c  = _mm512_load_ps((const float *)((ptr) )); \
+a5 = _mm512_loadu_ps((const float *)((ptr) + (4))); \
+a6 = _mm512_loadu_ps((const float *)((ptr) + (pitch) - (4))); \
+a7 = _mm512_load_ps((const float *)((ptr) + (pitch))); \
+a8 = _mm512_loadu_ps((const float *)((ptr) + (pitch) + (4))); \
+}
+
+#define LOAD_SQUARE_AVX512_32(ptr, pitch) LOAD_SQUARE_AVX512_0_32(ptr, pitch, false)
+#define LOAD_SQUARE_AVX512_32_UA(ptr, pitch, aligned) LOAD_SQUARE_AVX512_0_32(ptr, pitch, aligned)
+
+#endif
@@ -0,0 +1,94 @@
+#include "common.h"
+#include "autotune.h"
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+static inline unsigned long long xgetbv(unsigned xcr) { return _xgetbv(xcr); }
+#else
+// GCC: cpuid.h has __cpuidex, its __cpuid is a macro with another signature
+#include <cpuid.h>
+#undef __cpuid
+static inline void __cpuid(int info[4], int leaf) { __cpuidex(info, leaf, 0); }
+// _xgetbv needs the xsave target, this file is built for SSE2 only
+__attribute__((target("xsave"))) static inline unsigned long long xgetbv(unsigned xcr) { return _xgetbv(xcr); }
+#endif
+
+static bool detect_avx512bw() {
+  int info[4];
+  __cpuid(info, 0);
+  if (info[0] < 7)
+    return false;
+
+  __cpuid(info, 1);
+  const bool osxsave = (info[2] & (1 << 27)) != 0;
+  if (!osxsave)
+    return false;
+
+  // XCR0: SSE, AVX, opmask, upper halves of ZMM0-15 and ZMM16-31 state saved by the OS
+  const unsigned long long xcr0 = xgetbv(0);
+  if ((xcr0 & 0xE6) != 0xE6)
+    return false;
+
+  __cpuidex(info, 7, 0);
+  const unsigned ebx = (unsigned)info[1];
+  const unsigned f = 1u << 16, bw = 1u << 30, vl = 1u << 31;
+  return (ebx & (f | bw | vl)) == (f | bw | vl);
+}
+
+bool cpu_has_avx512bw() {
+  static const bool avx512bw = detect_avx512bw();
+  return avx512bw;
+}
+
+// CPUF_* flags straight from CPUID, for hosts that do not report everything (classic Avisynth 2.6 has no AVX2)
+static int detect_cpu_flags() {
+  int info[4];
+  __cpuid(info, 0);
+  const int max_leaf = info[0];
+
+  __cpuid(info, 1);
+  const unsigned ecx = (unsigned)info[2], edx = (unsigned)info[3];
+  int flags = 0;
+  if (edx & (1u << 25)) flags |= CPUF_SSE | CPUF_INTEGER_SSE;
+  if (edx & (1u << 26)) flags |= CPUF_SSE2;
+  if (ecx & (1u << 0))  flags |= CPUF_SSE3;
+  if (ecx & (1u << 9))  flags |= CPUF_SSSE3;
+  if (ecx & (1u << 19)) flags |= CPUF_SSE4_1;
+  if (ecx & (1u << 20)) flags |= CPUF_SSE4_2;
+
+  // AVX needs the OS to save YMM state
+  const bool osxsave = (ecx & (1u << 27)) != 0;
+  if (!osxsave || (ecx & (1u << 28)) == 0 || (xgetbv(0) & 0x6) != 0x6)
+    return flags;
+  flags |= CPUF_AVX;
+  if (ecx & (1u << 12)) flags |= CPUF_FMA3;
+
+  if (max_leaf >= 7) {
+    __cpuidex(info, 7, 0);
+    if (info[1] & (1 << 5)) flags |= CPUF_AVX2;
+  }
+  return flags;
+}
+
+int cpu_detect_flags() {
+  static const int flags = detect_cpu_flags();
+  return flags;
+}
+
+// brand string, "unknown" on CPUs without it
+std::string cpu_model_name() {
+  int info[4];
+  __cpuid(info, 0x80000000);
+  if ((unsigned)info[0] < 0x80000004u)
+    return "unknown";
+
+  char brand[49] = {};
+  for (int i = 0; i < 3; ++i) {
+    __cpuid(info, 0x80000002 + i);
+    memcpy(brand + i * 16, info, 16);
+  }
+  std::string name(brand);
+  const size_t first = name.find_first_not_of(' ');
+  const size_t last = name.find_last_not_of(' ');
+  return first == std::string::npos ? "unknown" : name.substr(first, last - first + 1);
+}
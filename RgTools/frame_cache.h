@@ -0,0 +1,57 @@
+#ifndef __FRAME_CACHE_H__
+#define __FRAME_CACHE_H__
+
+#include "common.h"
+#include <atomic>
+#include <memory>
+#include <mutex>
+
+// Recent frames of a filter instance by frame number, shared by all threads that request frames
+// from it (Clense: its own source frames, reduceflicker and batch outputs). Frame n goes to slot
+// n % slots, a newer frame replaces it, so any window of 'slots' consecutive frames fits.
+// The frame number of a slot is checked without a lock, so a miss never waits. A hit locks the slot
+// only to copy the frame reference, the reference count can not be taken safely without.
+class KeyedFrameCache {
+public:
+  explicit KeyedFrameCache(int slots) : slots_(new Slot[slots]), count_(slots) {
+    for (int i = 0; i < count_; ++i)
+      slots_[i].n = -1;
+  }
+
+  int size() const { return count_; }
+
+  // frame n when it is in the cache
+  bool lookup(int n, PVideoFrame &frame) {
+    if (n < 0)
+      return false;
+    Slot &slot = slots_[n % count_];
+    if (slot.n.load(std::memory_order_acquire) != n)
+      return false;
+    std::lock_guard<std::mutex> guard(slot.lock);
+    if (slot.n.load(std::memory_order_relaxed) != n) // replaced in the meantime
+      return false;
+    frame = slot.frame;
+    return true;
+  }
+
+  void insert(int n, const PVideoFrame &frame) {
+    if (n < 0)
+      return;
+    Slot &slot = slots_[n % count_];
+    std::lock_guard<std::mutex> guard(slot.lock);
+    slot.frame = frame;
+    slot.n.store(n, std::memory_order_release);
+  }
+
+private:
+  struct Slot {
+    std::atomic<int> n;
+    std::mutex lock;
+    PVideoFrame frame;
+  };
+
+  std::unique_ptr<Slot[]> slots_;
+  int count_;
+};
+
+#endif
@@ -2,7 +2,25 @@
 // Avisynth v2.6.  Copyright 2006 Klaus Post.
 // Avisynth v2.6.  Copyright 2009 Ian Brabham.
 // Avisynth+ project
-// Last modification date: 20161005
+// 20160613: new 16 bit planar pixel_type constants go live!
+// 20160725: pixel_type constants 10-12-14 bit + planar RGB + BRG48/64
+// 20161005: Fallback of VideoInfo functions to defaults if no function exists
+// 20170117: global variables for VfW output OPT_xxxx
+// 20170310: new MT mode: MT_SPECIAL_MT
+// 20171207: C++ Standard Conformance (no change for plugin writers)
+// 20180525: AVS_UNUSED define to supress parameter not used warnings
+// 2020xxxx: AVS_WINDOWS and AVS_POSIX option see avs/config.h
+// 20200305: ScriptEnvironment::VSprintf parameter (void *) changed back to va_list
+// 20200330: removed __stdcall from variadic argument functions (Sprintf)
+//           Integrate Avisynth Neo structures and interface, PFunction, PDevice
+// 20200501: frame property support (NewVideoFrameP and other helpers) to legacy IScriptEnvironment.
+//           move some former IScriptEnvironment2 functions to IScriptEnvironment:
+//             GetEnvProperty (system prop), Allocate, Free (buffer pool)
+//             GetVarTry, GetVarBool/Int/String/Double/Long
+//             Invoke2, Invoke3, InvokeTry, Invoke2Try, Invoke3Try
+//           Interface Version to 8 (classic 2.6 = 6)
+// 20200607  AVS frame property enums to match existing Avisynth enum style
+// 2021xxxx: Interface Version to 9: MakePropertyWritable, VideoFrame::IsPropertyWritable
 
 // http://www.avisynth.org
 
@@ -41,21 +59,49 @@
 
 
 
-#ifndef __AVISYNTH_6_H__
-#define __AVISYNTH_6_H__
+#ifndef __AVISYNTH_9_H__
+#define __AVISYNTH_9_H__
 
-#include <avs/config.h>
-#include <avs/capi.h>
-#include <avs/types.h>
+#include "avs/config.h"
+#include "avs/capi.h"
+#include "avs/types.h"
 
+#ifdef AVS_POSIX
+#  include "avs/posix.h"
+#endif
 
-enum { AVISYNTH_INTERFACE_VERSION = 6 };
+#if defined(AVS_POSIX)
+#if defined(AVS_HAIKU)
+#undef __stdcall
+#undef __cdecl
+#endif
+#define __stdcall
+#define __cdecl
+#endif
 
+// Important note on AVISYNTH_INTERFACE_VERSION V6->V8 change:
+// Note 1: Those few plugins which were using earlier IScriptEnvironment2 despite the big Warning will crash have to be rebuilt.
+// Note 2: How to support earlier avisynth interface with an up-to-date avisynth.h:
+//   Use the new frame property features adaptively after querying that at least v8 is supported
+//   AviSynth 2.6 and non-supporting Avisynth+ can be detected with the CheckVersion method:
+//   bool has_at_least_v8 = true;
+//   try { env->CheckVersion(8); } catch (const AvisynthError&) { has_at_least_v8 = false; }
+//   and then for example:
+//   PVideoFrame dst = has_at_least_v8 ? env->NewVideoFrameP(vi, &src) : env->NewVideoFrame(vi);
+// Note 3: Frame property support is available since V8, MakePropertyWritable since V9
+
+enum AvsVersion {
+  AVISYNTH_CLASSIC_INTERFACE_VERSION_25 = 3,
+  AVISYNTH_CLASSIC_INTERFACE_VERSION_26BETA = 5,
+  AVISYNTH_CLASSIC_INTERFACE_VERSION = 6,
+  AVISYNTH_INTERFACE_VERSION = 9,
+  AVISYNTHPLUS_INTERFACE_BUGFIX_VERSION = 0 // reset to zero whenever the normal interface version bumps
+};
 
 /* Compiler-specific crap */
 
 // Tell MSVC to stop precompiling here
-#ifdef _MSC_VER
+#if defined(_MSC_VER) && !defined(__clang__)
   #pragma hdrstop
 #endif
 
@@ -118,6 +164,9 @@ enum {
    PLANAR_B_ALIGNED=PLANAR_B|PLANAR_ALIGNED,
   };
 
+// Usage: AVS_UNUSED(x) to suppress unused parameter warnings
+#define AVS_UNUSED(x) (void)(x)
+
 class AvisynthError /* exception */ {
 public:
   const char* const msg;
@@ -128,6 +177,12 @@ private:
   AvisynthError& operator=(const AvisynthError&);
 }; // end class AvisynthError
 
+enum AvsDeviceType {
+  DEV_TYPE_NONE = 0,
+  DEV_TYPE_CPU = 1,
+  DEV_TYPE_CUDA = 2,
+  DEV_TYPE_ANY = 0xFFFF
+};
 
 /* Forward references */
 #if defined(MSVC)
@@ -143,6 +198,12 @@ class SINGLE_INHERITANCE PClip;
 class SINGLE_INHERITANCE PVideoFrame;
 class IScriptEnvironment;
 class SINGLE_INHERITANCE AVSValue;
+class INeoEnv;
+class IFunction;
+class SINGLE_INHERITANCE PFunction;
+class Device;
+class SINGLE_INHERITANCE PDevice;
+struct AVSMap;
 
 
 /*
@@ -189,10 +250,10 @@ struct AVS_Linkage {
   int     (VideoInfo::*BytesFromPixels)(int pixels) const;
   int     (VideoInfo::*RowSize)(int plane) const;
   int     (VideoInfo::*BMPSize)() const;
-  __int64 (VideoInfo::*AudioSamplesFromFrames)(int frames) const;
-  int     (VideoInfo::*FramesFromAudioSamples)(__int64 samples) const;
-  __int64 (VideoInfo::*AudioSamplesFromBytes)(__int64 bytes) const;
-  __int64 (VideoInfo::*BytesFromAudioSamples)(__int64 samples) const;
+  int64_t (VideoInfo::*AudioSamplesFromFrames)(int frames) const;
+  int     (VideoInfo::*FramesFromAudioSamples)(int64_t samples) const;
+  int64_t (VideoInfo::*AudioSamplesFromBytes)(int64_t bytes) const;
+  int64_t (VideoInfo::*BytesFromAudioSamples)(int64_t samples) const;
   int     (VideoInfo::*AudioChannels)() const;
   int     (VideoInfo::*SampleType)() const;
   bool    (VideoInfo::*IsSampleType)(int testtype) const;
@@ -316,6 +377,52 @@ struct AVS_Linkage {
   bool    (VideoInfo::*IsPlanarRGB)() const;
   bool    (VideoInfo::*IsPlanarRGBA)() const;
   /**********************************************************************/
+
+  // Reserve pointer space for Avisynth+
+  void    (VideoInfo::*reserved2[64 - 12])();
+  /**********************************************************************/
+
+  // AviSynth Neo additions
+  INeoEnv* (__stdcall *GetNeoEnv)(IScriptEnvironment* env);
+  // As of V8 most PDevice, PFunction linkage entries are moved to standard avs+ linkage table.
+
+  // frame property access
+  AVSMap&         (VideoFrame::*getProperties)();
+  const AVSMap&   (VideoFrame::*getConstProperties)();
+  void            (VideoFrame::*setProperties)(const AVSMap& properties);
+
+  // PFunction
+  void            (AVSValue::*AVSValue_CONSTRUCTOR11)(const PFunction& o);
+  bool            (AVSValue::*IsFunction)() const;
+  void            (PFunction::*PFunction_CONSTRUCTOR0)();
+  void            (PFunction::*PFunction_CONSTRUCTOR1)(IFunction* p);
+  void            (PFunction::*PFunction_CONSTRUCTOR2)(const PFunction& p);
+  PFunction&      (PFunction::*PFunction_OPERATOR_ASSIGN0)(IFunction* other);
+  PFunction&      (PFunction::*PFunction_OPERATOR_ASSIGN1)(const PFunction& other);
+  void            (PFunction::*PFunction_DESTRUCTOR)();
+  // end PFunction
+
+  // extra VideoFrame functions
+  int             (VideoFrame::*VideoFrame_CheckMemory)() const;
+  PDevice         (VideoFrame::*VideoFrame_GetDevice)() const;
+
+  // class PDevice, even if only CPU device
+  void            (PDevice::*PDevice_CONSTRUCTOR0)();
+  void            (PDevice::*PDevice_CONSTRUCTOR1)(Device* p);
+  void            (PDevice::*PDevice_CONSTRUCTOR2)(const PDevice& p);
+  PDevice&        (PDevice::*PDevice_OPERATOR_ASSIGN0)(Device* other);
+  PDevice&        (PDevice::*PDevice_OPERATOR_ASSIGN1)(const PDevice& other);
+  void            (PDevice::*PDevice_DESTRUCTOR)();
+  AvsDeviceType   (PDevice::*PDevice_GetType)() const;
+  int             (PDevice::*PDevice_GetId)() const;
+  int             (PDevice::*PDevice_GetIndex)() const;
+  const char*     (PDevice::*PDevice_GetName)() const;
+  // end class PDevice
+  /**********************************************************************/
+
+  // V9: VideoFrame helper
+  bool            (VideoFrame::*IsPropertyWritable)() const;
+  /**********************************************************************/
 };
 
 #ifdef BUILDING_AVSCORE
@@ -323,6 +430,7 @@ struct AVS_Linkage {
 # define AVS_BakedCode(arg) ;
 # define AVS_LinkCall(arg)
 # define AVS_LinkCallV(arg)
+# define AVS_LinkCall_Void(arg)
 # define AVS_LinkCallOpt(arg, argOpt) AVSLinkCall(arg)
 # define AVS_LinkCallOptDefault(arg, argDefaultValue) AVSLinkCall(arg())
 # define CALL_MEMBER_FN(object,ptrToMember)
@@ -340,16 +448,17 @@ extern const AVS_Linkage* AVS_linkage;
 # endif
 
 # define AVS_BakedCode(arg) { arg ; }
-# define AVS_LinkCall(arg)  !AVS_linkage || offsetof(AVS_Linkage, arg) >= AVS_linkage->Size ?     0 : (this->*(AVS_linkage->arg))
-# define AVS_LinkCallV(arg) !AVS_linkage || offsetof(AVS_Linkage, arg) >= AVS_linkage->Size ? *this : (this->*(AVS_linkage->arg))
+# define AVS_LinkCall(arg)  !AVS_linkage || offsetof(AVS_Linkage, arg) >= (size_t)AVS_linkage->Size ?     0 : (this->*(AVS_linkage->arg))
+# define AVS_LinkCall_Void(arg)  !AVS_linkage || offsetof(AVS_Linkage, arg) >= (size_t)AVS_linkage->Size ? (void)0 : (this->*(AVS_linkage->arg))
+# define AVS_LinkCallV(arg) !AVS_linkage || offsetof(AVS_Linkage, arg) >= (size_t)AVS_linkage->Size ? *this : (this->*(AVS_linkage->arg))
 // Helper macros for fallback option when a function does not exists
 #define CALL_MEMBER_FN(object,ptrToMember)  ((object)->*(ptrToMember))
 #define AVS_LinkCallOpt(arg, argOpt)  !AVS_linkage ? 0 : \
-                                      ( offsetof(AVS_Linkage, arg) >= AVS_linkage->Size ? \
-                                        (offsetof(AVS_Linkage, argOpt) >= AVS_linkage->Size ? 0 : CALL_MEMBER_FN(this, AVS_linkage->argOpt)() ) : \
+                                      ( offsetof(AVS_Linkage, arg) >= (size_t)AVS_linkage->Size ? \
+                                        (offsetof(AVS_Linkage, argOpt) >= (size_t)AVS_linkage->Size ? 0 : CALL_MEMBER_FN(this, AVS_linkage->argOpt)() ) : \
                                         CALL_MEMBER_FN(this, AVS_linkage->arg)() )
 // AVS_LinkCallOptDefault puts automatically () only after arg
-# define AVS_LinkCallOptDefault(arg, argDefaultValue)  !AVS_linkage || offsetof(AVS_Linkage, arg) >= AVS_linkage->Size ? (argDefaultValue) : ((this->*(AVS_linkage->arg))())
+# define AVS_LinkCallOptDefault(arg, argDefaultValue)  !AVS_linkage || offsetof(AVS_Linkage, arg) >= (size_t)AVS_linkage->Size ? (argDefaultValue) : ((this->*(AVS_linkage->arg))())
 
 #endif
 
@@ -592,7 +701,7 @@ enum {
 
   int audio_samples_per_second;   // 0 means no audio
   int sample_type;                // as of 2.5
-  __int64 num_audio_samples;      // changed as of 2.5
+  int64_t num_audio_samples;      // changed as of 2.5
   int nchannels;                  // as of 2.5
 
   // Imagetype properties
@@ -645,18 +754,18 @@ enum {
   int RowSize(int plane = 0) const AVS_BakedCode(return AVS_LinkCall(RowSize)(plane))
   int BMPSize() const AVS_BakedCode(return AVS_LinkCall(BMPSize)())
 
-  __int64 AudioSamplesFromFrames(int frames) const AVS_BakedCode(return AVS_LinkCall(AudioSamplesFromFrames)(frames))
-  int FramesFromAudioSamples(__int64 samples) const AVS_BakedCode(return AVS_LinkCall(FramesFromAudioSamples)(samples))
-  __int64 AudioSamplesFromBytes(__int64 bytes) const AVS_BakedCode(return AVS_LinkCall(AudioSamplesFromBytes)(bytes))
-  __int64 BytesFromAudioSamples(__int64 samples) const AVS_BakedCode(return AVS_LinkCall(BytesFromAudioSamples)(samples))
+  int64_t AudioSamplesFromFrames(int frames) const AVS_BakedCode(return AVS_LinkCall(AudioSamplesFromFrames)(frames))
+  int FramesFromAudioSamples(int64_t samples) const AVS_BakedCode(return AVS_LinkCall(FramesFromAudioSamples)(samples))
+  int64_t AudioSamplesFromBytes(int64_t bytes) const AVS_BakedCode(return AVS_LinkCall(AudioSamplesFromBytes)(bytes))
+  int64_t BytesFromAudioSamples(int64_t samples) const AVS_BakedCode(return AVS_LinkCall(BytesFromAudioSamples)(samples))
   int AudioChannels() const AVS_BakedCode(return AVS_LinkCall(AudioChannels)())
   int SampleType() const AVS_BakedCode(return AVS_LinkCall(SampleType)())
   bool IsSampleType(int testtype) const AVS_BakedCode(return AVS_LinkCall(IsSampleType)(testtype))
   int SamplesPerSecond() const AVS_BakedCode(return AVS_LinkCall(SamplesPerSecond)())
   int BytesPerAudioSample() const AVS_BakedCode(return AVS_LinkCall(BytesPerAudioSample)())
-  void SetFieldBased(bool isfieldbased) AVS_BakedCode(AVS_LinkCall(SetFieldBased)(isfieldbased))
-  void Set(int property) AVS_BakedCode(AVS_LinkCall(Set)(property))
-  void Clear(int property) AVS_BakedCode(AVS_LinkCall(Clear)(property))
+  void SetFieldBased(bool isfieldbased) AVS_BakedCode(AVS_LinkCall_Void(SetFieldBased)(isfieldbased))
+  void Set(int property) AVS_BakedCode(AVS_LinkCall_Void(Set)(property))
+  void Clear(int property) AVS_BakedCode(AVS_LinkCall_Void(Clear)(property))
   // Subsampling in bitshifts!
   int GetPlaneWidthSubsampling(int plane) const AVS_BakedCode(return AVS_LinkCall(GetPlaneWidthSubsampling)(plane))
   int GetPlaneHeightSubsampling(int plane) const AVS_BakedCode(return AVS_LinkCall(GetPlaneHeightSubsampling)(plane))
@@ -665,10 +774,10 @@ enum {
   int BytesPerChannelSample() const AVS_BakedCode(return AVS_LinkCall(BytesPerChannelSample)())
 
   // useful mutator
-  void SetFPS(unsigned numerator, unsigned denominator) AVS_BakedCode(AVS_LinkCall(SetFPS)(numerator, denominator))
+  void SetFPS(unsigned numerator, unsigned denominator) AVS_BakedCode(AVS_LinkCall_Void(SetFPS)(numerator, denominator))
 
   // Range protected multiply-divide of FPS
-  void MulDivFPS(unsigned multiplier, unsigned divisor) AVS_BakedCode(AVS_LinkCall(MulDivFPS)(multiplier, divisor))
+  void MulDivFPS(unsigned multiplier, unsigned divisor) AVS_BakedCode(AVS_LinkCall_Void(MulDivFPS)(multiplier, divisor))
 
   // Test for same colorspace
   bool IsSameColorspace(const VideoInfo& vi) const AVS_BakedCode(return AVS_LinkCall(IsSameColorspace)(vi))
@@ -726,6 +835,41 @@ enum {
 
 
 
+// smart pointer to Device
+class PDevice
+{
+public:
+  PDevice() AVS_BakedCode( AVS_LinkCall_Void(PDevice_CONSTRUCTOR0)() )
+  PDevice(Device* p) AVS_BakedCode( AVS_LinkCall_Void(PDevice_CONSTRUCTOR1)(p) )
+  PDevice(const PDevice& p) AVS_BakedCode( AVS_LinkCall_Void(PDevice_CONSTRUCTOR2)(p) )
+  PDevice& operator=(Device* p) AVS_BakedCode( return AVS_LinkCallV(PDevice_OPERATOR_ASSIGN0)(p) )
+  PDevice& operator=(const PDevice& p) AVS_BakedCode( return AVS_LinkCallV(PDevice_OPERATOR_ASSIGN1)(p) )
+  ~PDevice() AVS_BakedCode( AVS_LinkCall_Void(PDevice_DESTRUCTOR)() )
+
+  int operator!() const { return !e; }
+  operator void*() const { return e; }
+  Device* operator->() const { return e; }
+
+  AvsDeviceType GetType() const AVS_BakedCode( return AVS_LinkCallOptDefault(PDevice_GetType, DEV_TYPE_NONE) )
+  int GetId() const AVS_BakedCode( return AVS_LinkCallOptDefault(PDevice_GetId, -1) )
+  int GetIndex() const AVS_BakedCode( return AVS_LinkCallOptDefault(PDevice_GetIndex, -1) )
+  const char* GetName() const AVS_BakedCode( return AVS_LinkCallOptDefault(PDevice_GetName, 0) )
+
+private:
+  Device * e;
+
+#ifdef BUILDING_AVSCORE
+public:
+  void CONSTRUCTOR0();  /* Damn compiler won't allow taking the address of reserved constructs, make a dummy interlude */
+  void CONSTRUCTOR1(Device* p);
+  void CONSTRUCTOR2(const PDevice& p);
+  PDevice& OPERATOR_ASSIGN0(Device* p);
+  PDevice& OPERATOR_ASSIGN1(const PDevice& p);
+  void DESTRUCTOR();
+#endif
+}; // end class PDevice
+
+
 // VideoFrameBuffer holds information about a memory block which is used
 // for video data.  For efficiency, instances of this class are not deleted
 // when the refcount reaches zero; instead they're stored in a linked list
@@ -744,8 +888,11 @@ class VideoFrameBuffer {
   friend class ScriptEnvironment;
   volatile long refcount;
 
+  // AVS+CUDA extension, does not break plugins if appended here
+  Device* device;
+
 protected:
-  VideoFrameBuffer(int size);
+  VideoFrameBuffer(int size, int margin, Device* device);
   VideoFrameBuffer();
   ~VideoFrameBuffer();
 
@@ -779,6 +926,8 @@ class VideoFrame {
   // AVS+ extension, does not break plugins if appended here
   int offsetA, pitchA, row_sizeA; // 4th alpha plane support, pitch and row_size is 0 is none
 
+  AVSMap *properties;
+
   friend class PVideoFrame;
   void AddRef();
   void Release();
@@ -786,10 +935,10 @@ class VideoFrame {
   friend class ScriptEnvironment;
   friend class Cache;
 
-  VideoFrame(VideoFrameBuffer* _vfb, int _offset, int _pitch, int _row_size, int _height);
-  VideoFrame(VideoFrameBuffer* _vfb, int _offset, int _pitch, int _row_size, int _height, int _offsetU, int _offsetV, int _pitchUV, int _row_sizeUV, int _heightUV);
+  VideoFrame(VideoFrameBuffer* _vfb, AVSMap* avsmap, int _offset, int _pitch, int _row_size, int _height);
+  VideoFrame(VideoFrameBuffer* _vfb, AVSMap* avsmap, int _offset, int _pitch, int _row_size, int _height, int _offsetU, int _offsetV, int _pitchUV, int _row_sizeUV, int _heightUV);
   // for Alpha
-  VideoFrame(VideoFrameBuffer* _vfb, int _offset, int _pitch, int _row_size, int _height, int _offsetU, int _offsetV, int _pitchUV, int _row_sizeUV, int _heightUV, int _offsetA);
+  VideoFrame(VideoFrameBuffer* _vfb, AVSMap* avsmap, int _offset, int _pitch, int _row_size, int _height, int _offsetU, int _offsetV, int _pitchUV, int _row_sizeUV, int _heightUV, int _offsetA);
 
   void* operator new(size_t size);
 // TESTME: OFFSET U/V may be switched to what could be expected from AVI standard!
@@ -812,7 +961,19 @@ public:
   bool IsWritable() const AVS_BakedCode( return AVS_LinkCall(IsWritable)() )
   BYTE* GetWritePtr(int plane=0) const AVS_BakedCode( return AVS_LinkCall(VFGetWritePtr)(plane) )
 
-  ~VideoFrame() AVS_BakedCode( AVS_LinkCall(VideoFrame_DESTRUCTOR)() )
+  // frame properties, in plugins use env->getFramePropsRO / getFramePropsRW
+  AVSMap& getProperties();
+  const AVSMap& getConstProperties();
+  void setProperties(const AVSMap& _properties);
+
+  PDevice GetDevice() const AVS_BakedCode( return AVS_LinkCall(VideoFrame_GetDevice)() )
+
+  // 0: OK, 1: NG, -1: disabled or non CPU frame
+  int CheckMemory() const AVS_BakedCode( return AVS_LinkCall(VideoFrame_CheckMemory)() )
+
+  bool IsPropertyWritable() const AVS_BakedCode( return AVS_LinkCall(IsPropertyWritable)() )
+
+  ~VideoFrame() AVS_BakedCode( AVS_LinkCall_Void(VideoFrame_DESTRUCTOR)() )
 #ifdef BUILDING_AVSCORE
 public:
   void DESTRUCTOR();  /* Damn compiler won't allow taking the address of reserved constructs, make a dummy interlude */
@@ -896,6 +1057,11 @@ enum CachePolicyHint {
   CACHE_IS_MTGUARD_REQ,
   CACHE_IS_MTGUARD_ANS,
 
+  CACHE_AVSPLUS_CUDA_CONSTANTS = 600,
+
+  CACHE_GET_DEV_TYPE,           // Device types a filter can return
+  CACHE_GET_CHILD_DEV_TYPE,     // Device types a fitler can receive
+
   CACHE_USER_CONSTANTS = 1000       // Smaller values are reserved for the core
 
 };
@@ -906,17 +1072,20 @@ class IClip {
   friend class AVSValue;
   volatile long refcnt;
   void AddRef();
+#if BUILDING_AVSCORE
+public:
+#endif
   void Release();
 public:
   IClip() : refcnt(0) {}
   virtual int __stdcall GetVersion() { return AVISYNTH_INTERFACE_VERSION; }
   virtual PVideoFrame __stdcall GetFrame(int n, IScriptEnvironment* env) = 0;
   virtual bool __stdcall GetParity(int n) = 0;  // return field parity if field_based, else parity of first field in frame
-  virtual void __stdcall GetAudio(void* buf, __int64 start, __int64 count, IScriptEnvironment* env) = 0;  // start and count are in samples
+  virtual void __stdcall GetAudio(void* buf, int64_t start, int64_t count, IScriptEnvironment* env) = 0;  // start and count are in samples
   /* Need to check GetVersion first, pre v5 will return random crap from EAX reg. */
   virtual int __stdcall SetCacheHints(int cachehints,int frame_range) = 0 ;  // We do not pass cache requests upwards, only to the next filter.
   virtual const VideoInfo& __stdcall GetVideoInfo() = 0;
-  virtual AVSC_CC ~IClip() {}
+  virtual __stdcall ~IClip() {}
 }; // end class IClip
 
 
@@ -933,11 +1102,11 @@ class PClip {
   void Set(IClip* x);
 
 public:
-  PClip() AVS_BakedCode( AVS_LinkCall(PClip_CONSTRUCTOR0)() )
-  PClip(const PClip& x) AVS_BakedCode( AVS_LinkCall(PClip_CONSTRUCTOR1)(x) )
-  PClip(IClip* x) AVS_BakedCode( AVS_LinkCall(PClip_CONSTRUCTOR2)(x) )
-  void operator=(IClip* x) AVS_BakedCode( AVS_LinkCall(PClip_OPERATOR_ASSIGN0)(x) )
-  void operator=(const PClip& x) AVS_BakedCode( AVS_LinkCall(PClip_OPERATOR_ASSIGN1)(x) )
+  PClip() AVS_BakedCode( AVS_LinkCall_Void(PClip_CONSTRUCTOR0)() )
+  PClip(const PClip& x) AVS_BakedCode( AVS_LinkCall_Void(PClip_CONSTRUCTOR1)(x) )
+  PClip(IClip* x) AVS_BakedCode( AVS_LinkCall_Void(PClip_CONSTRUCTOR2)(x) )
+  void operator=(IClip* x) AVS_BakedCode( AVS_LinkCall_Void(PClip_OPERATOR_ASSIGN0)(x) )
+  void operator=(const PClip& x) AVS_BakedCode( AVS_LinkCall_Void(PClip_OPERATOR_ASSIGN1)(x) )
 
   IClip* operator->() const { return p; }
 
@@ -945,7 +1114,7 @@ public:
   operator void*() const { return p; }
   bool operator!() const { return !p; }
 
-  ~PClip() AVS_BakedCode( AVS_LinkCall(PClip_DESTRUCTOR)() )
+  ~PClip() AVS_BakedCode( AVS_LinkCall_Void(PClip_DESTRUCTOR)() )
 #ifdef BUILDING_AVSCORE
 public:
   void CONSTRUCTOR0();  /* Damn compiler won't allow taking the address of reserved constructs, make a dummy interlude */
@@ -967,11 +1136,11 @@ class PVideoFrame {
   void Set(VideoFrame* x);
 
 public:
-  PVideoFrame() AVS_BakedCode( AVS_LinkCall(PVideoFrame_CONSTRUCTOR0)() )
-  PVideoFrame(const PVideoFrame& x) AVS_BakedCode( AVS_LinkCall(PVideoFrame_CONSTRUCTOR1)(x) )
-  PVideoFrame(VideoFrame* x) AVS_BakedCode( AVS_LinkCall(PVideoFrame_CONSTRUCTOR2)(x) )
-  void operator=(VideoFrame* x) AVS_BakedCode( AVS_LinkCall(PVideoFrame_OPERATOR_ASSIGN0)(x) )
-  void operator=(const PVideoFrame& x) AVS_BakedCode( AVS_LinkCall(PVideoFrame_OPERATOR_ASSIGN1)(x) )
+  PVideoFrame() AVS_BakedCode( AVS_LinkCall_Void(PVideoFrame_CONSTRUCTOR0)() )
+  PVideoFrame(const PVideoFrame& x) AVS_BakedCode( AVS_LinkCall_Void(PVideoFrame_CONSTRUCTOR1)(x) )
+  PVideoFrame(VideoFrame* x) AVS_BakedCode( AVS_LinkCall_Void(PVideoFrame_CONSTRUCTOR2)(x) )
+  void operator=(VideoFrame* x) AVS_BakedCode( AVS_LinkCall_Void(PVideoFrame_OPERATOR_ASSIGN0)(x) )
+  void operator=(const PVideoFrame& x) AVS_BakedCode( AVS_LinkCall_Void(PVideoFrame_OPERATOR_ASSIGN1)(x) )
 
   VideoFrame* operator->() const { return p; }
 
@@ -979,7 +1148,7 @@ public:
   operator void*() const { return p; }
   bool operator!() const { return !p; }
 
-  ~PVideoFrame() AVS_BakedCode( AVS_LinkCall(PVideoFrame_DESTRUCTOR)() )
+  ~PVideoFrame() AVS_BakedCode( AVS_LinkCall_Void(PVideoFrame_DESTRUCTOR)() )
 #ifdef BUILDING_AVSCORE
 public:
   void CONSTRUCTOR0();  /* Damn compiler won't allow taking the address of reserved constructs, make a dummy interlude */
@@ -992,23 +1161,59 @@ public:
 }; // end class PVideoFrame
 
 
+// smart pointer to IFunction
+class PFunction
+{
+public:
+  PFunction() AVS_BakedCode( AVS_LinkCall_Void(PFunction_CONSTRUCTOR0)() )
+  PFunction(IFunction* p) AVS_BakedCode( AVS_LinkCall_Void(PFunction_CONSTRUCTOR1)(p) )
+  PFunction(const PFunction& p) AVS_BakedCode( AVS_LinkCall_Void(PFunction_CONSTRUCTOR2)(p) )
+  PFunction& operator=(IFunction* p) AVS_BakedCode( return AVS_LinkCallV(PFunction_OPERATOR_ASSIGN0)(p) )
+  PFunction& operator=(const PFunction& p) AVS_BakedCode( return AVS_LinkCallV(PFunction_OPERATOR_ASSIGN1)(p) )
+  ~PFunction() AVS_BakedCode( AVS_LinkCall_Void(PFunction_DESTRUCTOR)() )
+
+  int operator!() const { return !e; }
+  operator void*() const { return e; }
+  IFunction* operator->() const { return e; }
+
+private:
+  IFunction * e;
+
+  friend class AVSValue;
+  IFunction * GetPointerWithAddRef() const;
+  void Init(IFunction* p);
+  void Set(IFunction* p);
+
+#ifdef BUILDING_AVSCORE
+public:
+  void CONSTRUCTOR0();  /* Damn compiler won't allow taking the address of reserved constructs, make a dummy interlude */
+  void CONSTRUCTOR1(IFunction* p);
+  void CONSTRUCTOR2(const PFunction& p);
+  PFunction& OPERATOR_ASSIGN0(IFunction* p);
+  PFunction& OPERATOR_ASSIGN1(const PFunction& p);
+  void DESTRUCTOR();
+#endif
+}; // end class PFunction
+
+
 class AVSValue {
 public:
 
-  AVSValue() AVS_BakedCode( AVS_LinkCall(AVSValue_CONSTRUCTOR0)() )
-  AVSValue(IClip* c) AVS_BakedCode( AVS_LinkCall(AVSValue_CONSTRUCTOR1)(c) )
-  AVSValue(const PClip& c) AVS_BakedCode( AVS_LinkCall(AVSValue_CONSTRUCTOR2)(c) )
-  AVSValue(bool b) AVS_BakedCode( AVS_LinkCall(AVSValue_CONSTRUCTOR3)(b) )
-  AVSValue(int i) AVS_BakedCode( AVS_LinkCall(AVSValue_CONSTRUCTOR4)(i) )
-//  AVSValue(__int64 l);
-  AVSValue(float f) AVS_BakedCode( AVS_LinkCall(AVSValue_CONSTRUCTOR5)(f) )
-  AVSValue(double f) AVS_BakedCode( AVS_LinkCall(AVSValue_CONSTRUCTOR6)(f) )
-  AVSValue(const char* s) AVS_BakedCode( AVS_LinkCall(AVSValue_CONSTRUCTOR7)(s) )
-  AVSValue(const AVSValue* a, int size) AVS_BakedCode( AVS_LinkCall(AVSValue_CONSTRUCTOR8)(a, size) )
-  AVSValue(const AVSValue& a, int size) AVS_BakedCode( AVS_LinkCall(AVSValue_CONSTRUCTOR8)(&a, size) )
-  AVSValue(const AVSValue& v) AVS_BakedCode( AVS_LinkCall(AVSValue_CONSTRUCTOR9)(v) )
-
-  ~AVSValue() AVS_BakedCode( AVS_LinkCall(AVSValue_DESTRUCTOR)() )
+  AVSValue() AVS_BakedCode( AVS_LinkCall_Void(AVSValue_CONSTRUCTOR0)() )
+  AVSValue(IClip* c) AVS_BakedCode( AVS_LinkCall_Void(AVSValue_CONSTRUCTOR1)(c) )
+  AVSValue(const PClip& c) AVS_BakedCode( AVS_LinkCall_Void(AVSValue_CONSTRUCTOR2)(c) )
+  AVSValue(bool b) AVS_BakedCode( AVS_LinkCall_Void(AVSValue_CONSTRUCTOR3)(b) )
+  AVSValue(int i) AVS_BakedCode( AVS_LinkCall_Void(AVSValue_CONSTRUCTOR4)(i) )
+//  AVSValue(int64_t l);
+  AVSValue(float f) AVS_BakedCode( AVS_LinkCall_Void(AVSValue_CONSTRUCTOR5)(f) )
+  AVSValue(double f) AVS_BakedCode( AVS_LinkCall_Void(AVSValue_CONSTRUCTOR6)(f) )
+  AVSValue(const char* s) AVS_BakedCode( AVS_LinkCall_Void(AVSValue_CONSTRUCTOR7)(s) )
+  AVSValue(const AVSValue* a, int size) AVS_BakedCode( AVS_LinkCall_Void(AVSValue_CONSTRUCTOR8)(a, size) )
+  AVSValue(const AVSValue& a, int size) AVS_BakedCode( AVS_LinkCall_Void(AVSValue_CONSTRUCTOR8)(&a, size) )
+  AVSValue(const AVSValue& v) AVS_BakedCode( AVS_LinkCall_Void(AVSValue_CONSTRUCTOR9)(v) )
+  AVSValue(const PFunction& n) AVS_BakedCode( AVS_LinkCall_Void(AVSValue_CONSTRUCTOR11)(n) )
+
+  ~AVSValue() AVS_BakedCode( AVS_LinkCall_Void(AVSValue_DESTRUCTOR)() )
   AVSValue& operator=(const AVSValue& v) AVS_BakedCode( return AVS_LinkCallV(AVSValue_OPERATOR_ASSIGN)(v) )
 
   // Note that we transparently allow 'int' to be treated as 'float'.
@@ -1022,6 +1227,7 @@ public:
   bool IsFloat() const AVS_BakedCode( return AVS_LinkCall(IsFloat)() )
   bool IsString() const AVS_BakedCode( return AVS_LinkCall(IsString)() )
   bool IsArray() const AVS_BakedCode( return AVS_LinkCall(IsArray)() )
+  bool IsFunction() const AVS_BakedCode( return AVS_LinkCall(IsFunction)() )
 
   PClip AsClip() const AVS_BakedCode( return AVS_LinkCall(AsClip)() )
   bool AsBool() const AVS_BakedCode( return AVS_LinkCall(AsBool1)() )
@@ -1030,6 +1236,7 @@ public:
   const char* AsString() const AVS_BakedCode( return AVS_LinkCall(AsString1)() )
   double AsFloat() const AVS_BakedCode( return AVS_LinkCall(AsFloat1)() )
   float AsFloatf() const AVS_BakedCode( return float( AVS_LinkCall(AsFloat1)() ) )
+  PFunction AsFunction() const; // internal use only
 
   bool AsBool(bool def) const AVS_BakedCode( return AVS_LinkCall(AsBool2)(def) )
   int AsInt(int def) const AVS_BakedCode( return AVS_LinkCall(AsInt2)(def) )
@@ -1044,7 +1251,7 @@ public:
 
 private:
 
-  short type;  // 'a'rray, 'c'lip, 'b'ool, 'i'nt, 'f'loat, 's'tring, 'v'oid, or RFU: 'l'ong ('d'ouble)
+  short type;  // 'a'rray, 'c'lip, 'b'ool, 'i'nt, 'f'loat, 's'tring, 'v'oid, 'n'unction, or RFU: 'l'ong ('d'ouble)
   short array_size;
   union {
     IClip* clip;
@@ -1053,9 +1260,10 @@ private:
     float floating_pt;
     const char* string;
     const AVSValue* array;
+    IFunction* function;
     #ifdef X86_64
     // if ever, only x64 will support. It breaks struct size on 32 bit
-    __int64 longlong; // 8 bytes
+    int64_t longlong; // 8 bytes
     double double_pt; // 8 bytes 
     #endif
   };
@@ -1073,6 +1281,7 @@ public:
   void            CONSTRUCTOR7(const char* s);
   void            CONSTRUCTOR8(const AVSValue* a, int size);
   void            CONSTRUCTOR9(const AVSValue& v);
+  void            CONSTRUCTOR11(const PFunction& n);
   void            DESTRUCTOR();
   AVSValue&       OPERATOR_ASSIGN(const AVSValue& v);
   const AVSValue& OPERATOR_INDEX(int index) const;
@@ -1093,6 +1302,7 @@ public:
 #undef AVS_LinkCallOptDefault
 #undef AVS_LinkCallOpt
 #undef AVS_LinkCallV
+#undef AVS_LinkCall_Void
 #undef AVS_LinkCall
 #undef AVS_BakedCode
 
@@ -1104,7 +1314,7 @@ protected:
 public:
   GenericVideoFilter(PClip _child) : child(_child) { vi = child->GetVideoInfo(); }
   PVideoFrame __stdcall GetFrame(int n, IScriptEnvironment* env) { return child->GetFrame(n, env); }
-  void __stdcall GetAudio(void* buf, __int64 start, __int64 count, IScriptEnvironment* env) { child->GetAudio(buf, start, count, env); }
+  void __stdcall GetAudio(void* buf, int64_t start, int64_t count, IScriptEnvironment* env) { child->GetAudio(buf, start, count, env); }
   const VideoInfo& __stdcall GetVideoInfo() { return vi; }
   bool __stdcall GetParity(int n) { return child->GetParity(n); }
   int __stdcall SetCacheHints(int cachehints,int frame_range) { return 0; } ;  // We do not pass cache requests upwards, only to the next filter.
@@ -1113,7 +1323,59 @@ public:
 
 
 
-#include <avs/cpuid.h>
+#include "avs/cpuid.h"
+
+// IScriptEnvironment GetEnvProperty
+enum AvsEnvProperty
+{
+  AEP_PHYSICAL_CPUS = 1,
+  AEP_LOGICAL_CPUS = 2,
+  AEP_THREADPOOL_THREADS = 3,
+  AEP_FILTERCHAIN_THREADS = 4,
+  AEP_THREAD_ID = 5,
+  AEP_VERSION = 6,
+  AEP_HOST_SYSTEM_ENDIANNESS = 7,
+  AEP_INTERFACE_VERSION = 8,
+  AEP_INTERFACE_BUGFIX = 9,
+
+  // Neo additionals
+  AEP_NUM_DEVICES = 901,
+  AEP_FRAME_ALIGN = 902,
+  AEP_PLANE_ALIGN = 903,
+
+  AEP_SUPPRESS_THREAD = 921,
+  AEP_GETFRAME_RECURSIVE = 922,
+};
+
+// IScriptEnvironment Allocate
+enum AvsAllocType
+{
+  AVS_NORMAL_ALLOC  = 1,
+  AVS_POOLED_ALLOC  = 2
+};
+
+// frame properties, since V8
+enum AVSPropTypes {
+  PROPTYPE_UNSET = 'u', // ptUnset
+  PROPTYPE_INT = 'i', // peType
+  PROPTYPE_FLOAT = 'f', // ptFloat
+  PROPTYPE_DATA = 's', // ptData
+  PROPTYPE_CLIP = 'c', // ptClip
+  PROPTYPE_FRAME = 'v' // ptFrame
+  //  ptFunction = 'm'
+};
+
+enum AVSGetPropErrors {
+  GETPROPERROR_UNSET = 1, // peUnset
+  GETPROPERROR_TYPE = 2, // peType
+  GETPROPERROR_INDEX = 4 // peIndex
+};
+
+enum AVSPropAppendMode {
+  PROPAPPENDMODE_REPLACE = 0, // paReplace
+  PROPAPPENDMODE_APPEND = 1, // paAppend
+  PROPAPPENDMODE_TOUCH = 2 // paTouch
+};
 
 
 
@@ -1124,11 +1386,16 @@ public:
   virtual /*static*/ int __stdcall GetCPUFlags() = 0;
 
   virtual char* __stdcall SaveString(const char* s, int length = -1) = 0;
-  virtual char* __stdcall Sprintf(const char* fmt, ...) = 0;
+  virtual char* Sprintf(const char* fmt, ...) = 0;
   // note: val is really a va_list; I hope everyone typedefs va_list to a pointer
-  virtual char* __stdcall VSprintf(const char* fmt, void* val) = 0;
+  // 20200305: (void *) changed back to va_list
+  virtual char* __stdcall VSprintf(const char* fmt, va_list val) = 0;
 
-  __declspec(noreturn) virtual void __stdcall ThrowError(const char* fmt, ...) = 0;
+#ifdef AVS_WINDOWS
+  __declspec(noreturn) virtual void ThrowError(const char* fmt, ...) = 0;
+#else
+  virtual void ThrowError(const char* fmt, ...) = 0;
+#endif
 
   class NotFound /*exception*/ {};  // thrown by Invoke and GetVar
 
@@ -1155,7 +1422,7 @@ public:
   typedef void (__cdecl *ShutdownFunc)(void* user_data, IScriptEnvironment* env);
   virtual void __stdcall AtExit(ShutdownFunc function, void* user_data) = 0;
 
-  virtual void __stdcall CheckVersion(int version = AVISYNTH_INTERFACE_VERSION) = 0;
+  virtual void __stdcall CheckVersion(int version = AVISYNTH_CLASSIC_INTERFACE_VERSION) = 0;
 
   virtual PVideoFrame __stdcall Subframe(PVideoFrame src, int rel_offset, int new_pitch, int new_row_size, int new_height) = 0;
 
@@ -1180,11 +1447,88 @@ public:
   virtual void __stdcall ApplyMessage(PVideoFrame* frame, const VideoInfo& vi, const char* message, int size,
                                      int textcolor, int halocolor, int bgcolor) = 0;
 
-  virtual const AVS_Linkage* const __stdcall GetAVSLinkage() = 0;
+  virtual const AVS_Linkage* __stdcall GetAVSLinkage() = 0;
 
   // noThrow version of GetVar
   virtual AVSValue __stdcall GetVarDef(const char* name, const AVSValue& def = AVSValue()) = 0;
 
+  // **** AVISYNTH_INTERFACE_VERSION 8 **** AviSynth+ 3.6.0-
+  virtual PVideoFrame __stdcall SubframePlanarA(PVideoFrame src, int rel_offset, int new_pitch, int new_row_size,
+    int new_height, int rel_offsetU, int rel_offsetV, int new_pitchUV, int rel_offsetA) = 0;
+
+  virtual void __stdcall copyFrameProps(const PVideoFrame& src, PVideoFrame& dst) = 0;
+  virtual const AVSMap* __stdcall getFramePropsRO(const PVideoFrame& frame) = 0;
+  virtual AVSMap* __stdcall getFramePropsRW(PVideoFrame& frame) = 0;
+
+  virtual int __stdcall propNumKeys(const AVSMap* map) = 0;
+
+  virtual const char* __stdcall propGetKey(const AVSMap* map, int index) = 0;
+  virtual int __stdcall propNumElements(const AVSMap* map, const char* key) = 0;
+  virtual char __stdcall propGetType(const AVSMap* map, const char* key) = 0;
+
+  virtual int64_t __stdcall propGetInt(const AVSMap* map, const char* key, int index, int* error) = 0;
+  virtual double __stdcall propGetFloat(const AVSMap* map, const char* key, int index, int* error) = 0;
+  virtual const char* __stdcall propGetData(const AVSMap* map, const char* key, int index, int* error) = 0;
+  virtual int __stdcall propGetDataSize(const AVSMap* map, const char* key, int index, int* error) = 0;
+  virtual PClip __stdcall propGetClip(const AVSMap* map, const char* key, int index, int* error) = 0;
+  virtual const PVideoFrame __stdcall propGetFrame(const AVSMap* map, const char* key, int index, int* error) = 0;
+
+  virtual int __stdcall propDeleteKey(AVSMap* map, const char* key) = 0;
+
+  virtual int __stdcall propSetInt(AVSMap* map, const char* key, int64_t i, int append) = 0;
+  virtual int __stdcall propSetFloat(AVSMap* map, const char* key, double d, int append) = 0;
+  virtual int __stdcall propSetData(AVSMap* map, const char* key, const char* d, int length, int append) = 0;
+  virtual int __stdcall propSetClip(AVSMap* map, const char* key, PClip& clip, int append) = 0;
+  virtual int __stdcall propSetFrame(AVSMap* map, const char* key, const PVideoFrame& frame, int append) = 0;
+
+  virtual const int64_t *__stdcall propGetIntArray(const AVSMap* map, const char* key, int* error) = 0;
+  virtual const double *__stdcall propGetFloatArray(const AVSMap* map, const char* key, int* error) = 0;
+  virtual int __stdcall propSetIntArray(AVSMap* map, const char* key, const int64_t* i, int size) = 0;
+  virtual int __stdcall propSetFloatArray(AVSMap* map, const char* key, const double* d, int size) = 0;
+
+  virtual AVSMap* __stdcall createMap() = 0;
+  virtual void __stdcall freeMap(AVSMap* map) = 0;
+  virtual void __stdcall clearMap(AVSMap* map) = 0;
+
+  // NewVideoFrame with frame property source.
+  virtual PVideoFrame __stdcall NewVideoFrameP(const VideoInfo& vi, const PVideoFrame* prop_src, int align = FRAME_ALIGN) = 0;
+
+  // Generic query to ask for various system properties
+  virtual size_t  __stdcall GetEnvProperty(AvsEnvProperty prop) = 0;
+
+  // Support functions
+  virtual void* __stdcall Allocate(size_t nBytes, size_t alignment, AvsAllocType type) = 0;
+  virtual void __stdcall Free(void* ptr) = 0;
+
+  // these GetVar versions (renamed differently) were moved from IScriptEnvironment2
+
+  // Returns TRUE and the requested variable. If the method fails, returns FALSE and does not touch 'val'.
+  virtual bool  __stdcall GetVarTry(const char* name, AVSValue* val) const = 0; // ex virtual bool  __stdcall GetVar(const char* name, AVSValue* val) const = 0;
+  // Return the value of the requested variable.
+  // If the variable was not found or had the wrong type,
+  // return the supplied default value.
+  virtual bool __stdcall GetVarBool(const char* name, bool def) const = 0;
+  virtual int  __stdcall GetVarInt(const char* name, int def) const = 0;
+  virtual double  __stdcall GetVarDouble(const char* name, double def) const = 0;
+  virtual const char* __stdcall GetVarString(const char* name, const char* def) const = 0;
+  // brand new in v8 - though no real int64 support yet
+  virtual int64_t __stdcall GetVarLong(const char* name, int64_t def) const = 0;
+
+  // 'Invoke' functions moved here from internal ScriptEnvironments are renamed in order to keep vtable order
+  // Invoke functions with 'Try' will return false instead of throwing NotFound().
+  // ex-IScriptEnvironment2
+  virtual bool __stdcall InvokeTry(AVSValue* result, const char* name, const AVSValue& args, const char* const* arg_names = 0) = 0;
+  // Since V8
+  virtual AVSValue __stdcall Invoke2(const AVSValue& implicit_last, const char* name, const AVSValue args, const char* const* arg_names = 0) = 0;
+  // Ex-INeo
+  virtual bool __stdcall Invoke2Try(AVSValue* result, const AVSValue& implicit_last, const char* name, const AVSValue args, const char* const* arg_names = 0) = 0;
+  virtual AVSValue __stdcall Invoke3(const AVSValue& implicit_last, const PFunction& func, const AVSValue args, const char* const* arg_names = 0) = 0;
+  virtual bool __stdcall Invoke3Try(AVSValue* result, const AVSValue& implicit_last, const PFunction& func, const AVSValue args, const char* const* arg_names = 0) = 0;
+
+  // **** AVISYNTH_INTERFACE_VERSION 9 **** AviSynth+ 3.7.1-
+  // Makes the frame properties writable: a new VideoFrame over the same buffer when the properties are shared
+  virtual bool __stdcall MakePropertyWritable(PVideoFrame* pvf) = 0;
+
 }; // end class IScriptEnvironment
 
 
@@ -1194,7 +1538,8 @@ enum MtMode
   MT_NICE_FILTER = 1,
   MT_MULTI_INSTANCE = 2,
   MT_SERIALIZED = 3,
-  MT_MODE_COUNT = 4
+  MT_SPECIAL_MT = 4,
+  MT_MODE_COUNT = 5
 };
 
 class IJobCompletion
@@ -1214,22 +1559,6 @@ class IScriptEnvironment2;
 class Prefetcher;
 typedef AVSValue (*ThreadWorkerFuncPtr)(IScriptEnvironment2* env, void* data);
 
-enum AvsEnvProperty
-{
-  AEP_PHYSICAL_CPUS = 1,
-  AEP_LOGICAL_CPUS = 2,
-  AEP_THREADPOOL_THREADS = 3,
-  AEP_FILTERCHAIN_THREADS = 4,
-  AEP_THREAD_ID = 5,
-  AEP_VERSION = 6
-};
-
-enum AvsAllocType
-{
-  AVS_NORMAL_ALLOC  = 1,
-  AVS_POOLED_ALLOC  = 2
-};
-
 /* -----------------------------------------------------------------------------
    Note to plugin authors: The interface in IScriptEnvironment2 is
       preliminary / under construction / only for testing / non-final etc.!
@@ -1243,19 +1572,7 @@ class IScriptEnvironment2 : public IScriptEnvironment{
 public:
   virtual ~IScriptEnvironment2() {}
 
-  // Generic system to ask for various properties
-  virtual size_t  __stdcall GetProperty(AvsEnvProperty prop) = 0;
-
-  // Returns TRUE and the requested variable. If the method fails, returns FALSE and does not touch 'val'.
-  virtual bool  __stdcall GetVar(const char* name, AVSValue *val) const = 0;
-
-  // Return the value of the requested variable.
-  // If the variable was not found or had the wrong type,
-  // return the supplied default value.
-  virtual bool __stdcall GetVar(const char* name, bool def) const = 0;
-  virtual int  __stdcall GetVar(const char* name, int def) const = 0;
-  virtual double  __stdcall GetVar(const char* name, double def) const = 0;
-  virtual const char*  __stdcall GetVar(const char* name, const char* def) const = 0;
+  // V8: SubframePlanarA, GetEnvProperty, GetVar versions, Allocate, Free, no-throw Invoke moved to IScriptEnvironment
 
   // Plugin functions
   virtual bool __stdcall LoadPlugin(const char* filePath, bool throwOnError, AVSValue *result) = 0;
@@ -1270,17 +1587,9 @@ public:
   virtual IJobCompletion* __stdcall NewCompletion(size_t capacity) = 0;
   virtual void __stdcall ParallelJob(ThreadWorkerFuncPtr jobFunc, void* jobData, IJobCompletion* completion) = 0;
 
-  // This version of Invoke will return false instead of throwing NotFound().
-  virtual bool __stdcall Invoke(AVSValue *result, const char* name, const AVSValue& args, const char* const* arg_names=0) = 0;
-
-  // Support functions
-  virtual void* __stdcall Allocate(size_t nBytes, size_t alignment, AvsAllocType type) = 0;
-  virtual void __stdcall Free(void* ptr) = 0;
-
   // These lines are needed so that we can overload the older functions from IScriptEnvironment.
   using IScriptEnvironment::Invoke;
   using IScriptEnvironment::AddFunction;
-  using IScriptEnvironment::GetVar;
 
 }; // end class IScriptEnvironment2
 
@@ -1296,13 +1605,18 @@ AVSC_API(IScriptEnvironment*, CreateScriptEnvironment)(int version = AVISYNTH_IN
 #define VARNAME_AVIPadScanlines   "OPT_AVIPadScanlines"   // Have scanlines mod4 padded in all pixel formats
 #define VARNAME_UseWaveExtensible "OPT_UseWaveExtensible" // Use WAVEFORMATEXTENSIBLE when describing audio to Windows
 #define VARNAME_dwChannelMask     "OPT_dwChannelMask"     // Integer audio channel mask. See description of WAVEFORMATEXTENSIBLE for more info.
+#define VARNAME_Enable_V210       "OPT_Enable_V210"       // AVS+ use V210 instead of P210 (VfW)
+#define VARNAME_Enable_Y3_10_10   "OPT_Enable_Y3_10_10"   // AVS+ use Y3[10][10] instead of P210 (VfW)
+#define VARNAME_Enable_Y3_10_16   "OPT_Enable_Y3_10_16"   // AVS+ use Y3[10][16] instead of P216 (VfW)
+#define VARNAME_Enable_b64a       "OPT_Enable_b64a"       // AVS+ use b64a instead of BRA[64] (VfW)
+#define VARNAME_Enable_PlanarToPackedRGB "OPT_Enable_PlanarToPackedRGB" // AVS+ convert Planar RGB to packed RGB (VfW)
 
 
 // C exports
-#include <avs/capi.h>
+#include "avs/capi.h"
 AVSC_API(IScriptEnvironment2*, CreateScriptEnvironment2)(int version = AVISYNTH_INTERFACE_VERSION);
 
 
 #pragma pack(pop)
 
-#endif //__AVISYNTH_6_H__
+#endif //__AVISYNTH_9_H__
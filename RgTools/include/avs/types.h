@@ -35,23 +35,27 @@
 
 // Define all types necessary for interfacing with avisynth.dll
 
+#include "config.h"
+
 #ifdef __cplusplus
   #include <cstddef>
+  #include <cstdarg>
 #else
   #include <stddef.h>
+  #include <stdarg.h>
+#endif
+
+// NOTE: this header is included from the C interface too
+#include <stdint.h>
+#ifndef __cplusplus
+#include <stdbool.h>
 #endif
 
 // Raster types used by VirtualDub & Avisynth
-typedef unsigned int    Pixel32;
-typedef unsigned char   BYTE;
+typedef uint32_t        Pixel32;
+typedef uint8_t         BYTE;
 
 // Audio Sample information
 typedef float SFLOAT;
 
-#ifdef __GNUC__
-typedef long long int INT64;
-#else
-typedef __int64 INT64;
-#endif
-
 #endif //AVS_TYPES_H
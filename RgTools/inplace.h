@@ -0,0 +1,54 @@
+#ifndef __INPLACE_H__
+#define __INPLACE_H__
+
+#include "common.h"
+#include <vector>
+
+// In-place filtering of a plane of an exclusively owned frame. The plane is processed in windows of rows,
+// the source rows of a window are kept in a small buffer that stays in cache and the plane processor
+// writes from there back into the plane.
+// Windows overlap by 2*border rows: the processor copies 'border' rows at the top and the bottom of a
+// window unchanged. The top ones are final from the previous window and are put back afterwards, the
+// bottom ones are filtered by the next window. Their source values are carried over in the buffer, the
+// plane rows are already overwritten. Window starts stay even, which keeps the field parity of
+// RemoveGrain modes 13-16.
+// process(y, h, pSrc, srcPitch, pDst, dstPitch) must run the plane processor on the h rows from plane row y.
+template<typename F>
+static void process_plane_inplace(Byte* pPlane, int pitch, int rowsize, int height, int border, F process) {
+    const int bufPitch = (rowsize + 63) & ~63;
+    int window = std::min(std::max(256 * 1024 / bufPitch, 8 * border), 64) & ~1;
+    if (window >= height)
+        window = height;
+
+    // window rows, then 'border' rows for the final rows the processor overwrites
+    std::vector<Byte> buffer(bufPitch * (window + border) + 64);
+    Byte* pBuf = reinterpret_cast<Byte*>(((uintptr_t)buffer.data() + 63) & ~(uintptr_t)63);
+    Byte* pSaved = pBuf + window * bufPitch;
+
+    for (int y = 0; ; y += window - 2 * border) {
+        const int h = std::min(window, height - y);
+        Byte* pRows = pPlane + y * pitch;
+
+        int carried = 0;
+        if (y > 0) {
+            carried = 2 * border;
+            for (int r = 0; r < carried; ++r)
+                memcpy(pBuf + r * bufPitch, pBuf + (window - carried + r) * bufPitch, rowsize);
+            for (int r = 0; r < border; ++r)
+                memcpy(pSaved + r * bufPitch, pRows + r * pitch, rowsize);
+        }
+        for (int r = carried; r < h; ++r)
+            memcpy(pBuf + r * bufPitch, pRows + r * pitch, rowsize);
+
+        process(y, h, pBuf, bufPitch, pRows, pitch);
+
+        if (y > 0) {
+            for (int r = 0; r < border; ++r)
+                memcpy(pRows + r * pitch, pSaved + r * bufPitch, rowsize);
+        }
+        if (y + h == height)
+            break;
+    }
+}
+
+#endif
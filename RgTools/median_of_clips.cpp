@@ -0,0 +1,122 @@
+#include "median_of_clips.h"
+
+
+MedianOfClips::MedianOfClips(const std::vector<PClip> &clips, int rank, bool skip_cs_check, bool use_avx2, int threads, bool profile, IScriptEnvironment* env)
+    : GenericVideoFilter(clips[0]), clips_(clips), rank_(rank), processor_(nullptr), median_processor_(nullptr), pool_(nullptr), stripes_(1) {
+    if (!(vi.IsPlanar() || skip_cs_check)) {
+        env->ThrowError("MedianOfClips works only with planar colorspaces");
+    }
+
+    const int count = (int)clips_.size();
+    if (count < 2 || count > RANK_MAX_PLANES) {
+        env->ThrowError("MedianOfClips: between 2 and %d clips are needed!", RANK_MAX_PLANES);
+    }
+    for (int i = 1; i < count; ++i) {
+        const VideoInfo &other = clips_[i]->GetVideoInfo();
+        if (other.width != vi.width || other.height != vi.height)
+            env->ThrowError("MedianOfClips: frame dimensions of clip %d do not match", i + 1);
+        if (!other.IsSameColorspace(vi))
+            env->ThrowError("MedianOfClips: colorspace of clip %d does not match", i + 1);
+        // frames past the end of a shorter clip are its last frame
+        vi.num_frames = std::max(vi.num_frames, other.num_frames);
+    }
+
+    if (rank_ < 0)
+      rank_ = (count - 1) / 2;
+    if (rank_ >= count) {
+        env->ThrowError("MedianOfClips: rank must be between 0 and %d!", count - 1);
+    }
+
+    const int pixelsize = vi.ComponentSize();
+    const int bits_per_pixel = vi.BitsPerComponent();
+    if (pixelsize == 2 && (bits_per_pixel < 10 || bits_per_pixel > 16 || (bits_per_pixel & 1)))
+      env->ThrowError("Illegal bit-depth: %d!", bits_per_pixel);
+
+    // the narrowest plane, same tables and instruction set choice as Clense radius 2-4
+    const int min_width = chroma_plane_width(vi);
+    const char *isa;
+    processor_ = rank_function(vi, min_width, use_avx2, &isa, env);
+    // the median of 5, 7 or 9 has shorter networks than the sort
+    const int radius = (count - 1) / 2;
+    if ((count & 1) && rank_ == radius && radius >= 2 && radius <= Clense::MAX_RADIUS)
+      median_processor_ = clense_median_function(vi, min_width, radius, use_avx2, &isa, env);
+
+    profile_ = FilterProfile::create(profile, "MedianOfClips", vi, env);
+    if (profile_) {
+      for (int p = 0; p < 3; ++p)
+        profile_->set_isa(p, isa);
+    }
+
+    if (threads < 0) {
+      env->ThrowError("MedianOfClips: threads must be 0 (auto) or positive!");
+    }
+    if (threads != 1) {
+      pool_ = ThreadPool::acquire();
+      stripes_ = stripes_for_threads(threads, pool_);
+    }
+}
+
+MedianOfClips::~MedianOfClips() {
+  if (pool_ != nullptr)
+    ThreadPool::release();
+}
+
+// Every stripe reads its rows of all clips, a row of each at a time: no buffer, the working set is
+// count source rows however many clips there are
+void MedianOfClips::process_plane(int p, int plane, PVideoFrame &dstFrame, const PVideoFrame *frames, IScriptEnvironment *env) {
+  const int count = (int)clips_.size();
+  const Byte* pPlanes[RANK_MAX_PLANES];
+  int pitches[RANK_MAX_PLANES];
+  for (int i = 0; i < count; ++i) {
+    pPlanes[i] = frames[i]->GetReadPtr(plane);
+    pitches[i] = frames[i]->GetPitch(plane);
+  }
+  const int rowsize = dstFrame->GetRowSize(plane);
+  const int height = dstFrame->GetHeight(plane);
+
+  PlaneTimer timer(profile_.get(), p, rowsize, height, count);
+  // purely per pixel, stripes need no overlap
+  process_plane_stripes(pool_, stripes_, 0, dstFrame->GetWritePtr(plane), dstFrame->GetPitch(plane), rowsize, height, [&](int y, int h, Byte* pStripeDst, int stripeDstPitch) {
+    const Byte* pStripes[RANK_MAX_PLANES];
+    for (int i = 0; i < count; ++i)
+      pStripes[i] = pPlanes[i] + y * pitches[i];
+    if (median_processor_ != nullptr)
+      median_processor_(pStripeDst, pStripes, pitches, stripeDstPitch, rowsize, h, env);
+    else
+      processor_(pStripeDst, pStripes, pitches, count, rank_, stripeDstPitch, rowsize, h, env);
+  });
+}
+
+PVideoFrame MedianOfClips::GetFrame(int n, IScriptEnvironment* env) {
+    const int count = (int)clips_.size();
+    PVideoFrame frames[RANK_MAX_PLANES];
+    for (int i = 0; i < count; ++i)
+      frames[i] = clips_[i]->GetFrame(std::min(n, clips_[i]->GetVideoInfo().num_frames - 1), env);
+
+    auto dstFrame = env->NewVideoFrame(vi);
+    FrameProfile frame_profile(profile_.get());
+
+    int planes_y[3] = { PLANAR_Y, PLANAR_U, PLANAR_V };
+    int planes_r[3] = { PLANAR_G, PLANAR_B, PLANAR_R };
+    const bool rgb = vi.IsPlanarRGB() || vi.IsPlanarRGBA();
+    const int num_planes = (vi.IsPlanar() && !vi.IsY()) ? 3 : 1;
+    for (int p = 0; p < num_planes; ++p)
+      process_plane(p, rgb ? planes_r[p] : planes_y[p], dstFrame, frames, env);
+
+    if (vi.IsYUVA() || vi.IsPlanarRGBA())
+    { // copy alpha of the first clip
+      env->BitBlt(dstFrame->GetWritePtr(PLANAR_A), dstFrame->GetPitch(PLANAR_A), frames[0]->GetReadPtr(PLANAR_A), frames[0]->GetPitch(PLANAR_A), frames[0]->GetRowSize(PLANAR_A_ALIGNED), frames[0]->GetHeight(PLANAR_A));
+    }
+    frame_profile.attach(dstFrame, env);
+    return dstFrame;
+}
+
+
+AVSValue __cdecl Create_MedianOfClips(AVSValue args, void*, IScriptEnvironment* env) {
+    enum { CLIPS, RANK, PLANAR, OPTAVX2, THREADS, PROFILE };
+    std::vector<PClip> clips;
+    for (int i = 0; i < args[CLIPS].ArraySize(); ++i)
+      clips.push_back(args[CLIPS][i].AsClip());
+    return new MedianOfClips(clips, args[RANK].AsInt(-1),
+      args[PLANAR].AsBool(false), args[OPTAVX2].AsBool(true), args[THREADS].AsInt(1), args[PROFILE].AsBool(false), env);
+}
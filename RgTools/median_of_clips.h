@@ -0,0 +1,45 @@
+#ifndef __MEDIAN_OF_CLIPS_H__
+#define __MEDIAN_OF_CLIPS_H__
+
+#include "common.h"
+#include "thread_pool.h"
+#include "profile.h"
+#include "clense.h"
+#include <vector>
+
+
+// Per pixel median (or any rank) of the same frame of several clips, e.g. captures of one tape
+class MedianOfClips : public GenericVideoFilter {
+public:
+    // rank -1: median, the lower one of the two middle values for an even number of clips
+    MedianOfClips(const std::vector<PClip> &clips, int rank, bool skip_cs_check, bool use_avx2, int threads, bool profile, IScriptEnvironment* env);
+    ~MedianOfClips();
+
+    PVideoFrame __stdcall GetFrame(int n, IScriptEnvironment* env);
+
+    // profile=true, else nullptr
+    FilterProfile* profile() const { return profile_.get(); }
+
+    int __stdcall SetCacheHints(int cachehints, int frame_range) override {
+      return cachehints == CACHE_GET_MTMODE ? MT_NICE_FILTER : 0;
+    }
+
+private:
+    std::vector<PClip> clips_;
+    int rank_;
+
+    RankProcessor* processor_;
+    ClenseMedianProcessor* median_processor_; // median of 5, 7 or 9 clips: the Clense radius 2-4 networks, else nullptr
+
+    ThreadPool *pool_; // nullptr when threads=1
+    int stripes_;
+
+    std::shared_ptr<FilterProfile> profile_; // nullptr when profile=false
+
+    void process_plane(int p, int plane, PVideoFrame &dstFrame, const PVideoFrame *frames, IScriptEnvironment *env);
+};
+
+
+AVSValue __cdecl Create_MedianOfClips(AVSValue args, void*, IScriptEnvironment* env);
+
+#endif
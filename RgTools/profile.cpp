@@ -0,0 +1,187 @@
+#include "profile.h"
+#include <cstdio>
+#include <mutex>
+#include <set>
+#include <vector>
+
+// filters are created from several script threads
+static std::mutex profiles_lock;
+static std::vector<std::shared_ptr<FilterProfile>> profiles;
+static int instance_count = 0;
+static std::set<std::string> logs; // written at script close, "" = debug output
+
+std::shared_ptr<FilterProfile> FilterProfile::create(bool enabled, const char *filter, const VideoInfo &vi, IScriptEnvironment *env) {
+  if (!enabled)
+    return nullptr;
+
+  // MakePropertyWritable is interface 9, Avisynth 2.6 and older Avisynth+ get the totals only
+  bool frame_props = true;
+  try {
+    env->CheckVersion(9);
+  } catch (const AvisynthError&) {
+    frame_props = false;
+  }
+
+  std::lock_guard<std::mutex> guard(profiles_lock);
+  char name[128];
+  snprintf(name, sizeof(name), "%s #%d, %dx%d, %d bit", filter, ++instance_count, vi.width, vi.height, vi.BitsPerComponent());
+  auto profile = std::make_shared<FilterProfile>(name, filter, frame_props);
+  profiles.push_back(profile);
+  return profile;
+}
+
+FilterProfile::FilterProfile(const std::string &name, const char *filter, bool frame_props)
+  : name_(name), filter_(filter), frame_props_(frame_props) {
+  for (auto &plane : planes_)
+    plane.isa = "";
+  reset();
+}
+
+void FilterProfile::reset() {
+  for (auto &plane : planes_) {
+    plane.calls = 0;
+    plane.ns = 0;
+    plane.bytes_read = 0;
+    plane.bytes_written = 0;
+  }
+  hits_ = 0;
+  misses_ = 0;
+}
+
+void FilterProfile::add(int p, std::chrono::steady_clock::duration time, long long bytes_read, long long bytes_written) {
+  const long long ns = std::chrono::duration_cast<std::chrono::nanoseconds>(time).count();
+  Plane &plane = planes_[p];
+  plane.calls += 1;
+  plane.ns += ns;
+  plane.bytes_read += bytes_read;
+  plane.bytes_written += bytes_written;
+
+  FrameProfile *frame = FrameProfile::current_;
+  if (frame != nullptr && frame->profile_ == this) {
+    frame->ns_ += ns;
+    frame->bytes_read_[p] += bytes_read;
+    frame->bytes_written_[p] += bytes_written;
+    frame->planes_ = std::max(frame->planes_, p + 1);
+  }
+}
+
+thread_local FrameProfile *FrameProfile::current_ = nullptr;
+
+FrameProfile::FrameProfile(FilterProfile *profile)
+  : profile_(profile != nullptr && profile->frame_props_ ? profile : nullptr), outer_(current_), ns_(0), planes_(0) {
+  for (int p = 0; p < 3; ++p)
+    bytes_read_[p] = bytes_written_[p] = 0;
+  if (profile_ != nullptr)
+    current_ = this;
+}
+
+FrameProfile::~FrameProfile() {
+  if (profile_ != nullptr)
+    current_ = outer_;
+}
+
+void FrameProfile::attach(PVideoFrame &frame, IScriptEnvironment *env) {
+  if (profile_ == nullptr || planes_ == 0)
+    return;
+
+  // in place or handed on frames may share their properties with another frame
+  env->MakePropertyWritable(&frame);
+  AVSMap *props = env->getFramePropsRW(frame);
+  const std::string key = "_RgTools_" + profile_->filter_;
+  env->propSetInt(props, (key + "_us").c_str(), ns_ / 1000, PROPAPPENDMODE_REPLACE);
+  env->propSetIntArray(props, (key + "_read").c_str(), bytes_read_, planes_);
+  env->propSetIntArray(props, (key + "_written").c_str(), bytes_written_, planes_);
+  const std::string isa_key = key + "_isa";
+  for (int p = 0; p < planes_; ++p) {
+    const char *isa = profile_->planes_[p].isa;
+    env->propSetData(props, isa_key.c_str(), isa, (int)strlen(isa), p == 0 ? PROPAPPENDMODE_REPLACE : PROPAPPENDMODE_APPEND);
+  }
+}
+
+std::string FilterProfile::report() const {
+  return name_ + "\n" + plane_report();
+}
+
+std::string FilterProfile::plane_report() const {
+  std::string s;
+  bool any = false;
+  for (int p = 0; p < 3; ++p) {
+    const Plane &plane = planes_[p];
+    const long long calls = plane.calls;
+    if (calls == 0)
+      continue;
+    any = true;
+
+    const double ms = plane.ns / 1e6;
+    const double read = plane.bytes_read / 1e6;
+    const double written = plane.bytes_written / 1e6;
+    char line[256];
+    snprintf(line, sizeof(line), "  plane %d %-8s %8lld frames %10.1f ms %9.1f us/frame  read %9.1f MB  written %9.1f MB %7.2f GB/s\n",
+      p, plane.isa, calls, ms, ms * 1000 / calls, read, written, ms > 0 ? (read + written) / ms : 0.0);
+    s += line;
+  }
+  if (!any)
+    s += "  no frames processed\n";
+  const long long hits = hits_, misses = misses_;
+  if (hits + misses > 0) {
+    char line[128];
+    snprintf(line, sizeof(line), "  frame cache %lld hits %lld misses\n", hits, misses);
+    s += line;
+  }
+  return s;
+}
+
+std::string profile_report() {
+  std::lock_guard<std::mutex> guard(profiles_lock);
+  if (profiles.empty())
+    return "RgTools: no filter with profile=true\n";
+
+  std::string s = "RgTools profile\n";
+  for (auto &profile : profiles)
+    s += profile->report();
+  return s;
+}
+
+// script close: no more frames, the totals are final
+static void __cdecl write_report(void* user_data, IScriptEnvironment*) {
+  std::unique_ptr<std::string> path(static_cast<std::string*>(user_data));
+  const std::string report = profile_report();
+  {
+    std::lock_guard<std::mutex> guard(profiles_lock);
+    logs.erase(*path);
+  }
+
+  if (path->empty()) {
+#ifdef _WIN32
+    OutputDebugStringA(report.c_str());
+#else
+    fputs(report.c_str(), stderr);
+#endif
+  } else {
+    FILE *f = fopen(path->c_str(), "a");
+    if (f != nullptr) {
+      fputs(report.c_str(), f);
+      fclose(f);
+    }
+  }
+
+  // forget instances no filter uses anymore, a reopened script starts over
+  std::lock_guard<std::mutex> guard(profiles_lock);
+  profiles.erase(std::remove_if(profiles.begin(), profiles.end(),
+    [](const std::shared_ptr<FilterProfile> &profile) { return profile.use_count() == 1; }), profiles.end());
+}
+
+AVSValue __cdecl Create_RgToolsStats(AVSValue args, void*, IScriptEnvironment* env) {
+  enum { LOG };
+  const std::string path = args[LOG].AsString("");
+  bool first;
+  {
+    std::lock_guard<std::mutex> guard(profiles_lock);
+    first = logs.insert(path).second;
+  }
+  // once per log, RgToolsStats may run every frame in ScriptClip.
+  // "" = debug output (DebugView), a log file is appended to
+  if (first)
+    env->AtExit(write_report, new std::string(path));
+  return AVSValue(env->SaveString(profile_report().c_str()));
+}
@@ -0,0 +1,111 @@
+#ifndef __PROFILE_H__
+#define __PROFILE_H__
+
+#include "common.h"
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+
+class FrameProfile;
+
+// profile=true: processing time and memory traffic of each plane, summed over the frames of one filter
+// instance. Instances stay in a plugin-wide list after the filter is destroyed, RgToolsStats() reports them.
+class FilterProfile {
+public:
+  // nullptr when profile=false, filter is the script function name
+  static std::shared_ptr<FilterProfile> create(bool enabled, const char *filter, const VideoInfo &vi, IScriptEnvironment *env);
+
+  // frame_props: the host has frame properties (interface 9), see FrameProfile
+  FilterProfile(const std::string &name, const char *filter, bool frame_props);
+
+  // plane processor table of plane p (0..2), e.g. "avx2"
+  void set_isa(int p, const char *isa) { planes_[p].isa = isa; }
+  void add(int p, std::chrono::steady_clock::duration time, long long bytes_read, long long bytes_written);
+  // output frame reused from the filter's own cache (Clense reduceflicker) or not
+  void count_lookup(bool hit) { (hit ? hits_ : misses_) += 1; }
+  void reset(); // totals to zero, the table names stay
+
+  // name line and one line per processed plane
+  std::string report() const;
+  std::string plane_report() const;
+
+private:
+  friend class FrameProfile;
+
+  struct Plane {
+    const char *isa;
+    std::atomic<long long> calls;
+    std::atomic<long long> ns;
+    std::atomic<long long> bytes_read;
+    std::atomic<long long> bytes_written;
+  };
+
+  std::string name_;
+  std::string filter_;
+  bool frame_props_;
+  Plane planes_[3];
+  std::atomic<long long> hits_;
+  std::atomic<long long> misses_;
+};
+
+// Times one plane from construction to destruction, does nothing without a profile
+class PlaneTimer {
+public:
+  // inputs: planes of this size read per output plane (RemoveGrain 1, Repair 2, Clense 3)
+  PlaneTimer(FilterProfile *profile, int p, int rowsize, int height, int inputs)
+    : profile_(profile), p_(p), bytes_((long long)rowsize * height), inputs_(inputs) {
+    if (profile_ != nullptr)
+      start_ = std::chrono::steady_clock::now();
+  }
+
+  ~PlaneTimer() {
+    if (profile_ != nullptr)
+      profile_->add(p_, std::chrono::steady_clock::now() - start_, bytes_ * inputs_, bytes_);
+  }
+
+private:
+  PlaneTimer(const PlaneTimer&) = delete;
+  PlaneTimer& operator=(const PlaneTimer&) = delete;
+
+  FilterProfile *profile_;
+  int p_;
+  long long bytes_;
+  int inputs_;
+  std::chrono::steady_clock::time_point start_;
+};
+
+// The planes of one output frame, written onto it as frame properties when the host has them:
+// _RgTools_<filter>_us (int, all planes), _RgTools_<filter>_read and _written (int arrays, bytes per plane)
+// and _RgTools_<filter>_isa (data array, table per plane). Created in GetFrame, PlaneTimer reports to it
+// through FilterProfile::add on the same thread.
+class FrameProfile {
+public:
+  // does nothing without a profile or frame properties
+  FrameProfile(FilterProfile *profile);
+  ~FrameProfile();
+
+  // the finished output frame, once
+  void attach(PVideoFrame &frame, IScriptEnvironment *env);
+
+private:
+  FrameProfile(const FrameProfile&) = delete;
+  FrameProfile& operator=(const FrameProfile&) = delete;
+
+  friend class FilterProfile;
+  static thread_local FrameProfile *current_;
+
+  FilterProfile *profile_;
+  FrameProfile *outer_; // another filter's frame on this thread
+  long long ns_;
+  int64_t bytes_read_[3];
+  int64_t bytes_written_[3];
+  int planes_; // highest timed plane + 1
+};
+
+// all profiled instances of the process, one block per instance
+std::string profile_report();
+
+AVSValue __cdecl Create_RgToolsStats(AVSValue args, void*, IScriptEnvironment* env);
+
+#endif
@@ -1,56 +1,91 @@
 #include "rg_functions_c.h"
 #include "rg_functions_sse.h"
+#include "colsort.h"
 #include "removegrain.h"
+#include "autotune.h"
+#include "inplace.h"
+
+
+// 'rows' (1 or 2) output rows per call: both results of a column are computed before storing them,
+// so the compiler can keep the two source rows shared by the output rows in registers
+// instead of loading them again (12 loads per column instead of 18)
+template<SseModeProcessor processor, int rows, bool aligned>
+static RG_FORCEINLINE void process_column_sse(const Byte* pSrc, Byte* pDst, int srcPitch, int dstPitch) {
+    __m128i r0 = processor(pSrc, srcPitch);
+    __m128i r1;
+    if (rows > 1) r1 = processor(pSrc + srcPitch, srcPitch);
+    simd_store_si128<aligned>(pDst, r0);
+    if (rows > 1) simd_store_si128<aligned>(pDst + dstPitch, r1);
+}
 
-
-template<typename pixel_t, SseModeProcessor processor, SseModeProcessor processor_a>
-static void process_plane_sse(IScriptEnvironment* env, const BYTE* pSrc8, BYTE* pDst8, int rowsize, int height, int srcPitch, int dstPitch) {
-    env->BitBlt(pDst8, dstPitch, pSrc8, srcPitch, rowsize, 1);
-
-    pixel_t *pDst = reinterpret_cast<pixel_t *>(pDst8);
-    const pixel_t *pSrc = reinterpret_cast<const pixel_t *>(pSrc8);
-
-    dstPitch /= sizeof(pixel_t);
-    const int srcPitchOrig = srcPitch;
-    srcPitch /= sizeof(pixel_t);
-
-    const int width = rowsize / sizeof(pixel_t);
+template<typename pixel_t, SseModeProcessor processor, SseModeProcessor processor_a, bool aligned, int rows>
+static RG_FORCEINLINE void process_rows_sse(const Byte* pSrc, Byte* pDst, int srcPitch, int dstPitch, int width) {
     const int pixels_at_at_time = 16 / sizeof(pixel_t);
+    const int mod_width = width / pixels_at_at_time * pixels_at_at_time;
 
-    pSrc += srcPitch;
-    pDst += dstPitch;
-    int mod_width = width / pixels_at_at_time * pixels_at_at_time;
-
-    for (int y = 1; y < height - 1; ++y) {
-      pDst[0] = pSrc[0];
+    for (int r = 0; r < rows; ++r)
+      reinterpret_cast<pixel_t*>(pDst + r * dstPitch)[0] = reinterpret_cast<const pixel_t*>(pSrc + r * srcPitch)[0];
 
+    if (width < pixels_at_at_time + 2) {
+      // narrow plane: one partial vector on a staged copy of the rows
+      for (int r = 0; r < rows && width > 2; ++r)
+        process_row_staged<pixel_t>(pDst + r * dstPitch, pSrc + r * srcPitch, srcPitch, width, processor);
+    } else {
       // unaligned first 16 bytes, last pixel overlaps with the next aligned loop
-      __m128i result = processor((uint8_t *)(pSrc + 1), srcPitchOrig);
-      _mm_storeu_si128(reinterpret_cast<__m128i*>(pDst + 1), result);
+      process_column_sse<processor, rows, false>(pSrc + sizeof(pixel_t), pDst + sizeof(pixel_t), srcPitch, dstPitch);
 
-      // aligned
+      // aligned, unless the plane is cropped
       for (int x = pixels_at_at_time; x < mod_width - 1; x += pixels_at_at_time) {
-        __m128i result = processor_a((uint8_t *)(pSrc + x), srcPitchOrig);
-        _mm_store_si128(reinterpret_cast<__m128i*>(pDst + x), result);
+        process_column_sse<processor_a, rows, aligned>(pSrc + x * sizeof(pixel_t), pDst + x * sizeof(pixel_t), srcPitch, dstPitch);
       }
-      
+
       if (mod_width != width) {
-        __m128i result = processor((uint8_t *)(pSrc + width - 1 - pixels_at_at_time), srcPitchOrig);
-        _mm_storeu_si128(reinterpret_cast<__m128i*>(pDst + width - 1 - pixels_at_at_time), result);
+        const int x = width - 1 - pixels_at_at_time;
+        process_column_sse<processor, rows, false>(pSrc + x * sizeof(pixel_t), pDst + x * sizeof(pixel_t), srcPitch, dstPitch);
       }
-      
-      pDst[width - 1] = pSrc[width - 1];
+    }
+
+    for (int r = 0; r < rows; ++r)
+      reinterpret_cast<pixel_t*>(pDst + r * dstPitch)[width - 1] = reinterpret_cast<const pixel_t*>(pSrc + r * srcPitch)[width - 1];
+}
+
+template<typename pixel_t, SseModeProcessor processor, SseModeProcessor processor_a, bool aligned, int rows>
+static void process_plane_sse_impl(IScriptEnvironment* env, const BYTE* pSrc, BYTE* pDst, int rowsize, int height, int srcPitch, int dstPitch) {
+    env->BitBlt(pDst, dstPitch, pSrc, srcPitch, rowsize, 1);
+
+    const int width = rowsize / sizeof(pixel_t);
 
+    pSrc += srcPitch;
+    pDst += dstPitch;
+
+    int y = 1;
+    for (; y + rows <= height - 1; y += rows) {
+      process_rows_sse<pixel_t, processor, processor_a, aligned, rows>(pSrc, pDst, srcPitch, dstPitch, width);
+      pSrc += srcPitch * rows;
+      pDst += dstPitch * rows;
+    }
+    for (; y < height - 1; ++y) {
+      process_rows_sse<pixel_t, processor, processor_a, aligned, 1>(pSrc, pDst, srcPitch, dstPitch, width);
       pSrc += srcPitch;
       pDst += dstPitch;
     }
 
-    env->BitBlt((uint8_t *)(pDst), dstPitch*sizeof(pixel_t), (uint8_t *)(pSrc), srcPitch*sizeof(pixel_t), rowsize, 1);
+    env->BitBlt(pDst, dstPitch, pSrc, srcPitch, rowsize, 1);
 }
 
+// rows > 1 only pays off for the modes that are bound by loads, the sorting modes gain nothing
+template<typename pixel_t, SseModeProcessor processor, SseModeProcessor processor_a, int rows = 1>
+static void process_plane_sse(IScriptEnvironment* env, const BYTE* pSrc8, BYTE* pDst8, int rowsize, int height, int srcPitch, int dstPitch) {
+    // unaligned crop: same loop with unaligned loads and stores
+    if (is_16byte_aligned_plane(pSrc8, srcPitch) && is_16byte_aligned_plane(pDst8, dstPitch))
+        process_plane_sse_impl<pixel_t, processor, processor_a, true, rows>(env, pSrc8, pDst8, rowsize, height, srcPitch, dstPitch);
+    else
+        process_plane_sse_impl<pixel_t, processor, processor, false, rows>(env, pSrc8, pDst8, rowsize, height, srcPitch, dstPitch);
+}
 
-template<typename pixel_t, SseModeProcessor processor, SseModeProcessor processor_a>
-static void process_halfplane_sse(IScriptEnvironment* env, const BYTE* pSrc8, BYTE* pDst8, int rowsize, int height, int srcPitch, int dstPitch) {
+
+template<typename pixel_t, SseModeProcessor processor, SseModeProcessor processor_a, bool aligned>
+static void process_halfplane_sse_impl(IScriptEnvironment* env, const BYTE* pSrc8, BYTE* pDst8, int rowsize, int height, int srcPitch, int dstPitch) {
   pixel_t *pDst = reinterpret_cast<pixel_t *>(pDst8);
   const pixel_t *pSrc = reinterpret_cast<const pixel_t *>(pSrc8);
 
@@ -68,19 +103,24 @@ static void process_halfplane_sse(IScriptEnvironment* env, const BYTE* pSrc8, BY
     for (int y = 1; y < height/2; ++y) {
         pDst[0] = (pSrc[srcPitch] + pSrc[-srcPitch] + (sizeof(pixel_t) == 4 ? 0 : 1)) / 2; // float: no +1 rounding
 
-        // unaligned first 16 bytes, last pixel overlaps with the next aligned loop
-        __m128i result = processor((uint8_t *)(pSrc + 1), srcPitchOrig);
-        _mm_storeu_si128(reinterpret_cast<__m128i*>(pDst + 1), result);
-
-        // aligned
-        for (int x = pixels_at_at_time; x < mod_width - 1; x += pixels_at_at_time) {
-          __m128i result = processor_a((uint8_t *)(pSrc + x), srcPitchOrig);
-          _mm_store_si128(reinterpret_cast<__m128i*>(pDst + x), result);
-        }
-
-        if (mod_width != width) {
-          __m128i result = processor((uint8_t *)(pSrc+width-1-pixels_at_at_time), srcPitchOrig);
-          _mm_storeu_si128(reinterpret_cast<__m128i*>(pDst+width-1-pixels_at_at_time), result);
+        if (width < pixels_at_at_time + 2) {
+          if (width > 2)
+            process_row_staged<pixel_t>((uint8_t *)pDst, (const uint8_t *)pSrc, srcPitchOrig, width, processor);
+        } else {
+          // unaligned first 16 bytes, last pixel overlaps with the next aligned loop
+          __m128i result = processor((uint8_t *)(pSrc + 1), srcPitchOrig);
+          _mm_storeu_si128(reinterpret_cast<__m128i*>(pDst + 1), result);
+
+          // aligned, unless the plane is cropped
+          for (int x = pixels_at_at_time; x < mod_width - 1; x += pixels_at_at_time) {
+            __m128i result = processor_a((uint8_t *)(pSrc + x), srcPitchOrig);
+            simd_store_si128<aligned>((uint8_t *)(pDst + x), result);
+          }
+
+          if (mod_width != width) {
+            __m128i result = processor((uint8_t *)(pSrc+width-1-pixels_at_at_time), srcPitchOrig);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(pDst+width-1-pixels_at_at_time), result);
+          }
         }
 
         pDst[width-1] = (pSrc[width-1 + srcPitch] + pSrc[width-1 - srcPitch] + (sizeof(pixel_t) == 4 ? 0 : 1)) / 2; // float: no +1 rounding
@@ -94,11 +134,23 @@ static void process_halfplane_sse(IScriptEnvironment* env, const BYTE* pSrc8, BY
     }
 }
 
+template<typename pixel_t, SseModeProcessor processor, SseModeProcessor processor_a>
+static void process_halfplane_sse(IScriptEnvironment* env, const BYTE* pSrc8, BYTE* pDst8, int rowsize, int height, int srcPitch, int dstPitch) {
+    // unaligned crop: same loop with unaligned loads and stores
+    if (is_16byte_aligned_plane(pSrc8, srcPitch) && is_16byte_aligned_plane(pDst8, dstPitch))
+        process_halfplane_sse_impl<pixel_t, processor, processor_a, true>(env, pSrc8, pDst8, rowsize, height, srcPitch, dstPitch);
+    else
+        process_halfplane_sse_impl<pixel_t, processor, processor, false>(env, pSrc8, pDst8, rowsize, height, srcPitch, dstPitch);
+}
+
 template<typename pixel_t, SseModeProcessor processor, SseModeProcessor processor_a>
 static void process_even_rows_sse(IScriptEnvironment* env, const BYTE* pSrc, BYTE* pDst, int rowsize, int height, int srcPitch, int dstPitch) {
     env->BitBlt(pDst, dstPitch, pSrc, srcPitch, rowsize, 2); //copy first two lines
 
     process_halfplane_sse<pixel_t, processor, processor_a>(env, pSrc+srcPitch, pDst+dstPitch, rowsize, height, srcPitch, dstPitch);
+
+    if (height & 1) // odd height: the last row is beyond the half plane loop
+      env->BitBlt(pDst+dstPitch*(height-1), dstPitch, pSrc+srcPitch*(height-1), srcPitch, rowsize, 1);
 }
 
 template<typename pixel_t, SseModeProcessor processor, SseModeProcessor processor_a>
@@ -107,6 +159,9 @@ static void process_odd_rows_sse(IScriptEnvironment* env, const BYTE* pSrc, BYTE
 
     process_halfplane_sse<pixel_t, processor, processor_a>(env, pSrc, pDst, rowsize, height, srcPitch, dstPitch);
 
+    if (height & 1) // odd height: the half plane loop stops one row above the bottom border
+      env->BitBlt(pDst+dstPitch*(height-2), dstPitch, pSrc+srcPitch*(height-2), srcPitch, rowsize, 1);
+
     env->BitBlt(pDst+dstPitch*(height-1), dstPitch, pSrc+srcPitch*(height-1), srcPitch, rowsize, 1); //bottom border
 }
 
@@ -175,6 +230,9 @@ static void process_even_rows_c(IScriptEnvironment* env, const BYTE* pSrc, BYTE*
     env->BitBlt(pDst, dstPitch, pSrc, srcPitch, rowsize, 2); //copy first two lines
 
     process_halfplane_c<pixel_t, processor>(env, pSrc+srcPitch, pDst+dstPitch, rowsize, height, srcPitch, dstPitch);
+
+    if (height & 1) // odd height: the last row is beyond the half plane loop
+      env->BitBlt(pDst+dstPitch*(height-1), dstPitch, pSrc+srcPitch*(height-1), srcPitch, rowsize, 1);
 }
 
 template<typename pixel_t, CModeProcessor<pixel_t> processor>
@@ -183,6 +241,9 @@ static void process_odd_rows_c(IScriptEnvironment* env, const BYTE* pSrc, BYTE*
 
     process_halfplane_c<pixel_t, processor>(env, pSrc, pDst, rowsize, height, srcPitch, dstPitch);
 
+    if (height & 1) // odd height: the half plane loop stops one row above the bottom border
+      env->BitBlt(pDst+dstPitch*(height-2), dstPitch, pSrc+srcPitch*(height-2), srcPitch, rowsize, 1);
+
     env->BitBlt(pDst+dstPitch*(height-1), dstPitch, pSrc+srcPitch*(height-1), srcPitch, rowsize, 1); //bottom border
 }
 
@@ -316,208 +377,389 @@ mode 	sharp edges 	corners   thin lines  line ends  thin curves  compression
 PlaneProcessor* sse2_functions[] = {
     doNothing,
     copyPlane,
-    process_plane_sse<uint8_t, rg_mode1_sse<false, SSE2>, rg_mode1_sse<true, SSE2>>,
-    process_plane_sse<uint8_t, rg_mode2_sse<false, SSE2>, rg_mode2_sse<true, SSE2>>,
-    process_plane_sse<uint8_t, rg_mode3_sse<false, SSE2>, rg_mode3_sse<true, SSE2>>,
-    process_plane_sse<uint8_t, rg_mode4_sse<false, SSE2>, rg_mode4_sse<true, SSE2>>,
+    process_plane_sse<uint8_t, rg_mode1_sse<false, SSE2>, rg_mode1_sse<true, SSE2>, RG_BLOCK_ROWS>,
+    process_plane_colsort<ColsortSse8<SSE2>, CS_RANK1_8>,
+    process_plane_sse<uint8_t, rg_mode3_sse<false, SSE2>, rg_mode3_sse<true, SSE2>, RG_BLOCK_ROWS>,
+    process_plane_colsort<ColsortSse8<SSE2>, CS_MEDIAN>,
     process_plane_sse<uint8_t, rg_mode5_sse<false, SSE2>, rg_mode5_sse<true, SSE2>>,
     process_plane_sse<uint8_t, rg_mode6_sse<false, SSE2>, rg_mode6_sse<true, SSE2>>,
     process_plane_sse<uint8_t, rg_mode7_sse<false, SSE2>, rg_mode7_sse<true, SSE2>>,
     process_plane_sse<uint8_t, rg_mode8_sse<false, SSE2>, rg_mode8_sse<true, SSE2>>,
     process_plane_sse<uint8_t, rg_mode9_sse<false, SSE2>, rg_mode9_sse<true, SSE2>>,
     process_plane_sse<uint8_t, rg_mode10_sse<false, SSE2>, rg_mode10_sse<true, SSE2>>,
-    process_plane_sse<uint8_t, rg_mode11_sse<false, SSE2>, rg_mode11_sse<true, SSE2>>,
-    process_plane_sse<uint8_t, rg_mode12_sse<false, SSE2>, rg_mode12_sse<true, SSE2>>,
+    process_plane_sse<uint8_t, rg_mode11_sse<false, SSE2>, rg_mode11_sse<true, SSE2>, RG_BLOCK_ROWS>,
+    process_plane_sse<uint8_t, rg_mode12_sse<false, SSE2>, rg_mode12_sse<true, SSE2>, RG_BLOCK_ROWS>,
     process_even_rows_sse<uint8_t, rg_mode13_and14_sse<false, SSE2>, rg_mode13_and14_sse<true, SSE2>>,
     process_odd_rows_sse<uint8_t, rg_mode13_and14_sse<false, SSE2>, rg_mode13_and14_sse<true, SSE2>>,
     process_even_rows_sse<uint8_t, rg_mode15_and16_sse<false, SSE2>, rg_mode15_and16_sse<true, SSE2>>,
     process_odd_rows_sse<uint8_t, rg_mode15_and16_sse<false, SSE2>, rg_mode15_and16_sse<true, SSE2>>,
-    process_plane_sse<uint8_t, rg_mode17_sse<false, SSE2>, rg_mode17_sse<true, SSE2>>,
+    process_plane_sse<uint8_t, rg_mode17_sse<false, SSE2>, rg_mode17_sse<true, SSE2>, RG_BLOCK_ROWS>,
     process_plane_sse<uint8_t, rg_mode18_sse<false, SSE2>, rg_mode18_sse<true, SSE2>>,
-    process_plane_sse<uint8_t, rg_mode19_sse<false, SSE2>, rg_mode19_sse<true, SSE2>>,
-    process_plane_sse<uint8_t, rg_mode20_sse<false, SSE2>, rg_mode20_sse<true, SSE2>>,
+    process_plane_sse<uint8_t, rg_mode19_sse<false, SSE2>, rg_mode19_sse<true, SSE2>, RG_BLOCK_ROWS>,
+    process_plane_sse<uint8_t, rg_mode20_sse<false, SSE2>, rg_mode20_sse<true, SSE2>, RG_BLOCK_ROWS>,
     process_plane_sse<uint8_t, rg_mode21_sse<false, SSE2>, rg_mode21_sse<true, SSE2>>,
-    process_plane_sse<uint8_t, rg_mode22_sse<false, SSE2>, rg_mode22_sse<true, SSE2>>,
+    process_plane_sse<uint8_t, rg_mode22_sse<false, SSE2>, rg_mode22_sse<true, SSE2>, RG_BLOCK_ROWS>,
     process_plane_sse<uint8_t, rg_mode23_sse<false, SSE2>, rg_mode23_sse<true, SSE2>>,
     process_plane_sse<uint8_t, rg_mode24_sse<false, SSE2>, rg_mode24_sse<true, SSE2>>,
 };
 
+// RgBench: the row blocked modes of sse2_functions with one row per iteration, nullptr for the other modes
+PlaneProcessor* sse2_functions_rows1[] = {
+    nullptr, nullptr,
+    process_plane_sse<uint8_t, rg_mode1_sse<false, SSE2>, rg_mode1_sse<true, SSE2>, 1>,
+    nullptr,
+    process_plane_sse<uint8_t, rg_mode3_sse<false, SSE2>, rg_mode3_sse<true, SSE2>, 1>,
+    nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+    process_plane_sse<uint8_t, rg_mode11_sse<false, SSE2>, rg_mode11_sse<true, SSE2>, 1>,
+    process_plane_sse<uint8_t, rg_mode12_sse<false, SSE2>, rg_mode12_sse<true, SSE2>, 1>,
+    nullptr, nullptr, nullptr, nullptr,
+    process_plane_sse<uint8_t, rg_mode17_sse<false, SSE2>, rg_mode17_sse<true, SSE2>, 1>,
+    nullptr,
+    process_plane_sse<uint8_t, rg_mode19_sse<false, SSE2>, rg_mode19_sse<true, SSE2>, 1>,
+    process_plane_sse<uint8_t, rg_mode20_sse<false, SSE2>, rg_mode20_sse<true, SSE2>, 1>,
+    nullptr,
+    process_plane_sse<uint8_t, rg_mode22_sse<false, SSE2>, rg_mode22_sse<true, SSE2>, 1>,
+    nullptr, nullptr,
+};
+
 PlaneProcessor* sse3_functions[] = {
     doNothing,
     copyPlane,
-    process_plane_sse<uint8_t, rg_mode1_sse<false, SSE3>, rg_mode1_sse<true, SSE3>>,
-    process_plane_sse<uint8_t, rg_mode2_sse<false, SSE3>, rg_mode2_sse<true, SSE3>>,
-    process_plane_sse<uint8_t, rg_mode3_sse<false, SSE3>, rg_mode3_sse<true, SSE3>>,
-    process_plane_sse<uint8_t, rg_mode4_sse<false, SSE3>, rg_mode4_sse<true, SSE3>>,
+    process_plane_sse<uint8_t, rg_mode1_sse<false, SSE3>, rg_mode1_sse<true, SSE3>, RG_BLOCK_ROWS>,
+    process_plane_colsort<ColsortSse8<SSE3>, CS_RANK1_8>,
+    process_plane_sse<uint8_t, rg_mode3_sse<false, SSE3>, rg_mode3_sse<true, SSE3>, RG_BLOCK_ROWS>,
+    process_plane_colsort<ColsortSse8<SSE3>, CS_MEDIAN>,
     process_plane_sse<uint8_t, rg_mode5_sse<false, SSE3>, rg_mode5_sse<true, SSE3>>,
     process_plane_sse<uint8_t, rg_mode6_sse<false, SSE3>, rg_mode6_sse<true, SSE3>>,
     process_plane_sse<uint8_t, rg_mode7_sse<false, SSE3>, rg_mode7_sse<true, SSE3>>,
     process_plane_sse<uint8_t, rg_mode8_sse<false, SSE3>, rg_mode8_sse<true, SSE3>>,
     process_plane_sse<uint8_t, rg_mode9_sse<false, SSE3>, rg_mode9_sse<true, SSE3>>,
     process_plane_sse<uint8_t, rg_mode10_sse<false, SSE3>, rg_mode10_sse<true, SSE3>>,
-    process_plane_sse<uint8_t, rg_mode11_sse<false, SSE3>, rg_mode11_sse<true, SSE3>>,
-    process_plane_sse<uint8_t, rg_mode12_sse<false, SSE3>, rg_mode12_sse<true, SSE3>>,
+    process_plane_sse<uint8_t, rg_mode11_sse<false, SSE3>, rg_mode11_sse<true, SSE3>, RG_BLOCK_ROWS>,
+    process_plane_sse<uint8_t, rg_mode12_sse<false, SSE3>, rg_mode12_sse<true, SSE3>, RG_BLOCK_ROWS>,
     process_even_rows_sse<uint8_t, rg_mode13_and14_sse<false, SSE3>, rg_mode13_and14_sse<true, SSE3>>,
     process_odd_rows_sse<uint8_t, rg_mode13_and14_sse<false, SSE3>, rg_mode13_and14_sse<true, SSE3>>,
     process_even_rows_sse<uint8_t, rg_mode15_and16_sse<false, SSE3>, rg_mode15_and16_sse<true, SSE3>>,
     process_odd_rows_sse<uint8_t, rg_mode15_and16_sse<false, SSE3>, rg_mode15_and16_sse<true, SSE3>>,
-    process_plane_sse<uint8_t, rg_mode17_sse<false, SSE3>, rg_mode17_sse<true, SSE3>>,
+    process_plane_sse<uint8_t, rg_mode17_sse<false, SSE3>, rg_mode17_sse<true, SSE3>, RG_BLOCK_ROWS>,
     process_plane_sse<uint8_t, rg_mode18_sse<false, SSE3>, rg_mode18_sse<true, SSE3>>,
-    process_plane_sse<uint8_t, rg_mode19_sse<false, SSE3>, rg_mode19_sse<true, SSE3>>,
-    process_plane_sse<uint8_t, rg_mode20_sse<false, SSE3>, rg_mode20_sse<true, SSE3>>,
+    process_plane_sse<uint8_t, rg_mode19_sse<false, SSE3>, rg_mode19_sse<true, SSE3>, RG_BLOCK_ROWS>,
+    process_plane_sse<uint8_t, rg_mode20_sse<false, SSE3>, rg_mode20_sse<true, SSE3>, RG_BLOCK_ROWS>,
     process_plane_sse<uint8_t, rg_mode21_sse<false, SSE3>, rg_mode21_sse<true, SSE3>>,
-    process_plane_sse<uint8_t, rg_mode22_sse<false, SSE3>, rg_mode22_sse<true, SSE3>>,
+    process_plane_sse<uint8_t, rg_mode22_sse<false, SSE3>, rg_mode22_sse<true, SSE3>, RG_BLOCK_ROWS>,
     process_plane_sse<uint8_t, rg_mode23_sse<false, SSE3>, rg_mode23_sse<true, SSE3>>,
     process_plane_sse<uint8_t, rg_mode24_sse<false, SSE3>, rg_mode24_sse<true, SSE3>>,
 };
 
+// RgBench: the row blocked modes of sse3_functions with one row per iteration, nullptr for the other modes
+PlaneProcessor* sse3_functions_rows1[] = {
+    nullptr, nullptr,
+    process_plane_sse<uint8_t, rg_mode1_sse<false, SSE3>, rg_mode1_sse<true, SSE3>, 1>,
+    nullptr,
+    process_plane_sse<uint8_t, rg_mode3_sse<false, SSE3>, rg_mode3_sse<true, SSE3>, 1>,
+    nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+    process_plane_sse<uint8_t, rg_mode11_sse<false, SSE3>, rg_mode11_sse<true, SSE3>, 1>,
+    process_plane_sse<uint8_t, rg_mode12_sse<false, SSE3>, rg_mode12_sse<true, SSE3>, 1>,
+    nullptr, nullptr, nullptr, nullptr,
+    process_plane_sse<uint8_t, rg_mode17_sse<false, SSE3>, rg_mode17_sse<true, SSE3>, 1>,
+    nullptr,
+    process_plane_sse<uint8_t, rg_mode19_sse<false, SSE3>, rg_mode19_sse<true, SSE3>, 1>,
+    process_plane_sse<uint8_t, rg_mode20_sse<false, SSE3>, rg_mode20_sse<true, SSE3>, 1>,
+    nullptr,
+    process_plane_sse<uint8_t, rg_mode22_sse<false, SSE3>, rg_mode22_sse<true, SSE3>, 1>,
+    nullptr, nullptr,
+};
+
+PlaneProcessor* ssse3_functions[] = {
+    doNothing,
+    copyPlane,
+    process_plane_sse<uint8_t, rg_mode1_sse<false, SSSE3>, rg_mode1_sse<true, SSSE3>, RG_BLOCK_ROWS>,
+    process_plane_colsort<ColsortSse8<SSSE3>, CS_RANK1_8>,
+    process_plane_sse<uint8_t, rg_mode3_sse<false, SSSE3>, rg_mode3_sse<true, SSSE3>, RG_BLOCK_ROWS>,
+    process_plane_colsort<ColsortSse8<SSSE3>, CS_MEDIAN>,
+    process_plane_sse<uint8_t, rg_mode5_sse<false, SSSE3>, rg_mode5_sse<true, SSSE3>>,
+    process_plane_sse<uint8_t, rg_mode6_sse<false, SSSE3>, rg_mode6_sse<true, SSSE3>>,
+    process_plane_sse<uint8_t, rg_mode7_sse<false, SSSE3>, rg_mode7_sse<true, SSSE3>>,
+    process_plane_sse<uint8_t, rg_mode8_sse<false, SSSE3>, rg_mode8_sse<true, SSSE3>>,
+    process_plane_sse<uint8_t, rg_mode9_sse<false, SSSE3>, rg_mode9_sse<true, SSSE3>>,
+    process_plane_sse<uint8_t, rg_mode10_sse<false, SSSE3>, rg_mode10_sse<true, SSSE3>>,
+    process_plane_sse<uint8_t, rg_mode11_sse<false, SSSE3>, rg_mode11_sse<true, SSSE3>, RG_BLOCK_ROWS>,
+    process_plane_sse<uint8_t, rg_mode12_sse<false, SSSE3>, rg_mode12_sse<true, SSSE3>, RG_BLOCK_ROWS>,
+    process_even_rows_sse<uint8_t, rg_mode13_and14_sse<false, SSSE3>, rg_mode13_and14_sse<true, SSSE3>>,
+    process_odd_rows_sse<uint8_t, rg_mode13_and14_sse<false, SSSE3>, rg_mode13_and14_sse<true, SSSE3>>,
+    process_even_rows_sse<uint8_t, rg_mode15_and16_sse<false, SSSE3>, rg_mode15_and16_sse<true, SSSE3>>,
+    process_odd_rows_sse<uint8_t, rg_mode15_and16_sse<false, SSSE3>, rg_mode15_and16_sse<true, SSSE3>>,
+    process_plane_sse<uint8_t, rg_mode17_sse<false, SSSE3>, rg_mode17_sse<true, SSSE3>, RG_BLOCK_ROWS>,
+    process_plane_sse<uint8_t, rg_mode18_sse<false, SSSE3>, rg_mode18_sse<true, SSSE3>>,
+    process_plane_sse<uint8_t, rg_mode19_sse<false, SSSE3>, rg_mode19_sse<true, SSSE3>, RG_BLOCK_ROWS>,
+    process_plane_sse<uint8_t, rg_mode20_sse<false, SSSE3>, rg_mode20_sse<true, SSSE3>, RG_BLOCK_ROWS>,
+    process_plane_sse<uint8_t, rg_mode21_sse<false, SSSE3>, rg_mode21_sse<true, SSSE3>>,
+    process_plane_sse<uint8_t, rg_mode22_sse<false, SSSE3>, rg_mode22_sse<true, SSSE3>, RG_BLOCK_ROWS>,
+    process_plane_sse<uint8_t, rg_mode23_sse<false, SSSE3>, rg_mode23_sse<true, SSSE3>>,
+    process_plane_sse<uint8_t, rg_mode24_sse<false, SSSE3>, rg_mode24_sse<true, SSSE3>>,
+};
+
+// RgBench: the row blocked modes of ssse3_functions with one row per iteration, nullptr for the other modes
+PlaneProcessor* ssse3_functions_rows1[] = {
+    nullptr, nullptr,
+    process_plane_sse<uint8_t, rg_mode1_sse<false, SSSE3>, rg_mode1_sse<true, SSSE3>, 1>,
+    nullptr,
+    process_plane_sse<uint8_t, rg_mode3_sse<false, SSSE3>, rg_mode3_sse<true, SSSE3>, 1>,
+    nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+    process_plane_sse<uint8_t, rg_mode11_sse<false, SSSE3>, rg_mode11_sse<true, SSSE3>, 1>,
+    process_plane_sse<uint8_t, rg_mode12_sse<false, SSSE3>, rg_mode12_sse<true, SSSE3>, 1>,
+    nullptr, nullptr, nullptr, nullptr,
+    process_plane_sse<uint8_t, rg_mode17_sse<false, SSSE3>, rg_mode17_sse<true, SSSE3>, 1>,
+    nullptr,
+    process_plane_sse<uint8_t, rg_mode19_sse<false, SSSE3>, rg_mode19_sse<true, SSSE3>, 1>,
+    process_plane_sse<uint8_t, rg_mode20_sse<false, SSSE3>, rg_mode20_sse<true, SSSE3>, 1>,
+    nullptr,
+    process_plane_sse<uint8_t, rg_mode22_sse<false, SSSE3>, rg_mode22_sse<true, SSSE3>, 1>,
+    nullptr, nullptr,
+};
+
 PlaneProcessor* sse4_functions_16_10[] = {
   doNothing,
   copyPlane,
-  process_plane_sse<uint16_t, rg_mode1_sse_16<false>, rg_mode1_sse_16<true>>,
-  process_plane_sse<uint16_t, rg_mode2_sse_16<false>, rg_mode2_sse_16<true>>,
-  process_plane_sse<uint16_t, rg_mode3_sse_16<false>, rg_mode3_sse_16<true>>,
-  process_plane_sse<uint16_t, rg_mode4_sse_16<false>, rg_mode4_sse_16<true>>,
+  process_plane_sse<uint16_t, rg_mode1_sse_16<false>, rg_mode1_sse_16<true>, RG_BLOCK_ROWS>,
+  process_plane_colsort<ColsortSse16, CS_RANK1_8>,
+  process_plane_sse<uint16_t, rg_mode3_sse_16<false>, rg_mode3_sse_16<true>, RG_BLOCK_ROWS>,
+  process_plane_colsort<ColsortSse16, CS_MEDIAN>,
   process_plane_sse<uint16_t, rg_mode5_sse_16<false>, rg_mode5_sse_16<true>>,
   process_plane_sse<uint16_t, rg_mode6_sse_16<10, false>, rg_mode6_sse_16<10, false>>,
   process_plane_sse<uint16_t, rg_mode7_sse_16<false>, rg_mode7_sse_16<true>>,
   process_plane_sse<uint16_t, rg_mode8_sse_16<10, false>, rg_mode8_sse_16<10, true>>,
   process_plane_sse<uint16_t, rg_mode9_sse_16<false>, rg_mode9_sse_16<true>>,
   process_plane_sse<uint16_t, rg_mode10_sse_16<false>, rg_mode10_sse_16<true>>,
-  process_plane_sse<uint16_t, rg_mode11_sse_16<false>, rg_mode11_sse_16<true>>,
-  process_plane_sse<uint16_t, rg_mode12_sse_16<false>, rg_mode12_sse_16<true>>,
+  process_plane_sse<uint16_t, rg_mode11_sse_16<false>, rg_mode11_sse_16<true>, RG_BLOCK_ROWS>,
+  process_plane_sse<uint16_t, rg_mode12_sse_16<false>, rg_mode12_sse_16<true>, RG_BLOCK_ROWS>,
   process_even_rows_sse<uint16_t, rg_mode13_and14_sse_16<false>, rg_mode13_and14_sse_16<true>>,
   process_odd_rows_sse<uint16_t, rg_mode13_and14_sse_16<false>, rg_mode13_and14_sse_16<true>>,
   process_even_rows_sse<uint16_t, rg_mode15_and16_sse_16<false>, rg_mode15_and16_sse_16<true>>,
   process_odd_rows_sse<uint16_t, rg_mode15_and16_sse_16<false>, rg_mode15_and16_sse_16<true>>,
-  process_plane_sse<uint16_t, rg_mode17_sse_16<false>, rg_mode17_sse_16<true>>,
+  process_plane_sse<uint16_t, rg_mode17_sse_16<false>, rg_mode17_sse_16<true>, RG_BLOCK_ROWS>,
   process_plane_sse<uint16_t, rg_mode18_sse_16<false>, rg_mode18_sse_16<true>>,
-  process_plane_sse<uint16_t, rg_mode19_sse_16<false>, rg_mode19_sse_16<true>>,
-  process_plane_sse<uint16_t, rg_mode20_sse_16<false>, rg_mode20_sse_16<true>>,
+  process_plane_sse<uint16_t, rg_mode19_sse_16<false>, rg_mode19_sse_16<true>, RG_BLOCK_ROWS>,
+  process_plane_sse<uint16_t, rg_mode20_sse_16<false>, rg_mode20_sse_16<true>, RG_BLOCK_ROWS>,
   process_plane_sse<uint16_t, rg_mode21_sse_16<false>, rg_mode21_sse_16<true>>,
-  process_plane_sse<uint16_t, rg_mode22_sse_16<false>, rg_mode22_sse_16<true>>,
+  process_plane_sse<uint16_t, rg_mode22_sse_16<false>, rg_mode22_sse_16<true>, RG_BLOCK_ROWS>,
   process_plane_sse<uint16_t, rg_mode23_sse_16<false>, rg_mode23_sse_16<true>>,
   process_plane_sse<uint16_t, rg_mode24_sse_16<false>, rg_mode24_sse_16<true>>,
 };
 
+// RgBench: the row blocked modes of sse4_functions_16_10 with one row per iteration, nullptr for the other modes
+PlaneProcessor* sse4_functions_16_10_rows1[] = {
+    nullptr, nullptr,
+  process_plane_sse<uint16_t, rg_mode1_sse_16<false>, rg_mode1_sse_16<true>, 1>,
+    nullptr,
+  process_plane_sse<uint16_t, rg_mode3_sse_16<false>, rg_mode3_sse_16<true>, 1>,
+    nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+  process_plane_sse<uint16_t, rg_mode11_sse_16<false>, rg_mode11_sse_16<true>, 1>,
+  process_plane_sse<uint16_t, rg_mode12_sse_16<false>, rg_mode12_sse_16<true>, 1>,
+    nullptr, nullptr, nullptr, nullptr,
+  process_plane_sse<uint16_t, rg_mode17_sse_16<false>, rg_mode17_sse_16<true>, 1>,
+    nullptr,
+  process_plane_sse<uint16_t, rg_mode19_sse_16<false>, rg_mode19_sse_16<true>, 1>,
+  process_plane_sse<uint16_t, rg_mode20_sse_16<false>, rg_mode20_sse_16<true>, 1>,
+    nullptr,
+  process_plane_sse<uint16_t, rg_mode22_sse_16<false>, rg_mode22_sse_16<true>, 1>,
+    nullptr, nullptr,
+};
+
 PlaneProcessor* sse4_functions_16_12[] = {
   doNothing,
   copyPlane,
-  process_plane_sse<uint16_t, rg_mode1_sse_16<false>, rg_mode1_sse_16<true>>,
-  process_plane_sse<uint16_t, rg_mode2_sse_16<false>, rg_mode2_sse_16<true>>,
-  process_plane_sse<uint16_t, rg_mode3_sse_16<false>, rg_mode3_sse_16<true>>,
-  process_plane_sse<uint16_t, rg_mode4_sse_16<false>, rg_mode4_sse_16<true>>,
+  process_plane_sse<uint16_t, rg_mode1_sse_16<false>, rg_mode1_sse_16<true>, RG_BLOCK_ROWS>,
+  process_plane_colsort<ColsortSse16, CS_RANK1_8>,
+  process_plane_sse<uint16_t, rg_mode3_sse_16<false>, rg_mode3_sse_16<true>, RG_BLOCK_ROWS>,
+  process_plane_colsort<ColsortSse16, CS_MEDIAN>,
   process_plane_sse<uint16_t, rg_mode5_sse_16<false>, rg_mode5_sse_16<true>>,
   process_plane_sse<uint16_t, rg_mode6_sse_16<12, false>, rg_mode6_sse_16<12, false>>,
   process_plane_sse<uint16_t, rg_mode7_sse_16<false>, rg_mode7_sse_16<true>>,
   process_plane_sse<uint16_t, rg_mode8_sse_16<12, false>, rg_mode8_sse_16<12, true>>,
   process_plane_sse<uint16_t, rg_mode9_sse_16<false>, rg_mode9_sse_16<true>>,
   process_plane_sse<uint16_t, rg_mode10_sse_16<false>, rg_mode10_sse_16<true>>,
-  process_plane_sse<uint16_t, rg_mode11_sse_16<false>, rg_mode11_sse_16<true>>,
-  process_plane_sse<uint16_t, rg_mode12_sse_16<false>, rg_mode12_sse_16<true>>,
+  process_plane_sse<uint16_t, rg_mode11_sse_16<false>, rg_mode11_sse_16<true>, RG_BLOCK_ROWS>,
+  process_plane_sse<uint16_t, rg_mode12_sse_16<false>, rg_mode12_sse_16<true>, RG_BLOCK_ROWS>,
   process_even_rows_sse<uint16_t, rg_mode13_and14_sse_16<false>, rg_mode13_and14_sse_16<true>>,
   process_odd_rows_sse<uint16_t, rg_mode13_and14_sse_16<false>, rg_mode13_and14_sse_16<true>>,
   process_even_rows_sse<uint16_t, rg_mode15_and16_sse_16<false>, rg_mode15_and16_sse_16<true>>,
   process_odd_rows_sse<uint16_t, rg_mode15_and16_sse_16<false>, rg_mode15_and16_sse_16<true>>,
-  process_plane_sse<uint16_t, rg_mode17_sse_16<false>, rg_mode17_sse_16<true>>,
+  process_plane_sse<uint16_t, rg_mode17_sse_16<false>, rg_mode17_sse_16<true>, RG_BLOCK_ROWS>,
   process_plane_sse<uint16_t, rg_mode18_sse_16<false>, rg_mode18_sse_16<true>>,
-  process_plane_sse<uint16_t, rg_mode19_sse_16<false>, rg_mode19_sse_16<true>>,
-  process_plane_sse<uint16_t, rg_mode20_sse_16<false>, rg_mode20_sse_16<true>>,
+  process_plane_sse<uint16_t, rg_mode19_sse_16<false>, rg_mode19_sse_16<true>, RG_BLOCK_ROWS>,
+  process_plane_sse<uint16_t, rg_mode20_sse_16<false>, rg_mode20_sse_16<true>, RG_BLOCK_ROWS>,
   process_plane_sse<uint16_t, rg_mode21_sse_16<false>, rg_mode21_sse_16<true>>,
-  process_plane_sse<uint16_t, rg_mode22_sse_16<false>, rg_mode22_sse_16<true>>,
+  process_plane_sse<uint16_t, rg_mode22_sse_16<false>, rg_mode22_sse_16<true>, RG_BLOCK_ROWS>,
   process_plane_sse<uint16_t, rg_mode23_sse_16<false>, rg_mode23_sse_16<true>>,
   process_plane_sse<uint16_t, rg_mode24_sse_16<false>, rg_mode24_sse_16<true>>,
 };
 
+// RgBench: the row blocked modes of sse4_functions_16_12 with one row per iteration, nullptr for the other modes
+PlaneProcessor* sse4_functions_16_12_rows1[] = {
+    nullptr, nullptr,
+  process_plane_sse<uint16_t, rg_mode1_sse_16<false>, rg_mode1_sse_16<true>, 1>,
+    nullptr,
+  process_plane_sse<uint16_t, rg_mode3_sse_16<false>, rg_mode3_sse_16<true>, 1>,
+    nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+  process_plane_sse<uint16_t, rg_mode11_sse_16<false>, rg_mode11_sse_16<true>, 1>,
+  process_plane_sse<uint16_t, rg_mode12_sse_16<false>, rg_mode12_sse_16<true>, 1>,
+    nullptr, nullptr, nullptr, nullptr,
+  process_plane_sse<uint16_t, rg_mode17_sse_16<false>, rg_mode17_sse_16<true>, 1>,
+    nullptr,
+  process_plane_sse<uint16_t, rg_mode19_sse_16<false>, rg_mode19_sse_16<true>, 1>,
+  process_plane_sse<uint16_t, rg_mode20_sse_16<false>, rg_mode20_sse_16<true>, 1>,
+    nullptr,
+  process_plane_sse<uint16_t, rg_mode22_sse_16<false>, rg_mode22_sse_16<true>, 1>,
+    nullptr, nullptr,
+};
+
 PlaneProcessor* sse4_functions_16_14[] = {
   doNothing,
   copyPlane,
-  process_plane_sse<uint16_t, rg_mode1_sse_16<false>, rg_mode1_sse_16<true>>,
-  process_plane_sse<uint16_t, rg_mode2_sse_16<false>, rg_mode2_sse_16<true>>,
-  process_plane_sse<uint16_t, rg_mode3_sse_16<false>, rg_mode3_sse_16<true>>,
-  process_plane_sse<uint16_t, rg_mode4_sse_16<false>, rg_mode4_sse_16<true>>,
+  process_plane_sse<uint16_t, rg_mode1_sse_16<false>, rg_mode1_sse_16<true>, RG_BLOCK_ROWS>,
+  process_plane_colsort<ColsortSse16, CS_RANK1_8>,
+  process_plane_sse<uint16_t, rg_mode3_sse_16<false>, rg_mode3_sse_16<true>, RG_BLOCK_ROWS>,
+  process_plane_colsort<ColsortSse16, CS_MEDIAN>,
   process_plane_sse<uint16_t, rg_mode5_sse_16<false>, rg_mode5_sse_16<true>>,
   process_plane_sse<uint16_t, rg_mode6_sse_16<14, false>, rg_mode6_sse_16<14, true>>,
   process_plane_sse<uint16_t, rg_mode7_sse_16<false>, rg_mode7_sse_16<true>>,
   process_plane_sse<uint16_t, rg_mode8_sse_16<14, false>, rg_mode8_sse_16<14, true>>,
   process_plane_sse<uint16_t, rg_mode9_sse_16<false>, rg_mode9_sse_16<true>>,
   process_plane_sse<uint16_t, rg_mode10_sse_16<false>, rg_mode10_sse_16<true>>,
-  process_plane_sse<uint16_t, rg_mode11_sse_16<false>, rg_mode11_sse_16<true>>,
-  process_plane_sse<uint16_t, rg_mode12_sse_16<false>, rg_mode12_sse_16<true>>,
+  process_plane_sse<uint16_t, rg_mode11_sse_16<false>, rg_mode11_sse_16<true>, RG_BLOCK_ROWS>,
+  process_plane_sse<uint16_t, rg_mode12_sse_16<false>, rg_mode12_sse_16<true>, RG_BLOCK_ROWS>,
   process_even_rows_sse<uint16_t, rg_mode13_and14_sse_16<false>, rg_mode13_and14_sse_16<true>>,
   process_odd_rows_sse<uint16_t, rg_mode13_and14_sse_16<false>, rg_mode13_and14_sse_16<true>>,
   process_even_rows_sse<uint16_t, rg_mode15_and16_sse_16<false>, rg_mode15_and16_sse_16<true>>,
   process_odd_rows_sse<uint16_t, rg_mode15_and16_sse_16<false>, rg_mode15_and16_sse_16<true>>,
-  process_plane_sse<uint16_t, rg_mode17_sse_16<false>, rg_mode17_sse_16<true>>,
+  process_plane_sse<uint16_t, rg_mode17_sse_16<false>, rg_mode17_sse_16<true>, RG_BLOCK_ROWS>,
   process_plane_sse<uint16_t, rg_mode18_sse_16<false>, rg_mode18_sse_16<true>>,
-  process_plane_sse<uint16_t, rg_mode19_sse_16<false>, rg_mode19_sse_16<true>>,
-  process_plane_sse<uint16_t, rg_mode20_sse_16<false>, rg_mode20_sse_16<true>>,
+  process_plane_sse<uint16_t, rg_mode19_sse_16<false>, rg_mode19_sse_16<true>, RG_BLOCK_ROWS>,
+  process_plane_sse<uint16_t, rg_mode20_sse_16<false>, rg_mode20_sse_16<true>, RG_BLOCK_ROWS>,
   process_plane_sse<uint16_t, rg_mode21_sse_16<false>, rg_mode21_sse_16<true>>,
-  process_plane_sse<uint16_t, rg_mode22_sse_16<false>, rg_mode22_sse_16<true>>,
+  process_plane_sse<uint16_t, rg_mode22_sse_16<false>, rg_mode22_sse_16<true>, RG_BLOCK_ROWS>,
   process_plane_sse<uint16_t, rg_mode23_sse_16<false>, rg_mode23_sse_16<true>>,
   process_plane_sse<uint16_t, rg_mode24_sse_16<false>, rg_mode24_sse_16<true>>,
 };
 
+// RgBench: the row blocked modes of sse4_functions_16_14 with one row per iteration, nullptr for the other modes
+PlaneProcessor* sse4_functions_16_14_rows1[] = {
+    nullptr, nullptr,
+  process_plane_sse<uint16_t, rg_mode1_sse_16<false>, rg_mode1_sse_16<true>, 1>,
+    nullptr,
+  process_plane_sse<uint16_t, rg_mode3_sse_16<false>, rg_mode3_sse_16<true>, 1>,
+    nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+  process_plane_sse<uint16_t, rg_mode11_sse_16<false>, rg_mode11_sse_16<true>, 1>,
+  process_plane_sse<uint16_t, rg_mode12_sse_16<false>, rg_mode12_sse_16<true>, 1>,
+    nullptr, nullptr, nullptr, nullptr,
+  process_plane_sse<uint16_t, rg_mode17_sse_16<false>, rg_mode17_sse_16<true>, 1>,
+    nullptr,
+  process_plane_sse<uint16_t, rg_mode19_sse_16<false>, rg_mode19_sse_16<true>, 1>,
+  process_plane_sse<uint16_t, rg_mode20_sse_16<false>, rg_mode20_sse_16<true>, 1>,
+    nullptr,
+  process_plane_sse<uint16_t, rg_mode22_sse_16<false>, rg_mode22_sse_16<true>, 1>,
+    nullptr, nullptr,
+};
+
 PlaneProcessor* sse4_functions_16_16[] = {
   doNothing,
   copyPlane,
-  process_plane_sse<uint16_t, rg_mode1_sse_16<false>, rg_mode1_sse_16<true>>,
-  process_plane_sse<uint16_t, rg_mode2_sse_16<false>, rg_mode2_sse_16<true>>,
-  process_plane_sse<uint16_t, rg_mode3_sse_16<false>, rg_mode3_sse_16<true>>,
-  process_plane_sse<uint16_t, rg_mode4_sse_16<false>, rg_mode4_sse_16<true>>,
+  process_plane_sse<uint16_t, rg_mode1_sse_16<false>, rg_mode1_sse_16<true>, RG_BLOCK_ROWS>,
+  process_plane_colsort<ColsortSse16, CS_RANK1_8>,
+  process_plane_sse<uint16_t, rg_mode3_sse_16<false>, rg_mode3_sse_16<true>, RG_BLOCK_ROWS>,
+  process_plane_colsort<ColsortSse16, CS_MEDIAN>,
   process_plane_sse<uint16_t, rg_mode5_sse_16<false>, rg_mode5_sse_16<true>>,
   process_plane_sse<uint16_t, rg_mode6_sse_16<16, false>, rg_mode6_sse_16<16, true>>,
   process_plane_sse<uint16_t, rg_mode7_sse_16<false>, rg_mode7_sse_16<true>>,
   process_plane_sse<uint16_t, rg_mode8_sse_16<16, false>, rg_mode8_sse_16<16, true>>,
   process_plane_sse<uint16_t, rg_mode9_sse_16<false>, rg_mode9_sse_16<true>>,
   process_plane_sse<uint16_t, rg_mode10_sse_16<false>, rg_mode10_sse_16<true>>,
-  process_plane_sse<uint16_t, rg_mode11_sse_16<false>, rg_mode11_sse_16<true>>,
-  process_plane_sse<uint16_t, rg_mode12_sse_16<false>, rg_mode12_sse_16<true>>,
+  process_plane_sse<uint16_t, rg_mode11_sse_16<false>, rg_mode11_sse_16<true>, RG_BLOCK_ROWS>,
+  process_plane_sse<uint16_t, rg_mode12_sse_16<false>, rg_mode12_sse_16<true>, RG_BLOCK_ROWS>,
   process_even_rows_sse<uint16_t, rg_mode13_and14_sse_16<false>, rg_mode13_and14_sse_16<true>>,
   process_odd_rows_sse<uint16_t, rg_mode13_and14_sse_16<false>, rg_mode13_and14_sse_16<true>>,
   process_even_rows_sse<uint16_t, rg_mode15_and16_sse_16<false>, rg_mode15_and16_sse_16<true>>,
   process_odd_rows_sse<uint16_t, rg_mode15_and16_sse_16<false>, rg_mode15_and16_sse_16<true>>,
-  process_plane_sse<uint16_t, rg_mode17_sse_16<false>, rg_mode17_sse_16<true>>,
+  process_plane_sse<uint16_t, rg_mode17_sse_16<false>, rg_mode17_sse_16<true>, RG_BLOCK_ROWS>,
   process_plane_sse<uint16_t, rg_mode18_sse_16<false>, rg_mode18_sse_16<true>>,
-  process_plane_sse<uint16_t, rg_mode19_sse_16<false>, rg_mode19_sse_16<true>>,
-  process_plane_sse<uint16_t, rg_mode20_sse_16<false>, rg_mode20_sse_16<true>>,
+  process_plane_sse<uint16_t, rg_mode19_sse_16<false>, rg_mode19_sse_16<true>, RG_BLOCK_ROWS>,
+  process_plane_sse<uint16_t, rg_mode20_sse_16<false>, rg_mode20_sse_16<true>, RG_BLOCK_ROWS>,
   process_plane_sse<uint16_t, rg_mode21_sse_16<false>, rg_mode21_sse_16<true>>,
-  process_plane_sse<uint16_t, rg_mode22_sse_16<false>, rg_mode22_sse_16<true>>,
+  process_plane_sse<uint16_t, rg_mode22_sse_16<false>, rg_mode22_sse_16<true>, RG_BLOCK_ROWS>,
   process_plane_sse<uint16_t, rg_mode23_sse_16<false>, rg_mode23_sse_16<true>>,
   process_plane_sse<uint16_t, rg_mode24_sse_16<false>, rg_mode24_sse_16<true>>,
 };
 
+// RgBench: the row blocked modes of sse4_functions_16_16 with one row per iteration, nullptr for the other modes
+PlaneProcessor* sse4_functions_16_16_rows1[] = {
+    nullptr, nullptr,
+  process_plane_sse<uint16_t, rg_mode1_sse_16<false>, rg_mode1_sse_16<true>, 1>,
+    nullptr,
+  process_plane_sse<uint16_t, rg_mode3_sse_16<false>, rg_mode3_sse_16<true>, 1>,
+    nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+  process_plane_sse<uint16_t, rg_mode11_sse_16<false>, rg_mode11_sse_16<true>, 1>,
+  process_plane_sse<uint16_t, rg_mode12_sse_16<false>, rg_mode12_sse_16<true>, 1>,
+    nullptr, nullptr, nullptr, nullptr,
+  process_plane_sse<uint16_t, rg_mode17_sse_16<false>, rg_mode17_sse_16<true>, 1>,
+    nullptr,
+  process_plane_sse<uint16_t, rg_mode19_sse_16<false>, rg_mode19_sse_16<true>, 1>,
+  process_plane_sse<uint16_t, rg_mode20_sse_16<false>, rg_mode20_sse_16<true>, 1>,
+    nullptr,
+  process_plane_sse<uint16_t, rg_mode22_sse_16<false>, rg_mode22_sse_16<true>, 1>,
+    nullptr, nullptr,
+};
+
 
 
 PlaneProcessor* sse4_functions_32[] = {
   doNothing,
   copyPlane,
-  process_plane_sse<float, rg_mode1_sse_32<false>, rg_mode1_sse_32<true>>,
-  process_plane_sse<float, rg_mode2_sse_32<false>, rg_mode2_sse_32<true>>,
-  process_plane_sse<float, rg_mode3_sse_32<false>, rg_mode3_sse_32<true>>,
-  process_plane_sse<float, rg_mode4_sse_32<false>, rg_mode4_sse_32<true>>,
+  process_plane_sse<float, rg_mode1_sse_32<false>, rg_mode1_sse_32<true>, RG_BLOCK_ROWS>,
+  process_plane_colsort<ColsortSse32, CS_RANK1_8>,
+  process_plane_sse<float, rg_mode3_sse_32<false>, rg_mode3_sse_32<true>, RG_BLOCK_ROWS>,
+  process_plane_colsort<ColsortSse32, CS_MEDIAN>,
   process_plane_sse<float, rg_mode5_sse_32<false>, rg_mode5_sse_32<true>>,
   process_plane_sse<float, rg_mode6_sse_32<false>, rg_mode6_sse_32<true>>,
   process_plane_sse<float, rg_mode7_sse_32<false>, rg_mode7_sse_32<true>>,
   process_plane_sse<float, rg_mode8_sse_32<false>, rg_mode8_sse_32<true>>,
   process_plane_sse<float, rg_mode9_sse_32<false>, rg_mode9_sse_32<true>>,
   process_plane_sse<float, rg_mode10_sse_32<false>, rg_mode10_sse_32<true>>,
-  process_plane_sse<float, rg_mode11_sse_32<false>, rg_mode11_sse_32<true>>,
-  process_plane_sse<float, rg_mode12_sse_32<false>, rg_mode12_sse_32<true>>,
+  process_plane_sse<float, rg_mode11_sse_32<false>, rg_mode11_sse_32<true>, RG_BLOCK_ROWS>,
+  process_plane_sse<float, rg_mode12_sse_32<false>, rg_mode12_sse_32<true>, RG_BLOCK_ROWS>,
   process_even_rows_sse<float, rg_mode13_and14_sse_32<false>, rg_mode13_and14_sse_32<true>>,
   process_odd_rows_sse<float, rg_mode13_and14_sse_32<false>, rg_mode13_and14_sse_32<true>>,
   process_even_rows_sse<float, rg_mode15_and16_sse_32<false>, rg_mode15_and16_sse_32<true>>,
   process_odd_rows_sse<float, rg_mode15_and16_sse_32<false>, rg_mode15_and16_sse_32<true>>,
-  process_plane_sse<float, rg_mode17_sse_32<false>, rg_mode17_sse_32<true>>,
+  process_plane_sse<float, rg_mode17_sse_32<false>, rg_mode17_sse_32<true>, RG_BLOCK_ROWS>,
   process_plane_sse<float, rg_mode18_sse_32<false>, rg_mode18_sse_32<true>>,
-  process_plane_sse<float, rg_mode19_sse_32<false>, rg_mode19_sse_32<true>>,
-  process_plane_sse<float, rg_mode20_sse_32<false>, rg_mode20_sse_32<true>>,
+  process_plane_sse<float, rg_mode19_sse_32<false>, rg_mode19_sse_32<true>, RG_BLOCK_ROWS>,
+  process_plane_sse<float, rg_mode20_sse_32<false>, rg_mode20_sse_32<true>, RG_BLOCK_ROWS>,
   process_plane_sse<float, rg_mode21_sse_32<false>, rg_mode21_sse_32<true>>,
-  process_plane_sse<float, rg_mode22_sse_32<false>, rg_mode22_sse_32<true>>,
+  process_plane_sse<float, rg_mode22_sse_32<false>, rg_mode22_sse_32<true>, RG_BLOCK_ROWS>,
   process_plane_sse<float, rg_mode23_sse_32<false>, rg_mode23_sse_32<true>>,
   process_plane_sse<float, rg_mode24_sse_32<false>, rg_mode24_sse_32<true>>,
 };
 
+// RgBench: the row blocked modes of sse4_functions_32 with one row per iteration, nullptr for the other modes
+PlaneProcessor* sse4_functions_32_rows1[] = {
+    nullptr, nullptr,
+  process_plane_sse<float, rg_mode1_sse_32<false>, rg_mode1_sse_32<true>, 1>,
+    nullptr,
+  process_plane_sse<float, rg_mode3_sse_32<false>, rg_mode3_sse_32<true>, 1>,
+    nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+  process_plane_sse<float, rg_mode11_sse_32<false>, rg_mode11_sse_32<true>, 1>,
+  process_plane_sse<float, rg_mode12_sse_32<false>, rg_mode12_sse_32<true>, 1>,
+    nullptr, nullptr, nullptr, nullptr,
+  process_plane_sse<float, rg_mode17_sse_32<false>, rg_mode17_sse_32<true>, 1>,
+    nullptr,
+  process_plane_sse<float, rg_mode19_sse_32<false>, rg_mode19_sse_32<true>, 1>,
+  process_plane_sse<float, rg_mode20_sse_32<false>, rg_mode20_sse_32<true>, 1>,
+    nullptr,
+  process_plane_sse<float, rg_mode22_sse_32<false>, rg_mode22_sse_32<true>, 1>,
+    nullptr, nullptr,
+};
+
 
 PlaneProcessor* c_functions[] = {
     doNothing,
@@ -700,54 +942,50 @@ extern PlaneProcessor* avx2_functions_16_12[];
 extern PlaneProcessor* avx2_functions_16_14[];
 extern PlaneProcessor* avx2_functions_16_16[];
 extern PlaneProcessor* avx2_functions_32[];
-
-RemoveGrain::RemoveGrain(PClip child, int mode, int modeU, int modeV, bool skip_cs_check, bool use_avx2, IScriptEnvironment* env)
-    : GenericVideoFilter(child), mode_(mode), modeU_(modeU), modeV_(modeV), functions(nullptr) {
-    if (!(vi.IsPlanar() || skip_cs_check)) {
-        env->ThrowError("RemoveGrain works only with planar colorspaces");
-    }
-
-    if (mode <= UNDEFINED_MODE || mode_ > 24 || modeU_ > 24 || modeV_ > 24) {
-        env->ThrowError("RemoveGrain mode should be between -1 and 24!");
-    }
-
-    bool isPlanarRGB = vi.IsPlanarRGB() || vi.IsPlanarRGBA();
-    if (isPlanarRGB && ((modeU_ > UNDEFINED_MODE) || (modeV_ > UNDEFINED_MODE))) {
-      env->ThrowError("RemoveGrain: cannot specify U or V mode for planar RGB!");
-    }
-
-    //now change undefined mode value and EVERYTHING WILL BREAK
-    if (modeU_ <= UNDEFINED_MODE) { 
-        modeU_ = mode_;
-    }
-    if (modeV_ <= UNDEFINED_MODE) {
-        modeV_ = modeU_;
-    }
-
-    pixelsize = vi.ComponentSize();
-    bits_per_pixel = vi.BitsPerComponent();
-
-    bool avx2 = (env->GetCPUFlags() & CPUF_AVX2) && use_avx2;
+extern PlaneProcessor* avx2_fma_functions_32[];
+extern PlaneProcessor* avx512_functions[];
+extern PlaneProcessor* avx512_functions_16_10[];
+extern PlaneProcessor* avx512_functions_16_12[];
+extern PlaneProcessor* avx512_functions_16_14[];
+extern PlaneProcessor* avx512_functions_16_16[];
+extern PlaneProcessor* avx512_functions_32[];
+
+// CPU, bit depth and plane width dependent table, shared with RGRepair.
+// Any width works with every table, AVX2/AVX-512 only pay off when a plane has a full vector of inner pixels.
+// optAvx2=false disables AVX-512 too.
+PlaneProcessor** removegrain_functions(const VideoInfo &vi, int width, bool use_avx2, IScriptEnvironment* env) {
+    const int pixelsize = vi.ComponentSize();
+    const int bits_per_pixel = vi.BitsPerComponent();
+    PlaneProcessor **functions = nullptr;
+
+    bool avx2 = (env->GetCPUFlags() & CPUF_AVX2) && use_avx2 && width >= 32 / pixelsize + 2;
+    bool avx512 = avx2 && cpu_has_avx512bw() && width >= 64 / pixelsize + 2;
 
     if (pixelsize == 1) {
-      if (avx2)
+      if (avx512)
+        functions = avx512_functions;
+      else if (avx2)
         functions = avx2_functions;
+      else if ((env->GetCPUFlags() & CPUF_SSSE3) && !(env->GetCPUFlags() & CPUF_SSE4_2))
+        functions = ssse3_functions; // palignr instead of cache line split loads
       else if (env->GetCPUFlags() & CPUF_SSE3)
         functions = sse3_functions;
       else if (env->GetCPUFlags() & CPUF_SSE2)
         functions = sse2_functions;
       else
         functions = c_functions;
-
-      if (vi.width < 32 + 1 && avx2) { //not enough for YMM, try SSE3
-        functions = sse3_functions;
-      }
-      if (vi.width < 16+1) { //not enough for XMM
-        functions = c_functions;
-      }
     }
     else if (pixelsize == 2) {
-      if (avx2 && vi.width >= (32 / sizeof(uint16_t) + 1)) {
+      if (avx512) {
+        switch (bits_per_pixel) {
+        case 10: functions = avx512_functions_16_10; break;
+        case 12: functions = avx512_functions_16_12; break;
+        case 14: functions = avx512_functions_16_14; break;
+        case 16: functions = avx512_functions_16_16; break;
+        default: env->ThrowError("Illegal bit-depth: %d!", bits_per_pixel);
+        }
+      }
+      else if (avx2) {
         // mode 6 and 8 bitdepth clamp specific
         switch (bits_per_pixel) {
         case 10: functions = avx2_functions_16_10; break;
@@ -757,7 +995,7 @@ RemoveGrain::RemoveGrain(PClip child, int mode, int modeU, int modeV, bool skip_
         default: env->ThrowError("Illegal bit-depth: %d!", bits_per_pixel);
         }
       }
-      else if ((env->GetCPUFlags() & CPUF_SSE4) && vi.width >= (16/sizeof(uint16_t) + 1)) {
+      else if (env->GetCPUFlags() & CPUF_SSE4) {
         // mode 6 and 8 bitdepth clamp specific
         switch (bits_per_pixel) {
         case 10: functions = sse4_functions_16_10; break;
@@ -778,61 +1016,221 @@ RemoveGrain::RemoveGrain(PClip child, int mode, int modeU, int modeV, bool skip_
       }
     }
     else {// if (pixelsize == 4) 
-      if (avx2 && vi.width >= (32 / sizeof(float) + 1))
-        functions = avx2_functions_32;
-      else if ((env->GetCPUFlags() & CPUF_SSE4) && vi.width >= (16/sizeof(float) + 1))
+      if (avx512)
+        functions = avx512_functions_32;
+      else if (avx2)
+        functions = (env->GetCPUFlags() & CPUF_FMA3) ? avx2_fma_functions_32 : avx2_functions_32;
+      else if (env->GetCPUFlags() & CPUF_SSE4)
         functions = sse4_functions_32;
       else
         functions = c_functions_32;
     }
+
+    return functions;
+}
+
+// every table the CPU can run for this format, flags from CPUID so classic hosts get AVX2 too
+static std::vector<TuneCandidate<PlaneProcessor>> removegrain_candidates(const VideoInfo &vi, bool use_avx2) {
+    const int cpu = cpu_detect_flags();
+    const bool avx2 = use_avx2 && (cpu & CPUF_AVX2);
+    const bool avx512 = avx2 && cpu_has_avx512bw();
+    std::vector<TuneCandidate<PlaneProcessor>> candidates;
+
+    if (vi.ComponentSize() == 1) {
+      candidates.push_back({ "c", c_functions });
+      if (cpu & CPUF_SSE2) candidates.push_back({ "sse2", sse2_functions });
+      if (cpu & CPUF_SSE3) candidates.push_back({ "sse3", sse3_functions });
+      if (cpu & CPUF_SSSE3) candidates.push_back({ "ssse3", ssse3_functions });
+      if (avx2) candidates.push_back({ "avx2", avx2_functions });
+      if (avx512) candidates.push_back({ "avx512", avx512_functions });
+    }
+    else if (vi.ComponentSize() == 2) {
+      const int i = (vi.BitsPerComponent() - 10) / 2; // 10, 12, 14, 16
+      PlaneProcessor **c[] = { c_functions_10, c_functions_12, c_functions_14, c_functions_16 };
+      PlaneProcessor **sse4[] = { sse4_functions_16_10, sse4_functions_16_12, sse4_functions_16_14, sse4_functions_16_16 };
+      PlaneProcessor **avx2_16[] = { avx2_functions_16_10, avx2_functions_16_12, avx2_functions_16_14, avx2_functions_16_16 };
+      PlaneProcessor **avx512_16[] = { avx512_functions_16_10, avx512_functions_16_12, avx512_functions_16_14, avx512_functions_16_16 };
+      candidates.push_back({ "c", c[i] });
+      if (cpu & CPUF_SSE4) candidates.push_back({ "sse4", sse4[i] });
+      if (avx2) candidates.push_back({ "avx2", avx2_16[i] });
+      if (avx512) candidates.push_back({ "avx512", avx512_16[i] });
+    }
+    else {
+      candidates.push_back({ "c", c_functions_32 });
+      if (cpu & CPUF_SSE4) candidates.push_back({ "sse4", sse4_functions_32 });
+      if (avx2) candidates.push_back({ "avx2", avx2_functions_32 });
+      if (avx2 && (cpu & CPUF_FMA3)) candidates.push_back({ "avx2fma", avx2_fma_functions_32 });
+      if (avx512) candidates.push_back({ "avx512", avx512_functions_32 });
+    }
+    return candidates;
+}
+
+const char* removegrain_table_name(const VideoInfo &vi, PlaneProcessor **table, int mode) {
+    return tune_candidate_name(removegrain_candidates(vi, true), table, mode);
+}
+
+// autotune=true: times the candidates on a plane of this size and puts the fastest one for 'mode' in 'tuned',
+// 'reference' is the table chosen without autotune
+static void removegrain_autotune(PlaneProcessor **tuned, PlaneProcessor **reference, const VideoInfo &vi, int mode, int width, int height, bool use_avx2, const char *cache_path, IScriptEnvironment* env) {
+    if (mode <= 0)
+      return; // copy or nothing
+
+    const int rowsize = width * vi.ComponentSize();
+    const int bits_per_pixel = vi.BitsPerComponent();
+    char key[256];
+    snprintf(key, sizeof(key), "%s|RemoveGrain mode=%d bits=%d %dx%d%s", cpu_model_name().c_str(), mode, bits_per_pixel, width, height, use_avx2 ? "" : " noavx2");
+
+    PlaneProcessor **best = autotune_pick<PlaneProcessor>(removegrain_candidates(vi, use_avx2), reference, key, rowsize, height, bits_per_pixel, 1, cache_path,
+      [&](PlaneProcessor **table, std::vector<TunePlane> &in, TunePlane &dst) {
+        table[mode + 1](env, in[0].ptr(), dst.ptr(), rowsize, height, in[0].pitch(), dst.pitch());
+      });
+    tuned[mode + 1] = best[mode + 1];
+}
+
+RemoveGrain::RemoveGrain(PClip child, int mode, int modeU, int modeV, bool skip_cs_check, bool use_avx2, int threads, bool autotune, const char *tunecache, bool profile, IScriptEnvironment* env)
+    : GenericVideoFilter(child), mode_(mode), modeU_(modeU), modeV_(modeV), functions(nullptr), functions_chroma(nullptr), pool_(nullptr), stripes_(1) {
+    if (!(vi.IsPlanar() || skip_cs_check)) {
+        env->ThrowError("RemoveGrain works only with planar colorspaces");
+    }
+
+    if (mode <= UNDEFINED_MODE || mode_ > 24 || modeU_ > 24 || modeV_ > 24) {
+        env->ThrowError("RemoveGrain mode should be between -1 and 24!");
+    }
+
+    bool isPlanarRGB = vi.IsPlanarRGB() || vi.IsPlanarRGBA();
+    if (isPlanarRGB && ((modeU_ > UNDEFINED_MODE) || (modeV_ > UNDEFINED_MODE))) {
+      env->ThrowError("RemoveGrain: cannot specify U or V mode for planar RGB!");
+    }
+
+    //now change undefined mode value and EVERYTHING WILL BREAK
+    if (modeU_ <= UNDEFINED_MODE) { 
+        modeU_ = mode_;
+    }
+    if (modeV_ <= UNDEFINED_MODE) {
+        modeV_ = modeU_;
+    }
+
+    // no plane is changed, frames are handed on without a copy
+    passthrough_ = mode_ <= 0 && (isPlanarRGB || !vi.IsPlanar() || vi.IsY() || (modeU_ <= 0 && modeV_ <= 0));
+
+    pixelsize = vi.ComponentSize();
+    bits_per_pixel = vi.BitsPerComponent();
+
+    functions = removegrain_functions(vi, vi.width, use_avx2, env);
+    functions_chroma = removegrain_functions(vi, chroma_plane_width(vi), use_avx2, env);
+
+    if (autotune) {
+      // tuned copies of the tables, only the entries of the used modes change
+      std::copy(functions, functions + TABLE_SIZE, tuned_);
+      std::copy(functions_chroma, functions_chroma + TABLE_SIZE, tuned_chroma_);
+
+      const bool chroma = vi.IsPlanar() && !vi.IsY() && !vi.IsPlanarRGB() && !vi.IsPlanarRGBA();
+      removegrain_autotune(tuned_, functions, vi, mode_, vi.width, vi.height, use_avx2, tunecache, env);
+      if (chroma) {
+        const int chroma_height = vi.height >> vi.GetPlaneHeightSubsampling(PLANAR_U);
+        removegrain_autotune(tuned_chroma_, functions_chroma, vi, modeU_, chroma_plane_width(vi), chroma_height, use_avx2, tunecache, env);
+        if (modeV_ != modeU_)
+          removegrain_autotune(tuned_chroma_, functions_chroma, vi, modeV_, chroma_plane_width(vi), chroma_height, use_avx2, tunecache, env);
+      }
+      functions = tuned_;
+      functions_chroma = tuned_chroma_;
+    }
+
+    profile_ = FilterProfile::create(profile, "RemoveGrain", vi, env);
+    if (profile_) {
+      // planar RGB: all planes use the luma table
+      profile_->set_isa(0, removegrain_table_name(vi, functions, mode_));
+      profile_->set_isa(1, removegrain_table_name(vi, isPlanarRGB ? functions : functions_chroma, isPlanarRGB ? mode_ : modeU_));
+      profile_->set_isa(2, removegrain_table_name(vi, isPlanarRGB ? functions : functions_chroma, isPlanarRGB ? mode_ : modeV_));
+    }
+
+    if (threads < 0) {
+      env->ThrowError("RemoveGrain: threads must be 0 (auto) or positive!");
+    }
+    if (threads != 1) {
+      pool_ = ThreadPool::acquire();
+      stripes_ = stripes_for_threads(threads, pool_);
+    }
+}
+
+RemoveGrain::~RemoveGrain() {
+  if (pool_ != nullptr)
+    ThreadPool::release();
+}
+
+void RemoveGrain::process_plane(int p, PlaneProcessor** table, int mode, const BYTE* pSrc, BYTE* pDst, int rowsize, int height, int srcPitch, int dstPitch, IScriptEnvironment* env) {
+  PlaneTimer timer(profile_.get(), p, rowsize, height, 1);
+  PlaneProcessor *processor = table[mode + 1];
+  if (pSrc == pDst) {
+    // in place, modes 0 and -1 leave the plane as it is
+    if (mode > 0) {
+      process_plane_inplace(pDst, dstPitch, rowsize, height, 1, [&](int, int h, const BYTE* pWindow, int windowPitch, BYTE* pRows, int pitch) {
+        processor(env, pWindow, pRows, rowsize, h, windowPitch, pitch);
+      });
+    }
+    return;
+  }
+  if (pool_ == nullptr || mode == -1) {
+    processor(env, pSrc, pDst, rowsize, height, srcPitch, dstPitch);
+    return;
+  }
+  process_plane_stripes(pool_, stripes_, 1, pDst, dstPitch, rowsize, height, [&](int y, int h, BYTE* pStripeDst, int stripeDstPitch) {
+    processor(env, pSrc + y * srcPitch, pStripeDst, rowsize, h, srcPitch, stripeDstPitch);
+  });
 }
 
 
 PVideoFrame RemoveGrain::GetFrame(int n, IScriptEnvironment* env) {
+    if (passthrough_)
+      return child->GetFrame(n, env);
+
     auto srcFrame = child->GetFrame(n, env);
-    auto dstFrame = env->NewVideoFrame(vi);
-    
+    // nothing else holds the source frame (no cache before us): filter it in place, without a second
+    // frame and the alpha copy. Not with threads, the stripes would need each other's source rows
+    const bool inplace = pool_ == nullptr && srcFrame->IsWritable();
+    PVideoFrame newFrame;
+    if (!inplace)
+      newFrame = env->NewVideoFrame(vi);
+    // in place an alias, not a second handle: that would make the frame read-only, GetWritePtr returns nullptr
+    PVideoFrame &dstFrame = inplace ? srcFrame : newFrame;
+    FrameProfile frame_profile(profile_.get());
+
     int planes_y[4] = { PLANAR_Y, PLANAR_U, PLANAR_V, PLANAR_A };
     int planes_r[4] = { PLANAR_G, PLANAR_B, PLANAR_R, PLANAR_A };
     int *planes = (vi.IsYUV() || vi.IsYUVA()) ? planes_y : planes_r;
 
-    // remark: no special alignment required for AVX2
+    // remark: no special alignment required, SSE planes fall back to unaligned loads per plane
 
     if (vi.IsPlanarRGB() || vi.IsPlanarRGBA()) {
       for (int p = 0; p < 3; ++p) {
         const int plane = planes[p];
 
-        functions[mode_ + 1](env, srcFrame->GetReadPtr(plane), dstFrame->GetWritePtr(plane), srcFrame->GetRowSize(plane),
-          srcFrame->GetHeight(plane), srcFrame->GetPitch(plane), dstFrame->GetPitch(plane));
+        process_plane(p, functions, mode_, srcFrame->GetReadPtr(plane), dstFrame->GetWritePtr(plane), srcFrame->GetRowSize(plane),
+          srcFrame->GetHeight(plane), srcFrame->GetPitch(plane), dstFrame->GetPitch(plane), env);
       }
     } else {
-      if(!is_16byte_aligned(srcFrame->GetReadPtr(PLANAR_Y)))
-        env->ThrowError("RemoveGrain: Invalid memory alignment. Unaligned crop?");
-
-      functions[mode_+1](env, srcFrame->GetReadPtr(PLANAR_Y), dstFrame->GetWritePtr(PLANAR_Y), srcFrame->GetRowSize(PLANAR_Y), 
-        srcFrame->GetHeight(PLANAR_Y), srcFrame->GetPitch(PLANAR_Y), dstFrame->GetPitch(PLANAR_Y));
+      process_plane(0, functions, mode_, srcFrame->GetReadPtr(PLANAR_Y), dstFrame->GetWritePtr(PLANAR_Y), srcFrame->GetRowSize(PLANAR_Y), 
+        srcFrame->GetHeight(PLANAR_Y), srcFrame->GetPitch(PLANAR_Y), dstFrame->GetPitch(PLANAR_Y), env);
 
       if (vi.IsPlanar() && !vi.IsY()) {
-        if(!is_16byte_aligned(srcFrame->GetReadPtr(PLANAR_U)))
-          env->ThrowError("RemoveGrain: Invalid memory alignment. Unaligned crop?");
-
-        functions[modeU_ + 1](env, srcFrame->GetReadPtr(PLANAR_U), dstFrame->GetWritePtr(PLANAR_U), srcFrame->GetRowSize(PLANAR_U),
-          srcFrame->GetHeight(PLANAR_U), srcFrame->GetPitch(PLANAR_U), dstFrame->GetPitch(PLANAR_U));
+        process_plane(1, functions_chroma, modeU_, srcFrame->GetReadPtr(PLANAR_U), dstFrame->GetWritePtr(PLANAR_U), srcFrame->GetRowSize(PLANAR_U),
+          srcFrame->GetHeight(PLANAR_U), srcFrame->GetPitch(PLANAR_U), dstFrame->GetPitch(PLANAR_U), env);
 
-        functions[modeV_ + 1](env, srcFrame->GetReadPtr(PLANAR_V), dstFrame->GetWritePtr(PLANAR_V), srcFrame->GetRowSize(PLANAR_V),
-          srcFrame->GetHeight(PLANAR_V), srcFrame->GetPitch(PLANAR_V), dstFrame->GetPitch(PLANAR_V));
+        process_plane(2, functions_chroma, modeV_, srcFrame->GetReadPtr(PLANAR_V), dstFrame->GetWritePtr(PLANAR_V), srcFrame->GetRowSize(PLANAR_V),
+          srcFrame->GetHeight(PLANAR_V), srcFrame->GetPitch(PLANAR_V), dstFrame->GetPitch(PLANAR_V), env);
       }
     }
-    if (vi.IsYUVA() || vi.IsPlanarRGBA())
-    { // copy alpha
+    if ((vi.IsYUVA() || vi.IsPlanarRGBA()) && !inplace)
+    { // copy alpha, in place it is there already
       env->BitBlt(dstFrame->GetWritePtr(PLANAR_A), dstFrame->GetPitch(PLANAR_A), srcFrame->GetReadPtr(PLANAR_A), srcFrame->GetPitch(PLANAR_A), srcFrame->GetRowSize(PLANAR_A_ALIGNED), srcFrame->GetHeight(PLANAR_A));
     }
+    frame_profile.attach(dstFrame, env);
     return dstFrame;
 }
 
 
 AVSValue __cdecl Create_RemoveGrain(AVSValue args, void*, IScriptEnvironment* env) {
-    enum { CLIP, MODE, MODEU, MODEV, PLANAR, OPTAVX2 };
+    enum { CLIP, MODE, MODEU, MODEV, PLANAR, OPTAVX2, THREADS, AUTOTUNE, TUNECACHE, PROFILE };
     return new RemoveGrain(args[CLIP].AsClip(), args[MODE].AsInt(1), args[MODEU].AsInt(RemoveGrain::UNDEFINED_MODE), args[MODEV].AsInt(RemoveGrain::UNDEFINED_MODE), 
-      args[PLANAR].AsBool(false), args[OPTAVX2].AsBool(true), env);
+      args[PLANAR].AsBool(false), args[OPTAVX2].AsBool(true), args[THREADS].AsInt(1), args[AUTOTUNE].AsBool(false), args[TUNECACHE].AsString(""), args[PROFILE].AsBool(false), env);
 }
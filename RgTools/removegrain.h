@@ -2,6 +2,8 @@
 #define __REMOVEGRAIN_H__
 
 #include "common.h"
+#include "thread_pool.h"
+#include "profile.h"
 
 
 typedef void (PlaneProcessor)(IScriptEnvironment* env, const BYTE* pSrc, BYTE* pDst, int rowsize, int height, int srcPitch, int dstPitch);
@@ -9,20 +11,26 @@ typedef void (PlaneProcessor)(IScriptEnvironment* env, const BYTE* pSrc, BYTE* p
 
 class RemoveGrain : public GenericVideoFilter {
 public:
-    RemoveGrain(PClip child, int mode, int modeU, int modeV, bool skip_cs_check, bool use_avx2, IScriptEnvironment* env);
+    RemoveGrain(PClip child, int mode, int modeU, int modeV, bool skip_cs_check, bool use_avx2, int threads, bool autotune, const char *tunecache, bool profile, IScriptEnvironment* env);
+    ~RemoveGrain();
 
     PVideoFrame __stdcall GetFrame(int n, IScriptEnvironment* env);
 
+    // profile=true, else nullptr
+    FilterProfile* profile() const { return profile_.get(); }
+
     int __stdcall SetCacheHints(int cachehints, int frame_range) override {
       return cachehints == CACHE_GET_MTMODE ? MT_NICE_FILTER : 0;
     }
 
     const static int UNDEFINED_MODE = -2;
+    const static int TABLE_SIZE = 26; // modes -1..24
 
 private:
     int mode_;
     int modeU_;
     int modeV_;
+    bool passthrough_; // all planes mode 0 or -1: GetFrame returns the source frame
 
     bool avx2_; // for disabling avx2
 
@@ -30,9 +38,23 @@ private:
     int bits_per_pixel;
 
     PlaneProcessor **functions;
+    PlaneProcessor **functions_chroma; // U and V, may be narrower than a vector
+    PlaneProcessor *tuned_[TABLE_SIZE]; // autotune=true: functions and functions_chroma point here
+    PlaneProcessor *tuned_chroma_[TABLE_SIZE];
+
+    ThreadPool *pool_; // nullptr when threads=1
+    int stripes_;
+
+    std::shared_ptr<FilterProfile> profile_; // nullptr when profile=false
+
+    void process_plane(int p, PlaneProcessor** table, int mode, const BYTE* pSrc, BYTE* pDst, int rowsize, int height, int srcPitch, int dstPitch, IScriptEnvironment* env);
 };
 
 
+PlaneProcessor** removegrain_functions(const VideoInfo &vi, int width, bool use_avx2, IScriptEnvironment* env);
+// "c", "sse2", ... "avx512" for a table from removegrain_functions or an autotuned copy
+const char* removegrain_table_name(const VideoInfo &vi, PlaneProcessor **table, int mode);
+
 AVSValue __cdecl Create_RemoveGrain(AVSValue args, void*, IScriptEnvironment* env);
 
 #endif
\ No newline at end of file
@@ -1,53 +1,73 @@
-#include "rg_functions_avx2.h"
+#include "rg_functions_fma.h"
 #include "removegrain.h"
 
-// AVX2: not using special aligned templates, loadu is fast is aligned
-template<typename pixel_t, SseModeProcessor processor>
-static void process_plane_avx2(IScriptEnvironment* env, const BYTE* pSrc8, BYTE* pDst8, int rowsize, int height, int srcPitch, int dstPitch) {
-    _mm256_zeroupper();
-    
-    env->BitBlt(pDst8, dstPitch, pSrc8, srcPitch, rowsize, 1);
-
-    pixel_t *pDst = reinterpret_cast<pixel_t *>(pDst8);
-    const pixel_t *pSrc = reinterpret_cast<const pixel_t *>(pSrc8);
-
-    dstPitch /= sizeof(pixel_t);
-    const int srcPitchOrig = srcPitch;
-    srcPitch /= sizeof(pixel_t);
+// 'rows' (1 or 2) output rows per call, see process_column_sse in removegrain.cpp
+template<SseModeProcessor processor, int rows>
+static RG_FORCEINLINE void process_column_avx2(const Byte* pSrc, Byte* pDst, int srcPitch, int dstPitch) {
+    __m256i r0 = processor(pSrc, srcPitch);
+    __m256i r1;
+    if (rows > 1) r1 = processor(pSrc + srcPitch, srcPitch);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(pDst), r0);
+    if (rows > 1) _mm256_storeu_si256(reinterpret_cast<__m256i*>(pDst + dstPitch), r1);
+}
 
-    const int width = rowsize / sizeof(pixel_t);
+template<typename pixel_t, SseModeProcessor processor, int rows>
+static RG_FORCEINLINE void process_rows_avx2(const Byte* pSrc, Byte* pDst, int srcPitch, int dstPitch, int width) {
     const int pixels_at_at_time = 32 / sizeof(pixel_t); // 32!
+    const int mod_width = width / pixels_at_at_time * pixels_at_at_time;
 
-    pSrc += srcPitch;
-    pDst += dstPitch;
-    int mod_width = width / pixels_at_at_time * pixels_at_at_time;
-
-    for (int y = 1; y < height - 1; ++y) {
-      pDst[0] = pSrc[0];
+    for (int r = 0; r < rows; ++r)
+      reinterpret_cast<pixel_t*>(pDst + r * dstPitch)[0] = reinterpret_cast<const pixel_t*>(pSrc + r * srcPitch)[0];
 
+    if (width < pixels_at_at_time + 2) {
+      // narrow plane: one partial vector on a staged copy of the rows
+      for (int r = 0; r < rows && width > 2; ++r)
+        process_row_staged<pixel_t>(pDst + r * dstPitch, pSrc + r * srcPitch, srcPitch, width, processor);
+    } else {
       // unaligned first 32 bytes, last pixel overlaps with the next aligned loop
-      __m256i result = processor((uint8_t *)(pSrc + 1), srcPitchOrig);
-      _mm256_storeu_si256(reinterpret_cast<__m256i*>(pDst + 1), result);
+      process_column_avx2<processor, rows>(pSrc + sizeof(pixel_t), pDst + sizeof(pixel_t), srcPitch, dstPitch);
 
-      // possibly aligned
+      // possibly aligned, stored as unaligned
       for (int x = pixels_at_at_time; x < mod_width - 1; x += pixels_at_at_time) {
-        __m256i result = processor((uint8_t *)(pSrc + x), srcPitchOrig);
-        _mm256_storeu_si256(reinterpret_cast<__m256i*>(pDst + x), result); // store as unaligned
+        process_column_avx2<processor, rows>(pSrc + x * sizeof(pixel_t), pDst + x * sizeof(pixel_t), srcPitch, dstPitch);
       }
-      
+
       if (mod_width != width) {
-        __m256i result = processor((uint8_t *)(pSrc + width - 1 - pixels_at_at_time), srcPitchOrig);
-        _mm256_storeu_si256(reinterpret_cast<__m256i*>(pDst + width - 1 - pixels_at_at_time), result);
+        const int x = width - 1 - pixels_at_at_time;
+        process_column_avx2<processor, rows>(pSrc + x * sizeof(pixel_t), pDst + x * sizeof(pixel_t), srcPitch, dstPitch);
       }
-      
-      pDst[width - 1] = pSrc[width - 1];
+    }
 
+    for (int r = 0; r < rows; ++r)
+      reinterpret_cast<pixel_t*>(pDst + r * dstPitch)[width - 1] = reinterpret_cast<const pixel_t*>(pSrc + r * srcPitch)[width - 1];
+}
+
+// AVX2: not using special aligned templates, loadu is fast is aligned
+template<typename pixel_t, SseModeProcessor processor, int rows = 1>
+static void process_plane_avx2(IScriptEnvironment* env, const BYTE* pSrc, BYTE* pDst, int rowsize, int height, int srcPitch, int dstPitch) {
+    _mm256_zeroupper();
+    
+    env->BitBlt(pDst, dstPitch, pSrc, srcPitch, rowsize, 1);
+
+    const int width = rowsize / sizeof(pixel_t);
+
+    pSrc += srcPitch;
+    pDst += dstPitch;
+
+    int y = 1;
+    for (; y + rows <= height - 1; y += rows) {
+      process_rows_avx2<pixel_t, processor, rows>(pSrc, pDst, srcPitch, dstPitch, width);
+      pSrc += srcPitch * rows;
+      pDst += dstPitch * rows;
+    }
+    for (; y < height - 1; ++y) {
+      process_rows_avx2<pixel_t, processor, 1>(pSrc, pDst, srcPitch, dstPitch, width);
       pSrc += srcPitch;
       pDst += dstPitch;
     }
     _mm256_zeroupper();
 
-    env->BitBlt((uint8_t *)(pDst), dstPitch*sizeof(pixel_t), (uint8_t *)(pSrc), srcPitch*sizeof(pixel_t), rowsize, 1);
+    env->BitBlt(pDst, dstPitch, pSrc, srcPitch, rowsize, 1);
 }
 
 
@@ -72,19 +92,24 @@ static void process_halfplane_avx2(IScriptEnvironment* env, const BYTE* pSrc8, B
     for (int y = 1; y < height/2; ++y) {
         pDst[0] = (pSrc[srcPitch] + pSrc[-srcPitch] + (sizeof(pixel_t) == 4 ? 0 : 1)) / 2; // float: no +1 rounding
 
-        // unaligned first 32 bytes, last pixel overlaps with the next aligned loop
-        __m256i result = processor((uint8_t *)(pSrc + 1), srcPitchOrig);
-        _mm256_storeu_si256(reinterpret_cast<__m256i*>(pDst + 1), result);
-
-        // possibly aligned
-        for (int x = pixels_at_at_time; x < mod_width - 1; x += pixels_at_at_time) {
-          __m256i result = processor((uint8_t *)(pSrc + x), srcPitchOrig);
-          _mm256_storeu_si256(reinterpret_cast<__m256i*>(pDst + x), result);
-        }
-
-        if (mod_width != width) {
-          __m256i result = processor((uint8_t *)(pSrc+width-1-pixels_at_at_time), srcPitchOrig);
-          _mm256_storeu_si256(reinterpret_cast<__m256i*>(pDst+width-1-pixels_at_at_time), result);
+        if (width < pixels_at_at_time + 2) {
+          if (width > 2)
+            process_row_staged<pixel_t>((uint8_t *)pDst, (const uint8_t *)pSrc, srcPitchOrig, width, processor);
+        } else {
+          // unaligned first 32 bytes, last pixel overlaps with the next aligned loop
+          __m256i result = processor((uint8_t *)(pSrc + 1), srcPitchOrig);
+          _mm256_storeu_si256(reinterpret_cast<__m256i*>(pDst + 1), result);
+
+          // possibly aligned
+          for (int x = pixels_at_at_time; x < mod_width - 1; x += pixels_at_at_time) {
+            __m256i result = processor((uint8_t *)(pSrc + x), srcPitchOrig);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(pDst + x), result);
+          }
+
+          if (mod_width != width) {
+            __m256i result = processor((uint8_t *)(pSrc+width-1-pixels_at_at_time), srcPitchOrig);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(pDst+width-1-pixels_at_at_time), result);
+          }
         }
 
         pDst[width-1] = (pSrc[width-1 + srcPitch] + pSrc[width-1 - srcPitch] + (sizeof(pixel_t) == 4 ? 0 : 1)) / 2; // float: no +1 rounding
@@ -106,6 +131,9 @@ static void process_even_rows_avx2(IScriptEnvironment* env, const BYTE* pSrc, BY
     env->BitBlt(pDst, dstPitch, pSrc, srcPitch, rowsize, 2); //copy first two lines
 
     process_halfplane_avx2<pixel_t, processor>(env, pSrc+srcPitch, pDst+dstPitch, rowsize, height, srcPitch, dstPitch);
+
+    if (height & 1) // odd height: the last row is beyond the half plane loop
+      env->BitBlt(pDst+dstPitch*(height-1), dstPitch, pSrc+srcPitch*(height-1), srcPitch, rowsize, 1);
 }
 
 template<typename pixel_t, SseModeProcessor processor>
@@ -115,6 +143,9 @@ static void process_odd_rows_avx2(IScriptEnvironment* env, const BYTE* pSrc, BYT
 
     process_halfplane_avx2<pixel_t, processor>(env, pSrc, pDst, rowsize, height, srcPitch, dstPitch);
 
+    if (height & 1) // odd height: the half plane loop stops one row above the bottom border
+      env->BitBlt(pDst+dstPitch*(height-2), dstPitch, pSrc+srcPitch*(height-2), srcPitch, rowsize, 1);
+
     env->BitBlt(pDst+dstPitch*(height-1), dstPitch, pSrc+srcPitch*(height-1), srcPitch, rowsize, 1); //bottom border
 }
 
@@ -131,177 +162,347 @@ static void copyPlane(IScriptEnvironment* env, const BYTE* pSrc, BYTE* pDst, int
 PlaneProcessor* avx2_functions[] = {
     doNothing,
     copyPlane,
-    process_plane_avx2<uint8_t, rg_mode1_avx2<false>>,
-    process_plane_avx2<uint8_t, rg_mode2_avx2<false>>,
-    process_plane_avx2<uint8_t, rg_mode3_avx2<false>>,
-    process_plane_avx2<uint8_t, rg_mode4_avx2<false>>,
+    process_plane_avx2<uint8_t, rg_mode1_avx2<false>, RG_BLOCK_ROWS>,
+    process_plane_avx2<uint8_t, rg_mode2_avx2<false>, RG_BLOCK_ROWS>,
+    process_plane_avx2<uint8_t, rg_mode3_avx2<false>, RG_BLOCK_ROWS>,
+    process_plane_avx2<uint8_t, rg_mode4_avx2<false>, RG_BLOCK_ROWS>,
     process_plane_avx2<uint8_t, rg_mode5_avx2<false>>,
     process_plane_avx2<uint8_t, rg_mode6_avx2<false>>,
     process_plane_avx2<uint8_t, rg_mode7_avx2<false>>,
     process_plane_avx2<uint8_t, rg_mode8_avx2<false>>,
     process_plane_avx2<uint8_t, rg_mode9_avx2<false>>,
     process_plane_avx2<uint8_t, rg_mode10_avx2<false>>,
-    process_plane_avx2<uint8_t, rg_mode11_avx2<false>>,
-    process_plane_avx2<uint8_t, rg_mode12_avx2<false>>,
+    process_plane_avx2<uint8_t, rg_mode11_avx2<false>, RG_BLOCK_ROWS>,
+    process_plane_avx2<uint8_t, rg_mode12_avx2<false>, RG_BLOCK_ROWS>,
     process_even_rows_avx2<uint8_t, rg_mode13_and14_avx2<false>>,
     process_odd_rows_avx2<uint8_t, rg_mode13_and14_avx2<false>>,
     process_even_rows_avx2<uint8_t, rg_mode15_and16_avx2<false>>,
     process_odd_rows_avx2<uint8_t, rg_mode15_and16_avx2<false>>,
-    process_plane_avx2<uint8_t, rg_mode17_avx2<false>>,
+    process_plane_avx2<uint8_t, rg_mode17_avx2<false>, RG_BLOCK_ROWS>,
     process_plane_avx2<uint8_t, rg_mode18_avx2<false>>,
-    process_plane_avx2<uint8_t, rg_mode19_avx2<false>>,
-    process_plane_avx2<uint8_t, rg_mode20_avx2<false>>,
+    process_plane_avx2<uint8_t, rg_mode19_avx2<false>, RG_BLOCK_ROWS>,
+    process_plane_avx2<uint8_t, rg_mode20_avx2<false>, RG_BLOCK_ROWS>,
     process_plane_avx2<uint8_t, rg_mode21_avx2<false>>,
-    process_plane_avx2<uint8_t, rg_mode22_avx2<false>>,
+    process_plane_avx2<uint8_t, rg_mode22_avx2<false>, RG_BLOCK_ROWS>,
     process_plane_avx2<uint8_t, rg_mode23_avx2<false>>,
     process_plane_avx2<uint8_t, rg_mode24_avx2<false>>,
 };
 
+// RgBench: the row blocked modes of avx2_functions with one row per iteration, nullptr for the other modes
+PlaneProcessor* avx2_functions_rows1[] = {
+    nullptr, nullptr,
+    process_plane_avx2<uint8_t, rg_mode1_avx2<false>, 1>,
+    process_plane_avx2<uint8_t, rg_mode2_avx2<false>, 1>,
+    process_plane_avx2<uint8_t, rg_mode3_avx2<false>, 1>,
+    process_plane_avx2<uint8_t, rg_mode4_avx2<false>, 1>,
+    nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+    process_plane_avx2<uint8_t, rg_mode11_avx2<false>, 1>,
+    process_plane_avx2<uint8_t, rg_mode12_avx2<false>, 1>,
+    nullptr, nullptr, nullptr, nullptr,
+    process_plane_avx2<uint8_t, rg_mode17_avx2<false>, 1>,
+    nullptr,
+    process_plane_avx2<uint8_t, rg_mode19_avx2<false>, 1>,
+    process_plane_avx2<uint8_t, rg_mode20_avx2<false>, 1>,
+    nullptr,
+    process_plane_avx2<uint8_t, rg_mode22_avx2<false>, 1>,
+    nullptr, nullptr,
+};
+
 
 PlaneProcessor* avx2_functions_16_10[] = {
   doNothing,
   copyPlane,
-  process_plane_avx2<uint16_t, rg_mode1_avx2_16<false>>,
-  process_plane_avx2<uint16_t, rg_mode2_avx2_16<false>>,
-  process_plane_avx2<uint16_t, rg_mode3_avx2_16<false>>,
-  process_plane_avx2<uint16_t, rg_mode4_avx2_16<false>>,
+  process_plane_avx2<uint16_t, rg_mode1_avx2_16<false>, RG_BLOCK_ROWS>,
+  process_plane_avx2<uint16_t, rg_mode2_avx2_16<false>, RG_BLOCK_ROWS>,
+  process_plane_avx2<uint16_t, rg_mode3_avx2_16<false>, RG_BLOCK_ROWS>,
+  process_plane_avx2<uint16_t, rg_mode4_avx2_16<false>, RG_BLOCK_ROWS>,
   process_plane_avx2<uint16_t, rg_mode5_avx2_16<false>>,
   process_plane_avx2<uint16_t, rg_mode6_avx2_16<10, false>>,
   process_plane_avx2<uint16_t, rg_mode7_avx2_16<false>>,
   process_plane_avx2<uint16_t, rg_mode8_avx2_16<10, false>>,
   process_plane_avx2<uint16_t, rg_mode9_avx2_16<false>>,
   process_plane_avx2<uint16_t, rg_mode10_avx2_16<false>>,
-  process_plane_avx2<uint16_t, rg_mode11_avx2_16<false>>,
-  process_plane_avx2<uint16_t, rg_mode12_avx2_16<false>>,
+  process_plane_avx2<uint16_t, rg_mode11_avx2_16<false>, RG_BLOCK_ROWS>,
+  process_plane_avx2<uint16_t, rg_mode12_avx2_16<false>, RG_BLOCK_ROWS>,
   process_even_rows_avx2<uint16_t, rg_mode13_and14_avx2_16<false>>,
   process_odd_rows_avx2<uint16_t, rg_mode13_and14_avx2_16<false>>,
   process_even_rows_avx2<uint16_t, rg_mode15_and16_avx2_16<false>>,
   process_odd_rows_avx2<uint16_t, rg_mode15_and16_avx2_16<false>>,
-  process_plane_avx2<uint16_t, rg_mode17_avx2_16<false>>,
+  process_plane_avx2<uint16_t, rg_mode17_avx2_16<false>, RG_BLOCK_ROWS>,
   process_plane_avx2<uint16_t, rg_mode18_avx2_16<false>>,
-  process_plane_avx2<uint16_t, rg_mode19_avx2_16<false>>,
-  process_plane_avx2<uint16_t, rg_mode20_avx2_16<false>>,
+  process_plane_avx2<uint16_t, rg_mode19_avx2_16<false>, RG_BLOCK_ROWS>,
+  process_plane_avx2<uint16_t, rg_mode20_avx2_16<false>, RG_BLOCK_ROWS>,
   process_plane_avx2<uint16_t, rg_mode21_avx2_16<false>>,
-  process_plane_avx2<uint16_t, rg_mode22_avx2_16<false>>,
+  process_plane_avx2<uint16_t, rg_mode22_avx2_16<false>, RG_BLOCK_ROWS>,
   process_plane_avx2<uint16_t, rg_mode23_avx2_16<false>>,
   process_plane_avx2<uint16_t, rg_mode24_avx2_16<false>>,
 };
 
+// RgBench: the row blocked modes of avx2_functions_16_10 with one row per iteration, nullptr for the other modes
+PlaneProcessor* avx2_functions_16_10_rows1[] = {
+    nullptr, nullptr,
+  process_plane_avx2<uint16_t, rg_mode1_avx2_16<false>, 1>,
+  process_plane_avx2<uint16_t, rg_mode2_avx2_16<false>, 1>,
+  process_plane_avx2<uint16_t, rg_mode3_avx2_16<false>, 1>,
+  process_plane_avx2<uint16_t, rg_mode4_avx2_16<false>, 1>,
+    nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+  process_plane_avx2<uint16_t, rg_mode11_avx2_16<false>, 1>,
+  process_plane_avx2<uint16_t, rg_mode12_avx2_16<false>, 1>,
+    nullptr, nullptr, nullptr, nullptr,
+  process_plane_avx2<uint16_t, rg_mode17_avx2_16<false>, 1>,
+    nullptr,
+  process_plane_avx2<uint16_t, rg_mode19_avx2_16<false>, 1>,
+  process_plane_avx2<uint16_t, rg_mode20_avx2_16<false>, 1>,
+    nullptr,
+  process_plane_avx2<uint16_t, rg_mode22_avx2_16<false>, 1>,
+    nullptr, nullptr,
+};
+
 PlaneProcessor* avx2_functions_16_12[] = {
   doNothing,
   copyPlane,
-  process_plane_avx2<uint16_t, rg_mode1_avx2_16<false>>,
-  process_plane_avx2<uint16_t, rg_mode2_avx2_16<false>>,
-  process_plane_avx2<uint16_t, rg_mode3_avx2_16<false>>,
-  process_plane_avx2<uint16_t, rg_mode4_avx2_16<false>>,
+  process_plane_avx2<uint16_t, rg_mode1_avx2_16<false>, RG_BLOCK_ROWS>,
+  process_plane_avx2<uint16_t, rg_mode2_avx2_16<false>, RG_BLOCK_ROWS>,
+  process_plane_avx2<uint16_t, rg_mode3_avx2_16<false>, RG_BLOCK_ROWS>,
+  process_plane_avx2<uint16_t, rg_mode4_avx2_16<false>, RG_BLOCK_ROWS>,
   process_plane_avx2<uint16_t, rg_mode5_avx2_16<false>>,
   process_plane_avx2<uint16_t, rg_mode6_avx2_16<12, false>>,
   process_plane_avx2<uint16_t, rg_mode7_avx2_16<false>>,
   process_plane_avx2<uint16_t, rg_mode8_avx2_16<12, false>>,
   process_plane_avx2<uint16_t, rg_mode9_avx2_16<false>>,
   process_plane_avx2<uint16_t, rg_mode10_avx2_16<false>>,
-  process_plane_avx2<uint16_t, rg_mode11_avx2_16<false>>,
-  process_plane_avx2<uint16_t, rg_mode12_avx2_16<false>>,
+  process_plane_avx2<uint16_t, rg_mode11_avx2_16<false>, RG_BLOCK_ROWS>,
+  process_plane_avx2<uint16_t, rg_mode12_avx2_16<false>, RG_BLOCK_ROWS>,
   process_even_rows_avx2<uint16_t, rg_mode13_and14_avx2_16<false>>,
   process_odd_rows_avx2<uint16_t, rg_mode13_and14_avx2_16<false>>,
   process_even_rows_avx2<uint16_t, rg_mode15_and16_avx2_16<false>>,
   process_odd_rows_avx2<uint16_t, rg_mode15_and16_avx2_16<false>>,
-  process_plane_avx2<uint16_t, rg_mode17_avx2_16<false>>,
+  process_plane_avx2<uint16_t, rg_mode17_avx2_16<false>, RG_BLOCK_ROWS>,
   process_plane_avx2<uint16_t, rg_mode18_avx2_16<false>>,
-  process_plane_avx2<uint16_t, rg_mode19_avx2_16<false>>,
-  process_plane_avx2<uint16_t, rg_mode20_avx2_16<false>>,
+  process_plane_avx2<uint16_t, rg_mode19_avx2_16<false>, RG_BLOCK_ROWS>,
+  process_plane_avx2<uint16_t, rg_mode20_avx2_16<false>, RG_BLOCK_ROWS>,
   process_plane_avx2<uint16_t, rg_mode21_avx2_16<false>>,
-  process_plane_avx2<uint16_t, rg_mode22_avx2_16<false>>,
+  process_plane_avx2<uint16_t, rg_mode22_avx2_16<false>, RG_BLOCK_ROWS>,
   process_plane_avx2<uint16_t, rg_mode23_avx2_16<false>>,
   process_plane_avx2<uint16_t, rg_mode24_avx2_16<false>>,
 };
 
+// RgBench: the row blocked modes of avx2_functions_16_12 with one row per iteration, nullptr for the other modes
+PlaneProcessor* avx2_functions_16_12_rows1[] = {
+    nullptr, nullptr,
+  process_plane_avx2<uint16_t, rg_mode1_avx2_16<false>, 1>,
+  process_plane_avx2<uint16_t, rg_mode2_avx2_16<false>, 1>,
+  process_plane_avx2<uint16_t, rg_mode3_avx2_16<false>, 1>,
+  process_plane_avx2<uint16_t, rg_mode4_avx2_16<false>, 1>,
+    nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+  process_plane_avx2<uint16_t, rg_mode11_avx2_16<false>, 1>,
+  process_plane_avx2<uint16_t, rg_mode12_avx2_16<false>, 1>,
+    nullptr, nullptr, nullptr, nullptr,
+  process_plane_avx2<uint16_t, rg_mode17_avx2_16<false>, 1>,
+    nullptr,
+  process_plane_avx2<uint16_t, rg_mode19_avx2_16<false>, 1>,
+  process_plane_avx2<uint16_t, rg_mode20_avx2_16<false>, 1>,
+    nullptr,
+  process_plane_avx2<uint16_t, rg_mode22_avx2_16<false>, 1>,
+    nullptr, nullptr,
+};
+
 PlaneProcessor* avx2_functions_16_14[] = {
   doNothing,
   copyPlane,
-  process_plane_avx2<uint16_t, rg_mode1_avx2_16<false>>,
-  process_plane_avx2<uint16_t, rg_mode2_avx2_16<false>>,
-  process_plane_avx2<uint16_t, rg_mode3_avx2_16<false>>,
-  process_plane_avx2<uint16_t, rg_mode4_avx2_16<false>>,
+  process_plane_avx2<uint16_t, rg_mode1_avx2_16<false>, RG_BLOCK_ROWS>,
+  process_plane_avx2<uint16_t, rg_mode2_avx2_16<false>, RG_BLOCK_ROWS>,
+  process_plane_avx2<uint16_t, rg_mode3_avx2_16<false>, RG_BLOCK_ROWS>,
+  process_plane_avx2<uint16_t, rg_mode4_avx2_16<false>, RG_BLOCK_ROWS>,
   process_plane_avx2<uint16_t, rg_mode5_avx2_16<false>>,
   process_plane_avx2<uint16_t, rg_mode6_avx2_16<14, false>>,
   process_plane_avx2<uint16_t, rg_mode7_avx2_16<false>>,
   process_plane_avx2<uint16_t, rg_mode8_avx2_16<14, false>>,
   process_plane_avx2<uint16_t, rg_mode9_avx2_16<false>>,
   process_plane_avx2<uint16_t, rg_mode10_avx2_16<false>>,
-  process_plane_avx2<uint16_t, rg_mode11_avx2_16<false>>,
-  process_plane_avx2<uint16_t, rg_mode12_avx2_16<false>>,
+  process_plane_avx2<uint16_t, rg_mode11_avx2_16<false>, RG_BLOCK_ROWS>,
+  process_plane_avx2<uint16_t, rg_mode12_avx2_16<false>, RG_BLOCK_ROWS>,
   process_even_rows_avx2<uint16_t, rg_mode13_and14_avx2_16<false>>,
   process_odd_rows_avx2<uint16_t, rg_mode13_and14_avx2_16<false>>,
   process_even_rows_avx2<uint16_t, rg_mode15_and16_avx2_16<false>>,
   process_odd_rows_avx2<uint16_t, rg_mode15_and16_avx2_16<false>>,
-  process_plane_avx2<uint16_t, rg_mode17_avx2_16<false>>,
+  process_plane_avx2<uint16_t, rg_mode17_avx2_16<false>, RG_BLOCK_ROWS>,
   process_plane_avx2<uint16_t, rg_mode18_avx2_16<false>>,
-  process_plane_avx2<uint16_t, rg_mode19_avx2_16<false>>,
-  process_plane_avx2<uint16_t, rg_mode20_avx2_16<false>>,
+  process_plane_avx2<uint16_t, rg_mode19_avx2_16<false>, RG_BLOCK_ROWS>,
+  process_plane_avx2<uint16_t, rg_mode20_avx2_16<false>, RG_BLOCK_ROWS>,
   process_plane_avx2<uint16_t, rg_mode21_avx2_16<false>>,
-  process_plane_avx2<uint16_t, rg_mode22_avx2_16<false>>,
+  process_plane_avx2<uint16_t, rg_mode22_avx2_16<false>, RG_BLOCK_ROWS>,
   process_plane_avx2<uint16_t, rg_mode23_avx2_16<false>>,
   process_plane_avx2<uint16_t, rg_mode24_avx2_16<false>>,
 };
 
+// RgBench: the row blocked modes of avx2_functions_16_14 with one row per iteration, nullptr for the other modes
+PlaneProcessor* avx2_functions_16_14_rows1[] = {
+    nullptr, nullptr,
+  process_plane_avx2<uint16_t, rg_mode1_avx2_16<false>, 1>,
+  process_plane_avx2<uint16_t, rg_mode2_avx2_16<false>, 1>,
+  process_plane_avx2<uint16_t, rg_mode3_avx2_16<false>, 1>,
+  process_plane_avx2<uint16_t, rg_mode4_avx2_16<false>, 1>,
+    nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+  process_plane_avx2<uint16_t, rg_mode11_avx2_16<false>, 1>,
+  process_plane_avx2<uint16_t, rg_mode12_avx2_16<false>, 1>,
+    nullptr, nullptr, nullptr, nullptr,
+  process_plane_avx2<uint16_t, rg_mode17_avx2_16<false>, 1>,
+    nullptr,
+  process_plane_avx2<uint16_t, rg_mode19_avx2_16<false>, 1>,
+  process_plane_avx2<uint16_t, rg_mode20_avx2_16<false>, 1>,
+    nullptr,
+  process_plane_avx2<uint16_t, rg_mode22_avx2_16<false>, 1>,
+    nullptr, nullptr,
+};
+
 PlaneProcessor* avx2_functions_16_16[] = {
   doNothing,
   copyPlane,
-  process_plane_avx2<uint16_t, rg_mode1_avx2_16<false>>,
-  process_plane_avx2<uint16_t, rg_mode2_avx2_16<false>>,
-  process_plane_avx2<uint16_t, rg_mode3_avx2_16<false>>,
-  process_plane_avx2<uint16_t, rg_mode4_avx2_16<false>>,
+  process_plane_avx2<uint16_t, rg_mode1_avx2_16<false>, RG_BLOCK_ROWS>,
+  process_plane_avx2<uint16_t, rg_mode2_avx2_16<false>, RG_BLOCK_ROWS>,
+  process_plane_avx2<uint16_t, rg_mode3_avx2_16<false>, RG_BLOCK_ROWS>,
+  process_plane_avx2<uint16_t, rg_mode4_avx2_16<false>, RG_BLOCK_ROWS>,
   process_plane_avx2<uint16_t, rg_mode5_avx2_16<false>>,
   process_plane_avx2<uint16_t, rg_mode6_avx2_16<16, false>>,
   process_plane_avx2<uint16_t, rg_mode7_avx2_16<false>>,
   process_plane_avx2<uint16_t, rg_mode8_avx2_16<16, false>>,
   process_plane_avx2<uint16_t, rg_mode9_avx2_16<false>>,
   process_plane_avx2<uint16_t, rg_mode10_avx2_16<false>>,
-  process_plane_avx2<uint16_t, rg_mode11_avx2_16<false>>,
-  process_plane_avx2<uint16_t, rg_mode12_avx2_16<false>>,
+  process_plane_avx2<uint16_t, rg_mode11_avx2_16<false>, RG_BLOCK_ROWS>,
+  process_plane_avx2<uint16_t, rg_mode12_avx2_16<false>, RG_BLOCK_ROWS>,
   process_even_rows_avx2<uint16_t, rg_mode13_and14_avx2_16<false>>,
   process_odd_rows_avx2<uint16_t, rg_mode13_and14_avx2_16<false>>,
   process_even_rows_avx2<uint16_t, rg_mode15_and16_avx2_16<false>>,
   process_odd_rows_avx2<uint16_t, rg_mode15_and16_avx2_16<false>>,
-  process_plane_avx2<uint16_t, rg_mode17_avx2_16<false>>,
+  process_plane_avx2<uint16_t, rg_mode17_avx2_16<false>, RG_BLOCK_ROWS>,
   process_plane_avx2<uint16_t, rg_mode18_avx2_16<false>>,
-  process_plane_avx2<uint16_t, rg_mode19_avx2_16<false>>,
-  process_plane_avx2<uint16_t, rg_mode20_avx2_16<false>>,
+  process_plane_avx2<uint16_t, rg_mode19_avx2_16<false>, RG_BLOCK_ROWS>,
+  process_plane_avx2<uint16_t, rg_mode20_avx2_16<false>, RG_BLOCK_ROWS>,
   process_plane_avx2<uint16_t, rg_mode21_avx2_16<false>>,
-  process_plane_avx2<uint16_t, rg_mode22_avx2_16<false>>,
+  process_plane_avx2<uint16_t, rg_mode22_avx2_16<false>, RG_BLOCK_ROWS>,
   process_plane_avx2<uint16_t, rg_mode23_avx2_16<false>>,
   process_plane_avx2<uint16_t, rg_mode24_avx2_16<false>>,
 };
 
+// RgBench: the row blocked modes of avx2_functions_16_16 with one row per iteration, nullptr for the other modes
+PlaneProcessor* avx2_functions_16_16_rows1[] = {
+    nullptr, nullptr,
+  process_plane_avx2<uint16_t, rg_mode1_avx2_16<false>, 1>,
+  process_plane_avx2<uint16_t, rg_mode2_avx2_16<false>, 1>,
+  process_plane_avx2<uint16_t, rg_mode3_avx2_16<false>, 1>,
+  process_plane_avx2<uint16_t, rg_mode4_avx2_16<false>, 1>,
+    nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+  process_plane_avx2<uint16_t, rg_mode11_avx2_16<false>, 1>,
+  process_plane_avx2<uint16_t, rg_mode12_avx2_16<false>, 1>,
+    nullptr, nullptr, nullptr, nullptr,
+  process_plane_avx2<uint16_t, rg_mode17_avx2_16<false>, 1>,
+    nullptr,
+  process_plane_avx2<uint16_t, rg_mode19_avx2_16<false>, 1>,
+  process_plane_avx2<uint16_t, rg_mode20_avx2_16<false>, 1>,
+    nullptr,
+  process_plane_avx2<uint16_t, rg_mode22_avx2_16<false>, 1>,
+    nullptr, nullptr,
+};
+
 
 
 PlaneProcessor* avx2_functions_32[] = {
   doNothing,
   copyPlane,
-  process_plane_avx2<float, rg_mode1_avx2_32<false>>,
-  process_plane_avx2<float, rg_mode2_avx2_32<false>>,
-  process_plane_avx2<float, rg_mode3_avx2_32<false>>,
-  process_plane_avx2<float, rg_mode4_avx2_32<false>>,
+  process_plane_avx2<float, rg_mode1_avx2_32<false>, RG_BLOCK_ROWS>,
+  process_plane_avx2<float, rg_mode2_avx2_32<false>, RG_BLOCK_ROWS>,
+  process_plane_avx2<float, rg_mode3_avx2_32<false>, RG_BLOCK_ROWS>,
+  process_plane_avx2<float, rg_mode4_avx2_32<false>, RG_BLOCK_ROWS>,
   process_plane_avx2<float, rg_mode5_avx2_32<false>>,
   process_plane_avx2<float, rg_mode6_avx2_32<false>>,
   process_plane_avx2<float, rg_mode7_avx2_32<false>>,
   process_plane_avx2<float, rg_mode8_avx2_32<false>>,
   process_plane_avx2<float, rg_mode9_avx2_32<false>>,
   process_plane_avx2<float, rg_mode10_avx2_32<false>>,
-  process_plane_avx2<float, rg_mode11_avx2_32<false>>,
-  process_plane_avx2<float, rg_mode12_avx2_32<false>>,
+  process_plane_avx2<float, rg_mode11_avx2_32<false>, RG_BLOCK_ROWS>,
+  process_plane_avx2<float, rg_mode12_avx2_32<false>, RG_BLOCK_ROWS>,
   process_even_rows_avx2<float, rg_mode13_and14_avx2_32<false>>,
   process_odd_rows_avx2<float, rg_mode13_and14_avx2_32<false>>,
   process_even_rows_avx2<float, rg_mode15_and16_avx2_32<false>>,
   process_odd_rows_avx2<float, rg_mode15_and16_avx2_32<false>>,
-  process_plane_avx2<float, rg_mode17_avx2_32<false>>,
+  process_plane_avx2<float, rg_mode17_avx2_32<false>, RG_BLOCK_ROWS>,
   process_plane_avx2<float, rg_mode18_avx2_32<false>>,
-  process_plane_avx2<float, rg_mode19_avx2_32<false>>,
-  process_plane_avx2<float, rg_mode20_avx2_32<false>>,
+  process_plane_avx2<float, rg_mode19_avx2_32<false>, RG_BLOCK_ROWS>,
+  process_plane_avx2<float, rg_mode20_avx2_32<false>, RG_BLOCK_ROWS>,
   process_plane_avx2<float, rg_mode21_avx2_32<false>>,
-  process_plane_avx2<float, rg_mode22_avx2_32<false>>,
+  process_plane_avx2<float, rg_mode22_avx2_32<false>, RG_BLOCK_ROWS>,
   process_plane_avx2<float, rg_mode23_avx2_32<false>>,
   process_plane_avx2<float, rg_mode24_avx2_32<false>>,
 };
 
+// RgBench: the row blocked modes of avx2_functions_32 with one row per iteration, nullptr for the other modes
+PlaneProcessor* avx2_functions_32_rows1[] = {
+    nullptr, nullptr,
+  process_plane_avx2<float, rg_mode1_avx2_32<false>, 1>,
+  process_plane_avx2<float, rg_mode2_avx2_32<false>, 1>,
+  process_plane_avx2<float, rg_mode3_avx2_32<false>, 1>,
+  process_plane_avx2<float, rg_mode4_avx2_32<false>, 1>,
+    nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+  process_plane_avx2<float, rg_mode11_avx2_32<false>, 1>,
+  process_plane_avx2<float, rg_mode12_avx2_32<false>, 1>,
+    nullptr, nullptr, nullptr, nullptr,
+  process_plane_avx2<float, rg_mode17_avx2_32<false>, 1>,
+    nullptr,
+  process_plane_avx2<float, rg_mode19_avx2_32<false>, 1>,
+  process_plane_avx2<float, rg_mode20_avx2_32<false>, 1>,
+    nullptr,
+  process_plane_avx2<float, rg_mode22_avx2_32<false>, 1>,
+    nullptr, nullptr,
+};
+
+// AVX2 + FMA3, see rg_functions_fma.h
+PlaneProcessor* avx2_fma_functions_32[] = {
+  doNothing,
+  copyPlane,
+  process_plane_avx2<float, rg_mode1_avx2_32<false>, RG_BLOCK_ROWS>,
+  process_plane_avx2<float, rg_mode2_avx2_32<false>, RG_BLOCK_ROWS>,
+  process_plane_avx2<float, rg_mode3_avx2_32<false>, RG_BLOCK_ROWS>,
+  process_plane_avx2<float, rg_mode4_avx2_32<false>, RG_BLOCK_ROWS>,
+  process_plane_avx2<float, rg_mode5_avx2_32<false>>,
+  process_plane_avx2<float, rg_mode6_fma_32<false>>,
+  process_plane_avx2<float, rg_mode7_avx2_32<false>>,
+  process_plane_avx2<float, rg_mode8_fma_32<false>>,
+  process_plane_avx2<float, rg_mode9_avx2_32<false>>,
+  process_plane_avx2<float, rg_mode10_avx2_32<false>>,
+  process_plane_avx2<float, rg_mode11_and12_fma_32<false>, RG_BLOCK_ROWS>,
+  process_plane_avx2<float, rg_mode11_and12_fma_32<false>, RG_BLOCK_ROWS>,
+  process_even_rows_avx2<float, rg_mode13_and14_avx2_32<false>>,
+  process_odd_rows_avx2<float, rg_mode13_and14_avx2_32<false>>,
+  process_even_rows_avx2<float, rg_mode15_and16_fma_32<false>>,
+  process_odd_rows_avx2<float, rg_mode15_and16_fma_32<false>>,
+  process_plane_avx2<float, rg_mode17_avx2_32<false>, RG_BLOCK_ROWS>,
+  process_plane_avx2<float, rg_mode18_avx2_32<false>>,
+  process_plane_avx2<float, rg_mode19_fma_32<false>, RG_BLOCK_ROWS>,
+  process_plane_avx2<float, rg_mode20_fma_32<false>, RG_BLOCK_ROWS>,
+  process_plane_avx2<float, rg_mode21_and22_fma_32<false>>,
+  process_plane_avx2<float, rg_mode21_and22_fma_32<false>, RG_BLOCK_ROWS>,
+  process_plane_avx2<float, rg_mode23_avx2_32<false>>,
+  process_plane_avx2<float, rg_mode24_avx2_32<false>>,
+};
+
+// RgBench: the row blocked modes of avx2_fma_functions_32 with one row per iteration, nullptr for the other modes
+PlaneProcessor* avx2_fma_functions_32_rows1[] = {
+    nullptr, nullptr,
+  process_plane_avx2<float, rg_mode1_avx2_32<false>, 1>,
+  process_plane_avx2<float, rg_mode2_avx2_32<false>, 1>,
+  process_plane_avx2<float, rg_mode3_avx2_32<false>, 1>,
+  process_plane_avx2<float, rg_mode4_avx2_32<false>, 1>,
+    nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+  process_plane_avx2<float, rg_mode11_and12_fma_32<false>, 1>,
+  process_plane_avx2<float, rg_mode11_and12_fma_32<false>, 1>,
+    nullptr, nullptr, nullptr, nullptr,
+  process_plane_avx2<float, rg_mode17_avx2_32<false>, 1>,
+    nullptr,
+  process_plane_avx2<float, rg_mode19_fma_32<false>, 1>,
+  process_plane_avx2<float, rg_mode20_fma_32<false>, 1>,
+    nullptr,
+  process_plane_avx2<float, rg_mode21_and22_fma_32<false>, 1>,
+    nullptr, nullptr,
+};
+
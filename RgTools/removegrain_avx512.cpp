@@ -0,0 +1,341 @@
+#include "rg_functions_avx512.h"
+#include "removegrain.h"
+
+// AVX-512BW, see common_avx512.h. Same loops as removegrain_avx2.cpp on 64 byte vectors,
+// the partial first and last vector of a row are stored with a byte mask instead of
+// overlapping stores: every pixel is written once.
+
+// 'rows' (1 or 2) output rows per call, see process_column_sse in removegrain.cpp
+template<SseModeProcessor processor, int rows>
+static RG_FORCEINLINE void process_column_avx512(const Byte* pSrc, Byte* pDst, int srcPitch, int dstPitch, __mmask64 mask) {
+    __m512i r0 = processor(pSrc, srcPitch);
+    __m512i r1;
+    if (rows > 1) r1 = processor(pSrc + srcPitch, srcPitch);
+    if (mask == ~0ULL) {
+      _mm512_storeu_si512(reinterpret_cast<__m512i*>(pDst), r0);
+      if (rows > 1) _mm512_storeu_si512(reinterpret_cast<__m512i*>(pDst + dstPitch), r1);
+    } else {
+      simd_mask_storeu(pDst, mask, r0);
+      if (rows > 1) simd_mask_storeu(pDst + dstPitch, mask, r1);
+    }
+}
+
+// inner pixels of 'rows' rows, width >= one vector + 2
+template<typename pixel_t, SseModeProcessor processor, int rows>
+static RG_FORCEINLINE void process_inner_avx512(const Byte* pSrc, Byte* pDst, int srcPitch, int dstPitch, int width) {
+    const int pixels_at_a_time = 64 / sizeof(pixel_t);
+    const int mod_width = width / pixels_at_a_time * pixels_at_a_time;
+
+    // pixels 1 .. pixels_at_a_time-1, the last lane belongs to the loop below
+    process_column_avx512<processor, rows>(pSrc + sizeof(pixel_t), pDst + sizeof(pixel_t), srcPitch, dstPitch, first_bytes_mask((pixels_at_a_time - 1) * sizeof(pixel_t)));
+
+    for (int x = pixels_at_a_time; x < mod_width - 1; x += pixels_at_a_time) {
+      process_column_avx512<processor, rows>(pSrc + x * sizeof(pixel_t), pDst + x * sizeof(pixel_t), srcPitch, dstPitch, ~0ULL);
+    }
+
+    if (mod_width < width - 1) {
+      // last vector ends at pixel width-2, only the lanes after mod_width are new
+      const int x = width - 1 - pixels_at_a_time;
+      process_column_avx512<processor, rows>(pSrc + x * sizeof(pixel_t), pDst + x * sizeof(pixel_t), srcPitch, dstPitch, from_byte_mask((mod_width - x) * sizeof(pixel_t)));
+    }
+}
+
+template<typename pixel_t, SseModeProcessor processor, int rows>
+static RG_FORCEINLINE void process_rows_avx512(const Byte* pSrc, Byte* pDst, int srcPitch, int dstPitch, int width) {
+    const int pixels_at_a_time = 64 / sizeof(pixel_t);
+
+    for (int r = 0; r < rows; ++r)
+      reinterpret_cast<pixel_t*>(pDst + r * dstPitch)[0] = reinterpret_cast<const pixel_t*>(pSrc + r * srcPitch)[0];
+
+    if (width < pixels_at_a_time + 2) {
+      // narrow plane: one partial vector on a staged copy of the rows
+      for (int r = 0; r < rows && width > 2; ++r)
+        process_row_staged<pixel_t>(pDst + r * dstPitch, pSrc + r * srcPitch, srcPitch, width, processor);
+    } else {
+      process_inner_avx512<pixel_t, processor, rows>(pSrc, pDst, srcPitch, dstPitch, width);
+    }
+
+    for (int r = 0; r < rows; ++r)
+      reinterpret_cast<pixel_t*>(pDst + r * dstPitch)[width - 1] = reinterpret_cast<const pixel_t*>(pSrc + r * srcPitch)[width - 1];
+}
+
+template<typename pixel_t, SseModeProcessor processor, int rows = 1>
+static void process_plane_avx512(IScriptEnvironment* env, const BYTE* pSrc, BYTE* pDst, int rowsize, int height, int srcPitch, int dstPitch) {
+    _mm256_zeroupper();
+
+    env->BitBlt(pDst, dstPitch, pSrc, srcPitch, rowsize, 1);
+
+    const int width = rowsize / sizeof(pixel_t);
+
+    pSrc += srcPitch;
+    pDst += dstPitch;
+
+    int y = 1;
+    for (; y + rows <= height - 1; y += rows) {
+      process_rows_avx512<pixel_t, processor, rows>(pSrc, pDst, srcPitch, dstPitch, width);
+      pSrc += srcPitch * rows;
+      pDst += dstPitch * rows;
+    }
+    for (; y < height - 1; ++y) {
+      process_rows_avx512<pixel_t, processor, 1>(pSrc, pDst, srcPitch, dstPitch, width);
+      pSrc += srcPitch;
+      pDst += dstPitch;
+    }
+    _mm256_zeroupper();
+
+    env->BitBlt(pDst, dstPitch, pSrc, srcPitch, rowsize, 1);
+}
+
+
+template<typename pixel_t, SseModeProcessor processor>
+static void process_halfplane_avx512(IScriptEnvironment* env, const BYTE* pSrc8, BYTE* pDst8, int rowsize, int height, int srcPitch, int dstPitch) {
+  _mm256_zeroupper();
+
+  pixel_t *pDst = reinterpret_cast<pixel_t *>(pDst8);
+  const pixel_t *pSrc = reinterpret_cast<const pixel_t *>(pSrc8);
+
+  dstPitch /= sizeof(pixel_t);
+  const int srcPitchOrig = srcPitch;
+  srcPitch /= sizeof(pixel_t);
+
+  const int width = rowsize / sizeof(pixel_t);
+  const int pixels_at_a_time = 64 / sizeof(pixel_t);
+
+  pSrc += srcPitch;
+  pDst += dstPitch;
+
+  for (int y = 1; y < height/2; ++y) {
+    pDst[0] = (pSrc[srcPitch] + pSrc[-srcPitch] + (sizeof(pixel_t) == 4 ? 0 : 1)) / 2; // float: no +1 rounding
+
+    if (width < pixels_at_a_time + 2) {
+      if (width > 2)
+        process_row_staged<pixel_t>((uint8_t *)pDst, (const uint8_t *)pSrc, srcPitchOrig, width, processor);
+    } else {
+      process_inner_avx512<pixel_t, processor, 1>((const uint8_t *)pSrc, (uint8_t *)pDst, srcPitchOrig, 0, width);
+    }
+
+    pDst[width-1] = (pSrc[width-1 + srcPitch] + pSrc[width-1 - srcPitch] + (sizeof(pixel_t) == 4 ? 0 : 1)) / 2; // float: no +1 rounding
+    pSrc += srcPitch;
+    pDst += dstPitch;
+
+    _mm256_zeroupper();
+
+    env->BitBlt((uint8_t *)(pDst), dstPitch*sizeof(pixel_t), (uint8_t *)(pSrc), srcPitch*sizeof(pixel_t), rowsize, 1); //other field
+
+    pSrc += srcPitch;
+    pDst += dstPitch;
+  }
+}
+
+template<typename pixel_t, SseModeProcessor processor>
+static void process_even_rows_avx512(IScriptEnvironment* env, const BYTE* pSrc, BYTE* pDst, int rowsize, int height, int srcPitch, int dstPitch) {
+    _mm256_zeroupper(); // paranoia
+    env->BitBlt(pDst, dstPitch, pSrc, srcPitch, rowsize, 2); //copy first two lines
+
+    process_halfplane_avx512<pixel_t, processor>(env, pSrc+srcPitch, pDst+dstPitch, rowsize, height, srcPitch, dstPitch);
+
+    if (height & 1) // odd height: the last row is beyond the half plane loop
+      env->BitBlt(pDst+dstPitch*(height-1), dstPitch, pSrc+srcPitch*(height-1), srcPitch, rowsize, 1);
+}
+
+template<typename pixel_t, SseModeProcessor processor>
+static void process_odd_rows_avx512(IScriptEnvironment* env, const BYTE* pSrc, BYTE* pDst, int rowsize, int height, int srcPitch, int dstPitch) {
+    _mm256_zeroupper();  // paranoia
+    env->BitBlt(pDst, dstPitch, pSrc, srcPitch, rowsize, 1); //top border
+
+    process_halfplane_avx512<pixel_t, processor>(env, pSrc, pDst, rowsize, height, srcPitch, dstPitch);
+
+    if (height & 1) // odd height: the half plane loop stops one row above the bottom border
+      env->BitBlt(pDst+dstPitch*(height-2), dstPitch, pSrc+srcPitch*(height-2), srcPitch, rowsize, 1);
+
+    env->BitBlt(pDst+dstPitch*(height-1), dstPitch, pSrc+srcPitch*(height-1), srcPitch, rowsize, 1); //bottom border
+}
+
+static void doNothing(IScriptEnvironment* env, const BYTE* pSrc, BYTE* pDst, int rowsize, int height, int srcPitch, int dstPitch) {
+
+}
+
+static void copyPlane(IScriptEnvironment* env, const BYTE* pSrc, BYTE* pDst, int rowsize, int height, int srcPitch, int dstPitch) {
+  _mm256_zeroupper(); // paranoia
+  env->BitBlt(pDst, dstPitch, pSrc, srcPitch, rowsize, height);
+}
+
+
+PlaneProcessor* avx512_functions[] = {
+    doNothing,
+    copyPlane,
+    process_plane_avx512<uint8_t, rg_mode1_avx512<false>, RG_BLOCK_ROWS>,
+    process_plane_avx512<uint8_t, rg_mode2_avx512<false>, RG_BLOCK_ROWS>,
+    process_plane_avx512<uint8_t, rg_mode3_avx512<false>, RG_BLOCK_ROWS>,
+    process_plane_avx512<uint8_t, rg_mode4_avx512<false>, RG_BLOCK_ROWS>,
+    process_plane_avx512<uint8_t, rg_mode5_avx512<false>>,
+    process_plane_avx512<uint8_t, rg_mode6_avx512<false>>,
+    process_plane_avx512<uint8_t, rg_mode7_avx512<false>>,
+    process_plane_avx512<uint8_t, rg_mode8_avx512<false>>,
+    process_plane_avx512<uint8_t, rg_mode9_avx512<false>>,
+    process_plane_avx512<uint8_t, rg_mode10_avx512<false>>,
+    process_plane_avx512<uint8_t, rg_mode11_avx512<false>, RG_BLOCK_ROWS>,
+    process_plane_avx512<uint8_t, rg_mode12_avx512<false>, RG_BLOCK_ROWS>,
+    process_even_rows_avx512<uint8_t, rg_mode13_and14_avx512<false>>,
+    process_odd_rows_avx512<uint8_t, rg_mode13_and14_avx512<false>>,
+    process_even_rows_avx512<uint8_t, rg_mode15_and16_avx512<false>>,
+    process_odd_rows_avx512<uint8_t, rg_mode15_and16_avx512<false>>,
+    process_plane_avx512<uint8_t, rg_mode17_avx512<false>, RG_BLOCK_ROWS>,
+    process_plane_avx512<uint8_t, rg_mode18_avx512<false>>,
+    process_plane_avx512<uint8_t, rg_mode19_avx512<false>, RG_BLOCK_ROWS>,
+    process_plane_avx512<uint8_t, rg_mode20_avx512<false>, RG_BLOCK_ROWS>,
+    process_plane_avx512<uint8_t, rg_mode21_avx512<false>>,
+    process_plane_avx512<uint8_t, rg_mode22_avx512<false>, RG_BLOCK_ROWS>,
+    process_plane_avx512<uint8_t, rg_mode23_avx512<false>>,
+    process_plane_avx512<uint8_t, rg_mode24_avx512<false>>,
+};
+
+
+PlaneProcessor* avx512_functions_16_10[] = {
+  doNothing,
+  copyPlane,
+  process_plane_avx512<uint16_t, rg_mode1_avx512_16<false>, RG_BLOCK_ROWS>,
+  process_plane_avx512<uint16_t, rg_mode2_avx512_16<false>, RG_BLOCK_ROWS>,
+  process_plane_avx512<uint16_t, rg_mode3_avx512_16<false>, RG_BLOCK_ROWS>,
+  process_plane_avx512<uint16_t, rg_mode4_avx512_16<false>, RG_BLOCK_ROWS>,
+  process_plane_avx512<uint16_t, rg_mode5_avx512_16<false>>,
+  process_plane_avx512<uint16_t, rg_mode6_avx512_16<10, false>>,
+  process_plane_avx512<uint16_t, rg_mode7_avx512_16<false>>,
+  process_plane_avx512<uint16_t, rg_mode8_avx512_16<10, false>>,
+  process_plane_avx512<uint16_t, rg_mode9_avx512_16<false>>,
+  process_plane_avx512<uint16_t, rg_mode10_avx512_16<false>>,
+  process_plane_avx512<uint16_t, rg_mode11_avx512_16<false>, RG_BLOCK_ROWS>,
+  process_plane_avx512<uint16_t, rg_mode12_avx512_16<false>, RG_BLOCK_ROWS>,
+  process_even_rows_avx512<uint16_t, rg_mode13_and14_avx512_16<false>>,
+  process_odd_rows_avx512<uint16_t, rg_mode13_and14_avx512_16<false>>,
+  process_even_rows_avx512<uint16_t, rg_mode15_and16_avx512_16<false>>,
+  process_odd_rows_avx512<uint16_t, rg_mode15_and16_avx512_16<false>>,
+  process_plane_avx512<uint16_t, rg_mode17_avx512_16<false>, RG_BLOCK_ROWS>,
+  process_plane_avx512<uint16_t, rg_mode18_avx512_16<false>>,
+  process_plane_avx512<uint16_t, rg_mode19_avx512_16<false>, RG_BLOCK_ROWS>,
+  process_plane_avx512<uint16_t, rg_mode20_avx512_16<false>, RG_BLOCK_ROWS>,
+  process_plane_avx512<uint16_t, rg_mode21_avx512_16<false>>,
+  process_plane_avx512<uint16_t, rg_mode22_avx512_16<false>, RG_BLOCK_ROWS>,
+  process_plane_avx512<uint16_t, rg_mode23_avx512_16<false>>,
+  process_plane_avx512<uint16_t, rg_mode24_avx512_16<false>>,
+};
+
+PlaneProcessor* avx512_functions_16_12[] = {
+  doNothing,
+  copyPlane,
+  process_plane_avx512<uint16_t, rg_mode1_avx512_16<false>, RG_BLOCK_ROWS>,
+  process_plane_avx512<uint16_t, rg_mode2_avx512_16<false>, RG_BLOCK_ROWS>,
+  process_plane_avx512<uint16_t, rg_mode3_avx512_16<false>, RG_BLOCK_ROWS>,
+  process_plane_avx512<uint16_t, rg_mode4_avx512_16<false>, RG_BLOCK_ROWS>,
+  process_plane_avx512<uint16_t, rg_mode5_avx512_16<false>>,
+  process_plane_avx512<uint16_t, rg_mode6_avx512_16<12, false>>,
+  process_plane_avx512<uint16_t, rg_mode7_avx512_16<false>>,
+  process_plane_avx512<uint16_t, rg_mode8_avx512_16<12, false>>,
+  process_plane_avx512<uint16_t, rg_mode9_avx512_16<false>>,
+  process_plane_avx512<uint16_t, rg_mode10_avx512_16<false>>,
+  process_plane_avx512<uint16_t, rg_mode11_avx512_16<false>, RG_BLOCK_ROWS>,
+  process_plane_avx512<uint16_t, rg_mode12_avx512_16<false>, RG_BLOCK_ROWS>,
+  process_even_rows_avx512<uint16_t, rg_mode13_and14_avx512_16<false>>,
+  process_odd_rows_avx512<uint16_t, rg_mode13_and14_avx512_16<false>>,
+  process_even_rows_avx512<uint16_t, rg_mode15_and16_avx512_16<false>>,
+  process_odd_rows_avx512<uint16_t, rg_mode15_and16_avx512_16<false>>,
+  process_plane_avx512<uint16_t, rg_mode17_avx512_16<false>, RG_BLOCK_ROWS>,
+  process_plane_avx512<uint16_t, rg_mode18_avx512_16<false>>,
+  process_plane_avx512<uint16_t, rg_mode19_avx512_16<false>, RG_BLOCK_ROWS>,
+  process_plane_avx512<uint16_t, rg_mode20_avx512_16<false>, RG_BLOCK_ROWS>,
+  process_plane_avx512<uint16_t, rg_mode21_avx512_16<false>>,
+  process_plane_avx512<uint16_t, rg_mode22_avx512_16<false>, RG_BLOCK_ROWS>,
+  process_plane_avx512<uint16_t, rg_mode23_avx512_16<false>>,
+  process_plane_avx512<uint16_t, rg_mode24_avx512_16<false>>,
+};
+
+PlaneProcessor* avx512_functions_16_14[] = {
+  doNothing,
+  copyPlane,
+  process_plane_avx512<uint16_t, rg_mode1_avx512_16<false>, RG_BLOCK_ROWS>,
+  process_plane_avx512<uint16_t, rg_mode2_avx512_16<false>, RG_BLOCK_ROWS>,
+  process_plane_avx512<uint16_t, rg_mode3_avx512_16<false>, RG_BLOCK_ROWS>,
+  process_plane_avx512<uint16_t, rg_mode4_avx512_16<false>, RG_BLOCK_ROWS>,
+  process_plane_avx512<uint16_t, rg_mode5_avx512_16<false>>,
+  process_plane_avx512<uint16_t, rg_mode6_avx512_16<14, false>>,
+  process_plane_avx512<uint16_t, rg_mode7_avx512_16<false>>,
+  process_plane_avx512<uint16_t, rg_mode8_avx512_16<14, false>>,
+  process_plane_avx512<uint16_t, rg_mode9_avx512_16<false>>,
+  process_plane_avx512<uint16_t, rg_mode10_avx512_16<false>>,
+  process_plane_avx512<uint16_t, rg_mode11_avx512_16<false>, RG_BLOCK_ROWS>,
+  process_plane_avx512<uint16_t, rg_mode12_avx512_16<false>, RG_BLOCK_ROWS>,
+  process_even_rows_avx512<uint16_t, rg_mode13_and14_avx512_16<false>>,
+  process_odd_rows_avx512<uint16_t, rg_mode13_and14_avx512_16<false>>,
+  process_even_rows_avx512<uint16_t, rg_mode15_and16_avx512_16<false>>,
+  process_odd_rows_avx512<uint16_t, rg_mode15_and16_avx512_16<false>>,
+  process_plane_avx512<uint16_t, rg_mode17_avx512_16<false>, RG_BLOCK_ROWS>,
+  process_plane_avx512<uint16_t, rg_mode18_avx512_16<false>>,
+  process_plane_avx512<uint16_t, rg_mode19_avx512_16<false>, RG_BLOCK_ROWS>,
+  process_plane_avx512<uint16_t, rg_mode20_avx512_16<false>, RG_BLOCK_ROWS>,
+  process_plane_avx512<uint16_t, rg_mode21_avx512_16<false>>,
+  process_plane_avx512<uint16_t, rg_mode22_avx512_16<false>, RG_BLOCK_ROWS>,
+  process_plane_avx512<uint16_t, rg_mode23_avx512_16<false>>,
+  process_plane_avx512<uint16_t, rg_mode24_avx512_16<false>>,
+};
+
+PlaneProcessor* avx512_functions_16_16[] = {
+  doNothing,
+  copyPlane,
+  process_plane_avx512<uint16_t, rg_mode1_avx512_16<false>, RG_BLOCK_ROWS>,
+  process_plane_avx512<uint16_t, rg_mode2_avx512_16<false>, RG_BLOCK_ROWS>,
+  process_plane_avx512<uint16_t, rg_mode3_avx512_16<false>, RG_BLOCK_ROWS>,
+  process_plane_avx512<uint16_t, rg_mode4_avx512_16<false>, RG_BLOCK_ROWS>,
+  process_plane_avx512<uint16_t, rg_mode5_avx512_16<false>>,
+  process_plane_avx512<uint16_t, rg_mode6_avx512_16<16, false>>,
+  process_plane_avx512<uint16_t, rg_mode7_avx512_16<false>>,
+  process_plane_avx512<uint16_t, rg_mode8_avx512_16<16, false>>,
+  process_plane_avx512<uint16_t, rg_mode9_avx512_16<false>>,
+  process_plane_avx512<uint16_t, rg_mode10_avx512_16<false>>,
+  process_plane_avx512<uint16_t, rg_mode11_avx512_16<false>, RG_BLOCK_ROWS>,
+  process_plane_avx512<uint16_t, rg_mode12_avx512_16<false>, RG_BLOCK_ROWS>,
+  process_even_rows_avx512<uint16_t, rg_mode13_and14_avx512_16<false>>,
+  process_odd_rows_avx512<uint16_t, rg_mode13_and14_avx512_16<false>>,
+  process_even_rows_avx512<uint16_t, rg_mode15_and16_avx512_16<false>>,
+  process_odd_rows_avx512<uint16_t, rg_mode15_and16_avx512_16<false>>,
+  process_plane_avx512<uint16_t, rg_mode17_avx512_16<false>, RG_BLOCK_ROWS>,
+  process_plane_avx512<uint16_t, rg_mode18_avx512_16<false>>,
+  process_plane_avx512<uint16_t, rg_mode19_avx512_16<false>, RG_BLOCK_ROWS>,
+  process_plane_avx512<uint16_t, rg_mode20_avx512_16<false>, RG_BLOCK_ROWS>,
+  process_plane_avx512<uint16_t, rg_mode21_avx512_16<false>>,
+  process_plane_avx512<uint16_t, rg_mode22_avx512_16<false>, RG_BLOCK_ROWS>,
+  process_plane_avx512<uint16_t, rg_mode23_avx512_16<false>>,
+  process_plane_avx512<uint16_t, rg_mode24_avx512_16<false>>,
+};
+
+
+
+// float: the FMA kernels, see rg_functions_fma.h
+PlaneProcessor* avx512_functions_32[] = {
+  doNothing,
+  copyPlane,
+  process_plane_avx512<float, rg_mode1_avx512_32<false>, RG_BLOCK_ROWS>,
+  process_plane_avx512<float, rg_mode2_avx512_32<false>, RG_BLOCK_ROWS>,
+  process_plane_avx512<float, rg_mode3_avx512_32<false>, RG_BLOCK_ROWS>,
+  process_plane_avx512<float, rg_mode4_avx512_32<false>, RG_BLOCK_ROWS>,
+  process_plane_avx512<float, rg_mode5_avx512_32<false>>,
+  process_plane_avx512<float, rg_mode6_avx512_32<false>>,
+  process_plane_avx512<float, rg_mode7_avx512_32<false>>,
+  process_plane_avx512<float, rg_mode8_avx512_32<false>>,
+  process_plane_avx512<float, rg_mode9_avx512_32<false>>,
+  process_plane_avx512<float, rg_mode10_avx512_32<false>>,
+  process_plane_avx512<float, rg_mode11_and12_avx512_32<false>, RG_BLOCK_ROWS>,
+  process_plane_avx512<float, rg_mode11_and12_avx512_32<false>, RG_BLOCK_ROWS>,
+  process_even_rows_avx512<float, rg_mode13_and14_avx512_32<false>>,
+  process_odd_rows_avx512<float, rg_mode13_and14_avx512_32<false>>,
+  process_even_rows_avx512<float, rg_mode15_and16_avx512_32<false>>,
+  process_odd_rows_avx512<float, rg_mode15_and16_avx512_32<false>>,
+  process_plane_avx512<float, rg_mode17_avx512_32<false>, RG_BLOCK_ROWS>,
+  process_plane_avx512<float, rg_mode18_avx512_32<false>>,
+  process_plane_avx512<float, rg_mode19_avx512_32<false>, RG_BLOCK_ROWS>,
+  process_plane_avx512<float, rg_mode20_avx512_32<false>, RG_BLOCK_ROWS>,
+  process_plane_avx512<float, rg_mode21_and22_avx512_32<false>>,
+  process_plane_avx512<float, rg_mode21_and22_avx512_32<false>, RG_BLOCK_ROWS>,
+  process_plane_avx512<float, rg_mode23_avx512_32<false>>,
+  process_plane_avx512<float, rg_mode24_avx512_32<false>>,
+};
+
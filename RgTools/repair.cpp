@@ -1,59 +1,99 @@
 #include "repair_functions_c.h"
 #include "repair_functions_sse.h"
+#include "colsort.h"
 #include "repair.h"
+#include "autotune.h"
+#include "inplace.h"
+
+
+// 'rows' (1 or 2) output rows per call, see process_column_sse in removegrain.cpp:
+// the reference rows shared by both output rows are loaded once
+template<SseModeProcessor processor, InstructionSet optLevel, int rows, bool aligned, bool aligned_src>
+static RG_FORCEINLINE void process_column_sse(Byte* pDst, const Byte* pSrc, const Byte* pRef, int dstPitch, int srcPitch, int refPitch) {
+    __m128i val0 = aligned_src ? simd_loada_si128<optLevel>(pSrc) : simd_loadu_si128<optLevel>(pSrc);
+    __m128i r0 = processor(pRef, val0, refPitch);
+    __m128i r1;
+    if (rows > 1) {
+        __m128i val1 = aligned_src ? simd_loada_si128<optLevel>(pSrc + srcPitch) : simd_loadu_si128<optLevel>(pSrc + srcPitch);
+        r1 = processor(pRef + refPitch, val1, refPitch);
+    }
+    simd_store_si128<aligned>(pDst, r0);
+    if (rows > 1) simd_store_si128<aligned>(pDst + dstPitch, r1);
+}
 
-
-template<typename pixel_t, SseModeProcessor processor, SseModeProcessor processor_a, InstructionSet optLevel>
-static void process_plane_sse(IScriptEnvironment* env, BYTE* pDst8, const BYTE* pSrc8, const BYTE* pRef8, int dstPitch, int srcPitch, int refPitch, int rowsize, int height) {
-    env->BitBlt(pDst8, dstPitch, pSrc8, srcPitch, rowsize, 1);
-
-    pixel_t *pDst = reinterpret_cast<pixel_t *>(pDst8);
-    const pixel_t *pSrc = reinterpret_cast<const pixel_t *>(pSrc8);
-    const pixel_t *pRef = reinterpret_cast<const pixel_t *>(pRef8);
-
-    dstPitch /= sizeof(pixel_t);
-    const int refPitchOrig = refPitch;
-    refPitch /= sizeof(pixel_t);
-    srcPitch /= sizeof(pixel_t);
-
-    const int width = rowsize / sizeof(pixel_t);
+template<typename pixel_t, SseModeProcessor processor, SseModeProcessor processor_a, InstructionSet optLevel, bool aligned, int rows>
+static RG_FORCEINLINE void process_rows_sse(Byte* pDst, const Byte* pSrc, const Byte* pRef, int dstPitch, int srcPitch, int refPitch, int width) {
     const int pixels_at_at_time = 16 / sizeof(pixel_t);
-
-    pSrc += srcPitch;
-    pDst += dstPitch;
-    pRef += refPitch;
-    int mod_width = width / pixels_at_at_time * pixels_at_at_time;
-
-    for (int y = 1; y < height-1; ++y) {
-        pDst[0] = pSrc[0];
-
+    const int mod_width = width / pixels_at_at_time * pixels_at_at_time;
+
+    for (int r = 0; r < rows; ++r)
+        reinterpret_cast<pixel_t*>(pDst + r * dstPitch)[0] = reinterpret_cast<const pixel_t*>(pSrc + r * srcPitch)[0];
+
+    if (width < pixels_at_at_time + 2) {
+        // narrow plane: one partial vector on staged copies of the rows
+        for (int r = 0; r < rows && width > 2; ++r) {
+            const Byte* pSrcRow = pSrc + r * srcPitch;
+            process_row_staged<pixel_t>(pDst + r * dstPitch, pRef + r * refPitch, refPitch, width, [&](const Byte* pStage, int stagePitch) {
+                alignas(64) Byte val[RG_STAGE_PITCH] = {};
+                memcpy(val, pSrcRow, width * sizeof(pixel_t));
+                return processor(pStage, simd_loadu_si128<optLevel>(val + sizeof(pixel_t)), stagePitch);
+            });
+        }
+    } else {
         // unaligned first 16 bytes, last pixel overlaps with the next aligned loop
-        __m128i val = simd_loadu_si128<optLevel>((uint8_t *)(pSrc+1));
-        __m128i result = processor((uint8_t *)(pRef+1), val, refPitchOrig);
-        _mm_storeu_si128(reinterpret_cast<__m128i*>(pDst+1), result);
+        process_column_sse<processor, optLevel, rows, false, false>(pDst + sizeof(pixel_t), pSrc + sizeof(pixel_t), pRef + sizeof(pixel_t), dstPitch, srcPitch, refPitch);
 
-        //aligned
+        //aligned, unless the plane is cropped
         for (int x = pixels_at_at_time; x < mod_width-1; x+= pixels_at_at_time) {
-            __m128i val = simd_loada_si128<optLevel>((uint8_t *)(pSrc+x));
-            __m128i result = processor_a((uint8_t *)(pRef+x), val, refPitchOrig);
-            _mm_store_si128(reinterpret_cast<__m128i*>(pDst+x), result);
+            const int offset = x * sizeof(pixel_t);
+            process_column_sse<processor_a, optLevel, rows, aligned, aligned>(pDst + offset, pSrc + offset, pRef + offset, dstPitch, srcPitch, refPitch);
         }
 
         if (mod_width != width) {
-            __m128i val = simd_loadu_si128<optLevel>((uint8_t *)(pSrc + width - 1 - pixels_at_at_time));
-            __m128i result = processor((uint8_t *)(pRef + width - 1 - pixels_at_at_time), val, refPitchOrig);
-            _mm_storeu_si128(reinterpret_cast<__m128i*>((uint8_t *)(pDst + width - 1 - pixels_at_at_time)), result);
+            const int offset = (width - 1 - pixels_at_at_time) * sizeof(pixel_t);
+            process_column_sse<processor, optLevel, rows, false, false>(pDst + offset, pSrc + offset, pRef + offset, dstPitch, srcPitch, refPitch);
         }
+    }
+
+    for (int r = 0; r < rows; ++r)
+        reinterpret_cast<pixel_t*>(pDst + r * dstPitch)[width-1] = reinterpret_cast<const pixel_t*>(pSrc + r * srcPitch)[width-1];
+}
 
+template<typename pixel_t, SseModeProcessor processor, SseModeProcessor processor_a, InstructionSet optLevel, bool aligned, int rows>
+static void process_plane_sse_impl(IScriptEnvironment* env, BYTE* pDst, const BYTE* pSrc, const BYTE* pRef, int dstPitch, int srcPitch, int refPitch, int rowsize, int height) {
+    env->BitBlt(pDst, dstPitch, pSrc, srcPitch, rowsize, 1);
 
-        pDst[width-1] = pSrc[width-1];
+    const int width = rowsize / sizeof(pixel_t);
+
+    pSrc += srcPitch;
+    pDst += dstPitch;
+    pRef += refPitch;
 
+    int y = 1;
+    for (; y + rows <= height-1; y += rows) {
+        process_rows_sse<pixel_t, processor, processor_a, optLevel, aligned, rows>(pDst, pSrc, pRef, dstPitch, srcPitch, refPitch, width);
+        pSrc += srcPitch * rows;
+        pDst += dstPitch * rows;
+        pRef += refPitch * rows;
+    }
+    for (; y < height-1; ++y) {
+        process_rows_sse<pixel_t, processor, processor_a, optLevel, aligned, 1>(pDst, pSrc, pRef, dstPitch, srcPitch, refPitch, width);
         pSrc += srcPitch;
         pDst += dstPitch;
         pRef += refPitch;
     }
 
-    env->BitBlt((uint8_t *)(pDst), dstPitch*sizeof(pixel_t), (uint8_t *)(pSrc), srcPitch*sizeof(pixel_t), rowsize, 1);
+    env->BitBlt(pDst, dstPitch, pSrc, srcPitch, rowsize, 1);
+}
+
+// rows > 1 only pays off for the modes that are bound by loads
+template<typename pixel_t, SseModeProcessor processor, SseModeProcessor processor_a, InstructionSet optLevel, int rows = 1>
+static void process_plane_sse(IScriptEnvironment* env, BYTE* pDst8, const BYTE* pSrc8, const BYTE* pRef8, int dstPitch, int srcPitch, int refPitch, int rowsize, int height) {
+    // unaligned crop: same loop with unaligned loads and stores
+    if (is_16byte_aligned_plane(pDst8, dstPitch) && is_16byte_aligned_plane(pSrc8, srcPitch) && is_16byte_aligned_plane(pRef8, refPitch))
+        process_plane_sse_impl<pixel_t, processor, processor_a, optLevel, true, rows>(env, pDst8, pSrc8, pRef8, dstPitch, srcPitch, refPitch, rowsize, height);
+    else
+        process_plane_sse_impl<pixel_t, processor, processor, optLevel, false, rows>(env, pDst8, pSrc8, pRef8, dstPitch, srcPitch, refPitch, rowsize, height);
 }
 
 template<typename pixel_t, CModeProcessor<pixel_t> processor>
@@ -68,7 +108,7 @@ static void process_plane_c(IScriptEnvironment* env, BYTE* pDst, const BYTE* pSr
   for (int y = 1; y < height-1; ++y) {
     reinterpret_cast<pixel_t *>(pDst)[0] = reinterpret_cast<const pixel_t *>(pSrc)[0];
     for (int x = 1; x < width-1; x+=1) {
-      pixel_t result = processor(pRef + x*sizeof(pixel_t), reinterpret_cast<const pixel_t *>(pSrc)[x], srcPitch);
+      pixel_t result = processor(pRef + x*sizeof(pixel_t), reinterpret_cast<const pixel_t *>(pSrc)[x], refPitch);
       reinterpret_cast<pixel_t *>(pDst)[x] = result;
     }
     reinterpret_cast<pixel_t *>(pDst)[width-1] = reinterpret_cast<const pixel_t *>(pSrc)[width-1];
@@ -91,26 +131,29 @@ static void copyPlane(IScriptEnvironment* env, BYTE* pDst, const BYTE* pSrc, con
 }
 
 
+// the tables share their names with the RemoveGrain ones, GCC does not put the type into a variable's symbol like MSVC
+namespace repair {
+
 RepairPlaneProcessor* sse3_functions[] = {
     doNothing,
     copyPlane,
-    process_plane_sse<uint8_t, repair_mode1_sse<false, SSE3>, repair_mode1_sse<true, SSE3>, SSE3>,
-    process_plane_sse<uint8_t, repair_mode2_sse<false, SSE3>, repair_mode2_sse<true, SSE3>, SSE3>,
-    process_plane_sse<uint8_t, repair_mode3_sse<false, SSE3>, repair_mode3_sse<true, SSE3>, SSE3>,
-    process_plane_sse<uint8_t, repair_mode4_sse<false, SSE3>, repair_mode4_sse<true, SSE3>, SSE3>,
+    process_plane_sse<uint8_t, repair_mode1_sse<false, SSE3>, repair_mode1_sse<true, SSE3>, SSE3, RG_BLOCK_ROWS>,
+    process_plane_colsort<ColsortSse8<SSE3>, CS_RANK1>,
+    process_plane_colsort<ColsortSse8<SSE3>, CS_RANK2>,
+    process_plane_colsort<ColsortSse8<SSE3>, CS_RANK3>,
     process_plane_sse<uint8_t, repair_mode5_sse<false, SSE3>, repair_mode5_sse<true, SSE3>, SSE3>, 
     process_plane_sse<uint8_t, repair_mode6_sse<false, SSE3>, repair_mode6_sse<true, SSE3>, SSE3>, 
     process_plane_sse<uint8_t, repair_mode7_sse<false, SSE3>, repair_mode7_sse<true, SSE3>, SSE3>, 
     process_plane_sse<uint8_t, repair_mode8_sse<false, SSE3>, repair_mode8_sse<true, SSE3>, SSE3>, 
     process_plane_sse<uint8_t, repair_mode9_sse<false, SSE3>, repair_mode9_sse<true, SSE3>, SSE3>, 
     process_plane_sse<uint8_t, repair_mode10_sse<false, SSE3>, repair_mode10_sse<true, SSE3>, SSE3>,
-    process_plane_sse<uint8_t, repair_mode1_sse<false, SSE3>, repair_mode1_sse<true, SSE3>, SSE3>,
+    process_plane_sse<uint8_t, repair_mode1_sse<false, SSE3>, repair_mode1_sse<true, SSE3>, SSE3, RG_BLOCK_ROWS>,
     process_plane_sse<uint8_t, repair_mode12_sse<false, SSE3>, repair_mode12_sse<true, SSE3>, SSE3>,
     process_plane_sse<uint8_t, repair_mode13_sse<false, SSE3>, repair_mode13_sse<true, SSE3>, SSE3>,
     process_plane_sse<uint8_t, repair_mode14_sse<false, SSE3>, repair_mode14_sse<true, SSE3>, SSE3>,
     process_plane_sse<uint8_t, repair_mode15_sse<false, SSE3>, repair_mode15_sse<true, SSE3>, SSE3>,
     process_plane_sse<uint8_t, repair_mode16_sse<false, SSE3>, repair_mode16_sse<true, SSE3>, SSE3>,
-    process_plane_sse<uint8_t, repair_mode17_sse<false, SSE3>, repair_mode17_sse<true, SSE3>, SSE3>,
+    process_plane_sse<uint8_t, repair_mode17_sse<false, SSE3>, repair_mode17_sse<true, SSE3>, SSE3, RG_BLOCK_ROWS>,
     process_plane_sse<uint8_t, repair_mode18_sse<false, SSE3>, repair_mode18_sse<true, SSE3>, SSE3>,
     process_plane_sse<uint8_t, repair_mode19_sse<false, SSE3>, repair_mode19_sse<true, SSE3>, SSE3>, 
     process_plane_sse<uint8_t, repair_mode20_sse<false, SSE3>, repair_mode20_sse<true, SSE3>, SSE3>, 
@@ -120,26 +163,77 @@ RepairPlaneProcessor* sse3_functions[] = {
     process_plane_sse<uint8_t, repair_mode24_sse<false, SSE3>, repair_mode24_sse<true, SSE3>, SSE3> 
 };
 
+// RgBench: the row blocked modes of sse3_functions with one row per iteration, nullptr for the other modes
+RepairPlaneProcessor* sse3_functions_rows1[] = {
+    nullptr, nullptr,
+    process_plane_sse<uint8_t, repair_mode1_sse<false, SSE3>, repair_mode1_sse<true, SSE3>, SSE3, 1>,
+    nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+    process_plane_sse<uint8_t, repair_mode1_sse<false, SSE3>, repair_mode1_sse<true, SSE3>, SSE3, 1>,
+    nullptr, nullptr, nullptr, nullptr, nullptr,
+    process_plane_sse<uint8_t, repair_mode17_sse<false, SSE3>, repair_mode17_sse<true, SSE3>, SSE3, 1>,
+    nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+};
+
+RepairPlaneProcessor* ssse3_functions[] = {
+    doNothing,
+    copyPlane,
+    process_plane_sse<uint8_t, repair_mode1_sse<false, SSSE3>, repair_mode1_sse<true, SSSE3>, SSSE3, RG_BLOCK_ROWS>,
+    process_plane_colsort<ColsortSse8<SSSE3>, CS_RANK1>,
+    process_plane_colsort<ColsortSse8<SSSE3>, CS_RANK2>,
+    process_plane_colsort<ColsortSse8<SSSE3>, CS_RANK3>,
+    process_plane_sse<uint8_t, repair_mode5_sse<false, SSSE3>, repair_mode5_sse<true, SSSE3>, SSSE3>, 
+    process_plane_sse<uint8_t, repair_mode6_sse<false, SSSE3>, repair_mode6_sse<true, SSSE3>, SSSE3>, 
+    process_plane_sse<uint8_t, repair_mode7_sse<false, SSSE3>, repair_mode7_sse<true, SSSE3>, SSSE3>, 
+    process_plane_sse<uint8_t, repair_mode8_sse<false, SSSE3>, repair_mode8_sse<true, SSSE3>, SSSE3>, 
+    process_plane_sse<uint8_t, repair_mode9_sse<false, SSSE3>, repair_mode9_sse<true, SSSE3>, SSSE3>, 
+    process_plane_sse<uint8_t, repair_mode10_sse<false, SSSE3>, repair_mode10_sse<true, SSSE3>, SSSE3>,
+    process_plane_sse<uint8_t, repair_mode1_sse<false, SSSE3>, repair_mode1_sse<true, SSSE3>, SSSE3, RG_BLOCK_ROWS>,
+    process_plane_sse<uint8_t, repair_mode12_sse<false, SSSE3>, repair_mode12_sse<true, SSSE3>, SSSE3>,
+    process_plane_sse<uint8_t, repair_mode13_sse<false, SSSE3>, repair_mode13_sse<true, SSSE3>, SSSE3>,
+    process_plane_sse<uint8_t, repair_mode14_sse<false, SSSE3>, repair_mode14_sse<true, SSSE3>, SSSE3>,
+    process_plane_sse<uint8_t, repair_mode15_sse<false, SSSE3>, repair_mode15_sse<true, SSSE3>, SSSE3>,
+    process_plane_sse<uint8_t, repair_mode16_sse<false, SSSE3>, repair_mode16_sse<true, SSSE3>, SSSE3>,
+    process_plane_sse<uint8_t, repair_mode17_sse<false, SSSE3>, repair_mode17_sse<true, SSSE3>, SSSE3, RG_BLOCK_ROWS>,
+    process_plane_sse<uint8_t, repair_mode18_sse<false, SSSE3>, repair_mode18_sse<true, SSSE3>, SSSE3>,
+    process_plane_sse<uint8_t, repair_mode19_sse<false, SSSE3>, repair_mode19_sse<true, SSSE3>, SSSE3>, 
+    process_plane_sse<uint8_t, repair_mode20_sse<false, SSSE3>, repair_mode20_sse<true, SSSE3>, SSSE3>, 
+    process_plane_sse<uint8_t, repair_mode21_sse<false, SSSE3>, repair_mode21_sse<true, SSSE3>, SSSE3>, 
+    process_plane_sse<uint8_t, repair_mode22_sse<false, SSSE3>, repair_mode22_sse<true, SSSE3>, SSSE3>, 
+    process_plane_sse<uint8_t, repair_mode23_sse<false, SSSE3>, repair_mode23_sse<true, SSSE3>, SSSE3>, 
+    process_plane_sse<uint8_t, repair_mode24_sse<false, SSSE3>, repair_mode24_sse<true, SSSE3>, SSSE3> 
+};
+
+// RgBench: the row blocked modes of ssse3_functions with one row per iteration, nullptr for the other modes
+RepairPlaneProcessor* ssse3_functions_rows1[] = {
+    nullptr, nullptr,
+    process_plane_sse<uint8_t, repair_mode1_sse<false, SSSE3>, repair_mode1_sse<true, SSSE3>, SSSE3, 1>,
+    nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+    process_plane_sse<uint8_t, repair_mode1_sse<false, SSSE3>, repair_mode1_sse<true, SSSE3>, SSSE3, 1>,
+    nullptr, nullptr, nullptr, nullptr, nullptr,
+    process_plane_sse<uint8_t, repair_mode17_sse<false, SSSE3>, repair_mode17_sse<true, SSSE3>, SSSE3, 1>,
+    nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+};
+
 RepairPlaneProcessor* sse2_functions[] = {
     doNothing,
     copyPlane,
-    process_plane_sse<uint8_t, repair_mode1_sse<false, SSE2>, repair_mode1_sse<true, SSE2>, SSE2>,
-    process_plane_sse<uint8_t, repair_mode2_sse<false, SSE2>, repair_mode2_sse<true, SSE2>, SSE2>,
-    process_plane_sse<uint8_t, repair_mode3_sse<false, SSE2>, repair_mode3_sse<true, SSE2>, SSE2>,
-    process_plane_sse<uint8_t, repair_mode4_sse<false, SSE2>, repair_mode4_sse<true, SSE2>, SSE2>,
+    process_plane_sse<uint8_t, repair_mode1_sse<false, SSE2>, repair_mode1_sse<true, SSE2>, SSE2, RG_BLOCK_ROWS>,
+    process_plane_colsort<ColsortSse8<SSE2>, CS_RANK1>,
+    process_plane_colsort<ColsortSse8<SSE2>, CS_RANK2>,
+    process_plane_colsort<ColsortSse8<SSE2>, CS_RANK3>,
     process_plane_sse<uint8_t, repair_mode5_sse<false, SSE2>, repair_mode5_sse<true, SSE2>, SSE2>, 
     process_plane_sse<uint8_t, repair_mode6_sse<false, SSE2>, repair_mode6_sse<true, SSE2>, SSE2>, 
     process_plane_sse<uint8_t, repair_mode7_sse<false, SSE2>, repair_mode7_sse<true, SSE2>, SSE2>, 
     process_plane_sse<uint8_t, repair_mode8_sse<false, SSE2>, repair_mode8_sse<true, SSE2>, SSE2>, 
     process_plane_sse<uint8_t, repair_mode9_sse<false, SSE2>, repair_mode9_sse<true, SSE2>, SSE2>, 
     process_plane_sse<uint8_t, repair_mode10_sse<false, SSE2>, repair_mode10_sse<true, SSE2>, SSE2>,
-    process_plane_sse<uint8_t, repair_mode1_sse<false, SSE2>, repair_mode1_sse<true, SSE2>, SSE2>,
+    process_plane_sse<uint8_t, repair_mode1_sse<false, SSE2>, repair_mode1_sse<true, SSE2>, SSE2, RG_BLOCK_ROWS>,
     process_plane_sse<uint8_t, repair_mode12_sse<false, SSE2>, repair_mode12_sse<true, SSE2>, SSE2>,
     process_plane_sse<uint8_t, repair_mode13_sse<false, SSE2>, repair_mode13_sse<true, SSE2>, SSE2>,
     process_plane_sse<uint8_t, repair_mode14_sse<false, SSE2>, repair_mode14_sse<true, SSE2>, SSE2>,
     process_plane_sse<uint8_t, repair_mode15_sse<false, SSE2>, repair_mode15_sse<true, SSE2>, SSE2>,
     process_plane_sse<uint8_t, repair_mode16_sse<false, SSE2>, repair_mode16_sse<true, SSE2>, SSE2>,
-    process_plane_sse<uint8_t, repair_mode17_sse<false, SSE2>, repair_mode17_sse<true, SSE2>, SSE2>,
+    process_plane_sse<uint8_t, repair_mode17_sse<false, SSE2>, repair_mode17_sse<true, SSE2>, SSE2, RG_BLOCK_ROWS>,
     process_plane_sse<uint8_t, repair_mode18_sse<false, SSE2>, repair_mode18_sse<true, SSE2>, SSE2>,
     process_plane_sse<uint8_t, repair_mode19_sse<false, SSE2>, repair_mode19_sse<true, SSE2>, SSE2>, 
     process_plane_sse<uint8_t, repair_mode20_sse<false, SSE2>, repair_mode20_sse<true, SSE2>, SSE2>, 
@@ -149,26 +243,37 @@ RepairPlaneProcessor* sse2_functions[] = {
     process_plane_sse<uint8_t, repair_mode24_sse<false, SSE2>, repair_mode24_sse<true, SSE2>, SSE2> 
 };
 
+// RgBench: the row blocked modes of sse2_functions with one row per iteration, nullptr for the other modes
+RepairPlaneProcessor* sse2_functions_rows1[] = {
+    nullptr, nullptr,
+    process_plane_sse<uint8_t, repair_mode1_sse<false, SSE2>, repair_mode1_sse<true, SSE2>, SSE2, 1>,
+    nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+    process_plane_sse<uint8_t, repair_mode1_sse<false, SSE2>, repair_mode1_sse<true, SSE2>, SSE2, 1>,
+    nullptr, nullptr, nullptr, nullptr, nullptr,
+    process_plane_sse<uint8_t, repair_mode17_sse<false, SSE2>, repair_mode17_sse<true, SSE2>, SSE2, 1>,
+    nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+};
+
 RepairPlaneProcessor* sse4_functions_16_10[] = {
   doNothing,
   copyPlane,
-  process_plane_sse<uint16_t, repair_mode1_sse_16<false>,  repair_mode1_sse_16<true>, SSE3>,
-  process_plane_sse<uint16_t, repair_mode2_sse_16<false>,  repair_mode2_sse_16<true>, SSE3>,
-  process_plane_sse<uint16_t, repair_mode3_sse_16<false>,  repair_mode3_sse_16<true>, SSE3>,
-  process_plane_sse<uint16_t, repair_mode4_sse_16<false>,  repair_mode4_sse_16<true>, SSE3>,
+  process_plane_sse<uint16_t, repair_mode1_sse_16<false>,  repair_mode1_sse_16<true>, SSE3, RG_BLOCK_ROWS>,
+  process_plane_colsort<ColsortSse16, CS_RANK1>,
+  process_plane_colsort<ColsortSse16, CS_RANK2>,
+  process_plane_colsort<ColsortSse16, CS_RANK3>,
   process_plane_sse<uint16_t, repair_mode5_sse_16<false>,  repair_mode5_sse_16<true>, SSE3>, 
   process_plane_sse<uint16_t, repair_mode6_sse_16<10, false>,  repair_mode6_sse_16<10, true>,  SSE3>, 
   process_plane_sse<uint16_t, repair_mode7_sse_16<false>,  repair_mode7_sse_16<true>, SSE3>, 
   process_plane_sse<uint16_t, repair_mode8_sse_16<10, false>,  repair_mode8_sse_16<10, true>,  SSE3>, 
   process_plane_sse<uint16_t, repair_mode9_sse_16<false>,  repair_mode9_sse_16<true>, SSE3>, 
   process_plane_sse<uint16_t, repair_mode10_sse_16<false>,  repair_mode10_sse_16<true>, SSE3>,
-  process_plane_sse<uint16_t, repair_mode1_sse_16<false>,  repair_mode1_sse_16<true>, SSE3>,
+  process_plane_sse<uint16_t, repair_mode1_sse_16<false>,  repair_mode1_sse_16<true>, SSE3, RG_BLOCK_ROWS>,
   process_plane_sse<uint16_t, repair_mode12_sse_16<false>,  repair_mode12_sse_16<true>, SSE3>,
   process_plane_sse<uint16_t, repair_mode13_sse_16<false>,  repair_mode13_sse_16<true>, SSE3>,
   process_plane_sse<uint16_t, repair_mode14_sse_16<false>,  repair_mode14_sse_16<true>, SSE3>,
   process_plane_sse<uint16_t, repair_mode15_sse_16<false>,  repair_mode15_sse_16<true>, SSE3>,
   process_plane_sse<uint16_t, repair_mode16_sse_16<10, false>,  repair_mode16_sse_16<10, true>,  SSE3>,
-  process_plane_sse<uint16_t, repair_mode17_sse_16<false>,  repair_mode17_sse_16<true>, SSE3>,
+  process_plane_sse<uint16_t, repair_mode17_sse_16<false>,  repair_mode17_sse_16<true>, SSE3, RG_BLOCK_ROWS>,
   process_plane_sse<uint16_t, repair_mode18_sse_16<false>,  repair_mode18_sse_16<true>, SSE3>,
   process_plane_sse<uint16_t, repair_mode19_sse_16<10, false>,  repair_mode19_sse_16<10, true>,  SSE3>, 
   process_plane_sse<uint16_t, repair_mode20_sse_16<10, false>,  repair_mode20_sse_16<10, true>,  SSE3>, 
@@ -178,26 +283,37 @@ RepairPlaneProcessor* sse4_functions_16_10[] = {
   process_plane_sse<uint16_t, repair_mode24_sse_16<10, false>,  repair_mode24_sse_16<10, true>,  SSE3> 
 };
 
+// RgBench: the row blocked modes of sse4_functions_16_10 with one row per iteration, nullptr for the other modes
+RepairPlaneProcessor* sse4_functions_16_10_rows1[] = {
+    nullptr, nullptr,
+  process_plane_sse<uint16_t, repair_mode1_sse_16<false>,  repair_mode1_sse_16<true>, SSE3, 1>,
+    nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+  process_plane_sse<uint16_t, repair_mode1_sse_16<false>,  repair_mode1_sse_16<true>, SSE3, 1>,
+    nullptr, nullptr, nullptr, nullptr, nullptr,
+  process_plane_sse<uint16_t, repair_mode17_sse_16<false>,  repair_mode17_sse_16<true>, SSE3, 1>,
+    nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+};
+
 RepairPlaneProcessor* sse4_functions_16_12[] = {
   doNothing,
   copyPlane,
-  process_plane_sse<uint16_t, repair_mode1_sse_16<false>,  repair_mode1_sse_16<true>, SSE3>,
-  process_plane_sse<uint16_t, repair_mode2_sse_16<false>,  repair_mode2_sse_16<true>, SSE3>,
-  process_plane_sse<uint16_t, repair_mode3_sse_16<false>,  repair_mode3_sse_16<true>, SSE3>,
-  process_plane_sse<uint16_t, repair_mode4_sse_16<false>,  repair_mode4_sse_16<true>, SSE3>,
+  process_plane_sse<uint16_t, repair_mode1_sse_16<false>,  repair_mode1_sse_16<true>, SSE3, RG_BLOCK_ROWS>,
+  process_plane_colsort<ColsortSse16, CS_RANK1>,
+  process_plane_colsort<ColsortSse16, CS_RANK2>,
+  process_plane_colsort<ColsortSse16, CS_RANK3>,
   process_plane_sse<uint16_t, repair_mode5_sse_16<false>,  repair_mode5_sse_16<true>, SSE3>, 
   process_plane_sse<uint16_t, repair_mode6_sse_16<12, false>,  repair_mode6_sse_16<12, true>,  SSE3>, 
   process_plane_sse<uint16_t, repair_mode7_sse_16<false>,  repair_mode7_sse_16<true>, SSE3>, 
   process_plane_sse<uint16_t, repair_mode8_sse_16<12, false>,  repair_mode8_sse_16<12, true>,  SSE3>, 
   process_plane_sse<uint16_t, repair_mode9_sse_16<false>,  repair_mode9_sse_16<true>, SSE3>, 
   process_plane_sse<uint16_t, repair_mode10_sse_16<false>,  repair_mode10_sse_16<true>, SSE3>,
-  process_plane_sse<uint16_t, repair_mode1_sse_16<false>,  repair_mode1_sse_16<true>, SSE3>,
+  process_plane_sse<uint16_t, repair_mode1_sse_16<false>,  repair_mode1_sse_16<true>, SSE3, RG_BLOCK_ROWS>,
   process_plane_sse<uint16_t, repair_mode12_sse_16<false>,  repair_mode12_sse_16<true>, SSE3>,
   process_plane_sse<uint16_t, repair_mode13_sse_16<false>,  repair_mode13_sse_16<true>, SSE3>,
   process_plane_sse<uint16_t, repair_mode14_sse_16<false>,  repair_mode14_sse_16<true>, SSE3>,
   process_plane_sse<uint16_t, repair_mode15_sse_16<false>,  repair_mode15_sse_16<true>, SSE3>,
   process_plane_sse<uint16_t, repair_mode16_sse_16<12, false>,  repair_mode16_sse_16<12, true>,  SSE3>,
-  process_plane_sse<uint16_t, repair_mode17_sse_16<false>,  repair_mode17_sse_16<true>, SSE3>,
+  process_plane_sse<uint16_t, repair_mode17_sse_16<false>,  repair_mode17_sse_16<true>, SSE3, RG_BLOCK_ROWS>,
   process_plane_sse<uint16_t, repair_mode18_sse_16<false>,  repair_mode18_sse_16<true>, SSE3>,
   process_plane_sse<uint16_t, repair_mode19_sse_16<12, false>,  repair_mode19_sse_16<12, true>,  SSE3>, 
   process_plane_sse<uint16_t, repair_mode20_sse_16<12, false>,  repair_mode20_sse_16<12, true>,  SSE3>, 
@@ -207,26 +323,37 @@ RepairPlaneProcessor* sse4_functions_16_12[] = {
   process_plane_sse<uint16_t, repair_mode24_sse_16<12, false>,  repair_mode24_sse_16<12, true>,  SSE3> 
 };
 
+// RgBench: the row blocked modes of sse4_functions_16_12 with one row per iteration, nullptr for the other modes
+RepairPlaneProcessor* sse4_functions_16_12_rows1[] = {
+    nullptr, nullptr,
+  process_plane_sse<uint16_t, repair_mode1_sse_16<false>,  repair_mode1_sse_16<true>, SSE3, 1>,
+    nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+  process_plane_sse<uint16_t, repair_mode1_sse_16<false>,  repair_mode1_sse_16<true>, SSE3, 1>,
+    nullptr, nullptr, nullptr, nullptr, nullptr,
+  process_plane_sse<uint16_t, repair_mode17_sse_16<false>,  repair_mode17_sse_16<true>, SSE3, 1>,
+    nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+};
+
 RepairPlaneProcessor* sse4_functions_16_14[] = {
   doNothing,
   copyPlane,
-  process_plane_sse<uint16_t, repair_mode1_sse_16<false>,  repair_mode1_sse_16<true>, SSE3>,
-  process_plane_sse<uint16_t, repair_mode2_sse_16<false>,  repair_mode2_sse_16<true>, SSE3>,
-  process_plane_sse<uint16_t, repair_mode3_sse_16<false>,  repair_mode3_sse_16<true>, SSE3>,
-  process_plane_sse<uint16_t, repair_mode4_sse_16<false>,  repair_mode4_sse_16<true>, SSE3>,
+  process_plane_sse<uint16_t, repair_mode1_sse_16<false>,  repair_mode1_sse_16<true>, SSE3, RG_BLOCK_ROWS>,
+  process_plane_colsort<ColsortSse16, CS_RANK1>,
+  process_plane_colsort<ColsortSse16, CS_RANK2>,
+  process_plane_colsort<ColsortSse16, CS_RANK3>,
   process_plane_sse<uint16_t, repair_mode5_sse_16<false>,  repair_mode5_sse_16<true>, SSE3>, 
   process_plane_sse<uint16_t, repair_mode6_sse_16<14, false>,  repair_mode6_sse_16<14, true>,  SSE3>, 
   process_plane_sse<uint16_t, repair_mode7_sse_16<false>,  repair_mode7_sse_16<true>, SSE3>, 
   process_plane_sse<uint16_t, repair_mode8_sse_16<14, false>,  repair_mode8_sse_16<14, true>,  SSE3>, 
   process_plane_sse<uint16_t, repair_mode9_sse_16<false>,  repair_mode9_sse_16<true>, SSE3>, 
   process_plane_sse<uint16_t, repair_mode10_sse_16<false>,  repair_mode10_sse_16<true>, SSE3>,
-  process_plane_sse<uint16_t, repair_mode1_sse_16<false>,  repair_mode1_sse_16<true>, SSE3>,
+  process_plane_sse<uint16_t, repair_mode1_sse_16<false>,  repair_mode1_sse_16<true>, SSE3, RG_BLOCK_ROWS>,
   process_plane_sse<uint16_t, repair_mode12_sse_16<false>,  repair_mode12_sse_16<true>, SSE3>,
   process_plane_sse<uint16_t, repair_mode13_sse_16<false>,  repair_mode13_sse_16<true>, SSE3>,
   process_plane_sse<uint16_t, repair_mode14_sse_16<false>,  repair_mode14_sse_16<true>, SSE3>,
   process_plane_sse<uint16_t, repair_mode15_sse_16<false>,  repair_mode15_sse_16<true>, SSE3>,
   process_plane_sse<uint16_t, repair_mode16_sse_16<14, false>,  repair_mode16_sse_16<14, true>,  SSE3>,
-  process_plane_sse<uint16_t, repair_mode17_sse_16<false>,  repair_mode17_sse_16<true>, SSE3>,
+  process_plane_sse<uint16_t, repair_mode17_sse_16<false>,  repair_mode17_sse_16<true>, SSE3, RG_BLOCK_ROWS>,
   process_plane_sse<uint16_t, repair_mode18_sse_16<false>,  repair_mode18_sse_16<true>, SSE3>,
   process_plane_sse<uint16_t, repair_mode19_sse_16<14, false>,  repair_mode19_sse_16<14, true>,  SSE3>, 
   process_plane_sse<uint16_t, repair_mode20_sse_16<14, false>,  repair_mode20_sse_16<14, true>,  SSE3>, 
@@ -236,26 +363,37 @@ RepairPlaneProcessor* sse4_functions_16_14[] = {
   process_plane_sse<uint16_t, repair_mode24_sse_16<14, false>,  repair_mode24_sse_16<14, true>,  SSE3> 
 };
 
+// RgBench: the row blocked modes of sse4_functions_16_14 with one row per iteration, nullptr for the other modes
+RepairPlaneProcessor* sse4_functions_16_14_rows1[] = {
+    nullptr, nullptr,
+  process_plane_sse<uint16_t, repair_mode1_sse_16<false>,  repair_mode1_sse_16<true>, SSE3, 1>,
+    nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+  process_plane_sse<uint16_t, repair_mode1_sse_16<false>,  repair_mode1_sse_16<true>, SSE3, 1>,
+    nullptr, nullptr, nullptr, nullptr, nullptr,
+  process_plane_sse<uint16_t, repair_mode17_sse_16<false>,  repair_mode17_sse_16<true>, SSE3, 1>,
+    nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+};
+
 RepairPlaneProcessor* sse4_functions_16_16[] = {
   doNothing,
   copyPlane,
-  process_plane_sse<uint16_t, repair_mode1_sse_16<false>,  repair_mode1_sse_16<true>, SSE3>,
-  process_plane_sse<uint16_t, repair_mode2_sse_16<false>,  repair_mode2_sse_16<true>, SSE3>,
-  process_plane_sse<uint16_t, repair_mode3_sse_16<false>,  repair_mode3_sse_16<true>, SSE3>,
-  process_plane_sse<uint16_t, repair_mode4_sse_16<false>,  repair_mode4_sse_16<true>, SSE3>,
+  process_plane_sse<uint16_t, repair_mode1_sse_16<false>,  repair_mode1_sse_16<true>, SSE3, RG_BLOCK_ROWS>,
+  process_plane_colsort<ColsortSse16, CS_RANK1>,
+  process_plane_colsort<ColsortSse16, CS_RANK2>,
+  process_plane_colsort<ColsortSse16, CS_RANK3>,
   process_plane_sse<uint16_t, repair_mode5_sse_16<false>,  repair_mode5_sse_16<true>, SSE3>, 
   process_plane_sse<uint16_t, repair_mode6_sse_16<16, false>,  repair_mode6_sse_16<16, true>,  SSE3>, 
   process_plane_sse<uint16_t, repair_mode7_sse_16<false>,  repair_mode7_sse_16<true>, SSE3>, 
   process_plane_sse<uint16_t, repair_mode8_sse_16<16, false>,  repair_mode8_sse_16<16, true>,  SSE3>, 
   process_plane_sse<uint16_t, repair_mode9_sse_16<false>,  repair_mode9_sse_16<true>, SSE3>, 
   process_plane_sse<uint16_t, repair_mode10_sse_16<false>,  repair_mode10_sse_16<true>, SSE3>,
-  process_plane_sse<uint16_t, repair_mode1_sse_16<false>,  repair_mode1_sse_16<true>, SSE3>,
+  process_plane_sse<uint16_t, repair_mode1_sse_16<false>,  repair_mode1_sse_16<true>, SSE3, RG_BLOCK_ROWS>,
   process_plane_sse<uint16_t, repair_mode12_sse_16<false>,  repair_mode12_sse_16<true>, SSE3>,
   process_plane_sse<uint16_t, repair_mode13_sse_16<false>,  repair_mode13_sse_16<true>, SSE3>,
   process_plane_sse<uint16_t, repair_mode14_sse_16<false>,  repair_mode14_sse_16<true>, SSE3>,
   process_plane_sse<uint16_t, repair_mode15_sse_16<false>,  repair_mode15_sse_16<true>, SSE3>,
   process_plane_sse<uint16_t, repair_mode16_sse_16<16, false>,  repair_mode16_sse_16<16, true>,  SSE3>,
-  process_plane_sse<uint16_t, repair_mode17_sse_16<false>,  repair_mode17_sse_16<true>, SSE3>,
+  process_plane_sse<uint16_t, repair_mode17_sse_16<false>,  repair_mode17_sse_16<true>, SSE3, RG_BLOCK_ROWS>,
   process_plane_sse<uint16_t, repair_mode18_sse_16<false>,  repair_mode18_sse_16<true>, SSE3>,
   process_plane_sse<uint16_t, repair_mode19_sse_16<16, false>,  repair_mode19_sse_16<16, true>,  SSE3>, 
   process_plane_sse<uint16_t, repair_mode20_sse_16<16, false>,  repair_mode20_sse_16<16, true>,  SSE3>, 
@@ -265,27 +403,38 @@ RepairPlaneProcessor* sse4_functions_16_16[] = {
   process_plane_sse<uint16_t, repair_mode24_sse_16<16, false>,  repair_mode24_sse_16<16, true>,  SSE3> 
 };
 
+// RgBench: the row blocked modes of sse4_functions_16_16 with one row per iteration, nullptr for the other modes
+RepairPlaneProcessor* sse4_functions_16_16_rows1[] = {
+    nullptr, nullptr,
+  process_plane_sse<uint16_t, repair_mode1_sse_16<false>,  repair_mode1_sse_16<true>, SSE3, 1>,
+    nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+  process_plane_sse<uint16_t, repair_mode1_sse_16<false>,  repair_mode1_sse_16<true>, SSE3, 1>,
+    nullptr, nullptr, nullptr, nullptr, nullptr,
+  process_plane_sse<uint16_t, repair_mode17_sse_16<false>,  repair_mode17_sse_16<true>, SSE3, 1>,
+    nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+};
+
 
 RepairPlaneProcessor* sse4_functions_32[] = {
   doNothing,
   copyPlane,
-  process_plane_sse<float, repair_mode1_sse_32<false>, repair_mode1_sse_32<true>, SSE3>,
-  process_plane_sse<float, repair_mode2_sse_32<false>, repair_mode2_sse_32<true>, SSE3>,
-  process_plane_sse<float, repair_mode3_sse_32<false>, repair_mode3_sse_32<true>, SSE3>,
-  process_plane_sse<float, repair_mode4_sse_32<false>, repair_mode4_sse_32<true>, SSE3>,
+  process_plane_sse<float, repair_mode1_sse_32<false>, repair_mode1_sse_32<true>, SSE3, RG_BLOCK_ROWS>,
+  process_plane_colsort<ColsortSse32, CS_RANK1>,
+  process_plane_colsort<ColsortSse32, CS_RANK2>,
+  process_plane_colsort<ColsortSse32, CS_RANK3>,
   process_plane_sse<float, repair_mode5_sse_32<false>, repair_mode5_sse_32<true>, SSE3>, 
   process_plane_sse<float, repair_mode6_sse_32<false>, repair_mode6_sse_32<true>, SSE3>, 
   process_plane_sse<float, repair_mode7_sse_32<false>, repair_mode7_sse_32<true>, SSE3>, 
   process_plane_sse<float, repair_mode8_sse_32<false>, repair_mode8_sse_32<true>, SSE3>, 
   process_plane_sse<float, repair_mode9_sse_32<false>, repair_mode9_sse_32<true>, SSE3>, 
   process_plane_sse<float, repair_mode10_sse_32<false>, repair_mode10_sse_32<true>, SSE3>,
-  process_plane_sse<float, repair_mode1_sse_32<false>, repair_mode1_sse_32<true>, SSE3>,
+  process_plane_sse<float, repair_mode1_sse_32<false>, repair_mode1_sse_32<true>, SSE3, RG_BLOCK_ROWS>,
   process_plane_sse<float, repair_mode12_sse_32<false>, repair_mode12_sse_32<true>, SSE3>,
   process_plane_sse<float, repair_mode13_sse_32<false>, repair_mode13_sse_32<true>, SSE3>,
   process_plane_sse<float, repair_mode14_sse_32<false>, repair_mode14_sse_32<true>, SSE3>,
   process_plane_sse<float, repair_mode15_sse_32<false>, repair_mode15_sse_32<true>, SSE3>,
   process_plane_sse<float, repair_mode16_sse_32<false>, repair_mode16_sse_32<true>, SSE3>,
-  process_plane_sse<float, repair_mode17_sse_32<false>, repair_mode17_sse_32<true>, SSE3>,
+  process_plane_sse<float, repair_mode17_sse_32<false>, repair_mode17_sse_32<true>, SSE3, RG_BLOCK_ROWS>,
   process_plane_sse<float, repair_mode18_sse_32<false>, repair_mode18_sse_32<true>, SSE3>,
   process_plane_sse<float, repair_mode19_sse_32<false>, repair_mode19_sse_32<true>, SSE3>, 
   process_plane_sse<float, repair_mode20_sse_32<false>, repair_mode20_sse_32<true>, SSE3>, 
@@ -295,6 +444,17 @@ RepairPlaneProcessor* sse4_functions_32[] = {
   process_plane_sse<float, repair_mode24_sse_32<false>, repair_mode24_sse_32<true>, SSE3> 
 };
 
+// RgBench: the row blocked modes of sse4_functions_32 with one row per iteration, nullptr for the other modes
+RepairPlaneProcessor* sse4_functions_32_rows1[] = {
+    nullptr, nullptr,
+  process_plane_sse<float, repair_mode1_sse_32<false>, repair_mode1_sse_32<true>, SSE3, 1>,
+    nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+  process_plane_sse<float, repair_mode1_sse_32<false>, repair_mode1_sse_32<true>, SSE3, 1>,
+    nullptr, nullptr, nullptr, nullptr, nullptr,
+  process_plane_sse<float, repair_mode17_sse_32<false>, repair_mode17_sse_32<true>, SSE3, 1>,
+    nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+};
+
 
 RepairPlaneProcessor* c_functions[] = {
   doNothing,
@@ -470,8 +630,160 @@ RepairPlaneProcessor* c_functions_32[] = {
   process_plane_c<float,repair_mode24_cpp_32> 
 };
 
-Repair::Repair(PClip child, PClip ref, int mode, int modeU, int modeV, bool skip_cs_check, IScriptEnvironment* env)
-  : GenericVideoFilter(child), ref_(ref), mode_(mode), modeU_(modeU), modeV_(modeV), functions(nullptr) {
+extern RepairPlaneProcessor* avx2_functions[];
+extern RepairPlaneProcessor* avx2_functions_16_10[];
+extern RepairPlaneProcessor* avx2_functions_16_12[];
+extern RepairPlaneProcessor* avx2_functions_16_14[];
+extern RepairPlaneProcessor* avx2_functions_16_16[];
+extern RepairPlaneProcessor* avx2_functions_32[];
+extern RepairPlaneProcessor* avx2_fma_functions_32[];
+extern RepairPlaneProcessor* avx512_functions[];
+extern RepairPlaneProcessor* avx512_functions_16_10[];
+extern RepairPlaneProcessor* avx512_functions_16_12[];
+extern RepairPlaneProcessor* avx512_functions_16_14[];
+extern RepairPlaneProcessor* avx512_functions_16_16[];
+extern RepairPlaneProcessor* avx512_functions_32[];
+
+}
+using namespace repair;
+
+// CPU, bit depth and plane width dependent table, shared with RGRepair.
+// Any width works with every table, AVX2/AVX-512 only pay off when a plane has a full vector of inner pixels.
+// optAvx2=false disables AVX-512 too.
+RepairPlaneProcessor** repair_functions(const VideoInfo &vi, int width, bool use_avx2, IScriptEnvironment* env) {
+  const int pixelsize = vi.ComponentSize();
+  const int bits_per_pixel = vi.BitsPerComponent();
+  RepairPlaneProcessor **functions = nullptr;
+
+  bool avx2 = (env->GetCPUFlags() & CPUF_AVX2) && use_avx2 && width >= 32 / pixelsize + 2;
+  bool avx512 = avx2 && cpu_has_avx512bw() && width >= 64 / pixelsize + 2;
+
+  if (pixelsize == 1) {
+    if (avx512)
+      functions = avx512_functions;
+    else if (avx2)
+      functions = avx2_functions;
+    else if ((env->GetCPUFlags() & CPUF_SSSE3) && !(env->GetCPUFlags() & CPUF_SSE4_2))
+      functions = ssse3_functions; // palignr instead of cache line split loads
+    else if (env->GetCPUFlags() & CPUF_SSE3)
+      functions = sse3_functions;
+    else if (env->GetCPUFlags() & CPUF_SSE2)
+      functions = sse2_functions;
+    else
+      functions = c_functions;
+  }
+  else if (pixelsize == 2) {
+    if (avx512) {
+      switch (bits_per_pixel) {
+      case 10: functions = avx512_functions_16_10; break;
+      case 12: functions = avx512_functions_16_12; break;
+      case 14: functions = avx512_functions_16_14; break;
+      case 16: functions = avx512_functions_16_16; break;
+      default: env->ThrowError("Illegal bit-depth: %d!", bits_per_pixel);
+      }
+    }
+    else if (avx2) {
+      switch (bits_per_pixel) {
+      case 10: functions = avx2_functions_16_10; break;
+      case 12: functions = avx2_functions_16_12; break;
+      case 14: functions = avx2_functions_16_14; break;
+      case 16: functions = avx2_functions_16_16; break;
+      default: env->ThrowError("Illegal bit-depth: %d!", bits_per_pixel);
+      }
+    }
+    else if (env->GetCPUFlags() & CPUF_SSE4) {
+      switch (bits_per_pixel) {
+      case 10: functions = sse4_functions_16_10; break;
+      case 12: functions = sse4_functions_16_12; break;
+      case 14: functions = sse4_functions_16_14; break;
+      case 16: functions = sse4_functions_16_16; break;
+      default: env->ThrowError("Illegal bit-depth: %d!", bits_per_pixel);
+      }
+    }
+    else {
+      switch (bits_per_pixel) {
+      case 10: functions = c_functions_10; break;
+      case 12: functions = c_functions_12; break;
+      case 14: functions = c_functions_14; break;
+      case 16: functions = c_functions_16; break;
+      default: env->ThrowError("Illegal bit-depth: %d!", bits_per_pixel);
+      }
+    }
+  }
+  else {// if (pixelsize == 4) 
+    if (avx512)
+      functions = avx512_functions_32;
+    else if (avx2)
+      functions = (env->GetCPUFlags() & CPUF_FMA3) ? avx2_fma_functions_32 : avx2_functions_32;
+    else if (env->GetCPUFlags() & CPUF_SSE4)
+      functions = sse4_functions_32;
+    else
+      functions = c_functions_32;
+  }
+
+  return functions;
+}
+
+// every table the CPU can run for this format, flags from CPUID so classic hosts get AVX2 too
+static std::vector<TuneCandidate<RepairPlaneProcessor>> repair_candidates(const VideoInfo &vi, bool use_avx2) {
+  const int cpu = cpu_detect_flags();
+  const bool avx2 = use_avx2 && (cpu & CPUF_AVX2);
+  const bool avx512 = avx2 && cpu_has_avx512bw();
+  std::vector<TuneCandidate<RepairPlaneProcessor>> candidates;
+
+  if (vi.ComponentSize() == 1) {
+    candidates.push_back({ "c", c_functions });
+    if (cpu & CPUF_SSE2) candidates.push_back({ "sse2", sse2_functions });
+    if (cpu & CPUF_SSE3) candidates.push_back({ "sse3", sse3_functions });
+    if (cpu & CPUF_SSSE3) candidates.push_back({ "ssse3", ssse3_functions });
+    if (avx2) candidates.push_back({ "avx2", avx2_functions });
+    if (avx512) candidates.push_back({ "avx512", avx512_functions });
+  }
+  else if (vi.ComponentSize() == 2) {
+    const int i = (vi.BitsPerComponent() - 10) / 2; // 10, 12, 14, 16
+    RepairPlaneProcessor **c[] = { c_functions_10, c_functions_12, c_functions_14, c_functions_16 };
+    RepairPlaneProcessor **sse4[] = { sse4_functions_16_10, sse4_functions_16_12, sse4_functions_16_14, sse4_functions_16_16 };
+    RepairPlaneProcessor **avx2_16[] = { avx2_functions_16_10, avx2_functions_16_12, avx2_functions_16_14, avx2_functions_16_16 };
+    RepairPlaneProcessor **avx512_16[] = { avx512_functions_16_10, avx512_functions_16_12, avx512_functions_16_14, avx512_functions_16_16 };
+    candidates.push_back({ "c", c[i] });
+    if (cpu & CPUF_SSE4) candidates.push_back({ "sse4", sse4[i] });
+    if (avx2) candidates.push_back({ "avx2", avx2_16[i] });
+    if (avx512) candidates.push_back({ "avx512", avx512_16[i] });
+  }
+  else {
+    candidates.push_back({ "c", c_functions_32 });
+    if (cpu & CPUF_SSE4) candidates.push_back({ "sse4", sse4_functions_32 });
+    if (avx2) candidates.push_back({ "avx2", avx2_functions_32 });
+    if (avx2 && (cpu & CPUF_FMA3)) candidates.push_back({ "avx2fma", avx2_fma_functions_32 });
+    if (avx512) candidates.push_back({ "avx512", avx512_functions_32 });
+  }
+  return candidates;
+}
+
+// autotune=true: times the candidates on a plane of this size and puts the fastest one for 'mode' in 'tuned',
+// 'reference' is the table chosen without autotune
+const char* repair_table_name(const VideoInfo &vi, RepairPlaneProcessor **table, int mode) {
+  return tune_candidate_name(repair_candidates(vi, true), table, mode);
+}
+
+static void repair_autotune(RepairPlaneProcessor **tuned, RepairPlaneProcessor **reference, const VideoInfo &vi, int mode, int width, int height, bool use_avx2, const char *cache_path, IScriptEnvironment* env) {
+  if (mode <= 0)
+    return; // copy or nothing
+
+  const int rowsize = width * vi.ComponentSize();
+  const int bits_per_pixel = vi.BitsPerComponent();
+  char key[256];
+  snprintf(key, sizeof(key), "%s|Repair mode=%d bits=%d %dx%d%s", cpu_model_name().c_str(), mode, bits_per_pixel, width, height, use_avx2 ? "" : " noavx2");
+
+  RepairPlaneProcessor **best = autotune_pick<RepairPlaneProcessor>(repair_candidates(vi, use_avx2), reference, key, rowsize, height, bits_per_pixel, 2, cache_path,
+    [&](RepairPlaneProcessor **table, std::vector<TunePlane> &in, TunePlane &dst) {
+      table[mode + 1](env, dst.ptr(), in[0].ptr(), in[1].ptr(), dst.pitch(), in[0].pitch(), in[1].pitch(), rowsize, height);
+    });
+  tuned[mode + 1] = best[mode + 1];
+}
+
+Repair::Repair(PClip child, PClip ref, int mode, int modeU, int modeV, bool skip_cs_check, bool use_avx2, int threads, bool autotune, const char *tunecache, bool profile, IScriptEnvironment* env)
+  : GenericVideoFilter(child), ref_(ref), mode_(mode), modeU_(modeU), modeV_(modeV), avx2_(use_avx2), functions(nullptr), functions_chroma(nullptr), pool_(nullptr), stripes_(1) {
 
   auto refVi = ref_->GetVideoInfo();
 
@@ -500,6 +812,9 @@ Repair::Repair(PClip child, PClip ref, int mode, int modeU, int modeV, bool skip
     modeV_ = modeU_;
   }
 
+  // no plane is changed, frames are handed on without a copy
+  passthrough_ = mode_ <= 0 && (isPlanarRGB || !vi.IsPlanar() || vi.IsY() || (modeU_ <= 0 && modeV_ <= 0));
+
   if (vi.IsPlanar() && !vi.IsY() && (modeU_ != -1 || modeV_ != -1)) {
     if (!vi.IsSameColorspace(refVi)) {
       env->ThrowError("Both clips should have the same colorspace!");
@@ -509,50 +824,86 @@ Repair::Repair(PClip child, PClip ref, int mode, int modeU, int modeV, bool skip
   pixelsize = vi.ComponentSize();
   bits_per_pixel = vi.BitsPerComponent();
 
-  if (pixelsize == 1) {
+  functions = repair_functions(vi, vi.width, use_avx2, env);
+  functions_chroma = repair_functions(vi, chroma_plane_width(vi), use_avx2, env);
+
+  if (autotune) {
+    // tuned copies of the tables, only the entries of the used modes change
+    std::copy(functions, functions + TABLE_SIZE, tuned_);
+    std::copy(functions_chroma, functions_chroma + TABLE_SIZE, tuned_chroma_);
+
+    const bool chroma = vi.IsPlanar() && !vi.IsY() && !vi.IsPlanarRGB() && !vi.IsPlanarRGBA();
+    repair_autotune(tuned_, functions, vi, mode_, vi.width, vi.height, use_avx2, tunecache, env);
+    if (chroma) {
+      const int chroma_height = vi.height >> vi.GetPlaneHeightSubsampling(PLANAR_U);
+      repair_autotune(tuned_chroma_, functions_chroma, vi, modeU_, chroma_plane_width(vi), chroma_height, use_avx2, tunecache, env);
+      if (modeV_ != modeU_)
+        repair_autotune(tuned_chroma_, functions_chroma, vi, modeV_, chroma_plane_width(vi), chroma_height, use_avx2, tunecache, env);
+    }
+    functions = tuned_;
+    functions_chroma = tuned_chroma_;
+  }
 
-    functions = (env->GetCPUFlags() & CPUF_SSE3) ? sse3_functions
-      : (env->GetCPUFlags() & CPUF_SSE2) ? sse2_functions
-      : c_functions;
+  profile_ = FilterProfile::create(profile, "Repair", vi, env);
+  if (profile_) {
+    // planar RGB: all planes use the luma table
+    profile_->set_isa(0, repair_table_name(vi, functions, mode_));
+    profile_->set_isa(1, repair_table_name(vi, isPlanarRGB ? functions : functions_chroma, isPlanarRGB ? mode_ : modeU_));
+    profile_->set_isa(2, repair_table_name(vi, isPlanarRGB ? functions : functions_chroma, isPlanarRGB ? mode_ : modeV_));
+  }
 
-    if (vi.width < 17) { //not enough for XMM
-      functions = c_functions;
-    }
+  if (threads < 0) {
+    env->ThrowError("Repair: threads must be 0 (auto) or positive!");
   }
-  else if (pixelsize == 2) {
-    if ((env->GetCPUFlags() & CPUF_SSE4) && vi.width >= (16/sizeof(uint16_t) + 1)) {
-      switch (bits_per_pixel) {
-      case 10: functions = sse4_functions_16_10; break;
-      case 12: functions = sse4_functions_16_12; break;
-      case 14: functions = sse4_functions_16_14; break;
-      case 16: functions = sse4_functions_16_16; break;
-      default: env->ThrowError("Illegal bit-depth: %d!", bits_per_pixel);
-      }
-    }
-    else {
-      switch (bits_per_pixel) {
-      case 10: functions = c_functions_10; break;
-      case 12: functions = c_functions_12; break;
-      case 14: functions = c_functions_14; break;
-      case 16: functions = c_functions_16; break;
-      default: env->ThrowError("Illegal bit-depth: %d!", bits_per_pixel);
-      }
+  if (threads != 1) {
+    pool_ = ThreadPool::acquire();
+    stripes_ = stripes_for_threads(threads, pool_);
+  }
+}
+
+Repair::~Repair() {
+  if (pool_ != nullptr)
+    ThreadPool::release();
+}
+
+void Repair::process_plane(int p, RepairPlaneProcessor** table, int mode, BYTE* pDst, const BYTE* pSrc, const BYTE* pRef, int dstPitch, int srcPitch, int refPitch, int rowsize, int height, IScriptEnvironment* env) {
+  PlaneTimer timer(profile_.get(), p, rowsize, height, 2);
+  RepairPlaneProcessor *processor = table[mode + 1];
+  if (pSrc == pDst) {
+    // in place, modes 0 and -1 leave the plane as it is.
+    // Only the center source pixel is read, but the overlapping vectors at the row ends would read it back repaired
+    if (mode > 0) {
+      process_plane_inplace(pDst, dstPitch, rowsize, height, 1, [&](int y, int h, const BYTE* pWindow, int windowPitch, BYTE* pRows, int pitch) {
+        processor(env, pRows, pWindow, pRef + y * refPitch, pitch, windowPitch, refPitch, rowsize, h);
+      });
     }
+    return;
   }
-  else {// if (pixelsize == 4) 
-    
-    if ((env->GetCPUFlags() & CPUF_SSE4) && vi.width >= (16/sizeof(float) + 1))
-      functions = sse4_functions_32;
-    else
-      functions = c_functions_32;
+  if (pool_ == nullptr || mode == -1) {
+    processor(env, pDst, pSrc, pRef, dstPitch, srcPitch, refPitch, rowsize, height);
+    return;
   }
+  process_plane_stripes(pool_, stripes_, 1, pDst, dstPitch, rowsize, height, [&](int y, int h, BYTE* pStripeDst, int stripeDstPitch) {
+    processor(env, pStripeDst, pSrc + y * srcPitch, pRef + y * refPitch, stripeDstPitch, srcPitch, refPitch, rowsize, h);
+  });
 }
 
 
 PVideoFrame Repair::GetFrame(int n, IScriptEnvironment* env) {
+  if (passthrough_)
+    return child->GetFrame(n, env);
+
   auto srcFrame = child->GetFrame(n, env);
   auto refFrame = ref_->GetFrame(n, env);
-  auto dstFrame = env->NewVideoFrame(vi);
+  // nothing else holds the source frame (no cache before us): repair it in place, without a second
+  // frame and the alpha copy. Not with threads, the stripes would need each other's source rows
+  const bool inplace = pool_ == nullptr && srcFrame->IsWritable();
+  PVideoFrame newFrame;
+  if (!inplace)
+    newFrame = env->NewVideoFrame(vi);
+  // in place an alias, not a second handle: that would make the frame read-only, GetWritePtr returns nullptr
+  PVideoFrame &dstFrame = inplace ? srcFrame : newFrame;
+  FrameProfile frame_profile(profile_.get());
 
   int planes_y[4] = { PLANAR_Y, PLANAR_U, PLANAR_V, PLANAR_A };
   int planes_r[4] = { PLANAR_G, PLANAR_B, PLANAR_R, PLANAR_A };
@@ -563,41 +914,37 @@ PVideoFrame Repair::GetFrame(int n, IScriptEnvironment* env) {
     for (int p = 0; p < 3; ++p) {
       const int plane = planes[p];
 
-      functions[mode_ + 1](env, dstFrame->GetWritePtr(plane), srcFrame->GetReadPtr(plane), refFrame->GetReadPtr(plane),
+      process_plane(p, functions, mode_, dstFrame->GetWritePtr(plane), srcFrame->GetReadPtr(plane), refFrame->GetReadPtr(plane),
         dstFrame->GetPitch(plane), srcFrame->GetPitch(plane), refFrame->GetPitch(plane),
-        srcFrame->GetRowSize(plane), srcFrame->GetHeight(plane));
+        srcFrame->GetRowSize(plane), srcFrame->GetHeight(plane), env);
     }
   }
   else {
-    if(!is_16byte_aligned(srcFrame->GetReadPtr(PLANAR_Y)) || !is_16byte_aligned(refFrame->GetReadPtr(PLANAR_Y)))
-      env->ThrowError("Repair: Invalid memory alignment. Unaligned crop?");
-
-    functions[mode_ + 1](env, dstFrame->GetWritePtr(PLANAR_Y), srcFrame->GetReadPtr(PLANAR_Y), refFrame->GetReadPtr(PLANAR_Y),
+    process_plane(0, functions, mode_, dstFrame->GetWritePtr(PLANAR_Y), srcFrame->GetReadPtr(PLANAR_Y), refFrame->GetReadPtr(PLANAR_Y),
       dstFrame->GetPitch(PLANAR_Y), srcFrame->GetPitch(PLANAR_Y), refFrame->GetPitch(PLANAR_Y),
-      srcFrame->GetRowSize(PLANAR_Y), srcFrame->GetHeight(PLANAR_Y));
+      srcFrame->GetRowSize(PLANAR_Y), srcFrame->GetHeight(PLANAR_Y), env);
 
     if (vi.IsPlanar() && !vi.IsY()) {
-      if (!is_16byte_aligned(srcFrame->GetReadPtr(PLANAR_U)) || !is_16byte_aligned(refFrame->GetReadPtr(PLANAR_U)))
-        env->ThrowError("Repair: Invalid memory alignment. Unaligned crop?");
-
-      functions[modeU_ + 1](env, dstFrame->GetWritePtr(PLANAR_U), srcFrame->GetReadPtr(PLANAR_U), refFrame->GetReadPtr(PLANAR_U),
+      process_plane(1, functions_chroma, modeU_, dstFrame->GetWritePtr(PLANAR_U), srcFrame->GetReadPtr(PLANAR_U), refFrame->GetReadPtr(PLANAR_U),
         dstFrame->GetPitch(PLANAR_U), srcFrame->GetPitch(PLANAR_U), refFrame->GetPitch(PLANAR_U),
-        srcFrame->GetRowSize(PLANAR_U), srcFrame->GetHeight(PLANAR_U));
+        srcFrame->GetRowSize(PLANAR_U), srcFrame->GetHeight(PLANAR_U), env);
 
-      functions[modeV_ + 1](env, dstFrame->GetWritePtr(PLANAR_V), srcFrame->GetReadPtr(PLANAR_V), refFrame->GetReadPtr(PLANAR_V),
+      process_plane(2, functions_chroma, modeV_, dstFrame->GetWritePtr(PLANAR_V), srcFrame->GetReadPtr(PLANAR_V), refFrame->GetReadPtr(PLANAR_V),
         dstFrame->GetPitch(PLANAR_V), srcFrame->GetPitch(PLANAR_V), refFrame->GetPitch(PLANAR_V),
-        srcFrame->GetRowSize(PLANAR_V), srcFrame->GetHeight(PLANAR_V));
+        srcFrame->GetRowSize(PLANAR_V), srcFrame->GetHeight(PLANAR_V), env);
     }
   }
-  if (vi.IsYUVA() || vi.IsPlanarRGBA())
-  { // copy alpha
+  if ((vi.IsYUVA() || vi.IsPlanarRGBA()) && !inplace)
+  { // copy alpha, in place it is there already
     env->BitBlt(dstFrame->GetWritePtr(PLANAR_A), dstFrame->GetPitch(PLANAR_A), srcFrame->GetReadPtr(PLANAR_A), srcFrame->GetPitch(PLANAR_A), srcFrame->GetRowSize(PLANAR_A_ALIGNED), srcFrame->GetHeight(PLANAR_A));
   }
+  frame_profile.attach(dstFrame, env);
   return dstFrame;
 }
 
 
 AVSValue __cdecl Create_Repair(AVSValue args, void*, IScriptEnvironment* env) {
-    enum { CLIP, REF, MODE, MODEU, MODEV, PLANAR };
-    return new Repair(args[CLIP].AsClip(), args[REF].AsClip(), args[MODE].AsInt(1), args[MODEU].AsInt(Repair::UNDEFINED_MODE), args[MODEV].AsInt(Repair::UNDEFINED_MODE), args[PLANAR].AsBool(false), env);
+    enum { CLIP, REF, MODE, MODEU, MODEV, PLANAR, OPTAVX2, THREADS, AUTOTUNE, TUNECACHE, PROFILE };
+    return new Repair(args[CLIP].AsClip(), args[REF].AsClip(), args[MODE].AsInt(1), args[MODEU].AsInt(Repair::UNDEFINED_MODE), args[MODEV].AsInt(Repair::UNDEFINED_MODE), 
+      args[PLANAR].AsBool(false), args[OPTAVX2].AsBool(true), args[THREADS].AsInt(1), args[AUTOTUNE].AsBool(false), args[TUNECACHE].AsString(""), args[PROFILE].AsBool(false), env);
 }
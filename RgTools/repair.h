@@ -2,6 +2,8 @@
 #define __REPAIR_H__
 
 #include "common.h"
+#include "thread_pool.h"
+#include "profile.h"
 
 
 typedef void (RepairPlaneProcessor)(IScriptEnvironment* env, BYTE* pDst, const BYTE* pSrc, const BYTE* pRef, int dstPitch, int srcPitch, int refPitch, int rowsize, int height);
@@ -9,29 +11,51 @@ typedef void (RepairPlaneProcessor)(IScriptEnvironment* env, BYTE* pDst, const B
 
 class Repair : public GenericVideoFilter {
 public:
-    Repair(PClip child, PClip ref, int mode, int modeU, int modeV, bool skip_cs_check, IScriptEnvironment* env);
+    Repair(PClip child, PClip ref, int mode, int modeU, int modeV, bool skip_cs_check, bool use_avx2, int threads, bool autotune, const char *tunecache, bool profile, IScriptEnvironment* env);
+    ~Repair();
 
     PVideoFrame __stdcall GetFrame(int n, IScriptEnvironment* env);
 
+    // profile=true, else nullptr
+    FilterProfile* profile() const { return profile_.get(); }
+
     int __stdcall SetCacheHints(int cachehints, int frame_range) override {
       return cachehints == CACHE_GET_MTMODE ? MT_NICE_FILTER : 0;
     }
 
     const static int UNDEFINED_MODE = -2;
+    const static int TABLE_SIZE = 26; // modes -1..24
 
 private:
     int mode_;
     int modeU_;
     int modeV_;
+    bool passthrough_; // all planes mode 0 or -1: GetFrame returns the source frame
     PClip ref_;
 
+    bool avx2_; // for disabling avx2
+
     int pixelsize;
     int bits_per_pixel;
 
     RepairPlaneProcessor **functions;
+    RepairPlaneProcessor **functions_chroma; // U and V, may be narrower than a vector
+    RepairPlaneProcessor *tuned_[TABLE_SIZE]; // autotune=true: functions and functions_chroma point here
+    RepairPlaneProcessor *tuned_chroma_[TABLE_SIZE];
+
+    ThreadPool *pool_; // nullptr when threads=1
+    int stripes_;
+
+    std::shared_ptr<FilterProfile> profile_; // nullptr when profile=false
+
+    void process_plane(int p, RepairPlaneProcessor** table, int mode, BYTE* pDst, const BYTE* pSrc, const BYTE* pRef, int dstPitch, int srcPitch, int refPitch, int rowsize, int height, IScriptEnvironment* env);
 };
 
 
+RepairPlaneProcessor** repair_functions(const VideoInfo &vi, int width, bool use_avx2, IScriptEnvironment* env);
+// "c", "sse2", ... "avx512" for a table from repair_functions or an autotuned copy
+const char* repair_table_name(const VideoInfo &vi, RepairPlaneProcessor **table, int mode);
+
 AVSValue __cdecl Create_Repair(AVSValue args, void*, IScriptEnvironment* env);
 
 #endif
\ No newline at end of file
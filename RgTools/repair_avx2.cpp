@@ -0,0 +1,377 @@
+#include "repair_functions_fma.h"
+#include "colsort_avx2.h"
+#include "repair.h"
+
+// 'rows' (1 or 2) output rows per call, see process_column_sse in repair.cpp
+template<SseModeProcessor processor, int rows>
+static RG_FORCEINLINE void process_column_avx2(Byte* pDst, const Byte* pSrc, const Byte* pRef, int dstPitch, int srcPitch, int refPitch) {
+    __m256i r0 = processor(pRef, simd_loadu_si256(pSrc), refPitch);
+    __m256i r1;
+    if (rows > 1) r1 = processor(pRef + refPitch, simd_loadu_si256(pSrc + srcPitch), refPitch);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(pDst), r0);
+    if (rows > 1) _mm256_storeu_si256(reinterpret_cast<__m256i*>(pDst + dstPitch), r1);
+}
+
+template<typename pixel_t, SseModeProcessor processor, int rows>
+static RG_FORCEINLINE void process_rows_avx2(Byte* pDst, const Byte* pSrc, const Byte* pRef, int dstPitch, int srcPitch, int refPitch, int width) {
+    const int pixels_at_at_time = 32 / sizeof(pixel_t); // 32!
+    const int mod_width = width / pixels_at_at_time * pixels_at_at_time;
+
+    for (int r = 0; r < rows; ++r)
+        reinterpret_cast<pixel_t*>(pDst + r * dstPitch)[0] = reinterpret_cast<const pixel_t*>(pSrc + r * srcPitch)[0];
+
+    if (width < pixels_at_at_time + 2) {
+        // narrow plane: one partial vector on staged copies of the rows
+        for (int r = 0; r < rows && width > 2; ++r) {
+            const Byte* pSrcRow = pSrc + r * srcPitch;
+            process_row_staged<pixel_t>(pDst + r * dstPitch, pRef + r * refPitch, refPitch, width, [&](const Byte* pStage, int stagePitch) {
+                alignas(64) Byte val[RG_STAGE_PITCH] = {};
+                memcpy(val, pSrcRow, width * sizeof(pixel_t));
+                return processor(pStage, simd_loadu_si256(val + sizeof(pixel_t)), stagePitch);
+            });
+        }
+    } else {
+        // unaligned first 32 bytes, last pixel overlaps with the next aligned loop
+        process_column_avx2<processor, rows>(pDst + sizeof(pixel_t), pSrc + sizeof(pixel_t), pRef + sizeof(pixel_t), dstPitch, srcPitch, refPitch);
+
+        // possibly aligned, stored as unaligned
+        for (int x = pixels_at_at_time; x < mod_width-1; x+= pixels_at_at_time) {
+            const int offset = x * sizeof(pixel_t);
+            process_column_avx2<processor, rows>(pDst + offset, pSrc + offset, pRef + offset, dstPitch, srcPitch, refPitch);
+        }
+
+        if (mod_width != width) {
+            const int offset = (width - 1 - pixels_at_at_time) * sizeof(pixel_t);
+            process_column_avx2<processor, rows>(pDst + offset, pSrc + offset, pRef + offset, dstPitch, srcPitch, refPitch);
+        }
+    }
+
+    for (int r = 0; r < rows; ++r)
+        reinterpret_cast<pixel_t*>(pDst + r * dstPitch)[width-1] = reinterpret_cast<const pixel_t*>(pSrc + r * srcPitch)[width-1];
+}
+
+// AVX2: not using special aligned templates, loadu is fast is aligned
+template<typename pixel_t, SseModeProcessor processor, int rows = 1>
+static void process_plane_avx2(IScriptEnvironment* env, BYTE* pDst, const BYTE* pSrc, const BYTE* pRef, int dstPitch, int srcPitch, int refPitch, int rowsize, int height) {
+    _mm256_zeroupper();
+
+    env->BitBlt(pDst, dstPitch, pSrc, srcPitch, rowsize, 1);
+
+    const int width = rowsize / sizeof(pixel_t);
+
+    pSrc += srcPitch;
+    pDst += dstPitch;
+    pRef += refPitch;
+
+    int y = 1;
+    for (; y + rows <= height-1; y += rows) {
+        process_rows_avx2<pixel_t, processor, rows>(pDst, pSrc, pRef, dstPitch, srcPitch, refPitch, width);
+        pSrc += srcPitch * rows;
+        pDst += dstPitch * rows;
+        pRef += refPitch * rows;
+    }
+    for (; y < height-1; ++y) {
+        process_rows_avx2<pixel_t, processor, 1>(pDst, pSrc, pRef, dstPitch, srcPitch, refPitch, width);
+        pSrc += srcPitch;
+        pDst += dstPitch;
+        pRef += refPitch;
+    }
+    _mm256_zeroupper();
+
+    env->BitBlt(pDst, dstPitch, pSrc, srcPitch, rowsize, 1);
+}
+
+static void doNothing(IScriptEnvironment* env, BYTE* pDst, const BYTE* pSrc, const BYTE* pRef, int dstPitch, int srcPitch, int refPitch, int rowsize, int height) {
+
+}
+
+static void copyPlane(IScriptEnvironment* env, BYTE* pDst, const BYTE* pSrc, const BYTE* pRef, int dstPitch, int srcPitch, int refPitch, int rowsize, int height) {
+  _mm256_zeroupper(); // paranoia
+  env->BitBlt(pDst, dstPitch, pSrc, srcPitch, rowsize, height);
+}
+
+
+namespace repair {
+
+RepairPlaneProcessor* avx2_functions[] = {
+  doNothing,
+  copyPlane,
+  process_plane_avx2<uint8_t, repair_mode1_avx2<false>, RG_BLOCK_ROWS>,
+  process_plane_colsort<ColsortAvx2_8, CS_RANK1>,
+  process_plane_colsort<ColsortAvx2_8, CS_RANK2>,
+  process_plane_colsort<ColsortAvx2_8, CS_RANK3>,
+  process_plane_avx2<uint8_t, repair_mode5_avx2<false>>,
+  process_plane_avx2<uint8_t, repair_mode6_avx2<false>>,
+  process_plane_avx2<uint8_t, repair_mode7_avx2<false>>,
+  process_plane_avx2<uint8_t, repair_mode8_avx2<false>>,
+  process_plane_avx2<uint8_t, repair_mode9_avx2<false>>,
+  process_plane_avx2<uint8_t, repair_mode10_avx2<false>>,
+  process_plane_avx2<uint8_t, repair_mode1_avx2<false>, RG_BLOCK_ROWS>,
+  process_plane_avx2<uint8_t, repair_mode12_avx2<false>>,
+  process_plane_avx2<uint8_t, repair_mode13_avx2<false>>,
+  process_plane_avx2<uint8_t, repair_mode14_avx2<false>>,
+  process_plane_avx2<uint8_t, repair_mode15_avx2<false>>,
+  process_plane_avx2<uint8_t, repair_mode16_avx2<false>>,
+  process_plane_avx2<uint8_t, repair_mode17_avx2<false>, RG_BLOCK_ROWS>,
+  process_plane_avx2<uint8_t, repair_mode18_avx2<false>>,
+  process_plane_avx2<uint8_t, repair_mode19_avx2<false>>,
+  process_plane_avx2<uint8_t, repair_mode20_avx2<false>>,
+  process_plane_avx2<uint8_t, repair_mode21_avx2<false>>,
+  process_plane_avx2<uint8_t, repair_mode22_avx2<false>>,
+  process_plane_avx2<uint8_t, repair_mode23_avx2<false>>,
+  process_plane_avx2<uint8_t, repair_mode24_avx2<false>>
+};
+
+// RgBench: the row blocked modes of avx2_functions with one row per iteration, nullptr for the other modes
+RepairPlaneProcessor* avx2_functions_rows1[] = {
+    nullptr, nullptr,
+  process_plane_avx2<uint8_t, repair_mode1_avx2<false>, 1>,
+    nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+  process_plane_avx2<uint8_t, repair_mode1_avx2<false>, 1>,
+    nullptr, nullptr, nullptr, nullptr, nullptr,
+  process_plane_avx2<uint8_t, repair_mode17_avx2<false>, 1>,
+    nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+};
+
+RepairPlaneProcessor* avx2_functions_16_10[] = {
+  doNothing,
+  copyPlane,
+  process_plane_avx2<uint16_t, repair_mode1_avx2_16<false>, RG_BLOCK_ROWS>,
+  process_plane_colsort<ColsortAvx2_16, CS_RANK1>,
+  process_plane_colsort<ColsortAvx2_16, CS_RANK2>,
+  process_plane_colsort<ColsortAvx2_16, CS_RANK3>,
+  process_plane_avx2<uint16_t, repair_mode5_avx2_16<false>>,
+  process_plane_avx2<uint16_t, repair_mode6_avx2_16<10, false>>,
+  process_plane_avx2<uint16_t, repair_mode7_avx2_16<false>>,
+  process_plane_avx2<uint16_t, repair_mode8_avx2_16<10, false>>,
+  process_plane_avx2<uint16_t, repair_mode9_avx2_16<false>>,
+  process_plane_avx2<uint16_t, repair_mode10_avx2_16<false>>,
+  process_plane_avx2<uint16_t, repair_mode1_avx2_16<false>, RG_BLOCK_ROWS>,
+  process_plane_avx2<uint16_t, repair_mode12_avx2_16<false>>,
+  process_plane_avx2<uint16_t, repair_mode13_avx2_16<false>>,
+  process_plane_avx2<uint16_t, repair_mode14_avx2_16<false>>,
+  process_plane_avx2<uint16_t, repair_mode15_avx2_16<false>>,
+  process_plane_avx2<uint16_t, repair_mode16_avx2_16<10, false>>,
+  process_plane_avx2<uint16_t, repair_mode17_avx2_16<false>, RG_BLOCK_ROWS>,
+  process_plane_avx2<uint16_t, repair_mode18_avx2_16<false>>,
+  process_plane_avx2<uint16_t, repair_mode19_avx2_16<10, false>>,
+  process_plane_avx2<uint16_t, repair_mode20_avx2_16<10, false>>,
+  process_plane_avx2<uint16_t, repair_mode21_avx2_16<10, false>>,
+  process_plane_avx2<uint16_t, repair_mode22_avx2_16<10, false>>,
+  process_plane_avx2<uint16_t, repair_mode23_avx2_16<10, false>>,
+  process_plane_avx2<uint16_t, repair_mode24_avx2_16<10, false>>
+};
+
+// RgBench: the row blocked modes of avx2_functions_16_10 with one row per iteration, nullptr for the other modes
+RepairPlaneProcessor* avx2_functions_16_10_rows1[] = {
+    nullptr, nullptr,
+  process_plane_avx2<uint16_t, repair_mode1_avx2_16<false>, 1>,
+    nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+  process_plane_avx2<uint16_t, repair_mode1_avx2_16<false>, 1>,
+    nullptr, nullptr, nullptr, nullptr, nullptr,
+  process_plane_avx2<uint16_t, repair_mode17_avx2_16<false>, 1>,
+    nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+};
+
+RepairPlaneProcessor* avx2_functions_16_12[] = {
+  doNothing,
+  copyPlane,
+  process_plane_avx2<uint16_t, repair_mode1_avx2_16<false>, RG_BLOCK_ROWS>,
+  process_plane_colsort<ColsortAvx2_16, CS_RANK1>,
+  process_plane_colsort<ColsortAvx2_16, CS_RANK2>,
+  process_plane_colsort<ColsortAvx2_16, CS_RANK3>,
+  process_plane_avx2<uint16_t, repair_mode5_avx2_16<false>>,
+  process_plane_avx2<uint16_t, repair_mode6_avx2_16<12, false>>,
+  process_plane_avx2<uint16_t, repair_mode7_avx2_16<false>>,
+  process_plane_avx2<uint16_t, repair_mode8_avx2_16<12, false>>,
+  process_plane_avx2<uint16_t, repair_mode9_avx2_16<false>>,
+  process_plane_avx2<uint16_t, repair_mode10_avx2_16<false>>,
+  process_plane_avx2<uint16_t, repair_mode1_avx2_16<false>, RG_BLOCK_ROWS>,
+  process_plane_avx2<uint16_t, repair_mode12_avx2_16<false>>,
+  process_plane_avx2<uint16_t, repair_mode13_avx2_16<false>>,
+  process_plane_avx2<uint16_t, repair_mode14_avx2_16<false>>,
+  process_plane_avx2<uint16_t, repair_mode15_avx2_16<false>>,
+  process_plane_avx2<uint16_t, repair_mode16_avx2_16<12, false>>,
+  process_plane_avx2<uint16_t, repair_mode17_avx2_16<false>, RG_BLOCK_ROWS>,
+  process_plane_avx2<uint16_t, repair_mode18_avx2_16<false>>,
+  process_plane_avx2<uint16_t, repair_mode19_avx2_16<12, false>>,
+  process_plane_avx2<uint16_t, repair_mode20_avx2_16<12, false>>,
+  process_plane_avx2<uint16_t, repair_mode21_avx2_16<12, false>>,
+  process_plane_avx2<uint16_t, repair_mode22_avx2_16<12, false>>,
+  process_plane_avx2<uint16_t, repair_mode23_avx2_16<12, false>>,
+  process_plane_avx2<uint16_t, repair_mode24_avx2_16<12, false>>
+};
+
+// RgBench: the row blocked modes of avx2_functions_16_12 with one row per iteration, nullptr for the other modes
+RepairPlaneProcessor* avx2_functions_16_12_rows1[] = {
+    nullptr, nullptr,
+  process_plane_avx2<uint16_t, repair_mode1_avx2_16<false>, 1>,
+    nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+  process_plane_avx2<uint16_t, repair_mode1_avx2_16<false>, 1>,
+    nullptr, nullptr, nullptr, nullptr, nullptr,
+  process_plane_avx2<uint16_t, repair_mode17_avx2_16<false>, 1>,
+    nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+};
+
+RepairPlaneProcessor* avx2_functions_16_14[] = {
+  doNothing,
+  copyPlane,
+  process_plane_avx2<uint16_t, repair_mode1_avx2_16<false>, RG_BLOCK_ROWS>,
+  process_plane_colsort<ColsortAvx2_16, CS_RANK1>,
+  process_plane_colsort<ColsortAvx2_16, CS_RANK2>,
+  process_plane_colsort<ColsortAvx2_16, CS_RANK3>,
+  process_plane_avx2<uint16_t, repair_mode5_avx2_16<false>>,
+  process_plane_avx2<uint16_t, repair_mode6_avx2_16<14, false>>,
+  process_plane_avx2<uint16_t, repair_mode7_avx2_16<false>>,
+  process_plane_avx2<uint16_t, repair_mode8_avx2_16<14, false>>,
+  process_plane_avx2<uint16_t, repair_mode9_avx2_16<false>>,
+  process_plane_avx2<uint16_t, repair_mode10_avx2_16<false>>,
+  process_plane_avx2<uint16_t, repair_mode1_avx2_16<false>, RG_BLOCK_ROWS>,
+  process_plane_avx2<uint16_t, repair_mode12_avx2_16<false>>,
+  process_plane_avx2<uint16_t, repair_mode13_avx2_16<false>>,
+  process_plane_avx2<uint16_t, repair_mode14_avx2_16<false>>,
+  process_plane_avx2<uint16_t, repair_mode15_avx2_16<false>>,
+  process_plane_avx2<uint16_t, repair_mode16_avx2_16<14, false>>,
+  process_plane_avx2<uint16_t, repair_mode17_avx2_16<false>, RG_BLOCK_ROWS>,
+  process_plane_avx2<uint16_t, repair_mode18_avx2_16<false>>,
+  process_plane_avx2<uint16_t, repair_mode19_avx2_16<14, false>>,
+  process_plane_avx2<uint16_t, repair_mode20_avx2_16<14, false>>,
+  process_plane_avx2<uint16_t, repair_mode21_avx2_16<14, false>>,
+  process_plane_avx2<uint16_t, repair_mode22_avx2_16<14, false>>,
+  process_plane_avx2<uint16_t, repair_mode23_avx2_16<14, false>>,
+  process_plane_avx2<uint16_t, repair_mode24_avx2_16<14, false>>
+};
+
+// RgBench: the row blocked modes of avx2_functions_16_14 with one row per iteration, nullptr for the other modes
+RepairPlaneProcessor* avx2_functions_16_14_rows1[] = {
+    nullptr, nullptr,
+  process_plane_avx2<uint16_t, repair_mode1_avx2_16<false>, 1>,
+    nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+  process_plane_avx2<uint16_t, repair_mode1_avx2_16<false>, 1>,
+    nullptr, nullptr, nullptr, nullptr, nullptr,
+  process_plane_avx2<uint16_t, repair_mode17_avx2_16<false>, 1>,
+    nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+};
+
+RepairPlaneProcessor* avx2_functions_16_16[] = {
+  doNothing,
+  copyPlane,
+  process_plane_avx2<uint16_t, repair_mode1_avx2_16<false>, RG_BLOCK_ROWS>,
+  process_plane_colsort<ColsortAvx2_16, CS_RANK1>,
+  process_plane_colsort<ColsortAvx2_16, CS_RANK2>,
+  process_plane_colsort<ColsortAvx2_16, CS_RANK3>,
+  process_plane_avx2<uint16_t, repair_mode5_avx2_16<false>>,
+  process_plane_avx2<uint16_t, repair_mode6_avx2_16<16, false>>,
+  process_plane_avx2<uint16_t, repair_mode7_avx2_16<false>>,
+  process_plane_avx2<uint16_t, repair_mode8_avx2_16<16, false>>,
+  process_plane_avx2<uint16_t, repair_mode9_avx2_16<false>>,
+  process_plane_avx2<uint16_t, repair_mode10_avx2_16<false>>,
+  process_plane_avx2<uint16_t, repair_mode1_avx2_16<false>, RG_BLOCK_ROWS>,
+  process_plane_avx2<uint16_t, repair_mode12_avx2_16<false>>,
+  process_plane_avx2<uint16_t, repair_mode13_avx2_16<false>>,
+  process_plane_avx2<uint16_t, repair_mode14_avx2_16<false>>,
+  process_plane_avx2<uint16_t, repair_mode15_avx2_16<false>>,
+  process_plane_avx2<uint16_t, repair_mode16_avx2_16<16, false>>,
+  process_plane_avx2<uint16_t, repair_mode17_avx2_16<false>, RG_BLOCK_ROWS>,
+  process_plane_avx2<uint16_t, repair_mode18_avx2_16<false>>,
+  process_plane_avx2<uint16_t, repair_mode19_avx2_16<16, false>>,
+  process_plane_avx2<uint16_t, repair_mode20_avx2_16<16, false>>,
+  process_plane_avx2<uint16_t, repair_mode21_avx2_16<16, false>>,
+  process_plane_avx2<uint16_t, repair_mode22_avx2_16<16, false>>,
+  process_plane_avx2<uint16_t, repair_mode23_avx2_16<16, false>>,
+  process_plane_avx2<uint16_t, repair_mode24_avx2_16<16, false>>
+};
+
+// RgBench: the row blocked modes of avx2_functions_16_16 with one row per iteration, nullptr for the other modes
+RepairPlaneProcessor* avx2_functions_16_16_rows1[] = {
+    nullptr, nullptr,
+  process_plane_avx2<uint16_t, repair_mode1_avx2_16<false>, 1>,
+    nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+  process_plane_avx2<uint16_t, repair_mode1_avx2_16<false>, 1>,
+    nullptr, nullptr, nullptr, nullptr, nullptr,
+  process_plane_avx2<uint16_t, repair_mode17_avx2_16<false>, 1>,
+    nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+};
+
+RepairPlaneProcessor* avx2_functions_32[] = {
+  doNothing,
+  copyPlane,
+  process_plane_avx2<float, repair_mode1_avx2_32<false>, RG_BLOCK_ROWS>,
+  process_plane_colsort<ColsortAvx2_32, CS_RANK1>,
+  process_plane_colsort<ColsortAvx2_32, CS_RANK2>,
+  process_plane_colsort<ColsortAvx2_32, CS_RANK3>,
+  process_plane_avx2<float, repair_mode5_avx2_32<false>>,
+  process_plane_avx2<float, repair_mode6_avx2_32<false>>,
+  process_plane_avx2<float, repair_mode7_avx2_32<false>>,
+  process_plane_avx2<float, repair_mode8_avx2_32<false>>,
+  process_plane_avx2<float, repair_mode9_avx2_32<false>>,
+  process_plane_avx2<float, repair_mode10_avx2_32<false>>,
+  process_plane_avx2<float, repair_mode1_avx2_32<false>, RG_BLOCK_ROWS>,
+  process_plane_avx2<float, repair_mode12_avx2_32<false>>,
+  process_plane_avx2<float, repair_mode13_avx2_32<false>>,
+  process_plane_avx2<float, repair_mode14_avx2_32<false>>,
+  process_plane_avx2<float, repair_mode15_avx2_32<false>>,
+  process_plane_avx2<float, repair_mode16_avx2_32<false>>,
+  process_plane_avx2<float, repair_mode17_avx2_32<false>, RG_BLOCK_ROWS>,
+  process_plane_avx2<float, repair_mode18_avx2_32<false>>,
+  process_plane_avx2<float, repair_mode19_avx2_32<false>>,
+  process_plane_avx2<float, repair_mode20_avx2_32<false>>,
+  process_plane_avx2<float, repair_mode21_avx2_32<false>>,
+  process_plane_avx2<float, repair_mode22_avx2_32<false>>,
+  process_plane_avx2<float, repair_mode23_avx2_32<false>>,
+  process_plane_avx2<float, repair_mode24_avx2_32<false>>
+};
+
+// RgBench: the row blocked modes of avx2_functions_32 with one row per iteration, nullptr for the other modes
+RepairPlaneProcessor* avx2_functions_32_rows1[] = {
+    nullptr, nullptr,
+  process_plane_avx2<float, repair_mode1_avx2_32<false>, 1>,
+    nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+  process_plane_avx2<float, repair_mode1_avx2_32<false>, 1>,
+    nullptr, nullptr, nullptr, nullptr, nullptr,
+  process_plane_avx2<float, repair_mode17_avx2_32<false>, 1>,
+    nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+};
+
+// AVX2 + FMA3, see repair_functions_fma.h
+RepairPlaneProcessor* avx2_fma_functions_32[] = {
+  doNothing,
+  copyPlane,
+  process_plane_avx2<float, repair_mode1_avx2_32<false>, RG_BLOCK_ROWS>,
+  process_plane_colsort<ColsortAvx2_32, CS_RANK1>,
+  process_plane_colsort<ColsortAvx2_32, CS_RANK2>,
+  process_plane_colsort<ColsortAvx2_32, CS_RANK3>,
+  process_plane_avx2<float, repair_mode5_avx2_32<false>>,
+  process_plane_avx2<float, repair_mode6_fma_32<false>>,
+  process_plane_avx2<float, repair_mode7_avx2_32<false>>,
+  process_plane_avx2<float, repair_mode8_fma_32<false>>,
+  process_plane_avx2<float, repair_mode9_avx2_32<false>>,
+  process_plane_avx2<float, repair_mode10_avx2_32<false>>,
+  process_plane_avx2<float, repair_mode1_avx2_32<false>, RG_BLOCK_ROWS>,
+  process_plane_avx2<float, repair_mode12_avx2_32<false>>,
+  process_plane_avx2<float, repair_mode13_avx2_32<false>>,
+  process_plane_avx2<float, repair_mode14_avx2_32<false>>,
+  process_plane_avx2<float, repair_mode15_avx2_32<false>>,
+  process_plane_avx2<float, repair_mode16_fma_32<false>>,
+  process_plane_avx2<float, repair_mode17_avx2_32<false>, RG_BLOCK_ROWS>,
+  process_plane_avx2<float, repair_mode18_avx2_32<false>>,
+  process_plane_avx2<float, repair_mode19_avx2_32<false>>,
+  process_plane_avx2<float, repair_mode20_avx2_32<false>>,
+  process_plane_avx2<float, repair_mode21_avx2_32<false>>,
+  process_plane_avx2<float, repair_mode22_avx2_32<false>>,
+  process_plane_avx2<float, repair_mode23_avx2_32<false>>,
+  process_plane_avx2<float, repair_mode24_avx2_32<false>>
+};
+
+// RgBench: the row blocked modes of avx2_fma_functions_32 with one row per iteration, nullptr for the other modes
+RepairPlaneProcessor* avx2_fma_functions_32_rows1[] = {
+    nullptr, nullptr,
+  process_plane_avx2<float, repair_mode1_avx2_32<false>, 1>,
+    nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+  process_plane_avx2<float, repair_mode1_avx2_32<false>, 1>,
+    nullptr, nullptr, nullptr, nullptr, nullptr,
+  process_plane_avx2<float, repair_mode17_avx2_32<false>, 1>,
+    nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+};
+
+}
@@ -0,0 +1,281 @@
+#include "repair_functions_avx512.h"
+#include "colsort_avx512.h"
+#include "repair.h"
+
+// AVX-512BW, see common_avx512.h and removegrain_avx512.cpp: 64 byte vectors,
+// masked stores for the partial first and last vector of a row
+
+// 'rows' (1 or 2) output rows per call, see process_column_sse in repair.cpp
+template<SseModeProcessor processor, int rows>
+static RG_FORCEINLINE void process_column_avx512(Byte* pDst, const Byte* pSrc, const Byte* pRef, int dstPitch, int srcPitch, int refPitch, __mmask64 mask) {
+    __m512i r0 = processor(pRef, simd_loadu_si512(pSrc), refPitch);
+    __m512i r1;
+    if (rows > 1) r1 = processor(pRef + refPitch, simd_loadu_si512(pSrc + srcPitch), refPitch);
+    if (mask == ~0ULL) {
+        _mm512_storeu_si512(reinterpret_cast<__m512i*>(pDst), r0);
+        if (rows > 1) _mm512_storeu_si512(reinterpret_cast<__m512i*>(pDst + dstPitch), r1);
+    } else {
+        simd_mask_storeu(pDst, mask, r0);
+        if (rows > 1) simd_mask_storeu(pDst + dstPitch, mask, r1);
+    }
+}
+
+template<typename pixel_t, SseModeProcessor processor, int rows>
+static RG_FORCEINLINE void process_rows_avx512(Byte* pDst, const Byte* pSrc, const Byte* pRef, int dstPitch, int srcPitch, int refPitch, int width) {
+    const int pixels_at_a_time = 64 / sizeof(pixel_t);
+    const int mod_width = width / pixels_at_a_time * pixels_at_a_time;
+
+    for (int r = 0; r < rows; ++r)
+        reinterpret_cast<pixel_t*>(pDst + r * dstPitch)[0] = reinterpret_cast<const pixel_t*>(pSrc + r * srcPitch)[0];
+
+    if (width < pixels_at_a_time + 2) {
+        // narrow plane: one partial vector on staged copies of the rows
+        for (int r = 0; r < rows && width > 2; ++r) {
+            const Byte* pSrcRow = pSrc + r * srcPitch;
+            process_row_staged<pixel_t>(pDst + r * dstPitch, pRef + r * refPitch, refPitch, width, [&](const Byte* pStage, int stagePitch) {
+                alignas(64) Byte val[RG_STAGE_PITCH] = {};
+                memcpy(val, pSrcRow, width * sizeof(pixel_t));
+                return processor(pStage, simd_loadu_si512(val + sizeof(pixel_t)), stagePitch);
+            });
+        }
+    } else {
+        // pixels 1 .. pixels_at_a_time-1, the last lane belongs to the loop below
+        process_column_avx512<processor, rows>(pDst + sizeof(pixel_t), pSrc + sizeof(pixel_t), pRef + sizeof(pixel_t), dstPitch, srcPitch, refPitch,
+            first_bytes_mask((pixels_at_a_time - 1) * sizeof(pixel_t)));
+
+        for (int x = pixels_at_a_time; x < mod_width-1; x+= pixels_at_a_time) {
+            const int offset = x * sizeof(pixel_t);
+            process_column_avx512<processor, rows>(pDst + offset, pSrc + offset, pRef + offset, dstPitch, srcPitch, refPitch, ~0ULL);
+        }
+
+        if (mod_width < width - 1) {
+            // last vector ends at pixel width-2, only the lanes after mod_width are new
+            const int x = width - 1 - pixels_at_a_time;
+            const int offset = x * sizeof(pixel_t);
+            process_column_avx512<processor, rows>(pDst + offset, pSrc + offset, pRef + offset, dstPitch, srcPitch, refPitch,
+                from_byte_mask((mod_width - x) * sizeof(pixel_t)));
+        }
+    }
+
+    for (int r = 0; r < rows; ++r)
+        reinterpret_cast<pixel_t*>(pDst + r * dstPitch)[width-1] = reinterpret_cast<const pixel_t*>(pSrc + r * srcPitch)[width-1];
+}
+
+template<typename pixel_t, SseModeProcessor processor, int rows = 1>
+static void process_plane_avx512(IScriptEnvironment* env, BYTE* pDst, const BYTE* pSrc, const BYTE* pRef, int dstPitch, int srcPitch, int refPitch, int rowsize, int height) {
+    _mm256_zeroupper();
+
+    env->BitBlt(pDst, dstPitch, pSrc, srcPitch, rowsize, 1);
+
+    const int width = rowsize / sizeof(pixel_t);
+
+    pSrc += srcPitch;
+    pDst += dstPitch;
+    pRef += refPitch;
+
+    int y = 1;
+    for (; y + rows <= height-1; y += rows) {
+        process_rows_avx512<pixel_t, processor, rows>(pDst, pSrc, pRef, dstPitch, srcPitch, refPitch, width);
+        pSrc += srcPitch * rows;
+        pDst += dstPitch * rows;
+        pRef += refPitch * rows;
+    }
+    for (; y < height-1; ++y) {
+        process_rows_avx512<pixel_t, processor, 1>(pDst, pSrc, pRef, dstPitch, srcPitch, refPitch, width);
+        pSrc += srcPitch;
+        pDst += dstPitch;
+        pRef += refPitch;
+    }
+    _mm256_zeroupper();
+
+    env->BitBlt(pDst, dstPitch, pSrc, srcPitch, rowsize, 1);
+}
+
+static void doNothing(IScriptEnvironment* env, BYTE* pDst, const BYTE* pSrc, const BYTE* pRef, int dstPitch, int srcPitch, int refPitch, int rowsize, int height) {
+
+}
+
+static void copyPlane(IScriptEnvironment* env, BYTE* pDst, const BYTE* pSrc, const BYTE* pRef, int dstPitch, int srcPitch, int refPitch, int rowsize, int height) {
+  _mm256_zeroupper(); // paranoia
+  env->BitBlt(pDst, dstPitch, pSrc, srcPitch, rowsize, height);
+}
+
+
+namespace repair {
+
+RepairPlaneProcessor* avx512_functions[] = {
+  doNothing,
+  copyPlane,
+  process_plane_avx512<uint8_t, repair_mode1_avx512<false>, RG_BLOCK_ROWS>,
+  process_plane_colsort<ColsortAvx512_8, CS_RANK1>,
+  process_plane_colsort<ColsortAvx512_8, CS_RANK2>,
+  process_plane_colsort<ColsortAvx512_8, CS_RANK3>,
+  process_plane_avx512<uint8_t, repair_mode5_avx512<false>>,
+  process_plane_avx512<uint8_t, repair_mode6_avx512<false>>,
+  process_plane_avx512<uint8_t, repair_mode7_avx512<false>>,
+  process_plane_avx512<uint8_t, repair_mode8_avx512<false>>,
+  process_plane_avx512<uint8_t, repair_mode9_avx512<false>>,
+  process_plane_avx512<uint8_t, repair_mode10_avx512<false>>,
+  process_plane_avx512<uint8_t, repair_mode1_avx512<false>, RG_BLOCK_ROWS>,
+  process_plane_avx512<uint8_t, repair_mode12_avx512<false>>,
+  process_plane_avx512<uint8_t, repair_mode13_avx512<false>>,
+  process_plane_avx512<uint8_t, repair_mode14_avx512<false>>,
+  process_plane_avx512<uint8_t, repair_mode15_avx512<false>>,
+  process_plane_avx512<uint8_t, repair_mode16_avx512<false>>,
+  process_plane_avx512<uint8_t, repair_mode17_avx512<false>, RG_BLOCK_ROWS>,
+  process_plane_avx512<uint8_t, repair_mode18_avx512<false>>,
+  process_plane_avx512<uint8_t, repair_mode19_avx512<false>>,
+  process_plane_avx512<uint8_t, repair_mode20_avx512<false>>,
+  process_plane_avx512<uint8_t, repair_mode21_avx512<false>>,
+  process_plane_avx512<uint8_t, repair_mode22_avx512<false>>,
+  process_plane_avx512<uint8_t, repair_mode23_avx512<false>>,
+  process_plane_avx512<uint8_t, repair_mode24_avx512<false>>
+};
+
+RepairPlaneProcessor* avx512_functions_16_10[] = {
+  doNothing,
+  copyPlane,
+  process_plane_avx512<uint16_t, repair_mode1_avx512_16<false>, RG_BLOCK_ROWS>,
+  process_plane_colsort<ColsortAvx512_16, CS_RANK1>,
+  process_plane_colsort<ColsortAvx512_16, CS_RANK2>,
+  process_plane_colsort<ColsortAvx512_16, CS_RANK3>,
+  process_plane_avx512<uint16_t, repair_mode5_avx512_16<false>>,
+  process_plane_avx512<uint16_t, repair_mode6_avx512_16<10, false>>,
+  process_plane_avx512<uint16_t, repair_mode7_avx512_16<false>>,
+  process_plane_avx512<uint16_t, repair_mode8_avx512_16<10, false>>,
+  process_plane_avx512<uint16_t, repair_mode9_avx512_16<false>>,
+  process_plane_avx512<uint16_t, repair_mode10_avx512_16<false>>,
+  process_plane_avx512<uint16_t, repair_mode1_avx512_16<false>, RG_BLOCK_ROWS>,
+  process_plane_avx512<uint16_t, repair_mode12_avx512_16<false>>,
+  process_plane_avx512<uint16_t, repair_mode13_avx512_16<false>>,
+  process_plane_avx512<uint16_t, repair_mode14_avx512_16<false>>,
+  process_plane_avx512<uint16_t, repair_mode15_avx512_16<false>>,
+  process_plane_avx512<uint16_t, repair_mode16_avx512_16<10, false>>,
+  process_plane_avx512<uint16_t, repair_mode17_avx512_16<false>, RG_BLOCK_ROWS>,
+  process_plane_avx512<uint16_t, repair_mode18_avx512_16<false>>,
+  process_plane_avx512<uint16_t, repair_mode19_avx512_16<10, false>>,
+  process_plane_avx512<uint16_t, repair_mode20_avx512_16<10, false>>,
+  process_plane_avx512<uint16_t, repair_mode21_avx512_16<10, false>>,
+  process_plane_avx512<uint16_t, repair_mode22_avx512_16<10, false>>,
+  process_plane_avx512<uint16_t, repair_mode23_avx512_16<10, false>>,
+  process_plane_avx512<uint16_t, repair_mode24_avx512_16<10, false>>
+};
+
+RepairPlaneProcessor* avx512_functions_16_12[] = {
+  doNothing,
+  copyPlane,
+  process_plane_avx512<uint16_t, repair_mode1_avx512_16<false>, RG_BLOCK_ROWS>,
+  process_plane_colsort<ColsortAvx512_16, CS_RANK1>,
+  process_plane_colsort<ColsortAvx512_16, CS_RANK2>,
+  process_plane_colsort<ColsortAvx512_16, CS_RANK3>,
+  process_plane_avx512<uint16_t, repair_mode5_avx512_16<false>>,
+  process_plane_avx512<uint16_t, repair_mode6_avx512_16<12, false>>,
+  process_plane_avx512<uint16_t, repair_mode7_avx512_16<false>>,
+  process_plane_avx512<uint16_t, repair_mode8_avx512_16<12, false>>,
+  process_plane_avx512<uint16_t, repair_mode9_avx512_16<false>>,
+  process_plane_avx512<uint16_t, repair_mode10_avx512_16<false>>,
+  process_plane_avx512<uint16_t, repair_mode1_avx512_16<false>, RG_BLOCK_ROWS>,
+  process_plane_avx512<uint16_t, repair_mode12_avx512_16<false>>,
+  process_plane_avx512<uint16_t, repair_mode13_avx512_16<false>>,
+  process_plane_avx512<uint16_t, repair_mode14_avx512_16<false>>,
+  process_plane_avx512<uint16_t, repair_mode15_avx512_16<false>>,
+  process_plane_avx512<uint16_t, repair_mode16_avx512_16<12, false>>,
+  process_plane_avx512<uint16_t, repair_mode17_avx512_16<false>, RG_BLOCK_ROWS>,
+  process_plane_avx512<uint16_t, repair_mode18_avx512_16<false>>,
+  process_plane_avx512<uint16_t, repair_mode19_avx512_16<12, false>>,
+  process_plane_avx512<uint16_t, repair_mode20_avx512_16<12, false>>,
+  process_plane_avx512<uint16_t, repair_mode21_avx512_16<12, false>>,
+  process_plane_avx512<uint16_t, repair_mode22_avx512_16<12, false>>,
+  process_plane_avx512<uint16_t, repair_mode23_avx512_16<12, false>>,
+  process_plane_avx512<uint16_t, repair_mode24_avx512_16<12, false>>
+};
+
+RepairPlaneProcessor* avx512_functions_16_14[] = {
+  doNothing,
+  copyPlane,
+  process_plane_avx512<uint16_t, repair_mode1_avx512_16<false>, RG_BLOCK_ROWS>,
+  process_plane_colsort<ColsortAvx512_16, CS_RANK1>,
+  process_plane_colsort<ColsortAvx512_16, CS_RANK2>,
+  process_plane_colsort<ColsortAvx512_16, CS_RANK3>,
+  process_plane_avx512<uint16_t, repair_mode5_avx512_16<false>>,
+  process_plane_avx512<uint16_t, repair_mode6_avx512_16<14, false>>,
+  process_plane_avx512<uint16_t, repair_mode7_avx512_16<false>>,
+  process_plane_avx512<uint16_t, repair_mode8_avx512_16<14, false>>,
+  process_plane_avx512<uint16_t, repair_mode9_avx512_16<false>>,
+  process_plane_avx512<uint16_t, repair_mode10_avx512_16<false>>,
+  process_plane_avx512<uint16_t, repair_mode1_avx512_16<false>, RG_BLOCK_ROWS>,
+  process_plane_avx512<uint16_t, repair_mode12_avx512_16<false>>,
+  process_plane_avx512<uint16_t, repair_mode13_avx512_16<false>>,
+  process_plane_avx512<uint16_t, repair_mode14_avx512_16<false>>,
+  process_plane_avx512<uint16_t, repair_mode15_avx512_16<false>>,
+  process_plane_avx512<uint16_t, repair_mode16_avx512_16<14, false>>,
+  process_plane_avx512<uint16_t, repair_mode17_avx512_16<false>, RG_BLOCK_ROWS>,
+  process_plane_avx512<uint16_t, repair_mode18_avx512_16<false>>,
+  process_plane_avx512<uint16_t, repair_mode19_avx512_16<14, false>>,
+  process_plane_avx512<uint16_t, repair_mode20_avx512_16<14, false>>,
+  process_plane_avx512<uint16_t, repair_mode21_avx512_16<14, false>>,
+  process_plane_avx512<uint16_t, repair_mode22_avx512_16<14, false>>,
+  process_plane_avx512<uint16_t, repair_mode23_avx512_16<14, false>>,
+  process_plane_avx512<uint16_t, repair_mode24_avx512_16<14, false>>
+};
+
+RepairPlaneProcessor* avx512_functions_16_16[] = {
+  doNothing,
+  copyPlane,
+  process_plane_avx512<uint16_t, repair_mode1_avx512_16<false>, RG_BLOCK_ROWS>,
+  process_plane_colsort<ColsortAvx512_16, CS_RANK1>,
+  process_plane_colsort<ColsortAvx512_16, CS_RANK2>,
+  process_plane_colsort<ColsortAvx512_16, CS_RANK3>,
+  process_plane_avx512<uint16_t, repair_mode5_avx512_16<false>>,
+  process_plane_avx512<uint16_t, repair_mode6_avx512_16<16, false>>,
+  process_plane_avx512<uint16_t, repair_mode7_avx512_16<false>>,
+  process_plane_avx512<uint16_t, repair_mode8_avx512_16<16, false>>,
+  process_plane_avx512<uint16_t, repair_mode9_avx512_16<false>>,
+  process_plane_avx512<uint16_t, repair_mode10_avx512_16<false>>,
+  process_plane_avx512<uint16_t, repair_mode1_avx512_16<false>, RG_BLOCK_ROWS>,
+  process_plane_avx512<uint16_t, repair_mode12_avx512_16<false>>,
+  process_plane_avx512<uint16_t, repair_mode13_avx512_16<false>>,
+  process_plane_avx512<uint16_t, repair_mode14_avx512_16<false>>,
+  process_plane_avx512<uint16_t, repair_mode15_avx512_16<false>>,
+  process_plane_avx512<uint16_t, repair_mode16_avx512_16<16, false>>,
+  process_plane_avx512<uint16_t, repair_mode17_avx512_16<false>, RG_BLOCK_ROWS>,
+  process_plane_avx512<uint16_t, repair_mode18_avx512_16<false>>,
+  process_plane_avx512<uint16_t, repair_mode19_avx512_16<16, false>>,
+  process_plane_avx512<uint16_t, repair_mode20_avx512_16<16, false>>,
+  process_plane_avx512<uint16_t, repair_mode21_avx512_16<16, false>>,
+  process_plane_avx512<uint16_t, repair_mode22_avx512_16<16, false>>,
+  process_plane_avx512<uint16_t, repair_mode23_avx512_16<16, false>>,
+  process_plane_avx512<uint16_t, repair_mode24_avx512_16<16, false>>
+};
+
+// float: the FMA kernels, see repair_functions_fma.h
+RepairPlaneProcessor* avx512_functions_32[] = {
+  doNothing,
+  copyPlane,
+  process_plane_avx512<float, repair_mode1_avx512_32<false>, RG_BLOCK_ROWS>,
+  process_plane_colsort<ColsortAvx512_32, CS_RANK1>,
+  process_plane_colsort<ColsortAvx512_32, CS_RANK2>,
+  process_plane_colsort<ColsortAvx512_32, CS_RANK3>,
+  process_plane_avx512<float, repair_mode5_avx512_32<false>>,
+  process_plane_avx512<float, repair_mode6_avx512_32<false>>,
+  process_plane_avx512<float, repair_mode7_avx512_32<false>>,
+  process_plane_avx512<float, repair_mode8_avx512_32<false>>,
+  process_plane_avx512<float, repair_mode9_avx512_32<false>>,
+  process_plane_avx512<float, repair_mode10_avx512_32<false>>,
+  process_plane_avx512<float, repair_mode1_avx512_32<false>, RG_BLOCK_ROWS>,
+  process_plane_avx512<float, repair_mode12_avx512_32<false>>,
+  process_plane_avx512<float, repair_mode13_avx512_32<false>>,
+  process_plane_avx512<float, repair_mode14_avx512_32<false>>,
+  process_plane_avx512<float, repair_mode15_avx512_32<false>>,
+  process_plane_avx512<float, repair_mode16_avx512_32<false>>,
+  process_plane_avx512<float, repair_mode17_avx512_32<false>, RG_BLOCK_ROWS>,
+  process_plane_avx512<float, repair_mode18_avx512_32<false>>,
+  process_plane_avx512<float, repair_mode19_avx512_32<false>>,
+  process_plane_avx512<float, repair_mode20_avx512_32<false>>,
+  process_plane_avx512<float, repair_mode21_avx512_32<false>>,
+  process_plane_avx512<float, repair_mode22_avx512_32<false>>,
+  process_plane_avx512<float, repair_mode23_avx512_32<false>>,
+  process_plane_avx512<float, repair_mode24_avx512_32<false>>
+};
+
+}
@@ -2,7 +2,6 @@
 #define __REPAIR_FUNCTIONS_C_H__
 
 #include "common.h"
-#include <xutility>
 #include <algorithm>  
 #include <utility>
 
@@ -62,7 +61,7 @@ RG_FORCEINLINE Byte repair_mode2_cpp(const Byte* pSrc, Byte val, int srcPitch) {
 
     Byte a[9] = { a1, a2, a3, a4, c, a5, a6, a7, a8 };
 
-    std::sort(std::begin(a), std::end(a));
+    sort9_c(a);
 
     return clip(val, a[1], a[7]);
 }
@@ -72,7 +71,7 @@ RG_FORCEINLINE uint16_t repair_mode2_cpp_16(const Byte* pSrc, uint16_t val, int
 
   uint16_t a[9] = { a1, a2, a3, a4, c, a5, a6, a7, a8 };
 
-  std::sort(std::begin(a), std::end(a));
+  sort9_c(a);
 
   return clip_16(val, a[1], a[7]);
 }
@@ -82,7 +81,7 @@ RG_FORCEINLINE float repair_mode2_cpp_32(const Byte* pSrc, float val, int srcPit
 
   float a[9] = { a1, a2, a3, a4, c, a5, a6, a7, a8 };
 
-  std::sort(std::begin(a), std::end(a));
+  sort9_c(a);
 
   return clip_32(val, a[1], a[7]);
 }
@@ -94,7 +93,7 @@ RG_FORCEINLINE Byte repair_mode3_cpp(const Byte* pSrc, Byte val, int srcPitch) {
 
     Byte a[9] = { a1, a2, a3, a4, c, a5, a6, a7, a8 };
 
-    std::sort(std::begin(a), std::end(a));
+    sort9_c(a);
 
     return clip(val, a[2], a[6]);
 }
@@ -104,7 +103,7 @@ RG_FORCEINLINE uint16_t repair_mode3_cpp_16(const Byte* pSrc, uint16_t val, int
 
   uint16_t a[9] = { a1, a2, a3, a4, c, a5, a6, a7, a8 };
 
-  std::sort(std::begin(a), std::end(a));
+  sort9_c(a);
 
   return clip_16(val, a[2], a[6]);
 }
@@ -114,7 +113,7 @@ RG_FORCEINLINE float repair_mode3_cpp_32(const Byte* pSrc, float val, int srcPit
 
   float a[9] = { a1, a2, a3, a4, c, a5, a6, a7, a8 };
 
-  std::sort(std::begin(a), std::end(a));
+  sort9_c(a);
 
   return clip_32(val, a[2], a[6]);
 }
@@ -126,7 +125,7 @@ RG_FORCEINLINE Byte repair_mode4_cpp(const Byte* pSrc, Byte val, int srcPitch) {
 
     Byte a[9] = { a1, a2, a3, a4, c, a5, a6, a7, a8 };
 
-    std::sort(std::begin(a), std::end(a));
+    sort9_c(a);
 
     return clip(val, a[3], a[5]);
 }
@@ -136,7 +135,7 @@ RG_FORCEINLINE uint16_t repair_mode4_cpp_16(const Byte* pSrc, uint16_t val, int
 
   uint16_t a[9] = { a1, a2, a3, a4, c, a5, a6, a7, a8 };
 
-  std::sort(std::begin(a), std::end(a));
+  sort9_c(a);
 
   return clip_16(val, a[3], a[5]);
 }
@@ -146,7 +145,7 @@ RG_FORCEINLINE float repair_mode4_cpp_32(const Byte* pSrc, float val, int srcPit
 
   float a[9] = { a1, a2, a3, a4, c, a5, a6, a7, a8 };
 
-  std::sort(std::begin(a), std::end(a));
+  sort9_c(a);
 
   return clip_32(val, a[3], a[5]);
 }
@@ -175,10 +174,11 @@ RG_FORCEINLINE Byte repair_mode5_cpp(const Byte* pSrc, Byte val, int srcPitch) {
 
     auto mindiff = std::min(std::min(std::min(c1, c2), c3), c4);
 
-    if (mindiff == c4) return clip(val, mil4, mal4);
-    if (mindiff == c2) return clip(val, mil2, mal2);
-    if (mindiff == c3) return clip(val, mil3, mal3);
-    return clip(val, mil1, mal1);
+    auto result = clip(val, mil1, mal1);
+    result = mindiff == c3 ? clip(val, mil3, mal3) : result;
+    result = mindiff == c2 ? clip(val, mil2, mal2) : result;
+    result = mindiff == c4 ? clip(val, mil4, mal4) : result;
+    return result;
 }
 
 RG_FORCEINLINE uint16_t repair_mode5_cpp_16(const Byte* pSrc, uint16_t val, int srcPitch) {
@@ -203,10 +203,11 @@ RG_FORCEINLINE uint16_t repair_mode5_cpp_16(const Byte* pSrc, uint16_t val, int
 
   auto mindiff = std::min(std::min(std::min(c1, c2), c3), c4);
 
-  if (mindiff == c4) return clip_16(val, mil4, mal4);
-  if (mindiff == c2) return clip_16(val, mil2, mal2);
-  if (mindiff == c3) return clip_16(val, mil3, mal3);
-  return clip_16(val, mil1, mal1);
+  auto result = clip_16(val, mil1, mal1);
+  result = mindiff == c3 ? clip_16(val, mil3, mal3) : result;
+  result = mindiff == c2 ? clip_16(val, mil2, mal2) : result;
+  result = mindiff == c4 ? clip_16(val, mil4, mal4) : result;
+  return result;
 }
 
 
@@ -232,10 +233,11 @@ RG_FORCEINLINE float repair_mode5_cpp_32(const Byte* pSrc, float val, int srcPit
 
   auto mindiff = std::min(std::min(std::min(c1, c2), c3), c4);
 
-  if (mindiff == c4) return clip_32(val, mil4, mal4);
-  if (mindiff == c2) return clip_32(val, mil2, mal2);
-  if (mindiff == c3) return clip_32(val, mil3, mal3);
-  return clip_32(val, mil1, mal1);
+  auto result = clip_32(val, mil1, mal1);
+  result = mindiff == c3 ? clip_32(val, mil3, mal3) : result;
+  result = mindiff == c2 ? clip_32(val, mil2, mal2) : result;
+  result = mindiff == c4 ? clip_32(val, mil4, mal4) : result;
+  return result;
 }
 
 // ------------
@@ -272,10 +274,11 @@ RG_FORCEINLINE Byte repair_mode6_cpp(const Byte* pSrc, Byte val, int srcPitch) {
 
     int mindiff = std::min(std::min(std::min(c1, c2), c3), c4);
 
-    if (mindiff == c4) return clip(val, mil4, mal4);
-    if (mindiff == c2) return clip(val, mil2, mal2);
-    if (mindiff == c3) return clip(val, mil3, mal3);
-    return clip(val, mil1, mal1);
+    auto result = clip(val, mil1, mal1);
+    result = mindiff == c3 ? clip(val, mil3, mal3) : result;
+    result = mindiff == c2 ? clip(val, mil2, mal2) : result;
+    result = mindiff == c4 ? clip(val, mil4, mal4) : result;
+    return result;
 }
 
 template<int bits_per_pixel>
@@ -312,10 +315,11 @@ RG_FORCEINLINE uint16_t repair_mode6_cpp_16(const Byte* pSrc, uint16_t val, int
 
   int mindiff = std::min(std::min(std::min(c1, c2), c3), c4);
 
-  if (mindiff == c4) return clip_16(val, mil4, mal4);
-  if (mindiff == c2) return clip_16(val, mil2, mal2);
-  if (mindiff == c3) return clip_16(val, mil3, mal3);
-  return clip_16(val, mil1, mal1);
+  auto result = clip_16(val, mil1, mal1);
+  result = mindiff == c3 ? clip_16(val, mil3, mal3) : result;
+  result = mindiff == c2 ? clip_16(val, mil2, mal2) : result;
+  result = mindiff == c4 ? clip_16(val, mil4, mal4) : result;
+  return result;
 }
 
 RG_FORCEINLINE float repair_mode6_cpp_32(const Byte* pSrc, float val, int srcPitch) {
@@ -366,10 +370,11 @@ RG_FORCEINLINE float repair_mode6_cpp_32(const Byte* pSrc, float val, int srcPit
 
   float mindiff = std::min(std::min(std::min(c1, c2), c3), c4);
 
-  if (mindiff == c4) return clip_32(val, mil4, mal4);
-  if (mindiff == c2) return clip_32(val, mil2, mal2);
-  if (mindiff == c3) return clip_32(val, mil3, mal3);
-  return clip_32(val, mil1, mal1);
+  auto result = clip_32(val, mil1, mal1);
+  result = mindiff == c3 ? clip_32(val, mil3, mal3) : result;
+  result = mindiff == c2 ? clip_32(val, mil2, mal2) : result;
+  result = mindiff == c4 ? clip_32(val, mil4, mal4) : result;
+  return result;
 }
 
 // ------------
@@ -406,10 +411,11 @@ RG_FORCEINLINE Byte repair_mode7_cpp(const Byte* pSrc, Byte val, int srcPitch) {
 
     auto mindiff = std::min(std::min(std::min(c1, c2), c3), c4);
 
-    if (mindiff == c4) return clipped4;
-    if (mindiff == c2) return clipped2;
-    if (mindiff == c3) return clipped3;
-    return clipped1;
+    auto result = clipped1;
+    result = mindiff == c3 ? clipped3 : result;
+    result = mindiff == c2 ? clipped2 : result;
+    result = mindiff == c4 ? clipped4 : result;
+    return result;
 }
 
 RG_FORCEINLINE uint16_t repair_mode7_cpp_16(const Byte* pSrc, uint16_t val, int srcPitch) {
@@ -444,10 +450,11 @@ RG_FORCEINLINE uint16_t repair_mode7_cpp_16(const Byte* pSrc, uint16_t val, int
 
   auto mindiff = std::min(std::min(std::min(c1, c2), c3), c4);
 
-  if (mindiff == c4) return clipped4;
-  if (mindiff == c2) return clipped2;
-  if (mindiff == c3) return clipped3;
-  return clipped1;
+  auto result = clipped1;
+  result = mindiff == c3 ? clipped3 : result;
+  result = mindiff == c2 ? clipped2 : result;
+  result = mindiff == c4 ? clipped4 : result;
+  return result;
 }
 
 RG_FORCEINLINE float repair_mode7_cpp_32(const Byte* pSrc, float val, int srcPitch) {
@@ -482,10 +489,11 @@ RG_FORCEINLINE float repair_mode7_cpp_32(const Byte* pSrc, float val, int srcPit
 
   auto mindiff = std::min(std::min(std::min(c1, c2), c3), c4);
 
-  if (mindiff == c4) return clipped4;
-  if (mindiff == c2) return clipped2;
-  if (mindiff == c3) return clipped3;
-  return clipped1;
+  auto result = clipped1;
+  result = mindiff == c3 ? clipped3 : result;
+  result = mindiff == c2 ? clipped2 : result;
+  result = mindiff == c4 ? clipped4 : result;
+  return result;
 }
 
 
@@ -523,10 +531,11 @@ RG_FORCEINLINE Byte repair_mode8_cpp(const Byte* pSrc, Byte val, int srcPitch) {
 
     Byte mindiff = std::min(std::min(std::min(c1, c2), c3), c4);
 
-    if (mindiff == c4) return clipped4;
-    if (mindiff == c2) return clipped2;
-    if (mindiff == c3) return clipped3;
-    return clipped1;
+    auto result = clipped1;
+    result = mindiff == c3 ? clipped3 : result;
+    result = mindiff == c2 ? clipped2 : result;
+    result = mindiff == c4 ? clipped4 : result;
+    return result;
 }
 
 template<int bits_per_pixel>
@@ -563,10 +572,11 @@ RG_FORCEINLINE uint16_t repair_mode8_cpp_16(const Byte* pSrc, uint16_t val, int
 
   uint16_t mindiff = std::min(std::min(std::min(c1, c2), c3), c4);
 
-  if (mindiff == c4) return clipped4;
-  if (mindiff == c2) return clipped2;
-  if (mindiff == c3) return clipped3;
-  return clipped1;
+  auto result = clipped1;
+  result = mindiff == c3 ? clipped3 : result;
+  result = mindiff == c2 ? clipped2 : result;
+  result = mindiff == c4 ? clipped4 : result;
+  return result;
 }
 
 RG_FORCEINLINE float repair_mode8_cpp_32(const Byte* pSrc, float val, int srcPitch) {
@@ -617,10 +627,11 @@ RG_FORCEINLINE float repair_mode8_cpp_32(const Byte* pSrc, float val, int srcPit
 
   float mindiff = std::min(std::min(std::min(c1, c2), c3), c4);
 
-  if (mindiff == c4) return clipped4;
-  if (mindiff == c2) return clipped2;
-  if (mindiff == c3) return clipped3;
-  return clipped1;
+  auto result = clipped1;
+  result = mindiff == c3 ? clipped3 : result;
+  result = mindiff == c2 ? clipped2 : result;
+  result = mindiff == c4 ? clipped4 : result;
+  return result;
 }
 
 
@@ -648,10 +659,11 @@ RG_FORCEINLINE Byte repair_mode9_cpp(const Byte* pSrc, Byte val, int srcPitch) {
 
     auto mindiff = std::min(std::min(std::min(d1, d2), d3), d4);
 
-    if (mindiff == d4) return clip(val, mil4, mal4);
-    if (mindiff == d2) return clip(val, mil2, mal2);
-    if (mindiff == d3) return clip(val, mil3, mal3);
-    return clip(val, mil1, mal1);
+    auto result = clip(val, mil1, mal1);
+    result = mindiff == d3 ? clip(val, mil3, mal3) : result;
+    result = mindiff == d2 ? clip(val, mil2, mal2) : result;
+    result = mindiff == d4 ? clip(val, mil4, mal4) : result;
+    return result;
 }
 
 RG_FORCEINLINE uint16_t repair_mode9_cpp_16(const Byte* pSrc, uint16_t val, int srcPitch) {
@@ -676,10 +688,11 @@ RG_FORCEINLINE uint16_t repair_mode9_cpp_16(const Byte* pSrc, uint16_t val, int
 
   auto mindiff = std::min(std::min(std::min(d1, d2), d3), d4);
 
-  if (mindiff == d4) return clip_16(val, mil4, mal4);
-  if (mindiff == d2) return clip_16(val, mil2, mal2);
-  if (mindiff == d3) return clip_16(val, mil3, mal3);
-  return clip_16(val, mil1, mal1);
+  auto result = clip_16(val, mil1, mal1);
+  result = mindiff == d3 ? clip_16(val, mil3, mal3) : result;
+  result = mindiff == d2 ? clip_16(val, mil2, mal2) : result;
+  result = mindiff == d4 ? clip_16(val, mil4, mal4) : result;
+  return result;
 }
 
 RG_FORCEINLINE float repair_mode9_cpp_32(const Byte* pSrc, float val, int srcPitch) {
@@ -704,10 +717,11 @@ RG_FORCEINLINE float repair_mode9_cpp_32(const Byte* pSrc, float val, int srcPit
 
   auto mindiff = std::min(std::min(std::min(d1, d2), d3), d4);
 
-  if (mindiff == d4) return clip_32(val, mil4, mal4);
-  if (mindiff == d2) return clip_32(val, mil2, mal2);
-  if (mindiff == d3) return clip_32(val, mil3, mal3);
-  return clip_32(val, mil1, mal1);
+  auto result = clip_32(val, mil1, mal1);
+  result = mindiff == d3 ? clip_32(val, mil3, mal3) : result;
+  result = mindiff == d2 ? clip_32(val, mil2, mal2) : result;
+  result = mindiff == d4 ? clip_32(val, mil4, mal4) : result;
+  return result;
 }
 
 // ------------
@@ -727,15 +741,16 @@ RG_FORCEINLINE Byte repair_mode10_cpp(const Byte* pSrc, Byte val, int srcPitch)
 
     auto mindiff = std::min(std::min(std::min(std::min(std::min(std::min(std::min(std::min(d1, d2), d3), d4), d5), d6), d7), d8), dc);
 
-    if (mindiff == d7) return a7;
-    if (mindiff == d8) return a8;
-    if (mindiff == d6) return a6;
-    if (mindiff == d2) return a2;
-    if (mindiff == d3) return a3;
-    if (mindiff == d1) return a1;
-    if (mindiff == d5) return a5;
-    if (mindiff == dc) return c;
-    return a4;
+    auto result = a4;
+    result = mindiff == dc ? c : result;
+    result = mindiff == d5 ? a5 : result;
+    result = mindiff == d1 ? a1 : result;
+    result = mindiff == d3 ? a3 : result;
+    result = mindiff == d2 ? a2 : result;
+    result = mindiff == d6 ? a6 : result;
+    result = mindiff == d8 ? a8 : result;
+    result = mindiff == d7 ? a7 : result;
+    return result;
 }
 
 RG_FORCEINLINE uint16_t repair_mode10_cpp_16(const Byte* pSrc, uint16_t val, int srcPitch) {
@@ -753,15 +768,16 @@ RG_FORCEINLINE uint16_t repair_mode10_cpp_16(const Byte* pSrc, uint16_t val, int
 
   auto mindiff = std::min(std::min(std::min(std::min(std::min(std::min(std::min(std::min(d1, d2), d3), d4), d5), d6), d7), d8), dc);
 
-  if (mindiff == d7) return a7;
-  if (mindiff == d8) return a8;
-  if (mindiff == d6) return a6;
-  if (mindiff == d2) return a2;
-  if (mindiff == d3) return a3;
-  if (mindiff == d1) return a1;
-  if (mindiff == d5) return a5;
-  if (mindiff == dc) return c;
-  return a4;
+  auto result = a4;
+  result = mindiff == dc ? c : result;
+  result = mindiff == d5 ? a5 : result;
+  result = mindiff == d1 ? a1 : result;
+  result = mindiff == d3 ? a3 : result;
+  result = mindiff == d2 ? a2 : result;
+  result = mindiff == d6 ? a6 : result;
+  result = mindiff == d8 ? a8 : result;
+  result = mindiff == d7 ? a7 : result;
+  return result;
 }
 
 RG_FORCEINLINE float repair_mode10_cpp_32(const Byte* pSrc, float val, int srcPitch) {
@@ -779,15 +795,16 @@ RG_FORCEINLINE float repair_mode10_cpp_32(const Byte* pSrc, float val, int srcPi
 
   auto mindiff = std::min(std::min(std::min(std::min(std::min(std::min(std::min(std::min(d1, d2), d3), d4), d5), d6), d7), d8), dc);
 
-  if (mindiff == d7) return a7;
-  if (mindiff == d8) return a8;
-  if (mindiff == d6) return a6;
-  if (mindiff == d2) return a2;
-  if (mindiff == d3) return a3;
-  if (mindiff == d1) return a1;
-  if (mindiff == d5) return a5;
-  if (mindiff == dc) return c;
-  return a4;
+  auto result = a4;
+  result = mindiff == dc ? c : result;
+  result = mindiff == d5 ? a5 : result;
+  result = mindiff == d1 ? a1 : result;
+  result = mindiff == d3 ? a3 : result;
+  result = mindiff == d2 ? a2 : result;
+  result = mindiff == d6 ? a6 : result;
+  result = mindiff == d8 ? a8 : result;
+  result = mindiff == d7 ? a7 : result;
+  return result;
 }
 
 // ------------
@@ -797,7 +814,7 @@ RG_FORCEINLINE Byte repair_mode12_cpp(const Byte* pSrc, Byte val, int srcPitch)
 
     Byte a[8] = { a1, a2, a3, a4, a5, a6, a7, a8 };
 
-    std::sort(std::begin(a), std::end(a));
+    sort8_c(a);
     Byte mi = std::min(a[1], c);
     Byte ma = std::max(a[6], c);
 
@@ -809,7 +826,7 @@ RG_FORCEINLINE uint16_t repair_mode12_cpp_16(const Byte* pSrc, uint16_t val, int
 
   uint16_t a[8] = { a1, a2, a3, a4, a5, a6, a7, a8 };
 
-  std::sort(std::begin(a), std::end(a));
+  sort8_c(a);
   uint16_t mi = std::min(a[1], c);
   uint16_t ma = std::max(a[6], c);
 
@@ -821,7 +838,7 @@ RG_FORCEINLINE float repair_mode12_cpp_32(const Byte* pSrc, float val, int srcPi
 
   float a[8] = { a1, a2, a3, a4, a5, a6, a7, a8 };
 
-  std::sort(std::begin(a), std::end(a));
+  sort8_c(a);
   float mi = std::min(a[1], c);
   float ma = std::max(a[6], c);
 
@@ -835,7 +852,7 @@ RG_FORCEINLINE Byte repair_mode13_cpp(const Byte* pSrc, Byte val, int srcPitch)
 
     Byte a[8] = { a1, a2, a3, a4, a5, a6, a7, a8 };
 
-    std::sort(std::begin(a), std::end(a));
+    sort8_c(a);
     Byte mi = std::min(a[2], c);
     Byte ma = std::max(a[5], c);
 
@@ -847,7 +864,7 @@ RG_FORCEINLINE uint16_t repair_mode13_cpp_16(const Byte* pSrc, uint16_t val, int
 
   uint16_t a[8] = { a1, a2, a3, a4, a5, a6, a7, a8 };
 
-  std::sort(std::begin(a), std::end(a));
+  sort8_c(a);
   uint16_t mi = std::min(a[2], c);
   uint16_t ma = std::max(a[5], c);
 
@@ -859,7 +876,7 @@ RG_FORCEINLINE float repair_mode13_cpp_32(const Byte* pSrc, float val, int srcPi
 
   float a[8] = { a1, a2, a3, a4, a5, a6, a7, a8 };
 
-  std::sort(std::begin(a), std::end(a));
+  sort8_c(a);
   float mi = std::min(a[2], c);
   float ma = std::max(a[5], c);
 
@@ -874,7 +891,7 @@ RG_FORCEINLINE Byte repair_mode14_cpp(const Byte* pSrc, Byte val, int srcPitch)
 
     Byte a [8] = { a1, a2, a3, a4, a5, a6, a7, a8 };
 
-    std::sort(std::begin(a), std::end(a));
+    sort8_c(a);
     Byte mi = std::min(a[3], c);
     Byte ma = std::max(a[4], c);
 
@@ -886,7 +903,7 @@ RG_FORCEINLINE uint16_t repair_mode14_cpp_16(const Byte* pSrc, uint16_t val, int
 
   uint16_t a [8] = { a1, a2, a3, a4, a5, a6, a7, a8 };
 
-  std::sort(std::begin(a), std::end(a));
+  sort8_c(a);
   uint16_t mi = std::min(a[3], c);
   uint16_t ma = std::max(a[4], c);
 
@@ -898,7 +915,7 @@ RG_FORCEINLINE float repair_mode14_cpp_32(const Byte* pSrc, float val, int srcPi
 
   float a [8] = { a1, a2, a3, a4, a5, a6, a7, a8 };
 
-  std::sort(std::begin(a), std::end(a));
+  sort8_c(a);
   float mi = std::min(a[3], c);
   float ma = std::max(a[4], c);
 
@@ -937,26 +954,14 @@ RG_FORCEINLINE Byte repair_mode15_cpp(const Byte* pSrc, Byte val, int srcPitch)
 
     Byte mi;
     Byte ma;
-    if (mindiff == c4)
-    {
-        mi = mil4;
-        ma = mal4;
-    }
-    else if (mindiff == c2)
-    {
-        mi = mil2;
-        ma = mal2;
-    }
-    else if (mindiff == c3)
-    {
-        mi = mil3;
-        ma = mal3;
-    }
-    else
-    {
-        mi = mil1;
-        ma = mal1;
-    }
+    mi = mil1;
+    mi = mindiff == c3 ? mil3 : mi;
+    mi = mindiff == c2 ? mil2 : mi;
+    mi = mindiff == c4 ? mil4 : mi;
+    ma = mal1;
+    ma = mindiff == c3 ? mal3 : ma;
+    ma = mindiff == c2 ? mal2 : ma;
+    ma = mindiff == c4 ? mal4 : ma;
 
     mi = std::min(mi, c);
     ma = std::max(ma, c);
@@ -993,26 +998,14 @@ RG_FORCEINLINE uint16_t repair_mode15_cpp_16(const Byte* pSrc, uint16_t val, int
 
   uint16_t mi;
   uint16_t ma;
-  if (mindiff == c4)
-  {
-    mi = mil4;
-    ma = mal4;
-  }
-  else if (mindiff == c2)
-  {
-    mi = mil2;
-    ma = mal2;
-  }
-  else if (mindiff == c3)
-  {
-    mi = mil3;
-    ma = mal3;
-  }
-  else
-  {
-    mi = mil1;
-    ma = mal1;
-  }
+  mi = mil1;
+  mi = mindiff == c3 ? mil3 : mi;
+  mi = mindiff == c2 ? mil2 : mi;
+  mi = mindiff == c4 ? mil4 : mi;
+  ma = mal1;
+  ma = mindiff == c3 ? mal3 : ma;
+  ma = mindiff == c2 ? mal2 : ma;
+  ma = mindiff == c4 ? mal4 : ma;
 
   mi = std::min(mi, c);
   ma = std::max(ma, c);
@@ -1049,26 +1042,14 @@ RG_FORCEINLINE float repair_mode15_cpp_32(const Byte* pSrc, float val, int srcPi
 
   float mi;
   float ma;
-  if (mindiff == c4)
-  {
-    mi = mil4;
-    ma = mal4;
-  }
-  else if (mindiff == c2)
-  {
-    mi = mil2;
-    ma = mal2;
-  }
-  else if (mindiff == c3)
-  {
-    mi = mil3;
-    ma = mal3;
-  }
-  else
-  {
-    mi = mil1;
-    ma = mal1;
-  }
+  mi = mil1;
+  mi = mindiff == c3 ? mil3 : mi;
+  mi = mindiff == c2 ? mil2 : mi;
+  mi = mindiff == c4 ? mil4 : mi;
+  ma = mal1;
+  ma = mindiff == c3 ? mal3 : ma;
+  ma = mindiff == c2 ? mal2 : ma;
+  ma = mindiff == c4 ? mal4 : ma;
 
   mi = std::min(mi, c);
   ma = std::max(ma, c);
@@ -1108,26 +1089,14 @@ RG_FORCEINLINE Byte repair_mode16_cpp(const Byte* pSrc, Byte val, int srcPitch)
 
     Byte mi;
     Byte ma;
-    if (mindiff == c4)
-    {
-        mi = mil4;
-        ma = mal4;
-    }
-    else if (mindiff == c2)
-    {
-        mi = mil2;
-        ma = mal2;
-    }
-    else if (mindiff == c3)
-    {
-        mi = mil3;
-        ma = mal3;
-    }
-    else
-    {
-        mi = mil1;
-        ma = mal1;
-    }
+    mi = mil1;
+    mi = mindiff == c3 ? mil3 : mi;
+    mi = mindiff == c2 ? mil2 : mi;
+    mi = mindiff == c4 ? mil4 : mi;
+    ma = mal1;
+    ma = mindiff == c3 ? mal3 : ma;
+    ma = mindiff == c2 ? mal2 : ma;
+    ma = mindiff == c4 ? mal4 : ma;
 
     mi = std::min (mi, c);
     ma = std::max (ma, c);
@@ -1166,26 +1135,14 @@ RG_FORCEINLINE uint16_t repair_mode16_cpp_16(const Byte* pSrc, uint16_t val, int
 
   uint16_t mi;
   uint16_t ma;
-  if (mindiff == c4)
-  {
-    mi = mil4;
-    ma = mal4;
-  }
-  else if (mindiff == c2)
-  {
-    mi = mil2;
-    ma = mal2;
-  }
-  else if (mindiff == c3)
-  {
-    mi = mil3;
-    ma = mal3;
-  }
-  else
-  {
-    mi = mil1;
-    ma = mal1;
-  }
+  mi = mil1;
+  mi = mindiff == c3 ? mil3 : mi;
+  mi = mindiff == c2 ? mil2 : mi;
+  mi = mindiff == c4 ? mil4 : mi;
+  ma = mal1;
+  ma = mindiff == c3 ? mal3 : ma;
+  ma = mindiff == c2 ? mal2 : ma;
+  ma = mindiff == c4 ? mal4 : ma;
 
   mi = std::min (mi, c);
   ma = std::max (ma, c);
@@ -1238,26 +1195,14 @@ RG_FORCEINLINE float repair_mode16_cpp_32(const Byte* pSrc, float val, int srcPi
 
   float mi;
   float ma;
-  if (mindiff == c4)
-  {
-    mi = mil4;
-    ma = mal4;
-  }
-  else if (mindiff == c2)
-  {
-    mi = mil2;
-    ma = mal2;
-  }
-  else if (mindiff == c3)
-  {
-    mi = mil3;
-    ma = mal3;
-  }
-  else
-  {
-    mi = mil1;
-    ma = mal1;
-  }
+  mi = mil1;
+  mi = mindiff == c3 ? mil3 : mi;
+  mi = mindiff == c2 ? mil2 : mi;
+  mi = mindiff == c4 ? mil4 : mi;
+  ma = mal1;
+  ma = mindiff == c3 ? mal3 : ma;
+  ma = mindiff == c2 ? mal2 : ma;
+  ma = mindiff == c4 ? mal4 : ma;
 
   mi = std::min (mi, c);
   ma = std::max (ma, c);
@@ -1357,26 +1302,14 @@ RG_FORCEINLINE Byte repair_mode18_cpp(const Byte* pSrc, Byte val, int srcPitch)
 
     Byte mi;
     Byte ma;
-    if (mindiff == d4)
-    {
-        mi = std::min (a4, a5);
-        ma = std::max (a4, a5);
-    }
-    else if (mindiff == d2)
-    {
-        mi = std::min (a2, a7);
-        ma = std::max (a2, a7);
-    }
-    else if (mindiff == d3)
-    {
-        mi = std::min (a3, a6);
-        ma = std::max (a3, a6);
-    }
-    else
-    {
-        mi = std::min (a1, a8);
-        ma = std::max (a1, a8);
-    }
+    mi = std::min (a1, a8);
+    mi = mindiff == d3 ? std::min (a3, a6) : mi;
+    mi = mindiff == d2 ? std::min (a2, a7) : mi;
+    mi = mindiff == d4 ? std::min (a4, a5) : mi;
+    ma = std::max (a1, a8);
+    ma = mindiff == d3 ? std::max (a3, a6) : ma;
+    ma = mindiff == d2 ? std::max (a2, a7) : ma;
+    ma = mindiff == d4 ? std::max (a4, a5) : ma;
 
     mi = std::min (mi, c);
     ma = std::max (ma, c);
@@ -1396,26 +1329,14 @@ RG_FORCEINLINE uint16_t repair_mode18_cpp_16(const Byte* pSrc, uint16_t val, int
 
   uint16_t mi;
   uint16_t ma;
-  if (mindiff == d4)
-  {
-    mi = std::min (a4, a5);
-    ma = std::max (a4, a5);
-  }
-  else if (mindiff == d2)
-  {
-    mi = std::min (a2, a7);
-    ma = std::max (a2, a7);
-  }
-  else if (mindiff == d3)
-  {
-    mi = std::min (a3, a6);
-    ma = std::max (a3, a6);
-  }
-  else
-  {
-    mi = std::min (a1, a8);
-    ma = std::max (a1, a8);
-  }
+  mi = std::min (a1, a8);
+  mi = mindiff == d3 ? std::min (a3, a6) : mi;
+  mi = mindiff == d2 ? std::min (a2, a7) : mi;
+  mi = mindiff == d4 ? std::min (a4, a5) : mi;
+  ma = std::max (a1, a8);
+  ma = mindiff == d3 ? std::max (a3, a6) : ma;
+  ma = mindiff == d2 ? std::max (a2, a7) : ma;
+  ma = mindiff == d4 ? std::max (a4, a5) : ma;
 
   mi = std::min (mi, c);
   ma = std::max (ma, c);
@@ -1435,26 +1356,14 @@ RG_FORCEINLINE float repair_mode18_cpp_32(const Byte* pSrc, float val, int srcPi
 
   float mi;
   float ma;
-  if (mindiff == d4)
-  {
-    mi = std::min (a4, a5);
-    ma = std::max (a4, a5);
-  }
-  else if (mindiff == d2)
-  {
-    mi = std::min (a2, a7);
-    ma = std::max (a2, a7);
-  }
-  else if (mindiff == d3)
-  {
-    mi = std::min (a3, a6);
-    ma = std::max (a3, a6);
-  }
-  else
-  {
-    mi = std::min (a1, a8);
-    ma = std::max (a1, a8);
-  }
+  mi = std::min (a1, a8);
+  mi = mindiff == d3 ? std::min (a3, a6) : mi;
+  mi = mindiff == d2 ? std::min (a2, a7) : mi;
+  mi = mindiff == d4 ? std::min (a4, a5) : mi;
+  ma = std::max (a1, a8);
+  ma = mindiff == d3 ? std::max (a3, a6) : ma;
+  ma = mindiff == d2 ? std::max (a2, a7) : ma;
+  ma = mindiff == d4 ? std::max (a4, a5) : ma;
 
   mi = std::min (mi, c);
   ma = std::max (ma, c);
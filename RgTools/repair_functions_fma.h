@@ -0,0 +1,157 @@
+#ifndef __REPAIR_FUNCTIONS_FMA_H__
+#define __REPAIR_FUNCTIONS_FMA_H__
+
+#include "repair_functions_avx2.h"
+
+// 32 bit float Repair modes for AVX2 CPUs with FMA3: the weighted edge costs of modes 6, 8 and 16
+// (2*x + y) as one FMA. Bit identical to the AVX2 kernels, 2*x is exact.
+// All other Repair modes are min/max/clip only and use the AVX2 kernels.
+
+template<bool aligned>
+RG_FORCEINLINE __m256i repair_mode6_fma_32(const Byte* pSrc, const __m256i &val, int srcPitch) {
+  LOAD_SQUARE_AVX2_32_UA(pSrc, srcPitch, aligned);
+
+  auto mal1 = _mm256_max_ps(_mm256_max_ps(a1, a8), c);
+  auto mil1 = _mm256_min_ps(_mm256_min_ps(a1, a8), c);
+
+  auto mal2 = _mm256_max_ps(_mm256_max_ps(a2, a7), c);
+  auto mil2 = _mm256_min_ps(_mm256_min_ps(a2, a7), c);
+
+  auto mal3 = _mm256_max_ps(_mm256_max_ps(a3, a6), c);
+  auto mil3 = _mm256_min_ps(_mm256_min_ps(a3, a6), c);
+
+  auto mal4 = _mm256_max_ps(_mm256_max_ps(a4, a5), c);
+  auto mil4 = _mm256_min_ps(_mm256_min_ps(a4, a5), c);
+
+  auto d1 = _mm256_sub_ps(mal1, mil1);
+  auto d2 = _mm256_sub_ps(mal2, mil2);
+  auto d3 = _mm256_sub_ps(mal3, mil3);
+  auto d4 = _mm256_sub_ps(mal4, mil4);
+
+  auto clipped1 = simd_clip_32(_mm256_castsi256_ps(val), mil1, mal1);
+  auto clipped2 = simd_clip_32(_mm256_castsi256_ps(val), mil2, mal2);
+  auto clipped3 = simd_clip_32(_mm256_castsi256_ps(val), mil3, mal3);
+  auto clipped4 = simd_clip_32(_mm256_castsi256_ps(val), mil4, mal4);
+
+  auto absdiff1 = abs_diff_32(_mm256_castsi256_ps(val), clipped1);
+  auto absdiff2 = abs_diff_32(_mm256_castsi256_ps(val), clipped2);
+  auto absdiff3 = abs_diff_32(_mm256_castsi256_ps(val), clipped3);
+  auto absdiff4 = abs_diff_32(_mm256_castsi256_ps(val), clipped4);
+
+  auto c1 = fma_twice_plus_32(absdiff1, d1);
+  auto c2 = fma_twice_plus_32(absdiff2, d2);
+  auto c3 = fma_twice_plus_32(absdiff3, d3);
+  auto c4 = fma_twice_plus_32(absdiff4, d4);
+
+  auto mindiff = _mm256_min_ps(c1, c2);
+  mindiff = _mm256_min_ps(mindiff, c3);
+  mindiff = _mm256_min_ps(mindiff, c4);
+
+  auto result = select_on_equal_32(mindiff, c1, _mm256_castsi256_ps(val), clipped1);
+  result = select_on_equal_32(mindiff, c3, result, clipped3);
+  result = select_on_equal_32(mindiff, c2, result, clipped2);
+  return _mm256_castps_si256(select_on_equal_32(mindiff, c4, result, clipped4));
+}
+
+// ------------
+
+template<bool aligned>
+RG_FORCEINLINE __m256i repair_mode8_fma_32(const Byte* pSrc, const __m256i &val, int srcPitch) {
+  LOAD_SQUARE_AVX2_32_UA(pSrc, srcPitch, aligned);
+
+  auto mal1 = _mm256_max_ps(_mm256_max_ps(a1, a8), c);
+  auto mil1 = _mm256_min_ps(_mm256_min_ps(a1, a8), c);
+
+  auto mal2 = _mm256_max_ps(_mm256_max_ps(a2, a7), c);
+  auto mil2 = _mm256_min_ps(_mm256_min_ps(a2, a7), c);
+
+  auto mal3 = _mm256_max_ps(_mm256_max_ps(a3, a6), c);
+  auto mil3 = _mm256_min_ps(_mm256_min_ps(a3, a6), c);
+
+  auto mal4 = _mm256_max_ps(_mm256_max_ps(a4, a5), c);
+  auto mil4 = _mm256_min_ps(_mm256_min_ps(a4, a5), c);
+
+  auto d1 = _mm256_sub_ps(mal1, mil1);
+  auto d2 = _mm256_sub_ps(mal2, mil2);
+  auto d3 = _mm256_sub_ps(mal3, mil3);
+  auto d4 = _mm256_sub_ps(mal4, mil4);
+
+  auto clipped1 = simd_clip_32(_mm256_castsi256_ps(val), mil1, mal1);
+  auto clipped2 = simd_clip_32(_mm256_castsi256_ps(val), mil2, mal2);
+  auto clipped3 = simd_clip_32(_mm256_castsi256_ps(val), mil3, mal3);
+  auto clipped4 = simd_clip_32(_mm256_castsi256_ps(val), mil4, mal4);
+
+  auto c1 = fma_twice_plus_32(d1, abs_diff_32(_mm256_castsi256_ps(val), clipped1));
+  auto c2 = fma_twice_plus_32(d2, abs_diff_32(_mm256_castsi256_ps(val), clipped2));
+  auto c3 = fma_twice_plus_32(d3, abs_diff_32(_mm256_castsi256_ps(val), clipped3));
+  auto c4 = fma_twice_plus_32(d4, abs_diff_32(_mm256_castsi256_ps(val), clipped4));
+
+  auto mindiff = _mm256_min_ps(c1, c2);
+  mindiff = _mm256_min_ps(mindiff, c3);
+  mindiff = _mm256_min_ps(mindiff, c4);
+
+  auto result = select_on_equal_32(mindiff, c1, _mm256_castsi256_ps(val), clipped1);
+  result = select_on_equal_32(mindiff, c3, result, clipped3);
+  result = select_on_equal_32(mindiff, c2, result, clipped2);
+  return _mm256_castps_si256(select_on_equal_32(mindiff, c4, result, clipped4));
+}
+
+// ------------
+
+template<bool aligned>
+RG_FORCEINLINE __m256i repair_mode16_fma_32(const Byte* pSrc, const __m256i &val, int srcPitch) {
+  LOAD_SQUARE_AVX2_32_UA(pSrc, srcPitch, aligned);
+
+  auto mal1 = _mm256_max_ps(a1, a8);
+  auto mil1 = _mm256_min_ps(a1, a8);
+
+  auto mal2 = _mm256_max_ps(a2, a7);
+  auto mil2 = _mm256_min_ps(a2, a7);
+
+  auto mal3 = _mm256_max_ps(a3, a6);
+  auto mil3 = _mm256_min_ps(a3, a6);
+
+  auto mal4 = _mm256_max_ps(a4, a5);
+  auto mil4 = _mm256_min_ps(a4, a5);
+
+  auto cma1 = _mm256_max_ps(c, mal1);
+  auto cma2 = _mm256_max_ps(c, mal2);
+  auto cma3 = _mm256_max_ps(c, mal3);
+  auto cma4 = _mm256_max_ps(c, mal4);
+
+  auto cmi1 = _mm256_min_ps(c, mil1);
+  auto cmi2 = _mm256_min_ps(c, mil2);
+  auto cmi3 = _mm256_min_ps(c, mil3);
+  auto cmi4 = _mm256_min_ps(c, mil4);
+
+  auto clipped1 = simd_clip_32(c, mil1, mal1);
+  auto clipped2 = simd_clip_32(c, mil2, mal2);
+  auto clipped3 = simd_clip_32(c, mil3, mal3);
+  auto clipped4 = simd_clip_32(c, mil4, mal4);
+
+  auto d1 = _mm256_sub_ps(mal1, mil1);
+  auto d2 = _mm256_sub_ps(mal2, mil2);
+  auto d3 = _mm256_sub_ps(mal3, mil3);
+  auto d4 = _mm256_sub_ps(mal4, mil4);
+
+  auto absdiff1 = abs_diff_32(c, clipped1);
+  auto absdiff2 = abs_diff_32(c, clipped2);
+  auto absdiff3 = abs_diff_32(c, clipped3);
+  auto absdiff4 = abs_diff_32(c, clipped4);
+
+  auto c1 = fma_twice_plus_32(absdiff1, d1);
+  auto c2 = fma_twice_plus_32(absdiff2, d2);
+  auto c3 = fma_twice_plus_32(absdiff3, d3);
+  auto c4 = fma_twice_plus_32(absdiff4, d4);
+
+  auto mindiff = _mm256_min_ps(c1, c2);
+  mindiff = _mm256_min_ps(mindiff, c3);
+  mindiff = _mm256_min_ps(mindiff, c4);
+
+  auto result = select_on_equal_32(mindiff, c1, _mm256_castsi256_ps(val),    simd_clip_32(_mm256_castsi256_ps(val), cmi1, cma1));
+  result      = select_on_equal_32(mindiff, c3, result, simd_clip_32(_mm256_castsi256_ps(val), cmi3, cma3));
+  result      = select_on_equal_32(mindiff, c2, result, simd_clip_32(_mm256_castsi256_ps(val), cmi2, cma2));
+  return        _mm256_castps_si256(select_on_equal_32(mindiff, c4, result, simd_clip_32(_mm256_castsi256_ps(val), cmi4, cma4)));
+}
+
+#endif
@@ -0,0 +1,2111 @@
+#ifndef __RG_FUNCTIONS_AVX512_H__
+#define __RG_FUNCTIONS_AVX512_H__
+
+#include "common_avx512.h"
+
+typedef __m512i (SseModeProcessor)(const Byte*, int);
+
+// (a+b)/2 rounded down: the rounded up pavgb minus the lost bit (a^b)&1, vpternlog does xor+and
+static RG_FORCEINLINE __m512i not_rounded_average(__m512i a, __m512i b) {
+    auto lsb = _mm512_ternarylogic_epi32(a, b, _mm512_set1_epi8(1), 0x28); // (a ^ b) & 1
+    return _mm512_sub_epi8(_mm512_avg_epu8(a, b), lsb);
+}
+
+static RG_FORCEINLINE __m512i not_rounded_average_16(__m512i a, __m512i b) {
+  auto lsb = _mm512_ternarylogic_epi32(a, b, _mm512_set1_epi16(1), 0x28);
+  return _mm512_sub_epi16(_mm512_avg_epu16(a, b), lsb);
+}
+
+//-------------------
+
+// AVX-512:
+// we are always using aligned=false, no penalty if aligned
+//-------------------
+
+template<bool aligned>
+RG_FORCEINLINE __m512i rg_mode1_avx512(const Byte* pSrc, int srcPitch) {
+    LOAD_SQUARE_AVX512_UA(pSrc, srcPitch, aligned);
+
+    __m512i mi = _mm512_min_epu8 (
+        _mm512_min_epu8(_mm512_min_epu8(a1, a2), _mm512_min_epu8(a3, a4)),
+        _mm512_min_epu8(_mm512_min_epu8(a5, a6), _mm512_min_epu8(a7, a8))
+        );
+    __m512i ma = _mm512_max_epu8 (
+        _mm512_max_epu8(_mm512_max_epu8(a1, a2), _mm512_max_epu8(a3, a4)),
+        _mm512_max_epu8(_mm512_max_epu8(a5, a6), _mm512_max_epu8(a7, a8))
+        );
+
+    return simd_clip(c, mi, ma);
+}
+
+template<bool aligned>
+RG_FORCEINLINE __m512i rg_mode1_avx512_16(const Byte* pSrc, int srcPitch) {
+  LOAD_SQUARE_AVX512_16_UA(pSrc, srcPitch, aligned);
+
+  __m512i mi = _mm512_min_epu16 (
+    _mm512_min_epu16(_mm512_min_epu16(a1, a2), _mm512_min_epu16(a3, a4)),
+    _mm512_min_epu16(_mm512_min_epu16(a5, a6), _mm512_min_epu16(a7, a8))
+  );
+  __m512i ma = _mm512_max_epu16 (
+    _mm512_max_epu16(_mm512_max_epu16(a1, a2), _mm512_max_epu16(a3, a4)),
+    _mm512_max_epu16(_mm512_max_epu16(a5, a6), _mm512_max_epu16(a7, a8))
+  );
+
+  return simd_clip_16(c, mi, ma);
+}
+
+template<bool aligned>
+RG_FORCEINLINE __m512i rg_mode1_avx512_32(const Byte* pSrc, int srcPitch) {
+  LOAD_SQUARE_AVX512_32_UA(pSrc, srcPitch, aligned);
+
+  __m512 mi = _mm512_min_ps (
+    _mm512_min_ps(_mm512_min_ps(a1, a2), _mm512_min_ps(a3, a4)),
+    _mm512_min_ps(_mm512_min_ps(a5, a6), _mm512_min_ps(a7, a8))
+  );
+  __m512 ma = _mm512_max_ps (
+    _mm512_max_ps(_mm512_max_ps(a1, a2), _mm512_max_ps(a3, a4)),
+    _mm512_max_ps(_mm512_max_ps(a5, a6), _mm512_max_ps(a7, a8))
+  );
+
+  return _mm512_castps_si512(simd_clip_32(c, mi, ma));
+}
+
+//-------------------
+
+template<bool aligned>
+RG_FORCEINLINE __m512i rg_mode2_avx512(const Byte* pSrc, int srcPitch) {
+    LOAD_SQUARE_AVX512_UA(pSrc, srcPitch, aligned);
+
+    sort_pair(a1, a2);
+    sort_pair(a3, a4);
+    sort_pair(a5, a6);
+    sort_pair(a7, a8);
+
+    sort_pair(a1, a3);
+    sort_pair(a2, a4);
+    sort_pair(a5, a7);
+    sort_pair(a6, a8);
+
+    sort_pair(a2, a3);
+    sort_pair(a6, a7);
+
+    a5 = _mm512_max_epu8 (a1, a5);	// sort_pair (a1, a5);
+    sort_pair (a2, a6);
+    sort_pair (a3, a7);
+    a4 = _mm512_min_epu8 (a4, a8);	// sort_pair (a4, a8);
+
+    a3 = _mm512_min_epu8 (a3, a5);	// sort_pair (a3, a5);
+    a6 = _mm512_max_epu8 (a4, a6);	// sort_pair (a4, a6);
+
+    a2 = _mm512_min_epu8 (a2, a3);	// sort_pair (a2, a3);
+    a7 = _mm512_max_epu8 (a6, a7);	// sort_pair (a6, a7);
+
+    return simd_clip(c, a2, a7);
+}
+
+template<bool aligned>
+RG_FORCEINLINE __m512i rg_mode2_avx512_16(const Byte* pSrc, int srcPitch) {
+  LOAD_SQUARE_AVX512_16_UA(pSrc, srcPitch, aligned);
+
+  sort_pair_16(a1, a2);
+  sort_pair_16(a3, a4);
+  sort_pair_16(a5, a6);
+  sort_pair_16(a7, a8);
+
+  sort_pair_16(a1, a3);
+  sort_pair_16(a2, a4);
+  sort_pair_16(a5, a7);
+  sort_pair_16(a6, a8);
+
+  sort_pair_16(a2, a3);
+  sort_pair_16(a6, a7);
+
+  a5 = _mm512_max_epu16 (a1, a5);	// sort_pair (a1, a5);
+  sort_pair_16 (a2, a6);
+  sort_pair_16 (a3, a7);
+  a4 = _mm512_min_epu16 (a4, a8);	// sort_pair (a4, a8);
+
+  a3 = _mm512_min_epu16 (a3, a5);	// sort_pair (a3, a5);
+  a6 = _mm512_max_epu16 (a4, a6);	// sort_pair (a4, a6);
+
+  a2 = _mm512_min_epu16 (a2, a3);	// sort_pair (a2, a3);
+  a7 = _mm512_max_epu16 (a6, a7);	// sort_pair (a6, a7);
+
+  return simd_clip_16(c, a2, a7);
+}
+
+template<bool aligned>
+RG_FORCEINLINE __m512i rg_mode2_avx512_32(const Byte* pSrc, int srcPitch) {
+  LOAD_SQUARE_AVX512_32_UA(pSrc, srcPitch, aligned);
+
+  sort_pair_32(a1, a2);
+  sort_pair_32(a3, a4);
+  sort_pair_32(a5, a6);
+  sort_pair_32(a7, a8);
+
+  sort_pair_32(a1, a3);
+  sort_pair_32(a2, a4);
+  sort_pair_32(a5, a7);
+  sort_pair_32(a6, a8);
+
+  sort_pair_32(a2, a3);
+  sort_pair_32(a6, a7);
+
+  a5 = _mm512_max_ps (a1, a5);	// sort_pair (a1, a5);
+  sort_pair_32 (a2, a6);
+  sort_pair_32 (a3, a7);
+  a4 = _mm512_min_ps (a4, a8);	// sort_pair (a4, a8);
+
+  a3 = _mm512_min_ps (a3, a5);	// sort_pair (a3, a5);
+  a6 = _mm512_max_ps (a4, a6);	// sort_pair (a4, a6);
+
+  a2 = _mm512_min_ps (a2, a3);	// sort_pair (a2, a3);
+  a7 = _mm512_max_ps (a6, a7);	// sort_pair (a6, a7);
+
+  return _mm512_castps_si512(simd_clip_32(c, a2, a7));
+}
+
+
+//-------------------
+
+template<bool aligned>
+RG_FORCEINLINE __m512i rg_mode3_avx512(const Byte* pSrc, int srcPitch) {
+    LOAD_SQUARE_AVX512_UA(pSrc, srcPitch, aligned);
+
+    sort_pair(a1, a2);
+    sort_pair(a3, a4);
+    sort_pair(a5, a6);
+    sort_pair(a7, a8);
+
+    sort_pair(a1, a3);
+    sort_pair(a2, a4);
+    sort_pair(a5, a7);
+    sort_pair(a6, a8);
+
+    sort_pair(a2, a3);
+    sort_pair(a6, a7);
+
+    a5 = _mm512_max_epu8(a1, a5);	// sort_pair (a1, a5);
+    sort_pair (a2, a6);
+    sort_pair (a3, a7);
+    a4 = _mm512_min_epu8(a4, a8);	// sort_pair (a4, a8);
+
+    a3 = _mm512_min_epu8(a3, a5);	// sort_pair (a3, a5);
+    a6 = _mm512_max_epu8(a4, a6);	// sort_pair (a4, a6);
+
+    a3 = _mm512_max_epu8(a2, a3);	// sort_pair (a2, a3);
+    a6 = _mm512_min_epu8(a6, a7);	// sort_pair (a6, a7);
+
+    return simd_clip(c, a3, a6);
+}
+
+template<bool aligned>
+RG_FORCEINLINE __m512i rg_mode3_avx512_16(const Byte* pSrc, int srcPitch) {
+  LOAD_SQUARE_AVX512_16_UA(pSrc, srcPitch, aligned);
+
+  sort_pair_16(a1, a2);
+  sort_pair_16(a3, a4);
+  sort_pair_16(a5, a6);
+  sort_pair_16(a7, a8);
+
+  sort_pair_16(a1, a3);
+  sort_pair_16(a2, a4);
+  sort_pair_16(a5, a7);
+  sort_pair_16(a6, a8);
+
+  sort_pair_16(a2, a3);
+  sort_pair_16(a6, a7);
+
+  a5 = _mm512_max_epu16(a1, a5);	// sort_pair (a1, a5);
+  sort_pair_16 (a2, a6);
+  sort_pair_16 (a3, a7);
+  a4 = _mm512_min_epu16(a4, a8);	// sort_pair (a4, a8);
+
+  a3 = _mm512_min_epu16(a3, a5);	// sort_pair (a3, a5);
+  a6 = _mm512_max_epu16(a4, a6);	// sort_pair (a4, a6);
+
+  a3 = _mm512_max_epu16(a2, a3);	// sort_pair (a2, a3);
+  a6 = _mm512_min_epu16(a6, a7);	// sort_pair (a6, a7);
+
+  return simd_clip_16(c, a3, a6);
+}
+
+template<bool aligned>
+RG_FORCEINLINE __m512i rg_mode3_avx512_32(const Byte* pSrc, int srcPitch) {
+  LOAD_SQUARE_AVX512_32_UA(pSrc, srcPitch, aligned);
+
+  sort_pair_32(a1, a2);
+  sort_pair_32(a3, a4);
+  sort_pair_32(a5, a6);
+  sort_pair_32(a7, a8);
+
+  sort_pair_32(a1, a3);
+  sort_pair_32(a2, a4);
+  sort_pair_32(a5, a7);
+  sort_pair_32(a6, a8);
+
+  sort_pair_32(a2, a3);
+  sort_pair_32(a6, a7);
+
+  a5 = _mm512_max_ps(a1, a5);	// sort_pair (a1, a5);
+  sort_pair_32 (a2, a6);
+  sort_pair_32 (a3, a7);
+  a4 = _mm512_min_ps(a4, a8);	// sort_pair (a4, a8);
+
+  a3 = _mm512_min_ps(a3, a5);	// sort_pair (a3, a5);
+  a6 = _mm512_max_ps(a4, a6);	// sort_pair (a4, a6);
+
+  a3 = _mm512_max_ps(a2, a3);	// sort_pair (a2, a3);
+  a6 = _mm512_min_ps(a6, a7);	// sort_pair (a6, a7);
+
+  return _mm512_castps_si512(simd_clip_32(c, a3, a6));
+}
+
+//-------------------
+
+template<bool aligned>
+RG_FORCEINLINE __m512i rg_mode4_avx512(const Byte* pSrc, int srcPitch) {
+    LOAD_SQUARE_AVX512_UA(pSrc, srcPitch, aligned);
+
+    sort_pair (a1, a2);
+    sort_pair (a3, a4);
+    sort_pair (a5, a6);
+    sort_pair (a7, a8);
+
+    sort_pair (a1, a3);
+    sort_pair (a2, a4);
+    sort_pair (a5, a7);
+    sort_pair (a6, a8);
+
+    sort_pair (a2, a3);
+    sort_pair (a6, a7);
+
+    a5 = _mm512_max_epu8 (a1, a5);	// sort_pair (a1, a5);
+    a6 = _mm512_max_epu8 (a2, a6);	// sort_pair (a2, a6);
+    a3 = _mm512_min_epu8 (a3, a7);	// sort_pair (a3, a7);
+    a4 = _mm512_min_epu8 (a4, a8);	// sort_pair (a4, a8);
+
+    a5 = _mm512_max_epu8 (a3, a5);	// sort_pair (a3, a5);
+    a4 = _mm512_min_epu8 (a4, a6);	// sort_pair (a4, a6);
+
+    // sort_pair (au82, a3);
+    sort_pair (a4, a5);
+    // sort_pair (a6, a7);
+
+    return simd_clip(c, a4, a5);
+}
+
+template<bool aligned>
+RG_FORCEINLINE __m512i rg_mode4_avx512_16(const Byte* pSrc, int srcPitch) {
+  LOAD_SQUARE_AVX512_16_UA(pSrc, srcPitch, aligned);
+
+  sort_pair_16 (a1, a2);
+  sort_pair_16 (a3, a4);
+  sort_pair_16 (a5, a6);
+  sort_pair_16 (a7, a8);
+
+  sort_pair_16 (a1, a3);
+  sort_pair_16 (a2, a4);
+  sort_pair_16 (a5, a7);
+  sort_pair_16 (a6, a8);
+
+  sort_pair_16 (a2, a3);
+  sort_pair_16 (a6, a7);
+
+  a5 = _mm512_max_epu16 (a1, a5);	// sort_pair_16 (a1, a5);
+  a6 = _mm512_max_epu16 (a2, a6);	// sort_pair_16 (a2, a6);
+  a3 = _mm512_min_epu16 (a3, a7);	// sort_pair_16 (a3, a7);
+  a4 = _mm512_min_epu16 (a4, a8);	// sort_pair_16 (a4, a8);
+
+  a5 = _mm512_max_epu16 (a3, a5);	// sort_pair_16 (a3, a5);
+  a4 = _mm512_min_epu16 (a4, a6);	// sort_pair_16 (a4, a6);
+
+                              // sort_pair_16 (au82, a3);
+  sort_pair_16 (a4, a5);
+  // sort_pair (a6, a7);
+
+  return simd_clip_16(c, a4, a5);
+}
+
+template<bool aligned>
+RG_FORCEINLINE __m512i rg_mode4_avx512_32(const Byte* pSrc, int srcPitch) {
+  LOAD_SQUARE_AVX512_32_UA(pSrc, srcPitch, aligned);
+
+  sort_pair_32 (a1, a2);
+  sort_pair_32 (a3, a4);
+  sort_pair_32 (a5, a6);
+  sort_pair_32 (a7, a8);
+
+  sort_pair_32 (a1, a3);
+  sort_pair_32 (a2, a4);
+  sort_pair_32 (a5, a7);
+  sort_pair_32 (a6, a8);
+
+  sort_pair_32 (a2, a3);
+  sort_pair_32 (a6, a7);
+
+  a5 = _mm512_max_ps (a1, a5);	// sort_pair_32 (a1, a5);
+  a6 = _mm512_max_ps (a2, a6);	// sort_pair_32 (a2, a6);
+  a3 = _mm512_min_ps (a3, a7);	// sort_pair_32 (a3, a7);
+  a4 = _mm512_min_ps (a4, a8);	// sort_pair_32 (a4, a8);
+
+  a5 = _mm512_max_ps (a3, a5);	// sort_pair_32 (a3, a5);
+  a4 = _mm512_min_ps (a4, a6);	// sort_pair_32 (a4, a6);
+
+                                // sort_pair_32 (au82, a3);
+  sort_pair_32 (a4, a5);
+  // sort_pair (a6, a7);
+
+  return _mm512_castps_si512(simd_clip_32(c, a4, a5));
+}
+
+//-------------------
+
+template<bool aligned>
+RG_FORCEINLINE __m512i rg_mode5_avx512(const Byte* pSrc, int srcPitch) {
+    LOAD_SQUARE_AVX512_UA(pSrc, srcPitch, aligned);
+
+    auto mal1 = _mm512_max_epu8(a1, a8);
+    auto mil1 = _mm512_min_epu8(a1, a8);
+
+    auto mal2 = _mm512_max_epu8(a2, a7);
+    auto mil2 = _mm512_min_epu8(a2, a7);
+
+    auto mal3 = _mm512_max_epu8(a3, a6);
+    auto mil3 = _mm512_min_epu8(a3, a6);
+
+    auto mal4 = _mm512_max_epu8(a4, a5);
+    auto mil4 = _mm512_min_epu8(a4, a5);
+
+    auto clipped1 = simd_clip(c, mil1, mal1);
+    auto clipped2 = simd_clip(c, mil2, mal2);
+    auto clipped3 = simd_clip(c, mil3, mal3);
+    auto clipped4 = simd_clip(c, mil4, mal4);
+
+    auto c1 = abs_diff(c, clipped1);
+    auto c2 = abs_diff(c, clipped2);
+    auto c3 = abs_diff(c, clipped3);
+    auto c4 = abs_diff(c, clipped4);
+
+    auto mindiff = _mm512_min_epu8(c1, c2);
+    mindiff = _mm512_min_epu8(mindiff, c3);
+    mindiff = _mm512_min_epu8(mindiff, c4);
+
+    auto result = select_on_equal(mindiff, c1, c, clipped1);
+    result = select_on_equal(mindiff, c3, result, clipped3);
+    result = select_on_equal(mindiff, c2, result, clipped2);
+    return select_on_equal(mindiff, c4, result, clipped4);
+}
+
+template<bool aligned>
+RG_FORCEINLINE __m512i rg_mode5_avx512_16(const Byte* pSrc, int srcPitch) {
+  LOAD_SQUARE_AVX512_16_UA(pSrc, srcPitch, aligned);
+
+  auto mal1 = _mm512_max_epu16(a1, a8);
+  auto mil1 = _mm512_min_epu16(a1, a8);
+
+  auto mal2 = _mm512_max_epu16(a2, a7);
+  auto mil2 = _mm512_min_epu16(a2, a7);
+
+  auto mal3 = _mm512_max_epu16(a3, a6);
+  auto mil3 = _mm512_min_epu16(a3, a6);
+
+  auto mal4 = _mm512_max_epu16(a4, a5);
+  auto mil4 = _mm512_min_epu16(a4, a5);
+
+  auto clipped1 = simd_clip_16(c, mil1, mal1);
+  auto clipped2 = simd_clip_16(c, mil2, mal2);
+  auto clipped3 = simd_clip_16(c, mil3, mal3);
+  auto clipped4 = simd_clip_16(c, mil4, mal4);
+
+  auto c1 = abs_diff_16(c, clipped1);
+  auto c2 = abs_diff_16(c, clipped2);
+  auto c3 = abs_diff_16(c, clipped3);
+  auto c4 = abs_diff_16(c, clipped4);
+
+  auto mindiff = _mm512_min_epu16(c1, c2);
+  mindiff = _mm512_min_epu16(mindiff, c3);
+  mindiff = _mm512_min_epu16(mindiff, c4);
+
+  auto result = select_on_equal_16(mindiff, c1, c, clipped1);
+  result = select_on_equal_16(mindiff, c3, result, clipped3);
+  result = select_on_equal_16(mindiff, c2, result, clipped2);
+  return select_on_equal_16(mindiff, c4, result, clipped4);
+}
+
+template<bool aligned>
+RG_FORCEINLINE __m512i rg_mode5_avx512_32(const Byte* pSrc, int srcPitch) {
+  LOAD_SQUARE_AVX512_32_UA(pSrc, srcPitch, aligned);
+
+  auto mal1 = _mm512_max_ps(a1, a8);
+  auto mil1 = _mm512_min_ps(a1, a8);
+
+  auto mal2 = _mm512_max_ps(a2, a7);
+  auto mil2 = _mm512_min_ps(a2, a7);
+
+  auto mal3 = _mm512_max_ps(a3, a6);
+  auto mil3 = _mm512_min_ps(a3, a6);
+
+  auto mal4 = _mm512_max_ps(a4, a5);
+  auto mil4 = _mm512_min_ps(a4, a5);
+
+  auto clipped1 = simd_clip_32(c, mil1, mal1);
+  auto clipped2 = simd_clip_32(c, mil2, mal2);
+  auto clipped3 = simd_clip_32(c, mil3, mal3);
+  auto clipped4 = simd_clip_32(c, mil4, mal4);
+
+  auto c1 = abs_diff_32(c, clipped1);
+  auto c2 = abs_diff_32(c, clipped2);
+  auto c3 = abs_diff_32(c, clipped3);
+  auto c4 = abs_diff_32(c, clipped4);
+
+  auto mindiff = _mm512_min_ps(c1, c2);
+  mindiff = _mm512_min_ps(mindiff, c3);
+  mindiff = _mm512_min_ps(mindiff, c4);
+
+  auto result = select_on_equal_32(mindiff, c1, c, clipped1);
+  result = select_on_equal_32(mindiff, c3, result, clipped3);
+  result = select_on_equal_32(mindiff, c2, result, clipped2);
+  return _mm512_castps_si512(select_on_equal_32(mindiff, c4, result, clipped4));
+}
+
+//-------------------
+
+template<bool aligned>
+RG_FORCEINLINE __m512i rg_mode6_avx512(const Byte* pSrc, int srcPitch) {
+    LOAD_SQUARE_AVX512_UA(pSrc, srcPitch, aligned);
+
+    auto mal1 = _mm512_max_epu8(a1, a8);
+    auto mil1 = _mm512_min_epu8(a1, a8);
+
+    auto mal2 = _mm512_max_epu8(a2, a7);
+    auto mil2 = _mm512_min_epu8(a2, a7);
+
+    auto mal3 = _mm512_max_epu8(a3, a6);
+    auto mil3 = _mm512_min_epu8(a3, a6);
+
+    auto mal4 = _mm512_max_epu8(a4, a5);
+    auto mil4 = _mm512_min_epu8(a4, a5);
+
+    auto d1 = _mm512_subs_epu8(mal1, mil1);
+    auto d2 = _mm512_subs_epu8(mal2, mil2);
+    auto d3 = _mm512_subs_epu8(mal3, mil3);
+    auto d4 = _mm512_subs_epu8(mal4, mil4);
+
+    auto clipped1 = simd_clip(c, mil1, mal1);
+    auto clipped2 = simd_clip(c, mil2, mal2);
+    auto clipped3 = simd_clip(c, mil3, mal3);
+    auto clipped4 = simd_clip(c, mil4, mal4);
+
+    auto absdiff1 = abs_diff(c, clipped1);
+    auto absdiff2 = abs_diff(c, clipped2);
+    auto absdiff3 = abs_diff(c, clipped3);
+    auto absdiff4 = abs_diff(c, clipped4);
+    
+    auto c1 = _mm512_adds_epu8(_mm512_adds_epu8(absdiff1, absdiff1), d1);
+    auto c2 = _mm512_adds_epu8(_mm512_adds_epu8(absdiff2, absdiff2), d2);
+    auto c3 = _mm512_adds_epu8(_mm512_adds_epu8(absdiff3, absdiff3), d3);
+    auto c4 = _mm512_adds_epu8(_mm512_adds_epu8(absdiff4, absdiff4), d4);
+
+    auto mindiff = _mm512_min_epu8(c1, c2);
+    mindiff = _mm512_min_epu8(mindiff, c3);
+    mindiff = _mm512_min_epu8(mindiff, c4);
+
+    auto result = select_on_equal(mindiff, c1, c, clipped1);
+    result = select_on_equal(mindiff, c3, result, clipped3);
+    result = select_on_equal(mindiff, c2, result, clipped2);
+    return select_on_equal(mindiff, c4, result, clipped4);
+}
+
+template<int bits_per_pixel, bool aligned>
+RG_FORCEINLINE __m512i rg_mode6_avx512_16(const Byte* pSrc, int srcPitch) {
+  LOAD_SQUARE_AVX512_16_UA(pSrc, srcPitch, aligned);
+
+  auto mal1 = _mm512_max_epu16(a1, a8);
+  auto mil1 = _mm512_min_epu16(a1, a8);
+
+  auto mal2 = _mm512_max_epu16(a2, a7);
+  auto mil2 = _mm512_min_epu16(a2, a7);
+
+  auto mal3 = _mm512_max_epu16(a3, a6);
+  auto mil3 = _mm512_min_epu16(a3, a6);
+
+  auto mal4 = _mm512_max_epu16(a4, a5);
+  auto mil4 = _mm512_min_epu16(a4, a5);
+
+  auto d1 = _mm512_subs_epu16(mal1, mil1);
+  auto d2 = _mm512_subs_epu16(mal2, mil2);
+  auto d3 = _mm512_subs_epu16(mal3, mil3);
+  auto d4 = _mm512_subs_epu16(mal4, mil4);
+
+  auto clipped1 = simd_clip_16(c, mil1, mal1);
+  auto clipped2 = simd_clip_16(c, mil2, mal2);
+  auto clipped3 = simd_clip_16(c, mil3, mal3);
+  auto clipped4 = simd_clip_16(c, mil4, mal4);
+
+  auto absdiff1 = abs_diff_16(c, clipped1);
+  auto absdiff2 = abs_diff_16(c, clipped2);
+  auto absdiff3 = abs_diff_16(c, clipped3);
+  auto absdiff4 = abs_diff_16(c, clipped4);
+
+  auto c1 = _mm512_adds_epu16(_mm512_adds_epu16(absdiff1, absdiff1), d1);
+  auto c2 = _mm512_adds_epu16(_mm512_adds_epu16(absdiff2, absdiff2), d2);
+  auto c3 = _mm512_adds_epu16(_mm512_adds_epu16(absdiff3, absdiff3), d3);
+  auto c4 = _mm512_adds_epu16(_mm512_adds_epu16(absdiff4, absdiff4), d4);
+
+  if (bits_per_pixel < 16) { // adds saturates to FFFF
+    const __m512i pixel_max = _mm512_set1_epi16((short)((1 << bits_per_pixel) - 1));
+    c1 = _mm512_min_epu16(c1, pixel_max);
+    c2 = _mm512_min_epu16(c2, pixel_max);
+    c3 = _mm512_min_epu16(c3, pixel_max);
+    c4 = _mm512_min_epu16(c4, pixel_max);
+  }
+
+  auto mindiff = _mm512_min_epu16(c1, c2);
+  mindiff = _mm512_min_epu16(mindiff, c3);
+  mindiff = _mm512_min_epu16(mindiff, c4);
+
+  auto result = select_on_equal_16(mindiff, c1, c, clipped1);
+  result = select_on_equal_16(mindiff, c3, result, clipped3);
+  result = select_on_equal_16(mindiff, c2, result, clipped2);
+  return select_on_equal_16(mindiff, c4, result, clipped4);
+}
+
+
+
+//-------------------
+
+template<bool aligned>
+RG_FORCEINLINE __m512i rg_mode7_avx512(const Byte* pSrc, int srcPitch) {
+    LOAD_SQUARE_AVX512_UA(pSrc, srcPitch, aligned);
+
+    auto mal1 = _mm512_max_epu8(a1, a8);
+    auto mil1 = _mm512_min_epu8(a1, a8);
+
+    auto mal2 = _mm512_max_epu8(a2, a7);
+    auto mil2 = _mm512_min_epu8(a2, a7);
+
+    auto mal3 = _mm512_max_epu8(a3, a6);
+    auto mil3 = _mm512_min_epu8(a3, a6);
+
+    auto mal4 = _mm512_max_epu8(a4, a5);
+    auto mil4 = _mm512_min_epu8(a4, a5);
+
+    auto d1 = _mm512_subs_epu8(mal1, mil1);
+    auto d2 = _mm512_subs_epu8(mal2, mil2);
+    auto d3 = _mm512_subs_epu8(mal3, mil3);
+    auto d4 = _mm512_subs_epu8(mal4, mil4);
+
+    auto clipped1 = simd_clip(c, mil1, mal1);
+    auto clipped2 = simd_clip(c, mil2, mal2);
+    auto clipped3 = simd_clip(c, mil3, mal3);
+    auto clipped4 = simd_clip(c, mil4, mal4);
+    //todo: what happens when this overflows?
+    auto c1 = _mm512_adds_epu8(abs_diff(c, clipped1), d1);
+    auto c2 = _mm512_adds_epu8(abs_diff(c, clipped2), d2);
+    auto c3 = _mm512_adds_epu8(abs_diff(c, clipped3), d3);
+    auto c4 = _mm512_adds_epu8(abs_diff(c, clipped4), d4);
+
+    auto mindiff = _mm512_min_epu8(c1, c2);
+    mindiff = _mm512_min_epu8(mindiff, c3);
+    mindiff = _mm512_min_epu8(mindiff, c4);
+
+    auto result = select_on_equal(mindiff, c1, c, clipped1);
+    result = select_on_equal(mindiff, c3, result, clipped3);
+    result = select_on_equal(mindiff, c2, result, clipped2);
+    return select_on_equal(mindiff, c4, result, clipped4);
+}
+
+template<bool aligned>
+RG_FORCEINLINE __m512i rg_mode7_avx512_16(const Byte* pSrc, int srcPitch) {
+  LOAD_SQUARE_AVX512_16_UA(pSrc, srcPitch, aligned);
+
+  auto mal1 = _mm512_max_epu16(a1, a8);
+  auto mil1 = _mm512_min_epu16(a1, a8);
+
+  auto mal2 = _mm512_max_epu16(a2, a7);
+  auto mil2 = _mm512_min_epu16(a2, a7);
+
+  auto mal3 = _mm512_max_epu16(a3, a6);
+  auto mil3 = _mm512_min_epu16(a3, a6);
+
+  auto mal4 = _mm512_max_epu16(a4, a5);
+  auto mil4 = _mm512_min_epu16(a4, a5);
+
+  auto d1 = _mm512_subs_epu16(mal1, mil1);
+  auto d2 = _mm512_subs_epu16(mal2, mil2);
+  auto d3 = _mm512_subs_epu16(mal3, mil3);
+  auto d4 = _mm512_subs_epu16(mal4, mil4);
+
+  auto clipped1 = simd_clip_16(c, mil1, mal1);
+  auto clipped2 = simd_clip_16(c, mil2, mal2);
+  auto clipped3 = simd_clip_16(c, mil3, mal3);
+  auto clipped4 = simd_clip_16(c, mil4, mal4);
+  //todo: what happens when this overflows?
+  auto c1 = _mm512_adds_epu16(abs_diff_16(c, clipped1), d1);
+  auto c2 = _mm512_adds_epu16(abs_diff_16(c, clipped2), d2);
+  auto c3 = _mm512_adds_epu16(abs_diff_16(c, clipped3), d3);
+  auto c4 = _mm512_adds_epu16(abs_diff_16(c, clipped4), d4);
+
+  auto mindiff = _mm512_min_epu16(c1, c2);
+  mindiff = _mm512_min_epu16(mindiff, c3);
+  mindiff = _mm512_min_epu16(mindiff, c4);
+
+  auto result = select_on_equal_16(mindiff, c1, c, clipped1);
+  result = select_on_equal_16(mindiff, c3, result, clipped3);
+  result = select_on_equal_16(mindiff, c2, result, clipped2);
+  return select_on_equal_16(mindiff, c4, result, clipped4);
+}
+
+template<bool aligned>
+RG_FORCEINLINE __m512i rg_mode7_avx512_32(const Byte* pSrc, int srcPitch) {
+  LOAD_SQUARE_AVX512_32_UA(pSrc, srcPitch, aligned);
+
+  auto mal1 = _mm512_max_ps(a1, a8);
+  auto mil1 = _mm512_min_ps(a1, a8);
+
+  auto mal2 = _mm512_max_ps(a2, a7);
+  auto mil2 = _mm512_min_ps(a2, a7);
+
+  auto mal3 = _mm512_max_ps(a3, a6);
+  auto mil3 = _mm512_min_ps(a3, a6);
+
+  auto mal4 = _mm512_max_ps(a4, a5);
+  auto mil4 = _mm512_min_ps(a4, a5);
+
+  auto d1 = _mm512_subs_ps(mal1, mil1);
+  auto d2 = _mm512_subs_ps(mal2, mil2);
+  auto d3 = _mm512_subs_ps(mal3, mil3);
+  auto d4 = _mm512_subs_ps(mal4, mil4);
+
+  auto clipped1 = simd_clip_32(c, mil1, mal1);
+  auto clipped2 = simd_clip_32(c, mil2, mal2);
+  auto clipped3 = simd_clip_32(c, mil3, mal3);
+  auto clipped4 = simd_clip_32(c, mil4, mal4);
+  //todo: what happens when this overflows?
+  auto c1 = _mm512_adds_ps(abs_diff_32(c, clipped1), d1);
+  auto c2 = _mm512_adds_ps(abs_diff_32(c, clipped2), d2);
+  auto c3 = _mm512_adds_ps(abs_diff_32(c, clipped3), d3);
+  auto c4 = _mm512_adds_ps(abs_diff_32(c, clipped4), d4);
+
+  auto mindiff = _mm512_min_ps(c1, c2);
+  mindiff = _mm512_min_ps(mindiff, c3);
+  mindiff = _mm512_min_ps(mindiff, c4);
+
+  auto result = select_on_equal_32(mindiff, c1, c, clipped1);
+  result = select_on_equal_32(mindiff, c3, result, clipped3);
+  result = select_on_equal_32(mindiff, c2, result, clipped2);
+  return _mm512_castps_si512(select_on_equal_32(mindiff, c4, result, clipped4));
+}
+
+//-------------------
+
+template<bool aligned>
+RG_FORCEINLINE __m512i rg_mode8_avx512(const Byte* pSrc, int srcPitch) {
+    LOAD_SQUARE_AVX512_UA(pSrc, srcPitch, aligned);
+
+    auto mal1 = _mm512_max_epu8(a1, a8);
+    auto mil1 = _mm512_min_epu8(a1, a8);
+
+    auto mal2 = _mm512_max_epu8(a2, a7);
+    auto mil2 = _mm512_min_epu8(a2, a7);
+
+    auto mal3 = _mm512_max_epu8(a3, a6);
+    auto mil3 = _mm512_min_epu8(a3, a6);
+
+    auto mal4 = _mm512_max_epu8(a4, a5);
+    auto mil4 = _mm512_min_epu8(a4, a5);
+
+    auto d1 = _mm512_subs_epu8(mal1, mil1);
+    auto d2 = _mm512_subs_epu8(mal2, mil2);
+    auto d3 = _mm512_subs_epu8(mal3, mil3);
+    auto d4 = _mm512_subs_epu8(mal4, mil4);
+
+    auto clipped1 = simd_clip(c, mil1, mal1);
+    auto clipped2 = simd_clip(c, mil2, mal2);
+    auto clipped3 = simd_clip(c, mil3, mal3);
+    auto clipped4 = simd_clip(c, mil4, mal4);
+
+    auto c1 = _mm512_adds_epu8(abs_diff(c, clipped1), _mm512_adds_epu8(d1, d1));
+    auto c2 = _mm512_adds_epu8(abs_diff(c, clipped2), _mm512_adds_epu8(d2, d2));
+    auto c3 = _mm512_adds_epu8(abs_diff(c, clipped3), _mm512_adds_epu8(d3, d3));
+    auto c4 = _mm512_adds_epu8(abs_diff(c, clipped4), _mm512_adds_epu8(d4, d4));
+
+    auto mindiff = _mm512_min_epu8(c1, c2);
+    mindiff = _mm512_min_epu8(mindiff, c3);
+    mindiff = _mm512_min_epu8(mindiff, c4);
+
+    auto result = select_on_equal(mindiff, c1, c, clipped1);
+    result = select_on_equal(mindiff, c3, result, clipped3);
+    result = select_on_equal(mindiff, c2, result, clipped2);
+    return select_on_equal(mindiff, c4, result, clipped4);
+}
+
+template<int bits_per_pixel, bool aligned>
+RG_FORCEINLINE __m512i rg_mode8_avx512_16(const Byte* pSrc, int srcPitch) {
+  LOAD_SQUARE_AVX512_16_UA(pSrc, srcPitch, aligned);
+
+  auto mal1 = _mm512_max_epu16(a1, a8);
+  auto mil1 = _mm512_min_epu16(a1, a8);
+
+  auto mal2 = _mm512_max_epu16(a2, a7);
+  auto mil2 = _mm512_min_epu16(a2, a7);
+
+  auto mal3 = _mm512_max_epu16(a3, a6);
+  auto mil3 = _mm512_min_epu16(a3, a6);
+
+  auto mal4 = _mm512_max_epu16(a4, a5);
+  auto mil4 = _mm512_min_epu16(a4, a5);
+
+  auto d1 = _mm512_subs_epu16(mal1, mil1);
+  auto d2 = _mm512_subs_epu16(mal2, mil2);
+  auto d3 = _mm512_subs_epu16(mal3, mil3);
+  auto d4 = _mm512_subs_epu16(mal4, mil4);
+
+  auto clipped1 = simd_clip_16(c, mil1, mal1);
+  auto clipped2 = simd_clip_16(c, mil2, mal2);
+  auto clipped3 = simd_clip_16(c, mil3, mal3);
+  auto clipped4 = simd_clip_16(c, mil4, mal4);
+
+  auto c1 = _mm512_adds_epu16(abs_diff_16(c, clipped1), _mm512_adds_epu16(d1, d1));
+  auto c2 = _mm512_adds_epu16(abs_diff_16(c, clipped2), _mm512_adds_epu16(d2, d2));
+  auto c3 = _mm512_adds_epu16(abs_diff_16(c, clipped3), _mm512_adds_epu16(d3, d3));
+  auto c4 = _mm512_adds_epu16(abs_diff_16(c, clipped4), _mm512_adds_epu16(d4, d4));
+
+  if (bits_per_pixel < 16) { // adds saturates to FFFF
+    const __m512i pixel_max = _mm512_set1_epi16((short)((1 << bits_per_pixel) - 1));
+    c1 = _mm512_min_epu16(c1, pixel_max);
+    c2 = _mm512_min_epu16(c2, pixel_max);
+    c3 = _mm512_min_epu16(c3, pixel_max);
+    c4 = _mm512_min_epu16(c4, pixel_max);
+  }
+
+  auto mindiff = _mm512_min_epu16(c1, c2);
+  mindiff = _mm512_min_epu16(mindiff, c3);
+  mindiff = _mm512_min_epu16(mindiff, c4);
+
+  auto result = select_on_equal_16(mindiff, c1, c, clipped1);
+  result = select_on_equal_16(mindiff, c3, result, clipped3);
+  result = select_on_equal_16(mindiff, c2, result, clipped2);
+  return select_on_equal_16(mindiff, c4, result, clipped4);
+}
+
+
+//-------------------
+
+template<bool aligned>
+RG_FORCEINLINE __m512i rg_mode9_avx512(const Byte* pSrc, int srcPitch) {
+    LOAD_SQUARE_AVX512_UA(pSrc, srcPitch, aligned);
+
+    auto mal1 = _mm512_max_epu8(a1, a8);
+    auto mil1 = _mm512_min_epu8(a1, a8);
+
+    auto mal2 = _mm512_max_epu8(a2, a7);
+    auto mil2 = _mm512_min_epu8(a2, a7);
+
+    auto mal3 = _mm512_max_epu8(a3, a6);
+    auto mil3 = _mm512_min_epu8(a3, a6);
+
+    auto mal4 = _mm512_max_epu8(a4, a5);
+    auto mil4 = _mm512_min_epu8(a4, a5);
+
+    auto d1 = _mm512_subs_epu8(mal1, mil1);
+    auto d2 = _mm512_subs_epu8(mal2, mil2);
+    auto d3 = _mm512_subs_epu8(mal3, mil3);
+    auto d4 = _mm512_subs_epu8(mal4, mil4);
+
+    auto mindiff = _mm512_min_epu8(d1, d2);
+    mindiff = _mm512_min_epu8(mindiff, d3);
+    mindiff = _mm512_min_epu8(mindiff, d4);
+
+    auto result = select_on_equal(mindiff, d1, c, simd_clip(c, mil1, mal1));
+    result = select_on_equal(mindiff, d3, result, simd_clip(c, mil3, mal3));
+    result = select_on_equal(mindiff, d2, result, simd_clip(c, mil2, mal2));
+    return select_on_equal(mindiff, d4, result, simd_clip(c, mil4, mal4));
+}
+
+template<bool aligned>
+RG_FORCEINLINE __m512i rg_mode9_avx512_16(const Byte* pSrc, int srcPitch) {
+  LOAD_SQUARE_AVX512_16_UA(pSrc, srcPitch, aligned);
+
+  auto mal1 = _mm512_max_epu16(a1, a8);
+  auto mil1 = _mm512_min_epu16(a1, a8);
+
+  auto mal2 = _mm512_max_epu16(a2, a7);
+  auto mil2 = _mm512_min_epu16(a2, a7);
+
+  auto mal3 = _mm512_max_epu16(a3, a6);
+  auto mil3 = _mm512_min_epu16(a3, a6);
+
+  auto mal4 = _mm512_max_epu16(a4, a5);
+  auto mil4 = _mm512_min_epu16(a4, a5);
+
+  auto d1 = _mm512_subs_epu16(mal1, mil1);
+  auto d2 = _mm512_subs_epu16(mal2, mil2);
+  auto d3 = _mm512_subs_epu16(mal3, mil3);
+  auto d4 = _mm512_subs_epu16(mal4, mil4);
+
+  auto mindiff = _mm512_min_epu16(d1, d2);
+  mindiff = _mm512_min_epu16(mindiff, d3);
+  mindiff = _mm512_min_epu16(mindiff, d4);
+
+  auto result = select_on_equal_16(mindiff, d1, c, simd_clip_16(c, mil1, mal1));
+  result = select_on_equal_16(mindiff, d3, result, simd_clip_16(c, mil3, mal3));
+  result = select_on_equal_16(mindiff, d2, result, simd_clip_16(c, mil2, mal2));
+  return select_on_equal_16(mindiff, d4, result, simd_clip_16(c, mil4, mal4));
+}
+
+template<bool aligned>
+RG_FORCEINLINE __m512i rg_mode9_avx512_32(const Byte* pSrc, int srcPitch) {
+  LOAD_SQUARE_AVX512_32_UA(pSrc, srcPitch, aligned);
+
+  auto mal1 = _mm512_max_ps(a1, a8);
+  auto mil1 = _mm512_min_ps(a1, a8);
+
+  auto mal2 = _mm512_max_ps(a2, a7);
+  auto mil2 = _mm512_min_ps(a2, a7);
+
+  auto mal3 = _mm512_max_ps(a3, a6);
+  auto mil3 = _mm512_min_ps(a3, a6);
+
+  auto mal4 = _mm512_max_ps(a4, a5);
+  auto mil4 = _mm512_min_ps(a4, a5);
+
+  auto d1 = _mm512_subs_ps(mal1, mil1);
+  auto d2 = _mm512_subs_ps(mal2, mil2);
+  auto d3 = _mm512_subs_ps(mal3, mil3);
+  auto d4 = _mm512_subs_ps(mal4, mil4);
+
+  auto mindiff = _mm512_min_ps(d1, d2);
+  mindiff = _mm512_min_ps(mindiff, d3);
+  mindiff = _mm512_min_ps(mindiff, d4);
+
+  auto result = select_on_equal_32(mindiff, d1, c, simd_clip_32(c, mil1, mal1));
+  result = select_on_equal_32(mindiff, d3, result, simd_clip_32(c, mil3, mal3));
+  result = select_on_equal_32(mindiff, d2, result, simd_clip_32(c, mil2, mal2));
+  return _mm512_castps_si512(select_on_equal_32(mindiff, d4, result, simd_clip_32(c, mil4, mal4)));
+}
+
+
+//-------------------
+
+template<bool aligned>
+RG_FORCEINLINE __m512i rg_mode10_avx512(const Byte* pSrc, int srcPitch) {
+    LOAD_SQUARE_AVX512_UA(pSrc, srcPitch, aligned);
+
+    auto d1 = abs_diff(c, a1);
+    auto d2 = abs_diff(c, a2);
+    auto d3 = abs_diff(c, a3);
+    auto d4 = abs_diff(c, a4);
+    auto d5 = abs_diff(c, a5);
+    auto d6 = abs_diff(c, a6);
+    auto d7 = abs_diff(c, a7);
+    auto d8 = abs_diff(c, a8);
+
+    auto mindiff = _mm512_min_epu8(d1, d2);
+    mindiff = _mm512_min_epu8(mindiff, d3);
+    mindiff = _mm512_min_epu8(mindiff, d4);
+    mindiff = _mm512_min_epu8(mindiff, d5);
+    mindiff = _mm512_min_epu8(mindiff, d6);
+    mindiff = _mm512_min_epu8(mindiff, d7);
+    mindiff = _mm512_min_epu8(mindiff, d8);
+
+    auto result = select_on_equal(mindiff, d4, c, a4);
+    result = select_on_equal(mindiff, d5, result, a5);
+    result = select_on_equal(mindiff, d1, result, a1);
+    result = select_on_equal(mindiff, d3, result, a3);
+    result = select_on_equal(mindiff, d2, result, a2);
+    result = select_on_equal(mindiff, d6, result, a6);
+    result = select_on_equal(mindiff, d8, result, a8);
+    return select_on_equal(mindiff, d7, result, a7);
+}
+
+template<bool aligned>
+RG_FORCEINLINE __m512i rg_mode10_avx512_16(const Byte* pSrc, int srcPitch) {
+  LOAD_SQUARE_AVX512_16_UA(pSrc, srcPitch, aligned);
+
+  auto d1 = abs_diff_16(c, a1);
+  auto d2 = abs_diff_16(c, a2);
+  auto d3 = abs_diff_16(c, a3);
+  auto d4 = abs_diff_16(c, a4);
+  auto d5 = abs_diff_16(c, a5);
+  auto d6 = abs_diff_16(c, a6);
+  auto d7 = abs_diff_16(c, a7);
+  auto d8 = abs_diff_16(c, a8);
+
+  auto mindiff = _mm512_min_epu16(d1, d2);
+  mindiff = _mm512_min_epu16(mindiff, d3);
+  mindiff = _mm512_min_epu16(mindiff, d4);
+  mindiff = _mm512_min_epu16(mindiff, d5);
+  mindiff = _mm512_min_epu16(mindiff, d6);
+  mindiff = _mm512_min_epu16(mindiff, d7);
+  mindiff = _mm512_min_epu16(mindiff, d8);
+
+  auto result = select_on_equal_16(mindiff, d4, c, a4);
+  result = select_on_equal_16(mindiff, d5, result, a5);
+  result = select_on_equal_16(mindiff, d1, result, a1);
+  result = select_on_equal_16(mindiff, d3, result, a3);
+  result = select_on_equal_16(mindiff, d2, result, a2);
+  result = select_on_equal_16(mindiff, d6, result, a6);
+  result = select_on_equal_16(mindiff, d8, result, a8);
+  return select_on_equal_16(mindiff, d7, result, a7);
+}
+
+template<bool aligned>
+RG_FORCEINLINE __m512i rg_mode10_avx512_32(const Byte* pSrc, int srcPitch) {
+  LOAD_SQUARE_AVX512_32_UA(pSrc, srcPitch, aligned);
+
+  auto d1 = abs_diff_32(c, a1);
+  auto d2 = abs_diff_32(c, a2);
+  auto d3 = abs_diff_32(c, a3);
+  auto d4 = abs_diff_32(c, a4);
+  auto d5 = abs_diff_32(c, a5);
+  auto d6 = abs_diff_32(c, a6);
+  auto d7 = abs_diff_32(c, a7);
+  auto d8 = abs_diff_32(c, a8);
+
+  auto mindiff = _mm512_min_ps(d1, d2);
+  mindiff = _mm512_min_ps(mindiff, d3);
+  mindiff = _mm512_min_ps(mindiff, d4);
+  mindiff = _mm512_min_ps(mindiff, d5);
+  mindiff = _mm512_min_ps(mindiff, d6);
+  mindiff = _mm512_min_ps(mindiff, d7);
+  mindiff = _mm512_min_ps(mindiff, d8);
+
+  auto result = select_on_equal_32(mindiff, d4, c, a4);
+  result = select_on_equal_32(mindiff, d5, result, a5);
+  result = select_on_equal_32(mindiff, d1, result, a1);
+  result = select_on_equal_32(mindiff, d3, result, a3);
+  result = select_on_equal_32(mindiff, d2, result, a2);
+  result = select_on_equal_32(mindiff, d6, result, a6);
+  result = select_on_equal_32(mindiff, d8, result, a8);
+  return _mm512_castps_si512(select_on_equal_32(mindiff, d7, result, a7));
+}
+
+// mode11 after mode12
+
+//-------------------
+
+template<bool aligned>
+RG_FORCEINLINE __m512i rg_mode12_avx512(const Byte* pSrc, int srcPitch) {
+    LOAD_SQUARE_AVX512_UA(pSrc, srcPitch, aligned);
+
+    auto a13  = _mm512_avg_epu8 (a1, a3);
+    auto a123 = _mm512_avg_epu8 (a2, a13);
+
+    auto a68  = _mm512_avg_epu8 (a6, a8);
+    auto a678 = _mm512_avg_epu8 (a7, a68);
+
+    auto a45  = _mm512_avg_epu8 (a4, a5);
+    auto a4c5 = _mm512_avg_epu8 (c, a45);
+
+    auto a123678  = _mm512_avg_epu8 (a123, a678);
+    auto a123678b = _mm512_subs_epu8 (a123678, _mm512_set1_epi8(1));
+
+    return _mm512_avg_epu8 (a4c5, a123678b);
+}
+
+template<bool aligned>
+RG_FORCEINLINE __m512i rg_mode12_avx512_16(const Byte* pSrc, int srcPitch) {
+  LOAD_SQUARE_AVX512_16_UA(pSrc, srcPitch, aligned);
+
+  auto a13  = _mm512_avg_epu16 (a1, a3);
+  auto a123 = _mm512_avg_epu16 (a2, a13);
+
+  auto a68  = _mm512_avg_epu16 (a6, a8);
+  auto a678 = _mm512_avg_epu16 (a7, a68);
+
+  auto a45  = _mm512_avg_epu16 (a4, a5);
+  auto a4c5 = _mm512_avg_epu16 (c, a45);
+
+  auto a123678  = _mm512_avg_epu16 (a123, a678);
+  auto a123678b = _mm512_subs_epu16 (a123678, _mm512_set1_epi16(1));
+
+  return _mm512_avg_epu16 (a4c5, a123678b);
+}
+
+
+//-------------------
+/*
+template<bool aligned>
+RG_FORCEINLINE __m512i rg_mode12_avx512(const Byte* pSrc, int srcPitch);
+template<bool aligned>
+RG_FORCEINLINE __m512i rg_mode12_avx512_16(const Byte* pSrc, int srcPitch);
+*/
+//todo: actually implement is as mode 11
+template<bool aligned>
+RG_FORCEINLINE __m512i rg_mode11_avx512(const Byte* pSrc, int srcPitch) {
+  return rg_mode12_avx512<aligned>(pSrc, srcPitch);
+}
+template<bool aligned>
+RG_FORCEINLINE __m512i rg_mode11_avx512_16(const Byte* pSrc, int srcPitch) {
+  return rg_mode12_avx512_16<aligned>(pSrc, srcPitch);
+}
+
+//-------------------
+
+template<bool aligned>
+RG_FORCEINLINE __m512i rg_mode13_and14_avx512(const Byte* pSrc, int srcPitch) {
+    LOAD_SQUARE_AVX512_UA(pSrc, srcPitch, aligned);
+
+    auto d1 = abs_diff(a1, a8);
+    auto d2 = abs_diff(a2, a7);
+    auto d3 = abs_diff(a3, a6);
+
+    auto mindiff = _mm512_min_epu8(d1, d2);
+    mindiff = _mm512_min_epu8(mindiff, d3);
+
+    auto result = select_on_equal(mindiff, d1, c, _mm512_avg_epu8(a1, a8));
+    result = select_on_equal(mindiff, d3, result,  _mm512_avg_epu8(a3, a6));
+    return select_on_equal(mindiff, d2, result,  _mm512_avg_epu8(a2, a7));
+}
+
+template<bool aligned>
+RG_FORCEINLINE __m512i rg_mode13_and14_avx512_16(const Byte* pSrc, int srcPitch) {
+  LOAD_SQUARE_AVX512_16_UA(pSrc, srcPitch, aligned);
+
+  auto d1 = abs_diff_16(a1, a8);
+  auto d2 = abs_diff_16(a2, a7);
+  auto d3 = abs_diff_16(a3, a6);
+
+  auto mindiff = _mm512_min_epu16(d1, d2);
+  mindiff = _mm512_min_epu16(mindiff, d3);
+
+  auto result = select_on_equal_16(mindiff, d1, c, _mm512_avg_epu16(a1, a8));
+  result = select_on_equal_16(mindiff, d3, result,  _mm512_avg_epu16(a3, a6));
+  return select_on_equal_16(mindiff, d2, result,  _mm512_avg_epu16(a2, a7));
+}
+
+template<bool aligned>
+RG_FORCEINLINE __m512i rg_mode13_and14_avx512_32(const Byte* pSrc, int srcPitch) {
+  LOAD_SQUARE_AVX512_32_UA(pSrc, srcPitch, aligned);
+
+  auto d1 = abs_diff_32(a1, a8);
+  auto d2 = abs_diff_32(a2, a7);
+  auto d3 = abs_diff_32(a3, a6);
+
+  auto mindiff = _mm512_min_ps(d1, d2);
+  mindiff = _mm512_min_ps(mindiff, d3);
+
+  auto result = select_on_equal_32(mindiff, d1, c, _mm512_avg_ps(a1, a8));
+  result = select_on_equal_32(mindiff, d3, result,  _mm512_avg_ps(a3, a6));
+  return _mm512_castps_si512(select_on_equal_32(mindiff, d2, result,  _mm512_avg_ps(a2, a7)));
+}
+
+//-------------------
+
+//rounding does not match
+template<bool aligned>
+RG_FORCEINLINE __m512i rg_mode15_and16_avx512(const Byte* pSrc, int srcPitch) {
+    LOAD_SQUARE_AVX512_UA(pSrc, srcPitch, aligned);
+
+    auto max18 = _mm512_max_epu8(a1, a8);
+    auto min18 = _mm512_min_epu8(a1, a8);
+
+    auto max27 = _mm512_max_epu8(a2, a7);
+    auto min27 = _mm512_min_epu8(a2, a7);
+
+    auto max36 = _mm512_max_epu8(a3, a6);
+    auto min36 = _mm512_min_epu8(a3, a6);
+
+    auto d1 = _mm512_subs_epu8(max18, min18);
+    auto d2 = _mm512_subs_epu8(max27, min27);
+    auto d3 = _mm512_subs_epu8(max36, min36);
+
+    auto mindiff = _mm512_min_epu8(d1, d2);
+    mindiff = _mm512_min_epu8(mindiff, d3);
+
+    auto avg12 = _mm512_avg_epu8(a1, a2);
+    auto avg23 = _mm512_avg_epu8(a2, a3);
+    auto avg67 = _mm512_avg_epu8(a6, a7);
+    auto avg78 = _mm512_avg_epu8(a7, a8);
+
+    auto avg1223 = _mm512_avg_epu8(avg12, avg23);
+
+    auto avg6778 = _mm512_avg_epu8(avg67, avg78);
+    auto avg6778b = _mm512_subs_epu8(avg6778, _mm512_set1_epi8(1));
+    auto avg = _mm512_avg_epu8(avg1223, avg6778b);
+    
+
+    auto result = select_on_equal(mindiff, d1, c, simd_clip(avg, min18, max18));
+    result = select_on_equal(mindiff, d3, result, simd_clip(avg, min36, max36));
+    return select_on_equal(mindiff, d2, result, simd_clip(avg, min27, max27));
+}
+
+template<bool aligned>
+RG_FORCEINLINE __m512i rg_mode15_and16_avx512_16(const Byte* pSrc, int srcPitch) {
+  LOAD_SQUARE_AVX512_16_UA(pSrc, srcPitch, aligned);
+
+  auto max18 = _mm512_max_epu16(a1, a8);
+  auto min18 = _mm512_min_epu16(a1, a8);
+
+  auto max27 = _mm512_max_epu16(a2, a7);
+  auto min27 = _mm512_min_epu16(a2, a7);
+
+  auto max36 = _mm512_max_epu16(a3, a6);
+  auto min36 = _mm512_min_epu16(a3, a6);
+
+  auto d1 = _mm512_subs_epu16(max18, min18);
+  auto d2 = _mm512_subs_epu16(max27, min27);
+  auto d3 = _mm512_subs_epu16(max36, min36);
+
+  auto mindiff = _mm512_min_epu16(d1, d2);
+  mindiff = _mm512_min_epu16(mindiff, d3);
+
+  auto avg12 = _mm512_avg_epu16(a1, a2);
+  auto avg23 = _mm512_avg_epu16(a2, a3);
+  auto avg67 = _mm512_avg_epu16(a6, a7);
+  auto avg78 = _mm512_avg_epu16(a7, a8);
+
+  auto avg1223 = _mm512_avg_epu16(avg12, avg23);
+
+  auto avg6778 = _mm512_avg_epu16(avg67, avg78);
+  auto avg6778b = _mm512_subs_epu16(avg6778, _mm512_set1_epi16(1));
+  auto avg = _mm512_avg_epu16(avg1223, avg6778b);
+
+
+  auto result = select_on_equal_16(mindiff, d1, c, simd_clip_16(avg, min18, max18));
+  result = select_on_equal_16(mindiff, d3, result, simd_clip_16(avg, min36, max36));
+  return select_on_equal_16(mindiff, d2, result, simd_clip_16(avg, min27, max27));
+}
+
+
+//-------------------
+
+template<bool aligned>
+RG_FORCEINLINE __m512i rg_mode17_avx512(const Byte* pSrc, int srcPitch) {
+    LOAD_SQUARE_AVX512_UA(pSrc, srcPitch, aligned);
+
+    auto mal1 = _mm512_max_epu8(a1, a8);
+    auto mil1 = _mm512_min_epu8(a1, a8);
+
+    auto mal2 = _mm512_max_epu8(a2, a7);
+    auto mil2 = _mm512_min_epu8(a2, a7);
+
+    auto mal3 = _mm512_max_epu8(a3, a6);
+    auto mil3 = _mm512_min_epu8(a3, a6);
+
+    auto mal4 = _mm512_max_epu8(a4, a5);
+    auto mil4 = _mm512_min_epu8(a4, a5);
+
+    auto lower = _mm512_max_epu8(mil1, mil2);
+    lower = _mm512_max_epu8(lower, mil3);
+    lower = _mm512_max_epu8(lower, mil4);
+
+    auto upper = _mm512_min_epu8(mal1, mal2);
+    upper = _mm512_min_epu8(upper, mal3);
+    upper = _mm512_min_epu8(upper, mal4);
+
+    auto real_upper = _mm512_max_epu8(upper, lower);
+    auto real_lower = _mm512_min_epu8(upper, lower);
+
+    return simd_clip(c, real_lower, real_upper);
+}
+
+template<bool aligned>
+RG_FORCEINLINE __m512i rg_mode17_avx512_16(const Byte* pSrc, int srcPitch) {
+  LOAD_SQUARE_AVX512_16_UA(pSrc, srcPitch, aligned);
+
+  auto mal1 = _mm512_max_epu16(a1, a8);
+  auto mil1 = _mm512_min_epu16(a1, a8);
+
+  auto mal2 = _mm512_max_epu16(a2, a7);
+  auto mil2 = _mm512_min_epu16(a2, a7);
+
+  auto mal3 = _mm512_max_epu16(a3, a6);
+  auto mil3 = _mm512_min_epu16(a3, a6);
+
+  auto mal4 = _mm512_max_epu16(a4, a5);
+  auto mil4 = _mm512_min_epu16(a4, a5);
+
+  auto lower = _mm512_max_epu16(mil1, mil2);
+  lower = _mm512_max_epu16(lower, mil3);
+  lower = _mm512_max_epu16(lower, mil4);
+
+  auto upper = _mm512_min_epu16(mal1, mal2);
+  upper = _mm512_min_epu16(upper, mal3);
+  upper = _mm512_min_epu16(upper, mal4);
+
+  auto real_upper = _mm512_max_epu16(upper, lower);
+  auto real_lower = _mm512_min_epu16(upper, lower);
+
+  return simd_clip_16(c, real_lower, real_upper);
+}
+
+template<bool aligned>
+RG_FORCEINLINE __m512i rg_mode17_avx512_32(const Byte* pSrc, int srcPitch) {
+  LOAD_SQUARE_AVX512_32_UA(pSrc, srcPitch, aligned);
+
+  auto mal1 = _mm512_max_ps(a1, a8);
+  auto mil1 = _mm512_min_ps(a1, a8);
+
+  auto mal2 = _mm512_max_ps(a2, a7);
+  auto mil2 = _mm512_min_ps(a2, a7);
+
+  auto mal3 = _mm512_max_ps(a3, a6);
+  auto mil3 = _mm512_min_ps(a3, a6);
+
+  auto mal4 = _mm512_max_ps(a4, a5);
+  auto mil4 = _mm512_min_ps(a4, a5);
+
+  auto lower = _mm512_max_ps(mil1, mil2);
+  lower = _mm512_max_ps(lower, mil3);
+  lower = _mm512_max_ps(lower, mil4);
+
+  auto upper = _mm512_min_ps(mal1, mal2);
+  upper = _mm512_min_ps(upper, mal3);
+  upper = _mm512_min_ps(upper, mal4);
+
+  auto real_upper = _mm512_max_ps(upper, lower);
+  auto real_lower = _mm512_min_ps(upper, lower);
+
+  return _mm512_castps_si512(simd_clip_32(c, real_lower, real_upper));
+}
+
+//-------------------
+
+template<bool aligned>
+RG_FORCEINLINE __m512i rg_mode18_avx512(const Byte* pSrc, int srcPitch) {
+    LOAD_SQUARE_AVX512_UA(pSrc, srcPitch, aligned);
+
+    auto absdiff1 = abs_diff(c, a1);
+    auto absdiff2 = abs_diff(c, a2);
+    auto absdiff3 = abs_diff(c, a3);
+    auto absdiff4 = abs_diff(c, a4);
+    auto absdiff5 = abs_diff(c, a5);
+    auto absdiff6 = abs_diff(c, a6);
+    auto absdiff7 = abs_diff(c, a7);
+    auto absdiff8 = abs_diff(c, a8);
+
+    auto d1 = _mm512_max_epu8(absdiff1, absdiff8);
+    auto d2 = _mm512_max_epu8(absdiff2, absdiff7);
+    auto d3 = _mm512_max_epu8(absdiff3, absdiff6);
+    auto d4 = _mm512_max_epu8(absdiff4, absdiff5);
+
+    auto mindiff = _mm512_min_epu8(d1, d2);
+    mindiff = _mm512_min_epu8(mindiff, d3);
+    mindiff = _mm512_min_epu8(mindiff, d4);
+    
+    __m512i c1 = simd_clip(c, _mm512_min_epu8(a1, a8), _mm512_max_epu8(a1, a8));
+    __m512i c2 = simd_clip(c, _mm512_min_epu8(a2, a7), _mm512_max_epu8(a2, a7));
+    __m512i c3 = simd_clip(c, _mm512_min_epu8(a3, a6), _mm512_max_epu8(a3, a6));
+    __m512i c4 = simd_clip(c, _mm512_min_epu8(a4, a5), _mm512_max_epu8(a4, a5));
+    
+    auto result = select_on_equal(mindiff, d1, c, c1);
+    result = select_on_equal(mindiff, d3, result, c3);
+    result = select_on_equal(mindiff, d2, result, c2);
+    return select_on_equal(mindiff, d4, result, c4);
+}
+
+template<bool aligned>
+RG_FORCEINLINE __m512i rg_mode18_avx512_16(const Byte* pSrc, int srcPitch) {
+  LOAD_SQUARE_AVX512_16_UA(pSrc, srcPitch, aligned);
+
+  auto absdiff1 = abs_diff_16(c, a1);
+  auto absdiff2 = abs_diff_16(c, a2);
+  auto absdiff3 = abs_diff_16(c, a3);
+  auto absdiff4 = abs_diff_16(c, a4);
+  auto absdiff5 = abs_diff_16(c, a5);
+  auto absdiff6 = abs_diff_16(c, a6);
+  auto absdiff7 = abs_diff_16(c, a7);
+  auto absdiff8 = abs_diff_16(c, a8);
+
+  auto d1 = _mm512_max_epu16(absdiff1, absdiff8);
+  auto d2 = _mm512_max_epu16(absdiff2, absdiff7);
+  auto d3 = _mm512_max_epu16(absdiff3, absdiff6);
+  auto d4 = _mm512_max_epu16(absdiff4, absdiff5);
+
+  auto mindiff = _mm512_min_epu16(d1, d2);
+  mindiff = _mm512_min_epu16(mindiff, d3);
+  mindiff = _mm512_min_epu16(mindiff, d4);
+
+  __m512i c1 = simd_clip_16(c, _mm512_min_epu16(a1, a8), _mm512_max_epu16(a1, a8));
+  __m512i c2 = simd_clip_16(c, _mm512_min_epu16(a2, a7), _mm512_max_epu16(a2, a7));
+  __m512i c3 = simd_clip_16(c, _mm512_min_epu16(a3, a6), _mm512_max_epu16(a3, a6));
+  __m512i c4 = simd_clip_16(c, _mm512_min_epu16(a4, a5), _mm512_max_epu16(a4, a5));
+
+  auto result = select_on_equal_16(mindiff, d1, c, c1);
+  result = select_on_equal_16(mindiff, d3, result, c3);
+  result = select_on_equal_16(mindiff, d2, result, c2);
+  return select_on_equal_16(mindiff, d4, result, c4);
+}
+
+template<bool aligned>
+RG_FORCEINLINE __m512i rg_mode18_avx512_32(const Byte* pSrc, int srcPitch) {
+  LOAD_SQUARE_AVX512_32_UA(pSrc, srcPitch, aligned);
+
+  auto absdiff1 = abs_diff_32(c, a1);
+  auto absdiff2 = abs_diff_32(c, a2);
+  auto absdiff3 = abs_diff_32(c, a3);
+  auto absdiff4 = abs_diff_32(c, a4);
+  auto absdiff5 = abs_diff_32(c, a5);
+  auto absdiff6 = abs_diff_32(c, a6);
+  auto absdiff7 = abs_diff_32(c, a7);
+  auto absdiff8 = abs_diff_32(c, a8);
+
+  auto d1 = _mm512_max_ps(absdiff1, absdiff8);
+  auto d2 = _mm512_max_ps(absdiff2, absdiff7);
+  auto d3 = _mm512_max_ps(absdiff3, absdiff6);
+  auto d4 = _mm512_max_ps(absdiff4, absdiff5);
+
+  auto mindiff = _mm512_min_ps(d1, d2);
+  mindiff = _mm512_min_ps(mindiff, d3);
+  mindiff = _mm512_min_ps(mindiff, d4);
+
+  __m512 c1 = simd_clip_32(c, _mm512_min_ps(a1, a8), _mm512_max_ps(a1, a8));
+  __m512 c2 = simd_clip_32(c, _mm512_min_ps(a2, a7), _mm512_max_ps(a2, a7));
+  __m512 c3 = simd_clip_32(c, _mm512_min_ps(a3, a6), _mm512_max_ps(a3, a6));
+  __m512 c4 = simd_clip_32(c, _mm512_min_ps(a4, a5), _mm512_max_ps(a4, a5));
+
+  auto result = select_on_equal_32(mindiff, d1, c, c1);
+  result = select_on_equal_32(mindiff, d3, result, c3);
+  result = select_on_equal_32(mindiff, d2, result, c2);
+  return _mm512_castps_si512(select_on_equal_32(mindiff, d4, result, c4));
+}
+
+
+//-------------------
+
+template<bool aligned>
+RG_FORCEINLINE __m512i rg_mode19_avx512(const Byte* pSrc, int srcPitch) {
+    LOAD_SQUARE_AVX512_UA(pSrc, srcPitch, aligned);
+
+    auto a13    = _mm512_avg_epu8 (a1, a3);
+    auto a68    = _mm512_avg_epu8 (a6, a8);
+    auto a1368  = _mm512_avg_epu8 (a13, a68);
+    auto a1368b = _mm512_subs_epu8 (a1368, _mm512_set1_epi8(1));
+    auto a25    = _mm512_avg_epu8 (a2, a5);
+    auto a47    = _mm512_avg_epu8 (a4, a7);
+    auto a2457  = _mm512_avg_epu8 (a25, a47);
+    auto val    = _mm512_avg_epu8 (a1368b, a2457);
+
+    return val;
+}
+
+template<bool aligned>
+RG_FORCEINLINE __m512i rg_mode19_avx512_16(const Byte* pSrc, int srcPitch) {
+  LOAD_SQUARE_AVX512_16_UA(pSrc, srcPitch, aligned);
+
+  auto a13    = _mm512_avg_epu16 (a1, a3);
+  auto a68    = _mm512_avg_epu16 (a6, a8);
+  auto a1368  = _mm512_avg_epu16 (a13, a68);
+  auto a1368b = _mm512_subs_epu16 (a1368, _mm512_set1_epi8(1));
+  auto a25    = _mm512_avg_epu16 (a2, a5);
+  auto a47    = _mm512_avg_epu16 (a4, a7);
+  auto a2457  = _mm512_avg_epu16 (a25, a47);
+  auto val    = _mm512_avg_epu16 (a1368b, a2457);
+
+  return val;
+}
+
+
+//-------------------
+
+//todo: probably extract a function with 12 arguments?
+template<bool aligned>
+RG_FORCEINLINE __m512i rg_mode20_avx512(const Byte* pSrc, int srcPitch) {
+    LOAD_SQUARE_AVX512_UA(pSrc, srcPitch, aligned);
+
+    auto zero = _mm512_setzero_si512();
+    auto onenineth = _mm512_set1_epi16((unsigned short)(((1u << 16) + 4) / 9));
+    auto bias = _mm512_set1_epi16(4);
+
+    auto a1unpck_lo = _mm512_unpacklo_epi8(a1, zero);
+    auto a2unpck_lo = _mm512_unpacklo_epi8(a2, zero);
+    auto a3unpck_lo = _mm512_unpacklo_epi8(a3, zero);
+    auto a4unpck_lo = _mm512_unpacklo_epi8(a4, zero);
+    auto a5unpck_lo = _mm512_unpacklo_epi8(a5, zero);
+    auto a6unpck_lo = _mm512_unpacklo_epi8(a6, zero);
+    auto a7unpck_lo = _mm512_unpacklo_epi8(a7, zero);
+    auto a8unpck_lo = _mm512_unpacklo_epi8(a8, zero);
+    auto cunpck_lo  = _mm512_unpacklo_epi8(c, zero);
+
+    auto sum_t1 = _mm512_adds_epu16(a1unpck_lo, a2unpck_lo);
+    sum_t1 = _mm512_adds_epu16(sum_t1, a3unpck_lo);
+    sum_t1 = _mm512_adds_epu16(sum_t1, a4unpck_lo);
+
+    auto sum_t2 = _mm512_adds_epu16(a5unpck_lo, a6unpck_lo);
+    sum_t2 = _mm512_adds_epu16(sum_t2, a7unpck_lo);
+    sum_t2 = _mm512_adds_epu16(sum_t2, a8unpck_lo);
+
+    auto sum = _mm512_adds_epu16(sum_t1, sum_t2);
+    sum = _mm512_adds_epu16(sum, cunpck_lo);
+    sum = _mm512_adds_epu16(sum, bias);
+    
+    auto result_lo = _mm512_mulhi_epu16(sum, onenineth);
+    
+
+    auto a1unpck_hi = _mm512_unpackhi_epi8(a1, zero);
+    auto a2unpck_hi = _mm512_unpackhi_epi8(a2, zero);
+    auto a3unpck_hi = _mm512_unpackhi_epi8(a3, zero);
+    auto a4unpck_hi = _mm512_unpackhi_epi8(a4, zero);
+    auto a5unpck_hi = _mm512_unpackhi_epi8(a5, zero);
+    auto a6unpck_hi = _mm512_unpackhi_epi8(a6, zero);
+    auto a7unpck_hi = _mm512_unpackhi_epi8(a7, zero);
+    auto a8unpck_hi = _mm512_unpackhi_epi8(a8, zero);
+    auto cunpck_hi  = _mm512_unpackhi_epi8(c, zero);
+
+    sum_t1 = _mm512_adds_epu16(a1unpck_hi, a2unpck_hi);
+    sum_t1 = _mm512_adds_epu16(sum_t1, a3unpck_hi);
+    sum_t1 = _mm512_adds_epu16(sum_t1, a4unpck_hi);
+
+    sum_t2 = _mm512_adds_epu16(a5unpck_hi, a6unpck_hi);
+    sum_t2 = _mm512_adds_epu16(sum_t2, a7unpck_hi);
+    sum_t2 = _mm512_adds_epu16(sum_t2, a8unpck_hi);
+
+    sum = _mm512_adds_epu16(sum_t1, sum_t2);
+    sum = _mm512_adds_epu16(sum, cunpck_hi);
+    sum = _mm512_adds_epu16(sum, bias);
+
+    auto result_hi = _mm512_mulhi_epu16(sum, onenineth);
+    
+    return _mm512_packus_epi16(result_lo, result_hi);
+}
+
+template<bool aligned>
+RG_FORCEINLINE __m512i rg_mode20_avx512_16(const Byte* pSrc, int srcPitch) {
+  LOAD_SQUARE_AVX512_16_UA(pSrc, srcPitch, aligned);
+
+  //    int sum = a1 + a2 + a3 + a4 + c + a5 + a6 + a7 + a8;
+  //    int val = (sum + 4) / 9;
+
+  // trick, but there is no _mm512_mulhi_epi32
+  // x / 9 = x * 1/9 = [x * ( (1/9)<<32 )] >> 32 = Hi32_part_of_64bit_result(x * ((1 << 32)/9))
+  // instead: x less than 20 bits (9*65535), we have 15 bits to play, (1<<15)/9 < 4096 (12 bits)
+  // ((1<<14)+4) / 9) = 0x71C (1820)
+  // ((1<<15)+4) / 9) = 0xE39 (3641)
+  // worst case: 9*FFFF * 71C = 3FFBC004
+  // worst case: 9*FFFF * E39 = 8000B8E3 ( 8000B8E3 >> 15 = 10001, packus rounding to FFFF)
+  // Try with
+  // ((1<<15) / 9  + 4) = 0xE3C (3644)
+  const Byte FACTOR = 15;
+  auto zero = _mm512_setzero_si512();
+  auto onenineth = _mm512_set1_epi32(((1u << FACTOR) + 4) / 9);
+  auto bias = _mm512_set1_epi32(4);
+
+  auto a1unpck_lo = _mm512_unpacklo_epi16(a1, zero);
+  auto a2unpck_lo = _mm512_unpacklo_epi16(a2, zero);
+  auto a3unpck_lo = _mm512_unpacklo_epi16(a3, zero);
+  auto a4unpck_lo = _mm512_unpacklo_epi16(a4, zero);
+  auto a5unpck_lo = _mm512_unpacklo_epi16(a5, zero);
+  auto a6unpck_lo = _mm512_unpacklo_epi16(a6, zero);
+  auto a7unpck_lo = _mm512_unpacklo_epi16(a7, zero);
+  auto a8unpck_lo = _mm512_unpacklo_epi16(a8, zero);
+  auto cunpck_lo  = _mm512_unpacklo_epi16(c, zero);
+
+  // lower 4x uint16_t -> 128 bit 4x uint32_t
+  auto sum_t1 = _mm512_add_epi32(a1unpck_lo, a2unpck_lo);
+  sum_t1 = _mm512_add_epi32(sum_t1, a3unpck_lo);
+  sum_t1 = _mm512_add_epi32(sum_t1, a4unpck_lo);
+  
+  auto sum_t2 = _mm512_add_epi32(a5unpck_lo, a6unpck_lo);
+  sum_t2 = _mm512_add_epi32(sum_t2, a7unpck_lo);
+  sum_t2 = _mm512_add_epi32(sum_t2, a8unpck_lo);
+
+  auto sum = _mm512_add_epi32(sum_t1, sum_t2);
+  sum = _mm512_add_epi32(sum, cunpck_lo);
+  sum = _mm512_add_epi32(sum, bias);
+
+  auto result_lo = _mm512_srli_epi32(_mm512_mullo_epi32(sum, onenineth),FACTOR);
+  // we have sum of lower 4 pixels
+
+  auto a1unpck_hi = _mm512_unpackhi_epi16(a1, zero);
+  auto a2unpck_hi = _mm512_unpackhi_epi16(a2, zero);
+  auto a3unpck_hi = _mm512_unpackhi_epi16(a3, zero);
+  auto a4unpck_hi = _mm512_unpackhi_epi16(a4, zero);
+  auto a5unpck_hi = _mm512_unpackhi_epi16(a5, zero);
+  auto a6unpck_hi = _mm512_unpackhi_epi16(a6, zero);
+  auto a7unpck_hi = _mm512_unpackhi_epi16(a7, zero);
+  auto a8unpck_hi = _mm512_unpackhi_epi16(a8, zero);
+  auto cunpck_hi  = _mm512_unpackhi_epi16(c, zero);
+
+  sum_t1 = _mm512_add_epi32(a1unpck_hi, a2unpck_hi);
+  sum_t1 = _mm512_add_epi32(sum_t1, a3unpck_hi);
+  sum_t1 = _mm512_add_epi32(sum_t1, a4unpck_hi);
+  
+  sum_t2 = _mm512_add_epi32(a5unpck_hi, a6unpck_hi);
+  sum_t2 = _mm512_add_epi32(sum_t2, a7unpck_hi);
+  sum_t2 = _mm512_add_epi32(sum_t2, a8unpck_hi);
+
+  sum = _mm512_add_epi32(sum_t1, sum_t2);
+  sum = _mm512_add_epi32(sum, cunpck_hi);
+  sum = _mm512_add_epi32(sum, bias);
+
+  auto result_hi = _mm512_srli_epi32(_mm512_mullo_epi32(sum, onenineth),FACTOR);
+
+  return _mm512_packus_epi32(result_lo, result_hi);
+}
+
+
+//-------------------
+
+template<bool aligned>
+RG_FORCEINLINE __m512i rg_mode21_avx512(const Byte* pSrc, int srcPitch) {
+  /*
+  LOAD_SQUARE_AVX512_UA_18(pSrc, srcPitch, aligned);
+
+  auto l1a = not_rounded_average(a1, a8);
+  auto l1b = _mm512_avg_epu8(a1, a8);
+
+  LOAD_SQUARE_AVX512_UA_27(pSrc, srcPitch, aligned);
+  auto l2a = not_rounded_average(a2, a7);
+  auto l2b = _mm512_avg_epu8(a2, a7);
+
+  LOAD_SQUARE_AVX512_UA_36(pSrc, srcPitch, aligned);
+  auto l3a = not_rounded_average(a3, a6);
+  auto l3b = _mm512_avg_epu8(a3, a6);
+
+  LOAD_SQUARE_AVX512_UA_45(pSrc, srcPitch, aligned);
+  auto l4a = not_rounded_average(a4, a5);
+  auto l4b = _mm512_avg_epu8(a4, a5);
+
+  auto ma = _mm512_max_epu8(l1b, l2b);
+  ma = _mm512_max_epu8(ma, l3b);
+  ma = _mm512_max_epu8(ma, l4b);
+
+  auto mi = _mm512_min_epu8(l1a, l2a);
+  mi = _mm512_min_epu8(mi, l3a);
+  mi = _mm512_min_epu8(mi, l4a);
+
+  LOAD_SQUARE_AVX512_UA_Cent(pSrc, srcPitch, aligned);
+  return simd_clip(c, mi, ma);
+*/
+  
+    LOAD_SQUARE_AVX512_UA(pSrc, srcPitch, aligned);
+
+    auto l1a = not_rounded_average(a1, a8);
+    auto l2a = not_rounded_average(a2, a7);
+    auto l3a = not_rounded_average(a3, a6);
+    auto l4a = not_rounded_average(a4, a5);
+
+    auto l1b = _mm512_avg_epu8(a1, a8);
+    auto l2b = _mm512_avg_epu8(a2, a7);
+    auto l3b = _mm512_avg_epu8(a3, a6);
+    auto l4b = _mm512_avg_epu8(a4, a5);
+
+    auto ma = _mm512_max_epu8(l1b, l2b);
+    ma = _mm512_max_epu8(ma, l3b);
+    ma = _mm512_max_epu8(ma, l4b);
+
+    auto mi = _mm512_min_epu8(l1a, l2a);
+    mi = _mm512_min_epu8(mi, l3a);
+    mi = _mm512_min_epu8(mi, l4a);
+
+    return simd_clip(c, mi, ma);
+}
+
+template<bool aligned>
+RG_FORCEINLINE __m512i rg_mode21_avx512_16(const Byte* pSrc, int srcPitch) {
+  LOAD_SQUARE_AVX512_16_UA(pSrc, srcPitch, aligned);
+
+  auto l1a = not_rounded_average_16(a1, a8);
+  auto l2a = not_rounded_average_16(a2, a7);
+  auto l3a = not_rounded_average_16(a3, a6);
+  auto l4a = not_rounded_average_16(a4, a5);
+
+  auto l1b = _mm512_avg_epu16(a1, a8);
+  auto l2b = _mm512_avg_epu16(a2, a7);
+  auto l3b = _mm512_avg_epu16(a3, a6);
+  auto l4b = _mm512_avg_epu16(a4, a5);
+
+  auto ma = _mm512_max_epu16(l1b, l2b);
+  ma = _mm512_max_epu16(ma, l3b);
+  ma = _mm512_max_epu16(ma, l4b);
+
+  auto mi = _mm512_min_epu16(l1a, l2a);
+  mi = _mm512_min_epu16(mi, l3a);
+  mi = _mm512_min_epu16(mi, l4a);
+
+  return simd_clip_16(c, mi, ma);
+}
+
+  // float: no integer tricks, same like 22
+
+//-------------------
+
+template<bool aligned>
+RG_FORCEINLINE __m512i rg_mode22_avx512(const Byte* pSrc, int srcPitch) {
+    LOAD_SQUARE_AVX512_UA(pSrc, srcPitch, aligned);
+
+    auto l1 = _mm512_avg_epu8(a1, a8);
+    auto l2 = _mm512_avg_epu8(a2, a7);
+
+    auto ma = _mm512_max_epu8(l1, l2);
+    auto mi = _mm512_min_epu8(l1, l2);
+
+    auto l3 = _mm512_avg_epu8(a3, a6);
+    ma = _mm512_max_epu8(ma, l3);
+    mi = _mm512_min_epu8(mi, l3);
+
+    auto l4 = _mm512_avg_epu8(a4, a5);
+    ma = _mm512_max_epu8(ma, l4);
+    mi = _mm512_min_epu8(mi, l4);
+
+    return simd_clip(c, mi, ma);
+}
+
+template<bool aligned>
+RG_FORCEINLINE __m512i rg_mode22_avx512_16(const Byte* pSrc, int srcPitch) {
+  LOAD_SQUARE_AVX512_16_UA(pSrc, srcPitch, aligned);
+
+  auto l1 = _mm512_avg_epu16(a1, a8);
+  auto l2 = _mm512_avg_epu16(a2, a7);
+
+  auto ma = _mm512_max_epu16(l1, l2);
+  auto mi = _mm512_min_epu16(l1, l2);
+
+  auto l3 = _mm512_avg_epu16(a3, a6);
+  ma = _mm512_max_epu16(ma, l3);
+  mi = _mm512_min_epu16(mi, l3);
+
+  auto l4 = _mm512_avg_epu16(a4, a5);
+  ma = _mm512_max_epu16(ma, l4);
+  mi = _mm512_min_epu16(mi, l4);
+
+  return simd_clip_16(c, mi, ma);
+}
+
+
+
+//-------------------
+
+//optimized. 
+template<bool aligned>
+RG_FORCEINLINE __m512i rg_mode23_avx512(const Byte* pSrc, int srcPitch) {
+    LOAD_SQUARE_AVX512_UA(pSrc, srcPitch, aligned);
+
+    auto mal1 = _mm512_max_epu8(a1, a8);
+    auto mil1 = _mm512_min_epu8(a1, a8);
+
+    auto mal2 = _mm512_max_epu8(a2, a7);
+    auto mil2 = _mm512_min_epu8(a2, a7);
+
+    auto mal3 = _mm512_max_epu8(a3, a6);
+    auto mil3 = _mm512_min_epu8(a3, a6);
+
+    auto mal4 = _mm512_max_epu8(a4, a5);
+    auto mil4 = _mm512_min_epu8(a4, a5);
+
+    auto linediff1 = _mm512_subs_epu8(mal1, mil1);
+    auto linediff2 = _mm512_subs_epu8(mal2, mil2);
+    auto linediff3 = _mm512_subs_epu8(mal3, mil3);
+    auto linediff4 = _mm512_subs_epu8(mal4, mil4);
+
+    auto u1 = _mm512_min_epu8(_mm512_subs_epu8(c, mal1), linediff1);
+    auto u2 = _mm512_min_epu8(_mm512_subs_epu8(c, mal2), linediff2);
+    auto u3 = _mm512_min_epu8(_mm512_subs_epu8(c, mal3), linediff3);
+    auto u4 = _mm512_min_epu8(_mm512_subs_epu8(c, mal4), linediff4);
+
+    auto u = _mm512_max_epu8(u1, u2);
+    u = _mm512_max_epu8(u, u3);
+    u = _mm512_max_epu8(u, u4);
+
+    auto d1 = _mm512_min_epu8(_mm512_subs_epu8(mil1, c), linediff1);
+    auto d2 = _mm512_min_epu8(_mm512_subs_epu8(mil2, c), linediff2);
+    auto d3 = _mm512_min_epu8(_mm512_subs_epu8(mil3, c), linediff3);
+    auto d4 = _mm512_min_epu8(_mm512_subs_epu8(mil4, c), linediff4);
+
+    auto d = _mm512_max_epu8(d1, d2);
+    d = _mm512_max_epu8(d, d3);
+    d = _mm512_max_epu8(d, d4);
+
+    return _mm512_adds_epu8(_mm512_subs_epu8(c, u), d);
+}
+
+template<bool aligned>
+RG_FORCEINLINE __m512i rg_mode23_avx512_16(const Byte* pSrc, int srcPitch) {
+  LOAD_SQUARE_AVX512_16_UA(pSrc, srcPitch, aligned);
+
+  auto mal1 = _mm512_max_epu16(a1, a8);
+  auto mil1 = _mm512_min_epu16(a1, a8);
+
+  auto mal2 = _mm512_max_epu16(a2, a7);
+  auto mil2 = _mm512_min_epu16(a2, a7);
+
+  auto mal3 = _mm512_max_epu16(a3, a6);
+  auto mil3 = _mm512_min_epu16(a3, a6);
+
+  auto mal4 = _mm512_max_epu16(a4, a5);
+  auto mil4 = _mm512_min_epu16(a4, a5);
+
+  auto linediff1 = _mm512_subs_epu16(mal1, mil1);
+  auto linediff2 = _mm512_subs_epu16(mal2, mil2);
+  auto linediff3 = _mm512_subs_epu16(mal3, mil3);
+  auto linediff4 = _mm512_subs_epu16(mal4, mil4);
+
+  auto u1 = _mm512_min_epu16(_mm512_subs_epu16(c, mal1), linediff1);
+  auto u2 = _mm512_min_epu16(_mm512_subs_epu16(c, mal2), linediff2);
+  auto u3 = _mm512_min_epu16(_mm512_subs_epu16(c, mal3), linediff3);
+  auto u4 = _mm512_min_epu16(_mm512_subs_epu16(c, mal4), linediff4);
+
+  auto u = _mm512_max_epu16(u1, u2);
+  u = _mm512_max_epu16(u, u3);
+  u = _mm512_max_epu16(u, u4);
+
+  auto d1 = _mm512_min_epu16(_mm512_subs_epu16(mil1, c), linediff1);
+  auto d2 = _mm512_min_epu16(_mm512_subs_epu16(mil2, c), linediff2);
+  auto d3 = _mm512_min_epu16(_mm512_subs_epu16(mil3, c), linediff3);
+  auto d4 = _mm512_min_epu16(_mm512_subs_epu16(mil4, c), linediff4);
+
+  auto d = _mm512_max_epu16(d1, d2);
+  d = _mm512_max_epu16(d, d3);
+  d = _mm512_max_epu16(d, d4);
+
+  return _mm512_adds_epu16(_mm512_subs_epu16(c, u), d);
+}
+
+template<bool aligned>
+RG_FORCEINLINE __m512i rg_mode23_avx512_32(const Byte* pSrc, int srcPitch) {
+  LOAD_SQUARE_AVX512_32_UA(pSrc, srcPitch, aligned);
+
+  auto mal1 = _mm512_max_ps(a1, a8);
+  auto mil1 = _mm512_min_ps(a1, a8);
+
+  auto mal2 = _mm512_max_ps(a2, a7);
+  auto mil2 = _mm512_min_ps(a2, a7);
+
+  auto mal3 = _mm512_max_ps(a3, a6);
+  auto mil3 = _mm512_min_ps(a3, a6);
+
+  auto mal4 = _mm512_max_ps(a4, a5);
+  auto mil4 = _mm512_min_ps(a4, a5);
+
+  auto linediff1 = _mm512_subs_ps(mal1, mil1);
+  auto linediff2 = _mm512_subs_ps(mal2, mil2);
+  auto linediff3 = _mm512_subs_ps(mal3, mil3);
+  auto linediff4 = _mm512_subs_ps(mal4, mil4);
+
+  auto u1 = _mm512_min_ps(_mm512_subs_ps(c, mal1), linediff1);
+  auto u2 = _mm512_min_ps(_mm512_subs_ps(c, mal2), linediff2);
+  auto u3 = _mm512_min_ps(_mm512_subs_ps(c, mal3), linediff3);
+  auto u4 = _mm512_min_ps(_mm512_subs_ps(c, mal4), linediff4);
+
+  auto u = _mm512_max_ps(u1, u2);
+  u = _mm512_max_ps(u, u3);
+  u = _mm512_max_ps(u, u4);
+
+  auto d1 = _mm512_min_ps(_mm512_subs_ps(mil1, c), linediff1);
+  auto d2 = _mm512_min_ps(_mm512_subs_ps(mil2, c), linediff2);
+  auto d3 = _mm512_min_ps(_mm512_subs_ps(mil3, c), linediff3);
+  auto d4 = _mm512_min_ps(_mm512_subs_ps(mil4, c), linediff4);
+
+  auto d = _mm512_max_ps(d1, d2);
+  d = _mm512_max_ps(d, d3);
+  d = _mm512_max_ps(d, d4);
+
+  return _mm512_castps_si512(_mm512_adds_ps(_mm512_subs_ps(c, u), d));
+}
+
+
+//-------------------
+
+//optimized, todo: decide how to name the function and extract this stuff. Order is important.
+template<bool aligned>
+RG_FORCEINLINE __m512i rg_mode24_avx512(const Byte* pSrc, int srcPitch) {
+    LOAD_SQUARE_AVX512_UA(pSrc, srcPitch, aligned);
+
+    auto mal  = _mm512_max_epu8(a1, a8);
+    auto mil  = _mm512_min_epu8(a1, a8);
+    auto diff = _mm512_subs_epu8(mal, mil);
+    auto temp = _mm512_subs_epu8(c, mal);
+    auto u1   = _mm512_min_epu8(temp, _mm512_subs_epu8(diff, temp));
+    temp      = _mm512_subs_epu8(mil, c);
+    auto d1   = _mm512_min_epu8(temp, _mm512_subs_epu8(diff, temp));
+
+    mal       = _mm512_max_epu8(a2, a7);
+    mil       = _mm512_min_epu8(a2, a7);
+    diff      = _mm512_subs_epu8(mal, mil);
+    temp      = _mm512_subs_epu8(c, mal);
+    auto u2   = _mm512_min_epu8(temp, _mm512_subs_epu8(diff, temp));
+    temp      = _mm512_subs_epu8(mil, c);
+    auto d2   = _mm512_min_epu8(temp, _mm512_subs_epu8(diff, temp));
+
+    auto d = _mm512_max_epu8(d1, d2);
+    auto u = _mm512_max_epu8(u1, u2);
+
+    mal       = _mm512_max_epu8(a3, a6);
+    mil       = _mm512_min_epu8(a3, a6);
+    diff      = _mm512_subs_epu8(mal, mil);
+    temp      = _mm512_subs_epu8(c, mal);
+    auto u3   = _mm512_min_epu8(temp, _mm512_subs_epu8(diff, temp));
+    temp      = _mm512_subs_epu8(mil, c);
+    auto d3   = _mm512_min_epu8(temp, _mm512_subs_epu8(diff, temp));
+
+    d = _mm512_max_epu8(d, d3);
+    u = _mm512_max_epu8(u, u3);
+
+    mal       = _mm512_max_epu8(a4, a5);
+    mil       = _mm512_min_epu8(a4, a5);
+    diff      = _mm512_subs_epu8(mal, mil);
+    temp      = _mm512_subs_epu8(c, mal);
+    auto u4   = _mm512_min_epu8(temp, _mm512_subs_epu8(diff, temp));
+    temp      = _mm512_subs_epu8(mil, c);
+    auto d4   = _mm512_min_epu8(temp, _mm512_subs_epu8(diff, temp));
+
+    d = _mm512_max_epu8(d, d4);
+    u = _mm512_max_epu8(u, u4);
+
+    return _mm512_adds_epu8(_mm512_subs_epu8(c, u), d);
+}
+
+template<bool aligned>
+RG_FORCEINLINE __m512i rg_mode24_avx512_16(const Byte* pSrc, int srcPitch) {
+  LOAD_SQUARE_AVX512_16_UA(pSrc, srcPitch, aligned);
+
+  auto mal  = _mm512_max_epu16(a1, a8);
+  auto mil  = _mm512_min_epu16(a1, a8);
+  auto diff = _mm512_subs_epu16(mal, mil);
+  auto temp = _mm512_subs_epu16(c, mal);
+  auto u1   = _mm512_min_epu16(temp, _mm512_subs_epu16(diff, temp));
+  temp      = _mm512_subs_epu16(mil, c);
+  auto d1   = _mm512_min_epu16(temp, _mm512_subs_epu16(diff, temp));
+
+  mal       = _mm512_max_epu16(a2, a7);
+  mil       = _mm512_min_epu16(a2, a7);
+  diff      = _mm512_subs_epu16(mal, mil);
+  temp      = _mm512_subs_epu16(c, mal);
+  auto u2   = _mm512_min_epu16(temp, _mm512_subs_epu16(diff, temp));
+  temp      = _mm512_subs_epu16(mil, c);
+  auto d2   = _mm512_min_epu16(temp, _mm512_subs_epu16(diff, temp));
+
+  auto d = _mm512_max_epu16(d1, d2);
+  auto u = _mm512_max_epu16(u1, u2);
+
+  mal       = _mm512_max_epu16(a3, a6);
+  mil       = _mm512_min_epu16(a3, a6);
+  diff      = _mm512_subs_epu16(mal, mil);
+  temp      = _mm512_subs_epu16(c, mal);
+  auto u3   = _mm512_min_epu16(temp, _mm512_subs_epu16(diff, temp));
+  temp      = _mm512_subs_epu16(mil, c);
+  auto d3   = _mm512_min_epu16(temp, _mm512_subs_epu16(diff, temp));
+
+  d = _mm512_max_epu16(d, d3);
+  u = _mm512_max_epu16(u, u3);
+
+  mal       = _mm512_max_epu16(a4, a5);
+  mil       = _mm512_min_epu16(a4, a5);
+  diff      = _mm512_subs_epu16(mal, mil);
+  temp      = _mm512_subs_epu16(c, mal);
+  auto u4   = _mm512_min_epu16(temp, _mm512_subs_epu16(diff, temp));
+  temp      = _mm512_subs_epu16(mil, c);
+  auto d4   = _mm512_min_epu16(temp, _mm512_subs_epu16(diff, temp));
+
+  d = _mm512_max_epu16(d, d4);
+  u = _mm512_max_epu16(u, u4);
+
+  return _mm512_adds_epu16(_mm512_subs_epu16(c, u), d);
+}
+
+template<bool aligned>
+RG_FORCEINLINE __m512i rg_mode24_avx512_32(const Byte* pSrc, int srcPitch) {
+  LOAD_SQUARE_AVX512_32_UA(pSrc, srcPitch, aligned);
+
+  auto mal  = _mm512_max_ps(a1, a8);
+  auto mil  = _mm512_min_ps(a1, a8);
+  auto diff = _mm512_subs_ps(mal, mil);
+  auto temp = _mm512_subs_ps(c, mal);
+  auto u1   = _mm512_min_ps(temp, _mm512_subs_ps(diff, temp));
+  temp      = _mm512_subs_ps(mil, c);
+  auto d1   = _mm512_min_ps(temp, _mm512_subs_ps(diff, temp));
+
+  mal       = _mm512_max_ps(a2, a7);
+  mil       = _mm512_min_ps(a2, a7);
+  diff      = _mm512_subs_ps(mal, mil);
+  temp      = _mm512_subs_ps(c, mal);
+  auto u2   = _mm512_min_ps(temp, _mm512_subs_ps(diff, temp));
+  temp      = _mm512_subs_ps(mil, c);
+  auto d2   = _mm512_min_ps(temp, _mm512_subs_ps(diff, temp));
+
+  auto d = _mm512_max_ps(d1, d2);
+  auto u = _mm512_max_ps(u1, u2);
+
+  mal       = _mm512_max_ps(a3, a6);
+  mil       = _mm512_min_ps(a3, a6);
+  diff      = _mm512_subs_ps(mal, mil);
+  temp      = _mm512_subs_ps(c, mal);
+  auto u3   = _mm512_min_ps(temp, _mm512_subs_ps(diff, temp));
+  temp      = _mm512_subs_ps(mil, c);
+  auto d3   = _mm512_min_ps(temp, _mm512_subs_ps(diff, temp));
+
+  d = _mm512_max_ps(d, d3);
+  u = _mm512_max_ps(u, u3);
+
+  mal       = _mm512_max_ps(a4, a5);
+  mil       = _mm512_min_ps(a4, a5);
+  diff      = _mm512_subs_ps(mal, mil);
+  temp      = _mm512_subs_ps(c, mal);
+  auto u4   = _mm512_min_ps(temp, _mm512_subs_ps(diff, temp));
+  temp      = _mm512_subs_ps(mil, c);
+  auto d4   = _mm512_min_ps(temp, _mm512_subs_ps(diff, temp));
+
+  d = _mm512_max_ps(d, d4);
+  u = _mm512_max_ps(u, u4);
+
+  return _mm512_castps_si512(_mm512_adds_ps(_mm512_subs_ps(c, u), d));
+}
+
+//-------------------
+
+// float modes with FMA, same as rg_functions_fma.h (FMA is part of AVX-512F)
+
+template<bool aligned>
+RG_FORCEINLINE __m512i rg_mode6_avx512_32(const Byte* pSrc, int srcPitch) {
+  LOAD_SQUARE_AVX512_32_UA(pSrc, srcPitch, aligned);
+
+  auto mal1 = _mm512_max_ps(a1, a8);
+  auto mil1 = _mm512_min_ps(a1, a8);
+
+  auto mal2 = _mm512_max_ps(a2, a7);
+  auto mil2 = _mm512_min_ps(a2, a7);
+
+  auto mal3 = _mm512_max_ps(a3, a6);
+  auto mil3 = _mm512_min_ps(a3, a6);
+
+  auto mal4 = _mm512_max_ps(a4, a5);
+  auto mil4 = _mm512_min_ps(a4, a5);
+
+  auto clipped1 = simd_clip_32(c, mil1, mal1);
+  auto clipped2 = simd_clip_32(c, mil2, mal2);
+  auto clipped3 = simd_clip_32(c, mil3, mal3);
+  auto clipped4 = simd_clip_32(c, mil4, mal4);
+
+  auto c1 = fma_twice_plus_32(abs_diff_32(c, clipped1), _mm512_sub_ps(mal1, mil1));
+  auto c2 = fma_twice_plus_32(abs_diff_32(c, clipped2), _mm512_sub_ps(mal2, mil2));
+  auto c3 = fma_twice_plus_32(abs_diff_32(c, clipped3), _mm512_sub_ps(mal3, mil3));
+  auto c4 = fma_twice_plus_32(abs_diff_32(c, clipped4), _mm512_sub_ps(mal4, mil4));
+
+  auto mindiff = _mm512_min_ps(_mm512_min_ps(c1, c2), _mm512_min_ps(c3, c4));
+
+  auto result = select_on_equal_32(mindiff, c1, c, clipped1);
+  result = select_on_equal_32(mindiff, c3, result, clipped3);
+  result = select_on_equal_32(mindiff, c2, result, clipped2);
+  return _mm512_castps_si512(select_on_equal_32(mindiff, c4, result, clipped4));
+}
+
+template<bool aligned>
+RG_FORCEINLINE __m512i rg_mode8_avx512_32(const Byte* pSrc, int srcPitch) {
+  LOAD_SQUARE_AVX512_32_UA(pSrc, srcPitch, aligned);
+
+  auto mal1 = _mm512_max_ps(a1, a8);
+  auto mil1 = _mm512_min_ps(a1, a8);
+
+  auto mal2 = _mm512_max_ps(a2, a7);
+  auto mil2 = _mm512_min_ps(a2, a7);
+
+  auto mal3 = _mm512_max_ps(a3, a6);
+  auto mil3 = _mm512_min_ps(a3, a6);
+
+  auto mal4 = _mm512_max_ps(a4, a5);
+  auto mil4 = _mm512_min_ps(a4, a5);
+
+  auto clipped1 = simd_clip_32(c, mil1, mal1);
+  auto clipped2 = simd_clip_32(c, mil2, mal2);
+  auto clipped3 = simd_clip_32(c, mil3, mal3);
+  auto clipped4 = simd_clip_32(c, mil4, mal4);
+
+  auto c1 = fma_twice_plus_32(_mm512_sub_ps(mal1, mil1), abs_diff_32(c, clipped1));
+  auto c2 = fma_twice_plus_32(_mm512_sub_ps(mal2, mil2), abs_diff_32(c, clipped2));
+  auto c3 = fma_twice_plus_32(_mm512_sub_ps(mal3, mil3), abs_diff_32(c, clipped3));
+  auto c4 = fma_twice_plus_32(_mm512_sub_ps(mal4, mil4), abs_diff_32(c, clipped4));
+
+  auto mindiff = _mm512_min_ps(_mm512_min_ps(c1, c2), _mm512_min_ps(c3, c4));
+
+  auto result = select_on_equal_32(mindiff, c1, c, clipped1);
+  result = select_on_equal_32(mindiff, c3, result, clipped3);
+  result = select_on_equal_32(mindiff, c2, result, clipped2);
+  return _mm512_castps_si512(select_on_equal_32(mindiff, c4, result, clipped4));
+}
+
+//-------------------
+
+// (4*c + 2*(a2 + a4 + a5 + a7) + a1 + a3 + a6 + a8) / 16, same as the C version
+template<bool aligned>
+RG_FORCEINLINE __m512i rg_mode11_and12_avx512_32(const Byte* pSrc, int srcPitch) {
+  LOAD_SQUARE_AVX512_32_UA(pSrc, srcPitch, aligned);
+
+  auto corners = _mm512_add_ps(_mm512_add_ps(a1, a3), _mm512_add_ps(a6, a8));
+  auto edges = _mm512_add_ps(_mm512_add_ps(a2, a4), _mm512_add_ps(a5, a7));
+
+  auto val = _mm512_mul_ps(corners, _mm512_set1_ps(1.0f / 16));
+  val = _mm512_fmadd_ps(edges, _mm512_set1_ps(1.0f / 8), val);
+  val = _mm512_fmadd_ps(c, _mm512_set1_ps(1.0f / 4), val);
+  return _mm512_castps_si512(val);
+}
+
+//-------------------
+
+// interpolation (a1 + 2*a2 + a3 + a6 + 2*a7 + a8) / 8, clipped to the pair with the smallest difference
+template<bool aligned>
+RG_FORCEINLINE __m512i rg_mode15_and16_avx512_32(const Byte* pSrc, int srcPitch) {
+  LOAD_SQUARE_AVX512_32_UA(pSrc, srcPitch, aligned);
+
+  auto max18 = _mm512_max_ps(a1, a8);
+  auto min18 = _mm512_min_ps(a1, a8);
+
+  auto max27 = _mm512_max_ps(a2, a7);
+  auto min27 = _mm512_min_ps(a2, a7);
+
+  auto max36 = _mm512_max_ps(a3, a6);
+  auto min36 = _mm512_min_ps(a3, a6);
+
+  auto d1 = _mm512_sub_ps(max18, min18);
+  auto d2 = _mm512_sub_ps(max27, min27);
+  auto d3 = _mm512_sub_ps(max36, min36);
+
+  auto mindiff = _mm512_min_ps(_mm512_min_ps(d1, d2), d3);
+
+  auto outer = _mm512_add_ps(_mm512_add_ps(a1, a3), _mm512_add_ps(a6, a8));
+  auto avg = _mm512_mul_ps(outer, _mm512_set1_ps(1.0f / 8));
+  avg = _mm512_fmadd_ps(_mm512_add_ps(a2, a7), _mm512_set1_ps(1.0f / 4), avg);
+
+  auto result = select_on_equal_32(mindiff, d1, c, simd_clip_32(avg, min18, max18));
+  result = select_on_equal_32(mindiff, d3, result, simd_clip_32(avg, min36, max36));
+  return _mm512_castps_si512(select_on_equal_32(mindiff, d2, result, simd_clip_32(avg, min27, max27)));
+}
+
+//-------------------
+
+// mean of the 8 neighbours
+template<bool aligned>
+RG_FORCEINLINE __m512i rg_mode19_avx512_32(const Byte* pSrc, int srcPitch) {
+  LOAD_SQUARE_AVX512_32_UA(pSrc, srcPitch, aligned);
+
+  const auto eighth = _mm512_set1_ps(1.0f / 8);
+  auto corners = _mm512_add_ps(_mm512_add_ps(a1, a3), _mm512_add_ps(a6, a8));
+  auto edges = _mm512_add_ps(_mm512_add_ps(a2, a4), _mm512_add_ps(a5, a7));
+
+  return _mm512_castps_si512(_mm512_fmadd_ps(corners, eighth, _mm512_mul_ps(edges, eighth)));
+}
+
+// mean of the 3x3 square
+template<bool aligned>
+RG_FORCEINLINE __m512i rg_mode20_avx512_32(const Byte* pSrc, int srcPitch) {
+  LOAD_SQUARE_AVX512_32_UA(pSrc, srcPitch, aligned);
+
+  const auto ninth = _mm512_set1_ps(1.0f / 9);
+  auto corners = _mm512_add_ps(_mm512_add_ps(a1, a3), _mm512_add_ps(a6, a8));
+  auto edges = _mm512_add_ps(_mm512_add_ps(a2, a4), _mm512_add_ps(a5, a7));
+
+  return _mm512_castps_si512(_mm512_fmadd_ps(_mm512_add_ps(corners, edges), ninth, _mm512_mul_ps(c, ninth)));
+}
+
+//-------------------
+
+// float: mode 21 is the same as 22. min/max of (a + b) / 2 are the halved min/max of the sums
+template<bool aligned>
+RG_FORCEINLINE __m512i rg_mode21_and22_avx512_32(const Byte* pSrc, int srcPitch) {
+  LOAD_SQUARE_AVX512_32_UA(pSrc, srcPitch, aligned);
+
+  auto l1 = _mm512_add_ps(a1, a8);
+  auto l2 = _mm512_add_ps(a2, a7);
+  auto l3 = _mm512_add_ps(a3, a6);
+  auto l4 = _mm512_add_ps(a4, a5);
+
+  const auto half = _mm512_set1_ps(0.5f);
+  auto ma = _mm512_mul_ps(_mm512_max_ps(_mm512_max_ps(l1, l2), _mm512_max_ps(l3, l4)), half);
+  auto mi = _mm512_mul_ps(_mm512_min_ps(_mm512_min_ps(l1, l2), _mm512_min_ps(l3, l4)), half);
+
+  return _mm512_castps_si512(simd_clip_32(c, mi, ma));
+}
+
+#endif
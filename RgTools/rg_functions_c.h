@@ -2,7 +2,6 @@
 #define __RG_FUNCTIONS_C_H__
 
 #include "common.h"
-#include <xutility>
 #include <algorithm>  
 #include <utility>
 
@@ -62,7 +61,7 @@ RG_FORCEINLINE Byte rg_mode2_cpp(const Byte* pSrc, int srcPitch) {
 
   Byte a [8] = { a1, a2, a3, a4, a5, a6, a7, a8 };
 
-  std::sort(&a [0], (&a [7]) + 1);
+  sort8_c(a);
 
   return clip(c, a [2-1], a [7-1]);
 }
@@ -72,7 +71,7 @@ RG_FORCEINLINE uint16_t rg_mode2_cpp_16(const Byte* pSrc, int srcPitch) {
 
     uint16_t a [8] = { a1, a2, a3, a4, a5, a6, a7, a8 };
 
-    std::sort(&a [0], (&a [7]) + 1);
+    sort8_c(a);
 
     return clip_16(c, a [2-1], a [7-1]);
 }
@@ -82,7 +81,7 @@ RG_FORCEINLINE float rg_mode2_cpp_32(const Byte* pSrc, int srcPitch) {
 
   float a [8] = { a1, a2, a3, a4, a5, a6, a7, a8 };
 
-  std::sort(&a [0], (&a [7]) + 1);
+  sort8_c(a);
 
   return clip_32(c, a [2-1], a [7-1]);
 }
@@ -94,7 +93,7 @@ RG_FORCEINLINE Byte rg_mode3_cpp(const Byte* pSrc, int srcPitch) {
 
     Byte	a [8] = { a1, a2, a3, a4, a5, a6, a7, a8 };
 
-    std::sort (&a [0], (&a [7]) + 1);
+    sort8_c(a);
 
     return clip(c, a [3-1], a [6-1]);
 }
@@ -104,7 +103,7 @@ RG_FORCEINLINE uint16_t rg_mode3_cpp_16(const Byte* pSrc, int srcPitch) {
 
   uint16_t	a [8] = { a1, a2, a3, a4, a5, a6, a7, a8 };
 
-  std::sort (&a [0], (&a [7]) + 1);
+  sort8_c(a);
 
   return clip_16(c, a [3-1], a [6-1]);
 }
@@ -114,7 +113,7 @@ RG_FORCEINLINE float rg_mode3_cpp_32(const Byte* pSrc, int srcPitch) {
 
   float	a [8] = { a1, a2, a3, a4, a5, a6, a7, a8 };
 
-  std::sort (&a [0], (&a [7]) + 1);
+  sort8_c(a);
 
   return clip_32(c, a [3-1], a [6-1]);
 }
@@ -126,7 +125,7 @@ RG_FORCEINLINE Byte rg_mode4_cpp(const Byte* pSrc, int srcPitch) {
 
     Byte	a [8] = { a1, a2, a3, a4, a5, a6, a7, a8 };
 
-    std::sort (&a [0], (&a [7]) + 1);
+    sort8_c(a);
 
     return clip(c, a [4-1], a [5-1]);
 }
@@ -136,7 +135,7 @@ RG_FORCEINLINE uint16_t rg_mode4_cpp_16(const Byte* pSrc, int srcPitch) {
 
   uint16_t	a [8] = { a1, a2, a3, a4, a5, a6, a7, a8 };
 
-  std::sort (&a [0], (&a [7]) + 1);
+  sort8_c(a);
 
   return clip_16(c, a [4-1], a [5-1]);
 }
@@ -146,7 +145,7 @@ RG_FORCEINLINE float rg_mode4_cpp_32(const Byte* pSrc, int srcPitch) {
 
   float	a [8] = { a1, a2, a3, a4, a5, a6, a7, a8 };
 
-  std::sort (&a [0], (&a [7]) + 1);
+  sort8_c(a);
 
   return clip_32(c, a [4-1], a [5-1]);
 }
@@ -175,10 +174,11 @@ RG_FORCEINLINE Byte rg_mode5_cpp(const Byte* pSrc, int srcPitch) {
 
     auto mindiff = std::min(std::min(std::min(c1, c2), c3), c4);
 
-    if (mindiff == c4) return clip(c, mil4, mal4);
-    if (mindiff == c2) return clip(c, mil2, mal2);
-    if (mindiff == c3) return clip(c, mil3, mal3);
-    return clip(c, mil1, mal1);
+    auto result = clip(c, mil1, mal1);
+    result = mindiff == c3 ? clip(c, mil3, mal3) : result;
+    result = mindiff == c2 ? clip(c, mil2, mal2) : result;
+    result = mindiff == c4 ? clip(c, mil4, mal4) : result;
+    return result;
 }
 
 RG_FORCEINLINE uint16_t rg_mode5_cpp_16(const Byte* pSrc, int srcPitch) {
@@ -203,10 +203,11 @@ RG_FORCEINLINE uint16_t rg_mode5_cpp_16(const Byte* pSrc, int srcPitch) {
 
   auto mindiff = std::min(std::min(std::min(c1, c2), c3), c4);
 
-  if (mindiff == c4) return clip_16(c, mil4, mal4);
-  if (mindiff == c2) return clip_16(c, mil2, mal2);
-  if (mindiff == c3) return clip_16(c, mil3, mal3);
-  return clip_16(c, mil1, mal1);
+  auto result = clip_16(c, mil1, mal1);
+  result = mindiff == c3 ? clip_16(c, mil3, mal3) : result;
+  result = mindiff == c2 ? clip_16(c, mil2, mal2) : result;
+  result = mindiff == c4 ? clip_16(c, mil4, mal4) : result;
+  return result;
 }
 
 RG_FORCEINLINE float rg_mode5_cpp_32(const Byte* pSrc, int srcPitch) {
@@ -231,10 +232,11 @@ RG_FORCEINLINE float rg_mode5_cpp_32(const Byte* pSrc, int srcPitch) {
 
   auto mindiff = std::min(std::min(std::min(c1, c2), c3), c4);
 
-  if (mindiff == c4) return clip_32(c, mil4, mal4);
-  if (mindiff == c2) return clip_32(c, mil2, mal2);
-  if (mindiff == c3) return clip_32(c, mil3, mal3);
-  return clip_32(c, mil1, mal1);
+  auto result = clip_32(c, mil1, mal1);
+  result = mindiff == c3 ? clip_32(c, mil3, mal3) : result;
+  result = mindiff == c2 ? clip_32(c, mil2, mal2) : result;
+  result = mindiff == c4 ? clip_32(c, mil4, mal4) : result;
+  return result;
 }
 
 // ------------
@@ -271,10 +273,11 @@ RG_FORCEINLINE Byte rg_mode6_cpp(const Byte* pSrc, int srcPitch) {
 
   int mindiff = std::min(std::min(std::min(c1, c2), c3), c4);
 
-  if (mindiff == c4) return clip(c, mil4, mal4);
-  if (mindiff == c2) return clip(c, mil2, mal2);
-  if (mindiff == c3) return clip(c, mil3, mal3);
-  return clip(c, mil1, mal1);
+  auto result = clip(c, mil1, mal1);
+  result = mindiff == c3 ? clip(c, mil3, mal3) : result;
+  result = mindiff == c2 ? clip(c, mil2, mal2) : result;
+  result = mindiff == c4 ? clip(c, mil4, mal4) : result;
+  return result;
 }
 
 template<int bits_per_pixel>
@@ -312,10 +315,11 @@ RG_FORCEINLINE uint16_t rg_mode6_cpp_16(const Byte* pSrc, int srcPitch) {
 
     int mindiff = std::min(std::min(std::min(c1, c2), c3), c4);
 
-    if (mindiff == c4) return clip_16(c, mil4, mal4);
-    if (mindiff == c2) return clip_16(c, mil2, mal2);
-    if (mindiff == c3) return clip_16(c, mil3, mal3);
-    return clip_16(c, mil1, mal1);
+    auto result = clip_16(c, mil1, mal1);
+    result = mindiff == c3 ? clip_16(c, mil3, mal3) : result;
+    result = mindiff == c2 ? clip_16(c, mil2, mal2) : result;
+    result = mindiff == c4 ? clip_16(c, mil4, mal4) : result;
+    return result;
 }
 
 //template<bool chroma>
@@ -367,10 +371,11 @@ RG_FORCEINLINE float rg_mode6_cpp_32(const Byte* pSrc, int srcPitch) {
 
   float mindiff = std::min(std::min(std::min(c1, c2), c3), c4);
 
-  if (mindiff == c4) return clip_32(c, mil4, mal4);
-  if (mindiff == c2) return clip_32(c, mil2, mal2);
-  if (mindiff == c3) return clip_32(c, mil3, mal3);
-  return clip_32(c, mil1, mal1);
+  auto result = clip_32(c, mil1, mal1);
+  result = mindiff == c3 ? clip_32(c, mil3, mal3) : result;
+  result = mindiff == c2 ? clip_32(c, mil2, mal2) : result;
+  result = mindiff == c4 ? clip_32(c, mil4, mal4) : result;
+  return result;
 }
 
 
@@ -408,10 +413,11 @@ RG_FORCEINLINE Byte rg_mode7_cpp(const Byte* pSrc, int srcPitch) {
 
     auto mindiff = std::min(std::min(std::min(c1, c2), c3), c4);
 
-    if (mindiff == c4) return clipped4;
-    if (mindiff == c2) return clipped2;
-    if (mindiff == c3) return clipped3;
-    return clipped1;
+    auto result = clipped1;
+    result = mindiff == c3 ? clipped3 : result;
+    result = mindiff == c2 ? clipped2 : result;
+    result = mindiff == c4 ? clipped4 : result;
+    return result;
 }
 
 RG_FORCEINLINE uint16_t rg_mode7_cpp_16(const Byte* pSrc, int srcPitch) {
@@ -446,10 +452,11 @@ RG_FORCEINLINE uint16_t rg_mode7_cpp_16(const Byte* pSrc, int srcPitch) {
 
   auto mindiff = std::min(std::min(std::min(c1, c2), c3), c4);
 
-  if (mindiff == c4) return clipped4;
-  if (mindiff == c2) return clipped2;
-  if (mindiff == c3) return clipped3;
-  return clipped1;
+  auto result = clipped1;
+  result = mindiff == c3 ? clipped3 : result;
+  result = mindiff == c2 ? clipped2 : result;
+  result = mindiff == c4 ? clipped4 : result;
+  return result;
 }
 
 RG_FORCEINLINE float rg_mode7_cpp_32(const Byte* pSrc, int srcPitch) {
@@ -484,10 +491,11 @@ RG_FORCEINLINE float rg_mode7_cpp_32(const Byte* pSrc, int srcPitch) {
 
   auto mindiff = std::min(std::min(std::min(c1, c2), c3), c4);
 
-  if (mindiff == c4) return clipped4;
-  if (mindiff == c2) return clipped2;
-  if (mindiff == c3) return clipped3;
-  return clipped1;
+  auto result = clipped1;
+  result = mindiff == c3 ? clipped3 : result;
+  result = mindiff == c2 ? clipped2 : result;
+  result = mindiff == c4 ? clipped4 : result;
+  return result;
 }
 
 // ------------
@@ -524,10 +532,11 @@ RG_FORCEINLINE Byte rg_mode8_cpp(const Byte* pSrc, int srcPitch) {
 
     Byte mindiff = std::min(std::min(std::min(c1, c2), c3), c4);
 
-    if (mindiff == c4) return clipped4;
-    if (mindiff == c2) return clipped2;
-    if (mindiff == c3) return clipped3;
-    return clipped1;
+    auto result = clipped1;
+    result = mindiff == c3 ? clipped3 : result;
+    result = mindiff == c2 ? clipped2 : result;
+    result = mindiff == c4 ? clipped4 : result;
+    return result;
 }
 
 template<int bits_per_pixel>
@@ -565,10 +574,11 @@ RG_FORCEINLINE uint16_t rg_mode8_cpp_16(const Byte* pSrc, int srcPitch) {
 
   uint16_t mindiff = std::min(std::min(std::min(c1, c2), c3), c4);
 
-  if (mindiff == c4) return clipped4;
-  if (mindiff == c2) return clipped2;
-  if (mindiff == c3) return clipped3;
-  return clipped1;
+  auto result = clipped1;
+  result = mindiff == c3 ? clipped3 : result;
+  result = mindiff == c2 ? clipped2 : result;
+  result = mindiff == c4 ? clipped4 : result;
+  return result;
 }
 
 //template<bool chroma>
@@ -620,10 +630,11 @@ RG_FORCEINLINE float rg_mode8_cpp_32(const Byte* pSrc, int srcPitch) {
 
   float mindiff = std::min(std::min(std::min(c1, c2), c3), c4);
 
-  if (mindiff == c4) return clipped4;
-  if (mindiff == c2) return clipped2;
-  if (mindiff == c3) return clipped3;
-  return clipped1;
+  auto result = clipped1;
+  result = mindiff == c3 ? clipped3 : result;
+  result = mindiff == c2 ? clipped2 : result;
+  result = mindiff == c4 ? clipped4 : result;
+  return result;
 }
 
 // ------------
@@ -650,10 +661,11 @@ RG_FORCEINLINE Byte rg_mode9_cpp(const Byte* pSrc, int srcPitch) {
 
     auto mindiff = std::min(std::min(std::min(d1, d2), d3), d4);
 
-    if (mindiff == d4) return clip(c, mil4, mal4);
-    if (mindiff == d2) return clip(c, mil2, mal2);
-    if (mindiff == d3) return clip(c, mil3, mal3);
-    return clip(c, mil1, mal1);
+    auto result = clip(c, mil1, mal1);
+    result = mindiff == d3 ? clip(c, mil3, mal3) : result;
+    result = mindiff == d2 ? clip(c, mil2, mal2) : result;
+    result = mindiff == d4 ? clip(c, mil4, mal4) : result;
+    return result;
 }
 
 RG_FORCEINLINE uint16_t rg_mode9_cpp_16(const Byte* pSrc, int srcPitch) {
@@ -678,10 +690,11 @@ RG_FORCEINLINE uint16_t rg_mode9_cpp_16(const Byte* pSrc, int srcPitch) {
 
   auto mindiff = std::min(std::min(std::min(d1, d2), d3), d4);
 
-  if (mindiff == d4) return clip_16(c, mil4, mal4);
-  if (mindiff == d2) return clip_16(c, mil2, mal2);
-  if (mindiff == d3) return clip_16(c, mil3, mal3);
-  return clip_16(c, mil1, mal1);
+  auto result = clip_16(c, mil1, mal1);
+  result = mindiff == d3 ? clip_16(c, mil3, mal3) : result;
+  result = mindiff == d2 ? clip_16(c, mil2, mal2) : result;
+  result = mindiff == d4 ? clip_16(c, mil4, mal4) : result;
+  return result;
 }
 
 RG_FORCEINLINE float rg_mode9_cpp_32(const Byte* pSrc, int srcPitch) {
@@ -706,10 +719,11 @@ RG_FORCEINLINE float rg_mode9_cpp_32(const Byte* pSrc, int srcPitch) {
 
   auto mindiff = std::min(std::min(std::min(d1, d2), d3), d4);
 
-  if (mindiff == d4) return clip_32(c, mil4, mal4);
-  if (mindiff == d2) return clip_32(c, mil2, mal2);
-  if (mindiff == d3) return clip_32(c, mil3, mal3);
-  return clip_32(c, mil1, mal1);
+  auto result = clip_32(c, mil1, mal1);
+  result = mindiff == d3 ? clip_32(c, mil3, mal3) : result;
+  result = mindiff == d2 ? clip_32(c, mil2, mal2) : result;
+  result = mindiff == d4 ? clip_32(c, mil4, mal4) : result;
+  return result;
 }
 
 // ------------
@@ -728,14 +742,15 @@ RG_FORCEINLINE Byte rg_mode10_cpp(const Byte* pSrc, int srcPitch) {
 
     auto mindiff = std::min(std::min(std::min(std::min(std::min(std::min(std::min(d1, d2), d3), d4), d5), d6), d7), d8);
     
-    if (mindiff == d7) return a7;
-    if (mindiff == d8) return a8;
-    if (mindiff == d6) return a6;
-    if (mindiff == d2) return a2;
-    if (mindiff == d3) return a3;
-    if (mindiff == d1) return a1;
-    if (mindiff == d5) return a5;
-    return a4;
+    auto result = a4;
+    result = mindiff == d5 ? a5 : result;
+    result = mindiff == d1 ? a1 : result;
+    result = mindiff == d3 ? a3 : result;
+    result = mindiff == d2 ? a2 : result;
+    result = mindiff == d6 ? a6 : result;
+    result = mindiff == d8 ? a8 : result;
+    result = mindiff == d7 ? a7 : result;
+    return result;
 }
 
 RG_FORCEINLINE uint16_t rg_mode10_cpp_16(const Byte* pSrc, int srcPitch) {
@@ -752,14 +767,15 @@ RG_FORCEINLINE uint16_t rg_mode10_cpp_16(const Byte* pSrc, int srcPitch) {
 
   auto mindiff = std::min(std::min(std::min(std::min(std::min(std::min(std::min(d1, d2), d3), d4), d5), d6), d7), d8);
 
-  if (mindiff == d7) return a7;
-  if (mindiff == d8) return a8;
-  if (mindiff == d6) return a6;
-  if (mindiff == d2) return a2;
-  if (mindiff == d3) return a3;
-  if (mindiff == d1) return a1;
-  if (mindiff == d5) return a5;
-  return a4;
+  auto result = a4;
+  result = mindiff == d5 ? a5 : result;
+  result = mindiff == d1 ? a1 : result;
+  result = mindiff == d3 ? a3 : result;
+  result = mindiff == d2 ? a2 : result;
+  result = mindiff == d6 ? a6 : result;
+  result = mindiff == d8 ? a8 : result;
+  result = mindiff == d7 ? a7 : result;
+  return result;
 }
 
 RG_FORCEINLINE float rg_mode10_cpp_32(const Byte* pSrc, int srcPitch) {
@@ -776,14 +792,15 @@ RG_FORCEINLINE float rg_mode10_cpp_32(const Byte* pSrc, int srcPitch) {
 
   auto mindiff = std::min(std::min(std::min(std::min(std::min(std::min(std::min(d1, d2), d3), d4), d5), d6), d7), d8);
 
-  if (mindiff == d7) return a7;
-  if (mindiff == d8) return a8;
-  if (mindiff == d6) return a6;
-  if (mindiff == d2) return a2;
-  if (mindiff == d3) return a3;
-  if (mindiff == d1) return a1;
-  if (mindiff == d5) return a5;
-  return a4;
+  auto result = a4;
+  result = mindiff == d5 ? a5 : result;
+  result = mindiff == d1 ? a1 : result;
+  result = mindiff == d3 ? a3 : result;
+  result = mindiff == d2 ? a2 : result;
+  result = mindiff == d6 ? a6 : result;
+  result = mindiff == d8 ? a8 : result;
+  result = mindiff == d7 ? a7 : result;
+  return result;
 }
 
 // ------------
@@ -856,9 +873,10 @@ RG_FORCEINLINE Byte rg_mode13_and14_cpp(const Byte* pSrc, int srcPitch) {
 
     auto mindiff = std::min(std::min(d1, d2), d3);
     
-    if (mindiff == d2) return (a2 + a7 + 1) / 2;
-    if (mindiff == d3) return (a3 + a6 + 1) / 2;
-    return (a1 + a8 + 1) / 2;
+    auto result = (a1 + a8 + 1) / 2;
+    result = mindiff == d3 ? (a3 + a6 + 1) / 2 : result;
+    result = mindiff == d2 ? (a2 + a7 + 1) / 2 : result;
+    return result;
 }
 
 RG_FORCEINLINE uint16_t rg_mode13_and14_cpp_16(const Byte* pSrc, int srcPitch) {
@@ -870,9 +888,10 @@ RG_FORCEINLINE uint16_t rg_mode13_and14_cpp_16(const Byte* pSrc, int srcPitch) {
 
   auto mindiff = std::min(std::min(d1, d2), d3);
 
-  if (mindiff == d2) return (a2 + a7 + 1) / 2;
-  if (mindiff == d3) return (a3 + a6 + 1) / 2;
-  return (a1 + a8 + 1) / 2;
+  auto result = (a1 + a8 + 1) / 2;
+  result = mindiff == d3 ? (a3 + a6 + 1) / 2 : result;
+  result = mindiff == d2 ? (a2 + a7 + 1) / 2 : result;
+  return result;
 }
 
 RG_FORCEINLINE float rg_mode13_and14_cpp_32(const Byte* pSrc, int srcPitch) {
@@ -884,9 +903,11 @@ RG_FORCEINLINE float rg_mode13_and14_cpp_32(const Byte* pSrc, int srcPitch) {
 
   auto mindiff = std::min(std::min(d1, d2), d3);
 
-  if (mindiff == d2) return (a2 + a7) / 2.0f; // (a2 + a7 + 1) / 2;
-  if (mindiff == d3) return (a3 + a6) / 2.0f; // (a3 + a6 + 1) / 2;
-  return (a1 + a8) / 2.0f; // (a1 + a8 + 1) / 2;
+  // no +1 rounding in float
+  auto result = (a1 + a8) / 2.0f;
+  result = mindiff == d3 ? (a3 + a6) / 2.0f : result;
+  result = mindiff == d2 ? (a2 + a7) / 2.0f : result;
+  return result;
 }
 
 // ------------
@@ -903,9 +924,10 @@ RG_FORCEINLINE Byte rg_mode15_and16_cpp(const Byte* pSrc, int srcPitch) {
 
     auto average = (a1 + 2*a2 + a3 + a6 + 2*a7 + a8 + 4) / 8;
 
-    if (mindiff == d2) return clip(average, (int)std::min(a2, a7), (int)std::max(a2, a7));
-    if (mindiff == d3) return clip(average, (int)std::min(a3, a6), (int)std::max(a3, a6));
-    return clip(average, (int)std::min(a1, a8), (int)std::max(a1, a8));
+    auto result = clip(average, (int)std::min(a1, a8), (int)std::max(a1, a8));
+    result = mindiff == d3 ? clip(average, (int)std::min(a3, a6), (int)std::max(a3, a6)) : result;
+    result = mindiff == d2 ? clip(average, (int)std::min(a2, a7), (int)std::max(a2, a7)) : result;
+    return result;
 }
 
 RG_FORCEINLINE uint16_t rg_mode15_and16_cpp_16(const Byte* pSrc, int srcPitch) {
@@ -919,9 +941,10 @@ RG_FORCEINLINE uint16_t rg_mode15_and16_cpp_16(const Byte* pSrc, int srcPitch) {
 
   auto average = (a1 + 2*a2 + a3 + a6 + 2*a7 + a8 + 4) / 8;
 
-  if (mindiff == d2) return clip_16(average, (int)std::min(a2, a7), (int)std::max(a2, a7));
-  if (mindiff == d3) return clip_16(average, (int)std::min(a3, a6), (int)std::max(a3, a6));
-  return clip_16(average, (int)std::min(a1, a8), (int)std::max(a1, a8));
+  auto result = clip_16(average, (int)std::min(a1, a8), (int)std::max(a1, a8));
+  result = mindiff == d3 ? clip_16(average, (int)std::min(a3, a6), (int)std::max(a3, a6)) : result;
+  result = mindiff == d2 ? clip_16(average, (int)std::min(a2, a7), (int)std::max(a2, a7)) : result;
+  return result;
 }
 
 RG_FORCEINLINE float rg_mode15_and16_cpp_32(const Byte* pSrc, int srcPitch) {
@@ -935,9 +958,10 @@ RG_FORCEINLINE float rg_mode15_and16_cpp_32(const Byte* pSrc, int srcPitch) {
 
   auto average = (a1 + 2*a2 + a3 + a6 + 2*a7 + a8 + 4) / 8.0f;
 
-  if (mindiff == d2) return clip_32(average, std::min(a2, a7), std::max(a2, a7));
-  if (mindiff == d3) return clip_32(average, std::min(a3, a6), std::max(a3, a6));
-  return clip_32(average, std::min(a1, a8), std::max(a1, a8));
+  auto result = clip_32(average, std::min(a1, a8), std::max(a1, a8));
+  result = mindiff == d3 ? clip_32(average, std::min(a3, a6), std::max(a3, a6)) : result;
+  result = mindiff == d2 ? clip_32(average, std::min(a2, a7), std::max(a2, a7)) : result;
+  return result;
 }
 // ------------
 
@@ -1016,10 +1040,11 @@ RG_FORCEINLINE Byte rg_mode18_cpp(const Byte* pSrc, int srcPitch) {
 
     auto mindiff = std::min(std::min(std::min(d1, d2), d3), d4);
 
-    if (mindiff == d4) return clip(c, std::min(a4, a5),std::max(a4, a5));
-    if (mindiff == d2) return clip(c, std::min(a2, a7),std::max(a2, a7));
-    if (mindiff == d3) return clip(c, std::min(a3, a6),std::max(a3, a6));
-    return clip(c, std::min(a1, a8), std::max(a1, a8));
+    auto result = clip(c, std::min(a1, a8), std::max(a1, a8));
+    result = mindiff == d3 ? clip(c, std::min(a3, a6),std::max(a3, a6)) : result;
+    result = mindiff == d2 ? clip(c, std::min(a2, a7),std::max(a2, a7)) : result;
+    result = mindiff == d4 ? clip(c, std::min(a4, a5),std::max(a4, a5)) : result;
+    return result;
 }
 
 RG_FORCEINLINE uint16_t rg_mode18_cpp_16(const Byte* pSrc, int srcPitch) {
@@ -1032,10 +1057,11 @@ RG_FORCEINLINE uint16_t rg_mode18_cpp_16(const Byte* pSrc, int srcPitch) {
 
   auto mindiff = std::min(std::min(std::min(d1, d2), d3), d4);
 
-  if (mindiff == d4) return clip_16(c, std::min(a4, a5),std::max(a4, a5));
-  if (mindiff == d2) return clip_16(c, std::min(a2, a7),std::max(a2, a7));
-  if (mindiff == d3) return clip_16(c, std::min(a3, a6),std::max(a3, a6));
-  return clip_16(c, std::min(a1, a8), std::max(a1, a8));
+  auto result = clip_16(c, std::min(a1, a8), std::max(a1, a8));
+  result = mindiff == d3 ? clip_16(c, std::min(a3, a6),std::max(a3, a6)) : result;
+  result = mindiff == d2 ? clip_16(c, std::min(a2, a7),std::max(a2, a7)) : result;
+  result = mindiff == d4 ? clip_16(c, std::min(a4, a5),std::max(a4, a5)) : result;
+  return result;
 }
 
 RG_FORCEINLINE float rg_mode18_cpp_32(const Byte* pSrc, int srcPitch) {
@@ -1048,10 +1074,11 @@ RG_FORCEINLINE float rg_mode18_cpp_32(const Byte* pSrc, int srcPitch) {
 
   auto mindiff = std::min(std::min(std::min(d1, d2), d3), d4);
 
-  if (mindiff == d4) return clip_32(c, std::min(a4, a5),std::max(a4, a5));
-  if (mindiff == d2) return clip_32(c, std::min(a2, a7),std::max(a2, a7));
-  if (mindiff == d3) return clip_32(c, std::min(a3, a6),std::max(a3, a6));
-  return clip_32(c, std::min(a1, a8), std::max(a1, a8));
+  auto result = clip_32(c, std::min(a1, a8), std::max(a1, a8));
+  result = mindiff == d3 ? clip_32(c, std::min(a3, a6),std::max(a3, a6)) : result;
+  result = mindiff == d2 ? clip_32(c, std::min(a2, a7),std::max(a2, a7)) : result;
+  result = mindiff == d4 ? clip_32(c, std::min(a4, a5),std::max(a4, a5)) : result;
+  return result;
 }
 
 // ------------
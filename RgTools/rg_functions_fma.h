@@ -0,0 +1,174 @@
+#ifndef __RG_FUNCTIONS_FMA_H__
+#define __RG_FUNCTIONS_FMA_H__
+
+#include "rg_functions_avx2.h"
+
+// 32 bit float RemoveGrain modes for AVX2 CPUs with FMA3, used instead of the
+// converted integer kernels of rg_functions_avx2.h where there is something to gain:
+// - weighted sums (11, 12, 15, 16, 19, 20) as one sum per weight and FMA instead of
+//   chains of averages. Not bit identical to the plain AVX2 float output, see README
+// - 2*x + y in the edge selection modes (6, 8) as one FMA, bit identical (2*x is exact)
+// - mode 21/22 clip limits: min/max of the pair sums, halved once. Bit identical
+// The other modes have no arithmetic to save and use the plain AVX2 kernels.
+
+template<bool aligned>
+RG_FORCEINLINE __m256i rg_mode6_fma_32(const Byte* pSrc, int srcPitch) {
+  LOAD_SQUARE_AVX2_32_UA(pSrc, srcPitch, aligned);
+
+  auto mal1 = _mm256_max_ps(a1, a8);
+  auto mil1 = _mm256_min_ps(a1, a8);
+
+  auto mal2 = _mm256_max_ps(a2, a7);
+  auto mil2 = _mm256_min_ps(a2, a7);
+
+  auto mal3 = _mm256_max_ps(a3, a6);
+  auto mil3 = _mm256_min_ps(a3, a6);
+
+  auto mal4 = _mm256_max_ps(a4, a5);
+  auto mil4 = _mm256_min_ps(a4, a5);
+
+  auto clipped1 = simd_clip_32(c, mil1, mal1);
+  auto clipped2 = simd_clip_32(c, mil2, mal2);
+  auto clipped3 = simd_clip_32(c, mil3, mal3);
+  auto clipped4 = simd_clip_32(c, mil4, mal4);
+
+  auto c1 = fma_twice_plus_32(abs_diff_32(c, clipped1), _mm256_sub_ps(mal1, mil1));
+  auto c2 = fma_twice_plus_32(abs_diff_32(c, clipped2), _mm256_sub_ps(mal2, mil2));
+  auto c3 = fma_twice_plus_32(abs_diff_32(c, clipped3), _mm256_sub_ps(mal3, mil3));
+  auto c4 = fma_twice_plus_32(abs_diff_32(c, clipped4), _mm256_sub_ps(mal4, mil4));
+
+  auto mindiff = _mm256_min_ps(_mm256_min_ps(c1, c2), _mm256_min_ps(c3, c4));
+
+  auto result = select_on_equal_32(mindiff, c1, c, clipped1);
+  result = select_on_equal_32(mindiff, c3, result, clipped3);
+  result = select_on_equal_32(mindiff, c2, result, clipped2);
+  return _mm256_castps_si256(select_on_equal_32(mindiff, c4, result, clipped4));
+}
+
+template<bool aligned>
+RG_FORCEINLINE __m256i rg_mode8_fma_32(const Byte* pSrc, int srcPitch) {
+  LOAD_SQUARE_AVX2_32_UA(pSrc, srcPitch, aligned);
+
+  auto mal1 = _mm256_max_ps(a1, a8);
+  auto mil1 = _mm256_min_ps(a1, a8);
+
+  auto mal2 = _mm256_max_ps(a2, a7);
+  auto mil2 = _mm256_min_ps(a2, a7);
+
+  auto mal3 = _mm256_max_ps(a3, a6);
+  auto mil3 = _mm256_min_ps(a3, a6);
+
+  auto mal4 = _mm256_max_ps(a4, a5);
+  auto mil4 = _mm256_min_ps(a4, a5);
+
+  auto clipped1 = simd_clip_32(c, mil1, mal1);
+  auto clipped2 = simd_clip_32(c, mil2, mal2);
+  auto clipped3 = simd_clip_32(c, mil3, mal3);
+  auto clipped4 = simd_clip_32(c, mil4, mal4);
+
+  auto c1 = fma_twice_plus_32(_mm256_sub_ps(mal1, mil1), abs_diff_32(c, clipped1));
+  auto c2 = fma_twice_plus_32(_mm256_sub_ps(mal2, mil2), abs_diff_32(c, clipped2));
+  auto c3 = fma_twice_plus_32(_mm256_sub_ps(mal3, mil3), abs_diff_32(c, clipped3));
+  auto c4 = fma_twice_plus_32(_mm256_sub_ps(mal4, mil4), abs_diff_32(c, clipped4));
+
+  auto mindiff = _mm256_min_ps(_mm256_min_ps(c1, c2), _mm256_min_ps(c3, c4));
+
+  auto result = select_on_equal_32(mindiff, c1, c, clipped1);
+  result = select_on_equal_32(mindiff, c3, result, clipped3);
+  result = select_on_equal_32(mindiff, c2, result, clipped2);
+  return _mm256_castps_si256(select_on_equal_32(mindiff, c4, result, clipped4));
+}
+
+//-------------------
+
+// (4*c + 2*(a2 + a4 + a5 + a7) + a1 + a3 + a6 + a8) / 16, same as the C version
+template<bool aligned>
+RG_FORCEINLINE __m256i rg_mode11_and12_fma_32(const Byte* pSrc, int srcPitch) {
+  LOAD_SQUARE_AVX2_32_UA(pSrc, srcPitch, aligned);
+
+  auto corners = _mm256_add_ps(_mm256_add_ps(a1, a3), _mm256_add_ps(a6, a8));
+  auto edges = _mm256_add_ps(_mm256_add_ps(a2, a4), _mm256_add_ps(a5, a7));
+
+  auto val = _mm256_mul_ps(corners, _mm256_set1_ps(1.0f / 16));
+  val = _mm256_fmadd_ps(edges, _mm256_set1_ps(1.0f / 8), val);
+  val = _mm256_fmadd_ps(c, _mm256_set1_ps(1.0f / 4), val);
+  return _mm256_castps_si256(val);
+}
+
+//-------------------
+
+// interpolation (a1 + 2*a2 + a3 + a6 + 2*a7 + a8) / 8, clipped to the pair with the smallest difference
+template<bool aligned>
+RG_FORCEINLINE __m256i rg_mode15_and16_fma_32(const Byte* pSrc, int srcPitch) {
+  LOAD_SQUARE_AVX2_32_UA(pSrc, srcPitch, aligned);
+
+  auto max18 = _mm256_max_ps(a1, a8);
+  auto min18 = _mm256_min_ps(a1, a8);
+
+  auto max27 = _mm256_max_ps(a2, a7);
+  auto min27 = _mm256_min_ps(a2, a7);
+
+  auto max36 = _mm256_max_ps(a3, a6);
+  auto min36 = _mm256_min_ps(a3, a6);
+
+  auto d1 = _mm256_sub_ps(max18, min18);
+  auto d2 = _mm256_sub_ps(max27, min27);
+  auto d3 = _mm256_sub_ps(max36, min36);
+
+  auto mindiff = _mm256_min_ps(_mm256_min_ps(d1, d2), d3);
+
+  auto outer = _mm256_add_ps(_mm256_add_ps(a1, a3), _mm256_add_ps(a6, a8));
+  auto avg = _mm256_mul_ps(outer, _mm256_set1_ps(1.0f / 8));
+  avg = _mm256_fmadd_ps(_mm256_add_ps(a2, a7), _mm256_set1_ps(1.0f / 4), avg);
+
+  auto result = select_on_equal_32(mindiff, d1, c, simd_clip_32(avg, min18, max18));
+  result = select_on_equal_32(mindiff, d3, result, simd_clip_32(avg, min36, max36));
+  return _mm256_castps_si256(select_on_equal_32(mindiff, d2, result, simd_clip_32(avg, min27, max27)));
+}
+
+//-------------------
+
+// mean of the 8 neighbours
+template<bool aligned>
+RG_FORCEINLINE __m256i rg_mode19_fma_32(const Byte* pSrc, int srcPitch) {
+  LOAD_SQUARE_AVX2_32_UA(pSrc, srcPitch, aligned);
+
+  const auto eighth = _mm256_set1_ps(1.0f / 8);
+  auto corners = _mm256_add_ps(_mm256_add_ps(a1, a3), _mm256_add_ps(a6, a8));
+  auto edges = _mm256_add_ps(_mm256_add_ps(a2, a4), _mm256_add_ps(a5, a7));
+
+  return _mm256_castps_si256(_mm256_fmadd_ps(corners, eighth, _mm256_mul_ps(edges, eighth)));
+}
+
+// mean of the 3x3 square
+template<bool aligned>
+RG_FORCEINLINE __m256i rg_mode20_fma_32(const Byte* pSrc, int srcPitch) {
+  LOAD_SQUARE_AVX2_32_UA(pSrc, srcPitch, aligned);
+
+  const auto ninth = _mm256_set1_ps(1.0f / 9);
+  auto corners = _mm256_add_ps(_mm256_add_ps(a1, a3), _mm256_add_ps(a6, a8));
+  auto edges = _mm256_add_ps(_mm256_add_ps(a2, a4), _mm256_add_ps(a5, a7));
+
+  return _mm256_castps_si256(_mm256_fmadd_ps(_mm256_add_ps(corners, edges), ninth, _mm256_mul_ps(c, ninth)));
+}
+
+//-------------------
+
+// float: mode 21 is the same as 22. min/max of (a + b) / 2 are the halved min/max of the sums
+template<bool aligned>
+RG_FORCEINLINE __m256i rg_mode21_and22_fma_32(const Byte* pSrc, int srcPitch) {
+  LOAD_SQUARE_AVX2_32_UA(pSrc, srcPitch, aligned);
+
+  auto l1 = _mm256_add_ps(a1, a8);
+  auto l2 = _mm256_add_ps(a2, a7);
+  auto l3 = _mm256_add_ps(a3, a6);
+  auto l4 = _mm256_add_ps(a4, a5);
+
+  const auto half = _mm256_set1_ps(0.5f);
+  auto ma = _mm256_mul_ps(_mm256_max_ps(_mm256_max_ps(l1, l2), _mm256_max_ps(l3, l4)), half);
+  auto mi = _mm256_mul_ps(_mm256_min_ps(_mm256_min_ps(l1, l2), _mm256_min_ps(l3, l4)), half);
+
+  return _mm256_castps_si256(simd_clip_32(c, mi, ma));
+}
+
+#endif
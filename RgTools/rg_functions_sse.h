@@ -28,7 +28,7 @@ static RG_FORCEINLINE __m128i not_rounded_average_16(__m128i a, __m128i b) {
 
 // todo: 
 // - Float parts were blindly converted, should be optimized,
-//   check averaging simplifications, clamping
+//   check averaging simplifications, clamping (done for AVX2+FMA3 in rg_functions_fma.h)
 
 //-------------------
 
@@ -1085,7 +1085,7 @@ RG_FORCEINLINE __m128i rg_mode10_sse_32(const Byte* pSrc, int srcPitch) {
 
 //-------------------
 
-template<bool aligned>
+template<bool aligned, InstructionSet optLevel>
 RG_FORCEINLINE __m128i rg_mode12_sse(const Byte* pSrc, int srcPitch);
 template<bool aligned>
 RG_FORCEINLINE __m128i rg_mode12_sse_16(const Byte* pSrc, int srcPitch);
@@ -1652,7 +1652,7 @@ RG_FORCEINLINE __m128i rg_mode20_sse_16(const Byte* pSrc, int srcPitch) {
   // worst case: 9*FFFF * E39 = 8000B8E3 ( 8000B8E3 >> 15 = 10001, packus rounding to FFFF)
   // Try with
   // ((1<<15) / 9  + 4) = 0xE3C (3644)
-  const byte FACTOR = 15;
+  const Byte FACTOR = 15;
   auto zero = _mm_setzero_si128();
   auto onenineth = _mm_set1_epi32(((1u << FACTOR) + 4) / 9);
   auto bias = _mm_set1_epi32(4);
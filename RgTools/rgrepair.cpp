@@ -0,0 +1,115 @@
+#include "rgrepair.h"
+
+
+RGRepair::RGRepair(PClip child, int rgmode, int repmode, bool skip_cs_check, bool use_avx2, int threads, bool profile, IScriptEnvironment* env)
+    : GenericVideoFilter(child), rgmode_(rgmode), repmode_(repmode), rg_functions(nullptr), repair_functions_(nullptr), rg_functions_chroma(nullptr), repair_functions_chroma(nullptr), pool_(nullptr), stripes_(1) {
+    if (!(vi.IsPlanar() || skip_cs_check)) {
+        env->ThrowError("RGRepair works only with planar colorspaces");
+    }
+
+    if (rgmode_ < 0 || rgmode_ > 24 || repmode_ < 0 || repmode_ > 24) {
+        env->ThrowError("RGRepair: rgmode and repmode should be between 0 and 24!");
+    }
+    // Repair(RemoveGrain(c, 0), c, 0) is c, frames are handed on without a copy
+    passthrough_ = rgmode_ == 0 && repmode_ == 0;
+
+    // same tables as RemoveGrain and Repair would pick for this clip
+    rg_functions = removegrain_functions(vi, vi.width, use_avx2, env);
+    repair_functions_ = repair_functions(vi, vi.width, use_avx2, env);
+    rg_functions_chroma = removegrain_functions(vi, chroma_plane_width(vi), use_avx2, env);
+    repair_functions_chroma = repair_functions(vi, chroma_plane_width(vi), use_avx2, env);
+
+    profile_ = FilterProfile::create(profile, "RGRepair", vi, env);
+    if (profile_) {
+      // Repair runs on the same instruction set
+      const bool rgb = vi.IsPlanarRGB() || vi.IsPlanarRGBA();
+      const char *chroma = removegrain_table_name(vi, rgb ? rg_functions : rg_functions_chroma, rgmode_);
+      profile_->set_isa(0, removegrain_table_name(vi, rg_functions, rgmode_));
+      profile_->set_isa(1, chroma);
+      profile_->set_isa(2, chroma);
+    }
+
+    if (threads < 0) {
+      env->ThrowError("RGRepair: threads must be 0 (auto) or positive!");
+    }
+    if (threads != 1) {
+      pool_ = ThreadPool::acquire();
+      stripes_ = stripes_for_threads(threads, pool_);
+    }
+}
+
+RGRepair::~RGRepair() {
+  if (pool_ != nullptr)
+    ThreadPool::release();
+}
+
+// Repair only reads the center pixel of the RemoveGrain result, the 3x3 neighbourhood comes from
+// the source. So RemoveGrain goes band by band into a small buffer, Repair reads it back while the
+// band is still in cache.
+// Bands overlap by two rows: the first and last row of a band are border rows for both plane
+// processors. Row 0 of a later band is already final in pDst, it is put into the buffer so that
+// Repair's top border copy writes it back unchanged. Even band heights keep the field parity of
+// RemoveGrain modes 13-16.
+void RGRepair::process_bands(bool chroma, const BYTE* pSrc, BYTE* pDst, int rowsize, int height, int srcPitch, int dstPitch, IScriptEnvironment* env) {
+  const int bufPitch = (rowsize + 63) & ~63;
+  const int band = std::min(std::max(256 * 1024 / bufPitch, 8), 64) & ~1;
+
+  std::vector<BYTE> buffer(bufPitch * band + 64);
+  BYTE* pBuf = reinterpret_cast<BYTE*>(((uintptr_t)buffer.data() + 63) & ~(uintptr_t)63);
+
+  PlaneProcessor *rg = (chroma ? rg_functions_chroma : rg_functions)[rgmode_ + 1];
+  RepairPlaneProcessor *repair = (chroma ? repair_functions_chroma : repair_functions_)[repmode_ + 1];
+
+  for (int y = 0; ; y += band - 2) {
+    const int h = std::min(band, height - y);
+
+    rg(env, pSrc + y * srcPitch, pBuf, rowsize, h, srcPitch, bufPitch);
+    if (y > 0)
+      memcpy(pBuf, pDst + y * dstPitch, rowsize);
+    repair(env, pDst + y * dstPitch, pBuf, pSrc + y * srcPitch, dstPitch, bufPitch, srcPitch, rowsize, h);
+
+    if (y + h == height)
+      break;
+  }
+}
+
+void RGRepair::process_plane(int p, bool chroma, const BYTE* pSrc, BYTE* pDst, int rowsize, int height, int srcPitch, int dstPitch, IScriptEnvironment* env) {
+  // the RemoveGrain result stays in cache, one plane read and one written
+  PlaneTimer timer(profile_.get(), p, rowsize, height, 1);
+  process_plane_stripes(pool_, stripes_, 1, pDst, dstPitch, rowsize, height, [&](int y, int h, BYTE* pStripeDst, int stripeDstPitch) {
+    process_bands(chroma, pSrc + y * srcPitch, pStripeDst, rowsize, h, srcPitch, stripeDstPitch, env);
+  });
+}
+
+PVideoFrame RGRepair::GetFrame(int n, IScriptEnvironment* env) {
+    if (passthrough_)
+      return child->GetFrame(n, env);
+
+    auto srcFrame = child->GetFrame(n, env);
+    auto dstFrame = env->NewVideoFrame(vi);
+    FrameProfile frame_profile(profile_.get());
+
+    int planes_y[4] = { PLANAR_Y, PLANAR_U, PLANAR_V, PLANAR_A };
+    int planes_r[4] = { PLANAR_G, PLANAR_B, PLANAR_R, PLANAR_A };
+    int *planes = (vi.IsPlanarRGB() || vi.IsPlanarRGBA()) ? planes_r : planes_y;
+    const int num_planes = (vi.IsPlanar() && !vi.IsY()) ? 3 : 1;
+
+    for (int p = 0; p < num_planes; ++p) {
+      const int plane = planes[p];
+      process_plane(p, p > 0 && planes == planes_y, srcFrame->GetReadPtr(plane), dstFrame->GetWritePtr(plane), srcFrame->GetRowSize(plane),
+        srcFrame->GetHeight(plane), srcFrame->GetPitch(plane), dstFrame->GetPitch(plane), env);
+    }
+    if (vi.IsYUVA() || vi.IsPlanarRGBA())
+    { // copy alpha
+      env->BitBlt(dstFrame->GetWritePtr(PLANAR_A), dstFrame->GetPitch(PLANAR_A), srcFrame->GetReadPtr(PLANAR_A), srcFrame->GetPitch(PLANAR_A), srcFrame->GetRowSize(PLANAR_A_ALIGNED), srcFrame->GetHeight(PLANAR_A));
+    }
+    frame_profile.attach(dstFrame, env);
+    return dstFrame;
+}
+
+
+AVSValue __cdecl Create_RGRepair(AVSValue args, void*, IScriptEnvironment* env) {
+    enum { CLIP, RGMODE, REPMODE, PLANAR, OPTAVX2, THREADS, PROFILE };
+    return new RGRepair(args[CLIP].AsClip(), args[RGMODE].AsInt(1), args[REPMODE].AsInt(1),
+      args[PLANAR].AsBool(false), args[OPTAVX2].AsBool(true), args[THREADS].AsInt(1), args[PROFILE].AsBool(false), env);
+}
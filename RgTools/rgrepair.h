@@ -0,0 +1,47 @@
+#ifndef __RGREPAIR_H__
+#define __RGREPAIR_H__
+
+#include "common.h"
+#include "thread_pool.h"
+#include "removegrain.h"
+#include "repair.h"
+
+
+// Repair(RemoveGrain(c, rgmode), c, repmode) in one pass, without the intermediate frame
+class RGRepair : public GenericVideoFilter {
+public:
+    RGRepair(PClip child, int rgmode, int repmode, bool skip_cs_check, bool use_avx2, int threads, bool profile, IScriptEnvironment* env);
+    ~RGRepair();
+
+    PVideoFrame __stdcall GetFrame(int n, IScriptEnvironment* env);
+
+    // profile=true, else nullptr
+    FilterProfile* profile() const { return profile_.get(); }
+
+    int __stdcall SetCacheHints(int cachehints, int frame_range) override {
+      return cachehints == CACHE_GET_MTMODE ? MT_NICE_FILTER : 0;
+    }
+
+private:
+    int rgmode_;
+    int repmode_;
+    bool passthrough_; // rgmode=0 and repmode=0: GetFrame returns the source frame
+
+    PlaneProcessor **rg_functions;
+    RepairPlaneProcessor **repair_functions_;
+    PlaneProcessor **rg_functions_chroma; // U and V, may be narrower than a vector
+    RepairPlaneProcessor **repair_functions_chroma;
+
+    ThreadPool *pool_; // nullptr when threads=1
+    int stripes_;
+
+    std::shared_ptr<FilterProfile> profile_; // nullptr when profile=false
+
+    void process_plane(int p, bool chroma, const BYTE* pSrc, BYTE* pDst, int rowsize, int height, int srcPitch, int dstPitch, IScriptEnvironment* env);
+    void process_bands(bool chroma, const BYTE* pSrc, BYTE* pDst, int rowsize, int height, int srcPitch, int dstPitch, IScriptEnvironment* env);
+};
+
+
+AVSValue __cdecl Create_RGRepair(AVSValue args, void*, IScriptEnvironment* env);
+
+#endif
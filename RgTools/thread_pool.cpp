@@ -0,0 +1,140 @@
+#include "thread_pool.h"
+
+struct ThreadPool::Batch {
+    const std::function<void(int)> *task; // owned by the caller, only used while a task index is claimed
+    int count;
+    std::atomic<int> next;
+    std::atomic<int> done;
+    std::mutex lock;
+    std::condition_variable finished;
+    std::exception_ptr error;
+
+    Batch(const std::function<void(int)> *task, int count) : task(task), count(count), next(0), done(0) {}
+
+    void run() {
+        int i;
+        while ((i = next.fetch_add(1)) < count) {
+            try {
+                (*task)(i);
+            }
+            catch (...) {
+                std::lock_guard<std::mutex> guard(lock);
+                if (!error)
+                    error = std::current_exception();
+            }
+            if (done.fetch_add(1) + 1 == count) {
+                std::lock_guard<std::mutex> guard(lock);
+                finished.notify_all();
+            }
+        }
+    }
+};
+
+static std::mutex pool_lock;
+static ThreadPool *pool_instance = nullptr;
+static int pool_refs = 0;
+
+ThreadPool* ThreadPool::acquire() {
+    std::lock_guard<std::mutex> guard(pool_lock);
+    if (pool_instance == nullptr) {
+        int hw = (int)std::thread::hardware_concurrency();
+        pool_instance = new ThreadPool(std::max(hw, 1) - 1);
+    }
+    ++pool_refs;
+    return pool_instance;
+}
+
+void ThreadPool::release() {
+    std::lock_guard<std::mutex> guard(pool_lock);
+    if (--pool_refs == 0) {
+        delete pool_instance;
+        pool_instance = nullptr;
+    }
+}
+
+ThreadPool::ThreadPool(int worker_count) : pending_(0), next_queue_(0), stop_(false) {
+    for (int i = 0; i < worker_count; ++i) {
+        queues_.emplace_back(new Queue());
+    }
+    for (int i = 0; i < worker_count; ++i) {
+        workers_.emplace_back(&ThreadPool::worker_loop, this, i);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> guard(wake_lock_);
+        stop_ = true;
+    }
+    wake_.notify_all();
+    for (auto &worker : workers_) {
+        worker.join();
+    }
+}
+
+// own queue from the back, others from the front
+bool ThreadPool::pop_or_steal(int index, std::shared_ptr<Batch> &job) {
+    const int n = (int)queues_.size();
+    for (int k = 0; k < n; ++k) {
+        Queue &q = *queues_[(index + k) % n];
+        std::lock_guard<std::mutex> guard(q.lock);
+        if (!q.jobs.empty()) {
+            if (k == 0) {
+                job = q.jobs.back();
+                q.jobs.pop_back();
+            } else {
+                job = q.jobs.front();
+                q.jobs.pop_front();
+            }
+            --pending_;
+            return true;
+        }
+    }
+    return false;
+}
+
+void ThreadPool::worker_loop(int index) {
+    for (;;) {
+        std::shared_ptr<Batch> job;
+        if (pop_or_steal(index, job)) {
+            job->run();
+            continue;
+        }
+        std::unique_lock<std::mutex> lk(wake_lock_);
+        wake_.wait(lk, [this] { return stop_ || pending_ > 0; });
+        if (stop_ && pending_ == 0)
+            return;
+    }
+}
+
+void ThreadPool::parallel_for(int count, const std::function<void(int)> &task) {
+    if (count <= 0)
+        return;
+    if (count == 1 || workers_.empty()) {
+        for (int i = 0; i < count; ++i)
+            task(i);
+        return;
+    }
+
+    auto batch = std::make_shared<Batch>(&task, count);
+
+    // one entry per helping worker, each of them claims task indices until none is left
+    const int helpers = std::min(count - 1, (int)workers_.size());
+    for (int i = 0; i < helpers; ++i) {
+        Queue &q = *queues_[next_queue_.fetch_add(1) % queues_.size()];
+        std::lock_guard<std::mutex> guard(q.lock);
+        q.jobs.push_back(batch);
+        ++pending_;
+    }
+    {
+        std::lock_guard<std::mutex> guard(wake_lock_);
+    }
+    wake_.notify_all();
+
+    batch->run();
+
+    std::unique_lock<std::mutex> lk(batch->lock);
+    batch->finished.wait(lk, [&] { return batch->done.load() == count; });
+    if (batch->error)
+        std::rethrow_exception(batch->error);
+}
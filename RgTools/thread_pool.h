@@ -0,0 +1,96 @@
+#ifndef __THREAD_POOL_H__
+#define __THREAD_POOL_H__
+
+#include "common.h"
+#include <functional>
+#include <memory>
+#include <vector>
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <atomic>
+#include <exception>
+
+// Plugin-wide work-stealing pool, shared by every filter instance. It has one worker less
+// than the hardware threads (the calling thread works too), so several RgTools filters
+// in a script never oversubscribe the cpu.
+class ThreadPool {
+public:
+    // reference counted, workers are joined when the last filter releases the pool
+    static ThreadPool* acquire();
+    static void release();
+
+    // runs task(0)..task(count-1) and returns when all are done, calling thread takes part
+    void parallel_for(int count, const std::function<void(int)>& task);
+
+    // worker threads + calling thread
+    int concurrency() const { return (int)workers_.size() + 1; }
+
+private:
+    struct Batch;
+    struct Queue {
+        std::mutex lock;
+        std::deque<std::shared_ptr<Batch>> jobs;
+    };
+
+    explicit ThreadPool(int worker_count);
+    ~ThreadPool();
+
+    void worker_loop(int index);
+    bool pop_or_steal(int index, std::shared_ptr<Batch> &job);
+
+    std::vector<std::thread> workers_;
+    std::vector<std::unique_ptr<Queue>> queues_;
+    std::mutex wake_lock_;
+    std::condition_variable wake_;
+    std::atomic<int> pending_;
+    std::atomic<unsigned> next_queue_;
+    bool stop_;
+};
+
+// number of stripes for the 'threads' filter parameter: 1 = off, 0 = all hardware threads
+static inline int stripes_for_threads(int threads, ThreadPool *pool) {
+    return threads == 0 || threads > pool->concurrency() ? pool->concurrency() : threads;
+}
+
+// Processes a plane in row stripes on the pool. process(y, h, pDst, dstPitch) must run the
+// plane processor on source rows [y, y+h) and write them to pDst.
+// Plane processors copy 'border' rows at the top and bottom unchanged, so after the stripes
+// the rows around each inner stripe edge are redone from a 4*border row window in a scratch buffer.
+template<typename F>
+static void process_plane_stripes(ThreadPool *pool, int stripes, int border, Byte* pDst, int dstPitch, int rowsize, int height, F process) {
+    const int min_stripe_height = std::max(16, 4 * border);
+    stripes = std::min(stripes, height / min_stripe_height);
+
+    if (pool == nullptr || stripes <= 1) {
+        process(0, height, pDst, dstPitch);
+        return;
+    }
+
+    // even stripe height keeps the field parity of RemoveGrain modes 13-16
+    const int stripe_height = (height / stripes) & ~1;
+
+    pool->parallel_for(stripes, [&](int i) {
+        const int y = i * stripe_height;
+        const int h = i == stripes - 1 ? height - y : stripe_height;
+        process(y, h, pDst + y * dstPitch, dstPitch);
+    });
+
+    if (border == 0)
+        return;
+
+    pool->parallel_for(stripes - 1, [&](int i) {
+        const int edge = (i + 1) * stripe_height;
+        const int scratchPitch = (rowsize + 63) & ~63;
+        std::vector<Byte> scratch(scratchPitch * 4 * border + 64);
+        Byte* pScratch = reinterpret_cast<Byte*>(((uintptr_t)scratch.data() + 63) & ~(uintptr_t)63);
+
+        process(edge - 2 * border, 4 * border, pScratch, scratchPitch);
+        for (int y = 0; y < 2 * border; ++y) {
+            memcpy(pDst + (edge - border + y) * dstPitch, pScratch + (border + y) * scratchPitch, rowsize);
+        }
+    });
+}
+
+#endif
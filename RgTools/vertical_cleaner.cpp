@@ -1,220 +1,176 @@
 #include "vertical_cleaner.h"
-#include <xutility>
+#include "inplace.h"
+#include <algorithm>
 
 
-template<typename pixel_t>
-static void vcleaner_median_sse(Byte* pDst, const Byte *pSrc, int dstPitch, int srcPitch, int rowsize, int height, IScriptEnvironment *env) {
-    env->BitBlt(pDst, dstPitch, pSrc, srcPitch, rowsize, 1);
+typedef __m128i (VModeProcessor)(const Byte* pSrc, int srcPitch);
 
-    const int width = rowsize / sizeof(pixel_t);
+template<typename pixel_t, bool aligned>
+static RG_FORCEINLINE __m128i vcleaner_median_sse(const Byte* pSrc, int srcPitch) {
+    __m128i up     = simd_load_si128<aligned>(pSrc - srcPitch);
+    __m128i center = simd_load_si128<aligned>(pSrc);
+    __m128i down   = simd_load_si128<aligned>(pSrc + srcPitch);
 
-    pSrc += srcPitch;
-    pDst += dstPitch;
+    if (sizeof(pixel_t) == 1) {
+      __m128i mi = _mm_min_epu8(up, down);
+      __m128i ma = _mm_max_epu8(up, down);
 
-    for (int y = 1; y < height-1; ++y) {
-        for (int x = 0; x < width; x+=16/sizeof(pixel_t)) {
-            __m128i up     = _mm_load_si128(reinterpret_cast<const __m128i*>(pSrc + x*sizeof(pixel_t) - srcPitch));
-            __m128i center = _mm_load_si128(reinterpret_cast<const __m128i*>(pSrc + x*sizeof(pixel_t)));
-            __m128i down   = _mm_load_si128(reinterpret_cast<const __m128i*>(pSrc + x*sizeof(pixel_t) + srcPitch));
-
-            __m128i dst;
-            if (sizeof(pixel_t) == 1) {
-              __m128i mi = _mm_min_epu8(up, down);
-              __m128i ma = _mm_max_epu8(up, down);
-
-              __m128i cma = _mm_max_epu8(mi, center);
-              dst = _mm_min_epu8(cma, ma);
-            }
-            else if (sizeof(pixel_t) == 2) {
-              __m128i mi = _mm_min_epu16(up, down);
-              __m128i ma = _mm_max_epu16(up, down);
-
-              __m128i cma = _mm_max_epu16(mi, center);
-              dst = _mm_min_epu16(cma, ma);
-            }
-            else {  // sizeof(pixel_t) == 4: float
-              __m128 mi = _mm_min_ps(_mm_castsi128_ps(up), _mm_castsi128_ps(down));
-              __m128 ma = _mm_max_ps(_mm_castsi128_ps(up), _mm_castsi128_ps(down));
-
-              __m128 cma = _mm_max_ps(mi, _mm_castsi128_ps(center));
-              dst = _mm_castps_si128(_mm_min_ps(cma, ma));
-            }
-
-            _mm_store_si128(reinterpret_cast<__m128i*>(pDst+x*sizeof(pixel_t)), dst);
-        }
+      __m128i cma = _mm_max_epu8(mi, center);
+      return _mm_min_epu8(cma, ma);
+    }
+    else if (sizeof(pixel_t) == 2) {
+      __m128i mi = _mm_min_epu16(up, down);
+      __m128i ma = _mm_max_epu16(up, down);
 
-        pSrc += srcPitch;
-        pDst += dstPitch;
+      __m128i cma = _mm_max_epu16(mi, center);
+      return _mm_min_epu16(cma, ma);
     }
+    else {  // sizeof(pixel_t) == 4: float
+      __m128 mi = _mm_min_ps(_mm_castsi128_ps(up), _mm_castsi128_ps(down));
+      __m128 ma = _mm_max_ps(_mm_castsi128_ps(up), _mm_castsi128_ps(down));
 
-    env->BitBlt(pDst, dstPitch, pSrc, srcPitch, rowsize, 1);
+      __m128 cma = _mm_max_ps(mi, _mm_castsi128_ps(center));
+      return _mm_castps_si128(_mm_min_ps(cma, ma));
+    }
 }
 
-static void vcleaner_relaxed_median_sse2(Byte* pDst, const Byte *pSrc, int dstPitch, int srcPitch, int rowsize, int height, IScriptEnvironment *env) {
-    env->BitBlt(pDst, dstPitch, pSrc, srcPitch, rowsize, 2);
+template<bool aligned>
+static RG_FORCEINLINE __m128i vcleaner_relaxed_median_sse2(const Byte* pSrc, int srcPitch) {
+    __m128i p2 = simd_load_si128<aligned>(pSrc - srcPitch*2);
+    __m128i p1 = simd_load_si128<aligned>(pSrc - srcPitch);
+    __m128i c  = simd_load_si128<aligned>(pSrc);
+    __m128i n1 = simd_load_si128<aligned>(pSrc + srcPitch);
+    __m128i n2 = simd_load_si128<aligned>(pSrc + srcPitch*2);
 
-    pSrc += srcPitch*2;
-    pDst += dstPitch*2;
+    __m128i pdiff = _mm_subs_epu8(p1, p2);
+    __m128i ndiff = _mm_subs_epu8(n1, n2);
 
-    for (int y = 2; y < height-2; ++y) {
-        for (int x = 0; x < rowsize; x+=16) {
-            __m128i p2 = _mm_load_si128(reinterpret_cast<const __m128i*>(pSrc + x-srcPitch*2));
-            __m128i p1 = _mm_load_si128(reinterpret_cast<const __m128i*>(pSrc + x-srcPitch));
-            __m128i c  = _mm_load_si128(reinterpret_cast<const __m128i*>(pSrc + x));
-            __m128i n1 = _mm_load_si128(reinterpret_cast<const __m128i*>(pSrc + x+srcPitch));
-            __m128i n2 = _mm_load_si128(reinterpret_cast<const __m128i*>(pSrc + x+srcPitch*2));
-
-            __m128i pdiff = _mm_subs_epu8(p1, p2);
-            __m128i ndiff = _mm_subs_epu8(n1, n2);
-
-            __m128i pt = _mm_adds_epu8(pdiff, p1);
-            __m128i nt = _mm_adds_epu8(ndiff, n1);
+    __m128i pt = _mm_adds_epu8(pdiff, p1);
+    __m128i nt = _mm_adds_epu8(ndiff, n1);
 
-            __m128i upper = _mm_min_epu8(pt, nt);
-            upper = _mm_max_epu8(upper, p1);
-            upper = _mm_max_epu8(upper, n1);
+    __m128i upper = _mm_min_epu8(pt, nt);
+    upper = _mm_max_epu8(upper, p1);
+    upper = _mm_max_epu8(upper, n1);
 
-            pdiff = _mm_subs_epu8(p2, p1);
-            ndiff = _mm_subs_epu8(n2, n1);
+    pdiff = _mm_subs_epu8(p2, p1);
+    ndiff = _mm_subs_epu8(n2, n1);
 
-            pt = _mm_subs_epu8(p1, pdiff);
-            nt = _mm_subs_epu8(n1, ndiff);
+    pt = _mm_subs_epu8(p1, pdiff);
+    nt = _mm_subs_epu8(n1, ndiff);
 
-            __m128i minpn1 = _mm_min_epu8(p1, n1);
+    __m128i minpn1 = _mm_min_epu8(p1, n1);
 
-            __m128i lower = _mm_max_epu8(pt, nt);
-            lower = _mm_min_epu8(lower, minpn1);
-
-            __m128i dst = simd_clip(c, lower, upper);
-
-            _mm_store_si128(reinterpret_cast<__m128i*>(pDst+x), dst);
-        }
+    __m128i lower = _mm_max_epu8(pt, nt);
+    lower = _mm_min_epu8(lower, minpn1);
 
-        pSrc += srcPitch;
-        pDst += dstPitch;
-    }
-
-    env->BitBlt(pDst, dstPitch, pSrc, srcPitch, rowsize, 2);
+    return simd_clip(c, lower, upper);
 }
 
-template<int bits_per_pixel>
-static void vcleaner_relaxed_median_sse4_16(Byte* pDst8, const Byte *pSrc8, int dstPitch, int srcPitch, int rowsize, int height, IScriptEnvironment *env) {
-  env->BitBlt(pDst8, dstPitch, pSrc8, srcPitch, rowsize, 2);
-
-  uint16_t *pDst = reinterpret_cast<uint16_t *>(pDst8);
-  const uint16_t *pSrc = reinterpret_cast<const uint16_t *>(pSrc8);
-
-  dstPitch /= sizeof(uint16_t);
-  srcPitch /= sizeof(uint16_t);
-
-  const int max_pixel_value = (1 << bits_per_pixel) - 1;
-  const int width = rowsize / sizeof(uint16_t);
-
-  pSrc += srcPitch*2;
-  pDst += dstPitch*2;
-
-  for (int y = 2; y < height-2; ++y) {
-    for (int x = 0; x < width; x+=16/sizeof(uint16_t)) {
-      __m128i p2 = _mm_load_si128(reinterpret_cast<const __m128i*>(pSrc + x-srcPitch*2));
-      __m128i p1 = _mm_load_si128(reinterpret_cast<const __m128i*>(pSrc + x-srcPitch));
-      __m128i c  = _mm_load_si128(reinterpret_cast<const __m128i*>(pSrc + x));
-      __m128i n1 = _mm_load_si128(reinterpret_cast<const __m128i*>(pSrc + x+srcPitch));
-      __m128i n2 = _mm_load_si128(reinterpret_cast<const __m128i*>(pSrc + x+srcPitch*2));
-
-      __m128i pdiff = _mm_subs_epu16(p1, p2);
-      __m128i ndiff = _mm_subs_epu16(n1, n2);
-
-      __m128i pt = _mm_adds_epu16(pdiff, p1);
-      __m128i nt = _mm_adds_epu16(ndiff, n1);
-      if (bits_per_pixel < 16) // for 16 bit _mm_adds limits to FFFF
-      {
-        __m128i pixel_max = _mm_set1_epi16((short)((1u << bits_per_pixel) - 1));
-        pt = _mm_min_epu16(pt, pixel_max);
-        nt = _mm_min_epu16(nt, pixel_max);
-      }
-
-      __m128i upper = _mm_min_epu16(pt, nt);
-      upper = _mm_max_epu16(upper, p1);
-      upper = _mm_max_epu16(upper, n1);
-
-      pdiff = _mm_subs_epu16(p2, p1);
-      ndiff = _mm_subs_epu16(n2, n1);
+template<int bits_per_pixel, bool aligned>
+static RG_FORCEINLINE __m128i vcleaner_relaxed_median_sse4_16(const Byte* pSrc, int srcPitch) {
+  __m128i p2 = simd_load_si128<aligned>(pSrc - srcPitch*2);
+  __m128i p1 = simd_load_si128<aligned>(pSrc - srcPitch);
+  __m128i c  = simd_load_si128<aligned>(pSrc);
+  __m128i n1 = simd_load_si128<aligned>(pSrc + srcPitch);
+  __m128i n2 = simd_load_si128<aligned>(pSrc + srcPitch*2);
+
+  __m128i pdiff = _mm_subs_epu16(p1, p2);
+  __m128i ndiff = _mm_subs_epu16(n1, n2);
+
+  __m128i pt = _mm_adds_epu16(pdiff, p1);
+  __m128i nt = _mm_adds_epu16(ndiff, n1);
+  if (bits_per_pixel < 16) // for 16 bit _mm_adds limits to FFFF
+  {
+    __m128i pixel_max = _mm_set1_epi16((short)((1u << bits_per_pixel) - 1));
+    pt = _mm_min_epu16(pt, pixel_max);
+    nt = _mm_min_epu16(nt, pixel_max);
+  }
 
-      pt = _mm_subs_epu16(p1, pdiff);
-      nt = _mm_subs_epu16(n1, ndiff);
+  __m128i upper = _mm_min_epu16(pt, nt);
+  upper = _mm_max_epu16(upper, p1);
+  upper = _mm_max_epu16(upper, n1);
 
-      __m128i minpn1 = _mm_min_epu16(p1, n1);
+  pdiff = _mm_subs_epu16(p2, p1);
+  ndiff = _mm_subs_epu16(n2, n1);
 
-      __m128i lower = _mm_max_epu16(pt, nt);
-      lower = _mm_min_epu16(lower, minpn1);
+  pt = _mm_subs_epu16(p1, pdiff);
+  nt = _mm_subs_epu16(n1, ndiff);
 
-      __m128i dst = simd_clip_16(c, lower, upper);
+  __m128i minpn1 = _mm_min_epu16(p1, n1);
 
-      _mm_store_si128(reinterpret_cast<__m128i*>(pDst+x), dst);
-    }
+  __m128i lower = _mm_max_epu16(pt, nt);
+  lower = _mm_min_epu16(lower, minpn1);
 
-    pSrc += srcPitch;
-    pDst += dstPitch;
-  }
-
-  env->BitBlt((uint8_t *)pDst, dstPitch*sizeof(uint16_t), (uint8_t *)pSrc, srcPitch*sizeof(uint16_t), rowsize, 2);
+  return simd_clip_16(c, lower, upper);
 }
 
-static void vcleaner_relaxed_median_sse_32(Byte* pDst8, const Byte *pSrc8, int dstPitch, int srcPitch, int rowsize, int height, IScriptEnvironment *env) {
-  env->BitBlt(pDst8, dstPitch, pSrc8, srcPitch, rowsize, 2);
+template<bool aligned>
+static RG_FORCEINLINE __m128i vcleaner_relaxed_median_sse_32(const Byte* pSrc, int srcPitch) {
+  __m128 p2 = simd_load_ps<aligned>(pSrc - srcPitch*2);
+  __m128 p1 = simd_load_ps<aligned>(pSrc - srcPitch);
+  __m128 c  = simd_load_ps<aligned>(pSrc);
+  __m128 n1 = simd_load_ps<aligned>(pSrc + srcPitch);
+  __m128 n2 = simd_load_ps<aligned>(pSrc + srcPitch*2);
 
-  float *pDst = reinterpret_cast<float *>(pDst8);
-  const float *pSrc = reinterpret_cast<const float *>(pSrc8);
+  __m128 pdiff = _mm_subs_ps(p1, p2);
+  __m128 ndiff = _mm_subs_ps(n1, n2);
 
-  dstPitch /= sizeof(float);
-  srcPitch /= sizeof(float);
+  __m128 pt = _mm_adds_ps(pdiff, p1);
+  __m128 nt = _mm_adds_ps(ndiff, n1);
 
-  const int width = rowsize / sizeof(float);
+  // no max_pixel_value clamp for float
 
-  pSrc += srcPitch*2;
-  pDst += dstPitch*2;
+  __m128 upper = _mm_min_ps(pt, nt);
+  upper = _mm_max_ps(upper, p1);
+  upper = _mm_max_ps(upper, n1);
 
-  for (int y = 2; y < height-2; ++y) {
-    for (int x = 0; x < width; x+=16/sizeof(float)) {
-      __m128 p2 = _mm_load_ps(reinterpret_cast<const float*>(pSrc + x-srcPitch*2));
-      __m128 p1 = _mm_load_ps(reinterpret_cast<const float*>(pSrc + x-srcPitch));
-      __m128 c  = _mm_load_ps(reinterpret_cast<const float*>(pSrc + x));
-      __m128 n1 = _mm_load_ps(reinterpret_cast<const float*>(pSrc + x+srcPitch));
-      __m128 n2 = _mm_load_ps(reinterpret_cast<const float*>(pSrc + x+srcPitch*2));
+  pdiff = _mm_subs_ps(p2, p1);
+  ndiff = _mm_subs_ps(n2, n1);
 
-      __m128 pdiff = _mm_subs_ps(p1, p2);
-      __m128 ndiff = _mm_subs_ps(n1, n2);
+  pt = _mm_subs_ps(p1, pdiff);
+  nt = _mm_subs_ps(n1, ndiff);
 
-      __m128 pt = _mm_adds_ps(pdiff, p1);
-      __m128 nt = _mm_adds_ps(ndiff, n1);
+  __m128 minpn1 = _mm_min_ps(p1, n1);
 
-      // no max_pixel_value clamp for float
+  __m128 lower = _mm_max_ps(pt, nt);
+  lower = _mm_min_ps(lower, minpn1);
 
-      __m128 upper = _mm_min_ps(pt, nt);
-      upper = _mm_max_ps(upper, p1);
-      upper = _mm_max_ps(upper, n1);
+  return _mm_castps_si128(simd_clip_32(c, lower, upper));
+}
 
-      pdiff = _mm_subs_ps(p2, p1);
-      ndiff = _mm_subs_ps(n2, n1);
+// border: number of top and bottom lines copied unchanged (1 for median, 2 for relaxed median)
+// rowsize must be at least 16, checked in VerticalCleaner constructor
+template<VModeProcessor processor, VModeProcessor processor_ua, int border>
+static void process_plane_sse(Byte* pDst, const Byte *pSrc, int dstPitch, int srcPitch, int rowsize, int height, IScriptEnvironment *env) {
+    env->BitBlt(pDst, dstPitch, pSrc, srcPitch, rowsize, border);
 
-      pt = _mm_subs_ps(p1, pdiff);
-      nt = _mm_subs_ps(n1, ndiff);
+    // unaligned crop: unaligned loads and stores for the whole plane
+    const bool aligned = is_16byte_aligned_plane(pDst, dstPitch) && is_16byte_aligned_plane(pSrc, srcPitch);
+    const int mod16Width = rowsize / 16 * 16;
 
-      __m128 minpn1 = _mm_min_ps(p1, n1);
+    pSrc += srcPitch*border;
+    pDst += dstPitch*border;
 
-      __m128 lower = _mm_max_ps(pt, nt);
-      lower = _mm_min_ps(lower, minpn1);
+    for (int y = border; y < height-border; ++y) {
+        if (aligned) {
+            for (int x = 0; x < mod16Width; x+=16)
+                _mm_store_si128(reinterpret_cast<__m128i*>(pDst+x), processor(pSrc+x, srcPitch));
+        }
+        else {
+            for (int x = 0; x < mod16Width; x+=16)
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(pDst+x), processor_ua(pSrc+x, srcPitch));
+        }
 
-      __m128 dst = simd_clip_32(c, lower, upper);
+        if (mod16Width != rowsize) {
+            // last 16 bytes, overlaps with the already processed part
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(pDst+rowsize-16), processor_ua(pSrc+rowsize-16, srcPitch));
+        }
 
-      _mm_store_ps(reinterpret_cast<float*>(pDst+x), dst);
+        pSrc += srcPitch;
+        pDst += dstPitch;
     }
 
-    pSrc += srcPitch;
-    pDst += dstPitch;
-  }
-
-  env->BitBlt((uint8_t *)pDst, dstPitch*sizeof(float), (uint8_t *)pSrc, srcPitch*sizeof(float), rowsize, 2);
+    env->BitBlt(pDst, dstPitch, pSrc, srcPitch, rowsize, border);
 }
 
 
@@ -249,15 +205,15 @@ static void vcleaner_median_c(Byte* pDst8, const Byte *pSrc8, int dstPitch, int
     env->BitBlt((uint8_t *)pDst, dstPitch*sizeof(pixel_t), (uint8_t *)pSrc, srcPitch*sizeof(pixel_t), rowsize, 1);
 }
 
-static __forceinline Byte satb(int value) {
+static RG_FORCEINLINE Byte satb(int value) {
     return clip(value, 0, 255);
 }
 
-static __forceinline uint16_t satb_16(int value, int max_pixel_value) {
+static RG_FORCEINLINE uint16_t satb_16(int value, int max_pixel_value) {
   return clip_16(value, 0, max_pixel_value);
 }
 
-static __forceinline float satb_32(float value) {
+static RG_FORCEINLINE float satb_32(float value) {
 #if 0
   // no clamp for float
   return clip_32(value, 0.0f, 1.0f);
@@ -376,46 +332,49 @@ static void do_nothing(Byte* pDst, const Byte *pSrc, int dstPitch, int srcPitch,
 
 }
 
+// the tables share their names with the RemoveGrain and Repair ones, GCC does not put the type into a variable's symbol like MSVC
+namespace vcleaner {
+
 VCleanerProcessor* sse4_functions_uint16_10[] = {
   do_nothing,
   copy_plane,
-  vcleaner_median_sse<uint16_t>,
-  vcleaner_relaxed_median_sse4_16<10>
+  process_plane_sse<vcleaner_median_sse<uint16_t, true>, vcleaner_median_sse<uint16_t, false>, 1>,
+  process_plane_sse<vcleaner_relaxed_median_sse4_16<10, true>, vcleaner_relaxed_median_sse4_16<10, false>, 2>
 };
 
 VCleanerProcessor* sse4_functions_uint16_12[] = {
   do_nothing,
   copy_plane,
-  vcleaner_median_sse<uint16_t>,
-  vcleaner_relaxed_median_sse4_16<12>
+  process_plane_sse<vcleaner_median_sse<uint16_t, true>, vcleaner_median_sse<uint16_t, false>, 1>,
+  process_plane_sse<vcleaner_relaxed_median_sse4_16<12, true>, vcleaner_relaxed_median_sse4_16<12, false>, 2>
 };
 
 VCleanerProcessor* sse4_functions_uint16_14[] = {
   do_nothing,
   copy_plane,
-  vcleaner_median_sse<uint16_t>,
-  vcleaner_relaxed_median_sse4_16<14>
+  process_plane_sse<vcleaner_median_sse<uint16_t, true>, vcleaner_median_sse<uint16_t, false>, 1>,
+  process_plane_sse<vcleaner_relaxed_median_sse4_16<14, true>, vcleaner_relaxed_median_sse4_16<14, false>, 2>
 };
 
 VCleanerProcessor* sse4_functions_uint16_16[] = {
   do_nothing,
   copy_plane,
-  vcleaner_median_sse<uint16_t>,
-  vcleaner_relaxed_median_sse4_16<16>
+  process_plane_sse<vcleaner_median_sse<uint16_t, true>, vcleaner_median_sse<uint16_t, false>, 1>,
+  process_plane_sse<vcleaner_relaxed_median_sse4_16<16, true>, vcleaner_relaxed_median_sse4_16<16, false>, 2>
 };
 
 VCleanerProcessor* sse2_functions_32[] = {
   do_nothing,
   copy_plane,
-  vcleaner_median_sse<float>,
-  vcleaner_relaxed_median_sse_32
+  process_plane_sse<vcleaner_median_sse<float, true>, vcleaner_median_sse<float, false>, 1>,
+  process_plane_sse<vcleaner_relaxed_median_sse_32<true>, vcleaner_relaxed_median_sse_32<false>, 2>
 };
 
 VCleanerProcessor* sse2_functions[] = {
     do_nothing,
     copy_plane,
-    vcleaner_median_sse<uint8_t>,
-    vcleaner_relaxed_median_sse2
+    process_plane_sse<vcleaner_median_sse<uint8_t, true>, vcleaner_median_sse<uint8_t, false>, 1>,
+    process_plane_sse<vcleaner_relaxed_median_sse2<true>, vcleaner_relaxed_median_sse2<false>, 2>
 };
 
 VCleanerProcessor* c_functions[] = {
@@ -461,44 +420,47 @@ VCleanerProcessor* c_functions_32[] = {
   vcleaner_relaxed_median_c_32
 };
 
-static void dispatch_median(int mode, Byte* pDst, const Byte *pSrc, int dstPitch, int srcPitch, int rowsize, int height, int pixelsize, int bits_per_pixel, IScriptEnvironment *env) {
-  if (pixelsize == 1) {
-    if ((env->GetCPUFlags() & CPUF_SSE2) && rowsize >= 16 && is_16byte_aligned(pSrc)) {
-      sse2_functions[mode + 1](pDst, pSrc, dstPitch, srcPitch, rowsize, height, env);
-    }
-    else {
-      c_functions[mode + 1](pDst, pSrc, dstPitch, srcPitch, rowsize, height, env);
-    }
-  }
-  else if (pixelsize == 2) {
-    if ((env->GetCPUFlags() & CPUF_SSE4) && rowsize >= 16 && is_16byte_aligned(pSrc)) {
-      switch (bits_per_pixel) {
-      case 10: sse4_functions_uint16_10[mode + 1](pDst, pSrc, dstPitch, srcPitch, rowsize, height, env); break;
-      case 12: sse4_functions_uint16_12[mode + 1](pDst, pSrc, dstPitch, srcPitch, rowsize, height, env); break;
-      case 14: sse4_functions_uint16_14[mode + 1](pDst, pSrc, dstPitch, srcPitch, rowsize, height, env); break;
-      case 16: sse4_functions_uint16_16[mode + 1](pDst, pSrc, dstPitch, srcPitch, rowsize, height, env); break;
-      }
-    }
-    else {
-      switch (bits_per_pixel) {
-      case 10: c_functions_10[mode + 1](pDst, pSrc, dstPitch, srcPitch, rowsize, height, env); break;
-      case 12: c_functions_12[mode + 1](pDst, pSrc, dstPitch, srcPitch, rowsize, height, env); break;
-      case 14: c_functions_14[mode + 1](pDst, pSrc, dstPitch, srcPitch, rowsize, height, env); break;
-      case 16: c_functions_16[mode + 1](pDst, pSrc, dstPitch, srcPitch, rowsize, height, env); break;
-      }
+extern VCleanerProcessor* avx2_functions[];
+extern VCleanerProcessor* avx2_functions_uint16_10[];
+extern VCleanerProcessor* avx2_functions_uint16_12[];
+extern VCleanerProcessor* avx2_functions_uint16_14[];
+extern VCleanerProcessor* avx2_functions_uint16_16[];
+extern VCleanerProcessor* avx2_functions_32[];
+extern VCleanerProcessor* avx2_fma_functions_32[];
+extern VCleanerProcessor* avx512_functions[];
+extern VCleanerProcessor* avx512_functions_uint16_10[];
+extern VCleanerProcessor* avx512_functions_uint16_12[];
+extern VCleanerProcessor* avx512_functions_uint16_14[];
+extern VCleanerProcessor* avx512_functions_uint16_16[];
+extern VCleanerProcessor* avx512_functions_32[];
+
+}
+using namespace vcleaner;
+
+void VerticalCleaner::dispatch_median(int p, int mode, Byte* pDst, const Byte *pSrc, int dstPitch, int srcPitch, int rowsize, int height, IScriptEnvironment *env) {
+  PlaneTimer timer(profile_.get(), p, rowsize, height, 1);
+  VCleanerProcessor *processor = functions[mode + 1];
+  if (pSrc == pDst) {
+    // in place, modes 0 and -1 leave the plane as it is, relaxed median keeps two border lines
+    if (mode > 0) {
+      process_plane_inplace(pDst, dstPitch, rowsize, height, mode == 2 ? 2 : 1, [&](int, int h, const Byte* pWindow, int windowPitch, Byte* pRows, int pitch) {
+        processor(pRows, pWindow, pitch, windowPitch, rowsize, h, env);
+      });
     }
+    return;
   }
-  else { // if (pixelsize == 4
-    if ((env->GetCPUFlags() & CPUF_SSE2) && rowsize >= 16 && is_16byte_aligned(pSrc))
-      sse2_functions_32[mode + 1](pDst, pSrc, dstPitch, srcPitch, rowsize, height, env);
-    else
-      c_functions_32[mode + 1](pDst, pSrc, dstPitch, srcPitch, rowsize, height, env);
+  if (pool_ == nullptr || mode == -1) {
+    processor(pDst, pSrc, dstPitch, srcPitch, rowsize, height, env);
+    return;
   }
-
+  // relaxed median keeps two border lines
+  process_plane_stripes(pool_, stripes_, mode == 2 ? 2 : 1, pDst, dstPitch, rowsize, height, [&](int y, int h, Byte* pStripeDst, int stripeDstPitch) {
+    processor(pStripeDst, pSrc + y * srcPitch, stripeDstPitch, srcPitch, rowsize, h, env);
+  });
 }
 
-VerticalCleaner::VerticalCleaner(PClip child, int mode, int modeU, int modeV, bool skip_cs_check, IScriptEnvironment* env)
-: GenericVideoFilter(child), mode_(mode), modeU_(modeU), modeV_(modeV) {
+VerticalCleaner::VerticalCleaner(PClip child, int mode, int modeU, int modeV, bool skip_cs_check, bool use_avx2, int threads, bool profile, IScriptEnvironment* env)
+: GenericVideoFilter(child), mode_(mode), modeU_(modeU), modeV_(modeV), functions(nullptr), pool_(nullptr), stripes_(1) {
     if (!(vi.IsPlanar() || skip_cs_check)) {
         env->ThrowError("VerticalCleaner works only with planar colorspaces");
     }
@@ -519,49 +481,120 @@ VerticalCleaner::VerticalCleaner(PClip child, int mode, int modeU, int modeV, bo
         modeV_ = modeU_;
     }
 
+    // no plane is changed, frames are handed on without a copy
+    passthrough_ = mode_ <= 0 && (isPlanarRGB || !vi.IsPlanar() || vi.IsY() || (modeU_ <= 0 && modeV_ <= 0));
+
     pixelsize = vi.ComponentSize();
     bits_per_pixel = vi.BitsPerComponent();
+
+    // SSE and AVX2 plane processors need at least 16 or 32 bytes in the narrowest processed plane
+    int min_width = vi.width;
+    if (vi.IsPlanar() && !vi.IsY() && !isPlanarRGB)
+      min_width >>= vi.GetPlaneWidthSubsampling(PLANAR_U);
+    bool avx2 = use_avx2 && min_width * pixelsize >= 32 && (env->GetCPUFlags() & CPUF_AVX2);
+    bool sse2 = min_width * pixelsize >= 16 && (env->GetCPUFlags() & CPUF_SSE2);
+    bool sse4 = min_width * pixelsize >= 16 && (env->GetCPUFlags() & CPUF_SSE4);
+    // AVX-512 rows end with a masked vector, any width
+    bool avx512 = use_avx2 && (env->GetCPUFlags() & CPUF_AVX2) && cpu_has_avx512bw();
+
+    // remark: no special alignment required, SSE planes fall back to unaligned loads per plane
+    if (pixelsize == 1) {
+      functions = avx512 ? avx512_functions : avx2 ? avx2_functions : sse2 ? sse2_functions : c_functions;
+    }
+    else if (pixelsize == 2) {
+      switch (bits_per_pixel) {
+      case 10: functions = avx512 ? avx512_functions_uint16_10 : avx2 ? avx2_functions_uint16_10 : sse4 ? sse4_functions_uint16_10 : c_functions_10; break;
+      case 12: functions = avx512 ? avx512_functions_uint16_12 : avx2 ? avx2_functions_uint16_12 : sse4 ? sse4_functions_uint16_12 : c_functions_12; break;
+      case 14: functions = avx512 ? avx512_functions_uint16_14 : avx2 ? avx2_functions_uint16_14 : sse4 ? sse4_functions_uint16_14 : c_functions_14; break;
+      case 16: functions = avx512 ? avx512_functions_uint16_16 : avx2 ? avx2_functions_uint16_16 : sse4 ? sse4_functions_uint16_16 : c_functions_16; break;
+      default: env->ThrowError("Illegal bit-depth: %d!", bits_per_pixel);
+      }
+    }
+    else { // if (pixelsize == 4)
+      if (avx512)
+        functions = avx512_functions_32;
+      else if (avx2)
+        functions = (env->GetCPUFlags() & CPUF_FMA3) ? avx2_fma_functions_32 : avx2_functions_32;
+      else
+        functions = sse2 ? sse2_functions_32 : c_functions_32;
+    }
+
+    profile_ = FilterProfile::create(profile, "VerticalCleaner", vi, env);
+    if (profile_) {
+      const char *isa = avx512 ? "avx512" : avx2 ? (functions == avx2_fma_functions_32 ? "avx2fma" : "avx2")
+        : pixelsize == 2 ? (sse4 ? "sse4" : "c") : sse2 ? "sse2" : "c";
+      for (int p = 0; p < 3; ++p)
+        profile_->set_isa(p, isa);
+    }
+
+    if (threads < 0) {
+      env->ThrowError("VerticalCleaner: threads must be 0 (auto) or positive!");
+    }
+    if (threads != 1) {
+      pool_ = ThreadPool::acquire();
+      stripes_ = stripes_for_threads(threads, pool_);
+    }
+}
+
+VerticalCleaner::~VerticalCleaner() {
+  if (pool_ != nullptr)
+    ThreadPool::release();
 }
 
 PVideoFrame VerticalCleaner::GetFrame(int n, IScriptEnvironment* env) {
+    if (passthrough_)
+      return child->GetFrame(n, env);
+
     auto srcFrame = child->GetFrame(n, env);
-    auto dstFrame = env->NewVideoFrame(vi);
+    // nothing else holds the source frame (no cache before us): filter it in place, without a second
+    // frame and the alpha copy. Not with threads, the stripes would need each other's source rows
+    const bool inplace = pool_ == nullptr && srcFrame->IsWritable();
+    PVideoFrame newFrame;
+    if (!inplace)
+      newFrame = env->NewVideoFrame(vi);
+    // in place an alias, not a second handle: that would make the frame read-only, GetWritePtr returns nullptr
+    PVideoFrame &dstFrame = inplace ? srcFrame : newFrame;
+    FrameProfile frame_profile(profile_.get());
 
     if (vi.IsPlanarRGB() || vi.IsPlanarRGBA()) {
-      dispatch_median(mode_, dstFrame->GetWritePtr(PLANAR_G), srcFrame->GetReadPtr(PLANAR_G), dstFrame->GetPitch(PLANAR_G), srcFrame->GetPitch(PLANAR_G),
-        srcFrame->GetRowSize(PLANAR_G), srcFrame->GetHeight(PLANAR_G), pixelsize, bits_per_pixel, env);
-      dispatch_median(mode_, dstFrame->GetWritePtr(PLANAR_B), srcFrame->GetReadPtr(PLANAR_B), dstFrame->GetPitch(PLANAR_B), srcFrame->GetPitch(PLANAR_B),
-        srcFrame->GetRowSize(PLANAR_B), srcFrame->GetHeight(PLANAR_B), pixelsize, bits_per_pixel, env);
-      dispatch_median(mode_, dstFrame->GetWritePtr(PLANAR_R), srcFrame->GetReadPtr(PLANAR_R), dstFrame->GetPitch(PLANAR_R), srcFrame->GetPitch(PLANAR_R),
-        srcFrame->GetRowSize(PLANAR_R), srcFrame->GetHeight(PLANAR_R), pixelsize, bits_per_pixel, env);
+      dispatch_median(0, mode_, dstFrame->GetWritePtr(PLANAR_G), srcFrame->GetReadPtr(PLANAR_G), dstFrame->GetPitch(PLANAR_G), srcFrame->GetPitch(PLANAR_G),
+        srcFrame->GetRowSize(PLANAR_G), srcFrame->GetHeight(PLANAR_G), env);
+      dispatch_median(1, mode_, dstFrame->GetWritePtr(PLANAR_B), srcFrame->GetReadPtr(PLANAR_B), dstFrame->GetPitch(PLANAR_B), srcFrame->GetPitch(PLANAR_B),
+        srcFrame->GetRowSize(PLANAR_B), srcFrame->GetHeight(PLANAR_B), env);
+      dispatch_median(2, mode_, dstFrame->GetWritePtr(PLANAR_R), srcFrame->GetReadPtr(PLANAR_R), dstFrame->GetPitch(PLANAR_R), srcFrame->GetPitch(PLANAR_R),
+        srcFrame->GetRowSize(PLANAR_R), srcFrame->GetHeight(PLANAR_R), env);
     }
     else {
-      dispatch_median(mode_, dstFrame->GetWritePtr(PLANAR_Y), srcFrame->GetReadPtr(PLANAR_Y), dstFrame->GetPitch(PLANAR_Y), srcFrame->GetPitch(PLANAR_Y),
-        srcFrame->GetRowSize(PLANAR_Y), srcFrame->GetHeight(PLANAR_Y), pixelsize, bits_per_pixel, env);
+      dispatch_median(0, mode_, dstFrame->GetWritePtr(PLANAR_Y), srcFrame->GetReadPtr(PLANAR_Y), dstFrame->GetPitch(PLANAR_Y), srcFrame->GetPitch(PLANAR_Y),
+        srcFrame->GetRowSize(PLANAR_Y), srcFrame->GetHeight(PLANAR_Y), env);
 
       if (!vi.IsY()) {
-        dispatch_median(modeU_, dstFrame->GetWritePtr(PLANAR_U), srcFrame->GetReadPtr(PLANAR_U), dstFrame->GetPitch(PLANAR_U), srcFrame->GetPitch(PLANAR_U),
-          srcFrame->GetRowSize(PLANAR_U), srcFrame->GetHeight(PLANAR_U), pixelsize, bits_per_pixel, env);
+        dispatch_median(1, modeU_, dstFrame->GetWritePtr(PLANAR_U), srcFrame->GetReadPtr(PLANAR_U), dstFrame->GetPitch(PLANAR_U), srcFrame->GetPitch(PLANAR_U),
+          srcFrame->GetRowSize(PLANAR_U), srcFrame->GetHeight(PLANAR_U), env);
 
-        dispatch_median(modeV_, dstFrame->GetWritePtr(PLANAR_V), srcFrame->GetReadPtr(PLANAR_V), dstFrame->GetPitch(PLANAR_V), srcFrame->GetPitch(PLANAR_V),
-          srcFrame->GetRowSize(PLANAR_V), srcFrame->GetHeight(PLANAR_V), pixelsize, bits_per_pixel, env);
+        dispatch_median(2, modeV_, dstFrame->GetWritePtr(PLANAR_V), srcFrame->GetReadPtr(PLANAR_V), dstFrame->GetPitch(PLANAR_V), srcFrame->GetPitch(PLANAR_V),
+          srcFrame->GetRowSize(PLANAR_V), srcFrame->GetHeight(PLANAR_V), env);
       }
     }
-    if (vi.IsYUVA() || vi.IsPlanarRGBA())
-    { // copy alpha
+    if ((vi.IsYUVA() || vi.IsPlanarRGBA()) && !inplace)
+    { // copy alpha, in place it is there already
       env->BitBlt(dstFrame->GetWritePtr(PLANAR_A), dstFrame->GetPitch(PLANAR_A), srcFrame->GetReadPtr(PLANAR_A), srcFrame->GetPitch(PLANAR_A), srcFrame->GetRowSize(PLANAR_A_ALIGNED), srcFrame->GetHeight(PLANAR_A));
     }
+    frame_profile.attach(dstFrame, env);
     return dstFrame;
 }
 
 AVSValue __cdecl Create_VerticalCleaner(AVSValue args, void*, IScriptEnvironment* env) {
-    enum { CLIP, MODE, MODEU, MODEV, PLANAR };
+    enum { CLIP, MODE, MODEU, MODEV, PLANAR, OPTAVX2, THREADS, PROFILE };
     return new VerticalCleaner(
         args[CLIP].AsClip(), 
         args[MODE].AsInt(1),
         args[MODEU].AsInt(VerticalCleaner::UNDEFINED_MODE),
         args[MODEV].AsInt(VerticalCleaner::UNDEFINED_MODE),
         args[PLANAR].AsBool(false), 
+        args[OPTAVX2].AsBool(true),
+        args[THREADS].AsInt(1),
+        args[PROFILE].AsBool(false),
         env);
 }
 
@@ -2,15 +2,21 @@
 #define __VERTICAL_CLEANER_H__
 
 #include "common.h"
+#include "thread_pool.h"
+#include "profile.h"
 
 typedef void (VCleanerProcessor)(Byte* pDst, const Byte *pSrc, int dstPitch, int srcPitch, int rowsize, int height, IScriptEnvironment *env);
 
 class VerticalCleaner : public GenericVideoFilter {
 public:
-    VerticalCleaner(PClip child, int mode, int modeU, int modeV, bool skip_cs_check, IScriptEnvironment* env);
+    VerticalCleaner(PClip child, int mode, int modeU, int modeV, bool skip_cs_check, bool use_avx2, int threads, bool profile, IScriptEnvironment* env);
+    ~VerticalCleaner();
 
     PVideoFrame __stdcall GetFrame(int n, IScriptEnvironment* env);
 
+    // profile=true, else nullptr
+    FilterProfile* profile() const { return profile_.get(); }
+
     int __stdcall SetCacheHints(int cachehints, int frame_range) override {
       return cachehints == CACHE_GET_MTMODE ? MT_NICE_FILTER : 0;
     }
@@ -21,9 +27,19 @@ private:
     int mode_;
     int modeU_;
     int modeV_;
+    bool passthrough_; // all planes mode 0 or -1: GetFrame returns the source frame
 
     int pixelsize;
     int bits_per_pixel;
+
+    VCleanerProcessor **functions;
+
+    ThreadPool *pool_; // nullptr when threads=1
+    int stripes_;
+
+    std::shared_ptr<FilterProfile> profile_; // nullptr when profile=false
+
+    void dispatch_median(int p, int mode, Byte* pDst, const Byte *pSrc, int dstPitch, int srcPitch, int rowsize, int height, IScriptEnvironment *env);
 };
 
 
@@ -0,0 +1,246 @@
+#include "common_avx2.h"
+#include "vertical_cleaner.h"
+
+typedef __m256i (VModeProcessor)(const Byte* pSrc, int srcPitch);
+
+template<typename pixel_t>
+static RG_FORCEINLINE __m256i vcleaner_median_avx2(const Byte* pSrc, int srcPitch) {
+  __m256i up     = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pSrc - srcPitch));
+  __m256i center = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pSrc));
+  __m256i down   = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pSrc + srcPitch));
+
+  if (sizeof(pixel_t) == 1) {
+    __m256i mi = _mm256_min_epu8(up, down);
+    __m256i ma = _mm256_max_epu8(up, down);
+
+    __m256i cma = _mm256_max_epu8(mi, center);
+    return _mm256_min_epu8(cma, ma);
+  }
+  else if (sizeof(pixel_t) == 2) {
+    __m256i mi = _mm256_min_epu16(up, down);
+    __m256i ma = _mm256_max_epu16(up, down);
+
+    __m256i cma = _mm256_max_epu16(mi, center);
+    return _mm256_min_epu16(cma, ma);
+  }
+  else {  // sizeof(pixel_t) == 4: float
+    __m256 mi = _mm256_min_ps(_mm256_castsi256_ps(up), _mm256_castsi256_ps(down));
+    __m256 ma = _mm256_max_ps(_mm256_castsi256_ps(up), _mm256_castsi256_ps(down));
+
+    __m256 cma = _mm256_max_ps(mi, _mm256_castsi256_ps(center));
+    return _mm256_castps_si256(_mm256_min_ps(cma, ma));
+  }
+}
+
+static RG_FORCEINLINE __m256i vcleaner_relaxed_median_avx2(const Byte* pSrc, int srcPitch) {
+  __m256i p2 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pSrc - srcPitch*2));
+  __m256i p1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pSrc - srcPitch));
+  __m256i c  = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pSrc));
+  __m256i n1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pSrc + srcPitch));
+  __m256i n2 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pSrc + srcPitch*2));
+
+  __m256i pdiff = _mm256_subs_epu8(p1, p2);
+  __m256i ndiff = _mm256_subs_epu8(n1, n2);
+
+  __m256i pt = _mm256_adds_epu8(pdiff, p1);
+  __m256i nt = _mm256_adds_epu8(ndiff, n1);
+
+  __m256i upper = _mm256_min_epu8(pt, nt);
+  upper = _mm256_max_epu8(upper, p1);
+  upper = _mm256_max_epu8(upper, n1);
+
+  pdiff = _mm256_subs_epu8(p2, p1);
+  ndiff = _mm256_subs_epu8(n2, n1);
+
+  pt = _mm256_subs_epu8(p1, pdiff);
+  nt = _mm256_subs_epu8(n1, ndiff);
+
+  __m256i minpn1 = _mm256_min_epu8(p1, n1);
+
+  __m256i lower = _mm256_max_epu8(pt, nt);
+  lower = _mm256_min_epu8(lower, minpn1);
+
+  return simd_clip(c, lower, upper);
+}
+
+template<int bits_per_pixel>
+static RG_FORCEINLINE __m256i vcleaner_relaxed_median_avx2_16(const Byte* pSrc, int srcPitch) {
+  __m256i p2 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pSrc - srcPitch*2));
+  __m256i p1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pSrc - srcPitch));
+  __m256i c  = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pSrc));
+  __m256i n1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pSrc + srcPitch));
+  __m256i n2 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pSrc + srcPitch*2));
+
+  __m256i pdiff = _mm256_subs_epu16(p1, p2);
+  __m256i ndiff = _mm256_subs_epu16(n1, n2);
+
+  __m256i pt = _mm256_adds_epu16(pdiff, p1);
+  __m256i nt = _mm256_adds_epu16(ndiff, n1);
+  if (bits_per_pixel < 16) // for 16 bit _mm256_adds limits to FFFF
+  {
+    __m256i pixel_max = _mm256_set1_epi16((short)((1u << bits_per_pixel) - 1));
+    pt = _mm256_min_epu16(pt, pixel_max);
+    nt = _mm256_min_epu16(nt, pixel_max);
+  }
+
+  __m256i upper = _mm256_min_epu16(pt, nt);
+  upper = _mm256_max_epu16(upper, p1);
+  upper = _mm256_max_epu16(upper, n1);
+
+  pdiff = _mm256_subs_epu16(p2, p1);
+  ndiff = _mm256_subs_epu16(n2, n1);
+
+  pt = _mm256_subs_epu16(p1, pdiff);
+  nt = _mm256_subs_epu16(n1, ndiff);
+
+  __m256i minpn1 = _mm256_min_epu16(p1, n1);
+
+  __m256i lower = _mm256_max_epu16(pt, nt);
+  lower = _mm256_min_epu16(lower, minpn1);
+
+  return simd_clip_16(c, lower, upper);
+}
+
+static RG_FORCEINLINE __m256i vcleaner_relaxed_median_avx2_32(const Byte* pSrc, int srcPitch) {
+  __m256 p2 = _mm256_loadu_ps(reinterpret_cast<const float*>(pSrc - srcPitch*2));
+  __m256 p1 = _mm256_loadu_ps(reinterpret_cast<const float*>(pSrc - srcPitch));
+  __m256 c  = _mm256_loadu_ps(reinterpret_cast<const float*>(pSrc));
+  __m256 n1 = _mm256_loadu_ps(reinterpret_cast<const float*>(pSrc + srcPitch));
+  __m256 n2 = _mm256_loadu_ps(reinterpret_cast<const float*>(pSrc + srcPitch*2));
+
+  __m256 pdiff = _mm256_subs_ps(p1, p2);
+  __m256 ndiff = _mm256_subs_ps(n1, n2);
+
+  __m256 pt = _mm256_adds_ps(pdiff, p1);
+  __m256 nt = _mm256_adds_ps(ndiff, n1);
+
+  // no max_pixel_value clamp for float
+
+  __m256 upper = _mm256_min_ps(pt, nt);
+  upper = _mm256_max_ps(upper, p1);
+  upper = _mm256_max_ps(upper, n1);
+
+  pdiff = _mm256_subs_ps(p2, p1);
+  ndiff = _mm256_subs_ps(n2, n1);
+
+  pt = _mm256_subs_ps(p1, pdiff);
+  nt = _mm256_subs_ps(n1, ndiff);
+
+  __m256 minpn1 = _mm256_min_ps(p1, n1);
+
+  __m256 lower = _mm256_max_ps(pt, nt);
+  lower = _mm256_min_ps(lower, minpn1);
+
+  return _mm256_castps_si256(simd_clip_32(c, lower, upper));
+}
+
+// AVX2 + FMA3: p1 + (p1 - p2) and p1 - (p2 - p1) are the same value, computed once as 2*p1 - p2
+// in one rounding (the plain version rounds twice, results can differ in the last bit)
+static RG_FORCEINLINE __m256i vcleaner_relaxed_median_fma_32(const Byte* pSrc, int srcPitch) {
+  __m256 p2 = _mm256_loadu_ps(reinterpret_cast<const float*>(pSrc - srcPitch*2));
+  __m256 p1 = _mm256_loadu_ps(reinterpret_cast<const float*>(pSrc - srcPitch));
+  __m256 c  = _mm256_loadu_ps(reinterpret_cast<const float*>(pSrc));
+  __m256 n1 = _mm256_loadu_ps(reinterpret_cast<const float*>(pSrc + srcPitch));
+  __m256 n2 = _mm256_loadu_ps(reinterpret_cast<const float*>(pSrc + srcPitch*2));
+
+  const __m256 two = _mm256_set1_ps(2.0f);
+  __m256 pt = _mm256_fmsub_ps(p1, two, p2);
+  __m256 nt = _mm256_fmsub_ps(n1, two, n2);
+
+  __m256 upper = _mm256_max_ps(_mm256_min_ps(pt, nt), _mm256_max_ps(p1, n1));
+  __m256 lower = _mm256_min_ps(_mm256_max_ps(pt, nt), _mm256_min_ps(p1, n1));
+
+  return _mm256_castps_si256(simd_clip_32(c, lower, upper));
+}
+
+// border: number of top and bottom lines copied unchanged (1 for median, 2 for relaxed median)
+// rowsize must be at least 32, checked in VerticalCleaner constructor
+template<VModeProcessor processor, int border>
+static void process_plane_avx2(Byte* pDst, const Byte *pSrc, int dstPitch, int srcPitch, int rowsize, int height, IScriptEnvironment *env) {
+  _mm256_zeroupper();
+
+  env->BitBlt(pDst, dstPitch, pSrc, srcPitch, rowsize, border);
+
+  pSrc += srcPitch*border;
+  pDst += dstPitch*border;
+
+  const int mod32Width = rowsize / 32 * 32;
+
+  for (int y = border; y < height-border; ++y) {
+    for (int x = 0; x < mod32Width; x+=32) {
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(pDst+x), processor(pSrc+x, srcPitch));
+    }
+
+    if (mod32Width != rowsize) {
+      // last 32 bytes, overlaps with the already processed part
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(pDst+rowsize-32), processor(pSrc+rowsize-32, srcPitch));
+    }
+
+    pSrc += srcPitch;
+    pDst += dstPitch;
+  }
+  _mm256_zeroupper();
+
+  env->BitBlt(pDst, dstPitch, pSrc, srcPitch, rowsize, border);
+}
+
+static void copy_plane(Byte* pDst, const Byte *pSrc, int dstPitch, int srcPitch, int rowsize, int height, IScriptEnvironment *env) {
+  env->BitBlt(pDst, dstPitch, pSrc, srcPitch, rowsize, height);
+}
+
+static void do_nothing(Byte* pDst, const Byte *pSrc, int dstPitch, int srcPitch, int rowsize, int height, IScriptEnvironment *env) {
+
+}
+
+namespace vcleaner {
+
+VCleanerProcessor* avx2_functions[] = {
+  do_nothing,
+  copy_plane,
+  process_plane_avx2<vcleaner_median_avx2<uint8_t>, 1>,
+  process_plane_avx2<vcleaner_relaxed_median_avx2, 2>
+};
+
+VCleanerProcessor* avx2_functions_uint16_10[] = {
+  do_nothing,
+  copy_plane,
+  process_plane_avx2<vcleaner_median_avx2<uint16_t>, 1>,
+  process_plane_avx2<vcleaner_relaxed_median_avx2_16<10>, 2>
+};
+
+VCleanerProcessor* avx2_functions_uint16_12[] = {
+  do_nothing,
+  copy_plane,
+  process_plane_avx2<vcleaner_median_avx2<uint16_t>, 1>,
+  process_plane_avx2<vcleaner_relaxed_median_avx2_16<12>, 2>
+};
+
+VCleanerProcessor* avx2_functions_uint16_14[] = {
+  do_nothing,
+  copy_plane,
+  process_plane_avx2<vcleaner_median_avx2<uint16_t>, 1>,
+  process_plane_avx2<vcleaner_relaxed_median_avx2_16<14>, 2>
+};
+
+VCleanerProcessor* avx2_functions_uint16_16[] = {
+  do_nothing,
+  copy_plane,
+  process_plane_avx2<vcleaner_median_avx2<uint16_t>, 1>,
+  process_plane_avx2<vcleaner_relaxed_median_avx2_16<16>, 2>
+};
+
+VCleanerProcessor* avx2_functions_32[] = {
+  do_nothing,
+  copy_plane,
+  process_plane_avx2<vcleaner_median_avx2<float>, 1>,
+  process_plane_avx2<vcleaner_relaxed_median_avx2_32, 2>
+};
+
+VCleanerProcessor* avx2_fma_functions_32[] = {
+  do_nothing,
+  copy_plane,
+  process_plane_avx2<vcleaner_median_avx2<float>, 1>,
+  process_plane_avx2<vcleaner_relaxed_median_fma_32, 2>
+};
+
+}
@@ -0,0 +1,187 @@
+#include "common_avx512.h"
+#include "vertical_cleaner.h"
+
+// AVX-512BW: 64 byte vectors, the rest of the row with masked loads and stores (any rowsize)
+
+typedef __m512i (VModeProcessor)(const Byte* pSrc, int srcPitch, __mmask64 mask);
+
+// masked: zeroing load of the bytes in 'mask' only, for the last partial vector of a row
+template<bool masked>
+static RG_FORCEINLINE __m512i vc_load(const Byte* p, __mmask64 mask) {
+  return masked ? simd_maskz_loadu(p, mask) : simd_loadu_si512(p);
+}
+
+template<typename pixel_t, bool masked>
+static RG_FORCEINLINE __m512i vcleaner_median_avx512(const Byte* pSrc, int srcPitch, __mmask64 mask) {
+  __m512i up     = vc_load<masked>(pSrc - srcPitch, mask);
+  __m512i center = vc_load<masked>(pSrc, mask);
+  __m512i down   = vc_load<masked>(pSrc + srcPitch, mask);
+
+  if (sizeof(pixel_t) == 1) {
+    __m512i mi = _mm512_min_epu8(up, down);
+    __m512i ma = _mm512_max_epu8(up, down);
+    return _mm512_min_epu8(_mm512_max_epu8(mi, center), ma);
+  }
+  else if (sizeof(pixel_t) == 2) {
+    __m512i mi = _mm512_min_epu16(up, down);
+    __m512i ma = _mm512_max_epu16(up, down);
+    return _mm512_min_epu16(_mm512_max_epu16(mi, center), ma);
+  }
+  else {  // sizeof(pixel_t) == 4: float
+    __m512 mi = _mm512_min_ps(_mm512_castsi512_ps(up), _mm512_castsi512_ps(down));
+    __m512 ma = _mm512_max_ps(_mm512_castsi512_ps(up), _mm512_castsi512_ps(down));
+    return _mm512_castps_si512(_mm512_min_ps(_mm512_max_ps(mi, _mm512_castsi512_ps(center)), ma));
+  }
+}
+
+template<bool masked>
+static RG_FORCEINLINE __m512i vcleaner_relaxed_median_avx512(const Byte* pSrc, int srcPitch, __mmask64 mask) {
+  __m512i p2 = vc_load<masked>(pSrc - srcPitch*2, mask);
+  __m512i p1 = vc_load<masked>(pSrc - srcPitch, mask);
+  __m512i c  = vc_load<masked>(pSrc, mask);
+  __m512i n1 = vc_load<masked>(pSrc + srcPitch, mask);
+  __m512i n2 = vc_load<masked>(pSrc + srcPitch*2, mask);
+
+  __m512i pt = _mm512_adds_epu8(_mm512_subs_epu8(p1, p2), p1);
+  __m512i nt = _mm512_adds_epu8(_mm512_subs_epu8(n1, n2), n1);
+
+  __m512i upper = _mm512_max_epu8(_mm512_max_epu8(_mm512_min_epu8(pt, nt), p1), n1);
+
+  pt = _mm512_subs_epu8(p1, _mm512_subs_epu8(p2, p1));
+  nt = _mm512_subs_epu8(n1, _mm512_subs_epu8(n2, n1));
+
+  __m512i lower = _mm512_min_epu8(_mm512_max_epu8(pt, nt), _mm512_min_epu8(p1, n1));
+
+  return simd_clip(c, lower, upper);
+}
+
+template<int bits_per_pixel, bool masked>
+static RG_FORCEINLINE __m512i vcleaner_relaxed_median_avx512_16(const Byte* pSrc, int srcPitch, __mmask64 mask) {
+  __m512i p2 = vc_load<masked>(pSrc - srcPitch*2, mask);
+  __m512i p1 = vc_load<masked>(pSrc - srcPitch, mask);
+  __m512i c  = vc_load<masked>(pSrc, mask);
+  __m512i n1 = vc_load<masked>(pSrc + srcPitch, mask);
+  __m512i n2 = vc_load<masked>(pSrc + srcPitch*2, mask);
+
+  __m512i pt = _mm512_adds_epu16(_mm512_subs_epu16(p1, p2), p1);
+  __m512i nt = _mm512_adds_epu16(_mm512_subs_epu16(n1, n2), n1);
+  if (bits_per_pixel < 16) // for 16 bit _mm512_adds limits to FFFF
+  {
+    __m512i pixel_max = _mm512_set1_epi16((short)((1u << bits_per_pixel) - 1));
+    pt = _mm512_min_epu16(pt, pixel_max);
+    nt = _mm512_min_epu16(nt, pixel_max);
+  }
+
+  __m512i upper = _mm512_max_epu16(_mm512_max_epu16(_mm512_min_epu16(pt, nt), p1), n1);
+
+  pt = _mm512_subs_epu16(p1, _mm512_subs_epu16(p2, p1));
+  nt = _mm512_subs_epu16(n1, _mm512_subs_epu16(n2, n1));
+
+  __m512i lower = _mm512_min_epu16(_mm512_max_epu16(pt, nt), _mm512_min_epu16(p1, n1));
+
+  return simd_clip_16(c, lower, upper);
+}
+
+// 2*p1 - p2 with one rounding, same as vcleaner_relaxed_median_fma_32
+template<bool masked>
+static RG_FORCEINLINE __m512i vcleaner_relaxed_median_avx512_32(const Byte* pSrc, int srcPitch, __mmask64 mask) {
+  __m512 p2 = _mm512_castsi512_ps(vc_load<masked>(pSrc - srcPitch*2, mask));
+  __m512 p1 = _mm512_castsi512_ps(vc_load<masked>(pSrc - srcPitch, mask));
+  __m512 c  = _mm512_castsi512_ps(vc_load<masked>(pSrc, mask));
+  __m512 n1 = _mm512_castsi512_ps(vc_load<masked>(pSrc + srcPitch, mask));
+  __m512 n2 = _mm512_castsi512_ps(vc_load<masked>(pSrc + srcPitch*2, mask));
+
+  const __m512 two = _mm512_set1_ps(2.0f);
+  __m512 pt = _mm512_fmsub_ps(p1, two, p2);
+  __m512 nt = _mm512_fmsub_ps(n1, two, n2);
+
+  __m512 upper = _mm512_max_ps(_mm512_min_ps(pt, nt), _mm512_max_ps(p1, n1));
+  __m512 lower = _mm512_min_ps(_mm512_max_ps(pt, nt), _mm512_min_ps(p1, n1));
+
+  return _mm512_castps_si512(simd_clip_32(c, lower, upper));
+}
+
+// border: number of top and bottom lines copied unchanged (1 for median, 2 for relaxed median)
+template<VModeProcessor processor, VModeProcessor processor_masked, int border>
+static void process_plane_avx512(Byte* pDst, const Byte *pSrc, int dstPitch, int srcPitch, int rowsize, int height, IScriptEnvironment *env) {
+  _mm256_zeroupper();
+
+  env->BitBlt(pDst, dstPitch, pSrc, srcPitch, rowsize, border);
+
+  pSrc += srcPitch*border;
+  pDst += dstPitch*border;
+
+  const int mod64Width = rowsize / 64 * 64;
+  const __mmask64 tail = first_bytes_mask(rowsize - mod64Width);
+
+  for (int y = border; y < height-border; ++y) {
+    for (int x = 0; x < mod64Width; x+=64) {
+      _mm512_storeu_si512(reinterpret_cast<__m512i*>(pDst+x), processor(pSrc+x, srcPitch, ~0ULL));
+    }
+
+    if (mod64Width != rowsize) {
+      simd_mask_storeu(pDst+mod64Width, tail, processor_masked(pSrc+mod64Width, srcPitch, tail));
+    }
+
+    pSrc += srcPitch;
+    pDst += dstPitch;
+  }
+  _mm256_zeroupper();
+
+  env->BitBlt(pDst, dstPitch, pSrc, srcPitch, rowsize, border);
+}
+
+static void copy_plane(Byte* pDst, const Byte *pSrc, int dstPitch, int srcPitch, int rowsize, int height, IScriptEnvironment *env) {
+  env->BitBlt(pDst, dstPitch, pSrc, srcPitch, rowsize, height);
+}
+
+static void do_nothing(Byte* pDst, const Byte *pSrc, int dstPitch, int srcPitch, int rowsize, int height, IScriptEnvironment *env) {
+
+}
+
+namespace vcleaner {
+
+VCleanerProcessor* avx512_functions[] = {
+  do_nothing,
+  copy_plane,
+  process_plane_avx512<vcleaner_median_avx512<uint8_t, false>, vcleaner_median_avx512<uint8_t, true>, 1>,
+  process_plane_avx512<vcleaner_relaxed_median_avx512<false>, vcleaner_relaxed_median_avx512<true>, 2>
+};
+
+VCleanerProcessor* avx512_functions_uint16_10[] = {
+  do_nothing,
+  copy_plane,
+  process_plane_avx512<vcleaner_median_avx512<uint16_t, false>, vcleaner_median_avx512<uint16_t, true>, 1>,
+  process_plane_avx512<vcleaner_relaxed_median_avx512_16<10, false>, vcleaner_relaxed_median_avx512_16<10, true>, 2>
+};
+
+VCleanerProcessor* avx512_functions_uint16_12[] = {
+  do_nothing,
+  copy_plane,
+  process_plane_avx512<vcleaner_median_avx512<uint16_t, false>, vcleaner_median_avx512<uint16_t, true>, 1>,
+  process_plane_avx512<vcleaner_relaxed_median_avx512_16<12, false>, vcleaner_relaxed_median_avx512_16<12, true>, 2>
+};
+
+VCleanerProcessor* avx512_functions_uint16_14[] = {
+  do_nothing,
+  copy_plane,
+  process_plane_avx512<vcleaner_median_avx512<uint16_t, false>, vcleaner_median_avx512<uint16_t, true>, 1>,
+  process_plane_avx512<vcleaner_relaxed_median_avx512_16<14, false>, vcleaner_relaxed_median_avx512_16<14, true>, 2>
+};
+
+VCleanerProcessor* avx512_functions_uint16_16[] = {
+  do_nothing,
+  copy_plane,
+  process_plane_avx512<vcleaner_median_avx512<uint16_t, false>, vcleaner_median_avx512<uint16_t, true>, 1>,
+  process_plane_avx512<vcleaner_relaxed_median_avx512_16<16, false>, vcleaner_relaxed_median_avx512_16<16, true>, 2>
+};
+
+// float mode 2 as in avx2_fma_functions_32, FMA is part of AVX-512F
+VCleanerProcessor* avx512_functions_32[] = {
+  do_nothing,
+  copy_plane,
+  process_plane_avx512<vcleaner_median_avx512<float, false>, vcleaner_median_avx512<float, true>, 1>,
+  process_plane_avx512<vcleaner_relaxed_median_avx512_32<false>, vcleaner_relaxed_median_avx512_32<true>, 2>
+};
+
+}